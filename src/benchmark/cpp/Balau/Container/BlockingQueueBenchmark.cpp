@@ -0,0 +1,110 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Container/ArrayBlockingQueue.hpp>
+#include <Balau/Container/LockFreeBlockingQueue.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Balau::Container {
+
+//
+// Compares the transfer throughput of the array and lock-free blocking queues
+// across producer and consumer thread counts. The reported time is per element.
+//
+struct BlockingQueueBenchmark : public Testing::TestGroup<BlockingQueueBenchmark> {
+	static constexpr size_t QueueSize = 1024;
+	static constexpr size_t ElementCount = 200000;
+
+	BlockingQueueBenchmark() {
+		RegisterTestCase(transfer);
+	}
+
+	// Transfer the elements from the producers to the consumers.
+	static void transferElements(BlockingQueue<size_t> & queue, size_t producerCount, size_t consumerCount) {
+		const size_t perProducer = ElementCount / producerCount;
+		const size_t total = perProducer * producerCount;
+		std::atomic<size_t> dequeued { 0 };
+		std::atomic<size_t> sum { 0 };
+		std::vector<std::thread> threads;
+
+		for (size_t c = 0; c < consumerCount; c++) {
+			threads.emplace_back(
+				[&queue, &dequeued, &sum, total] () {
+					size_t localSum = 0;
+
+					while (dequeued < total) {
+						bool success;
+						auto element = queue.tryDequeue(std::chrono::milliseconds(10), success);
+
+						if (success) {
+							localSum += element;
+							++dequeued;
+						}
+					}
+
+					sum += localSum;
+				}
+			);
+		}
+
+		for (size_t p = 0; p < producerCount; p++) {
+			threads.emplace_back(
+				[&queue, perProducer] () {
+					for (size_t m = 1; m <= perProducer; m++) {
+						queue.enqueue(m);
+					}
+				}
+			);
+		}
+
+		for (auto & thread : threads) {
+			thread.join();
+		}
+
+		Benchmark::doNotOptimise(sum.load());
+	}
+
+	template <typename QueueT> static void run(const std::string & name, size_t producerCount, size_t consumerCount) {
+		QueueT queue(QueueSize);
+
+		auto result = Benchmark::measure(
+			  ::toString("BlockingQueue/", name, "/", producerCount, "-", consumerCount)
+			, [&queue, producerCount, consumerCount] () { transferElements(queue, producerCount, consumerCount); }
+		);
+
+		result.iterations *= ElementCount;
+		result.nanosecondsPerOperation /= (double) ElementCount;
+		Benchmark::report(result);
+	}
+
+	void transfer() {
+		const std::vector<std::pair<size_t, size_t>> threadCounts = { { 1, 1 }, { 4, 4 }, { 8, 2 }, { 32, 8 } };
+
+		for (const auto & counts : threadCounts) {
+			run<ArrayBlockingQueue<size_t>>("array", counts.first, counts.second);
+			run<LockFreeBlockingQueue<size_t>>("lock-free", counts.first, counts.second);
+		}
+	}
+};
+
+} // namespace Balau::Container
@@ -0,0 +1,216 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <LoadGenerator.hpp>
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/CannedHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/FailingHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/FileServingHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/RoutingHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/WsWebApps/EchoingWsWebApp.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <fstream>
+
+namespace Balau::Network::Http {
+
+//
+// Load tests of the HTTP server, run over loopback connections.
+//
+// Each scenario starts a server with the web application under test and runs
+// closed loop (maximum throughput) and/or open loop (constant rate) load against
+// it with keep-alive connections. Each run is written to standard output as a
+// tab delimited line starting with "load" (see Benchmark::report).
+//
+struct HttpServerBenchmark : public Testing::TestGroup<HttpServerBenchmark> {
+	HttpServerBenchmark() {
+		RegisterTestCase(canned);
+		RegisterTestCase(cannedOpenLoop);
+		RegisterTestCase(fileServing);
+		RegisterTestCase(routingDepth);
+		RegisterTestCase(wsEcho);
+	}
+
+	static constexpr unsigned short TestPortStart = 44310;
+	static constexpr size_t WorkerCount = 4;
+
+	static std::shared_ptr<HttpServer> startServer(const std::shared_ptr<HttpWebApp> & httpHandler,
+	                                               const std::shared_ptr<WsWebApp> & wsHandler,
+	                                               unsigned short & port) {
+		std::shared_ptr<HttpServer> server;
+
+		port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &httpHandler, &wsHandler] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(TestPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::shared_ptr<HttpServer>(
+					new HttpServer(clock, "BalauBenchmark", endpoint, "Benchmark", WorkerCount, httpHandler, wsHandler)
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	static Benchmark::LoadConnectionFactory httpGet(unsigned short port, const std::string & path) {
+		return [port, path] () {
+			return std::unique_ptr<Benchmark::LoadConnection>(new Benchmark::HttpGetConnection("127.0.0.1", port, path));
+		};
+	}
+
+	static Benchmark::LoadOptions closedLoop(const std::string & name, size_t connections) {
+		Benchmark::LoadOptions options;
+		options.name = name;
+		options.connections = connections;
+		return options;
+	}
+
+	static Benchmark::LoadOptions openLoop(const std::string & name, size_t connections, double requestsPerSecond) {
+		auto options = closedLoop(name, connections);
+		options.requestsPerSecond = requestsPerSecond;
+		return options;
+	}
+
+	static std::shared_ptr<HttpWebApp> cannedWebApp() {
+		return std::shared_ptr<HttpWebApp>(
+			new HttpWebApps::CannedHttpWebApp("text/plain", std::string(128, 'x'), "")
+		);
+	}
+
+	void canned() {
+		unsigned short port;
+		auto server = startServer(cannedWebApp(), nullptr, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		for (const size_t connections : { 1, 8, 32 }) {
+			Benchmark::runLoadAndReport(
+				closedLoop(::toString("HttpServer/canned/", connections, "-connections"), connections), httpGet(port, "/")
+			);
+		}
+	}
+
+	void cannedOpenLoop() {
+		unsigned short port;
+		auto server = startServer(cannedWebApp(), nullptr, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		for (const double rate : { 1000.0, 10000.0, 40000.0 }) {
+			Benchmark::runLoadAndReport(
+				openLoop(::toString("HttpServer/canned/", (size_t) rate, "-rps"), 16, rate), httpGet(port, "/")
+			);
+		}
+	}
+
+	void fileServing() {
+		// A temporary document root containing files of different sizes.
+		const auto root = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("balau-benchmark-%%%%-%%%%");
+		boost::filesystem::create_directories(root);
+		OnScopeExit removeRoot([&root] () { boost::system::error_code ignored; boost::filesystem::remove_all(root, ignored); });
+
+		const std::vector<size_t> sizes = { 1024, 16 * 1024, 256 * 1024 };
+
+		for (const auto size : sizes) {
+			std::ofstream file((root / ::toString("file-", size, ".html")).string(), std::ios::binary);
+			file << std::string(size, 'x');
+		}
+
+		unsigned short port;
+
+		auto server = startServer(
+			std::shared_ptr<HttpWebApp>(new HttpWebApps::FileServingHttpWebApp(Resource::File(root))), nullptr, port
+		);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		for (const auto size : sizes) {
+			Benchmark::runLoadAndReport(
+				  closedLoop(::toString("HttpServer/files/", size, "-bytes"), 8)
+				, httpGet(port, ::toString("/file-", size, ".html"))
+			);
+		}
+	}
+
+	void routingDepth() {
+		for (const size_t depth : { 1, 4, 16 }) {
+			// Each level has several siblings, with the handler at the end of the deepest path.
+			HttpWebApps::RoutingHttpWebApp::Routing routing(HttpWebApps::routingNode<HttpWebApps::FailingHttpWebApp>(""));
+			auto * node = &routing.root();
+			std::string path;
+
+			for (size_t level = 0; level < depth; ++level) {
+				for (size_t sibling = 0; sibling < 7; ++sibling) {
+					node->add(HttpWebApps::routingNode<HttpWebApps::FailingHttpWebApp>(::toString("sibling", sibling)));
+				}
+
+				const auto component = ::toString("level", level);
+				path += "/" + component;
+
+				node = level + 1 < depth
+					? &node->addAndReturnChild(HttpWebApps::routingNode(component))
+					: &node->addAndReturnChild(
+						HttpWebApps::routingNode<HttpWebApps::CannedHttpWebApp>(
+							component, std::string("text/plain"), std::string(128, 'x'), std::string()
+						)
+					);
+			}
+
+			unsigned short port;
+
+			auto server = startServer(
+				std::shared_ptr<HttpWebApp>(new HttpWebApps::RoutingHttpWebApp(std::move(routing))), nullptr, port
+			);
+
+			OnScopeExit stopServer([&server] () { server->stop(); });
+
+			Benchmark::runLoadAndReport(closedLoop(::toString("HttpServer/routing/depth-", depth), 8), httpGet(port, path));
+		}
+	}
+
+	void wsEcho() {
+		unsigned short port;
+
+		auto server = startServer(
+			  std::shared_ptr<HttpWebApp>(new HttpWebApps::FailingHttpWebApp)
+			, std::shared_ptr<WsWebApp>(new WsWebApps::EchoingWsWebApp)
+			, port
+		);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		for (const size_t size : { 64, 4096 }) {
+			Benchmark::runLoadAndReport(
+				  closedLoop(::toString("HttpServer/ws-echo/", size, "-bytes"), 8)
+				, [port, size] () {
+					return std::unique_ptr<Benchmark::LoadConnection>(
+						new Benchmark::WsEchoConnection("127.0.0.1", port, "/", std::string(size, 'x'))
+					);
+				}
+			);
+		}
+	}
+};
+
+} // namespace Balau::Network::Http
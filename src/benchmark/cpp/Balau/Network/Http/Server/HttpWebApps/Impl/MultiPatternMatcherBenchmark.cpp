@@ -0,0 +1,114 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/Impl/MultiPatternMatcher.hpp>
+
+namespace Balau::Network::Http::HttpWebApps::Impl {
+
+//
+// Compares the combined matcher with sequential std::regex matching,
+// for redirection rule sets of 10, 100, and 1000 rules.
+//
+struct MultiPatternMatcherBenchmark : public Testing::TestGroup<MultiPatternMatcherBenchmark> {
+	MultiPatternMatcherBenchmark() {
+		RegisterTestCase(rules10);
+		RegisterTestCase(rules100);
+		RegisterTestCase(rules1000);
+	}
+
+	// A mixture of regular expression rules and plain path rules, similar to legacy rewrite rules.
+	static std::vector<std::string> createPatterns(size_t count) {
+		std::vector<std::string> patterns;
+
+		for (size_t m = 0; m < count; ++m) {
+			switch (m % 4) {
+				case 0: patterns.push_back(::toString("^/legacy/section", m, "/(.*)$")); break;
+				case 1: patterns.push_back(::toString("^/archive/", m, "/([0-9]+)/([a-z-]+)\\.html$")); break;
+				case 2: patterns.push_back(::toString("^/old/page", m, "\\.html$")); break;
+				default: patterns.push_back(::toString("^/products/(", m, "|item", m, ")/(.*)$")); break;
+			}
+		}
+
+		return patterns;
+	}
+
+	// The index of the last rule of the specified kind.
+	static size_t lastRule(size_t count, size_t kind) {
+		const size_t index = (count - 1) / 4 * 4 + kind;
+		return index < count ? index : index - 4;
+	}
+
+	static void benchmark(size_t count) {
+		const auto patterns = createPatterns(count);
+
+		// Paths that match the last rules (the worst case for sequential matching) and a path that matches no rule.
+		const std::vector<std::string> paths = {
+			  ::toString("/legacy/section", lastRule(count, 0), "/some/deep/path/file.html")
+			, ::toString("/archive/", lastRule(count, 1), "/2018/an-article-title.html")
+			, ::toString("/old/page", lastRule(count, 2), ".html")
+			, ::toString("/products/item", lastRule(count, 3), "/details")
+			, "/unknown/path/file.html"
+		};
+
+		MultiPatternMatcher matcher(patterns);
+		std::vector<std::string_view> groups;
+
+		Benchmark::run(
+			  ::toString("MultiPatternMatcher/", count, "-rules")
+			, [&] () {
+				for (const auto & path : paths) {
+					Benchmark::doNotOptimise(matcher.match(path, groups));
+				}
+			}
+		);
+
+		std::vector<std::regex> regexes(patterns.begin(), patterns.end());
+		std::smatch results;
+
+		Benchmark::run(
+			  ::toString("SequentialStdRegex/", count, "-rules")
+			, [&] () {
+				for (const auto & path : paths) {
+					size_t index = 0;
+
+					while (index < regexes.size() && !std::regex_match(path, results, regexes[index])) {
+						++index;
+					}
+
+					Benchmark::doNotOptimise(index);
+				}
+			}
+		);
+	}
+
+	void rules10() {
+		benchmark(10);
+	}
+
+	void rules100() {
+		benchmark(100);
+	}
+
+	void rules1000() {
+		benchmark(1000);
+	}
+};
+
+} // namespace Balau::Network::Http::HttpWebApps::Impl
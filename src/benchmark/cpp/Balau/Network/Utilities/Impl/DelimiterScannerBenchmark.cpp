@@ -0,0 +1,92 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Network/Utilities/Impl/DelimiterScanner.hpp>
+#include <Balau/Util/Strings.hpp>
+
+namespace Balau::Network::Impl {
+
+//
+// Compares the vectorised cookie header parsing with the previous implementation,
+// which split the header and then each cookie via Strings::split.
+//
+struct DelimiterScannerBenchmark : public Testing::TestGroup<DelimiterScannerBenchmark> {
+	DelimiterScannerBenchmark() {
+		RegisterTestCase(cookies);
+		RegisterTestCase(scan);
+	}
+
+	template <typename HandlerT> static void previousForEachCookie(std::string_view header, HandlerT handler) {
+		for (const auto & cookie : Util::Strings::split(header, "; ")) {
+			const auto nameValue = Util::Strings::split(cookie, "=");
+
+			if (nameValue.size() != 2) {
+				continue;
+			}
+
+			handler(nameValue[0], nameValue[1]);
+		}
+	}
+
+	void cookies() {
+		const std::string header =
+			"session=0123456789abcdef0123456789abcdef; theme=dark; lang=en-GB; "
+			"_ga=GA1.2.1234567890.1234567890; _gid=GA1.2.0987654321.0987654321; consent=analytics";
+
+		size_t count = 0;
+
+		Benchmark::run(
+			  "Cookies/parse"
+			, [&] () {
+				forEachCookie(header, [&count] (std::string_view, std::string_view) { ++count; });
+				Benchmark::doNotOptimise(count);
+			}
+		);
+
+		Benchmark::run(
+			  "Cookies/previous-parse"
+			, [&] () {
+				previousForEachCookie(header, [&count] (std::string_view, std::string_view) { ++count; });
+				Benchmark::doNotOptimise(count);
+			}
+		);
+	}
+
+	void scan() {
+		// A long parameter value, with the delimiter at the end.
+		const std::string input = std::string(1000, 'x') + "&";
+
+		Benchmark::run(
+			  "DelimiterScanner/findFirstOf"
+			, [&] () {
+				Benchmark::doNotOptimise(findFirstOf<'&', '=', '%'>(input));
+			}
+		);
+
+		Benchmark::run(
+			  "DelimiterScanner/find_first_of"
+			, [&] () {
+				Benchmark::doNotOptimise(std::string_view(input).find_first_of("&=%"));
+			}
+		);
+	}
+};
+
+} // namespace Balau::Network::Impl
@@ -0,0 +1,81 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Network/Utilities/MimeTypes.hpp>
+#include <Balau/Util/Strings.hpp>
+
+namespace Balau::Network {
+
+//
+// Compares the perfect hash mime type lookup with the previous implementation,
+// which extracted and lower cased the extension into a new string before
+// looking it up in the hash map.
+//
+struct MimeTypesBenchmark : public Testing::TestGroup<MimeTypesBenchmark> {
+	MimeTypesBenchmark() {
+		RegisterTestCase(lookup);
+	}
+
+	static std::string_view previousLookup(const std::unordered_map<std::string, std::string> & data, const std::string & path) {
+		const auto lastDotPosition = path.rfind('.');
+
+		if (lastDotPosition == std::string::npos) {
+			return "";
+		}
+
+		auto match = data.find(Util::Strings::toLower(path.substr(lastDotPosition + 1)));
+		return match != data.end() ? std::string_view(match->second) : std::string_view();
+	}
+
+	void lookup() {
+		const auto & mimeTypes = *MimeTypes::defaultMimeTypes;
+
+		const std::vector<std::string> paths = {
+			  "/index.html"
+			, "/css/main.css"
+			, "/js/application.bundle.js"
+			, "/images/Photograph.JPEG"
+			, "/fonts/roboto-regular.woff2"
+			, "/downloads/archive.tar.gz"
+			, "/documents/README"
+			, "/unknown/file.extension"
+		};
+
+		Benchmark::run(
+			  "MimeTypes/lookup"
+			, [&] () {
+				for (const auto & path : paths) {
+					Benchmark::doNotOptimise(mimeTypes.lookup(path));
+				}
+			}
+		);
+
+		Benchmark::run(
+			  "MimeTypes/previous-lookup"
+			, [&] () {
+				for (const auto & path : paths) {
+					Benchmark::doNotOptimise(previousLookup(mimeTypes.getData(), path));
+				}
+			}
+		);
+	}
+};
+
+} // namespace Balau::Network
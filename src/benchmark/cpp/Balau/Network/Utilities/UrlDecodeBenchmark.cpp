@@ -0,0 +1,166 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Network/Utilities/UrlDecode.hpp>
+
+namespace Balau::Network {
+
+//
+// Compares the vectorised URL decoding and parameter splitting with the previous
+// implementations, which split via Strings::split into vectors and decoded by
+// appending to a new string.
+//
+struct UrlDecodeBenchmark : public Testing::TestGroup<UrlDecodeBenchmark> {
+	UrlDecodeBenchmark() {
+		RegisterTestCase(split);
+		RegisterTestCase(decode);
+	}
+
+	static std::unordered_map<std::string_view, std::string_view> previousSplit(const std::string_view data) {
+		std::unordered_map<std::string_view, std::string_view> keysAndValues;
+		std::vector<std::string_view> parameters = Util::Strings::split(data, "&");
+
+		for (auto parameter : parameters) {
+			std::vector<std::string_view> keyAndValue = Util::Strings::split(parameter, "=");
+
+			if (keyAndValue.size() == 1) {
+				keysAndValues.emplace(keyAndValue[0], "");
+			} else if (keyAndValue.size() != 2) {
+				ThrowBalauException(Exception::NetworkException, "Invalid parameter list");
+			} else {
+				keysAndValues.emplace(keyAndValue[0], keyAndValue[1]);
+			}
+		}
+
+		return keysAndValues;
+	}
+
+	static std::string previousDecode(const std::string_view input) {
+		std::string output;
+		size_t index = 0;
+
+		while (index < input.length()) {
+			switch (input[index]) {
+				case '+': {
+					output += ' ';
+					++index;
+					break;
+				}
+
+				case '%': {
+					std::string thisOutput;
+
+					while (index + 2 < input.length() && input[index] == '%') {
+						unsigned char b;
+						fromString(b, input.substr(index + 1, 2), 16);
+						thisOutput += (char) b;
+						index += 3;
+					}
+
+					int offset = 0;
+
+					while (offset >= 0 && offset != (int) thisOutput.length()) {
+						Character::getNextUtf8Safe(thisOutput, offset);
+					}
+
+					if (offset >= 0) {
+						output += thisOutput;
+					}
+
+					break;
+				}
+
+				default: {
+					output += input[index];
+					++index;
+					break;
+				}
+			}
+		}
+
+		return output;
+	}
+
+	// A query string typical of a search form submission.
+	static constexpr const char * query =
+		"q=balau+c%2B%2B+library&category=software&sort=relevance&page=2&per_page=50"
+		"&lang=en-GB&utm_source=newsletter&utm_medium=email&utm_campaign=release-2018";
+
+	// A form field value with a mixture of plain runs and percent encoded UTF-8.
+	static constexpr const char * value =
+		"utf-8+%c2%a9%c3%a7%e0%a6%88+characters+and+a+longer+run+of+plain+text+that+needs+no+decoding";
+
+	void split() {
+		std::vector<UrlDecode::Parameter> parameters;
+
+		Benchmark::run(
+			  "UrlDecode/split-flat"
+			, [&] () {
+				UrlDecode::split(query, parameters);
+				Benchmark::doNotOptimise(parameters.size());
+			}
+		);
+
+		Benchmark::run(
+			  "UrlDecode/split-map"
+			, [&] () {
+				Benchmark::doNotOptimise(UrlDecode::split(query).size());
+			}
+		);
+
+		Benchmark::run(
+			  "UrlDecode/previous-split"
+			, [&] () {
+				Benchmark::doNotOptimise(previousSplit(query).size());
+			}
+		);
+	}
+
+	void decode() {
+		const std::string input = value;
+		std::string buffer;
+		buffer.reserve(input.length());
+
+		Benchmark::run(
+			  "UrlDecode/decode-in-place"
+			, [&] () {
+				buffer.assign(input);
+				UrlDecode::decodeInPlace(buffer);
+				Benchmark::doNotOptimise(buffer.length());
+			}
+		);
+
+		Benchmark::run(
+			  "UrlDecode/decode"
+			, [&] () {
+				Benchmark::doNotOptimise(UrlDecode::decode(input).length());
+			}
+		);
+
+		Benchmark::run(
+			  "UrlDecode/previous-decode"
+			, [&] () {
+				Benchmark::doNotOptimise(previousDecode(input).length());
+			}
+		);
+	}
+};
+
+} // namespace Balau::Network
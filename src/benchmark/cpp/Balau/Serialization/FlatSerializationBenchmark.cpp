@@ -0,0 +1,101 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Benchmark.hpp>
+#include <Balau/Serialization/Marshallers.hpp>
+
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+namespace Balau::Serialization {
+
+//
+// Compares the encode + decode cost of the flat marshaller with the Boost
+// binary archive marshaller, for a message with nested and container fields.
+//
+struct FlatSerializationBenchmark : public Testing::TestGroup<FlatSerializationBenchmark> {
+	struct Message {
+		struct Point {
+			int x = 0;
+			int y = 0;
+
+			template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+				archive & BoostSerialization(x) & BoostSerialization(y);
+			}
+		};
+
+		std::string name;
+		long long timestamp = 0;
+		unsigned int count = 0;
+		double ratio = 0.0;
+		bool enabled = false;
+		std::vector<Point> points;
+		std::vector<char> bytes;
+		std::map<std::string, int> attributes;
+
+		template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+			archive
+				& BoostSerialization(name)
+				& BoostSerialization(timestamp)
+				& BoostSerialization(count)
+				& BoostSerialization(ratio)
+				& BoostSerialization(enabled)
+				& BoostSerialization(points)
+				& BoostSerialization(bytes)
+				& BoostSerialization(attributes);
+		}
+	};
+
+	FlatSerializationBenchmark() {
+		RegisterTestCase(encodeDecode);
+	}
+
+	template <typename MarshallerT> static void run(const std::string & name, const Message & message) {
+		std::vector<char> buffer;
+		Message decoded;
+
+		Benchmark::run(
+			  name
+			, [&] () {
+				buffer.clear();
+				MarshallerT::marshal(buffer, message);
+				MarshallerT::unmarshal(buffer.data(), buffer.size(), decoded);
+				Benchmark::doNotOptimise(decoded.count);
+			}
+		);
+	}
+
+	void encodeDecode() {
+		Message message;
+		message.name = "sensor.temperature";
+		message.timestamp = -1234567890123LL;
+		message.count = 300;
+		message.ratio = 0.25;
+		message.enabled = true;
+		message.points = { { 1, -1 }, { 1000000, -1000000 } };
+		message.bytes = { 'a', 'b', 'c' };
+		message.attributes = { { "a", 1 }, { "b", -2 } };
+
+		run<FlatMarshaller>("FlatSerialization/flat-encode-decode", message);
+		run<BoostArchiveMarshaller>("FlatSerialization/boost-encode-decode", message);
+	}
+};
+
+} // namespace Balau::Serialization
@@ -0,0 +1,99 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_BENCHMARK__BENCHMARK
+#define COM_BORA_SOFTWARE__BALAU_BENCHMARK__BENCHMARK
+
+#include <Balau/Testing/TestRunner.hpp>
+
+#include <chrono>
+#include <iostream>
+
+namespace Balau::Benchmark {
+
+//
+// The result of a single benchmark measurement.
+//
+struct Result {
+	std::string name;
+	size_t iterations;
+	double nanosecondsPerOperation;
+};
+
+//
+// Prevents the compiler from optimising away the computation of the supplied value.
+//
+template <typename T> inline void doNotOptimise(const T & value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//
+// Runs the supplied function repeatedly until the minimum duration has elapsed,
+// after an initial warm up run, and returns the mean time per call.
+//
+template <typename FunctionT>
+inline Result measure(const std::string & name,
+                      FunctionT function,
+                      std::chrono::nanoseconds minimumDuration = std::chrono::milliseconds(500)) {
+	function();
+
+	size_t batchSize = 1;
+	size_t iterations = 0;
+	std::chrono::nanoseconds elapsed(0);
+
+	while (elapsed < minimumDuration) {
+		const auto start = std::chrono::steady_clock::now();
+
+		for (size_t m = 0; m < batchSize; ++m) {
+			function();
+		}
+
+		elapsed += std::chrono::steady_clock::now() - start;
+		iterations += batchSize;
+		batchSize *= 2;
+	}
+
+	return Result { name, iterations, (double) elapsed.count() / (double) iterations };
+}
+
+//
+// Writes the result to standard output as a single tab delimited line.
+//
+// The lines are prefixed with "benchmark" so that they can be extracted from
+// the test runner output and compared between runs.
+//
+inline void report(const Result & result) {
+	std::cout << "benchmark\t" << result.name << "\t" << result.iterations << "\t" << result.nanosecondsPerOperation << "\n";
+}
+
+//
+// Measure and report.
+//
+template <typename FunctionT>
+inline Result run(const std::string & name,
+                  FunctionT function,
+                  std::chrono::nanoseconds minimumDuration = std::chrono::milliseconds(500)) {
+	auto result = measure(name, function, minimumDuration);
+	report(result);
+	return result;
+}
+
+} // namespace Balau::Benchmark
+
+#endif // COM_BORA_SOFTWARE__BALAU_BENCHMARK__BENCHMARK
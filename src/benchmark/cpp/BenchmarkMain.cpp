@@ -0,0 +1,32 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "Benchmark.hpp"
+
+//
+// Runs the Balau benchmarks.
+//
+// The benchmarks are test groups run by the test runner. The single threaded
+// execution model is used by default, so that the measurements do not interfere
+// with each other. Each measurement is written to standard output as a tab
+// delimited line starting with "benchmark".
+//
+int main(int argc, char * argv[]) {
+	return Balau::Testing::TestRunner::run(argc, argv);
+}
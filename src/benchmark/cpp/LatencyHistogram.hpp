@@ -0,0 +1,169 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_BENCHMARK__LATENCY_HISTOGRAM
+#define COM_BORA_SOFTWARE__BALAU_BENCHMARK__LATENCY_HISTOGRAM
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace Balau::Benchmark {
+
+//
+// A log-linear latency histogram, in the style of HdrHistogram.
+//
+// Values are recorded in nanoseconds. Values below 2048 are recorded exactly.
+// Larger values are recorded in buckets that have a relative width of 1/1024,
+// giving three significant decimal digits of precision across the entire range
+// (up to 2^41 nanoseconds, i.e. more than half an hour).
+//
+// Recording is a constant time operation. Histograms are not thread safe; each
+// thread should record into its own histogram, and the histograms are then
+// merged for reporting.
+//
+class LatencyHistogram final {
+	public: LatencyHistogram() : counts(BucketCount, 0) {}
+
+	//
+	// Record a latency value.
+	//
+	public: void record(std::chrono::nanoseconds latency) {
+		const auto value = (uint64_t) std::max<int64_t>(0, latency.count());
+		++counts[indexOf(value)];
+		++total;
+		sum += value;
+		maximum = std::max(maximum, value);
+		minimum = std::min(minimum, value);
+	}
+
+	//
+	// Add the values recorded in the supplied histogram to this histogram.
+	//
+	public: void merge(const LatencyHistogram & other) {
+		for (size_t index = 0; index < BucketCount; ++index) {
+			counts[index] += other.counts[index];
+		}
+
+		total += other.total;
+		sum += other.sum;
+		maximum = std::max(maximum, other.maximum);
+		minimum = std::min(minimum, other.minimum);
+	}
+
+	//
+	// Get the number of recorded values.
+	//
+	public: uint64_t count() const {
+		return total;
+	}
+
+	//
+	// Get the value at the specified percentile (0 to 100).
+	//
+	// The returned value is the highest value that is equivalent to the recorded
+	// values at the percentile, within the precision of the histogram.
+	//
+	public: std::chrono::nanoseconds percentile(double percentile) const {
+		if (total == 0) {
+			return std::chrono::nanoseconds(0);
+		}
+
+		const auto clamped = std::min(100.0, std::max(0.0, percentile));
+		const auto target = std::max<uint64_t>(1, (uint64_t) std::ceil(clamped / 100.0 * (double) total));
+		uint64_t cumulative = 0;
+
+		for (size_t index = 0; index < BucketCount; ++index) {
+			cumulative += counts[index];
+
+			if (cumulative >= target) {
+				// The last bucket also contains the values that are beyond the range of the histogram.
+				const auto value = index == BucketCount - 1 ? maximum : std::min(highestEquivalentValue(index), maximum);
+				return std::chrono::nanoseconds((int64_t) value);
+			}
+		}
+
+		return std::chrono::nanoseconds((int64_t) maximum);
+	}
+
+	//
+	// Get the maximum recorded value.
+	//
+	public: std::chrono::nanoseconds max() const {
+		return std::chrono::nanoseconds((int64_t) maximum);
+	}
+
+	//
+	// Get the minimum recorded value.
+	//
+	public: std::chrono::nanoseconds min() const {
+		return std::chrono::nanoseconds(total == 0 ? 0 : (int64_t) minimum);
+	}
+
+	//
+	// Get the mean of the recorded values.
+	//
+	public: double mean() const {
+		return total == 0 ? 0.0 : (double) sum / (double) total;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static constexpr unsigned SubBucketBits = 11;
+	private: static constexpr uint64_t SubBucketCount = 1U << SubBucketBits;
+	private: static constexpr uint64_t SubBucketHalfCount = SubBucketCount / 2;
+	private: static constexpr unsigned MaximumShift = 30;
+	private: static constexpr size_t BucketCount = SubBucketCount + MaximumShift * SubBucketHalfCount;
+
+	private: static size_t indexOf(uint64_t value) {
+		if (value < SubBucketCount) {
+			return (size_t) value;
+		}
+
+		const auto shift = std::min<unsigned>(MaximumShift, (unsigned) (63 - __builtin_clzll(value)) - (SubBucketBits - 1));
+
+		if (shift == MaximumShift && (value >> shift) >= SubBucketCount) {
+			return BucketCount - 1;
+		}
+
+		return (size_t) (SubBucketCount + (shift - 1) * SubBucketHalfCount + ((value >> shift) - SubBucketHalfCount));
+	}
+
+	private: static uint64_t highestEquivalentValue(size_t index) {
+		if (index < SubBucketCount) {
+			return index;
+		}
+
+		const auto shift = (unsigned) ((index - SubBucketCount) / SubBucketHalfCount + 1);
+		const auto subBucket = (index - SubBucketCount) % SubBucketHalfCount + SubBucketHalfCount;
+		return ((subBucket + 1) << shift) - 1;
+	}
+
+	private: std::vector<uint64_t> counts;
+	private: uint64_t total = 0;
+	private: uint64_t sum = 0;
+	private: uint64_t maximum = 0;
+	private: uint64_t minimum = UINT64_MAX;
+};
+
+} // namespace Balau::Benchmark
+
+#endif // COM_BORA_SOFTWARE__BALAU_BENCHMARK__LATENCY_HISTOGRAM
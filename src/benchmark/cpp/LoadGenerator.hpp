@@ -0,0 +1,357 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_BENCHMARK__LOAD_GENERATOR
+#define COM_BORA_SOFTWARE__BALAU_BENCHMARK__LOAD_GENERATOR
+
+#include <LatencyHistogram.hpp>
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <boost/asio/connect.hpp>
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace Balau::Benchmark {
+
+//
+// A client connection used by the load generator.
+//
+// Each connection is used by a single load generator thread.
+//
+class LoadConnection {
+	public: virtual ~LoadConnection() = default;
+
+	//
+	// Perform a single request/response round trip.
+	//
+	// @throw std::exception if the round trip failed; the connection is then discarded
+	//
+	public: virtual void roundTrip() = 0;
+};
+
+//
+// Creates a new connection to the server under test.
+//
+using LoadConnectionFactory = std::function<std::unique_ptr<LoadConnection> ()>;
+
+//
+// A keep-alive HTTP/1.1 connection that performs GET requests for a single path.
+//
+class HttpGetConnection : public LoadConnection {
+	public: HttpGetConnection(const std::string & host, unsigned short port, std::string path)
+		: socket(ioContext) {
+		Network::TCP::resolver resolver(ioContext);
+		auto results = resolver.resolve(host, ::toString(port));
+		boost::asio::connect(socket, results.begin(), results.end());
+
+		request.method(Network::Method::get);
+		request.target(path);
+		request.version(11);
+		request.set(Network::Field::host, host);
+		request.keep_alive(true);
+	}
+
+	public: ~HttpGetConnection() override {
+		boost::system::error_code ignored;
+		socket.shutdown(Network::TCP::socket::shutdown_both, ignored);
+	}
+
+	public: void roundTrip() override {
+		Network::HTTP::write(socket, request);
+
+		Network::StringResponse response;
+		Network::HTTP::read(socket, buffer, response);
+
+		if (response.result() != Network::Status::ok) {
+			ThrowBalauException(
+				Exception::NetworkException, ::toString("Unexpected response status: ", response.result_int())
+			);
+		}
+
+		if (!response.keep_alive()) {
+			ThrowBalauException(Exception::NetworkException, "The server closed the connection.");
+		}
+	}
+
+	private: boost::asio::io_context ioContext;
+	private: Network::TCP::socket socket;
+	private: Network::Buffer buffer;
+	private: Network::Request<Network::EmptyBody> request;
+};
+
+//
+// A WebSocket connection that sends a text message and waits for the echoed message.
+//
+class WsEchoConnection : public LoadConnection {
+	public: WsEchoConnection(const std::string & host, unsigned short port, const std::string & path, std::string payload_)
+		: ws(ioContext)
+		, payload(std::move(payload_)) {
+		Network::TCP::resolver resolver(ioContext);
+		auto results = resolver.resolve(host, ::toString(port));
+		boost::asio::connect(ws.next_layer(), results.begin(), results.end());
+		ws.handshake(host, path);
+		ws.text(true);
+	}
+
+	public: ~WsEchoConnection() override {
+		boost::system::error_code ignored;
+		ws.close(Network::WS::close_code::normal, ignored);
+	}
+
+	public: void roundTrip() override {
+		ws.write(boost::asio::buffer(payload));
+		buffer.consume(buffer.size());
+		ws.read(buffer);
+
+		if (buffer.size() != payload.size()) {
+			ThrowBalauException(Exception::NetworkException, "Unexpected echo message size.");
+		}
+	}
+
+	private: boost::asio::io_context ioContext;
+	private: Network::WS::stream<Network::TCP::socket> ws;
+	private: Network::Buffer buffer;
+	private: const std::string payload;
+};
+
+//
+// The parameters of a load test run.
+//
+struct LoadOptions {
+	//
+	// The name of the scenario, used in the report.
+	//
+	std::string name;
+
+	//
+	// The number of concurrent connections, each of which is driven by its own thread.
+	//
+	size_t connections = 1;
+
+	//
+	// The total target request rate for open loop runs, or zero for closed loop runs.
+	//
+	// Closed loop runs send the next request on each connection as soon as the
+	// previous response is received, thus measuring the maximum throughput.
+	// Open loop runs send requests at a constant rate, independently of the
+	// response times, thus measuring the latency at a given load.
+	//
+	double requestsPerSecond = 0;
+
+	//
+	// The duration of the warm up phase, during which nothing is recorded.
+	//
+	std::chrono::nanoseconds warmUp = std::chrono::milliseconds(500);
+
+	//
+	// The duration of the measurement phase.
+	//
+	std::chrono::nanoseconds duration = std::chrono::seconds(2);
+};
+
+//
+// The result of a load test run.
+//
+struct LoadResult {
+	std::string name;
+	std::string mode;
+	size_t connections;
+	double targetRequestsPerSecond;
+	uint64_t requests;
+	uint64_t errors;
+	std::chrono::nanoseconds elapsed;
+	LatencyHistogram latencies;
+
+	double requestsPerSecond() const {
+		return elapsed.count() == 0 ? 0.0 : (double) requests * 1e9 / (double) elapsed.count();
+	}
+};
+
+//
+// Runs a load test against a server with connections created by the supplied factory.
+//
+// In open loop runs, the latency of each request is measured from the time at
+// which the request was scheduled to be sent, rather than from the time at which
+// it was actually sent. Queueing delays caused by a slow server are thus included
+// in the measured latencies (i.e. coordinated omission is avoided).
+//
+inline LoadResult runLoad(const LoadOptions & options, const LoadConnectionFactory & factory) {
+	using Clock = std::chrono::steady_clock;
+
+	const bool openLoop = options.requestsPerSecond > 0;
+
+	const auto interval = openLoop
+		? std::chrono::nanoseconds((int64_t) (1e9 * (double) options.connections / options.requestsPerSecond))
+		: std::chrono::nanoseconds(0);
+
+	struct Worker {
+		LatencyHistogram latencies;
+		uint64_t requests = 0;
+		uint64_t errors = 0;
+		Clock::time_point finished;
+	};
+
+	std::vector<Worker> workers(options.connections);
+	std::vector<std::thread> threads;
+	std::atomic<size_t> ready { 0 };
+	std::atomic<bool> go { false };
+	Clock::time_point start;
+
+	for (size_t m = 0; m < options.connections; ++m) {
+		threads.emplace_back([&, m] () {
+			auto & worker = workers[m];
+			std::unique_ptr<LoadConnection> connection;
+
+			try {
+				connection = factory();
+			} catch (...) {
+				++worker.errors;
+			}
+
+			++ready;
+
+			while (!go.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+
+			const auto measureStart = start + options.warmUp;
+			const auto end = measureStart + options.duration;
+
+			// Spread the open loop schedules of the connections evenly across the interval.
+			Clock::time_point scheduled = start + interval * (int64_t) m / (int64_t) options.connections;
+
+			while (true) {
+				if (openLoop) {
+					std::this_thread::sleep_until(scheduled);
+				}
+
+				const auto sent = openLoop ? scheduled : Clock::now();
+
+				if (sent >= end) {
+					break;
+				}
+
+				bool success = false;
+
+				try {
+					if (!connection) {
+						connection = factory();
+					}
+
+					connection->roundTrip();
+					success = true;
+				} catch (...) {
+					connection.reset();
+				}
+
+				const auto received = Clock::now();
+
+				if (sent >= measureStart) {
+					if (success) {
+						worker.latencies.record(received - sent);
+						++worker.requests;
+					} else {
+						++worker.errors;
+					}
+				}
+
+				scheduled += interval;
+			}
+
+			worker.finished = Clock::now();
+		});
+	}
+
+	while (ready.load() < options.connections) {
+		std::this_thread::yield();
+	}
+
+	start = Clock::now();
+	go.store(true, std::memory_order_release);
+
+	for (auto & thread : threads) {
+		thread.join();
+	}
+
+	LoadResult result {
+		  options.name
+		, openLoop ? "open" : "closed"
+		, options.connections
+		, options.requestsPerSecond
+		, 0
+		, 0
+		, std::chrono::duration_cast<std::chrono::nanoseconds>(options.duration)
+		, LatencyHistogram()
+	};
+
+	for (const auto & worker : workers) {
+		result.latencies.merge(worker.latencies);
+		result.requests += worker.requests;
+		result.errors += worker.errors;
+
+		// Requests that were delayed by an overloaded server complete after the end of the measurement phase.
+		result.elapsed = std::max(
+			result.elapsed, std::chrono::duration_cast<std::chrono::nanoseconds>(worker.finished - start - options.warmUp)
+		);
+	}
+
+	return result;
+}
+
+//
+// Writes the load test result to standard output as a single tab delimited line.
+//
+// The fields are: "load", name, mode (open or closed), connections, target
+// requests per second (zero for closed loop runs), completed requests, errors,
+// achieved requests per second, and the p50, p99, p99.9 and maximum latencies
+// in microseconds.
+//
+inline void report(const LoadResult & result) {
+	const auto micros = [] (std::chrono::nanoseconds value) { return (double) value.count() / 1000.0; };
+
+	std::cout << "load"
+		<< "\t" << result.name
+		<< "\t" << result.mode
+		<< "\t" << result.connections
+		<< "\t" << result.targetRequestsPerSecond
+		<< "\t" << result.requests
+		<< "\t" << result.errors
+		<< "\t" << result.requestsPerSecond()
+		<< "\t" << micros(result.latencies.percentile(50.0))
+		<< "\t" << micros(result.latencies.percentile(99.0))
+		<< "\t" << micros(result.latencies.percentile(99.9))
+		<< "\t" << micros(result.latencies.max())
+		<< "\n";
+}
+
+//
+// Run a load test and report the result.
+//
+inline LoadResult runLoadAndReport(const LoadOptions & options, const LoadConnectionFactory & factory) {
+	auto result = runLoad(options, factory);
+	report(result);
+	return result;
+}
+
+} // namespace Balau::Benchmark
+
+#endif // COM_BORA_SOFTWARE__BALAU_BENCHMARK__LOAD_GENERATOR
@@ -0,0 +1,269 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__FUTEX
+#define COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__FUTEX
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+namespace Balau::Concurrent::Impl {
+
+//
+// The visibility of a futex word.
+//
+enum class FutexScope {
+	// The word is only accessed by the threads of the current process.
+	Private
+
+	// The word may be located in shared memory and accessed by multiple processes.
+	, Shared
+};
+
+//
+// Futex operations on a 32 bit atomic word.
+//
+// Private futexes use the FUTEX_PRIVATE_FLAG operations, which allow the
+// kernel to skip the shared mapping lookup on each wait and wake. Shared
+// futexes use the non-private operations, as the word may be located in
+// shared memory. On platforms without futexes, waiting degrades to polling
+// the word with short sleeps.
+//
+template <FutexScope Scope> class BasicFutex final {
+	//
+	// Wait until the word no longer contains the expected value or a wake is issued.
+	//
+	// Spurious wake ups may occur, thus the caller must recheck its condition.
+	//
+	public: static void wait(std::atomic<uint32_t> & word, uint32_t expected) {
+		#ifdef __linux__
+			syscall(SYS_futex, address(word), WaitOperation, expected, nullptr, nullptr, 0);
+		#else
+			while (word.load(std::memory_order_acquire) == expected) {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		#endif
+	}
+
+	//
+	// Wait until the word no longer contains the expected value, a wake is
+	// issued, or the timeout expires.
+	//
+	// Spurious wake ups may occur, thus the caller must recheck its condition.
+	//
+	public: static void wait(std::atomic<uint32_t> & word, uint32_t expected, std::chrono::nanoseconds timeout) {
+		if (timeout.count() <= 0) {
+			return;
+		}
+
+		#ifdef __linux__
+			timespec ts {};
+			ts.tv_sec = (time_t) (timeout.count() / 1000000000LL);
+			ts.tv_nsec = (long) (timeout.count() % 1000000000LL);
+			syscall(SYS_futex, address(word), WaitOperation, expected, &ts, nullptr, 0);
+		#else
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+			while (word.load(std::memory_order_acquire) == expected && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		#endif
+	}
+
+	//
+	// Wake up to count waiters on the word.
+	//
+	public: static void wake(std::atomic<uint32_t> & word, int count = INT_MAX) {
+		#ifdef __linux__
+			syscall(SYS_futex, address(word), WakeOperation, count, nullptr, nullptr, 0);
+		#else
+			(void) word;
+			(void) count;
+		#endif
+	}
+
+	//
+	// Hint to the processor that the caller is in a spin wait loop.
+	//
+	public: static void pause() {
+		#if defined(__x86_64__) || defined(__i386__)
+			_mm_pause();
+		#else
+			std::this_thread::yield();
+		#endif
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	public: BasicFutex() = delete;
+	public: BasicFutex(const BasicFutex &) = delete;
+	public: BasicFutex & operator = (const BasicFutex &) = delete;
+
+	#ifdef __linux__
+		private: static constexpr int WaitOperation =
+			Scope == FutexScope::Private ? FUTEX_WAIT_PRIVATE : FUTEX_WAIT;
+
+		private: static constexpr int WakeOperation =
+			Scope == FutexScope::Private ? FUTEX_WAKE_PRIVATE : FUTEX_WAKE;
+	#endif
+
+	private: static uint32_t * address(std::atomic<uint32_t> & word) {
+		static_assert(
+			sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free
+			, "Futex words must be lock free 32 bit atomics."
+		);
+
+		return reinterpret_cast<uint32_t *>(&word);
+	}
+};
+
+//
+// Futex operations on words accessed by the threads of the current process.
+//
+using Futex = BasicFutex<FutexScope::Private>;
+
+//
+// Futex operations on words that may be located in shared memory.
+//
+using SharedFutex = BasicFutex<FutexScope::Shared>;
+
+//
+// An event count, used to park threads waiting for a condition that is
+// published via atomic state outside of the event count.
+//
+// The notifying side only touches the futex when a waiter has parked since the
+// previous wake, thus uncontended operations and repeated notifications whilst
+// woken waiters are yet to run do not enter the kernel. Each wake releases all
+// parked waiters, which then recheck their conditions.
+//
+// Shared event counts are placed into shared memory, thus the structure must
+// remain trivially destructible and free of pointers. It is padded to the size of a cache line
+// but does not require cache line alignment, as managed shared memory segments
+// only guarantee the alignment of fundamental types. Owners that control their
+// layout align their event count members to a cache line.
+//
+template <FutexScope Scope> struct BasicEventCount {
+	std::atomic<uint32_t> epoch { 0 };
+	std::atomic<uint32_t> waiters { 0 };
+
+	// Set by a waiter after reading the epoch, and cleared by the notifier that advances the epoch.
+	std::atomic<uint32_t> armed { 0 };
+
+	char padding[64 - 3 * sizeof(std::atomic<uint32_t>)];
+
+	//
+	// Wake parked waiters after the condition has been published.
+	//
+	void notify() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (waiters.load(std::memory_order_relaxed) != 0 && armed.exchange(0, std::memory_order_seq_cst) != 0) {
+			epoch.fetch_add(1, std::memory_order_seq_cst);
+			BasicFutex<Scope>::wake(epoch);
+		}
+	}
+
+	//
+	// Spin on the condition and then park until it becomes true.
+	//
+	template <typename ConditionT> void await(ConditionT condition, unsigned int spinCount) {
+		await(condition, spinCount, std::chrono::steady_clock::time_point::max());
+	}
+
+	//
+	// Spin on the condition and then park until it becomes true or the deadline expires.
+	//
+	// @return true if the condition became true, false on timeout
+	//
+	template <typename ConditionT>
+	bool await(ConditionT condition, unsigned int spinCount, std::chrono::steady_clock::time_point deadline) {
+		for (unsigned int m = 0; m < spinCount; ++m) {
+			if (condition()) {
+				return true;
+			}
+
+			BasicFutex<Scope>::pause();
+		}
+
+		const bool timed = deadline != std::chrono::steady_clock::time_point::max();
+
+		while (true) {
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			const uint32_t e = epoch.load(std::memory_order_seq_cst);
+
+			// Arming after reading the epoch ensures that the notifier which clears
+			// the flag advances the epoch after this waiter has read it.
+			armed.store(1, std::memory_order_seq_cst);
+
+			if (condition()) {
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			if (timed) {
+				const auto remaining = deadline - std::chrono::steady_clock::now();
+
+				if (remaining.count() <= 0) {
+					waiters.fetch_sub(1, std::memory_order_relaxed);
+					return false;
+				}
+
+				BasicFutex<Scope>::wait(epoch, e, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+			} else {
+				BasicFutex<Scope>::wait(epoch, e);
+			}
+
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			if (condition()) {
+				return true;
+			}
+		}
+	}
+};
+
+//
+// An event count used by the threads of the current process.
+//
+using EventCount = BasicEventCount<FutexScope::Private>;
+
+//
+// An event count that may be located in shared memory.
+//
+using SharedEventCount = BasicEventCount<FutexScope::Shared>;
+
+static_assert(sizeof(EventCount) == 64, "EventCount must occupy a single cache line.");
+static_assert(sizeof(SharedEventCount) == 64, "SharedEventCount must occupy a single cache line.");
+
+} // namespace Balau::Concurrent::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__FUTEX
@@ -0,0 +1,176 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+
+#ifndef COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__WORK_STEALING_DEQUE
+#define COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__WORK_STEALING_DEQUE
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Balau::Concurrent::Impl {
+
+//
+// Chase-Lev work stealing deque of pointers, using the memory orderings
+// described by Lê, Pop, Cohen and Zappa Nardelli (PPoPP 2013).
+//
+// The owning thread pushes and takes at the bottom, whilst other threads
+// steal from the top. Only the owning thread grows the array. Arrays that
+// have been replaced are retained until the deque is destroyed, as stealers
+// may still be reading from them.
+//
+template <typename T> class WorkStealingDeque final {
+	public: explicit WorkStealingDeque(size_t initialCapacity = 256) {
+		size_t capacity = 2;
+
+		while (capacity < initialCapacity) {
+			capacity <<= 1;
+		}
+
+		arrays.emplace_back(new Array(capacity));
+		array.store(arrays.back().get(), std::memory_order_relaxed);
+	}
+
+	public: WorkStealingDeque(const WorkStealingDeque &) = delete;
+	public: WorkStealingDeque & operator = (const WorkStealingDeque &) = delete;
+
+	//
+	// Push an element onto the bottom of the deque (owner only).
+	//
+	public: void push(T * element) {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		Array * a = array.load(std::memory_order_relaxed);
+
+		if (b - t > (int64_t) a->capacity - 1) {
+			a = grow(a, t, b);
+		}
+
+		a->put(b, element);
+
+		// Publishes the element to stealers, which acquire the bottom index.
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	//
+	// Take an element from the bottom of the deque (owner only).
+	//
+	// @return the element or nullptr if the deque is empty
+	//
+	public: T * take() {
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Array * a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T * element = a->get(b);
+
+		if (t == b) {
+			// Last element, race against the stealers.
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				element = nullptr;
+			}
+
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		return element;
+	}
+
+	//
+	// Steal an element from the top of the deque (any thread).
+	//
+	// @return the element or nullptr if the deque is empty or the steal lost a race
+	//
+	public: T * steal() {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b) {
+			return nullptr;
+		}
+
+		Array * a = array.load(std::memory_order_acquire);
+		T * element = a->get(t);
+
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		return element;
+	}
+
+	//
+	// Approximate emptiness check, suitable for heuristics only.
+	//
+	public: bool empty() const {
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: struct Array {
+		const size_t capacity;
+		const size_t mask;
+		std::unique_ptr<std::atomic<T *>[]> slots;
+
+		explicit Array(size_t capacity_)
+			: capacity(capacity_)
+			, mask(capacity_ - 1)
+			, slots(new std::atomic<T *>[capacity_]) {}
+
+		T * get(int64_t index) const {
+			return slots[(size_t) index & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T * element) {
+			slots[(size_t) index & mask].store(element, std::memory_order_relaxed);
+		}
+	};
+
+	private: Array * grow(Array * a, int64_t t, int64_t b) {
+		arrays.emplace_back(new Array(a->capacity * 2));
+		Array * replacement = arrays.back().get();
+
+		for (int64_t m = t; m < b; ++m) {
+			replacement->put(m, a->get(m));
+		}
+
+		array.store(replacement, std::memory_order_release);
+		return replacement;
+	}
+
+	private: alignas(64) std::atomic<int64_t> top { 0 };
+	private: alignas(64) std::atomic<int64_t> bottom { 0 };
+	private: alignas(64) std::atomic<Array *> array { nullptr };
+	private: std::vector<std::unique_ptr<Array>> arrays;
+};
+
+} // namespace Balau::Concurrent::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_CONCURRENT_IMPL__WORK_STEALING_DEQUE
@@ -0,0 +1,632 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file ThreadPool.hpp
+///
+/// A work stealing thread pool with fork/join support.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_CONCURRENT__THREAD_POOL
+#define COM_BORA_SOFTWARE__BALAU_CONCURRENT__THREAD_POOL
+
+#include <Balau/Application/Injectable.hpp>
+#include <Balau/Concurrent/Impl/Futex.hpp>
+#include <Balau/Concurrent/Impl/WorkStealingDeque.hpp>
+#include <Balau/Logging/Logger.hpp>
+#include <Balau/System/ThreadName.hpp>
+#include <Balau/Type/ToString.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace Balau::Concurrent {
+
+///
+/// A work stealing thread pool with fork/join support.
+///
+/// Each worker thread owns a Chase-Lev deque. Tasks submitted from a worker
+/// thread are pushed onto the bottom of that worker's deque and are executed
+/// in LIFO order by the worker, whilst idle workers steal from the top of other
+/// workers' deques. Tasks submitted from outside the pool are placed on a
+/// global injection queue. Workers that find no work spin briefly and then park
+/// on their own futex word. Submitting a task wakes a single parked worker, and
+/// only enters the kernel when a worker is parked.
+///
+/// The parallelFor and parallelInvoke calls split work into fork/join tasks.
+/// The calling thread executes queued tasks whilst waiting for the join, thus
+/// these calls may be nested inside tasks without exhausting the workers.
+///
+/// The pool is injectable. The worker count and the thread pinning flag are
+/// obtained from the "balau.threadPool.workerCount" and "balau.threadPool.pinWorkers"
+/// named value bindings. Applications should bind the pool as a singleton, in
+/// order to share a single pool sized to the available cores:
+///
+/// @code
+/// bind<size_t>("balau.threadPool.workerCount").toValue(0);
+/// bind<bool>("balau.threadPool.pinWorkers").toValue(false);
+/// bind<Concurrent::ThreadPool>().toSingleton();
+/// @endcode
+///
+/// The destructor executes all tasks that have already been submitted before
+/// stopping the workers.
+///
+class ThreadPool final {
+	BalauInjectNamedTypes(
+		  ThreadPool
+		, size_t, "balau.threadPool.workerCount"
+		, bool,   "balau.threadPool.pinWorkers"
+	)
+
+	///
+	/// Create a thread pool.
+	///
+	/// @param workerCount_ the number of worker threads, or zero for the hardware concurrency
+	/// @param pinWorkers if true, worker threads are pinned to CPUs in a round robin manner (Linux only)
+	///
+	public: explicit ThreadPool(size_t workerCount_ = 0, bool pinWorkers = false)
+		: workerCount(workerCount_ != 0 ? workerCount_ : hardwareConcurrency()) {
+		workers.reserve(workerCount);
+
+		for (size_t m = 0; m < workerCount; ++m) {
+			workers.emplace_back(new Worker(*this, m));
+		}
+
+		for (size_t m = 0; m < workerCount; ++m) {
+			workers[m]->thread = std::thread(&ThreadPool::workerLoop, this, workers[m].get());
+
+			if (pinWorkers) {
+				pin(*workers[m], m);
+			}
+		}
+	}
+
+	public: ThreadPool(const ThreadPool &) = delete;
+	public: ThreadPool & operator = (const ThreadPool &) = delete;
+
+	///
+	/// Execute the tasks that have been submitted and then stop the worker threads.
+	///
+	public: ~ThreadPool() {
+		stopping.store(true, std::memory_order_seq_cst);
+		wakeAllWorkers();
+
+		for (auto & worker : workers) {
+			worker->thread.join();
+		}
+	}
+
+	///
+	/// Get the number of worker threads in the pool.
+	///
+	public: size_t getWorkerCount() const {
+		return workerCount;
+	}
+
+	///
+	/// Returns true if the calling thread is one of this pool's worker threads.
+	///
+	public: bool isWorkerThread() const {
+		const Worker * worker = currentWorker();
+		return worker != nullptr && &worker->pool == this;
+	}
+
+	///
+	/// Submit a task for execution.
+	///
+	/// The supplied arguments are copied or moved into the task.
+	///
+	/// @return a future that provides the task's result or exception
+	///
+	public: template <typename FunctionT, typename ... ArgsT>
+	auto submit(FunctionT && function, ArgsT && ... args)
+		-> std::future<std::invoke_result_t<std::decay_t<FunctionT>, std::decay_t<ArgsT> ...>> {
+		using ResultT = std::invoke_result_t<std::decay_t<FunctionT>, std::decay_t<ArgsT> ...>;
+
+		std::packaged_task<ResultT ()> task(
+			[f = std::forward<FunctionT>(function), a = std::make_tuple(std::forward<ArgsT>(args) ...)] () mutable {
+				return std::apply(std::move(f), std::move(a));
+			}
+		);
+
+		auto future = task.get_future();
+		schedule(std::move(task));
+		return future;
+	}
+
+	///
+	/// Submit a task for execution without obtaining a future.
+	///
+	/// Exceptions thrown by the task are discarded.
+	///
+	public: template <typename FunctionT> void execute(FunctionT && function) {
+		schedule(
+			[f = std::forward<FunctionT>(function)] () mutable {
+				try {
+					f();
+				} catch (...) {
+					// Discarded.
+				}
+			}
+		);
+	}
+
+	///
+	/// Call the function for each index in the range [begin, end) in parallel, and wait for completion.
+	///
+	/// The range is recursively split in half until the chunks are no larger
+	/// than the grain size. If the grain size is zero, a grain size that results
+	/// in approximately four chunks per worker is used.
+	///
+	/// If one or more calls throw an exception, the first exception is rethrown
+	/// after all chunks have completed.
+	///
+	public: template <typename IndexT, typename FunctionT>
+	void parallelFor(IndexT begin, IndexT end, FunctionT && function, size_t grainSize = 0) {
+		static_assert(std::is_integral_v<IndexT>, "parallelFor requires an integral index type.");
+
+		if (end <= begin) {
+			return;
+		}
+
+		const auto count = (size_t) (end - begin);
+
+		if (grainSize == 0) {
+			grainSize = std::max((size_t) 1, count / (workerCount * 4));
+		}
+
+		JoinGroup group;
+		invokeInGroup(group, [&] () { splitRange(group, begin, end, grainSize, function); });
+		join(group);
+	}
+
+	///
+	/// Call the functions in parallel, and wait for completion.
+	///
+	/// The first function is called on the calling thread.
+	///
+	/// If one or more functions throw an exception, the first exception is
+	/// rethrown after all functions have completed.
+	///
+	public: template <typename FirstT, typename ... RestT>
+	void parallelInvoke(FirstT && first, RestT && ... rest) {
+		JoinGroup group;
+		(fork(group, [&rest] () { rest(); }), ...);
+		invokeInGroup(group, first);
+		join(group);
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: static constexpr unsigned int SpinCount = 64;
+
+	private: class Task {
+		public: virtual ~Task() = default;
+		public: virtual void run() = 0;
+	};
+
+	private: template <typename FunctionT> class FunctionTask final : public Task {
+		public: explicit FunctionTask(FunctionT && function_) : function(std::move(function_)) {}
+		public: void run() override { function(); }
+		private: FunctionT function;
+	};
+
+	private: struct Worker {
+		ThreadPool & pool;
+		const size_t index;
+		Impl::WorkStealingDeque<Task> deque;
+		std::thread thread;
+		uint64_t randomState;
+		std::atomic<uint32_t> wakeSignal { 0 }; // Futex word on which the worker parks.
+
+		Worker(ThreadPool & pool_, size_t index_)
+			: pool(pool_)
+			, index(index_)
+			, randomState(0x9E3779B97F4A7C15ULL * (index_ + 1)) {}
+	};
+
+	// Set in the pending count of a join group when the joining thread is asleep.
+	private: static constexpr uint32_t JoinWaiting = 0x80000000U;
+
+	// Completion state of a set of forked tasks.
+	//
+	// The pending count is the futex word on which the joining thread sleeps.
+	//
+	private: struct JoinGroup {
+		std::atomic<uint32_t> pending { 0 };
+		std::mutex mutex;
+		std::exception_ptr exception;
+	};
+
+	private: static size_t hardwareConcurrency() {
+		const size_t concurrency = std::thread::hardware_concurrency();
+		return concurrency != 0 ? concurrency : 1;
+	}
+
+	private: static Worker *& currentWorker() {
+		thread_local Worker * worker = nullptr;
+		return worker;
+	}
+
+	private: static Logger & log() {
+		static Logger & logger = Logger::getLogger("balau.concurrent");
+		return logger;
+	}
+
+	// Pin the worker to a CPU in the affinity mask of the process, selected in a round robin manner.
+	private: static void pin(Worker & worker, size_t index) {
+		#ifdef __linux__
+			cpu_set_t allowed;
+			CPU_ZERO(&allowed);
+
+			if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+				BalauLogWarn(log(), "Thread pool worker {} not pinned: failed to get the process CPU affinity (errno {}).", index, errno);
+				return;
+			}
+
+			const auto allowedCount = (size_t) CPU_COUNT(&allowed);
+			size_t seen = 0;
+			int cpu = 0;
+
+			while (cpu < CPU_SETSIZE && !(CPU_ISSET(cpu, &allowed) && seen++ == index % allowedCount)) {
+				++cpu;
+			}
+
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(cpu, &cpus);
+
+			const int result = pthread_setaffinity_np(worker.thread.native_handle(), sizeof(cpu_set_t), &cpus);
+
+			if (result != 0) {
+				BalauLogWarn(log(), "Thread pool worker {} not pinned: failed to set the affinity to CPU {} (error {}).", index, cpu, result);
+			}
+		#else
+			(void) worker;
+			(void) index;
+		#endif
+	}
+
+	private: template <typename FunctionT> void schedule(FunctionT && function) {
+		Task * task = new FunctionTask<std::decay_t<FunctionT>>(std::forward<FunctionT>(function));
+		Worker * worker = ownWorker();
+
+		if (worker != nullptr) {
+			worker->deque.push(task);
+		} else {
+			std::lock_guard<std::mutex> lock(injectionMutex);
+			injectionQueue.push_back(task);
+			injectionSize.store(injectionQueue.size(), std::memory_order_relaxed);
+		}
+
+		wakeWorker();
+	}
+
+	// Wake a single parked worker, if there is one.
+	//
+	// The fence pairs with the fence in park. Either the parking worker sees the
+	// published task, or this call sees the parked worker.
+	//
+	private: void wakeWorker() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (parkedCount.load(std::memory_order_relaxed) == 0) {
+			return;
+		}
+
+		Worker * worker;
+
+		{
+			std::lock_guard<std::mutex> lock(parkingMutex);
+
+			if (parkedWorkers.empty()) {
+				return;
+			}
+
+			worker = parkedWorkers.back();
+			parkedWorkers.pop_back();
+			parkedCount.store(parkedWorkers.size(), std::memory_order_relaxed);
+		}
+
+		signal(*worker);
+	}
+
+	private: void wakeAllWorkers() {
+		std::vector<Worker *> woken;
+
+		{
+			std::lock_guard<std::mutex> lock(parkingMutex);
+			woken.swap(parkedWorkers);
+			parkedCount.store(0, std::memory_order_relaxed);
+		}
+
+		for (Worker * worker : woken) {
+			signal(*worker);
+		}
+	}
+
+	private: static void signal(Worker & worker) {
+		worker.wakeSignal.store(1, std::memory_order_release);
+		Impl::Futex::wake(worker.wakeSignal, 1);
+	}
+
+	// Park the worker until it is woken by a submission or by the destructor.
+	private: void park(Worker & worker) {
+		worker.wakeSignal.store(0, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(parkingMutex);
+			parkedWorkers.push_back(&worker);
+			parkedCount.store(parkedWorkers.size(), std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (hasWork() || stopping.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> lock(parkingMutex);
+			auto iterator = std::find(parkedWorkers.begin(), parkedWorkers.end(), &worker);
+
+			// If the worker is no longer in the list, it has already been woken.
+			if (iterator != parkedWorkers.end()) {
+				parkedWorkers.erase(iterator);
+				parkedCount.store(parkedWorkers.size(), std::memory_order_relaxed);
+			}
+
+			return;
+		}
+
+		while (worker.wakeSignal.load(std::memory_order_acquire) == 0) {
+			Impl::Futex::wait(worker.wakeSignal, 0);
+		}
+	}
+
+	// Returns true if any worker deque or the injection queue appears to contain a task.
+	private: bool hasWork() const {
+		for (const auto & worker : workers) {
+			if (!worker->deque.empty()) {
+				return true;
+			}
+		}
+
+		return injectionSize.load(std::memory_order_relaxed) != 0;
+	}
+
+	// Spin for a short while, waiting for work or for the condition to become true.
+	//
+	// @return true if the condition became true
+	//
+	private: template <typename ConditionT> bool spin(ConditionT condition) const {
+		for (unsigned int m = 0; m < SpinCount; ++m) {
+			if (condition()) {
+				return true;
+			}
+
+			if (hasWork()) {
+				return false;
+			}
+
+			Impl::Futex::pause();
+		}
+
+		return condition();
+	}
+
+	// The current thread's worker if the current thread belongs to this pool.
+	private: Worker * ownWorker() const {
+		Worker * worker = currentWorker();
+		return worker != nullptr && &worker->pool == this ? worker : nullptr;
+	}
+
+	private: Task * findTask(Worker * worker) {
+		Task * task = worker != nullptr ? worker->deque.take() : nullptr;
+
+		if (task == nullptr) {
+			task = pollInjectionQueue();
+		}
+
+		if (task == nullptr) {
+			task = stealTask(worker);
+		}
+
+		return task;
+	}
+
+	private: Task * pollInjectionQueue() {
+		if (injectionSize.load(std::memory_order_relaxed) == 0) {
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(injectionMutex);
+
+		if (injectionQueue.empty()) {
+			return nullptr;
+		}
+
+		Task * task = injectionQueue.front();
+		injectionQueue.pop_front();
+		injectionSize.store(injectionQueue.size(), std::memory_order_relaxed);
+		return task;
+	}
+
+	private: Task * stealTask(Worker * thief) {
+		thread_local uint64_t externalRandomState = 0x2545F4914F6CDD1DULL;
+		uint64_t & state = thief != nullptr ? thief->randomState : externalRandomState;
+
+		// Xorshift selection of the first victim.
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+
+		const size_t start = (size_t) (state % workerCount);
+
+		for (size_t m = 0; m < workerCount; ++m) {
+			Worker & victim = *workers[(start + m) % workerCount];
+
+			if (&victim == thief) {
+				continue;
+			}
+
+			Task * task = victim.deque.steal();
+
+			if (task != nullptr) {
+				return task;
+			}
+		}
+
+		return nullptr;
+	}
+
+	private: static void run(Task * task) {
+		std::unique_ptr<Task> owned(task);
+		owned->run();
+	}
+
+	private: void workerLoop(Worker * worker) {
+		currentWorker() = worker;
+		System::ThreadName::setName("ThreadPool-" + ::toString(worker->index));
+
+		while (true) {
+			Task * task = findTask(worker);
+
+			if (task != nullptr) {
+				run(task);
+				continue;
+			}
+
+			if (spin([this] () { return stopping.load(std::memory_order_acquire); })) {
+				// Stopping. The pool stops once all submitted tasks have been executed.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (!hasWork()) {
+					break;
+				}
+
+				continue;
+			}
+
+			if (!hasWork()) {
+				park(*worker);
+			}
+		}
+
+		currentWorker() = nullptr;
+	}
+
+	private: template <typename FunctionT> void invokeInGroup(JoinGroup & group, FunctionT && function) {
+		try {
+			function();
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(group.mutex);
+
+			if (!group.exception) {
+				group.exception = std::current_exception();
+			}
+		}
+	}
+
+	private: template <typename FunctionT> void fork(JoinGroup & group, FunctionT && function) {
+		group.pending.fetch_add(1, std::memory_order_relaxed);
+
+		schedule(
+			[this, &group, f = std::forward<FunctionT>(function)] () mutable {
+				invokeInGroup(group, f);
+
+				// The group may be destroyed by the joining thread as soon as the count reaches
+				// zero, thus only the address of the count is used by the wake. A stale wake is
+				// harmless, as futex waiters recheck their condition.
+				if (group.pending.fetch_sub(1, std::memory_order_acq_rel) == (JoinWaiting | 1U)) {
+					Impl::Futex::wake(group.pending);
+				}
+			}
+		);
+	}
+
+	// Execute queued tasks until the forked tasks of the group have completed.
+	private: void join(JoinGroup & group) {
+		Worker * worker = ownWorker();
+
+		const auto complete = [&group] () {
+			return (group.pending.load(std::memory_order_acquire) & ~JoinWaiting) == 0;
+		};
+
+		while (!complete()) {
+			Task * task = findTask(worker);
+
+			if (task != nullptr) {
+				run(task);
+				continue;
+			}
+
+			if (spin(complete) || hasWork()) {
+				continue;
+			}
+
+			// The remaining tasks of the group are being executed by other threads.
+			uint32_t pending = group.pending.load(std::memory_order_acquire);
+
+			if ((pending & ~JoinWaiting) != 0
+				&& group.pending.compare_exchange_strong(pending, pending | JoinWaiting, std::memory_order_acq_rel)) {
+				Impl::Futex::wait(group.pending, pending | JoinWaiting);
+			}
+		}
+
+		if (group.exception) {
+			std::rethrow_exception(group.exception);
+		}
+	}
+
+	private: template <typename IndexT, typename FunctionT>
+	void splitRange(JoinGroup & group, IndexT begin, IndexT end, size_t grainSize, FunctionT & function) {
+		while ((size_t) (end - begin) > grainSize) {
+			const IndexT middle = begin + (end - begin) / 2;
+			fork(group, [this, &group, middle, end, grainSize, &function] () { splitRange(group, middle, end, grainSize, function); });
+			end = middle;
+		}
+
+		for (IndexT index = begin; index < end; ++index) {
+			function(index);
+		}
+	}
+
+	private: const size_t workerCount;
+	private: std::vector<std::unique_ptr<Worker>> workers;
+	private: std::mutex injectionMutex;
+	private: std::deque<Task *> injectionQueue;
+	private: std::atomic<size_t> injectionSize { 0 }; // Updated whilst holding the injection mutex.
+	private: std::atomic<bool> stopping { false };
+	private: std::mutex parkingMutex;
+	private: std::vector<Worker *> parkedWorkers;
+	private: alignas(64) std::atomic<size_t> parkedCount { 0 }; // Updated whilst holding the parking mutex.
+};
+
+} // namespace Balau::Concurrent
+
+#endif // COM_BORA_SOFTWARE__BALAU_CONCURRENT__THREAD_POOL
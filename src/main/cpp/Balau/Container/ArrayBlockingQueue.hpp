@@ -30,6 +30,7 @@
 #include <Balau/Type/StdTypes.hpp>
 
 #include <condition_variable>
+#include <functional>
 
 namespace Balau::Container {
 
@@ -85,10 +86,14 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 		if (full()) {
 			queueIsFull(object);
 
+			++waitingProducers;
+
 			while (full()) {
 				enqueueCondition.wait(lock);
 			}
 
+			--waitingProducers;
+
 			spaceNowAvailable(object);
 		}
 
@@ -131,13 +136,12 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 		if (full()) {
 			queueIsFull(object);
 
-			auto startTime = std::chrono::system_clock::now();
-			auto waitTimeRemaining = std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime);
+			const auto deadline = std::chrono::steady_clock::now() + waitTime;
+			++waitingProducers;
 
-			while (full() && waitTimeRemaining > std::chrono::nanoseconds(0)) {
-				enqueueCondition.wait_for(lock, waitTimeRemaining);
-				waitTimeRemaining = waitTime - (std::chrono::system_clock::now() - startTime);
-			}
+			while (full() && enqueueCondition.wait_until(lock, deadline) != std::cv_status::timeout) {}
+
+			--waitingProducers;
 
 			if (full()) {
 				return false;
@@ -160,10 +164,14 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 	public: T dequeue() override {
 		std::unique_lock<std::mutex> lock(mutex);
 
+		++waitingConsumers;
+
 		while (empty()) {
 			dequeueCondition.wait(lock);
 		}
 
+		--waitingConsumers;
+
 		T element = std::move(elements[tail]);
 		increment(tail);
 		--count;
@@ -191,13 +199,12 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 		std::unique_lock<std::mutex> lock(mutex);
 
 		if (empty()) {
-			auto startTime = std::chrono::system_clock::now();
-			auto waitTimeRemaining = std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime);
+			const auto deadline = std::chrono::steady_clock::now() + waitTime;
+			++waitingConsumers;
 
-			while (empty() && waitTimeRemaining > std::chrono::nanoseconds(0)) {
-				dequeueCondition.wait_for(lock, waitTimeRemaining);
-				waitTimeRemaining = waitTime - (std::chrono::system_clock::now() - startTime);
-			}
+			while (empty() && dequeueCondition.wait_until(lock, deadline) != std::cv_status::timeout) {}
+
+			--waitingConsumers;
 		}
 
 		if (empty()) {
@@ -217,6 +224,106 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 		return element;
 	}
 
+	///
+	/// Enqueue all the objects in the supplied range, waiting for space to be available whenever the queue is full.
+	///
+	/// The lock is acquired once for each run of objects that fit into the queue, and
+	/// waiting consumers are only woken when the queue transitions from empty to non-empty
+	/// or consumers are waiting. If the range is an rvalue, the objects are moved into the
+	/// queue, otherwise they are copied.
+	///
+	/// The default full queue callbacks are called each time the queue is found to be full.
+	///
+	/// @param range the range of objects to enqueue
+	///
+	public: template <typename RangeT> void enqueueAll(RangeT && range) {
+		auto current = std::begin(range);
+		const auto end = std::end(range);
+
+		if (current == end) {
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+			if (full()) {
+				defaultQueueIsFull(*current);
+				++waitingProducers;
+
+				while (full()) {
+					enqueueCondition.wait(lock);
+				}
+
+				--waitingProducers;
+				defaultSpaceNowAvailable(*current);
+			}
+
+			size_t enqueued = 0;
+
+			do {
+				if constexpr (std::is_lvalue_reference_v<RangeT>) {
+					elements[head] = *current;
+				} else {
+					elements[head] = std::move(*current);
+				}
+
+				increment(head);
+				++count;
+				++enqueued;
+				++current;
+			} while (current != end && !full());
+
+			wake(dequeueCondition, waitingConsumers, enqueued);
+
+			if (current == end) {
+				return;
+			}
+		}
+	}
+
+	///
+	/// Dequeue up to the specified number of objects, waiting a limited amount of time for an object to become available if the queue is empty.
+	///
+	/// The lock is acquired once for the whole batch, and waiting producers are only woken
+	/// when the queue transitions from full to not full or producers are waiting.
+	///
+	/// @param maximum the maximum number of objects to dequeue
+	/// @param output the output iterator that the dequeued objects are moved into
+	/// @param waitTime the time in milliseconds to wait for an object to become available
+	/// @return the number of objects dequeued
+	///
+	public: template <typename OutputIteratorT>
+	size_t dequeueUpTo(size_t maximum, OutputIteratorT output, std::chrono::milliseconds waitTime) {
+		if (maximum == 0) {
+			return 0;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (empty()) {
+			const auto deadline = std::chrono::steady_clock::now() + waitTime;
+			++waitingConsumers;
+
+			while (empty() && dequeueCondition.wait_until(lock, deadline) != std::cv_status::timeout) {}
+
+			--waitingConsumers;
+		}
+
+		size_t dequeued = 0;
+
+		while (dequeued < maximum && !empty()) {
+			*output = std::move(elements[tail]);
+			++output;
+			increment(tail);
+			--count;
+			++dequeued;
+		}
+
+		wake(enqueueCondition, waitingProducers, dequeued);
+		return dequeued;
+	}
+
 	public: bool full() const override {
 		return count == elements.size();
 	}
@@ -232,6 +339,19 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 		ptr = ptr - (ptr == elements.size()) * elements.size();
 	}
 
+	// Wake up to the specified number of waiting threads, once per transferred object.
+	private: static void wake(std::condition_variable & condition, size_t waiting, size_t transferred) {
+		if (waiting == 0 || transferred == 0) {
+			return;
+		} else if (transferred >= waiting) {
+			condition.notify_all();
+		} else {
+			for (size_t m = 0; m < transferred; ++m) {
+				condition.notify_one();
+			}
+		}
+	}
+
 	private: std::vector<T> elements;
 	private: size_t count;
 	private: size_t head;
@@ -239,6 +359,8 @@ template <typename T> class ArrayBlockingQueue : public BlockingQueue<T> {
 	private: std::mutex mutex;
 	private: std::condition_variable enqueueCondition;
 	private: std::condition_variable dequeueCondition;
+	private: size_t waitingProducers = 0;
+	private: size_t waitingConsumers = 0;
 	private: const Callback defaultQueueIsFull;
 	private: const Callback defaultSpaceNowAvailable;
 };
@@ -0,0 +1,250 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file LockFreeBlockingQueue.hpp
+///
+/// A bounded, lock-free, multi-producer multi-consumer blocking queue.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_CONTAINER__LOCK_FREE_BLOCKING_QUEUE
+#define COM_BORA_SOFTWARE__BALAU_CONTAINER__LOCK_FREE_BLOCKING_QUEUE
+
+#include <Balau/Container/BlockingQueue.hpp>
+#include <Balau/Concurrent/Impl/Futex.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace Balau::Container {
+
+///
+/// A bounded, lock-free, multi-producer multi-consumer blocking queue.
+///
+/// Each slot of the queue's array has a sequence number, which indicates whether
+/// the slot is ready to be written to by the producer or read from by the consumer
+/// of a particular position. Producers and consumers claim positions via atomic
+/// increments of the enqueue and dequeue indices, which are kept on separate cache
+/// lines. Non-blocking enqueue and dequeue calls never touch a mutex.
+///
+/// Blocking calls spin for a short while and then park on an event count. Waking
+/// parked threads only enters the kernel when threads are actually parked. Timed
+/// waits use the steady clock.
+///
+/// The capacity is rounded up to a power of two.
+///
+/// @tparam T the element type (must be default constructable in
+///            addition being move constructable and assignable)
+///
+template <typename T> class LockFreeBlockingQueue : public BlockingQueue<T> {
+	///
+	/// Create a lock-free blocking queue with the specified capacity.
+	///
+	/// @param capacity the minimum capacity of the queue (rounded up to a power of two, minimum 2)
+	///
+	public: explicit LockFreeBlockingQueue(unsigned int capacity)
+		: mask(roundCapacity(capacity) - 1)
+		, cells(new Cell[mask + 1]) {
+		for (size_t m = 0; m <= mask; ++m) {
+			cells[m].sequence.store(m, std::memory_order_relaxed);
+		}
+	}
+
+	public: void enqueue(T object) override {
+		if (!tryPush(object)) {
+			notFull.await([this, &object] () { return tryPush(object); }, SpinCount);
+		}
+
+		notEmpty.notify();
+	}
+
+	public: bool tryEnqueue(T object) override {
+		if (!tryPush(object)) {
+			return false;
+		}
+
+		notEmpty.notify();
+		return true;
+	}
+
+	public: bool tryEnqueue(T object, std::chrono::milliseconds waitTime) override {
+		if (!tryPush(object)) {
+			const auto deadline = std::chrono::steady_clock::now() + waitTime;
+
+			if (!notFull.await([this, &object] () { return tryPush(object); }, SpinCount, deadline)) {
+				return false;
+			}
+		}
+
+		notEmpty.notify();
+		return true;
+	}
+
+	public: T dequeue() override {
+		T element;
+
+		if (!tryPop(element)) {
+			notEmpty.await([this, &element] () { return tryPop(element); }, SpinCount);
+		}
+
+		notFull.notify();
+		return element;
+	}
+
+	public: T tryDequeue() override {
+		bool success;
+		return tryDequeue(success);
+	}
+
+	public: T tryDequeue(bool & success) override {
+		T element;
+		success = tryPop(element);
+
+		if (success) {
+			notFull.notify();
+		}
+
+		return element;
+	}
+
+	public: T tryDequeue(std::chrono::milliseconds waitTime) override {
+		bool success;
+		return tryDequeue(waitTime, success);
+	}
+
+	public: T tryDequeue(std::chrono::milliseconds waitTime, bool & success) override {
+		T element;
+		success = tryPop(element);
+
+		if (!success) {
+			const auto deadline = std::chrono::steady_clock::now() + waitTime;
+			success = notEmpty.await([this, &element] () { return tryPop(element); }, SpinCount, deadline);
+		}
+
+		if (success) {
+			notFull.notify();
+		}
+
+		return element;
+	}
+
+	public: bool full() const override {
+		return size() > mask;
+	}
+
+	public: bool empty() const override {
+		return size() == 0;
+	}
+
+	///
+	/// Get the capacity of the queue.
+	///
+	public: size_t getCapacity() const {
+		return mask + 1;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static constexpr unsigned int SpinCount = 64;
+
+	private: static constexpr size_t CacheLineSize = 64;
+
+	//
+	// The sequence of a slot is equal to the position when the slot is ready for
+	// the producer of the position, and to the position plus one when the slot is
+	// ready for the consumer of the position.
+	//
+	private: struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	private: static size_t roundCapacity(unsigned int capacity) {
+		size_t rounded = 2;
+
+		while (rounded < capacity) {
+			rounded <<= 1;
+		}
+
+		return rounded;
+	}
+
+	private: size_t size() const {
+		const size_t dequeued = dequeuePosition.load(std::memory_order_acquire);
+		const size_t enqueued = enqueuePosition.load(std::memory_order_acquire);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+
+	// Move the object into the queue if there is space.
+	private: bool tryPush(T & object) {
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		while (true) {
+			Cell & cell = cells[position & mask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto difference = (std::ptrdiff_t) (sequence - position);
+
+			if (difference == 0) {
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.value = std::move(object);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Move an element out of the queue if there is one.
+	private: bool tryPop(T & element) {
+		size_t position = dequeuePosition.load(std::memory_order_relaxed);
+
+		while (true) {
+			Cell & cell = cells[position & mask];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			const auto difference = (std::ptrdiff_t) (sequence - (position + 1));
+
+			if (difference == 0) {
+				if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					element = std::move(cell.value);
+					cell.sequence.store(position + mask + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	private: const size_t mask;
+	private: std::unique_ptr<Cell[]> cells;
+	private: alignas(CacheLineSize) std::atomic<size_t> enqueuePosition { 0 };
+	private: alignas(CacheLineSize) std::atomic<size_t> dequeuePosition { 0 };
+	private: alignas(64) Concurrent::Impl::EventCount notFull;
+	private: alignas(64) Concurrent::Impl::EventCount notEmpty;
+};
+
+} // namespace Balau::Container
+
+#endif // COM_BORA_SOFTWARE__BALAU_CONTAINER__LOCK_FREE_BLOCKING_QUEUE
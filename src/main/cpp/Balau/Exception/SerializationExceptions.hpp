@@ -0,0 +1,46 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file SerializationExceptions.hpp
+///
+/// %Balau exceptions for serialisation.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_EXCEPTION__SERIALIZATION_EXCEPTIONS
+#define COM_BORA_SOFTWARE__BALAU_EXCEPTION__SERIALIZATION_EXCEPTIONS
+
+#include <Balau/Exception/BalauException.hpp>
+
+namespace Balau::Exception {
+
+///
+/// Thrown when serialised data cannot be decoded.
+///
+class SerializationException : public BalauException {
+	public: SerializationException(SourceCodeLocation location, const std::string & st, const std::string & text)
+		: BalauException(location, st, "Serialization", text) {}
+
+	public: SerializationException(const std::string & st, const std::string & text)
+		: BalauException(st, "Serialization", text) {}
+};
+
+} // namespace Balau::Exception
+
+#endif // COM_BORA_SOFTWARE__BALAU_EXCEPTION__SERIALIZATION_EXCEPTIONS
@@ -0,0 +1,364 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__BLOB_ARENA
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__BLOB_ARENA
+
+#include <Balau/Exception/ContainerExceptions.hpp>
+#include <Balau/Interprocess/SharedMemoryUtils.hpp>
+#include <Balau/Type/ToString.hpp>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_condition.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Balau::Interprocess::Impl {
+
+//
+// A shared memory arena that holds the payloads of messages which do not fit
+// into a single shared memory queue buffer.
+//
+// Blocks are allocated in power of two size classes from a chain of managed shared
+// memory segments. Freed blocks are placed on the free list of their size class for
+// reuse. When the segments are exhausted, the cached blocks of all size classes are
+// returned to their segments and the allocation is retried. If the allocation still
+// fails, the caller waits for other blocks to be freed.
+//
+// When a block could never be allocated by waiting, because no blocks are allocated
+// or because no segment is large enough to hold the block, the arena grows by
+// creating an additional segment that is sized for the block. The first segment
+// holds the shared control structure. Additional segments are named after the first
+// segment with a numeric suffix, and are mapped by other processes on first use.
+//
+// Blocks are identified by their handle, which contains the index of the segment in
+// the upper 16 bits and the offset from the start of the segment in the lower 48 bits.
+// Blocks can thus be passed between processes that map the segments at different
+// addresses. The size class of a block is derived from the payload size, which is
+// carried along with the handle.
+//
+class BlobArena final {
+	public: using Handle = uint64_t;
+
+	// Returned by tryAllocate on timeout. Offset zero of the first segment is the segment header.
+	public: static constexpr Handle NoBlob = 0;
+
+	public: static constexpr size_t MinimumBlockSize = 4096;
+
+	// The maximum number of segments in the chain.
+	public: static constexpr unsigned int MaximumSegmentCount = 16;
+
+	public: BlobArena(OpenOrCreateSelector, const std::string & name_, size_t size)
+		: name(name_)
+		, baseSize(size)
+		, segmentInstances(1)
+		, segments {} {
+		segmentInstances[0] = std::make_unique<boost::interprocess::managed_shared_memory>(
+			boost::interprocess::open_or_create, name.c_str(), size
+		);
+
+		segments[0].store(segmentInstances[0].get(), std::memory_order_release);
+		control = segmentInstances[0]->find_or_construct<Control>(ControlName)();
+	}
+
+	public: BlobArena(const BlobArena &) = delete;
+	public: BlobArena & operator = (const BlobArena &) = delete;
+
+	//
+	// Remove the segments of the arena with the specified name.
+	//
+	public: static void remove(const std::string & name) {
+		boost::interprocess::shared_memory_object::remove(name.c_str());
+
+		for (unsigned int index = 1; index < MaximumSegmentCount; ++index) {
+			if (!boost::interprocess::shared_memory_object::remove(segmentName(name, index).c_str())) {
+				break;
+			}
+		}
+	}
+
+	//
+	// Allocate a block for a payload of the specified size, waiting for space if the arena is full.
+	//
+	public: Handle allocate(size_t bytes) {
+		return allocate(bytes, [this] (boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> & lock) {
+			control->freed.wait(lock);
+			return true;
+		});
+	}
+
+	//
+	// Allocate a block for a payload of the specified size, waiting a limited amount of
+	// time for space if the arena is full. Returns NoBlob if the wait time expired.
+	//
+	public: Handle tryAllocate(size_t bytes, std::chrono::milliseconds waitTime) {
+		const auto deadline = boost::posix_time::microsec_clock::universal_time()
+			+ boost::posix_time::milliseconds(waitTime.count());
+
+		return allocate(bytes, [this, deadline] (boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> & lock) {
+			return control->freed.timed_wait(lock, deadline);
+		});
+	}
+
+	//
+	// Return the block allocated for a payload of the specified size to its free list.
+	//
+	public: void free(Handle handle, size_t bytes) {
+		const unsigned int sizeClass = sizeClassOf(bytes);
+		char * block = address(handle);
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(control->mutex);
+		* (Handle *) block = control->freeLists[sizeClass];
+		control->freeLists[sizeClass] = handle;
+		--control->allocatedBlocks;
+		control->freed.notify_all();
+	}
+
+	public: char * address(Handle handle) {
+		return (char *) segment(segmentIndexOf(handle)).get_address_from_handle(
+			(boost::interprocess::managed_shared_memory::handle_t) (handle & OffsetMask)
+		);
+	}
+
+	// The number of blocks currently allocated and not yet freed.
+	public: size_t allocatedBlockCount() {
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(control->mutex);
+		return control->allocatedBlocks;
+	}
+
+	// The number of segments in the chain.
+	public: unsigned int segmentCount() {
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(control->mutex);
+		return control->segmentCount;
+	}
+
+	// The total size of the segments in the chain.
+	public: size_t getSize() {
+		const unsigned int count = segmentCount();
+		size_t size = 0;
+
+		for (unsigned int index = 0; index < count; ++index) {
+			size += segment(index).get_size();
+		}
+
+		return size;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static constexpr unsigned int SizeClassCount = 40;
+	private: static constexpr const char * ControlName = "control";
+	private: static constexpr unsigned int OffsetBits = 48;
+	private: static constexpr Handle OffsetMask = (Handle(1) << OffsetBits) - 1;
+
+	private: struct Control {
+		boost::interprocess::interprocess_mutex mutex;
+		boost::interprocess::interprocess_condition freed;
+		Handle freeLists[SizeClassCount] {};
+		size_t allocatedBlocks = 0;
+		unsigned int segmentCount = 1;
+	};
+
+	private: static std::string segmentName(const std::string & name, unsigned int index) {
+		return index == 0 ? name : ::toString(name, "_", index);
+	}
+
+	private: static unsigned int segmentIndexOf(Handle handle) {
+		return (unsigned int) (handle >> OffsetBits);
+	}
+
+	private: static unsigned int sizeClassOf(size_t bytes) {
+		unsigned int sizeClass = 0;
+
+		while (sizeClass < SizeClassCount && (MinimumBlockSize << sizeClass) < bytes) {
+			++sizeClass;
+		}
+
+		return sizeClass;
+	}
+
+	// Get the segment with the specified index, mapping it if this is the first use in this process.
+	private: boost::interprocess::managed_shared_memory & segment(unsigned int index) {
+		auto * mapped = segments[index].load(std::memory_order_acquire);
+
+		if (mapped != nullptr) {
+			return *mapped;
+		}
+
+		std::lock_guard<std::mutex> lock(segmentMutex);
+		mapped = segments[index].load(std::memory_order_relaxed);
+
+		if (mapped == nullptr) {
+			segmentInstances.emplace_back(
+				std::make_unique<boost::interprocess::managed_shared_memory>(
+					boost::interprocess::open_only, segmentName(name, index).c_str()
+				)
+			);
+
+			mapped = segmentInstances.back().get();
+			segments[index].store(mapped, std::memory_order_release);
+		}
+
+		return *mapped;
+	}
+
+	private: template <typename WaitFunctionT> Handle allocate(size_t bytes, WaitFunctionT waitFunction) {
+		const unsigned int sizeClass = sizeClassOf(bytes);
+
+		if (sizeClass == SizeClassCount) {
+			throwTooLarge(bytes);
+		}
+
+		const size_t blockSize = MinimumBlockSize << sizeClass;
+
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(control->mutex);
+
+		while (true) {
+			const Handle head = control->freeLists[sizeClass];
+
+			if (head != NoBlob) {
+				control->freeLists[sizeClass] = * (Handle *) address(head);
+				++control->allocatedBlocks;
+				return head;
+			}
+
+			const Handle allocated = allocateFromSegments(blockSize);
+
+			if (allocated != NoBlob) {
+				++control->allocatedBlocks;
+				return allocated;
+			}
+
+			if (releaseCachedBlocks()) {
+				continue;
+			}
+
+			// Waiting only helps if a segment is large enough for the block and blocks are allocated.
+			if (control->allocatedBlocks == 0 || !fitsIntoSegment(blockSize)) {
+				addSegment(bytes, blockSize);
+				control->freed.notify_all();
+				continue;
+			}
+
+			if (!waitFunction(lock)) {
+				return NoBlob;
+			}
+		}
+	}
+
+	// Allocate a block from the first segment that has space. Called with the control mutex held.
+	private: Handle allocateFromSegments(size_t blockSize) {
+		for (unsigned int index = 0; index < control->segmentCount; ++index) {
+			auto & s = segment(index);
+			void * block = s.allocate(blockSize, std::nothrow);
+
+			if (block != nullptr) {
+				return (Handle(index) << OffsetBits) | (Handle) s.get_handle_from_address(block);
+			}
+		}
+
+		return NoBlob;
+	}
+
+	// Determine whether an existing segment is large enough to hold the block once it is empty.
+	private: bool fitsIntoSegment(size_t blockSize) {
+		for (unsigned int index = 0; index < control->segmentCount; ++index) {
+			if (blockSize * 2 <= segment(index).get_size()) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Create the next segment of the chain, sized for the block. Called with the control mutex held.
+	private: void addSegment(size_t bytes, size_t blockSize) {
+		const unsigned int index = control->segmentCount;
+
+		if (index == MaximumSegmentCount) {
+			throwTooLarge(bytes);
+		}
+
+		const size_t size = std::max(baseSize, 4 * (blockSize + MinimumBlockSize));
+
+		{
+			std::lock_guard<std::mutex> lock(segmentMutex);
+
+			// A segment left behind by a previous instance of the arena is replaced.
+			boost::interprocess::shared_memory_object::remove(segmentName(name, index).c_str());
+
+			segmentInstances.emplace_back(
+				std::make_unique<boost::interprocess::managed_shared_memory>(
+					boost::interprocess::create_only, segmentName(name, index).c_str(), size
+				)
+			);
+
+			segments[index].store(segmentInstances.back().get(), std::memory_order_release);
+		}
+
+		control->segmentCount = index + 1;
+	}
+
+	// Return all cached blocks to their segments, so that they can be coalesced.
+	private: bool releaseCachedBlocks() {
+		bool released = false;
+
+		for (auto & freeList : control->freeLists) {
+			while (freeList != NoBlob) {
+				const Handle handle = freeList;
+				char * block = address(handle);
+				freeList = * (Handle *) block;
+				segment(segmentIndexOf(handle)).deallocate(block);
+				released = true;
+			}
+		}
+
+		return released;
+	}
+
+	private: [[noreturn]] void throwTooLarge(size_t bytes) {
+		ThrowBalauException(
+			  Exception::SizeException
+			, ::toString(
+				  "The message is too large to fit into the shared memory blob arena ("
+				, bytes, "/", MaximumSegmentCount, " segments)."
+			)
+		);
+	}
+
+	private: const std::string name;
+	private: const size_t baseSize;
+
+	// Guards the mapping of segments in this process.
+	private: std::mutex segmentMutex;
+	private: std::vector<std::unique_ptr<boost::interprocess::managed_shared_memory>> segmentInstances;
+	private: std::array<std::atomic<boost::interprocess::managed_shared_memory *>, MaximumSegmentCount> segments;
+	private: Control * control;
+};
+
+} // namespace Balau::Interprocess::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__BLOB_ARENA
@@ -0,0 +1,199 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__PROCESS_LIVENESS
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__PROCESS_LIVENESS
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace Balau::Interprocess::Impl {
+
+//
+// Process identification and owner death detection for the process shared
+// synchronisation primitives.
+//
+// A process is identified by its process id and its start time. Process ids are
+// reused by the kernel, thus a process id alone may identify a different process
+// by the time that it is checked. The start time of a process does not change,
+// so a process that has been replaced by a new process with the same id is
+// detected as dead.
+//
+// Process ids are stored in shared memory as 32 bit signed atomics and start
+// times as 64 bit unsigned atomics. A zero process id indicates an unused entry.
+//
+class ProcessLiveness final {
+	//
+	// The interval at which blocked waiters wake in order to check for dead processes.
+	//
+	public: static constexpr std::chrono::milliseconds RecoveryInterval { 100 };
+
+	//
+	// The identity of a process.
+	//
+	public: struct Identity {
+		int32_t pid;
+		uint64_t startTime;
+	};
+
+	//
+	// Get the identity of the calling process.
+	//
+	// The identity is cached per thread and refreshed in the child of a fork.
+	//
+	public: static Identity currentProcess() {
+		struct Cached {
+			uint32_t generation;
+			Identity identity;
+		};
+
+		thread_local Cached cached { 0, { 0, 0 } };
+
+		const uint32_t generation = forkGeneration();
+
+		if (cached.identity.pid == 0 || cached.generation != generation) {
+			const auto pid = (int32_t) getpid();
+			cached = { generation, { pid, startTime(pid) } };
+		}
+
+		return cached.identity;
+	}
+
+	//
+	// Returns true if the identified process no longer exists, has terminated but
+	// has not yet been reaped by its parent, or if its process id now belongs to
+	// a process with a different start time.
+	//
+	// A start time of zero is not checked. On platforms without a proc file system,
+	// a process that exists is considered to be alive.
+	//
+	public: static bool isDead(int32_t pid, uint64_t startTime_) {
+		if (pid <= 0) {
+			return false;
+		}
+
+		if (kill((pid_t) pid, 0) == -1 && errno == ESRCH) {
+			return true;
+		}
+
+		#ifdef __linux__
+			char state = 0;
+			uint64_t actualStartTime = 0;
+
+			if (!readStat(pid, state, actualStartTime)) {
+				return true;
+			}
+
+			return state == 'Z' || (startTime_ != 0 && actualStartTime != startTime_);
+		#else
+			(void) startTime_;
+			return false;
+		#endif
+	}
+
+	//
+	// Get the duration to wait for, given the deadline.
+	//
+	// Waits are limited to the recovery interval, so that dead processes are detected.
+	//
+	public: static std::chrono::nanoseconds slice(std::chrono::steady_clock::time_point deadline) {
+		const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+		return remaining < RecoveryInterval ? remaining : std::chrono::nanoseconds(RecoveryInterval);
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	public: ProcessLiveness() = delete;
+	public: ProcessLiveness(const ProcessLiveness &) = delete;
+	public: ProcessLiveness & operator = (const ProcessLiveness &) = delete;
+
+	// Incremented in the child of each fork, invalidating the cached identities.
+	private: static uint32_t forkGeneration() {
+		static std::atomic<uint32_t> generation { 1 };
+
+		static const int registered = pthread_atfork(
+			nullptr, nullptr, [] () { generation.fetch_add(1, std::memory_order_relaxed); }
+		);
+
+		(void) registered;
+		return generation.load(std::memory_order_relaxed);
+	}
+
+	private: static uint64_t startTime(int32_t pid) {
+		#ifdef __linux__
+			char state = 0;
+			uint64_t time = 0;
+			return readStat(pid, state, time) ? time : 0;
+		#else
+			(void) pid;
+			return 0;
+		#endif
+	}
+
+	#ifdef __linux__
+
+	// The process state is the first field after the parenthesised command name,
+	// and the start time is the twentieth.
+	private: static bool readStat(int32_t pid, char & state, uint64_t & time) {
+		char path[32];
+		std::snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+		std::FILE * file = std::fopen(path, "r");
+
+		if (file == nullptr) {
+			return false;
+		}
+
+		char buffer[1024];
+		const size_t length = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+		std::fclose(file);
+		buffer[length] = 0;
+
+		const char * end = std::strrchr(buffer, ')');
+
+		if (end == nullptr || end[1] != ' ') {
+			return false;
+		}
+
+		unsigned long long value = 0;
+
+		const int fields = std::sscanf(
+			  end + 2
+			, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu"
+			, &state
+			, &value
+		);
+
+		time = value;
+		return fields == 2;
+	}
+
+	#endif
+};
+
+} // namespace Balau::Interprocess::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__PROCESS_LIVENESS
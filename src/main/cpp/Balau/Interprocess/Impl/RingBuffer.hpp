@@ -0,0 +1,344 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__RING_BUFFER
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__RING_BUFFER
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+
+#include <cstddef>
+
+namespace Balau::Interprocess::Impl {
+
+//
+// The control block at the start of a shared memory ring buffer.
+//
+// The enqueue and dequeue positions are placed on their own cache lines in
+// order to avoid false sharing between producers and consumers. Positions
+// are 64 bit and never wrap in practice.
+//
+struct RingControl {
+	static constexpr uint32_t Uninitialised = 0;
+	static constexpr uint32_t Initialising = 1;
+	static constexpr uint32_t Ready = 2;
+
+	static constexpr uint32_t MagicNumber = 0xBA1A0041;
+
+	std::atomic<uint32_t> state;
+	uint32_t magic;
+	uint32_t capacity;
+	uint32_t slotSize;
+	uint32_t slotStride;
+	uint32_t singleProducerSingleConsumer;
+
+	alignas(64) std::atomic<uint64_t> tail;
+	alignas(64) std::atomic<uint64_t> head;
+
+	alignas(64) Concurrent::Impl::SharedEventCount notEmpty;
+	alignas(64) Concurrent::Impl::SharedEventCount notFull;
+};
+
+//
+// The header of each slot in a shared memory ring buffer.
+//
+// The sequence number of a slot is equal to its position when the slot is
+// free for enqueueing, position + 1 when the slot contains a message, and
+// position + capacity when the slot has been released for the next lap.
+//
+struct RingSlot {
+	// The slot was claimed but abandoned by its producer and contains no message.
+	static constexpr uint32_t Abandoned = 1;
+
+	std::atomic<uint64_t> sequence;
+	uint32_t size;
+	uint32_t flags;
+};
+
+static_assert(sizeof(RingSlot) == 16, "RingSlot size is not 16 bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring buffers require lock free 64 bit atomics.");
+
+//
+// The unit of allocation of the shared memory region that holds a ring buffer.
+//
+struct RingRegionLine {
+	char bytes[64];
+};
+
+//
+// A process local view onto a bounded ring buffer of fixed size slots that
+// resides in shared memory.
+//
+// The multiple producer/multiple consumer variant uses the Vyukov sequenced
+// slot algorithm. The single producer/single consumer variant uses the same
+// slot sequencing, but advances the positions with plain stores instead of
+// compare and swap.
+//
+// Callers claim a position, access the slot payload, and then publish
+// (producers) or release (consumers) the position. Claims never block.
+//
+class RingBuffer final {
+	public: static constexpr size_t CacheLineSize = 64;
+
+	//
+	// Round the capacity up to the next power of two.
+	//
+	public: static uint32_t roundCapacity(uint32_t capacity) {
+		uint32_t rounded = 1;
+
+		while (rounded < capacity) {
+			rounded <<= 1U;
+		}
+
+		return rounded;
+	}
+
+	//
+	// The number of bytes occupied by each slot (header + payload, cache line aligned).
+	//
+	public: static uint32_t slotStride(uint32_t slotSize) {
+		return (uint32_t) roundUp(sizeof(RingSlot) + slotSize);
+	}
+
+	//
+	// The number of bytes required for a ring buffer with the specified
+	// (rounded) capacity and slot size.
+	//
+	public: static size_t bytesRequired(uint32_t capacity, uint32_t slotSize) {
+		return roundUp(sizeof(RingControl)) + (size_t) capacity * slotStride(slotSize);
+	}
+
+	public: RingBuffer() = default;
+
+	//
+	// Initialise a new ring buffer in the supplied zero filled memory if it has
+	// not already been initialised by another process, then attach to it.
+	//
+	public: void initialise(char * base_, uint32_t capacity, uint32_t slotSize, bool singleProducerSingleConsumer) {
+		auto * c = reinterpret_cast<RingControl *>(base_);
+		uint32_t expected = RingControl::Uninitialised;
+
+		if (c->state.compare_exchange_strong(expected, RingControl::Initialising, std::memory_order_acq_rel)) {
+			c->magic = RingControl::MagicNumber;
+			c->capacity = capacity;
+			c->slotSize = slotSize;
+			c->slotStride = slotStride(slotSize);
+			c->singleProducerSingleConsumer = singleProducerSingleConsumer;
+			c->tail.store(0, std::memory_order_relaxed);
+			c->head.store(0, std::memory_order_relaxed);
+
+			char * slotBase = base_ + roundUp(sizeof(RingControl));
+
+			for (uint32_t m = 0; m < capacity; ++m) {
+				auto * s = reinterpret_cast<RingSlot *>(slotBase + (size_t) m * c->slotStride);
+				s->sequence.store(m, std::memory_order_relaxed);
+				s->size = 0;
+				s->flags = 0;
+			}
+
+			c->state.store(RingControl::Ready, std::memory_order_release);
+		}
+
+		attach(base_);
+	}
+
+	//
+	// Attach to a ring buffer that has been or is being initialised by another process.
+	//
+	// @return false if the memory does not contain a ring buffer
+	//
+	public: bool attach(char * base_) {
+		auto * c = reinterpret_cast<RingControl *>(base_);
+
+		while (c->state.load(std::memory_order_acquire) != RingControl::Ready) {
+			Concurrent::Impl::SharedFutex::pause();
+		}
+
+		if (c->magic != RingControl::MagicNumber) {
+			return false;
+		}
+
+		control = c;
+		slots = base_ + roundUp(sizeof(RingControl));
+		mask = c->capacity - 1;
+		stride = c->slotStride;
+		spsc = c->singleProducerSingleConsumer != 0;
+		return true;
+	}
+
+	//
+	// Try to claim the next enqueue position.
+	//
+	// @return false if the ring buffer is full
+	//
+	public: bool tryClaimEnqueue(uint64_t & position) {
+		uint64_t pos = control->tail.load(std::memory_order_relaxed);
+
+		while (true) {
+			const uint64_t sequence = slot(pos).sequence.load(std::memory_order_acquire);
+			const auto difference = (int64_t) (sequence - pos);
+
+			if (difference == 0) {
+				if (spsc) {
+					control->tail.store(pos + 1, std::memory_order_relaxed);
+					position = pos;
+					return true;
+				} else if (control->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					position = pos;
+					return true;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				pos = control->tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	//
+	// Publish a claimed enqueue position containing size bytes of payload.
+	//
+	public: void publishEnqueue(uint64_t position, uint32_t size) {
+		RingSlot & s = slot(position);
+		s.size = size;
+		s.flags = 0;
+		s.sequence.store(position + 1, std::memory_order_release);
+		control->notEmpty.notify();
+	}
+
+	//
+	// Publish a claimed enqueue position that will not contain a message.
+	//
+	// Consumers skip abandoned slots.
+	//
+	public: void abandonEnqueue(uint64_t position) {
+		RingSlot & s = slot(position);
+		s.size = 0;
+		s.flags = RingSlot::Abandoned;
+		s.sequence.store(position + 1, std::memory_order_release);
+		control->notEmpty.notify();
+	}
+
+	//
+	// Try to claim the next dequeue position that contains a message,
+	// releasing any abandoned slots on the way.
+	//
+	// @return false if the ring buffer is empty
+	//
+	public: bool tryClaimMessage(uint64_t & position) {
+		while (tryClaimDequeue(position)) {
+			if ((slot(position).flags & RingSlot::Abandoned) == 0) {
+				return true;
+			}
+
+			releaseDequeue(position);
+		}
+
+		return false;
+	}
+
+	//
+	// Try to claim the next dequeue position.
+	//
+	// @return false if the ring buffer is empty
+	//
+	public: bool tryClaimDequeue(uint64_t & position) {
+		uint64_t pos = control->head.load(std::memory_order_relaxed);
+
+		while (true) {
+			const uint64_t sequence = slot(pos).sequence.load(std::memory_order_acquire);
+			const auto difference = (int64_t) (sequence - (pos + 1));
+
+			if (difference == 0) {
+				if (spsc) {
+					control->head.store(pos + 1, std::memory_order_relaxed);
+					position = pos;
+					return true;
+				} else if (control->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					position = pos;
+					return true;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				pos = control->head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	//
+	// Release a claimed dequeue position for reuse by producers.
+	//
+	public: void releaseDequeue(uint64_t position) {
+		slot(position).sequence.store(position + mask + 1, std::memory_order_release);
+		control->notFull.notify();
+	}
+
+	public: char * payload(uint64_t position) {
+		return reinterpret_cast<char *>(&slot(position)) + sizeof(RingSlot);
+	}
+
+	public: uint32_t payloadSize(uint64_t position) {
+		return slot(position).size;
+	}
+
+	public: uint32_t capacity() const {
+		return (uint32_t) (mask + 1);
+	}
+
+	public: uint32_t slotSize() const {
+		return control->slotSize;
+	}
+
+	public: bool singleProducerSingleConsumer() const {
+		return spsc;
+	}
+
+	public: RingControl & getControl() {
+		return *control;
+	}
+
+	//
+	// The approximate number of messages in the ring buffer.
+	//
+	public: uint64_t size() const {
+		const uint64_t head = control->head.load(std::memory_order_acquire);
+		const uint64_t tail = control->tail.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static size_t roundUp(size_t bytes) {
+		return (bytes + CacheLineSize - 1) & ~(CacheLineSize - 1);
+	}
+
+	private: RingSlot & slot(uint64_t position) {
+		return *reinterpret_cast<RingSlot *>(slots + (size_t) (position & mask) * stride);
+	}
+
+	private: RingControl * control = nullptr;
+	private: char * slots = nullptr;
+	private: uint64_t mask = 0;
+	private: uint32_t stride = 0;
+	private: bool spsc = false;
+};
+
+} // namespace Balau::Interprocess::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__RING_BUFFER
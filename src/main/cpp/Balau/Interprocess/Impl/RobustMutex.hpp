@@ -0,0 +1,122 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__ROBUST_MUTEX
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__ROBUST_MUTEX
+
+#include <Balau/Exception/BalauException.hpp>
+
+#include <cerrno>
+#include <pthread.h>
+
+namespace Balau::Interprocess::Impl {
+
+//
+// A process shared mutex that is released when its owner dies.
+//
+// On platforms with robust POSIX mutexes, the kernel releases the mutex if the
+// owning process dies whilst holding it. The next process to lock the mutex is
+// told that the owner died, so that it can repair the state protected by the
+// mutex. On other platforms, the mutex is an ordinary process shared mutex.
+//
+// The mutex is placed into shared memory and must not be copied.
+//
+class RobustMutex final {
+	public: RobustMutex() {
+		pthread_mutexattr_t attributes;
+		pthread_mutexattr_init(&attributes);
+		pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+
+		#ifdef __linux__
+			pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+		#endif
+
+		const int result = pthread_mutex_init(&mutex, &attributes);
+		pthread_mutexattr_destroy(&attributes);
+
+		if (result != 0) {
+			ThrowBalauException(Exception::IllegalStateException, ::toString("Failed to initialise robust mutex: error ", result));
+		}
+	}
+
+	public: ~RobustMutex() {
+		pthread_mutex_destroy(&mutex);
+	}
+
+	public: RobustMutex(const RobustMutex &) = delete;
+	public: RobustMutex & operator = (const RobustMutex &) = delete;
+
+	//
+	// Lock the mutex.
+	//
+	// @return true if the previous owner died whilst holding the mutex
+	//
+	public: bool lock() {
+		const int result = pthread_mutex_lock(&mutex);
+
+		#ifdef __linux__
+			if (result == EOWNERDEAD) {
+				pthread_mutex_consistent(&mutex);
+				return true;
+			}
+		#endif
+
+		if (result != 0) {
+			ThrowBalauException(Exception::IllegalStateException, ::toString("Failed to lock robust mutex: error ", result));
+		}
+
+		return false;
+	}
+
+	public: void unlock() {
+		pthread_mutex_unlock(&mutex);
+	}
+
+	private: pthread_mutex_t mutex;
+};
+
+//
+// Scoped lock of a robust mutex.
+//
+class RobustLock final {
+	public: explicit RobustLock(RobustMutex & mutex_)
+		: mutex(mutex_)
+		, ownerDied(mutex.lock()) {}
+
+	public: ~RobustLock() {
+		mutex.unlock();
+	}
+
+	public: RobustLock(const RobustLock &) = delete;
+	public: RobustLock & operator = (const RobustLock &) = delete;
+
+	//
+	// Returns true if the previous owner of the mutex died whilst holding it.
+	//
+	public: bool previousOwnerDied() const {
+		return ownerDied;
+	}
+
+	private: RobustMutex & mutex;
+	private: const bool ownerDied;
+};
+
+} // namespace Balau::Interprocess::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS_IMPL__ROBUST_MUTEX
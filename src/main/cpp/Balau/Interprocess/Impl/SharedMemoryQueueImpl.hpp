@@ -24,7 +24,7 @@
 
 namespace Balau::Interprocess {
 
-template <typename T> class SharedMemoryQueue;
+template <typename T, typename MarshallerT> class SharedMemoryQueue;
 
 namespace Impl {
 
@@ -36,28 +36,38 @@ namespace Impl {
 //
 struct QueueHeader {
 	//
-	// The sequence number identifies multiple chunks of a multi-chunk message.
+	// The chunk count value that identifies a batch buffer containing multiple
+	// length prefixed objects. The chunk number of a batch buffer is the number
+	// of objects in the batch.
+	//
+	static constexpr unsigned int BatchChunkCount = 0;
+
+	//
+	// The chunk count value that identifies a blob descriptor. The header is
+	// followed by the handle of the blob arena block that holds the message.
+	//
+	static constexpr unsigned int BlobChunkCount = 0xFFFFFFFF;
+
+	//
+	// The sequence number of the buffer.
 	// The sequence number will wrap after 4e9 enqueues.
 	//
 	unsigned int sequenceNumber;
 
 	//
-	// The chunk count is the number of chunks in a multi-chunk message.
+	// The chunk count is 1 for a buffer that contains a single object,
+	// BatchChunkCount for a batch buffer, or BlobChunkCount for a blob
+	// descriptor.
 	//
 	unsigned int chunkCount;
 
 	//
-	// The chunk number is either:
-	//
-	//  - the zero indexed nth chunk index for chunks; or
-	//
-	//  - chunkCount + the number of chunks already added to the marshal buffer (which was
-	//    previously placed onto the pending queue because no more chunks were available).
+	// The number of objects in a batch buffer, otherwise zero.
 	//
 	unsigned int chunkNumber;
 
 	//
-	// The total number of bytes in the message, not including the header(s).
+	// The total number of bytes in the message, not including the header.
 	//
 	unsigned int totalBytes;
 };
@@ -69,8 +79,9 @@ static_assert(sizeof(QueueHeader) == 16, "QueueHeader size is not 16 bytes");
 class SharedMemoryQueueTLS {
 	std::vector<char> marshalBuffer;
 	std::vector<char> queueBuffer;
+	std::vector<char> leftoverBuffer;
 
-	template <typename T> friend class ::Balau::Interprocess::SharedMemoryQueue;
+	template <typename T, typename MarshallerT> friend class ::Balau::Interprocess::SharedMemoryQueue;
 
 	static SharedMemoryQueueTLS & storage() {
 		thread_local SharedMemoryQueueTLS instance;
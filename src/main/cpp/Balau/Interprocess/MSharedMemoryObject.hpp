@@ -108,13 +108,11 @@ template <typename T> class MSharedMemoryObject {
 	MSharedMemoryObject(OpenOrCreateSelector, const std::string & name, const P & ... params) {
 		const std::string memoryName = name + "_memory";
 
-		boost::interprocess::shared_memory_object::remove(memoryName.c_str());
-
 		segment = boost::interprocess::managed_shared_memory(
 			boost::interprocess::open_or_create, memoryName.c_str(), metadataOverhead + sizeof(T)
 		);
 
-		object = segment.construct<T>((name + "_object").c_str())(params ...);
+		object = segment.find_or_construct<T>((name + "_object").c_str())(params ...);
 	}
 
 	///
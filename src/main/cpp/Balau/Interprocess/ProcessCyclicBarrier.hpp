@@ -0,0 +1,227 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file ProcessCyclicBarrier.hpp
+///
+/// A synchronising barrier that may be shared between processes.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_CYCLIC_BARRIER
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_CYCLIC_BARRIER
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+#include <Balau/Exception/BalauException.hpp>
+#include <Balau/Exception/ContainerExceptions.hpp>
+#include <Balau/Interprocess/Impl/ProcessLiveness.hpp>
+#include <Balau/Type/ToString.hpp>
+
+namespace Balau::Exception {
+
+///
+/// Thrown when a process cyclic barrier is broken due to the death of a participant.
+///
+class BrokenBarrierException : public BalauException {
+	public: BrokenBarrierException(SourceCodeLocation location, const std::string & st, const std::string & text)
+		: BalauException(location, st, "BrokenBarrier", text) {}
+
+	public: BrokenBarrierException(const std::string & st, const std::string & text)
+		: BalauException(st, "BrokenBarrier", text) {}
+};
+
+} // namespace Balau::Exception
+
+namespace Balau::Interprocess {
+
+///
+/// A synchronising barrier that may be shared between processes.
+///
+/// Instances are placed in shared memory, typically via an MSharedMemoryObject.
+///
+/// The barrier automatically resets after releasing the participants. Participants
+/// are threads in any of the processes that share the barrier.
+///
+/// The barrier is implemented directly on a futex. Arriving at the barrier is a
+/// single atomic read-modify-write, and waiting participants spin for a short while before
+/// sleeping in the kernel. Only the last participant to arrive enters the kernel in
+/// order to wake the others, and only if some have gone to sleep.
+///
+/// The process ids and start times of the participants of each cycle are recorded,
+/// so that a reused process id is not mistaken for a participant. If a participant
+/// of the previous cycle has died, the waiting participants of the current cycle break
+/// the barrier and throw a BrokenBarrierException, as the dead participant will never
+/// arrive. Subsequent countdowns also throw until the barrier is reset. The death of
+/// a participant that did not arrive at the first cycle is not detected.
+///
+class ProcessCyclicBarrier {
+	///
+	/// The maximum number of participants.
+	///
+	public: static constexpr unsigned int MaxParticipants = 256;
+
+	///
+	/// Create a cyclic barrier with the specified number of participants.
+	///
+	/// @throw SizeException if the count is zero or greater than MaxParticipants
+	///
+	public: explicit ProcessCyclicBarrier(unsigned int count_) {
+		if (count_ == 0 || count_ > MaxParticipants) {
+			ThrowBalauException(
+				Exception::SizeException, ::toString("The process cyclic barrier count must be between 1 and ", MaxParticipants, ".")
+			);
+		}
+
+		number = count_;
+	}
+
+	public: ProcessCyclicBarrier(const ProcessCyclicBarrier &) = delete;
+	public: ProcessCyclicBarrier & operator = (const ProcessCyclicBarrier &) = delete;
+
+	///
+	/// Count down the barrier, blocking if the count has not reached 0.
+	///
+	/// @throw BrokenBarrierException if the barrier is broken
+	///
+	public: void countdown() {
+		const uint32_t cycle = generation.load(std::memory_order_acquire);
+		throwIfBroken();
+
+		const uint32_t index = arrived.fetch_add(1, std::memory_order_acq_rel);
+		const auto self = Impl::ProcessLiveness::currentProcess();
+		participants[cycle & 1U][index].startTime.store(self.startTime, std::memory_order_relaxed);
+		participants[cycle & 1U][index].pid.store(self.pid, std::memory_order_relaxed);
+
+		if (index + 1 == number) {
+			arrived.store(0, std::memory_order_relaxed);
+			generation.store(cycle + 1, std::memory_order_seq_cst);
+
+			if (waiters.load(std::memory_order_seq_cst) != 0) {
+				Concurrent::Impl::SharedFutex::wake(generation);
+			}
+
+			return;
+		}
+
+		await(cycle);
+		throwIfBroken();
+	}
+
+	///
+	/// Returns true if the barrier has been broken due to the death of a participant.
+	///
+	public: bool isBroken() const {
+		return broken.load(std::memory_order_acquire) != 0;
+	}
+
+	///
+	/// Repair a broken barrier.
+	///
+	/// It is the responsibility of the caller to ensure that the barrier is not
+	/// being used at the time of the reset.
+	///
+	public: void reset() {
+		arrived.store(0, std::memory_order_relaxed);
+
+		for (auto & cycleParticipants : participants) {
+			for (auto & participant : cycleParticipants) {
+				participant.pid.store(0, std::memory_order_relaxed);
+				participant.startTime.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		broken.store(0, std::memory_order_relaxed);
+		generation.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: static constexpr unsigned int SpinCount = 256;
+
+	private: struct Participant {
+		std::atomic<int32_t> pid { 0 };
+		std::atomic<uint64_t> startTime { 0 };
+	};
+
+	private: void throwIfBroken() const {
+		if (isBroken()) {
+			ThrowBalauException(
+				Exception::BrokenBarrierException, "The process cyclic barrier is broken due to the death of a participant."
+			);
+		}
+	}
+
+	private: void await(uint32_t cycle) {
+		for (unsigned int m = 0; m < SpinCount; ++m) {
+			if (generation.load(std::memory_order_acquire) != cycle) {
+				return;
+			}
+
+			Concurrent::Impl::SharedFutex::pause();
+		}
+
+		while (true) {
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+
+			if (generation.load(std::memory_order_seq_cst) != cycle) {
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				return;
+			}
+
+			Concurrent::Impl::SharedFutex::wait(generation, cycle, Impl::ProcessLiveness::RecoveryInterval);
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			if (generation.load(std::memory_order_acquire) != cycle) {
+				return;
+			}
+
+			if (previousParticipantDied(cycle)) {
+				broken.store(1, std::memory_order_release);
+
+				if (generation.compare_exchange_strong(cycle, cycle + 1, std::memory_order_seq_cst)) {
+					Concurrent::Impl::SharedFutex::wake(generation);
+				}
+
+				return;
+			}
+		}
+	}
+
+	private: bool previousParticipantDied(uint32_t cycle) const {
+		for (const auto & participant : participants[(cycle - 1) & 1U]) {
+			const int32_t pid = participant.pid.load(std::memory_order_relaxed);
+
+			if (Impl::ProcessLiveness::isDead(pid, participant.startTime.load(std::memory_order_relaxed))) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	private: std::atomic<uint32_t> generation { 0 };
+	private: std::atomic<uint32_t> arrived { 0 };
+	private: std::atomic<uint32_t> waiters { 0 };
+	private: std::atomic<uint32_t> broken { 0 };
+	private: uint32_t number;
+	private: Participant participants[2][MaxParticipants];
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_CYCLIC_BARRIER
@@ -0,0 +1,185 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file ProcessEvent.hpp
+///
+/// A manual or auto-reset event that may be shared between processes.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_EVENT
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_EVENT
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+
+namespace Balau::Interprocess {
+
+///
+/// The reset behaviour of a process event.
+///
+enum class ProcessEventMode {
+	///
+	/// The event remains set until reset is called, and releases all waiters.
+	///
+	ManualReset
+
+	///
+	/// The event is reset by the first waiter that observes it, thus each set releases a single waiter.
+	///
+	, AutoReset
+};
+
+///
+/// A manual or auto-reset event that may be shared between processes.
+///
+/// Instances are placed in shared memory, typically via an MSharedMemoryObject.
+///
+/// The event is implemented directly on a futex. Setting, resetting and waiting on
+/// a set event are single atomic instructions. Waiting on an event that is not set
+/// spins for a short while before sleeping in the kernel, and setting the event only
+/// enters the kernel when there are sleeping waiters.
+///
+/// An event has no owner, thus a crashed process does not leave the event in an
+/// inconsistent state, and waiters sleep until the event is set or their wait
+/// times out. A waiter that must not block indefinitely on a process that may die
+/// should use the timed wait.
+///
+class ProcessEvent {
+	///
+	/// Create an event with the specified mode and initial state.
+	///
+	public: explicit ProcessEvent(ProcessEventMode mode_ = ProcessEventMode::ManualReset, bool set_ = false)
+		: mode(mode_)
+		, state(set_ ? 1U : 0U) {}
+
+	public: ProcessEvent(const ProcessEvent &) = delete;
+	public: ProcessEvent & operator = (const ProcessEvent &) = delete;
+
+	///
+	/// Set the event, releasing all waiters if the event is manual reset, or a single waiter if the event is auto-reset.
+	///
+	public: void set() {
+		state.store(1, std::memory_order_seq_cst);
+
+		if (waiters.load(std::memory_order_seq_cst) != 0) {
+			Concurrent::Impl::SharedFutex::wake(state, mode == ProcessEventMode::AutoReset ? 1 : INT_MAX);
+		}
+	}
+
+	///
+	/// Reset the event.
+	///
+	public: void reset() {
+		state.store(0, std::memory_order_relaxed);
+	}
+
+	///
+	/// Returns true if the event is set.
+	///
+	public: bool isSet() const {
+		return state.load(std::memory_order_acquire) != 0;
+	}
+
+	///
+	/// Wait until the event is set.
+	///
+	public: void wait() {
+		if (!tryConsume()) {
+			await(std::chrono::steady_clock::time_point::max());
+		}
+	}
+
+	///
+	/// Wait for up to the specified wait time for the event to be set.
+	///
+	/// @return true if the event was set, false if the wait timed out
+	///
+	public: bool tryWait(std::chrono::milliseconds waitTime) {
+		return tryConsume() || await(std::chrono::steady_clock::now() + waitTime);
+	}
+
+	///
+	/// Get the mode of the event.
+	///
+	public: ProcessEventMode getMode() const {
+		return mode;
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: static constexpr unsigned int SpinCount = 128;
+
+	// Observe the event, resetting it if it is auto-reset.
+	private: bool tryConsume() {
+		if (mode == ProcessEventMode::ManualReset) {
+			return state.load(std::memory_order_acquire) != 0;
+		}
+
+		uint32_t expected = 1;
+		return state.compare_exchange_strong(expected, 0, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	private: bool await(std::chrono::steady_clock::time_point deadline) {
+		for (unsigned int m = 0; m < SpinCount; ++m) {
+			Concurrent::Impl::SharedFutex::pause();
+
+			if (tryConsume()) {
+				return true;
+			}
+		}
+
+		while (true) {
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+
+			if (tryConsume()) {
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			if (deadline == std::chrono::steady_clock::time_point::max()) {
+				Concurrent::Impl::SharedFutex::wait(state, 0);
+			} else {
+				const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					deadline - std::chrono::steady_clock::now()
+				);
+
+				if (remaining.count() <= 0) {
+					waiters.fetch_sub(1, std::memory_order_relaxed);
+					return false;
+				}
+
+				Concurrent::Impl::SharedFutex::wait(state, 0, remaining);
+			}
+
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			if (tryConsume()) {
+				return true;
+			}
+		}
+	}
+
+	private: const ProcessEventMode mode;
+	private: std::atomic<uint32_t> state;
+	private: std::atomic<uint32_t> waiters { 0 };
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_EVENT
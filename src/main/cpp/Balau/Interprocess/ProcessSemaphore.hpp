@@ -0,0 +1,459 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file ProcessSemaphore.hpp
+///
+/// A counting semaphore that may be shared between processes.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_SEMAPHORE
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_SEMAPHORE
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+#include <Balau/Interprocess/Impl/ProcessLiveness.hpp>
+#include <Balau/Interprocess/Impl/RobustMutex.hpp>
+
+#include <thread>
+
+namespace Balau::Interprocess {
+
+///
+/// A counting semaphore that may be shared between processes.
+///
+/// Instances are placed in shared memory, typically via an MSharedMemoryObject.
+///
+/// The semaphore count is held in a single atomic state word. An uncontended
+/// increment or decrement is a single atomic read-modify-write of the state word.
+/// An uncontended acquire or release is a single atomic read-modify-write of the
+/// state word followed by an update of the holder record of the calling process,
+/// which is cached per thread. A contended decrement spins for a short while before
+/// sleeping in the kernel on a futex, and the kernel is only entered in order to
+/// wake when there are sleeping waiters.
+///
+/// Permits taken via acquire are recorded against the calling process, and are
+/// returned to the semaphore if the process dies without releasing them. The
+/// state word change of an acquire or release also journals the holder of the
+/// operation, thus a process that dies part way through an acquire or release
+/// leaves the semaphore in a recoverable state. Processes are identified by their
+/// process id and start time, so a reused process id is not mistaken for the holder.
+/// Blocked waiters check for dead holders periodically.
+///
+/// The permits of up to MaxHolders processes are recorded at a time. Permits
+/// acquired when the table is full are not recovered. The increment and decrement
+/// methods are not recorded, and are intended for signalling between processes.
+///
+class ProcessSemaphore {
+	///
+	/// The maximum number of processes for which held permits are recorded.
+	///
+	public: static constexpr unsigned int MaxHolders = 64;
+
+	///
+	/// Create a semaphore object, setting an initial count if desired.
+	///
+	public: explicit ProcessSemaphore(unsigned int count_ = 0) : state(count_) {}
+
+	public: ProcessSemaphore(const ProcessSemaphore &) = delete;
+	public: ProcessSemaphore & operator = (const ProcessSemaphore &) = delete;
+
+	///
+	/// Increment the semaphore.
+	///
+	public: void increment() {
+		state.fetch_add(1, std::memory_order_seq_cst);
+		wake(1);
+	}
+
+	///
+	/// Decrement the semaphore, blocking if the count is zero.
+	///
+	public: void decrement() {
+		if (!tryTake(nullptr)) {
+			await(nullptr, std::chrono::steady_clock::time_point::max());
+		}
+	}
+
+	///
+	/// Decrement the semaphore if the count is not zero.
+	///
+	/// @return true if the semaphore was decremented
+	///
+	public: bool tryDecrement() {
+		return tryTake(nullptr);
+	}
+
+	///
+	/// Decrement the semaphore, blocking for up to the specified wait time if the count is zero.
+	///
+	/// @return true if the semaphore was decremented
+	///
+	public: bool tryDecrement(std::chrono::milliseconds waitTime) {
+		return tryTake(nullptr) || await(nullptr, std::chrono::steady_clock::now() + waitTime);
+	}
+
+	///
+	/// Take a permit on behalf of the calling process, blocking if the count is zero.
+	///
+	/// If the process dies before releasing the permit, the permit is returned to the semaphore.
+	///
+	public: void acquire() {
+		Holder * holder = currentHolder();
+
+		if (!tryTake(holder)) {
+			await(holder, std::chrono::steady_clock::time_point::max());
+		}
+	}
+
+	///
+	/// Take a permit on behalf of the calling process, blocking for up to the specified wait time if the count is zero.
+	///
+	/// @return true if a permit was taken
+	///
+	public: bool tryAcquire(std::chrono::milliseconds waitTime) {
+		Holder * holder = currentHolder();
+		return tryTake(holder) || await(holder, std::chrono::steady_clock::now() + waitTime);
+	}
+
+	///
+	/// Return a permit taken via acquire by the calling process.
+	///
+	public: void release() {
+		Holder * holder = currentHolder();
+
+		if (holder == nullptr || permitsOf(holder->record.load(std::memory_order_relaxed)) == 0) {
+			increment();
+			return;
+		}
+
+		uint64_t s = state.load(std::memory_order_acquire);
+
+		while (true) {
+			if (!isSettled(s)) {
+				settle(s);
+				s = state.load(std::memory_order_acquire);
+				continue;
+			}
+
+			const uint32_t sequence = nextSequence(s);
+
+			if (state.compare_exchange_weak(s, journal(available(s) + 1, indexOf(holder), true, sequence), std::memory_order_seq_cst)) {
+				apply(*holder, -1, sequence);
+				break;
+			}
+		}
+
+		wake(1);
+	}
+
+	///
+	/// Get the current count.
+	///
+	public: unsigned int getCount() const {
+		return available(state.load(std::memory_order_relaxed));
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: static constexpr unsigned int SpinCount = 128;
+
+	// Holder process id value whilst the permits of a dead process are being recovered.
+	private: static constexpr int32_t Recovering = -1;
+
+	//
+	// The state word contains the count and a journal of the last acquire or release.
+	//
+	//  - bits 0 to 31 hold the count;
+	//  - bits 32 to 38 hold the holder index plus one of the journalled operation, or zero if none;
+	//  - bit 39 is set if the journalled operation is a release;
+	//  - bits 40 to 63 hold the sequence number of the journalled operation.
+	//
+	// The journalled operation is settled once the holder record has applied it.
+	// Acquires and releases wait for the previous one to be settled, thus at most
+	// one holder record update is outstanding and the recovery of a dead holder
+	// can complete it.
+	//
+	// The holder record word contains the number of permits held in bits 0 to 31
+	// and the sequence number of the last applied operation in bits 32 to 63, so
+	// that applying an operation is a single store.
+	//
+	private: static constexpr uint32_t SequenceMask = 0xFFFFFF;
+
+	private: struct Holder {
+		std::atomic<int32_t> pid { 0 };
+		std::atomic<uint64_t> startTime { 0 };
+		std::atomic<uint64_t> record { 0 };
+	};
+
+	private: static uint32_t available(uint64_t s) {
+		return (uint32_t) s;
+	}
+
+	private: static uint32_t journalledHolder(uint64_t s) {
+		return (uint32_t) (s >> 32U) & 0x7FU;
+	}
+
+	private: static bool journalledRelease(uint64_t s) {
+		return ((s >> 39U) & 1U) != 0;
+	}
+
+	private: static uint32_t sequenceOf(uint64_t s) {
+		return (uint32_t) (s >> 40U);
+	}
+
+	private: static uint32_t nextSequence(uint64_t s) {
+		return (sequenceOf(s) + 1) & SequenceMask;
+	}
+
+	private: static uint64_t journal(uint32_t count, uint32_t index, bool release, uint32_t sequence) {
+		return (uint64_t) count
+			| ((uint64_t) (index + 1) << 32U)
+			| ((uint64_t) (release ? 1U : 0U) << 39U)
+			| ((uint64_t) sequence << 40U);
+	}
+
+	private: static uint32_t permitsOf(uint64_t record) {
+		return (uint32_t) record;
+	}
+
+	private: static uint32_t appliedOf(uint64_t record) {
+		return (uint32_t) (record >> 32U);
+	}
+
+	// Apply an operation to a holder record. Only one operation is outstanding at a
+	// time, thus the record has no concurrent writers.
+	private: static void apply(Holder & holder, int delta, uint32_t sequence) {
+		const uint32_t permits = permitsOf(holder.record.load(std::memory_order_relaxed));
+		const uint32_t updated = delta > 0 ? permits + 1 : (permits != 0 ? permits - 1 : 0);
+		holder.record.store((uint64_t) updated | ((uint64_t) sequence << 32U), std::memory_order_release);
+	}
+
+	private: uint32_t indexOf(const Holder * holder) const {
+		return (uint32_t) (holder - holders);
+	}
+
+	private: bool isSettled(uint64_t s) const {
+		const uint32_t holder = journalledHolder(s);
+		return holder == 0 || appliedOf(holders[holder - 1].record.load(std::memory_order_acquire)) == sequenceOf(s);
+	}
+
+	// Wait for the journalled operation to be applied, completing it if its process has died.
+	//
+	// Returns early if another operation has been journalled, as the record may
+	// then have applied a later operation.
+	//
+	private: void settle(uint64_t s) {
+		const uint32_t index = journalledHolder(s) - 1;
+
+		for (unsigned int m = 1; !isSettled(s) && (state.load(std::memory_order_acquire) >> 32U) == (s >> 32U); ++m) {
+			if (m < SpinCount) {
+				Concurrent::Impl::SharedFutex::pause();
+			} else if (m % SpinCount == 0) {
+				recover(index);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// Take a permit, recording it against the holder if one is supplied.
+	private: bool tryTake(Holder * holder) {
+		uint64_t s = state.load(std::memory_order_acquire);
+
+		while (available(s) != 0) {
+			if (holder == nullptr) {
+				if (state.compare_exchange_weak(s, s - 1, std::memory_order_acquire, std::memory_order_acquire)) {
+					return true;
+				}
+			} else if (!isSettled(s)) {
+				settle(s);
+				s = state.load(std::memory_order_acquire);
+			} else {
+				const uint32_t sequence = nextSequence(s);
+				const uint64_t next = journal(available(s) - 1, indexOf(holder), false, sequence);
+
+				if (state.compare_exchange_weak(s, next, std::memory_order_acquire, std::memory_order_acquire)) {
+					apply(*holder, 1, sequence);
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	private: bool await(Holder * holder, std::chrono::steady_clock::time_point deadline) {
+		for (unsigned int m = 0; m < SpinCount; ++m) {
+			Concurrent::Impl::SharedFutex::pause();
+
+			if (tryTake(holder)) {
+				return true;
+			}
+		}
+
+		while (true) {
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			const uint32_t e = epoch.load(std::memory_order_seq_cst);
+
+			if (tryTake(holder)) {
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			const auto slice = Impl::ProcessLiveness::slice(deadline);
+
+			if (slice.count() <= 0) {
+				waiters.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			Concurrent::Impl::SharedFutex::wait(epoch, e, slice);
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			if (tryTake(holder)) {
+				return true;
+			}
+
+			recoverDeadHolders();
+		}
+	}
+
+	private: void wake(int count) {
+		if (waiters.load(std::memory_order_seq_cst) != 0) {
+			epoch.fetch_add(1, std::memory_order_seq_cst);
+			Concurrent::Impl::SharedFutex::wake(epoch, count);
+		}
+	}
+
+	// Get the holder record of the calling process, claiming one if necessary.
+	//
+	// The record is cached per thread and validated against the process identity,
+	// as the thread may be the forking thread of a child process.
+	//
+	// @return the holder record, or nullptr if the table is full
+	//
+	private: Holder * currentHolder() {
+		struct Cached {
+			const ProcessSemaphore * semaphore;
+			Holder * holder;
+		};
+
+		thread_local Cached cached { nullptr, nullptr };
+
+		const auto self = Impl::ProcessLiveness::currentProcess();
+
+		if (cached.semaphore == this && owns(*cached.holder, self)) {
+			return cached.holder;
+		}
+
+		Holder * holder = claim(self);
+
+		if (holder != nullptr) {
+			cached = { this, holder };
+		}
+
+		return holder;
+	}
+
+	private: static bool owns(const Holder & holder, Impl::ProcessLiveness::Identity self) {
+		return holder.pid.load(std::memory_order_acquire) == self.pid
+			&& holder.startTime.load(std::memory_order_relaxed) == self.startTime;
+	}
+
+	// Find or claim the holder record of the calling process.
+	//
+	// Claims are serialised by the claim mutex, so that threads of the same process
+	// that miss the lookup concurrently do not claim a record each. Records are only
+	// freed when their process dies, thus a claimed record remains owned.
+	//
+	private: Holder * claim(Impl::ProcessLiveness::Identity self) {
+		Impl::RobustLock lock(claimMutex);
+
+		for (int attempt = 0; attempt < 2; ++attempt) {
+			for (auto & holder : holders) {
+				if (owns(holder, self)) {
+					return &holder;
+				}
+			}
+
+			for (auto & holder : holders) {
+				if (holder.pid.load(std::memory_order_acquire) == 0) {
+					holder.startTime.store(self.startTime, std::memory_order_relaxed);
+					holder.pid.store(self.pid, std::memory_order_release);
+					return &holder;
+				}
+			}
+
+			recoverDeadHolders();
+		}
+
+		return nullptr;
+	}
+
+	// Return the permits held by dead processes to the semaphore and free their records.
+	private: void recoverDeadHolders() {
+		for (uint32_t index = 0; index < MaxHolders; ++index) {
+			recover(index);
+		}
+	}
+
+	// Recover the holder record if its process has died.
+	//
+	// An operation journalled by the dead process that it did not apply is applied
+	// first, so that the returned permits include an interrupted acquire and exclude
+	// an interrupted release.
+	//
+	private: void recover(uint32_t index) {
+		Holder & holder = holders[index];
+		int32_t pid = holder.pid.load(std::memory_order_acquire);
+
+		if (pid <= 0
+			|| !Impl::ProcessLiveness::isDead(pid, holder.startTime.load(std::memory_order_relaxed))
+			|| !holder.pid.compare_exchange_strong(pid, Recovering, std::memory_order_acq_rel)) {
+			return;
+		}
+
+		const uint64_t s = state.load(std::memory_order_acquire);
+
+		if (journalledHolder(s) == index + 1 && !isSettled(s)) {
+			apply(holder, journalledRelease(s) ? -1 : 1, sequenceOf(s));
+		}
+
+		const uint64_t record = holder.record.load(std::memory_order_relaxed);
+		const uint32_t permits = permitsOf(record);
+		holder.record.store((uint64_t) appliedOf(record) << 32U, std::memory_order_release);
+		holder.startTime.store(0, std::memory_order_relaxed);
+		holder.pid.store(0, std::memory_order_release);
+
+		if (permits != 0) {
+			state.fetch_add(permits, std::memory_order_seq_cst);
+			wake((int) permits);
+		}
+	}
+
+	private: std::atomic<uint64_t> state;
+	private: std::atomic<uint32_t> epoch { 0 };
+	private: std::atomic<uint32_t> waiters { 0 };
+	private: Impl::RobustMutex claimMutex;
+	private: Holder holders[MaxHolders];
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__PROCESS_SEMAPHORE
@@ -0,0 +1,481 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file SharedMemoryHashMap.hpp
+///
+/// A fixed capacity, open addressing hash map in a managed shared memory segment.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_HASH_MAP
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_HASH_MAP
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+#include <Balau/Exception/ContainerExceptions.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/SharedMemoryUtils.hpp>
+#include <Balau/Type/ToString.hpp>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace Balau::Interprocess {
+
+///
+/// A fixed capacity, open addressing hash map in a managed shared memory segment.
+///
+/// The map is placed by name into a caller supplied managed shared memory segment,
+/// thus several maps and object pools can share a single named segment. The map
+/// contains no pointers. Buckets are located via the segment's named object index,
+/// thus each process may map the segment at a different address.
+///
+/// Lookups are lock-free. Each bucket is protected by a sequence lock, and readers
+/// retry a bucket if a writer modified it during the read. Insertions, updates and
+/// erasures are serialised per key by a striped set of process-shared mutexes, and
+/// empty buckets are claimed atomically.
+///
+/// The key and value types must be trivially copyable, and the hash function must
+/// produce the same result for a key in every process. Erased buckets are marked as
+/// deleted and are reused by subsequent insertions, but the map is never rehashed.
+/// An insertion into a map that has no free bucket results in a SizeException.
+///
+/// @tparam K the key type
+/// @tparam V the value type
+/// @tparam HashT the hash function type
+///
+template <typename K, typename V, typename HashT = std::hash<K>>
+class SharedMemoryHashMap {
+	static_assert(std::is_trivially_copyable_v<K>, "SharedMemoryHashMap keys must be trivially copyable.");
+	static_assert(std::is_trivially_copyable_v<V>, "SharedMemoryHashMap values must be trivially copyable.");
+
+	///
+	/// The number of striped write locks.
+	///
+	public: static const size_t StripeCount = 64;
+
+	///
+	/// Get the number of bytes of segment space required for a map of the specified capacity.
+	///
+	/// @param capacity the number of buckets (rounded up to a power of two)
+	///
+	public: static size_t requiredSize(size_t capacity) {
+		return sizeof(Control) + roundCapacity(capacity) * sizeof(Bucket) + NamedObjectOverhead;
+	}
+
+	///
+	/// Create a hash map in the supplied segment.
+	///
+	/// @param segment_ the managed shared memory segment in which to place the map
+	/// @param name_ the name of the map within the segment
+	/// @param capacity the number of buckets (rounded up to a power of two)
+	/// @throw SharedMemoryObjectException if a map with the same name already exists in the segment
+	///
+	public: SharedMemoryHashMap(CreateOnlySelector,
+	                            boost::interprocess::managed_shared_memory & segment_,
+	                            const std::string & name_,
+	                            size_t capacity)
+		: segment(segment_)
+		, name(name_) {
+		atomically([this, capacity] () {
+			if (segment.find<Control>(controlName().c_str()).first != nullptr) {
+				ThrowBalauException(
+					Exception::SharedMemoryObjectException, "The shared memory hash map " + name + " already exists."
+				);
+			}
+
+			construct(capacity);
+		});
+	}
+
+	///
+	/// Open or create a hash map in the supplied segment.
+	///
+	/// If the map already exists, the capacity is ignored.
+	///
+	/// @param segment_ the managed shared memory segment in which to place the map
+	/// @param name_ the name of the map within the segment
+	/// @param capacity the number of buckets (rounded up to a power of two)
+	///
+	public: SharedMemoryHashMap(OpenOrCreateSelector,
+	                            boost::interprocess::managed_shared_memory & segment_,
+	                            const std::string & name_,
+	                            size_t capacity)
+		: segment(segment_)
+		, name(name_) {
+		atomically([this, capacity] () {
+			if (!find()) {
+				construct(capacity);
+			}
+		});
+	}
+
+	///
+	/// Open an existing hash map in the supplied segment.
+	///
+	/// @param segment_ the managed shared memory segment containing the map
+	/// @param name_ the name of the map within the segment
+	/// @throw SharedMemoryObjectException if the map does not exist
+	///
+	public: SharedMemoryHashMap(OpenOnlySelector, boost::interprocess::managed_shared_memory & segment_, const std::string & name_)
+		: segment(segment_)
+		, name(name_) {
+		bool found = false;
+		atomically([this, &found] () { found = find(); });
+
+		if (!found) {
+			ThrowBalauException(
+				Exception::SharedMemoryObjectException, "The shared memory hash map " + name + " was not found."
+			);
+		}
+	}
+
+	public: SharedMemoryHashMap(const SharedMemoryHashMap &) = delete;
+	public: SharedMemoryHashMap & operator = (const SharedMemoryHashMap &) = delete;
+
+	///
+	/// Get the value associated with the key.
+	///
+	/// This method is lock-free.
+	///
+	/// @param key the key
+	/// @param value set to the value if the key is present
+	/// @return true if the key is present
+	///
+	public: bool get(const K & key, V & value) const {
+		size_t index = homeIndex(key);
+
+		for (size_t m = 0; m < capacity; ++m) {
+			const Snapshot snapshot = read(buckets[index]);
+
+			if (snapshot.state == Empty) {
+				return false;
+			} else if (snapshot.state == Occupied && equal(snapshot.key, key)) {
+				value = snapshot.value;
+				return true;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return false;
+	}
+
+	///
+	/// Returns true if the key is present.
+	///
+	/// This method is lock-free.
+	///
+	public: bool contains(const K & key) const {
+		V value;
+		return get(key, value);
+	}
+
+	///
+	/// Insert the key and value if the key is not present.
+	///
+	/// @return true if the key and value were inserted, false if the key was already present
+	/// @throw SizeException if the map has no free bucket
+	///
+	public: bool insert(const K & key, const V & value) {
+		return write(key, value, false);
+	}
+
+	///
+	/// Insert the key and value, or replace the value if the key is present.
+	///
+	/// @return true if the key and value were inserted, false if the value was replaced
+	/// @throw SizeException if the map has no free bucket
+	///
+	public: bool put(const K & key, const V & value) {
+		return write(key, value, true);
+	}
+
+	///
+	/// Remove the key and its value.
+	///
+	/// @return true if the key was present
+	///
+	public: bool erase(const K & key) {
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(stripeOf(key));
+		const size_t index = locate(key);
+
+		if (index == capacity) {
+			return false;
+		}
+
+		buckets[index].state.store(Deleted, std::memory_order_release);
+		control->count.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	///
+	/// Call the supplied function for each key and value in the map.
+	///
+	/// This method is lock-free. Each entry is read consistently, but the map as a
+	/// whole is not a snapshot if it is concurrently modified.
+	///
+	public: void forEach(const std::function<void (const K &, const V &)> & function) const {
+		for (size_t index = 0; index < capacity; ++index) {
+			const Snapshot snapshot = read(buckets[index]);
+
+			if (snapshot.state == Occupied) {
+				function(snapshot.key, snapshot.value);
+			}
+		}
+	}
+
+	///
+	/// Get the number of entries in the map.
+	///
+	/// Given the concurrent nature of the map, this value is approximate.
+	///
+	public: size_t size() const {
+		return control->count.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the number of buckets in the map.
+	///
+	public: size_t getCapacity() const {
+		return capacity;
+	}
+
+	///
+	/// Get the name of the map within the segment.
+	///
+	public: const std::string & getName() const {
+		return name;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// Bucket states.
+	private: static constexpr uint32_t Empty = 0;
+	private: static constexpr uint32_t Busy = 1;
+	private: static constexpr uint32_t Occupied = 2;
+	private: static constexpr uint32_t Deleted = 3;
+
+	// Reserved memory for the segment's index entries of the named objects.
+	private: static const size_t NamedObjectOverhead = 1024;
+
+	private: struct Control {
+		uint64_t capacity;
+		std::atomic<uint64_t> count;
+		boost::interprocess::interprocess_mutex stripes[StripeCount];
+
+		explicit Control(uint64_t capacity_) : capacity(capacity_), count(0) {}
+	};
+
+	//
+	// The sequence is odd whilst the key or value is being written. The state
+	// is changed atomically. Empty and deleted buckets are claimed by changing
+	// their state to busy, and busy buckets are skipped by readers.
+	//
+	private: struct Bucket {
+		std::atomic<uint32_t> sequence { 0 };
+		std::atomic<uint32_t> state { Empty };
+		K key {};
+		V value {};
+	};
+
+	private: struct Snapshot {
+		uint32_t state;
+		K key;
+		V value;
+	};
+
+	private: static size_t roundCapacity(size_t capacity) {
+		size_t rounded = 1;
+
+		while (rounded < capacity) {
+			rounded <<= 1;
+		}
+
+		return rounded;
+	}
+
+	// Run the function whilst holding the segment's internal lock.
+	private: template <typename FunctionT> void atomically(FunctionT function) {
+		segment.atomic_func(function);
+	}
+
+	private: std::string controlName() const {
+		return name + "_control";
+	}
+
+	private: std::string bucketsName() const {
+		return name + "_buckets";
+	}
+
+	// Called within the segment's atomic function.
+	private: void construct(size_t requestedCapacity) {
+		const size_t roundedCapacity = roundCapacity(requestedCapacity);
+		control = segment.construct<Control>(controlName().c_str())(roundedCapacity);
+		buckets = segment.construct<Bucket>(bucketsName().c_str())[roundedCapacity]();
+		capacity = roundedCapacity;
+		mask = capacity - 1;
+	}
+
+	// Called within the segment's atomic function.
+	private: bool find() {
+		control = segment.find<Control>(controlName().c_str()).first;
+
+		if (control == nullptr) {
+			return false;
+		}
+
+		buckets = segment.find<Bucket>(bucketsName().c_str()).first;
+		capacity = control->capacity;
+		mask = capacity - 1;
+		return true;
+	}
+
+	private: size_t homeIndex(const K & key) const {
+		return HashT()(key) & mask;
+	}
+
+	private: boost::interprocess::interprocess_mutex & stripeOf(const K & key) const {
+		return control->stripes[HashT()(key) & (StripeCount - 1)];
+	}
+
+	private: static bool equal(const K & lhs, const K & rhs) {
+		return std::memcmp(&lhs, &rhs, sizeof(K)) == 0;
+	}
+
+	// Read a consistent copy of a bucket.
+	private: static Snapshot read(const Bucket & bucket) {
+		Snapshot snapshot;
+
+		while (true) {
+			const uint32_t before = bucket.sequence.load(std::memory_order_acquire);
+
+			if ((before & 1U) == 0) {
+				snapshot.state = bucket.state.load(std::memory_order_acquire);
+				std::memcpy(&snapshot.key, &bucket.key, sizeof(K));
+				std::memcpy(&snapshot.value, &bucket.value, sizeof(V));
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (bucket.sequence.load(std::memory_order_relaxed) == before) {
+					return snapshot;
+				}
+			}
+
+			Concurrent::Impl::SharedFutex::pause();
+		}
+	}
+
+	// Write the key and value of a bucket that is owned by the caller.
+	private: static void writeBucket(Bucket & bucket, const K * key, const V & value) {
+		const uint32_t sequence = bucket.sequence.load(std::memory_order_relaxed);
+		bucket.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		if (key != nullptr) {
+			std::memcpy(&bucket.key, key, sizeof(K));
+		}
+
+		std::memcpy(&bucket.value, &value, sizeof(V));
+		bucket.sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	// Get the index of the key's bucket, or capacity if the key is not present.
+	// Called with the key's stripe locked.
+	private: size_t locate(const K & key) const {
+		size_t index = homeIndex(key);
+
+		for (size_t m = 0; m < capacity; ++m) {
+			const Snapshot snapshot = read(buckets[index]);
+
+			if (snapshot.state == Empty) {
+				return capacity;
+			} else if (snapshot.state == Occupied && equal(snapshot.key, key)) {
+				return index;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return capacity;
+	}
+
+	private: bool write(const K & key, const V & value, bool replace) {
+		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(stripeOf(key));
+		const size_t existing = locate(key);
+
+		if (existing != capacity) {
+			if (replace) {
+				writeBucket(buckets[existing], nullptr, value);
+			}
+
+			return false;
+		}
+
+		// The key is not present and cannot be inserted concurrently, as insertions of
+		// the key are serialised by the stripe lock. Claim the first free bucket in the
+		// probe sequence. The buckets before it are not empty, so readers will reach it.
+		const size_t index = claim(key);
+
+		if (index == capacity) {
+			ThrowBalauException(
+				Exception::SizeException, ::toString("The shared memory hash map ", name, " is full (", capacity, " buckets).")
+			);
+		}
+
+		Bucket & bucket = buckets[index];
+		writeBucket(bucket, &key, value);
+		bucket.state.store(Occupied, std::memory_order_release);
+		control->count.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Claim the first empty or deleted bucket in the key's probe sequence, or return capacity if there is none.
+	private: size_t claim(const K & key) {
+		size_t index = homeIndex(key);
+
+		for (size_t m = 0; m < capacity; ++m) {
+			uint32_t state = buckets[index].state.load(std::memory_order_acquire);
+
+			if ((state == Empty || state == Deleted)
+				&& buckets[index].state.compare_exchange_strong(state, Busy, std::memory_order_acq_rel)) {
+				return index;
+			}
+
+			index = (index + 1) & mask;
+		}
+
+		return capacity;
+	}
+
+	private: boost::interprocess::managed_shared_memory & segment;
+	private: const std::string name;
+	private: Control * control = nullptr;
+	private: Bucket * buckets = nullptr;
+	private: size_t capacity = 0;
+	private: size_t mask = 0;
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_HASH_MAP
@@ -0,0 +1,362 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file SharedMemoryObjectPool.hpp
+///
+/// A fixed capacity pool of typed objects in a managed shared memory segment.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_OBJECT_POOL
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_OBJECT_POOL
+
+#include <Balau/Exception/ContainerExceptions.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/SharedMemoryUtils.hpp>
+#include <Balau/Type/ToString.hpp>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+namespace Balau::Interprocess {
+
+///
+/// A fixed capacity pool of typed objects in a managed shared memory segment.
+///
+/// The pool is placed by name into a caller supplied managed shared memory segment,
+/// thus pools and hash maps can share a single named segment. Objects are referenced
+/// via handles, which are slot indices rather than pointers. A handle is valid in
+/// every process that opens the pool, whatever address the segment is mapped at.
+/// Handles can thus be stored in other shared memory structures, for example as the
+/// values of a SharedMemoryHashMap.
+///
+/// Slot allocation and release are lock-free. Free slots are kept in a tagged stack.
+/// Synchronising access to the objects themselves is the responsibility of the caller.
+/// Typically, the objects are created once and then read by all processes.
+///
+/// The object type must not contain pointers into process local memory.
+///
+/// @tparam T the object type
+///
+template <typename T>
+class SharedMemoryObjectPool {
+	///
+	/// The object handle type.
+	///
+	public: using Handle = uint32_t;
+
+	///
+	/// The handle value that does not refer to an object.
+	///
+	public: static constexpr Handle NullHandle = 0xFFFFFFFFU;
+
+	///
+	/// Get the number of bytes of segment space required for a pool of the specified capacity.
+	///
+	public: static size_t requiredSize(size_t capacity) {
+		return sizeof(Control) + capacity * (sizeof(Slot) + sizeof(std::atomic<uint32_t>)) + NamedObjectOverhead;
+	}
+
+	///
+	/// Create an object pool in the supplied segment.
+	///
+	/// @param segment_ the managed shared memory segment in which to place the pool
+	/// @param name_ the name of the pool within the segment
+	/// @param capacity the maximum number of objects in the pool
+	/// @throw SharedMemoryObjectException if a pool with the same name already exists in the segment
+	/// @throw SizeException if the capacity is zero or not less than the null handle
+	///
+	public: SharedMemoryObjectPool(CreateOnlySelector,
+	                               boost::interprocess::managed_shared_memory & segment_,
+	                               const std::string & name_,
+	                               size_t capacity)
+		: segment(segment_)
+		, name(name_) {
+		validateCapacity(capacity);
+
+		atomically([this, capacity] () {
+			if (segment.find<Control>(controlName().c_str()).first != nullptr) {
+				ThrowBalauException(
+					Exception::SharedMemoryObjectException, "The shared memory object pool " + name + " already exists."
+				);
+			}
+
+			construct(capacity);
+		});
+	}
+
+	///
+	/// Open or create an object pool in the supplied segment.
+	///
+	/// If the pool already exists, the capacity is ignored.
+	///
+	/// @param segment_ the managed shared memory segment in which to place the pool
+	/// @param name_ the name of the pool within the segment
+	/// @param capacity the maximum number of objects in the pool
+	/// @throw SizeException if the capacity is zero or not less than the null handle
+	///
+	public: SharedMemoryObjectPool(OpenOrCreateSelector,
+	                               boost::interprocess::managed_shared_memory & segment_,
+	                               const std::string & name_,
+	                               size_t capacity)
+		: segment(segment_)
+		, name(name_) {
+		validateCapacity(capacity);
+
+		atomically([this, capacity] () {
+			if (!find()) {
+				construct(capacity);
+			}
+		});
+	}
+
+	///
+	/// Open an existing object pool in the supplied segment.
+	///
+	/// @param segment_ the managed shared memory segment containing the pool
+	/// @param name_ the name of the pool within the segment
+	/// @throw SharedMemoryObjectException if the pool does not exist
+	///
+	public: SharedMemoryObjectPool(OpenOnlySelector, boost::interprocess::managed_shared_memory & segment_, const std::string & name_)
+		: segment(segment_)
+		, name(name_) {
+		bool found = false;
+		atomically([this, &found] () { found = find(); });
+
+		if (!found) {
+			ThrowBalauException(
+				Exception::SharedMemoryObjectException, "The shared memory object pool " + name + " was not found."
+			);
+		}
+	}
+
+	public: SharedMemoryObjectPool(const SharedMemoryObjectPool &) = delete;
+	public: SharedMemoryObjectPool & operator = (const SharedMemoryObjectPool &) = delete;
+
+	///
+	/// Construct an object in a free slot.
+	///
+	/// @param params the object's constructor arguments
+	/// @return the handle of the new object
+	/// @throw SizeException if the pool has no free slot
+	///
+	public: template <typename ... ParamT> Handle create(ParamT && ... params) {
+		const Handle handle = pop();
+
+		if (handle == NullHandle) {
+			ThrowBalauException(
+				Exception::SizeException, ::toString("The shared memory object pool ", name, " is full (", capacity, " objects).")
+			);
+		}
+
+		try {
+			new (slots[handle].storage) T(std::forward<ParamT>(params) ...);
+		} catch (...) {
+			push(handle);
+			throw;
+		}
+
+		control->count.fetch_add(1, std::memory_order_relaxed);
+		return handle;
+	}
+
+	///
+	/// Destroy the object and release its slot.
+	///
+	/// The handle must have been obtained from create and must not be used afterwards.
+	///
+	public: void destroy(Handle handle) {
+		get(handle).~T();
+		control->count.fetch_sub(1, std::memory_order_relaxed);
+		push(handle);
+	}
+
+	///
+	/// Get the object referenced by the handle.
+	///
+	public: T & get(Handle handle) {
+		Assert::assertion(handle < capacity, "SharedMemoryObjectPool handle out of range.");
+		return *std::launder(reinterpret_cast<T *>(slots[handle].storage));
+	}
+
+	///
+	/// Get the object referenced by the handle.
+	///
+	public: const T & get(Handle handle) const {
+		Assert::assertion(handle < capacity, "SharedMemoryObjectPool handle out of range.");
+		return *std::launder(reinterpret_cast<const T *>(slots[handle].storage));
+	}
+
+	///
+	/// Get the object referenced by the handle.
+	///
+	public: T & operator [] (Handle handle) {
+		return get(handle);
+	}
+
+	///
+	/// Get the object referenced by the handle.
+	///
+	public: const T & operator [] (Handle handle) const {
+		return get(handle);
+	}
+
+	///
+	/// Get the number of objects in the pool.
+	///
+	/// Given the concurrent nature of the pool, this value is approximate.
+	///
+	public: size_t size() const {
+		return control->count.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the maximum number of objects in the pool.
+	///
+	public: size_t getCapacity() const {
+		return capacity;
+	}
+
+	///
+	/// Get the name of the pool within the segment.
+	///
+	public: const std::string & getName() const {
+		return name;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// Reserved memory for the segment's index entries of the named objects.
+	private: static const size_t NamedObjectOverhead = 1024;
+
+	//
+	// The free stack head contains the top slot index in the low 32 bits and a
+	// modification tag in the high 32 bits, in order to avoid the ABA problem.
+	//
+	private: struct Control {
+		uint64_t capacity;
+		std::atomic<uint64_t> head;
+		std::atomic<uint64_t> count;
+
+		explicit Control(uint64_t capacity_) : capacity(capacity_), head(0), count(0) {}
+	};
+
+	private: struct Slot {
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	private: static void validateCapacity(size_t capacity) {
+		if (capacity == 0 || capacity >= NullHandle) {
+			ThrowBalauException(
+				Exception::SizeException, "The shared memory object pool capacity must be between 1 and 2^32 - 2."
+			);
+		}
+	}
+
+	// Run the function whilst holding the segment's internal lock.
+	private: template <typename FunctionT> void atomically(FunctionT function) {
+		segment.atomic_func(function);
+	}
+
+	private: std::string controlName() const {
+		return name + "_control";
+	}
+
+	private: std::string slotsName() const {
+		return name + "_slots";
+	}
+
+	private: std::string linksName() const {
+		return name + "_links";
+	}
+
+	// Called within the segment's atomic function.
+	private: void construct(size_t requestedCapacity) {
+		control = segment.construct<Control>(controlName().c_str())(requestedCapacity);
+		slots = segment.construct<Slot>(slotsName().c_str())[requestedCapacity]();
+		links = segment.construct<std::atomic<uint32_t>>(linksName().c_str())[requestedCapacity](0U);
+		capacity = requestedCapacity;
+
+		for (size_t m = 0; m < capacity - 1; ++m) {
+			links[m].store((uint32_t) (m + 1), std::memory_order_relaxed);
+		}
+
+		links[capacity - 1].store(NullHandle, std::memory_order_relaxed);
+		control->head.store(0, std::memory_order_release);
+	}
+
+	// Called within the segment's atomic function.
+	private: bool find() {
+		control = segment.find<Control>(controlName().c_str()).first;
+
+		if (control == nullptr) {
+			return false;
+		}
+
+		slots = segment.find<Slot>(slotsName().c_str()).first;
+		links = segment.find<std::atomic<uint32_t>>(linksName().c_str()).first;
+		capacity = control->capacity;
+		return true;
+	}
+
+	private: Handle pop() {
+		uint64_t head = control->head.load(std::memory_order_acquire);
+
+		while (true) {
+			const auto index = (Handle) head;
+
+			if (index == NullHandle) {
+				return NullHandle;
+			}
+
+			const uint64_t next = ((head >> 32U) + 1) << 32U | links[index].load(std::memory_order_relaxed);
+
+			if (control->head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return index;
+			}
+		}
+	}
+
+	private: void push(Handle handle) {
+		uint64_t head = control->head.load(std::memory_order_relaxed);
+
+		while (true) {
+			links[handle].store((Handle) head, std::memory_order_relaxed);
+			const uint64_t next = ((head >> 32U) + 1) << 32U | handle;
+
+			if (control->head.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+	}
+
+	private: boost::interprocess::managed_shared_memory & segment;
+	private: const std::string name;
+	private: Control * control = nullptr;
+	private: Slot * slots = nullptr;
+	private: std::atomic<uint32_t> * links = nullptr;
+	private: size_t capacity = 0;
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_OBJECT_POOL
@@ -26,25 +26,28 @@
 #ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_QUEUE
 #define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_QUEUE
 
+#include <Balau/Concurrent/Impl/Futex.hpp>
 #include <Balau/Container/BlockingQueue.hpp>
 #include <Balau/Exception/ContainerExceptions.hpp>
 #include <Balau/Interprocess/MSharedMemoryObject.hpp>
 #include <Balau/Interprocess/SharedMemoryUtils.hpp>
+#include <Balau/Interprocess/Impl/BlobArena.hpp>
+#include <Balau/Interprocess/Impl/RobustMutex.hpp>
 #include <Balau/Interprocess/Impl/SharedMemoryQueueImpl.hpp>
+#include <Balau/Serialization/Marshallers.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
 #include <Balau/Type/UUID.hpp>
 #include <Balau/Util/Vectors.hpp>
 #include <Balau/Util/PrettyPrint.hpp>
 
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/archive/binary_oarchive.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
 #include <boost/interprocess/managed_shared_memory.hpp>
-#include <boost/iostreams/device/back_inserter.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/stream.hpp>
 
-#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 // Ignore false positives for constructor field initialisation.
 #pragma clang diagnostic push
@@ -59,45 +62,62 @@ namespace Balau::Interprocess {
 /// create a shared memory queue, and implements the Balau::Container::BlockingQueue
 /// API.
 ///
-/// The implementation uses the Boost serialization library for marshalling and
-/// unmarshalling of objects. In order to use the queue, the object type T must
-/// provide Boost serialize or save/load methods.
+/// By default, the implementation uses the Boost serialization library for
+/// marshalling and unmarshalling of objects. In order to use the queue, the object
+/// type T must provide Boost serialize or save/load methods. The faster flat
+/// serialisation format can be selected by specifying Serialization::FlatMarshaller
+/// as the marshaller type. Flat serialisation uses the same serialize methods.
 ///
-/// This queue implementation has the following concurrency guarantees.
+/// Objects whose serialised size + header size exceeds the queue buffer size are
+/// written once into a shared memory blob arena, and a small descriptor of the
+/// blob is sent through the queue. The dequeueing process unmarshals the object
+/// directly from the arena and frees the blob. The arena is created on the first
+/// oversize enqueue, with a size of DefaultBlobArenaSize or four times the size
+/// of the oversize message, whichever is greater. When the arena is full,
+/// enqueueing waits for blobs to be freed. A message that is too large for the
+/// arena's segments causes the arena to grow by an additional segment sized for
+/// the message. A SizeException is only thrown when the arena already has
+/// BlobArena::MaximumSegmentCount segments.
 ///
 /// The queue can be used for concurrent enqueues and concurrent dequeues across
-/// processes/threads if the maximum enqueued serialised object size + header size
-/// is guaranteed to be smaller than the shared memory queue buffer size.
+/// processes/threads, regardless of the serialised object sizes.
 ///
-/// If the above guarantee cannot be met, the queue can be used for concurrent
-/// enqueues across processes/threads, but only synchronised dequeues in a single
-/// process. This is due to the dequeueing of partial objects occurring in one
-/// process, rendering the continuation of the dequeueing of that object impossible
-/// in other processes.
+/// Objects can be enqueued and dequeued in batches via the enqueueAll and
+/// dequeueUpTo methods. The enqueueAll method packs as many objects as will fit
+/// into each queue buffer, thus amortising the header and message queue
+/// synchronisation cost across the batch. When a dequeue call receives a batch
+/// containing more objects than were requested, the remaining objects are placed
+/// in a leftover list held in the blob arena. The leftover list is shared by all
+/// processes using the queue and is drained before the message queue by every
+/// dequeue call, thus leftover objects are dequeued before any subsequently
+/// received buffer, regardless of its priority. If the arena has no free space,
+/// the leftover objects are held by the dequeueing queue instance instead of
+/// waiting for space, and are dequeued by the next dequeue call on the instance.
 ///
-/// If this limitation is breached, the application(s) will be defective due to:
-///  - dequeues of partial objects occurring across different processes/threads;
-///  - unprotected mutation of the std::dequeue used to hold pending dequeue buffers.
-///
-/// Note that the second of the above points necessitates a single threaded or
-/// mutex protected dequeueing in the dequeueing process when oversize objects
-/// are being enqueued.
-///
-/// The tryEnqueue methods have additional constraints. Due to the requirement of
-/// atomicity, the tryEnqueue methods can only be used for object sizes where the
-/// maximum enqueued serialised object size + header size is smaller than the
-/// shared memory queue buffer size. If this is not the case, a SizeException will
-/// be thrown.
+/// Blocked dequeue calls park on a process shared event count, which producers
+/// and consumers that place leftover objects notify. The leftover list is guarded
+/// by a robust mutex, thus a consumer that dies whilst holding the lock does not
+/// block the other consumers.
 ///
 /// @tparam T the type of enqueued/dequeued objects
+/// @tparam MarshallerT the marshaller policy (Boost archives by default)
 ///
-template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<T> {
+template <typename T, typename MarshallerT = Serialization::BoostArchiveMarshaller>
+class SharedMemoryQueue : public Container::BlockingQueue<T> {
 	private: using CharVector = std::vector<char>;
 
 	public: static const unsigned int HeaderSize = sizeof(Impl::QueueHeader);
 	public: static const unsigned int MinimumChunkSize = 2 * HeaderSize;
 	public: static const unsigned int DefaultPriority = 0;
 
+	///
+	/// The minimum size of the blob arena that holds oversize messages.
+	///
+	public: static constexpr size_t DefaultBlobArenaSize = 64 * 1024 * 1024;
+
+	// The size of the length prefix of each object in a batch buffer.
+	private: static const unsigned int BatchLengthSize = sizeof(uint32_t);
+
 	///
 	/// Create a shared memory queue of type T and with the specified capacity.
 	///
@@ -154,7 +174,8 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 		, queue(CreateOnlySelector(), name.c_str(), capacity, bufferSize_)
 		, chunkSize(bufferSize_)
 		, queueState(CreateOnlySelector(), name + "_queueState")
-		, throwOnOversize(throwOnOversize_) {}
+		, throwOnOversize(throwOnOversize_)
+		, ownsBlobArena(true) {}
 
 	///
 	/// Open or create a shared memory queue of type T and with the specified capacity.
@@ -217,6 +238,17 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 		, queueState(OpenOnlySelector(), name + "_queueState")
 		, throwOnOversize(throwOnOversize_) {}
 
+	///
+	/// Destroy the queue instance.
+	///
+	/// If this instance created the queue, the blob arena is removed.
+	///
+	public: ~SharedMemoryQueue() {
+		if (ownsBlobArena) {
+			Impl::BlobArena::remove(blobArenaName());
+		}
+	}
+
 	///
 	/// Enqueue an object with a priority of zero.
 	///
@@ -239,56 +271,75 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and the object is oversize
 	///
 	public: void enqueue(const T & object, unsigned int priority) {
-		const Impl::QueueHeader messageHeader { queueState->sequenceNumber++, 1, 0, 0 };
+		const Impl::QueueHeader messageHeader { 0, 1, 0, 0 };
 		CharVector & marshalBuffer = Impl::SharedMemoryQueueTLS::storage().marshalBuffer;
 		marshalBuffer.clear();
 
 		marshal(marshalBuffer, object, messageHeader);
+		send(marshalBuffer, priority);
+	}
 
-		const unsigned int totalBytes = (unsigned int) marshalBuffer.size() - HeaderSize;
-		auto * marshalHeader = (Impl::QueueHeader *) marshalBuffer.data();
-		marshalHeader->totalBytes = totalBytes;
+	///
+	/// Enqueue all the objects in the supplied range with a priority of zero.
+	///
+	/// The objects are packed into as few queue buffers as possible. An object that
+	/// does not fit into a single buffer is enqueued on its own, as per the enqueue method.
+	///
+	/// If the queue is full, this call will block until there is a slot available.
+	///
+	/// @param range the range of objects to serialise and enqueue
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and an object is oversize
+	///
+	public: template <typename RangeT> void enqueueAll(const RangeT & range) {
+		enqueueAll(range, DefaultPriority);
+	}
 
-		if (marshalBuffer.size() <= chunkSize) {
-			// The message fits in a single buffer.
-			queue.send(marshalBuffer.data(), marshalBuffer.size(), priority);
-		} else {
-			// The object is split across multiple buffers.
-			// This code avoids copying by writing each header into the marshal buffer,
-			// in the discarded area just before the next data to be sent.
-
-			if (throwOnOversize) {
-				ThrowBalauException(
-					  Exception::SizeException
-					, ::toString(
-						  "The serialized message is too large to fit into a single message "
-						, "(", marshalBuffer.size(), "/", chunkSize, ")."
-					)
-				);
+	///
+	/// Enqueue all the objects in the supplied range with the specified priority.
+	///
+	/// The objects are packed into as few queue buffers as possible. An object that
+	/// does not fit into a single buffer is enqueued on its own, as per the enqueue method.
+	///
+	/// If the queue is full, this call will block until there is a slot available.
+	///
+	/// @param range the range of objects to serialise and enqueue
+	/// @param priority the enqueuing priority
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and an object is oversize
+	///
+	public: template <typename RangeT> void enqueueAll(const RangeT & range, unsigned int priority) {
+		CharVector & batchBuffer = Impl::SharedMemoryQueueTLS::storage().marshalBuffer;
+		batchBuffer.clear();
+		batchBuffer.resize(HeaderSize);
+		unsigned int objectCount = 0;
+
+		for (const auto & object : range) {
+			// Each object is prefixed with its marshalled length.
+			const size_t objectStart = batchBuffer.size();
+			batchBuffer.resize(objectStart + BatchLengthSize);
+			MarshallerT::marshal(batchBuffer, object);
+			const auto objectBytes = (uint32_t) (batchBuffer.size() - objectStart - BatchLengthSize);
+			memcpy(batchBuffer.data() + objectStart, &objectBytes, BatchLengthSize);
+
+			if (batchBuffer.size() > chunkSize && objectCount > 0) {
+				// Send the objects preceding this one and move this one to the start of the next batch.
+				sendBatch(batchBuffer, objectStart, objectCount, priority);
+				batchBuffer.erase(batchBuffer.begin() + HeaderSize, batchBuffer.begin() + (ptrdiff_t) objectStart);
+				objectCount = 0;
 			}
 
-			const unsigned int chunkCount = calculateChunkCount(totalBytes);
-			size_t dataStart = HeaderSize;
-
-			for (unsigned int m = 0; m < chunkCount; m++) {
-				size_t chunkStart = dataStart - HeaderSize;
-				auto & chunkHeader = * (Impl::QueueHeader *) (marshalBuffer.data() + chunkStart);
-				chunkHeader.sequenceNumber = messageHeader.sequenceNumber;
-				chunkHeader.chunkCount = chunkCount;
-				chunkHeader.chunkNumber = m;
-				chunkHeader.totalBytes = totalBytes;
-
-				// Account for a potentially partial buffer for the last queue buffer.
-				const size_t chunkBytes = m < chunkCount - 1
-					? chunkSize
-					: marshalBuffer.size() - chunkStart;
-
-				queue.send(marshalBuffer.data() + chunkStart, chunkBytes, priority);
-
-				// The start of the data is moved forward the size of the buffer less the header size.
-				dataStart += chunkSize - HeaderSize;
+			if (batchBuffer.size() > chunkSize) {
+				// A single oversize object is sent via the blob arena.
+				batchBuffer.erase(batchBuffer.begin() + HeaderSize, batchBuffer.begin() + HeaderSize + BatchLengthSize);
+				send(batchBuffer, priority);
+				batchBuffer.resize(HeaderSize);
+			} else {
+				++objectCount;
 			}
 		}
+
+		if (objectCount > 0) {
+			sendBatch(batchBuffer, batchBuffer.size(), objectCount, priority);
+		}
 	}
 
 	///
@@ -296,12 +347,12 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// If the queue is full, this call will return false.
 	///
-	/// As this try enqueuing action must be atomic, this method always throws a size
-	/// exception if the object is oversize.
+	/// An oversize object is placed in the blob arena. If the arena is full, the
+	/// wait time also applies to waiting for space in the arena.
 	///
 	/// @param object the object to serialise and enqueue
 	/// @return true if the enqueue occurred, false otherwise
-	/// @throw SizeException if the object is oversize
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and the object is oversize
 	///
 	public: bool tryEnqueue(T object) override {
 		return tryEnqueue(std::move(object), std::chrono::milliseconds(0), DefaultPriority);
@@ -312,13 +363,13 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// If the queue is full, this call will wait a limited amount of time for space to be available.
 	///
-	/// As this try enqueuing action must be atomic, this method always throws a size
-	/// exception if the object is oversize.
+	/// An oversize object is placed in the blob arena. If the arena is full, the
+	/// wait time also applies to waiting for space in the arena.
 	///
 	/// @param object the object to serialise and enqueue
 	/// @param waitTime the number of milliseconds to wait if the queue is full
 	/// @return true if the enqueue occurred, false otherwise
-	/// @throw SizeException if the object is oversize
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and the object is oversize
 	///
 	public: bool tryEnqueue(T object, std::chrono::milliseconds waitTime) override {
 		return tryEnqueue(std::move(object), waitTime, DefaultPriority);
@@ -329,12 +380,12 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// If the queue is full, this call will return false.
 	///
-	/// As this try enqueuing action must be atomic, this method always throws a size
-	/// exception if the object is oversize.
+	/// An oversize object is placed in the blob arena. If the arena is full, the
+	/// wait time also applies to waiting for space in the arena.
 	///
 	/// @param object the object to serialise and enqueue
 	/// @return true if the enqueue occurred, false otherwise
-	/// @throw SizeException if the object is oversize
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and the object is oversize
 	///
 	public: bool tryEnqueue(T object, unsigned int priority) {
 		return tryEnqueue(std::move(object), std::chrono::milliseconds(0), priority);
@@ -345,88 +396,65 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// If the queue is full, this call will wait a limited amount of time for space to be available.
 	///
-	/// As this try enqueuing action must be atomic, this method always throws a size
-	/// exception if the object is oversize.
+	/// An oversize object is placed in the blob arena. If the arena is full, the
+	/// wait time also applies to waiting for space in the arena.
 	///
 	/// @param object the object to serialise and enqueue
 	/// @param waitTime the number of milliseconds to wait if the queue is full
 	/// @return true if the enqueue occurred, false otherwise
-	/// @throw SizeException if the object is oversize
+	/// @throw SizeException if enqueueing of oversize objects was set to forbidden and the object is oversize
 	///
 	public: bool tryEnqueue(T object, std::chrono::milliseconds waitTime, unsigned int priority) {
-		const Impl::QueueHeader messageHeader { queueState->sequenceNumber++, 1, 0, 0 };
+		const Impl::QueueHeader messageHeader { 0, 1, 0, 0 };
 		CharVector & marshalBuffer = Impl::SharedMemoryQueueTLS::storage().marshalBuffer;
 		marshalBuffer.clear();
 
 		marshal(marshalBuffer, object, messageHeader);
 
-		const unsigned int totalBytes = (unsigned int) marshalBuffer.size() - HeaderSize;
-		auto * marshalHeader = (Impl::QueueHeader *) marshalBuffer.data();
-		marshalHeader->totalBytes = totalBytes;
+		const auto deadline = boost::posix_time::microsec_clock::universal_time()
+			+ boost::posix_time::milliseconds(waitTime.count());
 
 		if (marshalBuffer.size() <= chunkSize) {
 			// The message fits in a single buffer.
-			auto timeout = boost::posix_time::microsec_clock::local_time() + boost::posix_time::millisec(waitTime.count());
-			return queue.timed_send(marshalBuffer.data(), marshalBuffer.size(), priority, timeout);
-		} else {
-			// Oversize objects cannot be try enqueued, thus an exception is thrown.
-			ThrowBalauException(
-				  Exception::SizeException
-				, ::toString(
-					"The serialized message is too large to fit into a single message "
-					, "(", marshalBuffer.size(), "/", chunkSize, ")."
-				)
-			);
+			setHeader(marshalBuffer, 1, 0, (unsigned int) marshalBuffer.size() - HeaderSize);
+
+			if (!queue.timed_send(marshalBuffer.data(), marshalBuffer.size(), priority, deadline)) {
+				return false;
+			}
+
+			queueState->available.notify();
+			return true;
+		}
+
+		const size_t totalBytes = marshalBuffer.size() - HeaderSize;
+		checkOversize(marshalBuffer);
+		auto & arena = blobArena(totalBytes);
+		const auto blob = arena.tryAllocate(totalBytes, waitTime);
+
+		if (blob == Impl::BlobArena::NoBlob) {
+			return false;
+		}
+
+		std::memcpy(arena.address(blob), marshalBuffer.data() + HeaderSize, totalBytes);
+
+		if (!sendBlobDescriptor(blob, totalBytes, priority, &deadline)) {
+			arena.free(blob, totalBytes);
+			return false;
 		}
+
+		return true;
 	}
 
 	///
 	/// Dequeue an object.
 	///
-	/// When the queue is being used with oversize objects (which require multiple
-	/// queue receives, this method may only be used via synchronised calls.
-	///
 	/// @return the dequeued object
 	///
 	public: T dequeue() override {
-		CharVector & queueBuffer = Impl::SharedMemoryQueueTLS::storage().queueBuffer;
-		unsigned long receivedSize;
-		unsigned int priority;
-
-		dequeueNextBuffer(queueBuffer, receivedSize, priority, 0);
-
-		const auto * queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
-
-		if (queueHeader->chunkCount == 1) {
-			// The entire object fits in a single buffer.
-			return unmarshal(queueBuffer);
-		} else if (queueHeader->chunkNumber < queueHeader->chunkCount) {
-			// The object is split across multiple buffers, potentially interleaved with other buffers.
-			return performMultiChunkDequeue(
-				queueBuffer, receivedSize, priority
-				, [this] (CharVector &,
-					      CharVector & queueBuffer,
-					      unsigned long & thisReceivedSize,
-					      unsigned int & thisPriority,
-					      size_t rejected) {
-					dequeueNextBuffer(queueBuffer, thisReceivedSize, thisPriority, rejected);
-					return true;
-				}
-			);
-		} else {
-			// This is a partially dequeued multi-chunk dequeue which was previously placed on the pending queue.
-			return completeMultiChunkDequeue(
-				queueBuffer, receivedSize, priority
-				, [this] (CharVector &,
-					      CharVector & queueBuffer,
-					      unsigned long & thisReceivedSize,
-					      unsigned int & thisPriority,
-					      size_t rejected) {
-					dequeueNextBuffer(queueBuffer, thisReceivedSize, thisPriority, rejected);
-					return true;
-				}
-			);
-		}
+		T object;
+		T * output = &object;
+		dequeueUntil(1, output, std::chrono::steady_clock::time_point::max());
+		return object;
 	}
 
 	///
@@ -434,9 +462,6 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// if no dequeue was made, a default constructed object is returned.
 	///
-	/// When the queue is being used with oversize objects (which require multiple
-	/// queue receives, this method may only be used via synchronised calls.
-	///
 	/// @return the dequeued object or a default constructed object otherwise
 	///
 	public: T tryDequeue() override {
@@ -447,9 +472,6 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// Try to dequeue an object.
 	///
-	/// When the queue is being used with oversize objects (which require multiple
-	/// queue receives, this method may only be used via synchronised calls.
-	///
 	/// @param success set to true on a successful dequeue, false otherwise
 	/// @return the dequeued object or a default constructed object otherwise
 	///
@@ -462,9 +484,6 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// if no dequeue was made, a default constructed object is returned.
 	///
-	/// When the queue is being used with oversize objects (which require multiple
-	/// queue receives, this method may only be used via synchronised calls.
-	///
 	/// @param waitTime the time in milliseconds to wait for an object to become available
 	/// @return the dequeued object or a default constructed object if no object was dequeued
 	///
@@ -478,70 +497,31 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	///
 	/// if no dequeue was made, a default constructed object is returned.
 	///
-	/// When the queue is being used with oversize objects (which require multiple
-	/// queue receives, this method may only be used via synchronised calls.
-	///
 	/// @param waitTime the time in milliseconds to wait for an object to become available
 	/// @param success a reference to a boolean that is set to true on success and false otherwise
 	/// @return the dequeued object or a default constructed object if no object was dequeued
 	///
 	public: T tryDequeue(std::chrono::milliseconds waitTime, bool & success) override {
-		CharVector & queueBuffer = Impl::SharedMemoryQueueTLS::storage().queueBuffer;
-
-		unsigned long receivedSize;
-		unsigned int priority;
-
-		if (!tryDequeueNextBuffer(queueBuffer, receivedSize, priority, 0, waitTime)) {
-			return T();
-		}
-
-		const auto * queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
+		T object;
+		T * output = &object;
+		success = dequeueUntil(1, output, std::chrono::steady_clock::now() + waitTime) == 1;
+		return object;
+	}
 
-		if (queueHeader->chunkCount == 1) {
-			// The entire object fits in a single buffer.
-			return unmarshal(queueBuffer);
-		} else if (queueHeader->chunkNumber < queueHeader->chunkCount) {
-			// The object is split across multiple buffers, potentially interleaved with other buffers.
-			return performMultiChunkDequeue(
-				queueBuffer, receivedSize, priority
-				, [waitTime, this] (CharVector & marshalBuffer,
-					                CharVector & queueBuffer,
-					                unsigned long & thisReceivedSize,
-					                unsigned int & thisPriority,
-					                size_t rejected) {
-					if (!tryDequeueNextBuffer(queueBuffer, thisReceivedSize, thisPriority, rejected, waitTime)) {
-						pendingBuffers.emplace_front(
-							PendingBuffer(std::move(marshalBuffer), marshalBuffer.size(), thisPriority)
-						);
-
-						marshalBuffer = CharVector();
-						return false;
-					}
-
-					return true;
-				}
-			);
-		} else {
-			// This is a partially dequeued multi-chunk dequeue which was previously placed on the pending queue.
-			return completeMultiChunkDequeue(
-				queueBuffer, receivedSize, priority
-				, [waitTime, this] (CharVector & marshalBuffer,
-					                CharVector & queueBuffer,
-					                unsigned long & thisReceivedSize,
-					                unsigned int & thisPriority,
-					                size_t rejected) {
-					if (!tryDequeueNextBuffer(queueBuffer, thisReceivedSize, thisPriority, rejected, waitTime)) {
-						pendingBuffers.emplace_front(
-							PendingBuffer(std::move(queueBuffer), queueBuffer.size(), thisPriority)
-						);
-						marshalBuffer = CharVector();
-						return false;
-					}
-
-					return true;
-				}
-			);
-		}
+	///
+	/// Dequeue up to the specified number of objects, waiting a limited amount of time for an object to become available if the queue is empty.
+	///
+	/// Only the first buffer is waited for. Subsequent buffers are dequeued until the
+	/// maximum is reached or the queue is empty.
+	///
+	/// @param maximum the maximum number of objects to dequeue
+	/// @param output the output iterator that the dequeued objects are moved into
+	/// @param waitTime the time in milliseconds to wait for an object to become available
+	/// @return the number of objects dequeued
+	///
+	public: template <typename OutputIteratorT>
+	size_t dequeueUpTo(size_t maximum, OutputIteratorT output, std::chrono::milliseconds waitTime) {
+		return dequeueUntil(maximum, output, std::chrono::steady_clock::now() + waitTime);
 	}
 
 	public: bool full() const override {
@@ -549,7 +529,7 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	}
 
 	public: bool empty() const override {
-		return queue.get_num_msg() == 0;
+		return !hasLeftovers() && queue.get_num_msg() == 0;
 	}
 
 	///
@@ -563,168 +543,378 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 
 	////////////////////////// Private implementation /////////////////////////
 
-	//
-	// Shared between the dequeue and tryDequeue methods.
-	// The object is split across multiple buffers, potentially interleaved with other buffers.
-	// The supplied queue buffer is the first received chunk.
-	//
-	private: template <typename DequeueFunctionT>
-	T performMultiChunkDequeue(CharVector & queueBuffer,
-	                           unsigned long & receivedSize,
-	                           unsigned int & priority,
-	                           DequeueFunctionT dequeueFunction) {
-		const auto * queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
-		const unsigned int totalBytes = queueHeader->totalBytes;
+	// Dequeue up to maximum objects, taking leftover objects before receiving buffers.
+	// Only the first object is waited for, until the deadline.
+	private: template <typename OutputIteratorT>
+	size_t dequeueUntil(size_t maximum, OutputIteratorT & output, std::chrono::steady_clock::time_point deadline) {
+		CharVector & queueBuffer = Impl::SharedMemoryQueueTLS::storage().queueBuffer;
+		size_t dequeued = 0;
 
-		CharVector & marshalBuffer = Impl::SharedMemoryQueueTLS::storage().marshalBuffer;
-		marshalBuffer.clear();
-		marshalBuffer.resize(HeaderSize + totalBytes);
-
-		// Set up the header in case the marshal buffer ends up on the pending queue (tryDequeue only).
-		memcpy(marshalBuffer.data(), queueBuffer.data(), HeaderSize);
-		auto * marshalHeader = (Impl::QueueHeader *) marshalBuffer.data();
-		marshalHeader->chunkNumber = marshalHeader->chunkCount;
-
-		size_t rejectedPendingBuffers = 0;
-		const unsigned long sequenceNumber = queueHeader->sequenceNumber;
-		unsigned int partsLeft = queueHeader->chunkCount;
-
-		while (true) {
-			if (queueHeader->sequenceNumber != sequenceNumber) { // Never true on the first iteration.
-				++rejectedPendingBuffers;
-				pendingBuffers.emplace_back(PendingBuffer(std::move(queueBuffer), receivedSize, priority));
-				queueBuffer = CharVector(chunkSize);
-			} else {
-				// This can occur out of order (if the chunks arrive out of order).
-				const size_t copyStart = HeaderSize + queueHeader->chunkNumber * (chunkSize - HeaderSize);
-				const size_t byteCount = queueBuffer.size() - HeaderSize;
-				memcpy(marshalBuffer.data() + copyStart, queueBuffer.data() + HeaderSize, byteCount);
-				++marshalHeader->chunkNumber;
-				--partsLeft;
+		while (dequeued < maximum) {
+			dequeued += takeLeftovers(maximum - dequeued, output);
+
+			if (dequeued == maximum) {
+				break;
 			}
 
-			if (partsLeft == 0) {
-				return unmarshal(marshalBuffer);
+			if (tryReceive(queueBuffer)) {
+				dequeued += unpackBuffer(queueBuffer, maximum - dequeued, output);
+				continue;
 			}
 
-			if (!dequeueFunction(marshalBuffer, queueBuffer, receivedSize, priority, rejectedPendingBuffers)) {
-				// Only occurs for tryDequeue.
-				return T();
+			if (dequeued > 0) {
+				break;
 			}
 
-			queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
+			// Park until a buffer is sent or leftover objects are placed.
+			const bool available = queueState->available.await(
+				[this] () { return hasLeftovers() || queue.get_num_msg() != 0; }, 0, deadline
+			);
+
+			if (!available) {
+				break;
+			}
+		}
+
+		return dequeued;
+	}
+
+	// Receive the next buffer if the queue is not empty.
+	private: bool tryReceive(CharVector & buffer) {
+		unsigned long receivedSize;
+		unsigned int priority;
+
+		buffer.resize(chunkSize);
+
+		if (queue.try_receive(buffer.data(), buffer.size(), receivedSize, priority)) {
+			buffer.resize(receivedSize);
+			return true;
+		} else {
+			return false;
 		}
 	}
 
-	//
-	// Shared between the dequeue and tryDequeue methods.
-	// The object is split across multiple buffers, potentially interleaved with other buffers.
-	// The supplied marshal buffer is part filled with previously dequeue chunk(s)
-	// and already the correct length.
-	//
-	private:
-	template <typename DequeueFunctionT>
-	T completeMultiChunkDequeue(CharVector & marshalBuffer,
-	                            unsigned long & receivedSize,
-	                            unsigned int & priority,
-	                            DequeueFunctionT dequeueFunction) {
-		auto * marshalHeader = (Impl::QueueHeader *) marshalBuffer.data();
-		const unsigned int totalBytes = marshalHeader->totalBytes;
-
-		Assert::assertion(
-			  receivedSize == totalBytes + HeaderSize
-			, "Received size of partially dequeued buffer is not the same as the size of the buffer."
-		);
-
-		size_t rejectedPendingBuffers = 0;
-		const unsigned long sequenceNumber = marshalHeader->sequenceNumber;
-		unsigned int partsLeft = 2 * marshalHeader->chunkCount - marshalHeader->chunkNumber;
-		CharVector queueBuffer {};
-
-		while (true) {
-			if (!dequeueFunction(marshalBuffer, queueBuffer, receivedSize, priority, rejectedPendingBuffers)) {
-				// Only occurs for tryDequeue.
-				return T();
+	// Unmarshal up to maximum objects from the received buffer into the output iterator.
+	private: template <typename OutputIteratorT>
+	size_t unpackBuffer(const CharVector & queueBuffer, size_t maximum, OutputIteratorT & output) {
+		const auto * queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
+
+		if (queueHeader->chunkCount == Impl::QueueHeader::BatchChunkCount) {
+			return unpackBatch(queueBuffer, maximum, output);
+		} else if (queueHeader->chunkCount == Impl::QueueHeader::BlobChunkCount) {
+			*output = unmarshalBlob(queueBuffer);
+			++output;
+		} else {
+			*output = unmarshal(queueBuffer);
+			++output;
+		}
+
+		return 1;
+	}
+
+	// Send a marshalled object, placing it in the blob arena if it does not fit into a single buffer.
+	// The buffer starts with space for the header, which is written by this method.
+	private: void send(CharVector & marshalBuffer, unsigned int priority) {
+		if (marshalBuffer.size() <= chunkSize) {
+			// The message fits in a single buffer.
+			setHeader(marshalBuffer, 1, 0, (unsigned int) marshalBuffer.size() - HeaderSize);
+			queue.send(marshalBuffer.data(), marshalBuffer.size(), priority);
+			queueState->available.notify();
+			return;
+		}
+
+		// The payload is written once into the blob arena and a descriptor is sent.
+		const size_t totalBytes = marshalBuffer.size() - HeaderSize;
+		checkOversize(marshalBuffer);
+		auto & arena = blobArena(totalBytes);
+		const auto blob = arena.allocate(totalBytes);
+		std::memcpy(arena.address(blob), marshalBuffer.data() + HeaderSize, totalBytes);
+		sendBlobDescriptor(blob, totalBytes, priority, nullptr);
+	}
+
+	// Send a descriptor of a blob, waiting until the deadline if one is supplied.
+	// The blob is freed if the send throws.
+	private: bool sendBlobDescriptor(Impl::BlobArena::Handle blob,
+	                                 size_t totalBytes,
+	                                 unsigned int priority,
+	                                 const boost::posix_time::ptime * deadline) {
+		CharVector descriptor(HeaderSize + sizeof(Impl::BlobArena::Handle));
+		setHeader(descriptor, Impl::QueueHeader::BlobChunkCount, 0, (unsigned int) totalBytes);
+		std::memcpy(descriptor.data() + HeaderSize, &blob, sizeof(Impl::BlobArena::Handle));
+
+		try {
+			if (deadline == nullptr) {
+				queue.send(descriptor.data(), descriptor.size(), priority);
+			} else if (!queue.timed_send(descriptor.data(), descriptor.size(), priority, *deadline)) {
+				return false;
 			}
 
-			auto * queueHeader = (const Impl::QueueHeader *) queueBuffer.data();
+			queueState->available.notify();
+			return true;
+		} catch (...) {
+			blobArena(totalBytes).free(blob, totalBytes);
+			throw;
+		}
+	}
 
-			if (sequenceNumber != queueHeader->sequenceNumber) {
-				++rejectedPendingBuffers;
-				pendingBuffers.emplace_back(PendingBuffer(std::move(queueBuffer), receivedSize, priority));
-				queueBuffer = CharVector(chunkSize);
-			} else {
-				// This can occur out of order (if the chunks arrive out of order).
-				const size_t copyStart = HeaderSize + (chunkSize - HeaderSize) * queueHeader->chunkNumber;
-				const size_t byteCount = queueBuffer.size() - HeaderSize;
-				memcpy(marshalBuffer.data() + copyStart, queueBuffer.data() + HeaderSize, byteCount);
-				++marshalHeader->chunkNumber;
-				--partsLeft;
+	// Unmarshal an object directly from the blob arena and free the blob.
+	private: T unmarshalBlob(const CharVector & descriptor) {
+		const auto * descriptorHeader = (const Impl::QueueHeader *) descriptor.data();
+		const size_t totalBytes = descriptorHeader->totalBytes;
+		Impl::BlobArena::Handle blob;
+		std::memcpy(&blob, descriptor.data() + HeaderSize, sizeof(Impl::BlobArena::Handle));
+
+		auto & arena = blobArena(totalBytes);
+		OnScopeExit freeBlob([&arena, blob, totalBytes] () { arena.free(blob, totalBytes); });
+
+		T object;
+		MarshallerT::unmarshal(arena.address(blob), totalBytes, object);
+		return object;
+	}
+
+	private: void checkOversize(const CharVector & marshalBuffer) const {
+		if (throwOnOversize) {
+			ThrowBalauException(
+				  Exception::SizeException
+				, ::toString(
+					  "The serialized message is too large to fit into a single message "
+					, "(", marshalBuffer.size(), "/", chunkSize, ")."
+				)
+			);
+		}
+	}
+
+	// Write a header with the next sequence number into the start of the buffer.
+	private: void setHeader(CharVector & buffer, unsigned int chunkCount, unsigned int chunkNumber, unsigned int totalBytes) {
+		const Impl::QueueHeader header { queueState->sequenceNumber++, chunkCount, chunkNumber, totalBytes };
+		std::memcpy(buffer.data(), &header, HeaderSize);
+	}
+
+	// Open or create the blob arena. The arena is created with sufficient space for the supplied message size.
+	private: Impl::BlobArena & blobArena(size_t totalBytes) {
+		std::lock_guard<std::mutex> lock(blobArenaMutex);
+
+		if (!blobArenaInstance) {
+			const size_t arenaSize = std::max(DefaultBlobArenaSize, 4 * (totalBytes + Impl::BlobArena::MinimumBlockSize));
+			blobArenaInstance = std::make_unique<Impl::BlobArena>(OpenOrCreateSelector(), blobArenaName(), arenaSize);
+		}
+
+		return *blobArenaInstance;
+	}
+
+	private: std::string blobArenaName() const {
+		return name + "_blobs";
+	}
+
+	// Send the first batchBytes of the batch buffer as a single batch message.
+	private: void sendBatch(CharVector & batchBuffer, size_t batchBytes, unsigned int objectCount, unsigned int priority) {
+		setHeader(batchBuffer, Impl::QueueHeader::BatchChunkCount, objectCount, (unsigned int) (batchBytes - HeaderSize));
+		queue.send(batchBuffer.data(), batchBytes, priority);
+		queueState->available.notify();
+	}
+
+	// Unmarshal up to maximum objects from the batch buffer into the output iterator.
+	// The remaining objects are placed on the leftover list before unmarshalling.
+	private: template <typename OutputIteratorT>
+	size_t unpackBatch(const CharVector & batchBuffer, size_t maximum, OutputIteratorT & output) {
+		const auto * batchHeader = (const Impl::QueueHeader *) batchBuffer.data();
+		const size_t objectCount = batchHeader->chunkNumber;
+		const size_t taken = std::min(maximum, objectCount);
+		const char * objects = batchBuffer.data() + HeaderSize;
+		const size_t objectBytes = batchBuffer.size() - HeaderSize;
+		const size_t takenBytes = batchOffset(objects, objectBytes, taken);
+
+		if (taken < objectCount) {
+			placeLeftovers(objects + takenBytes, objectBytes - takenBytes, objectCount - taken);
+		}
+
+		unpackObjects(objects, takenBytes, taken, output);
+		return taken;
+	}
+
+	// Calculate the offset of the object at the specified index within a sequence of length prefixed objects.
+	private: static size_t batchOffset(const char * objects, size_t bytes, size_t index) {
+		size_t position = 0;
+
+		for (size_t m = 0; m < index; ++m) {
+			uint32_t objectBytes;
+
+			Assert::assertion(
+				  position + BatchLengthSize <= bytes
+				, "Batch buffer is shorter than its object count requires."
+			);
+
+			memcpy(&objectBytes, objects + position, BatchLengthSize);
+			position += BatchLengthSize;
+
+			Assert::assertion(
+				  position + objectBytes <= bytes
+				, "Batch buffer is shorter than its object lengths require."
+			);
+
+			position += objectBytes;
+		}
+
+		return position;
+	}
+
+	// Unmarshal the specified number of length prefixed objects into the output iterator.
+	private: template <typename OutputIteratorT>
+	void unpackObjects(const char * objects, size_t bytes, size_t count, OutputIteratorT & output) {
+		size_t position = 0;
+
+		for (size_t m = 0; m < count; ++m) {
+			uint32_t objectBytes;
+			memcpy(&objectBytes, objects + position, BatchLengthSize);
+			position += BatchLengthSize;
+
+			Assert::assertion(position + objectBytes <= bytes, "Batch buffer is shorter than its object lengths require.");
+
+			T object;
+			MarshallerT::unmarshal(objects + position, objectBytes, object);
+			position += objectBytes;
+			*output = std::move(object);
+			++output;
+		}
+	}
+
+	// Copy the length prefixed objects into a blob arena block and append it to the shared leftover list.
+	// The arena allocation does not wait, thus if the arena is full the objects are held by this instance.
+	private: void placeLeftovers(const char * objects, size_t bytes, size_t count) {
+		const size_t blockBytes = sizeof(LeftoverBlock) + bytes;
+		auto & arena = blobArena(blockBytes);
+		auto handle = Impl::BlobArena::NoBlob;
+
+		try {
+			handle = arena.tryAllocate(blockBytes, std::chrono::milliseconds(0));
+		} catch (const Exception::SizeException & ) {
+			// The batch does not fit into the arena.
+		}
+
+		if (handle == Impl::BlobArena::NoBlob) {
+			std::lock_guard<std::mutex> lock(localLeftoverMutex);
+			localLeftovers.insert(localLeftovers.end(), objects, objects + bytes);
+			localLeftoverCount.fetch_add(count, std::memory_order_release);
+			queueState->available.notify();
+			return;
+		}
+
+		auto * block = new (arena.address(handle)) LeftoverBlock { Impl::BlobArena::NoBlob, bytes, count, 0 };
+		std::memcpy(block + 1, objects, bytes);
+
+		{
+			Impl::RobustLock lock(queueState->leftoverMutex);
+
+			if (lock.previousOwnerDied()) {
+				repairLeftovers(arena);
 			}
 
-			if (partsLeft == 0) {
-				return unmarshal(marshalBuffer);
+			if (queueState->leftoverTail != Impl::BlobArena::NoBlob) {
+				((LeftoverBlock *) arena.address(queueState->leftoverTail))->next = handle;
+			} else {
+				queueState->leftoverHead = handle;
 			}
+
+			queueState->leftoverTail = handle;
+			queueState->leftoverObjectCount.fetch_add(count, std::memory_order_release);
 		}
+
+		queueState->available.notify();
 	}
 
-	//
-	// Dequeue next buffer form the pending list if the pending list size is greater
-	// than rejectedPendingBuffers, otherwise dequeue from the shared memory queue.
-	//
-	private: void dequeueNextBuffer(CharVector & buffer,
-	                                unsigned long & receivedSize,
-	                                unsigned int & priority,
-	                                size_t rejectedPendingBuffers) {
-		if (rejectedPendingBuffers < pendingBuffers.size()) {
-			auto pendingBuffer = pendingBuffers.front();
-			buffer = std::move(pendingBuffer.buffer);
-			pendingBuffers.pop_front();
-			receivedSize = pendingBuffer.receivedSize;
-			priority = pendingBuffer.priority;
-		} else {
-			buffer.resize(chunkSize);
-			queue.receive(buffer.data(), buffer.size(), receivedSize, priority);
-			buffer.resize(receivedSize);
+	private: bool hasLeftovers() const {
+		return localLeftoverCount.load(std::memory_order_acquire) != 0
+			|| queueState->leftoverObjectCount.load(std::memory_order_acquire) != 0;
+	}
+
+	// Take up to maximum leftover objects, first from this instance and then from
+	// the shared leftover list, and unmarshal them into the output iterator.
+	private: template <typename OutputIteratorT> size_t takeLeftovers(size_t maximum, OutputIteratorT & output) {
+		if (maximum == 0 || !hasLeftovers()) {
+			return 0;
+		}
+
+		// The objects are copied out of the leftover lists so that they are unmarshalled outside of the locks.
+		CharVector & objects = Impl::SharedMemoryQueueTLS::storage().leftoverBuffer;
+		objects.clear();
+		size_t taken = takeLocalLeftovers(maximum, objects);
+
+		if (taken < maximum && queueState->leftoverObjectCount.load(std::memory_order_acquire) != 0) {
+			taken += takeSharedLeftovers(maximum - taken, objects);
 		}
+
+		unpackObjects(objects.data(), objects.size(), taken, output);
+		return taken;
 	}
 
-	//
-	// Dequeue next buffer form the pending list if the pending list size is greater
-	// than rejectedPendingBuffers, otherwise dequeue from the shared memory queue.
-	//
-	private: bool tryDequeueNextBuffer(CharVector & buffer,
-	                                   unsigned long & receivedSize,
-	                                   unsigned int & priority,
-	                                   size_t rejectedPendingBuffers,
-	                                   std::chrono::milliseconds waitTime) {
-		if (rejectedPendingBuffers < pendingBuffers.size()) {
-			auto pendingBuffer = pendingBuffers.front();
-			buffer = std::move(pendingBuffer.buffer);
-			pendingBuffers.pop_front();
-			receivedSize = pendingBuffer.receivedSize;
-			priority = pendingBuffer.priority;
-			return true;
-		} else {
-			boost::posix_time::ptime timeout(boost::posix_time::microsec_clock::universal_time());
-			boost::posix_time::time_duration w = boost::posix_time::milliseconds(waitTime.count());
-			timeout += w;
+	// Append up to maximum leftover objects held by this instance to the supplied buffer.
+	private: size_t takeLocalLeftovers(size_t maximum, CharVector & objects) {
+		if (localLeftoverCount.load(std::memory_order_acquire) == 0) {
+			return 0;
+		}
 
-			buffer.resize(chunkSize);
+		std::lock_guard<std::mutex> lock(localLeftoverMutex);
+		const size_t count = std::min(maximum, localLeftoverCount.load(std::memory_order_relaxed));
+		const size_t bytes = batchOffset(localLeftovers.data(), localLeftovers.size(), count);
+		objects.insert(objects.end(), localLeftovers.begin(), localLeftovers.begin() + (ptrdiff_t) bytes);
+		localLeftovers.erase(localLeftovers.begin(), localLeftovers.begin() + (ptrdiff_t) bytes);
+		localLeftoverCount.fetch_sub(count, std::memory_order_release);
+		return count;
+	}
 
-			if (queue.timed_receive(buffer.data(), buffer.size(), receivedSize, priority, timeout)) {
-				buffer.resize(receivedSize);
-				return true;
-			} else {
-				return false;
+	// Append up to maximum objects from the shared leftover list to the supplied buffer.
+	private: size_t takeSharedLeftovers(size_t maximum, CharVector & objects) {
+		auto & arena = blobArena(0);
+		size_t taken = 0;
+		Impl::RobustLock lock(queueState->leftoverMutex);
+
+		if (lock.previousOwnerDied()) {
+			repairLeftovers(arena);
+		}
+
+		while (taken < maximum && queueState->leftoverHead != Impl::BlobArena::NoBlob) {
+			const auto handle = queueState->leftoverHead;
+			auto * block = (LeftoverBlock *) arena.address(handle);
+			const char * blockObjects = (const char *) (block + 1);
+			const size_t count = std::min(maximum - taken, block->objectCount);
+			const size_t bytes = batchOffset(blockObjects + block->position, block->bytes - block->position, count);
+
+			objects.insert(objects.end(), blockObjects + block->position, blockObjects + block->position + bytes);
+			block->position += bytes;
+			block->objectCount -= count;
+			taken += count;
+
+			if (block->objectCount == 0) {
+				queueState->leftoverHead = block->next;
+
+				if (queueState->leftoverHead == Impl::BlobArena::NoBlob) {
+					queueState->leftoverTail = Impl::BlobArena::NoBlob;
+				}
+
+				arena.free(handle, sizeof(LeftoverBlock) + block->bytes);
 			}
 		}
+
+		queueState->leftoverObjectCount.fetch_sub(taken, std::memory_order_acq_rel);
+		return taken;
 	}
 
-	private: using SinkDevice   = boost::iostreams::back_insert_device<CharVector>;
-	private: using SinkBuffer   = boost::iostreams::stream_buffer<SinkDevice>;
-	private: using SourceDevice = boost::iostreams::basic_array_source<char>;
-	private: using SourceBuffer = boost::iostreams::stream_buffer<SourceDevice>;
+	// Recalculate the tail and object count of the shared leftover list after a
+	// consumer died whilst holding the leftover lock. Called with the lock held.
+	private: void repairLeftovers(Impl::BlobArena & arena) {
+		size_t count = 0;
+		auto tail = Impl::BlobArena::NoBlob;
+
+		for (auto handle = queueState->leftoverHead; handle != Impl::BlobArena::NoBlob; ) {
+			const auto * block = (const LeftoverBlock *) arena.address(handle);
+			count += block->objectCount;
+			tail = handle;
+			handle = block->next;
+		}
+
+		queueState->leftoverTail = tail;
+		queueState->leftoverObjectCount.store(count, std::memory_order_release);
+	}
 
 	// Marshal the object to bytes.
 	// Assume single queue buffer (add the header in order to avoid later copying).
@@ -732,9 +922,7 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 		buffer.resize(HeaderSize);
 		const char * headerBytes = (const char *) &header;
 		memcpy(buffer.data(), headerBytes, HeaderSize);
-		SinkBuffer oStreamBuffer { SinkDevice(buffer) };
-		boost::archive::binary_oarchive archive(oStreamBuffer);
-		archive << BoostSerialization(object);
+		MarshallerT::marshal(buffer, object);
 	}
 
 	// Unmarshal the bytes to an object.
@@ -742,19 +930,11 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 	private: T unmarshal(const CharVector & buffer) {
 		// Uncomment the following line for debug output.
 		//std::cerr << toString(getpid(), " -\n", Util::PrettyPrint::printHexBytes(buffer.data(), buffer.size(), 90, 2), "\n");
-		SourceBuffer iStreamBuffer(SourceDevice(buffer.data() + HeaderSize, buffer.size()));
-		boost::archive::binary_iarchive archive(iStreamBuffer);
 		T object;
-		archive >> BoostSerialization(object);
+		MarshallerT::unmarshal(buffer.data() + HeaderSize, buffer.size() - HeaderSize, object);
 		return object;
 	}
 
-	// The number of buffers required for a message of length totalBytes.
-	private: unsigned int calculateChunkCount(unsigned int totalBytes) const {
-		const unsigned int netBufferSize = chunkSize - HeaderSize;
-		return totalBytes / netBufferSize + (totalBytes % netBufferSize != 0);
-	}
-
 	private: unsigned int calculateDefaultBufferSize() const {
 		// Try marshalling a default constructed object to get an indication
 		// of the serialised size. Multiply this size by the default buffer
@@ -777,6 +957,7 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 		}
 
 		boost::interprocess::shared_memory_object::remove(n.c_str());
+		Impl::BlobArena::remove(n + "_blobs");
 
 		return n;
 	}
@@ -799,31 +980,47 @@ template <typename T> class SharedMemoryQueue : public Container::BlockingQueue<
 
 	friend struct SharedMemoryQueueTest;
 
+	// A blob arena block holding the remaining length prefixed objects of a partially dequeued batch.
+	private: struct LeftoverBlock {
+		Impl::BlobArena::Handle next;
+		size_t bytes;
+		size_t objectCount;
+		size_t position;
+	};
+
 	// Shared state across processes using the queue.
 	private: struct QueueState {
 		std::atomic_uint sequenceNumber;
 
-		explicit QueueState() : sequenceNumber(0) {}
-	};
+		// The list of leftover blocks, which is shared by all consumers.
+		Impl::RobustMutex leftoverMutex;
+		Impl::BlobArena::Handle leftoverHead;
+		Impl::BlobArena::Handle leftoverTail;
+		std::atomic<size_t> leftoverObjectCount;
 
-	// Pending buffers are used to support single process dequeueing of oversize objects.
-	private: struct PendingBuffer {
-		CharVector buffer;
-		unsigned long receivedSize;
-		unsigned int priority;
+		// Notified when a buffer is sent or leftover objects are placed.
+		Concurrent::Impl::SharedEventCount available;
 
-		PendingBuffer(CharVector && buffer_, unsigned long receivedSize_, unsigned int priority_)
-			: buffer(std::move(buffer_))
-			, receivedSize(receivedSize_)
-			, priority(priority_) {}
+		explicit QueueState()
+			: sequenceNumber(0)
+			, leftoverHead(Impl::BlobArena::NoBlob)
+			, leftoverTail(Impl::BlobArena::NoBlob)
+			, leftoverObjectCount(0) {}
 	};
 
 	private: const std::string name;
 	private: boost::interprocess::message_queue queue;
 	private: const unsigned int chunkSize {};
 	private: MSharedMemoryObject<QueueState> queueState;
-	private: std::deque<PendingBuffer> pendingBuffers;
 	private: const bool throwOnOversize;
+	private: const bool ownsBlobArena = false;
+	private: std::mutex blobArenaMutex;
+	private: std::unique_ptr<Impl::BlobArena> blobArenaInstance;
+
+	// Leftover objects that could not be placed in the blob arena.
+	private: std::mutex localLeftoverMutex;
+	private: CharVector localLeftovers;
+	private: std::atomic<size_t> localLeftoverCount { 0 };
 };
 
 } // namespace Balau::Interprocess
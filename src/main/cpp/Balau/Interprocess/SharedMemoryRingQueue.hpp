@@ -0,0 +1,813 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file SharedMemoryRingQueue.hpp
+///
+/// A blocking, lock-free shared memory ring buffer queue.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_RING_QUEUE
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_RING_QUEUE
+
+#include <Balau/Container/BlockingQueue.hpp>
+#include <Balau/Exception/ContainerExceptions.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/SharedMemoryUtils.hpp>
+#include <Balau/Interprocess/Impl/RingBuffer.hpp>
+#include <Balau/Serialization/Marshallers.hpp>
+#include <Balau/Type/UUID.hpp>
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+
+#include <cstring>
+#include <type_traits>
+
+namespace Balau::Interprocess {
+
+///
+/// The concurrency mode of a shared memory ring queue.
+///
+enum class SharedMemoryRingQueueMode {
+	///
+	/// A single producer and a single consumer (across all processes).
+	///
+	SingleProducerSingleConsumer
+
+	///
+	/// Multiple producers and multiple consumers (across all processes).
+	///
+	, MultiProducerMultiConsumer
+};
+
+///
+/// A blocking, lock-free shared memory ring buffer queue.
+///
+/// The queue is a ring of fixed size, cache line aligned slots, placed in a
+/// managed shared memory segment. Enqueue and dequeue positions are atomic
+/// sequences, thus the non-blocking paths never take a lock or enter the kernel.
+/// Blocked producers and consumers spin briefly and then park on a futex.
+///
+/// Two variants are available. The single producer/single consumer variant
+/// advances its positions with plain stores. The multiple producer/multiple
+/// consumer variant uses the Vyukov sequenced slot algorithm. The variant is
+/// recorded in shared memory when the queue is created.
+///
+/// Trivially copyable types are copied directly into and out of the slots, and
+/// are thus only portable between processes running the same binary. Other types
+/// are marshalled via the marshaller policy, which uses the Boost serialization
+/// library by default. Serialization::FlatMarshaller may be specified in order to
+/// use flat serialisation instead.
+///
+/// In addition to the BlockingQueue API, a zero-copy API is provided. Producers
+/// reserve a slot, write the message directly into shared memory and then commit
+/// it. Consumers acquire a read-only view onto the message in its slot, which is
+/// valid until it is released.
+///
+/// Unlike SharedMemoryQueue, objects larger than the slot size cannot be enqueued.
+/// An attempt to enqueue an oversize object results in a SizeException.
+///
+/// @tparam T the type of enqueued/dequeued objects
+/// @tparam MarshallerT the marshaller policy for types that are not trivially copyable
+///
+template <typename T, typename MarshallerT = Serialization::BoostArchiveMarshaller>
+class SharedMemoryRingQueue : public Container::BlockingQueue<T> {
+	///
+	/// The number of spin iterations made before parking a blocked producer or consumer.
+	///
+	public: static const unsigned int SpinCount = 256;
+
+	///
+	/// Create a shared memory ring queue of type T and with the specified capacity.
+	///
+	/// The slot size is automatically calculated from a default constructed object.
+	///
+	/// The name is automatically generated.
+	///
+	/// @param capacity the number of messages that can be queued (rounded up to a power of two)
+	/// @param mode the concurrency mode of the queue
+	///
+	public: explicit SharedMemoryRingQueue(unsigned int capacity,
+	                                       SharedMemoryRingQueueMode mode = SharedMemoryRingQueueMode::MultiProducerMultiConsumer)
+		: SharedMemoryRingQueue(capacity, calculateDefaultSlotSize(), "SMRQ_" + UUID().asString(), mode) {}
+
+	///
+	/// Create a shared memory ring queue of type T, with the specified capacity and slot size.
+	///
+	/// The name is automatically generated.
+	///
+	/// @param capacity the number of messages that can be queued (rounded up to a power of two)
+	/// @param slotSize_ the maximum marshalled object size in bytes
+	/// @param mode the concurrency mode of the queue
+	///
+	public: SharedMemoryRingQueue(unsigned int capacity,
+	                              unsigned int slotSize_,
+	                              SharedMemoryRingQueueMode mode = SharedMemoryRingQueueMode::MultiProducerMultiConsumer)
+		: SharedMemoryRingQueue(capacity, slotSize_, "SMRQ_" + UUID().asString(), mode) {}
+
+	///
+	/// Create a shared memory ring queue of type T, with the specified capacity and slot size.
+	///
+	/// The specified name is used. Any existing queue with the same name is removed.
+	///
+	/// @param capacity the number of messages that can be queued (rounded up to a power of two)
+	/// @param slotSize_ the maximum marshalled object size in bytes
+	/// @param name_ the name of the queue
+	/// @param mode the concurrency mode of the queue
+	/// @throw SizeException if the capacity or slot size is zero
+	///
+	public: SharedMemoryRingQueue(unsigned int capacity,
+	                              unsigned int slotSize_,
+	                              std::string name_,
+	                              SharedMemoryRingQueueMode mode = SharedMemoryRingQueueMode::MultiProducerMultiConsumer)
+		: name(std::move(name_))
+		, owner(true) {
+		validate(capacity, slotSize_);
+		const uint32_t roundedCapacity = Impl::RingBuffer::roundCapacity(capacity);
+		const size_t bytes = Impl::RingBuffer::bytesRequired(roundedCapacity, slotSize_);
+
+		boost::interprocess::shared_memory_object::remove(segmentName().c_str());
+		segment = boost::interprocess::managed_shared_memory(CreateOnlySelector(), segmentName().c_str(), bytes + segmentOverhead);
+		ring.initialise(constructRegion(bytes), roundedCapacity, slotSize_, isSpsc(mode));
+	}
+
+	///
+	/// Open or create a shared memory ring queue of type T, with the specified capacity and slot size.
+	///
+	/// The specified name is used.
+	///
+	/// If the queue already exists, the capacity, slot size and mode are ignored.
+	///
+	/// @param capacity the number of messages that can be queued (rounded up to a power of two)
+	/// @param slotSize_ the maximum marshalled object size in bytes
+	/// @param name_ the name of the queue
+	/// @param mode the concurrency mode of the queue
+	/// @throw SizeException if the capacity or slot size is zero
+	///
+	public: SharedMemoryRingQueue(OpenOrCreateSelector,
+	                              unsigned int capacity,
+	                              unsigned int slotSize_,
+	                              std::string name_,
+	                              SharedMemoryRingQueueMode mode = SharedMemoryRingQueueMode::MultiProducerMultiConsumer)
+		: name(std::move(name_))
+		, owner(false) {
+		validate(capacity, slotSize_);
+		const uint32_t roundedCapacity = Impl::RingBuffer::roundCapacity(capacity);
+		const size_t bytes = Impl::RingBuffer::bytesRequired(roundedCapacity, slotSize_);
+
+		segment = boost::interprocess::managed_shared_memory(
+			boost::interprocess::open_or_create, segmentName().c_str(), bytes + segmentOverhead
+		);
+
+		ring.initialise(constructRegion(bytes), roundedCapacity, slotSize_, isSpsc(mode));
+	}
+
+	///
+	/// Open an existing shared memory ring queue with the specified name.
+	///
+	/// @param name_ the name of the queue
+	/// @throw SharedMemoryObjectException if the queue does not exist
+	///
+	public: explicit SharedMemoryRingQueue(std::string name_)
+		: name(std::move(name_))
+		, owner(false) {
+		segment = boost::interprocess::managed_shared_memory(OpenOnlySelector(), segmentName().c_str());
+		auto region = segment.find<Impl::RingRegionLine>(RegionName);
+
+		if (region.first == nullptr || !ring.attach(alignRegion(region.first))) {
+			ThrowBalauException(
+				Exception::SharedMemoryObjectException, "The shared memory ring queue with name " + name + " was not found."
+			);
+		}
+	}
+
+	///
+	/// Destroy the queue instance.
+	///
+	/// If this instance created the queue, the shared memory is removed. Processes
+	/// that have the queue open may continue to use it.
+	///
+	public: ~SharedMemoryRingQueue() {
+		if (owner) {
+			boost::interprocess::shared_memory_object::remove(segmentName().c_str());
+		}
+	}
+
+	public: SharedMemoryRingQueue(const SharedMemoryRingQueue &) = delete;
+	public: SharedMemoryRingQueue & operator = (const SharedMemoryRingQueue &) = delete;
+
+	///
+	/// Enqueue an object.
+	///
+	/// If the queue is full, this call will block until there is a slot available.
+	///
+	/// @param object the object to enqueue
+	/// @throw SizeException if the marshalled object is larger than the slot size
+	///
+	public: void enqueue(T object) override {
+		Marshalled marshalled = marshal(object);
+		uint64_t position;
+		ring.getControl().notFull.await([this, &position] () { return ring.tryClaimEnqueue(position); }, SpinCount);
+		write(position, marshalled);
+	}
+
+	///
+	/// Try to enqueue an object.
+	///
+	/// If the queue is full, this call will return false.
+	///
+	/// @param object the object to enqueue
+	/// @return true if the enqueue occurred, false otherwise
+	/// @throw SizeException if the marshalled object is larger than the slot size
+	///
+	public: bool tryEnqueue(T object) override {
+		Marshalled marshalled = marshal(object);
+		uint64_t position;
+
+		if (!ring.tryClaimEnqueue(position)) {
+			return false;
+		}
+
+		write(position, marshalled);
+		return true;
+	}
+
+	///
+	/// Try to enqueue an object.
+	///
+	/// If the queue is full, this call will wait a limited amount of time for space to be available.
+	///
+	/// @param object the object to enqueue
+	/// @param waitTime the number of milliseconds to wait if the queue is full
+	/// @return true if the enqueue occurred, false otherwise
+	/// @throw SizeException if the marshalled object is larger than the slot size
+	///
+	public: bool tryEnqueue(T object, std::chrono::milliseconds waitTime) override {
+		Marshalled marshalled = marshal(object);
+		uint64_t position;
+		const auto deadline = std::chrono::steady_clock::now() + waitTime;
+
+		const bool claimed = ring.getControl().notFull.await(
+			[this, &position] () { return ring.tryClaimEnqueue(position); }, SpinCount, deadline
+		);
+
+		if (!claimed) {
+			return false;
+		}
+
+		write(position, marshalled);
+		return true;
+	}
+
+	///
+	/// Dequeue an object, waiting for an object to become available if the queue is empty.
+	///
+	/// @return the dequeued object
+	///
+	public: T dequeue() override {
+		uint64_t position;
+		ring.getControl().notEmpty.await([this, &position] () { return ring.tryClaimMessage(position); }, SpinCount);
+		return read(position);
+	}
+
+	///
+	/// Try to dequeue an object.
+	///
+	/// @return the dequeued object or a default constructed object if no object was dequeued
+	///
+	public: T tryDequeue() override {
+		bool success;
+		return tryDequeue(success);
+	}
+
+	///
+	/// Try to dequeue an object.
+	///
+	/// @param success set to true on a successful dequeue, false otherwise
+	/// @return the dequeued object or a default constructed object if no object was dequeued
+	///
+	public: T tryDequeue(bool & success) override {
+		uint64_t position;
+		success = ring.tryClaimMessage(position);
+		return success ? read(position) : T();
+	}
+
+	///
+	/// Try to dequeue an object, waiting for the specified time if the queue is empty.
+	///
+	/// @param waitTime the time in milliseconds to wait for an object to become available
+	/// @return the dequeued object or a default constructed object if no object was dequeued
+	///
+	public: T tryDequeue(std::chrono::milliseconds waitTime) override {
+		bool success;
+		return tryDequeue(waitTime, success);
+	}
+
+	///
+	/// Try to dequeue an object, waiting for the specified time if the queue is empty.
+	///
+	/// @param waitTime the time in milliseconds to wait for an object to become available
+	/// @param success set to true on a successful dequeue, false otherwise
+	/// @return the dequeued object or a default constructed object if no object was dequeued
+	///
+	public: T tryDequeue(std::chrono::milliseconds waitTime, bool & success) override {
+		uint64_t position;
+		const auto deadline = std::chrono::steady_clock::now() + waitTime;
+
+		success = ring.getControl().notEmpty.await(
+			[this, &position] () { return ring.tryClaimMessage(position); }, SpinCount, deadline
+		);
+
+		return success ? read(position) : T();
+	}
+
+	public: bool full() const override {
+		return ring.size() >= ring.capacity();
+	}
+
+	public: bool empty() const override {
+		return ring.size() == 0;
+	}
+
+	///
+	/// Get the name of the queue.
+	///
+	/// This can be passed to other processes in order to open the queue.
+	///
+	public: std::string getName() const {
+		return name;
+	}
+
+	///
+	/// Get the capacity of the queue (the requested capacity rounded up to a power of two).
+	///
+	public: unsigned int getCapacity() const {
+		return ring.capacity();
+	}
+
+	///
+	/// Get the slot size of the queue.
+	///
+	public: unsigned int getSlotSize() const {
+		return ring.slotSize();
+	}
+
+	///
+	/// Get the concurrency mode of the queue.
+	///
+	public: SharedMemoryRingQueueMode getMode() const {
+		return ring.singleProducerSingleConsumer()
+			? SharedMemoryRingQueueMode::SingleProducerSingleConsumer
+			: SharedMemoryRingQueueMode::MultiProducerMultiConsumer;
+	}
+
+	///////////////////////////// Zero-copy API //////////////////////////////
+
+	///
+	/// A slot reserved for the in-place construction of a message.
+	///
+	/// The reservation is published by calling commit. A reservation that is
+	/// destroyed without being committed is discarded, and consumers skip the
+	/// slot. Reservations must not outlive the queue instance that created them.
+	///
+	public: class Reservation {
+		///
+		/// Create an empty reservation.
+		///
+		public: Reservation() = default;
+
+		public: Reservation(Reservation && rhs) noexcept
+			: ring(rhs.ring)
+			, position(rhs.position)
+			, reservedSize(rhs.reservedSize) {
+			rhs.ring = nullptr;
+		}
+
+		public: Reservation & operator = (Reservation && rhs) noexcept {
+			if (this != &rhs) {
+				discard();
+				ring = rhs.ring;
+				position = rhs.position;
+				reservedSize = rhs.reservedSize;
+				rhs.ring = nullptr;
+			}
+
+			return *this;
+		}
+
+		public: ~Reservation() {
+			discard();
+		}
+
+		///
+		/// Returns true if the reservation holds a slot.
+		///
+		public: explicit operator bool () const {
+			return ring != nullptr;
+		}
+
+		///
+		/// Get a pointer to the writable bytes of the slot.
+		///
+		public: char * data() {
+			Assert::assertion(ring != nullptr, "Attempt to access an empty ring queue reservation.");
+			return ring->payload(position);
+		}
+
+		///
+		/// Get the number of reserved bytes.
+		///
+		public: size_t size() const {
+			return reservedSize;
+		}
+
+		///
+		/// Publish all the reserved bytes as a message.
+		///
+		public: void commit() {
+			commit(reservedSize);
+		}
+
+		///
+		/// Publish the first usedSize reserved bytes as a message.
+		///
+		/// @throw SizeException if the used size is larger than the reserved size
+		///
+		public: void commit(size_t usedSize) {
+			Assert::assertion(ring != nullptr, "Attempt to commit an empty ring queue reservation.");
+
+			if (usedSize > reservedSize) {
+				ThrowBalauException(
+					Exception::SizeException, ::toString("Commit size exceeds the reserved size (", usedSize, "/", reservedSize, ").")
+				);
+			}
+
+			ring->publishEnqueue(position, (uint32_t) usedSize);
+			ring = nullptr;
+		}
+
+		///
+		/// Discard the reservation without publishing a message.
+		///
+		public: void discard() {
+			if (ring != nullptr) {
+				ring->abandonEnqueue(position);
+				ring = nullptr;
+			}
+		}
+
+		private: Reservation(Impl::RingBuffer * ring_, uint64_t position_, size_t reservedSize_)
+			: ring(ring_)
+			, position(position_)
+			, reservedSize(reservedSize_) {}
+
+		private: Impl::RingBuffer * ring = nullptr;
+		private: uint64_t position = 0;
+		private: size_t reservedSize = 0;
+
+		friend class SharedMemoryRingQueue;
+	};
+
+	///
+	/// A read-only view onto a dequeued message that resides in its slot.
+	///
+	/// The slot is returned to producers when release is called or when the
+	/// view is destroyed. Views must not outlive the queue instance that
+	/// created them.
+	///
+	public: class View {
+		///
+		/// Create an empty view.
+		///
+		public: View() = default;
+
+		public: View(View && rhs) noexcept
+			: ring(rhs.ring)
+			, position(rhs.position) {
+			rhs.ring = nullptr;
+		}
+
+		public: View & operator = (View && rhs) noexcept {
+			if (this != &rhs) {
+				release();
+				ring = rhs.ring;
+				position = rhs.position;
+				rhs.ring = nullptr;
+			}
+
+			return *this;
+		}
+
+		public: ~View() {
+			release();
+		}
+
+		///
+		/// Returns true if the view holds a message.
+		///
+		public: explicit operator bool () const {
+			return ring != nullptr;
+		}
+
+		///
+		/// Get a pointer to the bytes of the message.
+		///
+		public: const char * data() const {
+			Assert::assertion(ring != nullptr, "Attempt to access an empty ring queue view.");
+			return ring->payload(position);
+		}
+
+		///
+		/// Get the number of bytes in the message.
+		///
+		public: size_t size() const {
+			Assert::assertion(ring != nullptr, "Attempt to access an empty ring queue view.");
+			return ring->payloadSize(position);
+		}
+
+		///
+		/// Get a reference to the trivially copyable object in the message.
+		///
+		public: const T & object() const {
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be viewed in place.");
+			static_assert(alignof(T) <= alignof(Impl::RingSlot), "The object alignment exceeds the slot payload alignment.");
+			Assert::assertion(size() == sizeof(T), "The ring queue message does not contain an object of the view type.");
+			return *reinterpret_cast<const T *>(data());
+		}
+
+		///
+		/// Release the slot back to the producers.
+		///
+		public: void release() {
+			if (ring != nullptr) {
+				ring->releaseDequeue(position);
+				ring = nullptr;
+			}
+		}
+
+		private: View(Impl::RingBuffer * ring_, uint64_t position_)
+			: ring(ring_)
+			, position(position_) {}
+
+		private: Impl::RingBuffer * ring = nullptr;
+		private: uint64_t position = 0;
+
+		friend class SharedMemoryRingQueue;
+	};
+
+	///
+	/// Reserve a slot for the in-place construction of a message of up to size bytes.
+	///
+	/// If the queue is full, this call will block until there is a slot available.
+	///
+	/// @param size the number of bytes to reserve
+	/// @return the reservation
+	/// @throw SizeException if the size is larger than the slot size
+	///
+	public: Reservation reserve(size_t size) {
+		validateReservation(size);
+		uint64_t position;
+		ring.getControl().notFull.await([this, &position] () { return ring.tryClaimEnqueue(position); }, SpinCount);
+		return Reservation(&ring, position, size);
+	}
+
+	///
+	/// Try to reserve a slot for the in-place construction of a message of up to size bytes.
+	///
+	/// @param size the number of bytes to reserve
+	/// @return the reservation, which is empty if the queue is full
+	/// @throw SizeException if the size is larger than the slot size
+	///
+	public: Reservation tryReserve(size_t size) {
+		validateReservation(size);
+		uint64_t position;
+		return ring.tryClaimEnqueue(position) ? Reservation(&ring, position, size) : Reservation();
+	}
+
+	///
+	/// Try to reserve a slot for the in-place construction of a message of up to size bytes,
+	/// waiting a limited amount of time for space to be available.
+	///
+	/// @param size the number of bytes to reserve
+	/// @param waitTime the number of milliseconds to wait if the queue is full
+	/// @return the reservation, which is empty if no slot became available
+	/// @throw SizeException if the size is larger than the slot size
+	///
+	public: Reservation tryReserve(size_t size, std::chrono::milliseconds waitTime) {
+		validateReservation(size);
+		uint64_t position;
+		const auto deadline = std::chrono::steady_clock::now() + waitTime;
+
+		const bool claimed = ring.getControl().notFull.await(
+			[this, &position] () { return ring.tryClaimEnqueue(position); }, SpinCount, deadline
+		);
+
+		return claimed ? Reservation(&ring, position, size) : Reservation();
+	}
+
+	///
+	/// Construct a trivially copyable object directly in a slot and publish it.
+	///
+	/// If the queue is full, this call will block until there is a slot available.
+	///
+	/// @param params the object's constructor arguments
+	///
+	public: template <typename ... P> void emplace(P && ... params) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be emplaced.");
+		Reservation reservation = reserve(sizeof(T));
+		new (reservation.data()) T(std::forward<P>(params) ...);
+		reservation.commit();
+	}
+
+	///
+	/// Acquire a view onto the next message, waiting for a message to become available if the queue is empty.
+	///
+	/// @return the view
+	///
+	public: View acquire() {
+		uint64_t position;
+		ring.getControl().notEmpty.await([this, &position] () { return ring.tryClaimMessage(position); }, SpinCount);
+		return View(&ring, position);
+	}
+
+	///
+	/// Try to acquire a view onto the next message.
+	///
+	/// @return the view, which is empty if the queue is empty
+	///
+	public: View tryAcquire() {
+		uint64_t position;
+		return ring.tryClaimMessage(position) ? View(&ring, position) : View();
+	}
+
+	///
+	/// Try to acquire a view onto the next message, waiting for the specified time if the queue is empty.
+	///
+	/// @param waitTime the time in milliseconds to wait for a message to become available
+	/// @return the view, which is empty if no message became available
+	///
+	public: View tryAcquire(std::chrono::milliseconds waitTime) {
+		uint64_t position;
+		const auto deadline = std::chrono::steady_clock::now() + waitTime;
+
+		const bool claimed = ring.getControl().notEmpty.await(
+			[this, &position] () { return ring.tryClaimMessage(position); }, SpinCount, deadline
+		);
+
+		return claimed ? View(&ring, position) : View();
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// The name of the ring region within the managed segment.
+	private: static constexpr const char * RegionName = "ring";
+
+	// Reserved memory for the managed segment's metadata and index.
+	private: static const size_t segmentOverhead = 4096;
+
+	// A pointer/size pair referring to the bytes of a marshalled object.
+	private: struct Marshalled {
+		const char * data;
+		size_t size;
+	};
+
+	private: using CharVector = std::vector<char>;
+
+	private: static void validate(unsigned int capacity, unsigned int slotSize) {
+		if (capacity == 0 || capacity > (1U << 30U)) {
+			ThrowBalauException(
+				Exception::SizeException, "The shared memory ring queue capacity must be between 1 and 2^30."
+			);
+		}
+
+		if (slotSize == 0) {
+			ThrowBalauException(Exception::SizeException, "The shared memory ring queue slot size must be greater than zero.");
+		}
+	}
+
+	private: void validateReservation(size_t size) const {
+		if (size > ring.slotSize()) {
+			ThrowBalauException(
+				  Exception::SizeException
+				, ::toString("The reservation is too large to fit into a ring queue slot (", size, "/", ring.slotSize(), ").")
+			);
+		}
+	}
+
+	private: static bool isSpsc(SharedMemoryRingQueueMode mode) {
+		return mode == SharedMemoryRingQueueMode::SingleProducerSingleConsumer;
+	}
+
+	private: static unsigned int calculateDefaultSlotSize() {
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			return (unsigned int) sizeof(T);
+		} else {
+			// Marshal a default constructed object to get an indication of the serialised size.
+			CharVector buffer;
+			MarshallerT::marshal(buffer, T {});
+			return (unsigned int) buffer.size() + DefaultSlotSizeMargin;
+		}
+	}
+
+	// The additional bytes added to the marshalled size of a default constructed object.
+	private: static const unsigned int DefaultSlotSizeMargin = 32;
+
+	private: std::string segmentName() const {
+		return name + "_ring";
+	}
+
+	// Construct (or find) the cache line array holding the ring and return its aligned start.
+	// The array is over-allocated by one line, as the segment does not guarantee cache line alignment.
+	private: char * constructRegion(size_t bytes) {
+		const size_t lines = bytes / sizeof(Impl::RingRegionLine) + 1;
+		auto * region = segment.find_or_construct<Impl::RingRegionLine>(RegionName)[lines]();
+		return alignRegion(region);
+	}
+
+	private: static char * alignRegion(Impl::RingRegionLine * region) {
+		const auto address = reinterpret_cast<uintptr_t>(region);
+		const uintptr_t alignment = Impl::RingBuffer::CacheLineSize;
+		return reinterpret_cast<char *>((address + alignment - 1) & ~(alignment - 1));
+	}
+
+	private: static CharVector & marshalBuffer() {
+		thread_local CharVector buffer;
+		return buffer;
+	}
+
+	// Trivially copyable objects are referenced directly. Other objects are marshalled into a thread-local buffer.
+	private: Marshalled marshal(const T & object) const {
+		Marshalled marshalled {};
+
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			marshalled = { reinterpret_cast<const char *>(&object), sizeof(T) };
+		} else {
+			CharVector & buffer = marshalBuffer();
+			buffer.clear();
+			MarshallerT::marshal(buffer, object);
+			marshalled = { buffer.data(), buffer.size() };
+		}
+
+		if (marshalled.size > ring.slotSize()) {
+			ThrowBalauException(
+				  Exception::SizeException
+				, ::toString(
+					  "The marshalled object is too large to fit into a ring queue slot "
+					, "(", marshalled.size, "/", ring.slotSize(), ")."
+				)
+			);
+		}
+
+		return marshalled;
+	}
+
+	private: void write(uint64_t position, const Marshalled & marshalled) {
+		std::memcpy(ring.payload(position), marshalled.data, marshalled.size);
+		ring.publishEnqueue(position, (uint32_t) marshalled.size);
+	}
+
+	// Unmarshal the object in place, then release the slot.
+	// The slot is released even if unmarshalling fails, in order to keep the ring moving.
+	private: T read(uint64_t position) {
+		T object {};
+
+		if constexpr (std::is_trivially_copyable_v<T>) {
+			std::memcpy(reinterpret_cast<char *>(&object), ring.payload(position), sizeof(T));
+		} else {
+			try {
+				MarshallerT::unmarshal(ring.payload(position), ring.payloadSize(position), object);
+			} catch (...) {
+				ring.releaseDequeue(position);
+				throw;
+			}
+		}
+
+		ring.releaseDequeue(position);
+		return object;
+	}
+
+	private: const std::string name;
+	private: const bool owner;
+	private: boost::interprocess::managed_shared_memory segment;
+	private: Impl::RingBuffer ring;
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_RING_QUEUE
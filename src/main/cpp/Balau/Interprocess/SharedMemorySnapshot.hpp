@@ -0,0 +1,232 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file SharedMemorySnapshot.hpp
+///
+/// A versioned value published by a single writer to readers in any process.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_SNAPSHOT
+#define COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_SNAPSHOT
+
+#include <Balau/Concurrent/Impl/Futex.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace Balau::Interprocess {
+
+///
+/// A versioned value published by a single writer to readers in any process.
+///
+/// This is suitable for frequently read data such as feature flags, rate limits
+/// and aggregated statistics. The writer publishes new versions of the value
+/// without blocking, and readers obtain a consistent copy without locking and
+/// without system calls.
+///
+/// The value is double buffered. Each publication is written to the buffer that
+/// does not contain the current version, and the buffer is protected by a
+/// sequence lock. A reader copies the current buffer and retries if the writer
+/// modified the buffer during the copy. Retries only occur if the writer
+/// publishes twice during a single read.
+///
+/// Versions are numbered from zero and increase by one on each publication.
+/// Readers can thus detect changes by comparing version numbers, without copying
+/// the value.
+///
+/// Only one thread in one process may publish at any time. Any number of threads
+/// in any number of processes may read.
+///
+/// The shared memory is managed by an MSharedMemoryObject, thus the snapshot may
+/// be constructed before forking and then used in the child processes without
+/// remapping, or may be created and opened by name in independent processes.
+///
+/// The type T must be trivially copyable.
+///
+/// @tparam T the value type
+///
+template <typename T> class SharedMemorySnapshot {
+	static_assert(std::is_trivially_copyable_v<T>, "SharedMemorySnapshot values must be trivially copyable.");
+
+	///
+	/// Create a snapshot, the initial value of which is constructed with the supplied input arguments.
+	///
+	/// The name prefix is automatically generated.
+	///
+	public: template <typename ... P> explicit SharedMemorySnapshot(const P & ... params)
+		: state(params ...) {}
+
+	///
+	/// Create a snapshot, the initial value of which is constructed with the supplied input arguments.
+	///
+	/// The specified name prefix is used.
+	///
+	public: template <typename ... P> SharedMemorySnapshot(CreateOnlySelector, const std::string & name, const P & ... params)
+		: state(CreateOnlySelector(), name, params ...) {}
+
+	///
+	/// Create or open a snapshot, the initial value of which is constructed with the supplied input arguments.
+	///
+	/// The specified name prefix is used.
+	///
+	/// If the snapshot already exists, it is opened and the supplied parameters are ignored.
+	///
+	public: template <typename ... P> SharedMemorySnapshot(OpenOrCreateSelector, const std::string & name, const P & ... params)
+		: state(OpenOrCreateSelector(), name, params ...) {}
+
+	///
+	/// Open an existing snapshot.
+	///
+	/// The specified name prefix is used.
+	///
+	/// @throw SharedMemoryObjectException if no such snapshot exists
+	///
+	public: SharedMemorySnapshot(OpenOnlySelector, const std::string & name)
+		: state(OpenOnlySelector(), name) {}
+
+	///
+	/// Publish a new version of the value.
+	///
+	/// This method must only be called by the single writer.
+	///
+	/// @return the version number of the published value
+	///
+	public: uint64_t publish(const T & value) {
+		const uint64_t version = state->version.load(std::memory_order_relaxed) + 1;
+		Buffer & buffer = state->buffers[version & 1U];
+		const uint64_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+
+		buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		buffer.version = version;
+		std::memcpy(&buffer.value, &value, sizeof(T));
+		buffer.sequence.store(sequence + 2, std::memory_order_release);
+
+		state->version.store(version, std::memory_order_release);
+		return version;
+	}
+
+	///
+	/// Publish a new version of the value, by applying the supplied function to a copy of the current value.
+	///
+	/// This method must only be called by the single writer.
+	///
+	/// @return the version number of the published value
+	///
+	public: uint64_t update(const std::function<void (T &)> & function) {
+		// The writer's own buffer cannot change concurrently, thus no sequence check is required.
+		const uint64_t version = state->version.load(std::memory_order_relaxed);
+		T value;
+		std::memcpy(&value, &state->buffers[version & 1U].value, sizeof(T));
+		function(value);
+		return publish(value);
+	}
+
+	///
+	/// Read a consistent copy of the current value.
+	///
+	/// @param value set to the current value
+	/// @return the version number of the value
+	///
+	public: uint64_t read(T & value) const {
+		while (true) {
+			const uint64_t version = state->version.load(std::memory_order_acquire);
+			const Buffer & buffer = state->buffers[version & 1U];
+			const uint64_t before = buffer.sequence.load(std::memory_order_acquire);
+
+			if ((before & 1U) == 0) {
+				const uint64_t bufferVersion = buffer.version;
+				std::memcpy(&value, &buffer.value, sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (buffer.sequence.load(std::memory_order_relaxed) == before) {
+					return bufferVersion;
+				}
+			}
+
+			Concurrent::Impl::SharedFutex::pause();
+		}
+	}
+
+	///
+	/// Read a consistent copy of the current value.
+	///
+	public: T read() const {
+		T value;
+		read(value);
+		return value;
+	}
+
+	///
+	/// Read a consistent copy of the current value if its version is newer than the supplied version.
+	///
+	/// @param value set to the current value if it is newer than the supplied version
+	/// @param version the version last seen by the caller, updated to the version of the value if it is newer
+	/// @return true if a newer value was read
+	///
+	public: bool readIfChanged(T & value, uint64_t & version) const {
+		if (state->version.load(std::memory_order_acquire) == version) {
+			return false;
+		}
+
+		version = read(value);
+		return true;
+	}
+
+	///
+	/// Get the version number of the current value.
+	///
+	public: uint64_t getVersion() const {
+		return state->version.load(std::memory_order_acquire);
+	}
+
+	///////////////////////// Private implementation //////////////////////////
+
+	//
+	// The sequence is odd whilst the writer is modifying the buffer.
+	//
+	private: struct Buffer {
+		std::atomic<uint64_t> sequence { 0 };
+		uint64_t version = 0;
+		T value;
+	};
+
+	//
+	// Version zero is in the first buffer. Subsequent versions alternate between the buffers.
+	//
+	private: struct State {
+		template <typename ... P> explicit State(const P & ... params) : version(0) {
+			buffers[0].value = T(params ...);
+			buffers[1].value = buffers[0].value;
+		}
+
+		std::atomic<uint64_t> version;
+		Buffer buffers[2];
+	};
+
+	private: MSharedMemoryObject<State> state;
+};
+
+} // namespace Balau::Interprocess
+
+#endif // COM_BORA_SOFTWARE__BALAU_INTERPROCESS__SHARED_MEMORY_SNAPSHOT
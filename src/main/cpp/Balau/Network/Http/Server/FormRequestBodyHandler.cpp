@@ -0,0 +1,223 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "FormRequestBodyHandler.hpp"
+#include "../../../Logging/Logger.hpp"
+#include "../../../Type/UUID.hpp"
+
+namespace Balau::Network::Http {
+
+namespace {
+
+Logger & log = Logger::getLogger("balau.network.server"); // NOLINT
+
+// Get the lower case media type of the request, without parameters.
+std::string mediaType(const StringRequest & request) {
+	const auto contentType = request[Field::content_type];
+	const auto view = std::string_view(contentType.data(), contentType.length());
+	auto type = std::string(Util::Strings::trim(view.substr(0, view.find(';'))));
+
+	for (char & c : type) {
+		if (c >= 'A' && c <= 'Z') {
+			c = (char) (c - 'A' + 'a');
+		}
+	}
+
+	return type;
+}
+
+} // namespace
+
+FormRequestBodyHandler::SpooledFile::~SpooledFile() {
+	if (!owned) {
+		return;
+	}
+
+	// Destructors must not throw.
+	try {
+		file.removeFile();
+	} catch (const std::exception & e) {
+		BalauLogError(log, "Failed to remove spooled upload file {}: {}", file, e);
+	} catch (...) {
+		BalauLogError(log, "Failed to remove spooled upload file {}: unknown exception", file);
+	}
+}
+
+bool FormRequestBodyHandler::isForm(const StringRequest & request) {
+	const auto type = mediaType(request);
+	return type == "application/x-www-form-urlencoded" || type == "multipart/form-data";
+}
+
+bool FormRequestBodyHandler::isUrlEncodedForm(const StringRequest & request) {
+	return mediaType(request) == "application/x-www-form-urlencoded";
+}
+
+bool FormRequestBodyHandler::isMultipartForm(const StringRequest & request) {
+	return mediaType(request) == "multipart/form-data";
+}
+
+FormRequestBodyHandler::FormRequestBodyHandler(const StringRequest & request,
+                                               Resource::File spoolDirectory_,
+                                               CompletionHandler completionHandler_,
+                                               Limits limits_)
+	: spoolDirectory(std::move(spoolDirectory_))
+	, completionHandler(std::move(completionHandler_))
+	, limits(limits_)
+	, spooling(false) {
+	const auto type = mediaType(request);
+
+	if (type == "multipart/form-data") {
+		const auto contentType = request[Field::content_type];
+
+		multipartParser = std::make_unique<MultipartFormDataParser>(
+			  MultipartFormDataParser::extractBoundary(std::string_view(contentType.data(), contentType.length()))
+			, static_cast<MultipartFormDataParser::Handler &>(*this)
+		);
+	} else if (type == "application/x-www-form-urlencoded") {
+		formParser = std::make_unique<FormUrlEncodedParser>(
+			  [this] (std::string && name, std::string && value) { addField(std::move(name), std::move(value)); }
+			, limits.maxFieldLength
+			, true
+			, limits.maxFieldCount
+		);
+	} else {
+		ThrowBalauException(Exception::NetworkException, ::toString("Unsupported form content type: ", type));
+	}
+}
+
+FormRequestBodyHandler::FormRequestBodyHandler(const StringRequest & request,
+                                               Resource::File spoolDirectory_,
+                                               CompletionHandler completionHandler_)
+	: FormRequestBodyHandler(request, std::move(spoolDirectory_), std::move(completionHandler_), Limits()) {}
+
+void FormRequestBodyHandler::onBodyChunk(std::string_view chunk) {
+	if (formParser) {
+		formParser->append(chunk);
+	} else {
+		multipartParser->append(chunk);
+	}
+}
+
+void FormRequestBodyHandler::onBodyComplete(HttpSession & session,
+                                            const StringRequest & request,
+                                            std::map<std::string, std::string> & variables) {
+	finish();
+	completionHandler(session, request, variables, form);
+}
+
+void FormRequestBodyHandler::finish() {
+	if (formParser) {
+		formParser->finish();
+	} else {
+		multipartParser->finish();
+	}
+}
+
+void FormRequestBodyHandler::onPartBegin(const MultipartFormDataParser::Part & part) {
+	checkFieldCount();
+
+	if (!part.isFile()) {
+		fieldName = part.name;
+		fieldValue.clear();
+		return;
+	}
+
+	spoolDirectory.createDirectories();
+
+	form.files.emplace_back(
+		part.name, part.filename, part.contentType, spoolDirectory / ("upload-" + UUID().asString())
+	);
+
+	spoolStream.open(form.files.back().file.toRawString(), std::ios::binary | std::ios::trunc);
+
+	if (!spoolStream) {
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("Could not create upload spool file: ", form.files.back().file)
+		);
+	}
+
+	spooling = true;
+}
+
+void FormRequestBodyHandler::onPartData(std::string_view data) {
+	if (!spooling) {
+		if (fieldValue.length() + data.length() > limits.maxFieldLength) {
+			ThrowBalauException(
+				  Exception::NetworkException
+				, ::toString("Form field exceeds the maximum length of ", limits.maxFieldLength, " bytes.")
+			);
+		}
+
+		fieldValue.append(data);
+		return;
+	}
+
+	auto & file = form.files.back();
+
+	if (data.length() > limits.maxFileSize - file.size) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Uploaded file exceeds the maximum size of ", limits.maxFileSize, " bytes.")
+		);
+	}
+
+	spoolStream.write(data.data(), (std::streamsize) data.length());
+
+	if (!spoolStream) {
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("Could not write to upload spool file: ", file.file)
+		);
+	}
+
+	file.size += data.length();
+}
+
+void FormRequestBodyHandler::onPartEnd() {
+	if (!spooling) {
+		form.fields.emplace(std::move(fieldName), std::move(fieldValue));
+		fieldName.clear();
+		fieldValue.clear();
+		return;
+	}
+
+	spooling = false;
+	spoolStream.close();
+
+	if (!spoolStream) {
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("Could not write to upload spool file: ", form.files.back().file)
+		);
+	}
+}
+
+void FormRequestBodyHandler::addField(std::string && name, std::string && value) {
+	checkFieldCount();
+	form.fields.emplace(std::move(name), std::move(value));
+}
+
+void FormRequestBodyHandler::checkFieldCount() const {
+	if (form.fields.size() + form.files.size() >= limits.maxFieldCount) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Form exceeds the maximum field count of ", limits.maxFieldCount, ".")
+		);
+	}
+}
+
+} // namespace Balau::Network::Http
@@ -0,0 +1,273 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file FormRequestBodyHandler.hpp
+///
+/// A request body handler that parses form submissions and spools file uploads to disk.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__FORM_REQUEST_BODY_HANDLER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__FORM_REQUEST_BODY_HANDLER
+
+#include <Balau/Network/Http/Server/RequestBodyHandler.hpp>
+#include <Balau/Network/Utilities/FormUrlEncodedParser.hpp>
+#include <Balau/Network/Utilities/MultipartFormDataParser.hpp>
+#include <Balau/Resource/File.hpp>
+
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+
+namespace Balau::Network::Http {
+
+///
+/// A request body handler that parses form submissions and spools file uploads to disk.
+///
+/// Both application/x-www-form-urlencoded and multipart/form-data bodies are parsed
+/// incrementally as the body chunks arrive. Form fields are decoded into a map. The
+/// file parts of multipart bodies are written directly to spool files in the spool
+/// directory, so that uploaded files are never held in memory.
+///
+/// When the body has been received, the completion handler is called with the parsed
+/// form. The completion handler must send the response. Spool files are deleted when
+/// the form is destroyed, unless they have been released by the completion handler.
+///
+/// Form body handlers are typically created in an HttpWebApp::createPostBodyHandler
+/// override:
+///
+/// <pre>
+/// if (!FormRequestBodyHandler::isForm(request)) {
+///     return std::unique_ptr<RequestBodyHandler>();
+/// }
+///
+/// return std::make_unique<FormRequestBodyHandler>(request, spoolDirectory, [] (auto & session, auto & request, auto & variables, auto & form) {
+///     // Process the form and send the response.
+/// });
+/// </pre>
+///
+class FormRequestBodyHandler : public RequestBodyHandler, private MultipartFormDataParser::Handler {
+	///
+	/// A file uploaded in a multipart/form-data request and spooled to disk.
+	///
+	/// The spool file is deleted when the instance is destroyed, unless it has been released.
+	///
+	public: class SpooledFile {
+		///
+		/// The name of the form field.
+		///
+		public: std::string name;
+
+		///
+		/// The filename supplied by the client.
+		///
+		public: std::string filename;
+
+		///
+		/// The content type supplied by the client.
+		///
+		public: std::string contentType;
+
+		///
+		/// The spool file containing the uploaded data.
+		///
+		public: Resource::File file;
+
+		///
+		/// The size of the uploaded data in bytes.
+		///
+		public: size_t size;
+
+		public: SpooledFile(std::string name_, std::string filename_, std::string contentType_, Resource::File file_)
+			: name(std::move(name_))
+			, filename(std::move(filename_))
+			, contentType(std::move(contentType_))
+			, file(std::move(file_))
+			, size(0)
+			, owned(true) {}
+
+		public: SpooledFile(SpooledFile && rhs) noexcept
+			: name(std::move(rhs.name))
+			, filename(std::move(rhs.filename))
+			, contentType(std::move(rhs.contentType))
+			, file(std::move(rhs.file))
+			, size(rhs.size)
+			, owned(rhs.owned) {
+			rhs.owned = false;
+		}
+
+		public: SpooledFile(const SpooledFile & ) = delete;
+		public: SpooledFile & operator = (const SpooledFile & ) = delete;
+
+		///
+		/// Take ownership of the spool file, for example after moving it to its final location.
+		///
+		public: const Resource::File & release() {
+			owned = false;
+			return file;
+		}
+
+		///
+		/// Remove the spool file if it is still owned. Removal failures are logged.
+		///
+		public: ~SpooledFile();
+
+		private: bool owned;
+	};
+
+	///
+	/// The parsed form.
+	///
+	public: struct Form {
+		///
+		/// The decoded form fields, excluding file uploads.
+		///
+		std::unordered_map<std::string, std::string> fields;
+
+		///
+		/// The uploaded files.
+		///
+		std::vector<SpooledFile> files;
+	};
+
+	///
+	/// The limits applied during parsing.
+	///
+	/// Exceeding a limit aborts the request.
+	///
+	public: struct Limits {
+		///
+		/// The maximum length of a single non-file form field.
+		///
+		size_t maxFieldLength = FormUrlEncodedParser::DefaultMaxFieldLength;
+
+		///
+		/// The maximum number of form fields, including file uploads and empty fields.
+		///
+		size_t maxFieldCount = 1000;
+
+		///
+		/// The maximum size of a single uploaded file.
+		///
+		size_t maxFileSize = RequestBodyHandler::DefaultMaxBodySize;
+
+		///
+		/// The maximum total size of the request body.
+		///
+		uint64_t maxBodySize = RequestBodyHandler::DefaultMaxBodySize;
+	};
+
+	///
+	/// The type of the function called when the body has been parsed.
+	///
+	public: using CompletionHandler = std::function<void (HttpSession & session,
+	                                                      const StringRequest & request,
+	                                                      std::map<std::string, std::string> & variables,
+	                                                      Form & form)>;
+
+	///
+	/// Returns true if the request has a form content type handled by this class.
+	///
+	public: static bool isForm(const StringRequest & request);
+
+	///
+	/// Returns true if the request has an application/x-www-form-urlencoded content type.
+	///
+	public: static bool isUrlEncodedForm(const StringRequest & request);
+
+	///
+	/// Returns true if the request has a multipart/form-data content type.
+	///
+	public: static bool isMultipartForm(const StringRequest & request);
+
+	///
+	/// Create a form body handler for the supplied request.
+	///
+	/// @param request the request, containing the header fields
+	/// @param spoolDirectory_ the directory in which to create the spool files of uploaded files
+	/// @param completionHandler_ the function called when the body has been parsed
+	/// @param limits_ the limits applied during parsing
+	/// @throw NetworkException if the request does not have a form content type
+	///
+	public: FormRequestBodyHandler(const StringRequest & request,
+	                               Resource::File spoolDirectory_,
+	                               CompletionHandler completionHandler_,
+	                               Limits limits_);
+
+	///
+	/// Create a form body handler for the supplied request, with the default limits.
+	///
+	/// @param request the request, containing the header fields
+	/// @param spoolDirectory_ the directory in which to create the spool files of uploaded files
+	/// @param completionHandler_ the function called when the body has been parsed
+	/// @throw NetworkException if the request does not have a form content type
+	///
+	public: FormRequestBodyHandler(const StringRequest & request,
+	                               Resource::File spoolDirectory_,
+	                               CompletionHandler completionHandler_);
+
+	public: uint64_t maxBodySize() const override {
+		return limits.maxBodySize;
+	}
+
+	public: void onBodyChunk(std::string_view chunk) override;
+
+	public: void onBodyComplete(HttpSession & session,
+	                            const StringRequest & request,
+	                            std::map<std::string, std::string> & variables) override;
+
+	///
+	/// Signal the end of the body and complete parsing.
+	///
+	/// This is called by onBodyComplete before the completion handler is called.
+	///
+	/// @throw NetworkException if the body is incomplete
+	///
+	public: void finish();
+
+	///
+	/// Get the form parsed so far.
+	///
+	public: Form & getForm() {
+		return form;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: void onPartBegin(const MultipartFormDataParser::Part & part) override;
+	private: void onPartData(std::string_view data) override;
+	private: void onPartEnd() override;
+	private: void addField(std::string && name, std::string && value);
+	private: void checkFieldCount() const;
+
+	private: const Resource::File spoolDirectory;
+	private: const CompletionHandler completionHandler;
+	private: const Limits limits;
+	private: std::unique_ptr<FormUrlEncodedParser> formParser;
+	private: std::unique_ptr<MultipartFormDataParser> multipartParser;
+	private: Form form;
+	private: std::string fieldName;
+	private: std::string fieldValue;
+	private: bool spooling;
+	private: std::ofstream spoolStream;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__FORM_REQUEST_BODY_HANDLER
@@ -0,0 +1,1145 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "Http2Session.hpp"
+#include "Impl/ConfigurationPublisher.hpp"
+#include "Impl/HttpSessions.hpp"
+#include "../../../Logging/Logger.hpp"
+
+#include <cctype>
+
+namespace Balau::Network::Http {
+
+using namespace Impl::Http2Frames;
+
+namespace {
+
+bool isConnectionSpecificHeader(std::string_view name) {
+	return name == "connection"
+		|| name == "keep-alive"
+		|| name == "proxy-connection"
+		|| name == "transfer-encoding"
+		|| name == "upgrade";
+}
+
+int base64UrlValue(char c) {
+	if (c >= 'A' && c <= 'Z') {
+		return c - 'A';
+	} else if (c >= 'a' && c <= 'z') {
+		return c - 'a' + 26;
+	} else if (c >= '0' && c <= '9') {
+		return c - '0' + 52;
+	} else if (c == '-') {
+		return 62;
+	} else if (c == '_') {
+		return 63;
+	}
+
+	return -1;
+}
+
+//
+// Populate the request from the decoded header list of a HEADERS frame.
+//
+// Returns false if the request is malformed (RFC 7540 section 8.1.2).
+//
+bool buildRequest(std::vector<Impl::HpackHeader> & headers, StringRequest & request) {
+	std::string method;
+	std::string scheme;
+	std::string path;
+	std::string authority;
+	std::string cookie;
+	bool regularHeaderSeen = false;
+
+	for (auto & header : headers) {
+		if (header.name.empty()) {
+			return false;
+		}
+
+		if (header.name[0] == ':') {
+			std::string * pseudoHeader;
+
+			if (regularHeaderSeen) {
+				return false;
+			} else if (header.name == ":method") {
+				pseudoHeader = &method;
+			} else if (header.name == ":scheme") {
+				pseudoHeader = &scheme;
+			} else if (header.name == ":path") {
+				pseudoHeader = &path;
+			} else if (header.name == ":authority") {
+				pseudoHeader = &authority;
+			} else {
+				return false;
+			}
+
+			if (!pseudoHeader->empty() || header.value.empty()) {
+				return false;
+			}
+
+			*pseudoHeader = std::move(header.value);
+			continue;
+		}
+
+		regularHeaderSeen = true;
+
+		for (char c : header.name) {
+			if (c >= 'A' && c <= 'Z') {
+				return false;
+			}
+		}
+
+		if (isConnectionSpecificHeader(header.name) || (header.name == "te" && header.value != "trailers")) {
+			return false;
+		}
+
+		// Cookie headers may be split into multiple fields (RFC 7540 section 8.1.2.5).
+		if (header.name == "cookie") {
+			if (!cookie.empty()) {
+				cookie.append("; ");
+			}
+
+			cookie.append(header.value);
+			continue;
+		}
+
+		request.insert(header.name, header.value);
+	}
+
+	if (method.empty() || scheme.empty() || path.empty()) {
+		return false;
+	}
+
+	request.method_string(method);
+	request.target(path);
+	request.version(11);
+
+	if (!authority.empty() && request.find(Field::host) == request.end()) {
+		request.set(Field::host, authority);
+	}
+
+	if (!cookie.empty()) {
+		request.set(Field::cookie, cookie);
+	}
+
+	return true;
+}
+
+} // namespace
+
+Http2Session::Http2Session(std::shared_ptr<HttpSession> connection_)
+	: connection(std::move(connection_))
+	, settings(connection->serverConfiguration->http2)
+	, streamConfiguration(connection->serverConfiguration)
+	, streamConfigurationGeneration(connection->configurationGeneration)
+	, remoteAddress(connection->remoteIpAddress())
+	, decoder(settings.headerTableSize)
+	, connectionReceiveWindow(std::max(settings.initialWindowSize, DefaultWindowSize)) {}
+
+bool Http2Session::decodeSettingsHeader(std::string_view value, std::string & payload) {
+	payload.clear();
+
+	unsigned accumulator = 0;
+	unsigned bits = 0;
+
+	for (char c : value) {
+		if (c == '=') {
+			break;
+		}
+
+		const int sextet = base64UrlValue(c);
+
+		if (sextet < 0) {
+			return false;
+		}
+
+		accumulator = (accumulator << 6U) | (unsigned) sextet;
+		bits += 6;
+
+		if (bits >= 8) {
+			bits -= 8;
+			payload.push_back((char) (accumulator >> bits));
+			accumulator &= (1U << bits) - 1;
+		}
+	}
+
+	return payload.length() % 6 == 0;
+}
+
+void Http2Session::startWithPriorKnowledge() {
+	// The request line of the connection preface has already been parsed by the HTTP session.
+	expectedPreface = ConnectionPreface.substr(ConnectionPrefaceRequestLength);
+	sendServerPreface();
+	registerWithConnection();
+	processInput();
+}
+
+void Http2Session::startNegotiated() {
+	// The client sends the full connection preface after the TLS handshake.
+	expectedPreface = ConnectionPreface;
+	sendServerPreface();
+	registerWithConnection();
+	processInput();
+}
+
+void Http2Session::startUpgraded(StringRequest && request_, std::string_view settingsPayload) {
+	expectedPreface = ConnectionPreface;
+	sendServerPreface();
+
+	if (!applySettings(settingsPayload)) {
+		flush();
+		return;
+	}
+
+	// The upgrade request is the request of stream 1, which is half closed (remote).
+	request_.erase(Field::upgrade);
+	request_.erase(Field::connection);
+	request_.erase("HTTP2-Settings");
+
+	lastStreamId = 1;
+
+	auto & stream = streams.emplace(
+		1, Stream { nullptr, nullptr, peerInitialWindowSize, settings.initialWindowSize }
+	).first->second;
+
+	stream.session = std::make_shared<HttpSession>(
+		  connection->httpSessions
+		, connection->clientSessions
+		, connection->serverConfiguration
+		, connection->strand
+		, remoteAddress
+		, weak_from_this()
+		, 1
+	);
+
+	stream.headRequest = request_.method() == Method::head;
+	stream.remoteClosed = true;
+
+	const size_t bytesIn = connection->requestBytesIn;
+	stream.session->startHttp2Request(std::move(request_), bytesIn);
+	stream.session->dispatchHttp2Request();
+
+	registerWithConnection();
+	processInput();
+}
+
+void Http2Session::drain() {
+	boost::asio::post(connection->strand, std::bind(&Http2Session::doDrain, shared_from_this()));
+}
+
+void Http2Session::sendHttp2Response(uint32_t streamId, std::unique_ptr<Impl::Http2Response> response) {
+	// The response is started via the strand, as the web application may be executing within a frame handler.
+	std::shared_ptr<Impl::Http2Response> sharedResponse(std::move(response));
+
+	boost::asio::post(
+		  connection->strand
+		, [self = shared_from_this(), streamId, sharedResponse] () {
+			self->startResponse(streamId, sharedResponse);
+			self->pump();
+			self->flush();
+		}
+	);
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+void Http2Session::sendServerPreface() {
+	std::string payload;
+	appendSetting(payload, SettingId::MaxConcurrentStreams, settings.maxConcurrentStreams);
+
+	if (settings.initialWindowSize != DefaultWindowSize) {
+		appendSetting(payload, SettingId::InitialWindowSize, settings.initialWindowSize);
+	}
+
+	if (settings.maxFrameSize != DefaultMaxFrameSize) {
+		appendSetting(payload, SettingId::MaxFrameSize, settings.maxFrameSize);
+	}
+
+	if (settings.headerTableSize != Impl::HpackDefaultTableSize) {
+		appendSetting(payload, SettingId::HeaderTableSize, settings.headerTableSize);
+	}
+
+	appendSetting(payload, SettingId::MaxHeaderListSize, settings.maxHeaderListSize);
+
+	appendFrameHeader(output, (uint32_t) payload.length(), FrameType::Settings, 0, 0);
+	output.append(payload);
+
+	// The connection window can only be enlarged via a WINDOW_UPDATE frame.
+	if (connectionReceiveWindow > DefaultWindowSize) {
+		writeWindowUpdate(0, (uint32_t) (connectionReceiveWindow - DefaultWindowSize));
+	}
+}
+
+void Http2Session::doRead() {
+	auto & buffer = connection->buffer;
+
+	connection->socket.async_read_some(
+		  buffer.prepare(std::max<size_t>(settings.maxFrameSize + FrameHeaderLength, 16 * 1024))
+		, boost::asio::bind_executor(
+			  connection->strand
+			, std::bind(&Http2Session::onRead, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
+		)
+	);
+}
+
+void Http2Session::onRead(boost::system::error_code errorCode, std::size_t bytesTransferred) {
+	if (errorCode) {
+		if (errorCode != boost::asio::error::eof && errorCode != boost::asio::error::operation_aborted) {
+			BalauBalauLogWarn(connection->serverConfiguration->logger, "Http2Session read error: {}", errorCode);
+		}
+
+		closing = true;
+		abandonStreams();
+		output.clear();
+		flush();
+		return;
+	}
+
+	connection->buffer.commit(bytesTransferred);
+	processInput();
+}
+
+void Http2Session::processInput() {
+	auto & buffer = connection->buffer;
+
+	while (!closing) {
+		const auto data = buffer.data();
+		const char * bytes = static_cast<const char *>(data.data());
+		const size_t size = data.size();
+
+		if (!expectedPreface.empty()) {
+			const size_t count = std::min(size, expectedPreface.length());
+
+			if (std::string_view(bytes, count) != expectedPreface.substr(0, count)) {
+				connectionError(ErrorCode::ProtocolError, "invalid connection preface");
+				break;
+			}
+
+			buffer.consume(count);
+			expectedPreface.remove_prefix(count);
+
+			if (!expectedPreface.empty()) {
+				// The rest of the preface has not been received yet.
+				break;
+			}
+
+			continue;
+		}
+
+		if (size < FrameHeaderLength) {
+			break;
+		}
+
+		const auto header = parseFrameHeader(bytes);
+
+		if (header.length > settings.maxFrameSize) {
+			connectionError(ErrorCode::FrameSizeError, "frame too large");
+			break;
+		}
+
+		if (size < FrameHeaderLength + header.length) {
+			break;
+		}
+
+		if (!handleFrame(header, std::string_view(bytes + FrameHeaderLength, header.length))) {
+			break;
+		}
+
+		buffer.consume(FrameHeaderLength + header.length);
+	}
+
+	if (!closing) {
+		doRead();
+	}
+
+	pump();
+	flush();
+}
+
+bool Http2Session::handleFrame(const FrameHeader & header, std::string_view payload) {
+	if (!settingsReceived && header.type != FrameType::Settings) {
+		return connectionError(ErrorCode::ProtocolError, "the first frame must be a SETTINGS frame");
+	}
+
+	if (continuationExpected && (header.type != FrameType::Continuation || header.streamId != headerBlockStreamId)) {
+		return connectionError(ErrorCode::ProtocolError, "CONTINUATION frame expected");
+	}
+
+	switch (header.type) {
+		case FrameType::Data: {
+			return onData(header, payload);
+		}
+
+		case FrameType::Headers: {
+			return onHeaders(header, payload);
+		}
+
+		case FrameType::Priority: {
+			// Stream prioritisation is not implemented.
+			if (header.streamId == 0) {
+				return connectionError(ErrorCode::ProtocolError, "PRIORITY frame on stream 0");
+			} else if (payload.length() != 5) {
+				resetStream(header.streamId, ErrorCode::FrameSizeError);
+			}
+
+			return true;
+		}
+
+		case FrameType::RstStream: {
+			return onRstStream(header, payload);
+		}
+
+		case FrameType::Settings: {
+			return onSettings(header, payload);
+		}
+
+		case FrameType::PushPromise: {
+			return connectionError(ErrorCode::ProtocolError, "PUSH_PROMISE frame sent by client");
+		}
+
+		case FrameType::Ping: {
+			if (header.streamId != 0) {
+				return connectionError(ErrorCode::ProtocolError, "PING frame on stream other than 0");
+			} else if (payload.length() != 8) {
+				return connectionError(ErrorCode::FrameSizeError, "invalid PING frame length");
+			}
+
+			if (!header.hasFlag(Flags::Ack)) {
+				appendFrameHeader(output, 8, FrameType::Ping, Flags::Ack, 0);
+				output.append(payload);
+			}
+
+			return true;
+		}
+
+		case FrameType::GoAway: {
+			if (header.streamId != 0) {
+				return connectionError(ErrorCode::ProtocolError, "GOAWAY frame on stream other than 0");
+			}
+
+			// The streams that have already been opened are completed.
+			goingAway = true;
+
+			if (streams.empty()) {
+				closing = true;
+			}
+
+			return true;
+		}
+
+		case FrameType::WindowUpdate: {
+			return onWindowUpdate(header, payload);
+		}
+
+		case FrameType::Continuation: {
+			if (!continuationExpected) {
+				return connectionError(ErrorCode::ProtocolError, "unexpected CONTINUATION frame");
+			}
+
+			headerBlock.append(payload);
+
+			if (headerBlock.length() > settings.maxHeaderListSize) {
+				return connectionError(ErrorCode::EnhanceYourCalm, "header block too large");
+			}
+
+			return !header.hasFlag(Flags::EndHeaders) || onHeaderBlock();
+		}
+
+		default: {
+			// Unknown frame types are ignored (RFC 7540 section 4.1).
+			return true;
+		}
+	}
+}
+
+bool Http2Session::onHeaders(const FrameHeader & header, std::string_view payload) {
+	if (header.streamId == 0) {
+		return connectionError(ErrorCode::ProtocolError, "HEADERS frame on stream 0");
+	}
+
+	if (header.hasFlag(Flags::Padded)) {
+		const size_t padding = payload.empty() ? 0 : (unsigned char) payload[0];
+
+		if (payload.empty() || padding >= payload.length()) {
+			return connectionError(ErrorCode::ProtocolError, "invalid HEADERS frame padding");
+		}
+
+		payload = payload.substr(1, payload.length() - 1 - padding);
+	}
+
+	if (header.hasFlag(Flags::Priority)) {
+		if (payload.length() < 5) {
+			return connectionError(ErrorCode::FrameSizeError, "invalid HEADERS frame priority");
+		}
+
+		payload.remove_prefix(5);
+	}
+
+	// A compressed header block is never larger than the decoded header list,
+	// so the block is limited before it is buffered any further.
+	if (payload.length() > settings.maxHeaderListSize) {
+		return connectionError(ErrorCode::EnhanceYourCalm, "header block too large");
+	}
+
+	headerBlock.assign(payload.data(), payload.length());
+	headerBlockStreamId = header.streamId;
+	headerBlockEndStream = header.hasFlag(Flags::EndStream);
+	continuationExpected = true;
+
+	return !header.hasFlag(Flags::EndHeaders) || onHeaderBlock();
+}
+
+bool Http2Session::onHeaderBlock() {
+	continuationExpected = false;
+
+	std::vector<Impl::HpackHeader> headers;
+
+	// The block is always decoded, in order to maintain the state of the dynamic table.
+	const auto result = decoder.decode(headerBlock, headers, settings.maxHeaderListSize);
+	const size_t bytesIn = headerBlock.length();
+	headerBlock.clear();
+
+	if (result == Impl::HpackDecoder::Result::CompressionError) {
+		return connectionError(ErrorCode::CompressionError, "invalid header block");
+	}
+
+	const uint32_t streamId = headerBlockStreamId;
+	auto iter = streams.find(streamId);
+
+	if (iter != streams.end()) {
+		// Trailers, which are ignored.
+		if (iter->second.remoteClosed) {
+			resetStream(streamId, ErrorCode::StreamClosed);
+		} else if (!headerBlockEndStream) {
+			resetStream(streamId, ErrorCode::ProtocolError);
+		} else {
+			onRemoteEnd(iter);
+		}
+
+		return true;
+	}
+
+	if ((streamId & 1U) == 0 || streamId <= lastStreamId) {
+		return connectionError(ErrorCode::ProtocolError, "invalid stream identifier");
+	}
+
+	lastStreamId = streamId;
+
+	if (goingAway || streams.size() >= settings.maxConcurrentStreams) {
+		resetStream(streamId, ErrorCode::RefusedStream);
+		return true;
+	}
+
+	openStream(
+		streamId, headers, result == Impl::HpackDecoder::Result::HeaderListTooLarge, bytesIn, headerBlockEndStream
+	);
+
+	return true;
+}
+
+void Http2Session::openStream(uint32_t streamId,
+                              std::vector<Impl::HpackHeader> & headers,
+                              bool tooLarge,
+                              size_t bytesIn,
+                              bool endStream) {
+	StringRequest request;
+
+	if (!tooLarge && !buildRequest(headers, request)) {
+		resetStream(streamId, ErrorCode::ProtocolError);
+		return;
+	}
+
+	auto iter = streams.emplace(
+		streamId, Stream { nullptr, nullptr, peerInitialWindowSize, settings.initialWindowSize }
+	).first;
+
+	auto & stream = iter->second;
+
+	// New streams pick up a reloaded configuration. The connection settings are not reloadable.
+	connection->publisher->refresh(streamConfiguration, streamConfigurationGeneration);
+
+	stream.session = std::make_shared<HttpSession>(
+		  connection->httpSessions
+		, connection->clientSessions
+		, streamConfiguration
+		, connection->strand
+		, remoteAddress
+		, weak_from_this()
+		, streamId
+	);
+
+	stream.headRequest = request.method() == Method::head;
+	stream.remoteClosed = endStream;
+
+	auto & session = *stream.session;
+	session.startHttp2Request(std::move(request), bytesIn);
+
+	if (tooLarge) {
+		Response<StringBody> response { Status::request_header_fields_too_large, 11 };
+		connection->serverConfiguration->headerCache.setCommonHeaders(response);
+		response.set(Field::content_type, "text/html");
+		response.body() = "Request header fields too large.";
+		response.prepare_payload();
+		session.sendResponse(std::move(response));
+		stream.discardingBody = true;
+	} else if (!endStream && session.request.method() == Method::post) {
+		stream.streamingBody = session.startHttp2Body();
+	}
+
+	if (endStream) {
+		onRemoteEnd(iter);
+	}
+}
+
+bool Http2Session::onData(const FrameHeader & header, std::string_view payload) {
+	if (header.streamId == 0) {
+		return connectionError(ErrorCode::ProtocolError, "DATA frame on stream 0");
+	}
+
+	// Flow control applies to the entire frame payload, including the padding.
+	const size_t length = payload.length();
+	connectionReceiveWindow -= (int64_t) length;
+
+	if (connectionReceiveWindow < 0) {
+		return connectionError(ErrorCode::FlowControlError, "connection flow control window exceeded");
+	}
+
+	connectionReceivedSinceUpdate += length;
+
+	if (connectionReceivedSinceUpdate >= (size_t) std::max(settings.initialWindowSize, DefaultWindowSize) / 2) {
+		writeWindowUpdate(0, (uint32_t) connectionReceivedSinceUpdate);
+		connectionReceiveWindow += (int64_t) connectionReceivedSinceUpdate;
+		connectionReceivedSinceUpdate = 0;
+	}
+
+	if (header.hasFlag(Flags::Padded)) {
+		const size_t padding = payload.empty() ? 0 : (unsigned char) payload[0];
+
+		if (payload.empty() || padding >= payload.length()) {
+			return connectionError(ErrorCode::ProtocolError, "invalid DATA frame padding");
+		}
+
+		payload = payload.substr(1, payload.length() - 1 - padding);
+	}
+
+	auto iter = streams.find(header.streamId);
+
+	if (iter == streams.end()) {
+		// Frames received on a stream that has been closed or reset are ignored.
+		return header.streamId <= lastStreamId
+			|| connectionError(ErrorCode::ProtocolError, "DATA frame on idle stream");
+	} else if (iter->second.remoteClosed) {
+		resetStream(header.streamId, ErrorCode::StreamClosed);
+		return true;
+	}
+
+	auto & stream = iter->second;
+	stream.receiveWindow -= (int64_t) length;
+
+	if (stream.receiveWindow < 0) {
+		resetStream(header.streamId, ErrorCode::FlowControlError);
+		return true;
+	}
+
+	auto & session = *stream.session;
+
+	if (stream.discardingBody || payload.empty()) {
+		// Nothing to deliver.
+	} else if (stream.streamingBody) {
+		stream.discardingBody = !session.deliverBodyChunk(payload);
+	} else if (session.request.body().length() + payload.length() > settings.maxBufferedBodySize) {
+		session.rejectOversizeBody();
+		stream.discardingBody = true;
+	} else {
+		session.request.body().append(payload.data(), payload.length());
+	}
+
+	session.requestBytesIn += length;
+
+	if (header.hasFlag(Flags::EndStream)) {
+		onRemoteEnd(iter);
+		return true;
+	}
+
+	stream.receivedSinceUpdate += length;
+
+	if (stream.receivedSinceUpdate >= settings.initialWindowSize / 2 && stream.receivedSinceUpdate != 0) {
+		writeWindowUpdate(header.streamId, (uint32_t) stream.receivedSinceUpdate);
+		stream.receiveWindow += (int64_t) stream.receivedSinceUpdate;
+		stream.receivedSinceUpdate = 0;
+	}
+
+	return true;
+}
+
+bool Http2Session::onSettings(const FrameHeader & header, std::string_view payload) {
+	if (header.streamId != 0) {
+		return connectionError(ErrorCode::ProtocolError, "SETTINGS frame on stream other than 0");
+	}
+
+	if (header.hasFlag(Flags::Ack)) {
+		return payload.empty() || connectionError(ErrorCode::FrameSizeError, "invalid SETTINGS acknowledgement");
+	}
+
+	settingsReceived = true;
+
+	if (!applySettings(payload)) {
+		return false;
+	}
+
+	appendFrameHeader(output, 0, FrameType::Settings, Flags::Ack, 0);
+	return true;
+}
+
+bool Http2Session::applySettings(std::string_view payload) {
+	if (payload.length() % 6 != 0) {
+		return connectionError(ErrorCode::FrameSizeError, "invalid SETTINGS frame length");
+	}
+
+	for (size_t offset = 0; offset < payload.length(); offset += 6) {
+		const auto id = (SettingId) (((unsigned) (unsigned char) payload[offset] << 8U) | (unsigned char) payload[offset + 1]);
+		const uint32_t value = readUint32(payload.data() + offset + 2);
+
+		switch (id) {
+			case SettingId::HeaderTableSize: {
+				encoder.setMaximumTableSize(value);
+				break;
+			}
+
+			case SettingId::EnablePush: {
+				// Server push is not used.
+				if (value > 1) {
+					return connectionError(ErrorCode::ProtocolError, "invalid SETTINGS_ENABLE_PUSH value");
+				}
+
+				break;
+			}
+
+			case SettingId::InitialWindowSize: {
+				if (value > Http2Settings::MaximumWindowSize) {
+					return connectionError(ErrorCode::FlowControlError, "invalid SETTINGS_INITIAL_WINDOW_SIZE value");
+				}
+
+				// The change applies to the send windows of all open streams (RFC 7540 section 6.9.2).
+				const int64_t delta = (int64_t) value - (int64_t) peerInitialWindowSize;
+
+				for (auto & entry : streams) {
+					entry.second.sendWindow += delta;
+
+					if (entry.second.sendWindow > Http2Settings::MaximumWindowSize) {
+						return connectionError(ErrorCode::FlowControlError, "stream flow control window overflow");
+					}
+				}
+
+				peerInitialWindowSize = value;
+				break;
+			}
+
+			case SettingId::MaxFrameSize: {
+				if (value < Http2Settings::MinimumFrameSize || value > Http2Settings::MaximumFrameSize) {
+					return connectionError(ErrorCode::ProtocolError, "invalid SETTINGS_MAX_FRAME_SIZE value");
+				}
+
+				peerMaxFrameSize = value;
+				break;
+			}
+
+			default: {
+				// SETTINGS_MAX_CONCURRENT_STREAMS and SETTINGS_MAX_HEADER_LIST_SIZE
+				// are not relevant to the server. Unknown settings are ignored.
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Http2Session::onWindowUpdate(const FrameHeader & header, std::string_view payload) {
+	if (payload.length() != 4) {
+		return connectionError(ErrorCode::FrameSizeError, "invalid WINDOW_UPDATE frame length");
+	}
+
+	const uint32_t increment = readUint32(payload.data()) & 0x7FFFFFFFU;
+
+	if (header.streamId == 0) {
+		if (increment == 0) {
+			return connectionError(ErrorCode::ProtocolError, "zero WINDOW_UPDATE increment");
+		}
+
+		connectionSendWindow += increment;
+
+		if (connectionSendWindow > Http2Settings::MaximumWindowSize) {
+			return connectionError(ErrorCode::FlowControlError, "connection flow control window overflow");
+		}
+
+		return true;
+	}
+
+	auto iter = streams.find(header.streamId);
+
+	if (iter == streams.end()) {
+		return header.streamId <= lastStreamId
+			|| connectionError(ErrorCode::ProtocolError, "WINDOW_UPDATE frame on idle stream");
+	}
+
+	if (increment == 0) {
+		resetStream(header.streamId, ErrorCode::ProtocolError);
+		return true;
+	}
+
+	iter->second.sendWindow += increment;
+
+	if (iter->second.sendWindow > Http2Settings::MaximumWindowSize) {
+		resetStream(header.streamId, ErrorCode::FlowControlError);
+	}
+
+	return true;
+}
+
+bool Http2Session::onRstStream(const FrameHeader & header, std::string_view payload) {
+	if (header.streamId == 0) {
+		return connectionError(ErrorCode::ProtocolError, "RST_STREAM frame on stream 0");
+	} else if (payload.length() != 4) {
+		return connectionError(ErrorCode::FrameSizeError, "invalid RST_STREAM frame length");
+	} else if (header.streamId > lastStreamId) {
+		return connectionError(ErrorCode::ProtocolError, "RST_STREAM frame on idle stream");
+	}
+
+	// Rapid reset defence: a client that opens and resets streams faster than
+	// the limit would otherwise cause unbounded request processing.
+	const auto now = std::chrono::steady_clock::now();
+
+	if (now - resetWindowStart >= std::chrono::seconds(1)) {
+		resetWindowStart = now;
+		resetsInWindow = 0;
+	}
+
+	if (++resetsInWindow > settings.maxStreamResetsPerSecond) {
+		return connectionError(ErrorCode::EnhanceYourCalm, "too many stream resets");
+	}
+
+	auto iter = streams.find(header.streamId);
+
+	if (iter != streams.end()) {
+		iter->second.session->abandonRequestMetrics();
+		streams.erase(iter);
+
+		if (goingAway && streams.empty()) {
+			closing = true;
+		}
+	}
+
+	return true;
+}
+
+void Http2Session::onRemoteEnd(Streams::iterator iter) {
+	auto & stream = iter->second;
+	auto & session = *stream.session;
+	stream.remoteClosed = true;
+
+	if (stream.discardingBody) {
+		// The response has already been sent.
+	} else if (stream.streamingBody) {
+		session.completeStreamedBody();
+	} else {
+		session.dispatchHttp2Request();
+	}
+}
+
+void Http2Session::startResponse(uint32_t streamId, const std::shared_ptr<Impl::Http2Response> & response) {
+	auto iter = streams.find(streamId);
+
+	// The stream may have been reset by the client.
+	if (closing || iter == streams.end() || iter->second.responseStarted) {
+		return;
+	}
+
+	auto & stream = iter->second;
+	stream.responseStarted = true;
+
+	bool endStream;
+
+	try {
+		endStream = stream.headRequest || !response->hasMore();
+	} catch (const std::exception & e) {
+		BalauBalauLogError(connection->serverConfiguration->logger, "Exception thrown during HTTP/2 response: {}", e);
+		resetStream(streamId, ErrorCode::InternalError);
+		return;
+	}
+
+	writeHeaders(streamId, stream, response->header(), endStream);
+
+	if (endStream) {
+		endLocal(iter);
+	} else {
+		stream.response = response;
+	}
+}
+
+void Http2Session::writeHeaders(uint32_t streamId, Stream & stream, const HTTP::response_header<> & header, bool endStream) {
+	std::string block;
+	encoder.startBlock(block);
+	encoder.encode(":status", std::to_string(header.result_int()), block);
+
+	std::string name;
+
+	for (const auto & field : header) {
+		const auto nameString = field.name_string();
+		name.assign(nameString.data(), nameString.length());
+
+		for (auto & c : name) {
+			c = (char) std::tolower((unsigned char) c);
+		}
+
+		if (isConnectionSpecificHeader(name)) {
+			continue;
+		}
+
+		const auto value = field.value();
+		encoder.encode(name, std::string_view(value.data(), value.length()), block);
+	}
+
+	// The header block is split into CONTINUATION frames if it exceeds the peer's maximum frame size.
+	size_t offset = 0;
+	FrameType type = FrameType::Headers;
+
+	do {
+		const size_t length = std::min<size_t>(block.length() - offset, peerMaxFrameSize);
+		const bool last = offset + length == block.length();
+
+		uint8_t flags = last ? Flags::EndHeaders : 0;
+
+		if (type == FrameType::Headers && endStream) {
+			flags |= Flags::EndStream;
+		}
+
+		appendFrameHeader(output, (uint32_t) length, type, flags, streamId);
+		output.append(block, offset, length);
+		offset += length;
+		type = FrameType::Continuation;
+	} while (offset < block.length());
+
+	stream.bytesOut += block.length() + FrameHeaderLength;
+}
+
+void Http2Session::pump() {
+	bool progress = true;
+
+	while (progress && !closing && output.length() < OutputHighWaterMark && connectionSendWindow > 0) {
+		progress = false;
+
+		// Each stream with a pending response body sends at most one frame per round.
+		auto iter = streams.upper_bound(lastPumpedStreamId);
+
+		for (size_t visited = 0, count = streams.size(); visited < count && !streams.empty(); ++visited) {
+			if (iter == streams.end()) {
+				iter = streams.begin();
+			}
+
+			auto current = iter++;
+			auto & stream = current->second;
+
+			if (!stream.response || stream.sendWindow <= 0) {
+				continue;
+			}
+
+			lastPumpedStreamId = current->first;
+			writeData(current);
+			progress = true;
+
+			if (closing || output.length() >= OutputHighWaterMark || connectionSendWindow <= 0) {
+				break;
+			}
+		}
+	}
+}
+
+void Http2Session::writeData(Streams::iterator iter) {
+	const uint32_t streamId = iter->first;
+	auto & stream = iter->second;
+
+	const size_t maximum = (size_t) std::min<int64_t>(
+		std::min<int64_t>(stream.sendWindow, connectionSendWindow), peerMaxFrameSize
+	);
+
+	const size_t start = output.length();
+	output.resize(start + FrameHeaderLength + maximum);
+
+	size_t count;
+	bool more;
+
+	try {
+		count = stream.response->read(&output[start + FrameHeaderLength], maximum);
+		more = stream.response->hasMore();
+	} catch (const std::exception & e) {
+		BalauBalauLogError(connection->serverConfiguration->logger, "Exception thrown during HTTP/2 response: {}", e);
+		output.resize(start);
+		resetStream(streamId, ErrorCode::InternalError);
+		return;
+	}
+
+	output.resize(start + FrameHeaderLength + count);
+	writeFrameHeader(&output[start], (uint32_t) count, FrameType::Data, more ? 0 : Flags::EndStream, streamId);
+
+	stream.sendWindow -= (int64_t) count;
+	connectionSendWindow -= (int64_t) count;
+	stream.bytesOut += FrameHeaderLength + count;
+
+	if (!more) {
+		endLocal(iter);
+	}
+}
+
+void Http2Session::endLocal(Streams::iterator iter) {
+	auto & stream = iter->second;
+	stream.response.reset();
+
+	// The remainder of the request is not required (RFC 7540 section 8.1).
+	if (!stream.remoteClosed) {
+		appendFrameHeader(output, 4, FrameType::RstStream, 0, iter->first);
+		appendUint32(output, (uint32_t) ErrorCode::NoError);
+	}
+
+	closeStream(iter);
+}
+
+void Http2Session::registerWithConnection() {
+	// Allows the connection's HTTP session to drain the HTTP/2 session.
+	connection->http2Connection = weak_from_this();
+
+	// The server started draining before the HTTP/2 session took over the connection.
+	if (connection->httpSessions.isDraining()) {
+		doDrain();
+	}
+}
+
+void Http2Session::doDrain() {
+	if (goingAway || closing || closed) {
+		return;
+	}
+
+	// The open streams are completed, after which the connection is closed.
+	appendFrameHeader(output, 8, FrameType::GoAway, 0, 0);
+	appendUint32(output, lastStreamId);
+	appendUint32(output, (uint32_t) ErrorCode::NoError);
+
+	goingAway = true;
+
+	if (streams.empty()) {
+		closing = true;
+	}
+
+	flush();
+}
+
+void Http2Session::closeStream(Streams::iterator iter) {
+	iter->second.session->completeRequestMetrics(iter->second.bytesOut);
+	streams.erase(iter);
+
+	if (goingAway && streams.empty()) {
+		closing = true;
+	}
+}
+
+void Http2Session::resetStream(uint32_t streamId, ErrorCode errorCode) {
+	appendFrameHeader(output, 4, FrameType::RstStream, 0, streamId);
+	appendUint32(output, (uint32_t) errorCode);
+
+	auto iter = streams.find(streamId);
+
+	if (iter != streams.end()) {
+		iter->second.session->abandonRequestMetrics();
+		streams.erase(iter);
+	}
+}
+
+void Http2Session::writeWindowUpdate(uint32_t streamId, uint32_t increment) {
+	appendFrameHeader(output, 4, FrameType::WindowUpdate, 0, streamId);
+	appendUint32(output, increment);
+}
+
+bool Http2Session::connectionError(ErrorCode errorCode, const char * reason) {
+	BalauBalauLogWarn(connection->serverConfiguration->logger, "Http2Session connection error: {}", reason);
+
+	appendFrameHeader(output, 8, FrameType::GoAway, 0, 0);
+	appendUint32(output, lastStreamId);
+	appendUint32(output, (uint32_t) errorCode);
+
+	closing = true;
+	abandonStreams();
+	return false;
+}
+
+void Http2Session::abandonStreams() {
+	for (auto & entry : streams) {
+		entry.second.session->abandonRequestMetrics();
+	}
+
+	streams.clear();
+}
+
+void Http2Session::flush() {
+	if (writeInProgress || closed) {
+		return;
+	}
+
+	if (output.empty()) {
+		if (closing) {
+			// All the output has been written.
+			closed = true;
+			abandonStreams();
+			connection->doClose();
+		}
+
+		return;
+	}
+
+	writing.swap(output);
+	output.clear();
+	writeInProgress = true;
+
+	boost::asio::async_write(
+		  connection->socket
+		, boost::asio::buffer(writing)
+		, boost::asio::bind_executor(
+			  connection->strand
+			, std::bind(&Http2Session::onWrite, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
+		)
+	);
+}
+
+void Http2Session::onWrite(boost::system::error_code errorCode, std::size_t ) {
+	writeInProgress = false;
+	writing.clear();
+
+	if (errorCode) {
+		if (errorCode != boost::asio::error::operation_aborted) {
+			BalauBalauLogWarn(connection->serverConfiguration->logger, "Http2Session write error: {}", errorCode);
+		}
+
+		closing = true;
+		output.clear();
+	}
+
+	pump();
+	flush();
+}
+
+} // namespace Balau::Network::Http
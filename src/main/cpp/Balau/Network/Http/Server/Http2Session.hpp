@@ -0,0 +1,177 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file Http2Session.hpp
+///
+/// Manages an HTTP/2 connection and the multiplexing of its streams.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SESSION
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SESSION
+
+#include <Balau/Network/Http/Server/HttpSession.hpp>
+#include <Balau/Network/Http/Server/Impl/Hpack.hpp>
+#include <Balau/Network/Http/Server/Impl/Http2Frames.hpp>
+
+#include <chrono>
+#include <map>
+
+namespace Balau::Network::Http {
+
+///
+/// Manages an HTTP/2 connection and the multiplexing of its streams.
+///
+/// An HTTP/2 session is created by the HTTP session of a connection, when the
+/// client sends the HTTP/2 connection preface (prior knowledge) or an h2c upgrade
+/// request, or when h2 is negotiated via ALPN during the TLS handshake. The HTTP/2
+/// session then takes over the socket of the connection.
+///
+/// Each stream opened by the client is handled by a separate HTTP session object,
+/// which dispatches the stream's request to the HTTP web application of the server.
+/// The responses of the web application are encoded into HEADERS and DATA frames.
+/// Response bodies are read incrementally as the flow control windows permit, and
+/// the DATA frames of concurrent responses are interleaved in a round robin manner.
+///
+/// All the processing of the connection occurs on the strand of the connection.
+///
+class Http2Session final : public Impl::Http2ResponseSink, public std::enable_shared_from_this<Http2Session> {
+	///
+	/// The number of bytes of pending output above which no further DATA frames are generated.
+	///
+	public: static constexpr size_t OutputHighWaterMark = 256 * 1024;
+
+	///
+	/// Create an HTTP/2 session for the connection of the supplied HTTP session.
+	///
+	public: explicit Http2Session(std::shared_ptr<HttpSession> connection_);
+
+	///
+	/// Decode the value of an HTTP2-Settings header into a SETTINGS frame payload.
+	///
+	/// @return false if the value is not a valid base64url encoded SETTINGS payload
+	///
+	public: static bool decodeSettingsHeader(std::string_view value, std::string & payload);
+
+	///
+	/// Start the session after the first line of the connection preface has been read.
+	///
+	public: void startWithPriorKnowledge();
+
+	///
+	/// Start the session after h2 has been negotiated via ALPN during the TLS handshake.
+	///
+	public: void startNegotiated();
+
+	///
+	/// Start the session after the 101 response to an h2c upgrade request has been written.
+	///
+	/// The upgrade request becomes the request of stream 1.
+	///
+	/// @param request_ the upgrade request
+	/// @param settings the decoded HTTP2-Settings header of the upgrade request
+	///
+	public: void startUpgraded(StringRequest && request_, std::string_view settings);
+
+	public: void sendHttp2Response(uint32_t streamId, std::unique_ptr<Impl::Http2Response> response) override;
+
+	public: void drain() override;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: struct Stream {
+		std::shared_ptr<HttpSession> session;
+		std::shared_ptr<Impl::Http2Response> response;
+		int64_t sendWindow;
+		int64_t receiveWindow;
+		size_t receivedSinceUpdate = 0;
+		size_t bytesOut = 0;
+		bool headRequest = false;
+		bool remoteClosed = false;
+		bool responseStarted = false;
+		bool streamingBody = false;
+		bool discardingBody = false;
+	};
+
+	private: using Streams = std::map<uint32_t, Stream>;
+	private: using ErrorCode = Impl::Http2Frames::ErrorCode;
+
+	private: void sendServerPreface();
+	private: void registerWithConnection();
+	private: void doDrain();
+	private: void doRead();
+	private: void onRead(boost::system::error_code errorCode, std::size_t bytesTransferred);
+	private: void processInput();
+	private: bool handleFrame(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: bool onHeaders(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: bool onHeaderBlock();
+	private: bool onData(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: bool onSettings(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: bool applySettings(std::string_view payload);
+	private: bool onWindowUpdate(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: bool onRstStream(const Impl::Http2Frames::FrameHeader & header, std::string_view payload);
+	private: void openStream(uint32_t streamId, std::vector<Impl::HpackHeader> & headers, bool tooLarge, size_t bytesIn, bool endStream);
+	private: void onRemoteEnd(Streams::iterator iter);
+	private: void startResponse(uint32_t streamId, const std::shared_ptr<Impl::Http2Response> & response);
+	private: void writeHeaders(uint32_t streamId, Stream & stream, const HTTP::response_header<> & header, bool endStream);
+	private: void pump();
+	private: void writeData(Streams::iterator iter);
+	private: void endLocal(Streams::iterator iter);
+	private: void closeStream(Streams::iterator iter);
+	private: void resetStream(uint32_t streamId, ErrorCode errorCode);
+	private: void writeWindowUpdate(uint32_t streamId, uint32_t increment);
+	private: bool connectionError(ErrorCode errorCode, const char * reason);
+	private: void abandonStreams();
+	private: void flush();
+	private: void onWrite(boost::system::error_code errorCode, std::size_t bytesTransferred);
+
+	private: const std::shared_ptr<HttpSession> connection;
+	private: const Http2Settings & settings;
+	private: std::shared_ptr<HttpServerConfiguration> streamConfiguration; // Picks up reloaded configurations.
+	private: uint64_t streamConfigurationGeneration;
+	private: const Address remoteAddress;
+	private: Impl::HpackDecoder decoder;
+	private: Impl::HpackEncoder encoder;
+	private: Streams streams;
+	private: std::string_view expectedPreface;
+	private: std::string headerBlock;
+	private: uint32_t headerBlockStreamId = 0;
+	private: bool headerBlockEndStream = false;
+	private: bool continuationExpected = false;
+	private: std::chrono::steady_clock::time_point resetWindowStart;
+	private: uint32_t resetsInWindow = 0; // Client stream resets in the current one second window.
+	private: bool settingsReceived = false;
+	private: uint32_t lastStreamId = 0;
+	private: uint32_t lastPumpedStreamId = 0;
+	private: uint32_t peerInitialWindowSize = Impl::Http2Frames::DefaultWindowSize;
+	private: uint32_t peerMaxFrameSize = Impl::Http2Frames::DefaultMaxFrameSize;
+	private: int64_t connectionSendWindow = Impl::Http2Frames::DefaultWindowSize;
+	private: int64_t connectionReceiveWindow;
+	private: size_t connectionReceivedSinceUpdate = 0;
+	private: std::string output;
+	private: std::string writing;
+	private: bool writeInProgress = false;
+	private: bool goingAway = false;
+	private: bool closing = false;
+	private: bool closed = false;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SESSION
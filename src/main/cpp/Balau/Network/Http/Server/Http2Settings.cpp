@@ -0,0 +1,70 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "Http2Settings.hpp"
+#include "../../../Application/EnvironmentProperties.hpp"
+
+namespace Balau::Network::Http {
+
+namespace {
+
+void validateRange(const char * name, int64_t value, int64_t minimum, int64_t maximum) {
+	if (value < minimum || value > maximum) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("HTTP/2 setting ", name, " = ", value, " is not in the range ", minimum, " to ", maximum, ".")
+		);
+	}
+}
+
+uint32_t getSetting(const EnvironmentProperties & configuration, const char * name, uint32_t defaultValue, int64_t minimum) {
+	const int value = configuration.getValue<int>(name, (int) defaultValue);
+	validateRange(name, value, minimum, std::numeric_limits<int>::max());
+	return (uint32_t) value;
+}
+
+} // namespace
+
+Http2Settings Http2Settings::fromConfiguration(const EnvironmentProperties & configuration) {
+	const Http2Settings defaults;
+	Http2Settings settings;
+
+	settings.enabled = configuration.getValue<bool>("enabled", defaults.enabled);
+	settings.maxConcurrentStreams = getSetting(configuration, "max.concurrent.streams", defaults.maxConcurrentStreams, 1);
+	settings.initialWindowSize = getSetting(configuration, "initial.window.size", defaults.initialWindowSize, 0);
+	settings.maxFrameSize = getSetting(configuration, "max.frame.size", defaults.maxFrameSize, 0);
+	settings.headerTableSize = getSetting(configuration, "header.table.size", defaults.headerTableSize, 0);
+	settings.maxHeaderListSize = getSetting(configuration, "max.header.list.size", defaults.maxHeaderListSize, 0);
+	settings.maxStreamResetsPerSecond = getSetting(configuration, "max.stream.resets.per.second", defaults.maxStreamResetsPerSecond, 1);
+	settings.maxBufferedBodySize = getSetting(configuration, "max.buffered.body.size", (uint32_t) defaults.maxBufferedBodySize, 0);
+
+	settings.validate();
+	return settings;
+}
+
+void Http2Settings::validate() const {
+	validateRange("max.concurrent.streams", maxConcurrentStreams, 1, std::numeric_limits<uint32_t>::max());
+	validateRange("initial.window.size", initialWindowSize, 0, MaximumWindowSize);
+	validateRange("max.frame.size", maxFrameSize, MinimumFrameSize, MaximumFrameSize);
+	validateRange("header.table.size", headerTableSize, 0, std::numeric_limits<uint32_t>::max());
+	validateRange("max.header.list.size", maxHeaderListSize, 1024, std::numeric_limits<uint32_t>::max());
+	validateRange("max.stream.resets.per.second", maxStreamResetsPerSecond, 1, std::numeric_limits<uint32_t>::max());
+}
+
+} // namespace Balau::Network::Http
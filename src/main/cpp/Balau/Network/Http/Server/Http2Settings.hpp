@@ -0,0 +1,132 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file Http2Settings.hpp
+///
+/// HTTP/2 settings of the HTTP server.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SETTINGS
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SETTINGS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Balau {
+
+class EnvironmentProperties;
+
+namespace Network::Http {
+
+///
+/// HTTP/2 settings of the HTTP server.
+///
+/// When HTTP/2 is enabled, cleartext HTTP/2 (h2c) connections are accepted,
+/// either via prior knowledge (the client sends the HTTP/2 connection preface
+/// immediately) or via an HTTP/1.1 upgrade request.
+///
+/// The settings from max concurrent streams to max header list size are
+/// advertised to the client in the server's SETTINGS frame.
+///
+struct Http2Settings {
+	///
+	/// The smallest permitted maximum frame size.
+	///
+	static constexpr uint32_t MinimumFrameSize = 16384;
+
+	///
+	/// The largest permitted maximum frame size.
+	///
+	static constexpr uint32_t MaximumFrameSize = 16777215;
+
+	///
+	/// The largest permitted flow control window size.
+	///
+	static constexpr uint32_t MaximumWindowSize = 2147483647;
+
+	///
+	/// True if the server accepts HTTP/2 connections.
+	///
+	bool enabled = true;
+
+	///
+	/// The maximum number of concurrently open streams per connection.
+	///
+	/// Streams opened by the client in excess of this number are refused.
+	///
+	uint32_t maxConcurrentStreams = 100;
+
+	///
+	/// The initial flow control window size of each stream, for request bodies.
+	///
+	uint32_t initialWindowSize = 65535;
+
+	///
+	/// The largest frame payload that the server will accept.
+	///
+	uint32_t maxFrameSize = MinimumFrameSize;
+
+	///
+	/// The maximum size of the HPACK dynamic table used to decode request headers.
+	///
+	uint32_t headerTableSize = 4096;
+
+	///
+	/// The maximum size of the decoded request header list.
+	///
+	/// Requests with larger header lists are rejected with a 431 response.
+	///
+	uint32_t maxHeaderListSize = 65536;
+
+	///
+	/// The maximum number of streams that a client may reset per second on a connection.
+	///
+	/// Connections exceeding the limit are closed with a GOAWAY frame, in order
+	/// to defend against rapid reset attacks.
+	///
+	uint32_t maxStreamResetsPerSecond = 100;
+
+	///
+	/// The maximum size of request bodies that are not streamed to a request body handler.
+	///
+	size_t maxBufferedBodySize = 1024 * 1024;
+
+	///
+	/// Create settings from an http2 configuration composite.
+	///
+	/// Settings that are not present in the configuration take their default values.
+	///
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	static Http2Settings fromConfiguration(const EnvironmentProperties & configuration);
+
+	///
+	/// Validate the settings.
+	///
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	void validate() const;
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP2_SETTINGS
@@ -0,0 +1,360 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HttpAdmissionControl.hpp"
+#include "../../../Application/EnvironmentProperties.hpp"
+#include "../../../Util/Strings.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <regex>
+
+namespace Balau::Network::Http {
+
+namespace {
+
+void validateRange(const char * name, int64_t value, int64_t minimum, int64_t maximum) {
+	if (value < minimum || value > maximum) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("HTTP admission setting ", name, " = ", value, " is not in the range ", minimum, " to ", maximum, ".")
+		);
+	}
+}
+
+HttpAdmissionPriority parsePriority(const std::string & value) {
+	if (value == "critical") {
+		return HttpAdmissionPriority::Critical;
+	} else if (value == "normal") {
+		return HttpAdmissionPriority::Normal;
+	} else if (value == "low") {
+		return HttpAdmissionPriority::Low;
+	}
+
+	ThrowBalauException(
+		  Exception::IllegalArgumentException
+		, ::toString("HTTP admission setting priority = ", value, " is not one of critical, normal or low.")
+	);
+}
+
+bool matchesLocation(std::string_view path, std::string_view location) {
+	if (location.empty() || location == "/") {
+		return true;
+	}
+
+	if (path.length() < location.length() || path.substr(0, location.length()) != location) {
+		return false;
+	}
+
+	return path.length() == location.length() || location.back() == '/' || path[location.length()] == '/';
+}
+
+int64_t nowNanoseconds() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+void appendEscapedLabel(std::string & output, std::string_view value) {
+	for (const char c : value) {
+		switch (c) {
+			case '\\': output.append("\\\\"); break;
+			case '"':  output.append("\\\""); break;
+			case '\n': output.append("\\n");  break;
+			default:   output.push_back(c);   break;
+		}
+	}
+}
+
+void appendNumber(std::string & output, uint64_t value) {
+	char buffer[24];
+	const int length = std::snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long) value);
+	output.append(buffer, (size_t) length);
+}
+
+void appendNumber(std::string & output, int64_t value) {
+	char buffer[24];
+	const int length = std::snprintf(buffer, sizeof(buffer), "%lld", (long long) value);
+	output.append(buffer, (size_t) length);
+}
+
+void appendHeader(std::string & output, const char * name, const char * type, const char * help) {
+	output.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	output.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+template <typename ValueT>
+void appendRouteValue(std::string & output, const char * name, const std::string & route, ValueT value) {
+	output.append(name).append("{route=\"");
+	appendEscapedLabel(output, route);
+	output.append("\"} ");
+	appendNumber(output, value);
+	output.push_back('\n');
+}
+
+} // namespace
+
+HttpAdmissionSettings HttpAdmissionSettings::fromConfiguration(const EnvironmentProperties & configuration,
+                                                               const HttpAdmissionSettings & defaults) {
+	HttpAdmissionSettings settings = defaults;
+
+	settings.priority = parsePriority(configuration.getValue<std::string>("priority", toString(defaults.priority)));
+	settings.maxConcurrency = configuration.getValue<int>("max.concurrency", defaults.maxConcurrency);
+	settings.minConcurrency = configuration.getValue<int>("min.concurrency", defaults.minConcurrency);
+	settings.adaptive = configuration.getValue<bool>("adaptive", defaults.adaptive);
+	settings.targetDelay = std::chrono::milliseconds(configuration.getValue<int>("target.delay", (int) defaults.targetDelay.count()));
+	settings.interval = std::chrono::milliseconds(configuration.getValue<int>("interval", (int) defaults.interval.count()));
+	settings.lowPriorityShare = configuration.getValue<int>("low.priority.share", defaults.lowPriorityShare);
+
+	settings.validate();
+	return settings;
+}
+
+void HttpAdmissionSettings::validate() const {
+	validateRange("max.concurrency", maxConcurrency, 1, std::numeric_limits<int>::max());
+	validateRange("min.concurrency", minConcurrency, 1, maxConcurrency);
+	validateRange("target.delay", targetDelay.count(), 0, std::numeric_limits<int>::max());
+	validateRange("interval", interval.count(), 1, std::numeric_limits<int>::max());
+	validateRange("low.priority.share", lowPriorityShare, 0, 100);
+}
+
+HttpAdmissionControl::Route::Route(std::vector<std::string> locations_, const HttpAdmissionSettings & settings_)
+	: locations(std::move(locations_))
+	, settings(settings_)
+	, currentLimit(settings.maxConcurrency)
+	, intervalStart(nowNanoseconds())
+	, intervalMinimumDelay(std::numeric_limits<int64_t>::max()) {}
+
+std::string HttpAdmissionControl::Route::label() const {
+	if (locations.empty()) {
+		return "default";
+	}
+
+	std::string label = locations.front();
+
+	for (size_t m = 1; m < locations.size(); ++m) {
+		label.append(" ").append(locations[m]);
+	}
+
+	return label;
+}
+
+HttpAdmissionControl::HttpAdmissionControl()
+	: enabled(false)
+	, retryAfter(0) {
+	routes.emplace_back(std::make_unique<Route>(std::vector<std::string>(), HttpAdmissionSettings()));
+}
+
+HttpAdmissionControl::HttpAdmissionControl(const HttpAdmissionSettings & defaultSettings,
+                                           const std::vector<std::pair<std::string, HttpAdmissionSettings>> & routes_,
+                                           std::chrono::seconds retryAfter_)
+	: enabled(true)
+	, retryAfter(retryAfter_) {
+	// Blank delimited list of locations.
+	static const std::regex delimiter("[ \t]+");
+
+	validateRange("retry.after", retryAfter.count(), 0, std::numeric_limits<int>::max());
+	defaultSettings.validate();
+	routes.emplace_back(std::make_unique<Route>(std::vector<std::string>(), defaultSettings));
+
+	for (const auto & route : routes_) {
+		route.second.validate();
+
+		std::vector<std::string> locations;
+
+		for (const auto & location : Util::Strings::splitAndTrim(route.first, delimiter)) {
+			if (!location.empty()) {
+				locations.emplace_back(location);
+			}
+		}
+
+		routes.emplace_back(std::make_unique<Route>(std::move(locations), route.second));
+	}
+}
+
+std::shared_ptr<HttpAdmissionControl> HttpAdmissionControl::fromConfiguration(const EnvironmentProperties & configuration) {
+	auto admissionConfiguration = configuration.getCompositeOrNull("admission");
+
+	if (!admissionConfiguration || !admissionConfiguration->getValue<bool>("enabled", false)) {
+		return std::make_shared<HttpAdmissionControl>();
+	}
+
+	const auto defaultSettings = HttpAdmissionSettings::fromConfiguration(*admissionConfiguration, HttpAdmissionSettings());
+	const auto retryAfter = std::chrono::seconds(admissionConfiguration->getValue<int>("retry.after", 1));
+
+	std::vector<std::pair<std::string, HttpAdmissionSettings>> routes;
+	auto httpConfiguration = configuration.getCompositeOrNull("http");
+
+	if (httpConfiguration) {
+		for (const auto & webAppConfiguration : *httpConfiguration) {
+			if (!webAppConfiguration.isComposite()) {
+				continue;
+			}
+
+			auto config = webAppConfiguration.getComposite();
+
+			// Unconfigured web applications do not have a location.
+			if (!config->hasValue<std::string>("location")) {
+				continue;
+			}
+
+			auto webAppAdmissionConfiguration = config->getCompositeOrNull("admission");
+
+			routes.emplace_back(
+				  config->getValue<std::string>("location")
+				, webAppAdmissionConfiguration
+					? HttpAdmissionSettings::fromConfiguration(*webAppAdmissionConfiguration, defaultSettings)
+					: defaultSettings
+			);
+		}
+	}
+
+	return std::make_shared<HttpAdmissionControl>(defaultSettings, routes, retryAfter);
+}
+
+HttpAdmissionControl::Route & HttpAdmissionControl::resolve(std::string_view path) {
+	Route * bestRoute = routes.front().get();
+	size_t bestLength = 0;
+
+	for (size_t m = 1; m < routes.size(); ++m) {
+		for (const auto & location : routes[m]->locations) {
+			if (location.length() + 1 > bestLength && matchesLocation(path, location)) {
+				bestRoute = routes[m].get();
+				bestLength = location.length() + 1;
+			}
+		}
+	}
+
+	return *bestRoute;
+}
+
+bool HttpAdmissionControl::tryAcquire(Route & route) {
+	const int64_t previous = route.inFlightCount.fetch_add(1, std::memory_order_acquire);
+
+	if (route.settings.priority != HttpAdmissionPriority::Critical) {
+		int64_t threshold = route.currentLimit.load(std::memory_order_relaxed);
+
+		if (route.settings.priority == HttpAdmissionPriority::Low) {
+			threshold = threshold * route.settings.lowPriorityShare / 100;
+		}
+
+		if (previous >= threshold) {
+			route.inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+			route.shedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	route.admittedCount.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void HttpAdmissionControl::recordQueueingDelay(std::chrono::nanoseconds queueingDelay) {
+	if (!enabled) {
+		return;
+	}
+
+	for (auto & route : routes) {
+		if (route->settings.adaptive) {
+			adaptLimit(*route, queueingDelay);
+		}
+	}
+}
+
+void HttpAdmissionControl::writePrometheus(std::string & output) const {
+	if (!enabled) {
+		return;
+	}
+
+	appendHeader(
+		output, "balau_http_admission_limit", "gauge", "The current concurrency limit of the admission control route."
+	);
+
+	for (const auto & route : routes) {
+		appendRouteValue(output, "balau_http_admission_limit", route->label(), route->limit());
+	}
+
+	appendHeader(
+		output, "balau_http_admission_in_flight", "gauge", "The number of admitted HTTP requests in flight by admission control route."
+	);
+
+	for (const auto & route : routes) {
+		appendRouteValue(output, "balau_http_admission_in_flight", route->label(), route->inFlight());
+	}
+
+	appendHeader(
+		output, "balau_http_admission_admitted_total", "counter", "The number of admitted HTTP requests by admission control route."
+	);
+
+	for (const auto & route : routes) {
+		appendRouteValue(output, "balau_http_admission_admitted_total", route->label(), route->admitted());
+	}
+
+	appendHeader(
+		output, "balau_http_admission_shed_total", "counter", "The number of shed HTTP requests by admission control route."
+	);
+
+	for (const auto & route : routes) {
+		appendRouteValue(output, "balau_http_admission_shed_total", route->label(), route->shed());
+	}
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+void HttpAdmissionControl::adaptLimit(Route & route, std::chrono::nanoseconds queueingDelay) {
+	const int64_t delay = queueingDelay.count();
+	int64_t minimumDelay = route.intervalMinimumDelay.load(std::memory_order_relaxed);
+
+	while (delay < minimumDelay && !route.intervalMinimumDelay.compare_exchange_weak(minimumDelay, delay, std::memory_order_relaxed)) {
+		// Retry with the updated minimum.
+	}
+
+	const int64_t now = nowNanoseconds();
+	const int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(route.settings.interval).count();
+	int64_t start = route.intervalStart.load(std::memory_order_relaxed);
+
+	// The thread that succeeds in starting the next interval adapts the limit.
+	if (now - start < interval || !route.intervalStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+		return;
+	}
+
+	minimumDelay = route.intervalMinimumDelay.exchange(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+
+	if (minimumDelay == std::numeric_limits<int64_t>::max()) {
+		return;
+	}
+
+	const int64_t target = std::chrono::duration_cast<std::chrono::nanoseconds>(route.settings.targetDelay).count();
+	const int64_t limit = route.currentLimit.load(std::memory_order_relaxed);
+	int64_t newLimit;
+
+	if (minimumDelay > target) {
+		// A standing queue has formed.
+		const double gradient = std::max(0.5, (double) target / (double) minimumDelay);
+		newLimit = std::max((int64_t) route.settings.minConcurrency, (int64_t) ((double) limit * gradient));
+	} else {
+		const auto increment = std::max((int64_t) 1, (int64_t) std::sqrt((double) limit));
+		newLimit = std::min((int64_t) route.settings.maxConcurrency, limit + increment);
+	}
+
+	route.currentLimit.store(newLimit, std::memory_order_relaxed);
+}
+
+} // namespace Balau::Network::Http
@@ -0,0 +1,335 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file HttpAdmissionControl.hpp
+///
+/// Per-route request admission control and load shedding of an HTTP server.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_ADMISSION_CONTROL
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_ADMISSION_CONTROL
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Balau {
+
+class EnvironmentProperties;
+
+namespace Network::Http {
+
+///
+/// The admission priority of the requests of a route.
+///
+enum class HttpAdmissionPriority {
+	///
+	/// Requests are always admitted (for example health checks).
+	///
+	Critical
+
+	///
+	/// Requests are admitted whilst the route's concurrency is below its limit.
+	///
+	, Normal
+
+	///
+	/// Requests are admitted whilst the route's concurrency is below the low priority share of its limit.
+	///
+	, Low
+};
+
+///
+/// Print the admission priority as a UTF-8 string.
+///
+/// The strings are the values used in the priority configuration property.
+///
+/// @return a UTF-8 string representing the admission priority
+///
+inline std::string toString(HttpAdmissionPriority priority) {
+	switch (priority) {
+		case HttpAdmissionPriority::Critical: return "critical";
+		case HttpAdmissionPriority::Normal:   return "normal";
+		case HttpAdmissionPriority::Low:      return "low";
+		default: return "unknown";
+	}
+}
+
+///
+/// Admission control settings of an HTTP server route.
+///
+struct HttpAdmissionSettings {
+	///
+	/// The priority of the route's requests.
+	///
+	HttpAdmissionPriority priority = HttpAdmissionPriority::Normal;
+
+	///
+	/// The maximum number of concurrent requests of the route.
+	///
+	/// When the limit is adaptive, this is the initial and upper limit.
+	///
+	int maxConcurrency = 1000;
+
+	///
+	/// The lower bound of the adaptive concurrency limit.
+	///
+	int minConcurrency = 1;
+
+	///
+	/// True if the concurrency limit adapts to the queueing delay of the route's requests.
+	///
+	bool adaptive = true;
+
+	///
+	/// The queueing delay above which the concurrency limit is reduced.
+	///
+	std::chrono::milliseconds targetDelay { 5 };
+
+	///
+	/// The interval over which the minimum queueing delay is measured.
+	///
+	std::chrono::milliseconds interval { 100 };
+
+	///
+	/// The percentage of the concurrency limit available to low priority requests.
+	///
+	int lowPriorityShare = 50;
+
+	///
+	/// Create settings from an admission configuration composite.
+	///
+	/// Settings that are not present in the configuration are taken from the supplied defaults.
+	///
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	static HttpAdmissionSettings fromConfiguration(const EnvironmentProperties & configuration,
+	                                               const HttpAdmissionSettings & defaults);
+
+	///
+	/// Validate the settings.
+	///
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	void validate() const;
+};
+
+///
+/// Per-route request admission control and load shedding of an HTTP server.
+///
+/// Each route has a set of location prefixes, admission settings, a concurrency
+/// limit, and counters. A request uses the route with the longest location
+/// prefix that matches its path, or the default route if there is no match.
+///
+/// A request is admitted if the number of requests in flight on its route is
+/// below the route's limit, otherwise it is shed and the server immediately
+/// responds with 503 Service Unavailable and a Retry-After header. Critical
+/// routes are always admitted. Low priority routes are shed once a share of
+/// the limit is in use, leaving headroom for normal priority requests.
+///
+/// When a route's limit is adaptive, the limit is adjusted at the end of each
+/// interval from the minimum queueing delay observed during the interval, in
+/// the manner of CoDel. The queueing delay is sampled by the server, which
+/// periodically posts a timer to its I/O context and records how late the timer
+/// handler runs. This is the time that ready handlers (including the dispatch
+/// of read requests) wait for a worker thread, which grows as the worker threads
+/// become saturated. If the minimum delay exceeds the target, a standing queue
+/// has formed and the limit is reduced by the ratio of the target to the minimum
+/// delay (at most halving it). Otherwise, the limit is increased by the square
+/// root of the limit, up to the maximum concurrency.
+///
+/// Admission decisions and the counters are lock-free atomic operations. Routes
+/// are fixed at construction, thus route resolution is thread safe.
+///
+class HttpAdmissionControl final {
+	///
+	/// An admission control route.
+	///
+	public: class Route {
+		///
+		/// The location prefixes of the route (empty for the default route).
+		///
+		public: const std::vector<std::string> locations;
+
+		///
+		/// The admission settings of the route.
+		///
+		public: const HttpAdmissionSettings settings;
+
+		///
+		/// Get the current concurrency limit of the route.
+		///
+		public: int64_t limit() const {
+			return currentLimit.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the number of admitted requests of the route that are in flight.
+		///
+		public: int64_t inFlight() const {
+			return inFlightCount.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the number of admitted requests of the route.
+		///
+		public: uint64_t admitted() const {
+			return admittedCount.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the number of shed requests of the route.
+		///
+		public: uint64_t shed() const {
+			return shedCount.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the location prefixes of the route as a single space delimited label.
+		///
+		public: std::string label() const;
+
+		////////////////////////// Private implementation /////////////////////////
+
+		friend class HttpAdmissionControl;
+
+		public: Route(std::vector<std::string> locations_, const HttpAdmissionSettings & settings_);
+
+		private: std::atomic<int64_t> currentLimit;
+		private: std::atomic<int64_t> inFlightCount { 0 };
+		private: std::atomic<uint64_t> admittedCount { 0 };
+		private: std::atomic<uint64_t> shedCount { 0 };
+		private: std::atomic<int64_t> intervalStart;
+		private: std::atomic<int64_t> intervalMinimumDelay;
+	};
+
+	///
+	/// Create an admission control instance with admission control disabled.
+	///
+	public: HttpAdmissionControl();
+
+	///
+	/// Create an enabled admission control instance with the supplied default settings and routes.
+	///
+	/// @param defaultSettings the settings used for paths that do not match a route
+	/// @param routes pairs of space delimited location prefixes and route settings
+	/// @param retryAfter the Retry-After value sent in the responses of shed requests
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	public: HttpAdmissionControl(const HttpAdmissionSettings & defaultSettings,
+	                             const std::vector<std::pair<std::string, HttpAdmissionSettings>> & routes,
+	                             std::chrono::seconds retryAfter = std::chrono::seconds(1));
+
+	///
+	/// Create an admission control instance from the http.server configuration composite.
+	///
+	/// The instance is enabled if the enabled property of the admission composite
+	/// of the server is true. The default settings are taken from the admission
+	/// composite. The settings of each configured HTTP web application are taken
+	/// from the admission composite of the web application if present, with missing
+	/// values taken from the default settings. Each web application location is a
+	/// separate route.
+	///
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	public: static std::shared_ptr<HttpAdmissionControl> fromConfiguration(const EnvironmentProperties & configuration);
+
+	public: HttpAdmissionControl(const HttpAdmissionControl & ) = delete;
+	public: HttpAdmissionControl & operator = (const HttpAdmissionControl & ) = delete;
+
+	///
+	/// Returns true if admission control is enabled.
+	///
+	public: bool isEnabled() const {
+		return enabled;
+	}
+
+	///
+	/// Get the Retry-After value sent in the responses of shed requests.
+	///
+	public: std::chrono::seconds getRetryAfter() const {
+		return retryAfter;
+	}
+
+	///
+	/// Resolve the route for the supplied path.
+	///
+	public: Route & resolve(std::string_view path);
+
+	///
+	/// Attempt to admit a request to the supplied route.
+	///
+	/// Each successful call must be matched by a subsequent call to release.
+	///
+	/// @param route the route of the request
+	/// @return true if the request is admitted, false if it is to be shed
+	///
+	public: bool tryAcquire(Route & route);
+
+	///
+	/// Record a queueing delay sample, adapting the limits of the adaptive routes.
+	///
+	/// @param queueingDelay the time that a ready handler waited for a worker thread
+	///
+	public: void recordQueueingDelay(std::chrono::nanoseconds queueingDelay);
+
+	///
+	/// Release an admitted request of the supplied route.
+	///
+	public: void release(Route & route) {
+		route.inFlightCount.fetch_sub(1, std::memory_order_release);
+	}
+
+	///
+	/// Get the default route.
+	///
+	public: Route & defaultRoute() {
+		return *routes.front();
+	}
+
+	///
+	/// Get all the routes, starting with the default route.
+	///
+	public: const std::vector<std::unique_ptr<Route>> & getRoutes() const {
+		return routes;
+	}
+
+	///
+	/// Append the route counters and limits to the supplied string, in the Prometheus text exposition format.
+	///
+	public: void writePrometheus(std::string & output) const;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: void adaptLimit(Route & route, std::chrono::nanoseconds queueingDelay);
+
+	private: const bool enabled;
+	private: const std::chrono::seconds retryAfter;
+	private: std::vector<std::unique_ptr<Route>> routes;
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_ADMISSION_CONTROL
@@ -0,0 +1,104 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HttpHeaderCache.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace Balau::Network::Http {
+
+namespace {
+
+const char * const DayNames = "SunMonTueWedThuFriSat";
+const char * const MonthNames = "JanFebMarAprMayJunJulAugSepOctNovDec";
+const char * const ServerPrefix = "Server: ";
+const char * const DatePrefix = "\r\nDate: ";
+const char * const BlockSuffix = "\r\n";
+
+inline void writeTwoDigits(char * buffer, unsigned value) {
+	buffer[0] = (char) ('0' + value / 10);
+	buffer[1] = (char) ('0' + value % 10);
+}
+
+} // namespace
+
+HttpHeaderCache::HttpHeaderCache(std::shared_ptr<const System::Clock> clock_, std::string serverId_)
+	: clock(std::move(clock_))
+	, serverId(std::move(serverId_))
+	, dateOffset(std::strlen(ServerPrefix) + serverId.length() + std::strlen(DatePrefix))
+	, publishedIndex(0)
+	, publishedSecond(std::numeric_limits<int64_t>::min()) {
+	// Pre-build the header blocks. Only the date portion is rewritten during refreshes.
+	for (auto & slot : slots) {
+		slot.block.reserve(dateOffset + DateLength + std::strlen(BlockSuffix));
+		slot.block.append(ServerPrefix).append(serverId).append(DatePrefix);
+		slot.block.append(DateLength, ' ').append(BlockSuffix);
+	}
+
+	refresh(std::chrono::duration_cast<std::chrono::seconds>(clock->now().time_since_epoch()).count());
+}
+
+void HttpHeaderCache::formatImfFixdate(char * buffer, System::Clock::TimePoint timePoint) {
+	const auto days = Date::floor<Date::days>(timePoint);
+	const Date::year_month_day ymd(days);
+	const auto secondOfDay = (unsigned) std::chrono::duration_cast<std::chrono::seconds>(timePoint - days).count();
+
+	const auto weekday = (unsigned) Date::weekday(days);
+	const auto year = (unsigned) (int) ymd.year();
+
+	// Sun, 06 Nov 1994 08:49:37 GMT
+	std::memcpy(buffer, DayNames + weekday * 3, 3);
+	buffer[3] = ',';
+	buffer[4] = ' ';
+	writeTwoDigits(buffer + 5, (unsigned) ymd.day());
+	buffer[7] = ' ';
+	std::memcpy(buffer + 8, MonthNames + ((unsigned) ymd.month() - 1) * 3, 3);
+	buffer[11] = ' ';
+	writeTwoDigits(buffer + 12, (year / 100) % 100);
+	writeTwoDigits(buffer + 14, year % 100);
+	buffer[16] = ' ';
+	writeTwoDigits(buffer + 17, secondOfDay / 3600);
+	buffer[19] = ':';
+	writeTwoDigits(buffer + 20, (secondOfDay / 60) % 60);
+	buffer[22] = ':';
+	writeTwoDigits(buffer + 23, secondOfDay % 60);
+	std::memcpy(buffer + 25, " GMT", 4);
+}
+
+void HttpHeaderCache::refresh(int64_t second) {
+	// Only one thread refreshes. Other threads continue to use the previous slot.
+	if (refreshing.test_and_set(std::memory_order_acquire)) {
+		return;
+	}
+
+	if (publishedSecond.load(std::memory_order_relaxed) != second) {
+		const size_t nextIndex = (publishedIndex.load(std::memory_order_relaxed) + 1) % SlotCount;
+		Slot & slot = slots[nextIndex];
+
+		formatImfFixdate(&slot.block[dateOffset], System::Clock::TimePoint(std::chrono::seconds(second)));
+
+		publishedIndex.store(nextIndex, std::memory_order_release);
+		publishedSecond.store(second, std::memory_order_release);
+	}
+
+	refreshing.clear(std::memory_order_release);
+}
+
+} // namespace Balau::Network::Http
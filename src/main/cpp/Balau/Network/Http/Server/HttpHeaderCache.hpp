@@ -0,0 +1,154 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file HttpHeaderCache.hpp
+///
+/// Server wide cache of the headers that are common to all HTTP responses.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_HEADER_CACHE
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_HEADER_CACHE
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <Balau/System/Clock.hpp>
+
+#include <array>
+#include <atomic>
+
+namespace Balau::Network::Http {
+
+///
+/// Server wide cache of the headers that are common to all HTTP responses.
+///
+/// The cache holds the server identification string and the IMF-fixdate string
+/// used in the Date header. The date string is reformatted at most once per second
+/// by the first thread that observes a new second. Formatting is performed without
+/// locale-aware formatting or heap allocation, and the result is published to
+/// concurrent readers via an atomic slot index.
+///
+/// The cache also maintains a pre-built common header block in HTTP/1.1 wire
+/// format ("Server: ...\r\nDate: ...\r\n"). HTTP sessions write the block in
+/// place of the Server and Date fields when serialising HTTP/1 response headers.
+///
+/// Views returned from the cache refer to one of a ring of slots. A slot is only
+/// overwritten after SlotCount seconds have elapsed, so the views must be copied
+/// (as Beast does when a header field is set) rather than retained.
+///
+class HttpHeaderCache final {
+	///
+	/// The length of an IMF-fixdate string (e.g. "Sun, 06 Nov 1994 08:49:37 GMT").
+	///
+	public: static constexpr size_t DateLength = 29;
+
+	///
+	/// The number of slots in the publication ring.
+	///
+	public: static constexpr size_t SlotCount = 64;
+
+	///
+	/// Create a header cache that uses the supplied clock and server identification string.
+	///
+	/// @param clock_ the clock used to determine the current date
+	/// @param serverId_ the server identification string
+	///
+	public: HttpHeaderCache(std::shared_ptr<const System::Clock> clock_, std::string serverId_);
+
+	public: HttpHeaderCache(const HttpHeaderCache & ) = delete;
+	public: HttpHeaderCache & operator = (const HttpHeaderCache & ) = delete;
+
+	///
+	/// Get the server identification string.
+	///
+	public: std::string_view server() const {
+		return serverId;
+	}
+
+	///
+	/// Get the current date in IMF-fixdate format.
+	///
+	/// The returned view must be copied before the next SlotCount seconds have elapsed.
+	///
+	public: std::string_view date() {
+		const Slot & slot = currentSlot();
+		return std::string_view(slot.block.data() + dateOffset, DateLength);
+	}
+
+	///
+	/// Get the common header block in HTTP/1.1 wire format.
+	///
+	/// The returned view must be copied before the next SlotCount seconds have elapsed.
+	///
+	public: std::string_view commonHeaderBlock() {
+		const Slot & slot = currentSlot();
+		return std::string_view(slot.block.data(), slot.block.size());
+	}
+
+	///
+	/// Set the Server and Date headers in the supplied response.
+	///
+	public: template <typename BodyT> void setCommonHeaders(Response<BodyT> & response) {
+		const Slot & slot = currentSlot();
+		response.set(Field::server, serverId);
+		response.set(Field::date, boost::string_view(slot.block.data() + dateOffset, DateLength));
+	}
+
+	///
+	/// Format the time point as an IMF-fixdate string into the supplied buffer.
+	///
+	/// The buffer must be at least DateLength characters long. No terminating null
+	/// character is written.
+	///
+	/// @param buffer the destination buffer
+	/// @param timePoint the time point to format
+	///
+	public: static void formatImfFixdate(char * buffer, System::Clock::TimePoint timePoint);
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: struct Slot {
+		std::string block;
+	};
+
+	private: const Slot & currentSlot() {
+		const int64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+			clock->now().time_since_epoch()
+		).count();
+
+		if (publishedSecond.load(std::memory_order_acquire) != second) {
+			refresh(second);
+		}
+
+		return slots[publishedIndex.load(std::memory_order_acquire)];
+	}
+
+	private: void refresh(int64_t second);
+
+	private: const std::shared_ptr<const System::Clock> clock;
+	private: const std::string serverId;
+	private: const size_t dateOffset;
+	private: std::array<Slot, SlotCount> slots;
+	private: std::atomic<size_t> publishedIndex;
+	private: std::atomic<int64_t> publishedSecond;
+	private: std::atomic_flag refreshing = ATOMIC_FLAG_INIT;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_HEADER_CACHE
@@ -0,0 +1,353 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "HttpMetrics.hpp"
+
+#include <cstdio>
+
+namespace Balau::Network::Http {
+
+namespace {
+
+// Unique over the lifetime of the process, so that thread local shard caches
+// are never matched against a different metrics instance at the same address.
+std::atomic<uint64_t> nextMetricsId { 1 };
+
+struct LocalShardCache {
+	uint64_t id = 0;
+	void * shard = nullptr;
+};
+
+thread_local LocalShardCache localShardCache;
+
+void appendEscapedLabel(std::string & output, std::string_view value) {
+	for (const char c : value) {
+		switch (c) {
+			case '\\': output.append("\\\\"); break;
+			case '"':  output.append("\\\""); break;
+			case '\n': output.append("\\n");  break;
+			default:   output.push_back(c);   break;
+		}
+	}
+}
+
+void appendNumber(std::string & output, uint64_t value) {
+	char buffer[24];
+	const int length = std::snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long) value);
+	output.append(buffer, (size_t) length);
+}
+
+void appendNumber(std::string & output, int64_t value) {
+	char buffer[24];
+	const int length = std::snprintf(buffer, sizeof(buffer), "%lld", (long long) value);
+	output.append(buffer, (size_t) length);
+}
+
+void appendNumber(std::string & output, double value) {
+	char buffer[32];
+	const int length = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+	output.append(buffer, (size_t) length);
+}
+
+void appendHeader(std::string & output, const char * name, const char * type, const char * help) {
+	output.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	output.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void appendRouteLabel(std::string & output, const char * name, const std::string & route) {
+	output.append(name).append("{route=\"");
+	appendEscapedLabel(output, route);
+	output.push_back('"');
+}
+
+} // namespace
+
+const std::string HttpMetrics::UnmatchedRoute = "unmatched"; // NOLINT
+const std::string HttpMetrics::WebSocketRoute = "websocket"; // NOLINT
+
+uint64_t HttpMetrics::RouteSnapshot::requestCount() const {
+	uint64_t count = 0;
+
+	for (const auto & bucket : latencyBuckets) {
+		count += bucket;
+	}
+
+	return count;
+}
+
+const HttpMetrics::RouteSnapshot * HttpMetrics::Snapshot::find(std::string_view route) const {
+	for (const auto & routeSnapshot : routes) {
+		if (routeSnapshot.route == route) {
+			return &routeSnapshot;
+		}
+	}
+
+	return nullptr;
+}
+
+HttpMetrics::HttpMetrics() : id(nextMetricsId.fetch_add(1, std::memory_order_relaxed)) {}
+
+HttpMetrics::~HttpMetrics() = default;
+
+void HttpMetrics::requestStarted() {
+	add(localShard().inFlight, 1);
+}
+
+void HttpMetrics::requestCompleted(std::string_view route,
+                                   unsigned status,
+                                   size_t bytesIn,
+                                   size_t bytesOut,
+                                   std::chrono::nanoseconds latency) {
+	Shard & shard = localShard();
+	RouteShard & routeMetrics = routeShard(shard, route);
+
+	const size_t statusIndex = status >= MinimumStatus && status <= MaximumStatus ? status - MinimumStatus + 1 : 0;
+	add(routeMetrics.statusCounts[statusIndex], 1);
+	add(routeMetrics.bytesIn, bytesIn);
+	add(routeMetrics.bytesOut, bytesOut);
+
+	const auto nanoseconds = latency.count() < 0 ? 0 : (uint64_t) latency.count();
+	const double seconds = (double) nanoseconds / 1e9;
+	size_t bucket = 0;
+
+	while (bucket < LatencyBucketBounds.size() && seconds > LatencyBucketBounds[bucket]) {
+		++bucket;
+	}
+
+	add(routeMetrics.latencyBuckets[bucket], 1);
+	add(routeMetrics.latencySum, nanoseconds);
+	add(shard.inFlight, -1);
+}
+
+void HttpMetrics::requestAbandoned() {
+	add(localShard().inFlight, -1);
+}
+
+void HttpMetrics::tlsHandshakeCompleted(bool resumed) {
+	Shard & shard = localShard();
+	add(resumed ? shard.tlsResumedHandshakes : shard.tlsFullHandshakes, 1);
+}
+
+void HttpMetrics::tlsHandshakeFailed() {
+	add(localShard().tlsFailedHandshakes, 1);
+}
+
+HttpMetrics::Snapshot HttpMetrics::snapshot() const {
+	Snapshot snapshot;
+	std::map<std::string, RouteSnapshot, std::less<>> merged;
+
+	std::lock_guard<std::mutex> shardsLock(shardsMutex);
+
+	for (const auto & threadShard : shards) {
+		Shard & shard = *threadShard.second;
+		snapshot.inFlight += shard.inFlight.load(std::memory_order_relaxed);
+		snapshot.tlsFullHandshakes += shard.tlsFullHandshakes.load(std::memory_order_relaxed);
+		snapshot.tlsResumedHandshakes += shard.tlsResumedHandshakes.load(std::memory_order_relaxed);
+		snapshot.tlsFailedHandshakes += shard.tlsFailedHandshakes.load(std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> shardLock(shard.mutex);
+
+		for (const auto & route : shard.routes) {
+			const RouteShard & source = *route.second;
+			RouteSnapshot & destination = merged[route.first];
+
+			for (size_t m = 0; m < source.statusCounts.size(); ++m) {
+				const auto count = source.statusCounts[m].load(std::memory_order_relaxed);
+
+				if (count != 0) {
+					destination.statusCounts[m == 0 ? 0 : (unsigned) m + MinimumStatus - 1] += count;
+				}
+			}
+
+			destination.bytesIn += source.bytesIn.load(std::memory_order_relaxed);
+			destination.bytesOut += source.bytesOut.load(std::memory_order_relaxed);
+
+			for (size_t m = 0; m < LatencyBucketCount; ++m) {
+				destination.latencyBuckets[m] += source.latencyBuckets[m].load(std::memory_order_relaxed);
+			}
+
+			destination.latencySum += std::chrono::nanoseconds(source.latencySum.load(std::memory_order_relaxed));
+		}
+	}
+
+	snapshot.routes.reserve(merged.size());
+
+	for (auto & route : merged) {
+		route.second.route = route.first;
+		snapshot.routes.emplace_back(std::move(route.second));
+	}
+
+	return snapshot;
+}
+
+void HttpMetrics::writePrometheus(std::string & output) const {
+	const Snapshot metrics = snapshot();
+
+	appendHeader(
+		output, "balau_http_requests_in_flight", "gauge", "The number of HTTP requests currently being handled."
+	);
+
+	output.append("balau_http_requests_in_flight ");
+	appendNumber(output, metrics.inFlight);
+	output.push_back('\n');
+
+	appendHeader(
+		output, "balau_http_requests_total", "counter", "The number of completed HTTP requests by route and status."
+	);
+
+	for (const auto & route : metrics.routes) {
+		for (const auto & status : route.statusCounts) {
+			appendRouteLabel(output, "balau_http_requests_total", route.route);
+			output.append(",status=\"");
+			appendNumber(output, (uint64_t) status.first);
+			output.append("\"} ");
+			appendNumber(output, status.second);
+			output.push_back('\n');
+		}
+	}
+
+	appendHeader(
+		output, "balau_http_request_bytes_total", "counter", "The number of HTTP request bytes read by route."
+	);
+
+	for (const auto & route : metrics.routes) {
+		appendRouteLabel(output, "balau_http_request_bytes_total", route.route);
+		output.append("} ");
+		appendNumber(output, route.bytesIn);
+		output.push_back('\n');
+	}
+
+	appendHeader(
+		output, "balau_http_response_bytes_total", "counter", "The number of HTTP response bytes written by route."
+	);
+
+	for (const auto & route : metrics.routes) {
+		appendRouteLabel(output, "balau_http_response_bytes_total", route.route);
+		output.append("} ");
+		appendNumber(output, route.bytesOut);
+		output.push_back('\n');
+	}
+
+	appendHeader(
+		  output
+		, "balau_http_request_duration_seconds"
+		, "histogram"
+		, "The duration from the first byte of an HTTP request being read to the response being written."
+	);
+
+	for (const auto & route : metrics.routes) {
+		uint64_t cumulative = 0;
+
+		for (size_t m = 0; m < LatencyBucketCount; ++m) {
+			cumulative += route.latencyBuckets[m];
+			appendRouteLabel(output, "balau_http_request_duration_seconds_bucket", route.route);
+			output.append(",le=\"");
+
+			if (m < LatencyBucketBounds.size()) {
+				appendNumber(output, LatencyBucketBounds[m]);
+			} else {
+				output.append("+Inf");
+			}
+
+			output.append("\"} ");
+			appendNumber(output, cumulative);
+			output.push_back('\n');
+		}
+
+		appendRouteLabel(output, "balau_http_request_duration_seconds_sum", route.route);
+		output.append("} ");
+		appendNumber(output, (double) route.latencySum.count() / 1e9);
+		output.push_back('\n');
+
+		appendRouteLabel(output, "balau_http_request_duration_seconds_count", route.route);
+		output.append("} ");
+		appendNumber(output, cumulative);
+		output.push_back('\n');
+	}
+
+	appendHeader(
+		  output
+		, "balau_http_tls_handshakes_total"
+		, "counter"
+		, "The number of TLS handshakes by result (full, resumed or failed)."
+	);
+
+	const std::pair<const char *, uint64_t> handshakes[] = {
+		  { "full",    metrics.tlsFullHandshakes }
+		, { "resumed", metrics.tlsResumedHandshakes }
+		, { "failed",  metrics.tlsFailedHandshakes }
+	};
+
+	for (const auto & handshake : handshakes) {
+		output.append("balau_http_tls_handshakes_total{result=\"").append(handshake.first).append("\"} ");
+		appendNumber(output, handshake.second);
+		output.push_back('\n');
+	}
+}
+
+std::string HttpMetrics::toPrometheus() const {
+	std::string output;
+	writePrometheus(output);
+	return output;
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+HttpMetrics::Shard & HttpMetrics::localShard() {
+	if (localShardCache.id == id) {
+		return *static_cast<Shard *>(localShardCache.shard);
+	}
+
+	const auto threadId = std::this_thread::get_id();
+	Shard * shard = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(shardsMutex);
+
+		for (const auto & threadShard : shards) {
+			if (threadShard.first == threadId) {
+				shard = threadShard.second.get();
+				break;
+			}
+		}
+
+		if (shard == nullptr) {
+			shards.emplace_back(threadId, std::make_unique<Shard>());
+			shard = shards.back().second.get();
+		}
+	}
+
+	localShardCache.id = id;
+	localShardCache.shard = shard;
+	return *shard;
+}
+
+HttpMetrics::RouteShard & HttpMetrics::routeShard(Shard & shard, std::string_view route) {
+	// Only the owning thread inserts, so the lookup does not require the lock.
+	auto iter = shard.routes.find(route);
+
+	if (iter != shard.routes.end()) {
+		return *iter->second;
+	}
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return *shard.routes.emplace(std::string(route), std::make_unique<RouteShard>()).first->second;
+}
+
+} // namespace Balau::Network::Http
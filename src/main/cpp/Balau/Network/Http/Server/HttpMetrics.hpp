@@ -0,0 +1,288 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file HttpMetrics.hpp
+///
+/// Per-route request metrics and latency histograms of an HTTP server.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_METRICS
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_METRICS
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Balau::Network::Http {
+
+///
+/// Per-route request metrics and latency histograms of an HTTP server.
+///
+/// The metrics of each request are recorded against the label of the routing
+/// node that resolved the request, together with the response status. Requests
+/// that were not resolved to a routing node are recorded against the unmatched
+/// route label.
+///
+/// Recording is lock-free. Each thread that records requests owns a shard of
+/// the metrics and is the only writer of the shard's counters. The shards are
+/// merged when the metrics are read. A lock is only acquired when a thread
+/// records its first request, and when a thread records the first request for
+/// a route.
+///
+/// Latencies are recorded in a fixed bucket histogram, compatible with the
+/// Prometheus histogram type.
+///
+/// When the server terminates TLS, the outcomes of the TLS handshakes are also
+/// counted, from which the handshake rate and session resumption ratio can be
+/// derived.
+///
+class HttpMetrics final {
+	///
+	/// The upper bounds in seconds of the latency histogram buckets.
+	///
+	/// The histogram has an additional bucket for latencies greater than the last bound.
+	///
+	public: static constexpr std::array<double, 14> LatencyBucketBounds = {
+		0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+	};
+
+	///
+	/// The number of latency histogram buckets, including the overflow bucket.
+	///
+	public: static constexpr size_t LatencyBucketCount = LatencyBucketBounds.size() + 1;
+
+	///
+	/// The lowest response status that is counted.
+	///
+	public: static constexpr unsigned MinimumStatus = 100;
+
+	///
+	/// The highest response status that is counted.
+	///
+	/// Responses with status codes outside of the counted range are counted against status 0.
+	///
+	public: static constexpr unsigned MaximumStatus = 599;
+
+	///
+	/// The route label used for requests that were not resolved to a routing node.
+	///
+	public: static const std::string UnmatchedRoute;
+
+	///
+	/// The route label used for WebSocket upgrade requests.
+	///
+	public: static const std::string WebSocketRoute;
+
+	///
+	/// The merged metrics of a single route.
+	///
+	public: struct RouteSnapshot {
+		///
+		/// The route label.
+		///
+		std::string route;
+
+		///
+		/// The number of completed requests for each response status.
+		///
+		std::map<unsigned, uint64_t> statusCounts;
+
+		///
+		/// The number of request bytes read.
+		///
+		uint64_t bytesIn = 0;
+
+		///
+		/// The number of response bytes written.
+		///
+		uint64_t bytesOut = 0;
+
+		///
+		/// The (non-cumulative) latency histogram bucket counts.
+		///
+		std::array<uint64_t, LatencyBucketCount> latencyBuckets {};
+
+		///
+		/// The sum of the recorded latencies.
+		///
+		std::chrono::nanoseconds latencySum { 0 };
+
+		///
+		/// Get the number of completed requests.
+		///
+		uint64_t requestCount() const;
+	};
+
+	///
+	/// The merged metrics of the server.
+	///
+	public: struct Snapshot {
+		///
+		/// The number of requests that are currently being handled.
+		///
+		int64_t inFlight = 0;
+
+		///
+		/// The route metrics, sorted by route label.
+		///
+		std::vector<RouteSnapshot> routes;
+
+		///
+		/// The number of completed full TLS handshakes.
+		///
+		uint64_t tlsFullHandshakes = 0;
+
+		///
+		/// The number of completed TLS handshakes that resumed a previous session.
+		///
+		uint64_t tlsResumedHandshakes = 0;
+
+		///
+		/// The number of failed TLS handshakes.
+		///
+		uint64_t tlsFailedHandshakes = 0;
+
+		///
+		/// Get the route snapshot for the specified route label, or nullptr if no
+		/// requests have been recorded for the route.
+		///
+		const RouteSnapshot * find(std::string_view route) const;
+	};
+
+	///
+	/// Create an empty metrics instance.
+	///
+	public: HttpMetrics();
+
+	public: HttpMetrics(const HttpMetrics & ) = delete;
+	public: HttpMetrics & operator = (const HttpMetrics & ) = delete;
+
+	public: ~HttpMetrics();
+
+	///
+	/// Record the start of a request.
+	///
+	/// Each call must be matched by a subsequent call to requestCompleted or requestAbandoned.
+	///
+	public: void requestStarted();
+
+	///
+	/// Record the completion of a request.
+	///
+	/// @param route the route label
+	/// @param status the response status
+	/// @param bytesIn the number of request bytes read
+	/// @param bytesOut the number of response bytes written
+	/// @param latency the duration from the first byte of the request being read to the response write completion
+	///
+	public: void requestCompleted(std::string_view route,
+	                              unsigned status,
+	                              size_t bytesIn,
+	                              size_t bytesOut,
+	                              std::chrono::nanoseconds latency);
+
+	///
+	/// Record that a started request was abandoned without a response being written.
+	///
+	public: void requestAbandoned();
+
+	///
+	/// Record the completion of a TLS handshake.
+	///
+	/// @param resumed true if a previous session was resumed via the session cache or a session ticket
+	///
+	public: void tlsHandshakeCompleted(bool resumed);
+
+	///
+	/// Record the failure of a TLS handshake.
+	///
+	public: void tlsHandshakeFailed();
+
+	///
+	/// Merge the shards and return the current metrics.
+	///
+	public: Snapshot snapshot() const;
+
+	///
+	/// Append the current metrics to the supplied string, in the Prometheus text exposition format.
+	///
+	public: void writePrometheus(std::string & output) const;
+
+	///
+	/// Get the current metrics in the Prometheus text exposition format.
+	///
+	public: std::string toPrometheus() const;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// The counters of a route in a single shard. The counters are only written
+	// by the thread that owns the shard.
+	private: struct RouteShard {
+		std::array<std::atomic<uint64_t>, MaximumStatus - MinimumStatus + 2> statusCounts {};
+		std::atomic<uint64_t> bytesIn { 0 };
+		std::atomic<uint64_t> bytesOut { 0 };
+		std::array<std::atomic<uint64_t>, LatencyBucketCount> latencyBuckets {};
+		std::atomic<uint64_t> latencySum { 0 };
+	};
+
+	private: struct Shard {
+		// Inserts are performed by the owning thread and merges are performed
+		// by readers, both whilst holding the mutex. The owning thread performs
+		// lookups without locking.
+		std::map<std::string, std::unique_ptr<RouteShard>, std::less<>> routes;
+		std::mutex mutex;
+
+		// Incremented and decremented by the owning thread. As the request may
+		// complete on a different thread, the sum over the shards is the gauge value.
+		std::atomic<int64_t> inFlight { 0 };
+
+		// TLS handshake outcome counters, written by the owning thread.
+		std::atomic<uint64_t> tlsFullHandshakes { 0 };
+		std::atomic<uint64_t> tlsResumedHandshakes { 0 };
+		std::atomic<uint64_t> tlsFailedHandshakes { 0 };
+	};
+
+	private: Shard & localShard();
+	private: RouteShard & routeShard(Shard & shard, std::string_view route);
+
+	// Single writer increment.
+	private: static void add(std::atomic<uint64_t> & counter, uint64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	private: static void add(std::atomic<int64_t> & counter, int64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	private: const uint64_t id;
+	private: std::vector<std::pair<std::thread::id, std::unique_ptr<Shard>>> shards;
+	private: mutable std::mutex shardsMutex;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_METRICS
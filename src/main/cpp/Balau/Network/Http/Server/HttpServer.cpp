@@ -18,12 +18,15 @@
 //
 
 #include "HttpServer.hpp"
+#include "Balau/Network/Http/Server/HttpWebApps/CachingHttpWebApp.hpp"
 #include "Balau/Network/Http/Server/HttpWebApps/EmailSendingHttpWebApp.hpp"
 #include "Balau/Network/Http/Server/HttpWebApps/FileServingHttpWebApp.hpp"
+#include "Balau/Network/Http/Server/HttpWebApps/MetricsHttpWebApp.hpp"
 #include "Balau/Network/Http/Server/HttpWebApps/RedirectingHttpWebApp.hpp"
 #include "HttpWebApps/RoutingHttpWebApp.hpp"
 #include "Impl/HttpWebAppFactory.hpp"
 #include "Impl/Listener.hpp"
+#include "Impl/SocketHandoff.hpp"
 #include "WsWebApps/NullWsWebApp.hpp"
 #include "../../Utilities/MimeTypes.hpp"
 #include "../../../System/ThreadName.hpp"
@@ -32,6 +35,8 @@
 
 #include <boost/bind.hpp>
 
+#include <unistd.h>
+
 // For built in web app initialiser.
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
@@ -43,6 +48,7 @@ struct HttpServerRegisterBuiltInWeApps {
 	HttpServerRegisterBuiltInWeApps() {
 		Impl::HttpWebAppFactory::registerHttpWebApp<HttpWebApps::FileServingHttpWebApp>("files");
 		Impl::HttpWebAppFactory::registerHttpWebApp<HttpWebApps::RedirectingHttpWebApp>("redirections");
+		Impl::HttpWebAppFactory::registerHttpWebApp<HttpWebApps::MetricsHttpWebApp>("metrics");
 		#ifdef BALAU_ENABLE_CURL
 		Impl::HttpWebAppFactory::registerHttpWebApp<HttpWebApps::EmailSendingHttpWebApp>("email.sender");
 		#endif // BALAU_ENABLE_CURL
@@ -56,13 +62,14 @@ HttpServerRegisterBuiltInWeApps httpServerRegisterBuiltInWeApps; // NOLINT
 HttpServer::HttpServer(std::shared_ptr<System::Clock> clock,
                        const std::shared_ptr<EnvironmentProperties>& configuration,
                        bool registerSignalHandler)
-	: state(createState(std::move(clock), configuration))
+	: publisher(std::make_shared<Impl::ConfigurationPublisher>(createState(std::move(clock), configuration)))
 	, threadNamePrefix(configuration->getValue<std::string>("thread.name.prefix", ""))
 	, workerCount((size_t) configuration->getValue<int>("worker.count", 1))
 	, launched(new std::atomic_uint { 0U })
 	, ioContext(new boost::asio::io_context(configuration->getValue<int>("worker.count", 1)))
 	, mutex(new std::mutex)
-	, signalSet(new boost::asio::signal_set(*ioContext)) {
+	, signalSet(new boost::asio::signal_set(*ioContext))
+	, drainTimeout(configuration->getValue<int>("drain.timeout", 0)) {
 	if (registerSignalHandler) {
 		doRegisterSignalHandler();
 	}
@@ -78,17 +85,27 @@ HttpServer::HttpServer(std::shared_ptr<System::Clock> clock,
                        const std::string & loggingNamespace,
                        std::string sessionCookieName,
                        std::shared_ptr<MimeTypes> mimeTypes,
-                       bool registerSignalHandler)
-	: state(
-		std::make_shared<HttpServerConfiguration>(
-			  std::move(clock)
-			, BalauLogger(loggingNamespace)
-			, serverId
-			, endpoint
-			, sessionCookieName
-			, std::move(httpHandler)
-			, std::move(wsHandler)
-			, std::move(mimeTypes)
+                       bool registerSignalHandler,
+                       std::shared_ptr<WsCompression> wsCompression,
+                       Http2Settings http2,
+                       TlsSettings tls,
+                       std::shared_ptr<HttpAdmissionControl> admission)
+	: publisher(
+		std::make_shared<Impl::ConfigurationPublisher>(
+			std::make_shared<HttpServerConfiguration>(
+				  std::move(clock)
+				, BalauLogger(loggingNamespace)
+				, serverId
+				, endpoint
+				, sessionCookieName
+				, std::move(httpHandler)
+				, std::move(wsHandler)
+				, std::move(mimeTypes)
+				, std::move(wsCompression)
+				, http2
+				, std::move(tls)
+				, std::move(admission)
+			)
 		)
 	)
 	, threadNamePrefix(std::move(threadNamePrefix_))
@@ -96,7 +113,8 @@ HttpServer::HttpServer(std::shared_ptr<System::Clock> clock,
 	, launched(new std::atomic_uint { 0U })
 	, ioContext(new boost::asio::io_context((int) workerCount))
 	, mutex(new std::mutex)
-	, signalSet(new boost::asio::signal_set(*ioContext)) {
+	, signalSet(new boost::asio::signal_set(*ioContext))
+	, drainTimeout(0) {
 	if (registerSignalHandler) {
 		doRegisterSignalHandler();
 	}
@@ -128,13 +146,23 @@ HttpServer::HttpServer(std::shared_ptr<System::Clock> clock,
 	) {}
 
 HttpServer::~HttpServer() {
+	if (reloadTask.valid()) {
+		reloadTask.wait();
+	}
+
 	stop();
+
+	// A received listening socket that was never used by a listener.
+	if (inheritedSocket >= 0) {
+		::close(inheritedSocket);
+	}
 }
 
 ///////////////////////////////// Public API //////////////////////////////////
 
 void HttpServer::startAsync() {
 	std::unique_lock<std::mutex> lock(*mutex);
+	const auto state = publisher->current();
 
 	if (!workers.empty()) {
 		BalauBalauLogWarn(state->logger, "HTTP server {}:{} already running", state->endpoint.address(), state->endpoint.port());
@@ -151,6 +179,7 @@ void HttpServer::startAsync() {
 	workers.emplace_back(
 		[this] {
 			launchListener();
+			startLagProbe();
 			workerThreadFunction(0);
 		}
 	);
@@ -172,18 +201,22 @@ void HttpServer::startAsync() {
 
 void HttpServer::startSync() {
 	std::unique_lock<std::mutex> lock(*mutex);
+	// Copied in order to avoid pinning the initial configuration whilst the server is running.
+	const auto logger = publisher->current()->logger;
+	const auto endpoint = publisher->current()->endpoint;
 
 	if (!workers.empty()) {
-		BalauBalauLogWarn(state->logger, "HTTP server {}:{} already running", state->endpoint.address(), state->endpoint.port());
+		BalauBalauLogWarn(logger, "HTTP server {}:{} already running", endpoint.address(), endpoint.port());
 		return;
 	}
 
-	BalauBalauLogInfo(state->logger, "Starting HTTP server {}:{}", state->endpoint.address(), state->endpoint.port());
+	BalauBalauLogInfo(logger, "Starting HTTP server {}:{}", endpoint.address(), endpoint.port());
 
 	ioContext->restart();
 
 	// This thread will be one of the IO context threads.
 	launchListener();
+	startLagProbe();
 
 	workers.reserve(workerCount - 1);
 	launched->store(0U);
@@ -209,6 +242,7 @@ bool HttpServer::isRunning() {
 
 void HttpServer::stop(bool warn) {
 	std::lock_guard<std::mutex> lock(*mutex);
+	const auto state = publisher->current();
 
 	if (workers.empty()) {
 		if (warn) {
@@ -234,10 +268,121 @@ void HttpServer::stop(bool warn) {
 	}
 
 	workers.clear();
+	lagProbe.reset();
 
 	BalauBalauLogInfo(state->logger, "HTTP server {}:{} stopped", state->endpoint.address(), state->endpoint.port());
 }
 
+void HttpServer::drain(std::chrono::milliseconds timeout) {
+	std::shared_ptr<Impl::Listener> drainingListener;
+
+	{
+		std::lock_guard<std::mutex> lock(*mutex);
+		const auto state = publisher->current();
+
+		if (workers.empty()) {
+			return;
+		}
+
+		// A closed listener has no work remaining in the IO context to perform the drain.
+		if (!listener->isClosed()) {
+			BalauBalauLogInfo(
+				  state->logger
+				, "Draining HTTP server {}:{} with a timeout of {}ms"
+				, state->endpoint.address()
+				, state->endpoint.port()
+				, timeout.count()
+			);
+
+			drainingListener = listener;
+			drainingListener->drain(timeout);
+		}
+	}
+
+	while (drainingListener && !drainingListener->isClosed()) {
+		System::Sleep::milliSleep(10);
+	}
+
+	stop();
+}
+
+void HttpServer::handOff(const std::string & path, std::chrono::milliseconds timeout) {
+	{
+		std::lock_guard<std::mutex> lock(*mutex);
+		const auto state = publisher->current();
+
+		if (workers.empty() || listener->isClosed()) {
+			ThrowBalauException(
+				  Exception::NetworkException
+				, ::toString("HTTP server ", state->endpoint.address(), ":", state->endpoint.port(), " is not running.")
+			);
+		}
+
+		Impl::sendListeningSocket(path, listener->nativeHandle());
+
+		BalauBalauLogInfo(
+			  state->logger
+			, "HTTP server {}:{} listening socket handed off via {}"
+			, state->endpoint.address()
+			, state->endpoint.port()
+			, path
+		);
+	}
+
+	drain(timeout);
+}
+
+void HttpServer::receiveListeningSocket(const std::string & path, std::chrono::milliseconds timeout) {
+	std::lock_guard<std::mutex> lock(*mutex);
+	const auto state = publisher->current();
+
+	if (!workers.empty()) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("HTTP server ", state->endpoint.address(), ":", state->endpoint.port(), " is already running.")
+		);
+	}
+
+	if (inheritedSocket >= 0) {
+		::close(inheritedSocket);
+	}
+
+	inheritedSocket = Impl::receiveListeningSocket(path, timeout);
+
+	BalauBalauLogInfo(
+		  state->logger
+		, "HTTP server {}:{} received listening socket via {}"
+		, state->endpoint.address()
+		, state->endpoint.port()
+		, path
+	);
+}
+
+void HttpServer::reload(const std::shared_ptr<EnvironmentProperties> & configuration) {
+	const auto generation = publisher->update(
+		[&configuration] (const std::shared_ptr<HttpServerConfiguration> & current) {
+			BalauLogger logger = current->logger;
+			auto mimeTypes = createMimeTypes(configuration, logger);
+			auto httpHandler = createHttpHandler(configuration, logger);
+			auto wsHandler = createWsHandler(configuration, logger);
+
+			return std::make_shared<HttpServerConfiguration>(
+				*current, configuration, std::move(httpHandler), std::move(wsHandler), std::move(mimeTypes)
+			);
+		}
+	);
+
+	const auto state = publisher->current();
+
+	BalauBalauLogInfo(
+		  state->logger
+		, "HTTP server {}:{} configuration reloaded (generation {})"
+		, state->endpoint.address()
+		, state->endpoint.port()
+		, generation
+	);
+}
+
 std::shared_ptr<HttpServerConfiguration> HttpServer::createState(std::shared_ptr<System::Clock> clock,
                                                                  const std::shared_ptr<EnvironmentProperties> & configuration) {
 	// Root logging configuration
@@ -254,9 +399,27 @@ std::shared_ptr<HttpServerConfiguration> HttpServer::createState(std::shared_ptr
 	auto mimeTypes = createMimeTypes(configuration, logger);
 	std::shared_ptr<HttpWebApp> httpHandler = createHttpHandler(configuration, logger);
 	std::shared_ptr<WsWebApp> wsHandler = createWsHandler(configuration, logger);
+	auto wsCompression = createWsCompression(configuration, logger);
+	auto http2Configuration = configuration->getCompositeOrNull("http2");
+	auto http2 = http2Configuration ? Http2Settings::fromConfiguration(*http2Configuration) : Http2Settings();
+	auto tlsConfiguration = configuration->getCompositeOrNull("tls");
+	auto tls = tlsConfiguration ? TlsSettings::fromConfiguration(*tlsConfiguration) : TlsSettings();
+	auto admission = HttpAdmissionControl::fromConfiguration(*configuration);
 
 	return std::make_shared<HttpServerConfiguration>(
-		clock, logger, serverId, endpoint, sessionCookieName, httpHandler, wsHandler, mimeTypes
+		  clock
+		, logger
+		, serverId
+		, endpoint
+		, sessionCookieName
+		, httpHandler
+		, wsHandler
+		, mimeTypes
+		, wsCompression
+		, http2
+		, std::move(tls)
+		, std::move(admission)
+		, configuration
 	);
 }
 
@@ -315,7 +478,15 @@ std::shared_ptr<HttpWebApp> HttpServer::createHttpHandler(const std::shared_ptr<
 			}
 
 			auto location = config->getValue<std::string>("location");
-			auto webApp = Impl::HttpWebAppFactory::getInstance(name, *config, logger);
+			std::shared_ptr<HttpWebApp> webApp = Impl::HttpWebAppFactory::getInstance(name, *config, logger);
+			auto cacheConfiguration = config->getCompositeOrNull("cache");
+
+			if (cacheConfiguration && cacheConfiguration->getValue<bool>("enabled", false)) {
+				webApp = std::make_shared<HttpWebApps::CachingHttpWebApp>(
+					std::move(webApp), HttpWebApps::CachingHttpWebApp::Settings::fromConfiguration(*cacheConfiguration)
+				);
+			}
+
 			addToHttpRoutingTrie(routing, location, webApp);
 		} else {
 			BalauBalauLogWarn(
@@ -368,6 +539,32 @@ std::shared_ptr<WsWebApp> HttpServer::createWsHandler(const std::shared_ptr<Envi
 	return std::shared_ptr<WsWebApp>(new WsWebApps::NullWsWebApp());
 }
 
+std::shared_ptr<WsCompression> HttpServer::createWsCompression(const std::shared_ptr<EnvironmentProperties> & configuration,
+                                                               BalauLogger & logger) {
+	auto wsConfiguration = configuration->getCompositeOrNull("ws");
+
+	if (!wsConfiguration) {
+		return std::make_shared<WsCompression>();
+	}
+
+	auto wsCompression = WsCompression::fromConfiguration(*wsConfiguration);
+
+	if (!WsDeflateSettings::minMessageSizeSupported()) {
+		for (const auto & route : wsCompression->getRoutes()) {
+			if (route->settings.enabled && route->settings.minMessageSize > 0) {
+				BalauBalauLogWarn(
+					  logger
+					, "The WebSocket deflate min.message.size setting is not supported by this version of Boost Beast and will be ignored."
+				);
+
+				break;
+			}
+		}
+	}
+
+	return wsCompression;
+}
+
 void HttpServer::addToHttpRoutingTrie(HttpWebApps::RoutingHttpWebApp::Routing & routing,
                                       const std::string & locationStr,
                                       std::shared_ptr<HttpWebApp> & webApp) {
@@ -410,7 +607,10 @@ void HttpServer::addToHttpRoutingTrie(HttpWebApps::RoutingHttpWebApp::Routing &
 }
 
 void HttpServer::launchListener() {
-	listener = std::make_unique<Impl::Listener>(state, *ioContext);
+	// The inherited socket is owned by the listener's acceptor from here on.
+	listener = std::make_unique<Impl::Listener>(publisher, *ioContext, inheritedSocket);
+	inheritedSocket = -1;
+	const auto state = publisher->current();
 
 	if (!listener->isOpen()) {
 		ThrowBalauException(
@@ -422,26 +622,60 @@ void HttpServer::launchListener() {
 	listener->doAccept();
 }
 
+void HttpServer::startLagProbe() {
+	// The admission control is shared by all configuration generations.
+	if (!publisher->current()->admission->isEnabled()) {
+		return;
+	}
+
+	lagProbe = std::make_unique<boost::asio::steady_timer>(*ioContext);
+	armLagProbe();
+}
+
+void HttpServer::armLagProbe() {
+	static constexpr std::chrono::milliseconds LagProbeInterval { 10 };
+
+	lagProbe->expires_after(LagProbeInterval);
+
+	lagProbe->async_wait(
+		[this] (const boost::system::error_code & error) {
+			if (error) {
+				return;
+			}
+
+			// The time the expired timer's handler waited for a worker thread.
+			const auto queueingDelay = std::chrono::steady_clock::now() - lagProbe->expiry();
+			publisher->current()->admission->recordQueueingDelay(queueingDelay);
+			armLagProbe();
+		}
+	);
+}
+
 void HttpServer::workerThreadFunction(size_t workerIndex) {
+	// The logger and endpoint are not reloadable. Copies are used in order to avoid
+	// pinning the initial configuration generation whilst the server is running.
+	const auto logger = publisher->current()->logger;
+	const auto endpoint = publisher->current()->endpoint;
+
 	if (!threadNamePrefix.empty()) {
 		System::ThreadName::setName(threadNamePrefix + "-" + ::toString(workerIndex));
 	}
 
 	BalauBalauLogInfo(
-		  state->logger
+		  logger
 		, "Starting HTTP server {}:{} worker {}"
-		, state->endpoint.address()
-		, state->endpoint.port()
+		, endpoint.address()
+		, endpoint.port()
 		, workerIndex
 	);
 
 	// Log started message if this is the last worker thread.
 	if (workerIndex == workerCount - 1) {
 		BalauBalauLogInfo(
-			  state->logger
+			  logger
 			, "HTTP server {}:{} started with {} workers"
-			, state->endpoint.address()
-			, state->endpoint.port()
+			, endpoint.address()
+			, endpoint.port()
 			, workerCount
 		);
 	}
@@ -454,29 +688,29 @@ void HttpServer::workerThreadFunction(size_t workerIndex) {
 			break;
 		} catch (const std::exception & e) {
 			BalauBalauLogError(
-				  state->logger
+				  logger
 				, "Exception encountered in HTTP server {}:{} worker {}: {}. Restarting worker."
-				, state->endpoint.address()
-				, state->endpoint.port()
+				, endpoint.address()
+				, endpoint.port()
 				, workerIndex
 				, e.what()
 			);
 		} catch (...) {
 			BalauBalauLogError(
-				  state->logger
+				  logger
 				, "Unknown exception encountered in HTTP server {}:{} worker {}. Restarting worker."
-				, state->endpoint.address()
-				, state->endpoint.port()
+				, endpoint.address()
+				, endpoint.port()
 				, workerIndex
 			);
 		}
 	}
 
 	BalauBalauLogInfo(
-		  state->logger
+		  logger
 		, "Stopped HTTP server {}:{} worker {}"
-		, state->endpoint.address()
-		, state->endpoint.port()
+		, endpoint.address()
+		, endpoint.port()
 		, workerIndex
 	);
 }
@@ -489,11 +723,23 @@ void HttpServer::doRegisterSignalHandler() {
 		signalSet->add(SIGQUIT);
 	#endif
 
+	#if defined(SIGHUP)
+		signalSet->add(SIGHUP);
+	#endif
+
 	signalSet->async_wait(boost::bind(&HttpServer::handleSignal, this, _1, _2));
 }
 
 void HttpServer::handleSignal(const boost::system::error_code & error, int sig) {
 	switch (sig) {
+		#if defined(SIGHUP)
+		case SIGHUP: {
+			reloadFromSource();
+			signalSet->async_wait(boost::bind(&HttpServer::handleSignal, this, _1, _2));
+			return;
+		}
+		#endif
+
 		case SIGINT: {
 			write(STDERR_FILENO, "Shutting down HTTP server due to signal SIGINT.\n", 48);
 			break;
@@ -517,7 +763,71 @@ void HttpServer::handleSignal(const boost::system::error_code & error, int sig)
 		}
 	}
 
-	listener->close();
+	if (drainTimeout.count() > 0) {
+		listener->drain(drainTimeout);
+	} else {
+		listener->close();
+	}
+}
+
+void HttpServer::reloadFromSource() {
+	const auto state = publisher->current();
+
+	if (!reloadSource) {
+		BalauBalauLogWarn(
+			  state->logger
+			, "HTTP server {}:{} ignored SIGHUP as no reload source is set. Set a reload source in order to enable reloading."
+			, state->endpoint.address()
+			, state->endpoint.port()
+		);
+
+		return;
+	}
+
+	if (reloadTask.valid() && reloadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		BalauBalauLogWarn(
+			  state->logger
+			, "HTTP server {}:{} ignored SIGHUP as a reload is already in progress."
+			, state->endpoint.address()
+			, state->endpoint.port()
+		);
+
+		return;
+	}
+
+	write(STDERR_FILENO, "Reloading HTTP server configuration due to signal SIGHUP.\n", 58);
+
+	// The configuration source and the creation of the web applications may be slow,
+	// thus the reload runs on its own thread instead of blocking an I/O thread.
+	reloadTask = std::async(
+		  std::launch::async
+		, [this, state] () {
+			try {
+				auto configuration = reloadSource();
+
+				if (!configuration) {
+					BalauBalauLogWarn(
+						  state->logger
+						, "HTTP server {}:{} reload source supplied no configuration. The current configuration remains active."
+						, state->endpoint.address()
+						, state->endpoint.port()
+					);
+
+					return;
+				}
+
+				reload(configuration);
+			} catch (const std::exception & e) {
+				BalauBalauLogError(
+					  state->logger
+					, "HTTP server {}:{} configuration reload failed: {}. The current configuration remains active."
+					, state->endpoint.address()
+					, state->endpoint.port()
+					, e.what()
+				);
+			}
+		}
+	);
 }
 
 } // namespace Balau::Network::Http
@@ -27,6 +27,7 @@
 #define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_SERVER
 
 #include <Balau/Network/Http/Server/HttpServerConfiguration.hpp>
+#include <Balau/Network/Http/Server/Impl/ConfigurationPublisher.hpp>
 #include <Balau/Network/Http/Server/HttpWebApps/RoutingHttpWebApp.hpp>
 #include <Balau/Network/Http/Server/WsWebApps/RoutingWsWebApp.hpp>
 #include <Balau/Resource/File.hpp>
@@ -34,8 +35,12 @@
 #include <Balau/Application/Injectable.hpp>
 
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 
+#include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <thread>
 
@@ -75,6 +80,17 @@ class Listener;
 /// or sigaction(), these handlers will be overridden. In order to avoid this,
 /// use Boost Asio signal sets for all signal handler registrations in the application.
 ///
+/// When a drain timeout is configured, the signal handlers drain the server instead
+/// of closing all connections immediately. The server may also be drained via drain(),
+/// and the listening socket may be handed off to a successor process via handOff()
+/// in order to restart the server without refusing connections.
+///
+/// The web applications and mime types of the server may be reloaded from an updated
+/// environment configuration without restarting the server, either by calling reload()
+/// or by sending SIGHUP to the process when the signal handler and a reload source are
+/// registered. The new configuration is built off the request path and published atomically.
+/// Requests that are in progress complete with the previous configuration.
+///
 /// The HTTP server and web application framework supports the use of injectors.
 /// The server shared state that is supplied to the web application handlers contains
 /// a shared pointer to an injector. If an injector is supplied to the constructor
@@ -135,6 +151,10 @@ class HttpServer {
 	/// @param sessionCookieName the name of the cookie in which the session id is stored (default = "session")
 	/// @param mimeTypes the mime type map to use
 	/// @param registerSignalHandler (default = true) set to false in order to prevent signal handler installation
+	/// @param wsCompression the WebSocket compression settings (default = compression disabled)
+	/// @param http2 the HTTP/2 settings (default = HTTP/2 enabled with the default settings)
+	/// @param tls the TLS settings (default = TLS disabled)
+	/// @param admission the request admission control (default = admission control disabled)
 	///
 	public: HttpServer(std::shared_ptr<System::Clock> clock,
 	                   const std::string & serverIdentification,
@@ -146,7 +166,11 @@ class HttpServer {
 	                   const std::string & loggingNamespace = "balau.network.server",
 	                   std::string sessionCookieName = "session",
 	                   std::shared_ptr<MimeTypes> mimeTypes = MimeTypes::defaultMimeTypes,
-	                   bool registerSignalHandler = true);
+	                   bool registerSignalHandler = true,
+	                   std::shared_ptr<WsCompression> wsCompression = std::shared_ptr<WsCompression>(nullptr),
+	                   Http2Settings http2 = Http2Settings(),
+	                   TlsSettings tls = TlsSettings(),
+	                   std::shared_ptr<HttpAdmissionControl> admission = std::shared_ptr<HttpAdmissionControl>(nullptr));
 
 	///
 	/// Create an HTTP server using the file serving HTTP handler.
@@ -222,25 +246,145 @@ class HttpServer {
 	///
 	public: void stop(bool warn = false);
 
+	///
+	/// Gracefully shut down the HTTP server.
+	///
+	/// The listener stops accepting connections. Idle keep-alive connections are
+	/// closed immediately and HTTP/2 connections are sent a GOAWAY frame. Requests
+	/// that are in flight are completed with a "Connection: close" response. Once
+	/// all connections have closed or the timeout has expired, the remaining
+	/// connections are closed and the server is stopped.
+	///
+	/// This call blocks until the server has stopped. If the server is already
+	/// stopped, this call is a NOP.
+	///
+	/// @param timeout the maximum time to wait for in-flight requests to complete
+	///
+	public: void drain(std::chrono::milliseconds timeout);
+
+	///
+	/// Hand the listening socket off to a successor process and then drain the server.
+	///
+	/// The successor process must be waiting for the socket via receiveListeningSocket
+	/// on the same Unix domain socket path. The listening socket remains open in the
+	/// successor, thus no connection attempts are refused during the handoff.
+	///
+	/// @param path the path of the Unix domain socket the successor is waiting on
+	/// @param timeout the maximum time to wait for in-flight requests to complete
+	/// @throw NetworkException if the server is not running or the socket could not be sent
+	///
+	public: void handOff(const std::string & path, std::chrono::milliseconds timeout);
+
+	///
+	/// Wait for the listening socket to be handed off by a predecessor process.
+	///
+	/// The received socket is used by the listener instead of binding to the
+	/// configured endpoint. The listening endpoint of both processes must be
+	/// the same. The socket is only accepted from a process running as the
+	/// same user as this process.
+	///
+	/// This method must be called before the server is started.
+	///
+	/// @param path the path of the Unix domain socket to wait on
+	/// @param timeout the maximum time to wait for the predecessor process
+	/// @throw NetworkException if no socket was received before the timeout expired
+	///
+	public: void receiveListeningSocket(const std::string & path, std::chrono::milliseconds timeout);
+
+	///
+	/// Set the drain timeout used when the server is shut down via a signal.
+	///
+	/// When the timeout is zero (the default), the server closes all connections
+	/// immediately on SIGINT, SIGTERM and SIGQUIT. Otherwise, the server is drained.
+	///
+	/// This method must be called before the server is started.
+	///
+	/// @param timeout the maximum time to wait for in-flight requests to complete
+	///
+	public: void setDrainTimeout(std::chrono::milliseconds timeout) {
+		drainTimeout = timeout;
+	}
+
+	///
+	/// Reload the web applications and mime types of the server from the supplied configuration.
+	///
+	/// The new routing trie, web application instances and mime type map are created
+	/// on the calling thread and then published atomically. New requests are handled
+	/// with the new configuration, whilst requests that are in progress complete with
+	/// the previous configuration.
+	///
+	/// The listening endpoint, logging, session cookie, WebSocket compression, HTTP/2,
+	/// TLS and admission control settings are not reloadable. Changes to these are ignored.
+	///
+	/// This method may be called whether or not the server is running.
+	///
+	/// @param configuration the new HTTP server environment configuration
+	/// @throw NetworkException if the new configuration is invalid (the current configuration remains active)
+	///
+	public: void reload(const std::shared_ptr<EnvironmentProperties> & configuration);
+
+	///
+	/// Set the function that supplies the configuration when a reload is triggered by SIGHUP.
+	///
+	/// The function would typically parse the application's environment configuration
+	/// files again. The function and the creation of the new web applications run on a
+	/// separate thread, so that the I/O threads continue to handle requests during the
+	/// reload. A SIGHUP that is received whilst a reload is in progress is ignored.
+	///
+	/// If no function is set, SIGHUP does not reload the server and a warning is logged.
+	///
+	/// This method must be called before the server is started.
+	///
+	/// @param source the function that supplies the reloaded configuration
+	///
+	public: void setReloadSource(std::function<std::shared_ptr<EnvironmentProperties> ()> source) {
+		reloadSource = std::move(source);
+	}
+
 	///
 	/// Get the address being listened on.
 	///
 	public: std::string getAddress() const {
-		return toString(state->endpoint.address());
+		return toString(publisher->current()->endpoint.address());
 	}
 
 	///
 	/// Get the port being listened on.
 	///
 	public: unsigned short getPort() const {
-		return state->endpoint.port();
+		return publisher->current()->endpoint.port();
+	}
+
+	///
+	/// Get the WebSocket compression settings and the per-route compression metrics.
+	///
+	public: const WsCompression & getWsCompression() const {
+		// The compression settings are shared by all configuration generations.
+		return *publisher->current()->wsCompression;
+	}
+
+	///
+	/// Get the request admission control of the server, including the per-route limits and counters.
+	///
+	public: const HttpAdmissionControl & getAdmissionControl() const {
+		// The admission control is shared by all configuration generations.
+		return *publisher->current()->admission;
+	}
+
+	///
+	/// Get the per-route request metrics of the server.
+	///
+	public: const HttpMetrics & getMetrics() const {
+		// The metrics are shared by all configuration generations.
+		return *publisher->current()->metrics;
 	}
 
 	////////////////////////// Private implementation /////////////////////////
 
 	// Used for injection for compilers without guaranteed copy elision.
 	private: HttpServer(HttpServer && rhs) noexcept
-		: state(std::move(rhs.state))
+		: publisher(std::move(rhs.publisher))
+		, reloadSource(std::move(rhs.reloadSource))
 		, threadNamePrefix(rhs.threadNamePrefix)
 		, workerCount(rhs.workerCount)
 		, workers(std::move(rhs.workers))
@@ -248,7 +392,13 @@ class HttpServer {
 		, listener(std::move(rhs.listener))
 		, ioContext(std::move(rhs.ioContext))
 		, mutex(std::move(rhs.mutex))
-		, signalSet(std::move(rhs.signalSet)) {}
+		, signalSet(std::move(rhs.signalSet))
+		, lagProbe(std::move(rhs.lagProbe))
+		, reloadTask(std::move(rhs.reloadTask))
+		, drainTimeout(rhs.drainTimeout)
+		, inheritedSocket(rhs.inheritedSocket) {
+		rhs.inheritedSocket = -1;
+	}
 
 	//
 	// Create the HTTP server configuration object.
@@ -277,6 +427,12 @@ class HttpServer {
 	private: static std::shared_ptr<WsWebApp> createWsHandler(const std::shared_ptr<EnvironmentProperties> & configuration,
 	                                                          BalauLogger & logger);
 
+	//
+	// Create the WebSocket compression settings from the environment configuration.
+	//
+	private: static std::shared_ptr<WsCompression> createWsCompression(const std::shared_ptr<EnvironmentProperties> & configuration,
+	                                                                   BalauLogger & logger);
+
 	//
 	// Helper function that adds the HTTP web application to the supplied routing
 	// trie in the location(s) specified in the location string.
@@ -289,11 +445,15 @@ class HttpServer {
 	                                          std::shared_ptr<HttpWebApp> & webApp);
 
 	private: void launchListener();
+	private: void startLagProbe();
+	private: void armLagProbe();
 	private: void workerThreadFunction(size_t workerIndex);
 	private: void doRegisterSignalHandler();
 	private: void handleSignal(const boost::system::error_code & error, int sig);
+	private: void reloadFromSource();
 
-	private: std::shared_ptr<HttpServerConfiguration> state;
+	private: std::shared_ptr<Impl::ConfigurationPublisher> publisher;
+	private: std::function<std::shared_ptr<EnvironmentProperties> ()> reloadSource;
 	private: const std::string threadNamePrefix;
 	private: const size_t workerCount;
 	private: std::vector<std::thread> workers;
@@ -302,6 +462,10 @@ class HttpServer {
 	private: std::unique_ptr<boost::asio::io_context> ioContext;
 	private: std::unique_ptr<std::mutex> mutex;
 	private: std::unique_ptr<boost::asio::signal_set> signalSet;
+	private: std::unique_ptr<boost::asio::steady_timer> lagProbe; // Samples the queueing delay for admission control.
+	private: std::future<void> reloadTask; // The SIGHUP triggered reload, which runs off the I/O threads.
+	private: std::chrono::milliseconds drainTimeout;
+	private: int inheritedSocket = -1; // Set when a listening socket has been received from a predecessor.
 };
 
 } // namespace Network::Http
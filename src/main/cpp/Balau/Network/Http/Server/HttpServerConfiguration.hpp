@@ -27,6 +27,13 @@
 #define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__HTTP_SERVER_CONFIGURATION
 
 #include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <Balau/Network/Http/Server/HttpAdmissionControl.hpp>
+#include <Balau/Network/Http/Server/HttpHeaderCache.hpp>
+#include <Balau/Network/Http/Server/HttpMetrics.hpp>
+#include <Balau/Network/Http/Server/Http2Settings.hpp>
+#include <Balau/Network/Http/Server/TlsSettings.hpp>
+#include <Balau/Network/Http/Server/WsCompression.hpp>
+#include <Balau/Network/Http/Server/Impl/TlsContext.hpp>
 #include <Balau/Network/Utilities/MimeTypes.hpp>
 #include <Balau/Application/Impl/BindingKey.hpp>
 #include <Balau/Network/Utilities/BalauLogger.hpp>
@@ -99,6 +106,41 @@ struct HttpServerConfiguration {
 	///
 	const std::shared_ptr<MimeTypes> mimeTypes;
 
+	///
+	/// The WebSocket permessage-deflate settings and compression metrics.
+	///
+	const std::shared_ptr<WsCompression> wsCompression;
+
+	///
+	/// The per-route request metrics of the server.
+	///
+	const std::shared_ptr<HttpMetrics> metrics;
+
+	///
+	/// The per-route request admission control of the server.
+	///
+	const std::shared_ptr<HttpAdmissionControl> admission;
+
+	///
+	/// The HTTP/2 settings of the server.
+	///
+	const Http2Settings http2;
+
+	///
+	/// The TLS settings of the server.
+	///
+	const TlsSettings tls;
+
+	///
+	/// The TLS context shared by the connections, or null if TLS is not enabled.
+	///
+	const std::shared_ptr<SSL::context> tlsContext;
+
+	///
+	/// The cache of the headers that are common to all responses.
+	///
+	HttpHeaderCache headerCache;
+
 	///////////////////////// Private implementation //////////////////////////
 
 	HttpServerConfiguration(std::shared_ptr<const System::Clock> clock_,
@@ -108,15 +150,57 @@ struct HttpServerConfiguration {
 	                        std::string sessionCookieName_,
 	                        std::shared_ptr<HttpWebApp> httpHandler_,
 	                        std::shared_ptr<WsWebApp> wsHandler_,
-	                        std::shared_ptr<MimeTypes> mimeTypes_)
+	                        std::shared_ptr<MimeTypes> mimeTypes_,
+	                        std::shared_ptr<WsCompression> wsCompression_ = std::make_shared<WsCompression>(),
+	                        Http2Settings http2_ = Http2Settings(),
+	                        TlsSettings tls_ = TlsSettings(),
+	                        std::shared_ptr<HttpAdmissionControl> admission_ = std::make_shared<HttpAdmissionControl>(),
+	                        std::shared_ptr<EnvironmentProperties> configuration_ = nullptr)
 		: clock(std::move(clock_))
+		, configuration(std::move(configuration_))
 		, logger(logger_)
 		, serverId(std::move(serverIdentification_))
 		, endpoint(std::move(endpoint_))
 		, sessionCookieName(std::move(sessionCookieName_))
 		, httpHandler(std::move(httpHandler_))
 		, wsHandler(std::move(wsHandler_))
-		, mimeTypes(std::move(mimeTypes_)) {}
+		, mimeTypes(std::move(mimeTypes_))
+		, wsCompression(wsCompression_ ? std::move(wsCompression_) : std::make_shared<WsCompression>())
+		, metrics(std::make_shared<HttpMetrics>())
+		, admission(admission_ ? std::move(admission_) : std::make_shared<HttpAdmissionControl>())
+		, http2(http2_)
+		, tls(std::move(tls_))
+		, tlsContext(tls.enabled ? Impl::createTlsContext(tls, http2.enabled) : nullptr)
+		, headerCache(clock, serverId) {}
+
+	//
+	// Create a reloaded configuration from the previous configuration.
+	//
+	// The environment configuration, web applications and mime types are replaced.
+	// The listening, compression, HTTP/2, TLS and admission control settings and
+	// the metrics are not reloadable and are shared with the previous configuration.
+	//
+	HttpServerConfiguration(const HttpServerConfiguration & previous,
+	                        std::shared_ptr<EnvironmentProperties> configuration_,
+	                        std::shared_ptr<HttpWebApp> httpHandler_,
+	                        std::shared_ptr<WsWebApp> wsHandler_,
+	                        std::shared_ptr<MimeTypes> mimeTypes_)
+		: clock(previous.clock)
+		, configuration(std::move(configuration_))
+		, logger(previous.logger)
+		, serverId(previous.serverId)
+		, endpoint(previous.endpoint)
+		, sessionCookieName(previous.sessionCookieName)
+		, httpHandler(std::move(httpHandler_))
+		, wsHandler(std::move(wsHandler_))
+		, mimeTypes(std::move(mimeTypes_))
+		, wsCompression(previous.wsCompression)
+		, metrics(previous.metrics)
+		, admission(previous.admission)
+		, http2(previous.http2)
+		, tls(previous.tls)
+		, tlsContext(previous.tlsContext)
+		, headerCache(clock, serverId) {}
 };
 
 } // namespace Network::Http
@@ -17,34 +17,215 @@
 // limitations under the License.
 //
 
+#include "Http2Session.hpp"
 #include "Impl/ClientSessions.hpp"
+#include "Impl/ConfigurationPublisher.hpp"
 #include "Impl/HttpSessions.hpp"
+#include "Impl/TlsContext.hpp"
+#include "../../Utilities/Impl/DelimiterScanner.hpp"
 #include "../../../Logging/Logger.hpp"
 
 namespace Balau::Network::Http {
 
+namespace {
+
+bool isLegalTarget(boost::string_view target) {
+	return !target.empty() && target[0] == '/' && target.find("..") == boost::string_view::npos;
+}
+
+// The first line of the HTTP/2 connection preface is parsed as a request with the PRI method.
+bool isHttp2Preface(const HttpServerConfiguration & configuration, const HTTP::request<EmptyBody> & request) {
+	return configuration.http2.enabled
+		&& request.method() == Method::unknown
+		&& request.method_string() == "PRI"
+		&& request.target() == "*"
+		&& request.version() == 20;
+}
+
+// Determine whether the request is an h2c upgrade request and decode its HTTP2-Settings header.
+bool isHttp2Upgrade(const HttpServerConfiguration & configuration, const StringRequest & request, std::string & settingsPayload) {
+	if (!configuration.http2.enabled || request.version() != 11) {
+		return false;
+	}
+
+	const auto settings = request.find("HTTP2-Settings");
+
+	if (settings == request.end()) {
+		return false;
+	}
+
+	for (const auto & token : HTTP::token_list(request[Field::upgrade])) {
+		if (boost::beast::iequals(token, "h2c")) {
+			const auto value = settings->value();
+			return Http2Session::decodeSettingsHeader(std::string_view(value.data(), value.length()), settingsPayload);
+		}
+	}
+
+	return false;
+}
+
+} // namespace
+
+HttpSession::HttpSession(Impl::HttpSessions & httpSessions_,
+                         Impl::ClientSessions & clientSessions_,
+                         std::shared_ptr<Impl::ConfigurationPublisher> publisher_,
+                         Impl::HttpSocket && socket_)
+	: httpSessions(httpSessions_)
+	, clientSessions(clientSessions_)
+	, publisher(std::move(publisher_))
+	, configurationGeneration(std::numeric_limits<uint64_t>::max())
+	, strand(socket_.get_executor())
+	, socket(std::move(socket_))
+	, cookies(CookieMap::allocator_type(arena)) {
+	// Obtains the configuration and its generation atomically.
+	publisher->refresh(serverConfiguration, configurationGeneration);
+}
+
 HttpSession::HttpSession(Impl::HttpSessions & httpSessions_,
                          Impl::ClientSessions & clientSessions_,
                          std::shared_ptr<HttpServerConfiguration> serverConfiguration_,
-                         TCP::socket && socket_)
+                         boost::asio::strand<boost::asio::io_context::executor_type> connectionStrand,
+                         Address remoteAddress_,
+                         std::weak_ptr<Impl::Http2ResponseSink> http2Sink_,
+                         uint32_t http2StreamId_)
 	: httpSessions(httpSessions_)
 	, clientSessions(clientSessions_)
 	, serverConfiguration(std::move(serverConfiguration_))
-	, strand(socket_.get_executor())
-	, socket(std::move(socket_)) {
+	, strand(std::move(connectionStrand))
+	, socket(strand.get_inner_executor().context()) // Not opened.
+	, cookies(CookieMap::allocator_type(arena))
+	, remoteAddress(std::move(remoteAddress_))
+	, http2Sink(std::move(http2Sink_))
+	, http2StreamId(http2StreamId_) {
+}
+
+HttpSession::~HttpSession() {
+	releaseResponseCapture();
+	releaseAdmission();
+}
+
+void HttpSession::start() {
+	if (!socket.isTls()) {
+		doRead();
+		return;
+	}
+
+	socket.asyncHandshake(
+		boost::asio::bind_executor(
+			  strand
+			, std::bind(&HttpSession::onHandshake, shared_from_this(), std::placeholders::_1)
+		)
+	);
 }
 
 void HttpSession::doRead() {
+	// Pick up a reloaded configuration between requests.
+	publisher->refresh(serverConfiguration, configurationGeneration);
+
+	releaseResponseCapture();
+
+	// Release the previous request's scratch data and reuse the arena.
+	cookies.clear();
+	cachedResponse = nullptr;
+	arena.reset();
+
 	request = {};
+	clientSession.reset();
+	metricsRoute = &HttpMetrics::UnmatchedRoute;
+	requestBytesIn = 0;
+	responseStatus = 0;
 
-	HTTP::async_read(
+	if (isDraining() && buffer.size() == 0) {
+		// The server is draining and there is no pipelined request to handle.
+		doClose();
+		return;
+	}
+
+	if (buffer.size() != 0) {
+		// The start of a pipelined request has already been read.
+		requestStart = std::chrono::steady_clock::now();
+		doReadHeader();
+		return;
+	}
+
+	if (socket.isTls()) {
+		// Decrypted data may already be held by the TLS stream, thus the socket
+		// cannot be waited on. The latency measurement starts when the header
+		// has been read instead.
+		doReadHeader();
+		return;
+	}
+
+	if (hasUnreadData()) {
+		// The next request has already arrived, thus it is read without waiting for readiness first.
+		requestStart = std::chrono::steady_clock::now();
+		doReadHeader();
+		return;
+	}
+
+	// The connection is idle. Wait for the first byte of the request, in order to
+	// start the latency measurement when the request arrives rather than when the
+	// previous response was written.
+	socket.tcpSocket().async_wait(
+		  TCP::socket::wait_read
+		, boost::asio::bind_executor(
+			  strand
+			, std::bind(&HttpSession::onFirstByte, shared_from_this(), std::placeholders::_1)
+		)
+	);
+}
+
+void HttpSession::close() {
+	strand.post(std::bind(&HttpSession::doClose, this), allocator);
+}
+
+void HttpSession::drain() {
+	strand.post(std::bind(&HttpSession::doDrain, shared_from_this()), allocator);
+}
+
+void HttpSession::onHandshake(boost::system::error_code errorCode) {
+	auto & metrics = *serverConfiguration->metrics;
+
+	if (errorCode) {
+		metrics.tlsHandshakeFailed();
+
+		BalauBalauLogDebug(serverConfiguration->logger, "HttpSession TLS handshake failed: {}", errorCode.message());
+
+		doClose();
+		return;
+	}
+
+	auto & stream = socket.tlsStream();
+	metrics.tlsHandshakeCompleted(SSL_session_reused(stream.native_handle()) == 1);
+
+	if (serverConfiguration->http2.enabled && Impl::alpnProtocol(stream) == Impl::AlpnHttp2) {
+		// The HTTP/2 session takes over the connection.
+		std::make_shared<Http2Session>(shared_from_this())->startNegotiated();
+		return;
+	}
+
+	doRead();
+}
+
+void HttpSession::onFirstByte(boost::system::error_code errorCode) {
+	// Errors are reported by the header read.
+	boost::ignore_unused(errorCode);
+	requestStart = std::chrono::steady_clock::now();
+	doReadHeader();
+}
+
+void HttpSession::doReadHeader() {
+	// The header is read first, in order to determine whether the body is to be streamed.
+	headerParser.emplace();
+
+	HTTP::async_read_header(
 		  socket
 		, buffer
-		, request
+		, *headerParser
 		, boost::asio::bind_executor(
 			  strand
 			, std::bind(
-				  &HttpSession::onRead
+				  &HttpSession::onReadHeader
 				, shared_from_this()
 				, std::placeholders::_1
 				, std::placeholders::_2
@@ -53,23 +234,87 @@ void HttpSession::doRead() {
 	);
 }
 
-void HttpSession::close() {
-	strand.post(std::bind(&HttpSession::doClose, this), allocator);
+void HttpSession::onReadHeader(boost::system::error_code errorCode, std::size_t bytesTransferred) {
+	if (!errorCode && isHttp2Preface(*serverConfiguration, headerParser->get())) {
+		// The HTTP/2 session takes over the connection.
+		headerParser.reset();
+		std::make_shared<Http2Session>(shared_from_this())->startWithPriorKnowledge();
+		return;
+	}
+
+	if (!errorCode) {
+		if (socket.isTls()) {
+			requestStart = std::chrono::steady_clock::now();
+		}
+
+		requestBytesIn += bytesTransferred;
+		requestInFlight = true;
+		serverConfiguration->metrics->requestStarted();
+	}
+
+	if (!errorCode && headerParser->get().method() == Method::post && startStreamedBody()) {
+		return;
+	}
+
+	// Read the body into the request and handle the request as a whole.
+	bodyParser.emplace(std::move(*headerParser));
+	headerParser.reset();
+
+	if (errorCode) {
+		onRead(errorCode, bytesTransferred);
+		return;
+	}
+
+	HTTP::async_read(
+		  socket
+		, buffer
+		, *bodyParser
+		, boost::asio::bind_executor(
+			  strand
+			, std::bind(
+				  &HttpSession::onRead
+				, shared_from_this()
+				, std::placeholders::_1
+				, std::placeholders::_2
+			)
+		)
+	);
 }
 
 void HttpSession::onRead(boost::system::error_code errorCode, std::size_t bytesTransferred) {
-	boost::ignore_unused(bytesTransferred);
+	if (!errorCode) {
+		requestBytesIn += bytesTransferred;
+	}
+
+	request = bodyParser->release();
+	bodyParser.reset();
 
 	parseCookies();
 
+	// The client session may already have been set when the body streaming decision was made.
+	if (!clientSession && !errorCode) {
+		setClientSession();
+	}
+
 	if (!validateRequest(errorCode, request)) {
 		return;
 	}
 
-	setClientSession();
+	// Check for h2c upgrade.
+	std::string http2SettingsPayload;
+
+	if (isHttp2Upgrade(*serverConfiguration, request, http2SettingsPayload)) {
+		upgradeToHttp2(std::move(http2SettingsPayload));
+		return;
+	}
 
 	// Check for WebSocket upgrade.
 	if (WS::is_upgrade(request)) {
+		// The handshake response is written by the WebSocket session.
+		metricsRoute = &HttpMetrics::WebSocketRoute;
+		responseStatus = static_cast<unsigned>(Status::switching_protocols);
+		completeRequestMetrics(0);
+
 		// ASIO states that following the socket move, the moved-from socket is in the same
 		// state as if constructed using basic_stream_socket<tcp>(io_context &) constructor.
 		std::make_shared<WsSession>(
@@ -84,18 +329,205 @@ void HttpSession::onRead(boost::system::error_code errorCode, std::size_t bytesT
 	}
 }
 
+bool HttpSession::startStreamedBody() {
+	request = StringRequest(headerParser->get().base());
+
+	// Invalid and upgrade requests are handled via the buffered path.
+	if (!isLegalTarget(request.target()) || WS::is_upgrade(request)) {
+		return false;
+	}
+
+	parseCookies();
+	setClientSession();
+
+	if (!acquireAdmission()) {
+		// The request is shed without reading its body, so the connection cannot be reused.
+		headerParser.reset();
+
+		auto response = HttpWebApp::createServiceUnavailableResponse(
+			*this, request, serverConfiguration->admission->getRetryAfter()
+		);
+
+		response.keep_alive(false);
+		sendResponse(std::move(response));
+		return true;
+	}
+
+	bodyVariables.clear();
+
+	try {
+		bodyHandler = serverConfiguration->httpHandler->createPostBodyHandler(*this, request, bodyVariables);
+	} catch (const std::exception & e) {
+		BalauBalauLogError(serverConfiguration->logger, "Exception thrown during request: {}", e);
+		abortStreamedBody();
+		return true;
+	} catch (...) {
+		BalauBalauLogError(serverConfiguration->logger, "Unknown exception thrown during request: {}");
+		abortStreamedBody();
+		return true;
+	}
+
+	if (!bodyHandler) {
+		return false;
+	}
+
+	const auto bodyLimit = bodyHandler->maxBodySize();
+	const auto contentLength = headerParser->content_length();
+	streamedBodySize = 0;
+
+	// A body that is declared to be too large is rejected before it is read.
+	if (contentLength && *contentLength > bodyLimit) {
+		rejectOversizeBody();
+		return true;
+	}
+
+	chunkParser.emplace(std::move(*headerParser));
+	headerParser.reset();
+	chunkParser->body_limit(bodyLimit);
+
+	if (!chunkBuffer) {
+		chunkBuffer.reset(new char[RequestBodyChunkSize]);
+	}
+
+	doReadBodyChunk();
+	return true;
+}
+
+void HttpSession::doReadBodyChunk() {
+	auto & body = chunkParser->get().body();
+	body.data = chunkBuffer.get();
+	body.size = RequestBodyChunkSize;
+
+	HTTP::async_read(
+		  socket
+		, buffer
+		, *chunkParser
+		, boost::asio::bind_executor(
+			  strand
+			, std::bind(
+				  &HttpSession::onReadBodyChunk
+				, shared_from_this()
+				, std::placeholders::_1
+				, std::placeholders::_2
+			)
+		)
+	);
+}
+
+void HttpSession::onReadBodyChunk(boost::system::error_code errorCode, std::size_t bytesTransferred) {
+	requestBytesIn += bytesTransferred;
+
+	if (errorCode == Error::need_buffer) {
+		// The chunk buffer is full.
+		errorCode = {};
+	} else if (errorCode == Error::body_limit) {
+		rejectOversizeBody();
+		return;
+	}
+
+	if (errorCode) {
+		BalauBalauLogWarn(serverConfiguration->logger, "HttpSession request body error: {}", errorCode);
+		bodyHandler.reset();
+		chunkParser.reset();
+		doClose();
+		return;
+	}
+
+	const size_t chunkSize = RequestBodyChunkSize - chunkParser->get().body().size;
+	const bool done = chunkParser->is_done();
+
+	if (chunkSize != 0 && !deliverBodyChunk(std::string_view(chunkBuffer.get(), chunkSize))) {
+		return;
+	}
+
+	if (!done) {
+		doReadBodyChunk();
+		return;
+	}
+
+	chunkParser.reset();
+	completeStreamedBody();
+}
+
+bool HttpSession::deliverBodyChunk(std::string_view chunk) {
+	if (!bodyHandler) {
+		return false;
+	}
+
+	// HTTP/1 bodies are also limited by the parser, HTTP/2 bodies only here.
+	streamedBodySize += chunk.length();
+
+	if (streamedBodySize > bodyHandler->maxBodySize()) {
+		rejectOversizeBody();
+		return false;
+	}
+
+	try {
+		bodyHandler->onBodyChunk(chunk);
+	} catch (const std::exception & e) {
+		BalauBalauLogError(serverConfiguration->logger, "Exception thrown during request: {}", e);
+		abortStreamedBody();
+		return false;
+	} catch (...) {
+		BalauBalauLogError(serverConfiguration->logger, "Unknown exception thrown during request: {}");
+		abortStreamedBody();
+		return false;
+	}
+
+	return true;
+}
+
+void HttpSession::completeStreamedBody() {
+	if (!bodyHandler) {
+		return;
+	}
+
+	auto handler = std::move(bodyHandler);
+
+	try {
+		handler->onBodyComplete(*this, request, bodyVariables);
+	} catch (const std::exception & e) {
+		BalauBalauLogError(serverConfiguration->logger, "Exception thrown during request: {}", e);
+		sendResponse(
+			HttpWebApp::createServerErrorResponse(
+				*this, request, "The server experienced an error during the request. A report has been logged."
+			)
+		);
+	} catch (...) {
+		BalauBalauLogError(serverConfiguration->logger, "Unknown exception thrown during request: {}");
+		sendResponse(
+			HttpWebApp::createServerErrorResponse(
+				*this, request, "The server experienced an error during the request. A report has been logged."
+			)
+		);
+	}
+}
+
+void HttpSession::abortStreamedBody() {
+	bodyHandler.reset();
+	chunkParser.reset();
+	headerParser.reset();
+
+	auto response = HttpWebApp::createServerErrorResponse(
+		*this, request, "The server experienced an error during the request. A report has been logged."
+	);
+
+	// The remainder of the request body has not been read, so the connection cannot be reused.
+	response.keep_alive(false);
+	sendResponse(std::move(response));
+}
+
 bool HttpSession::validateRequest(boost::system::error_code errorCode, const StringRequest & request) {
 	if (errorCode == Error::end_of_stream) {
 		doClose(); // The client closed the connection.
 		return false;
 	} else if (errorCode) {
 		BalauBalauLogWarn(serverConfiguration->logger, "HttpSession request error: {}", errorCode);
+		abandonRequestMetrics();
 		return false;
 	}
 
-	const auto target = request.target();
-
-	if (target.empty() || target[0] != '/' || target.find("..") != boost::string_view::npos) {
+	if (!isLegalTarget(request.target())) {
 		sendResponse(HttpWebApp::createBadRequestResponse(*this, request, "Illegal path in request."));
 		return false;
 	}
@@ -104,12 +536,15 @@ bool HttpSession::validateRequest(boost::system::error_code errorCode, const Str
 }
 
 void HttpSession::onWrite(boost::system::error_code errorCode, std::size_t bytesTransferred, bool close) {
-	boost::ignore_unused(bytesTransferred);
-
 	if (errorCode) {
 		BalauBalauLogWarn(serverConfiguration->logger, "HttpSession error: {}", errorCode);
 		doClose();
-	} else if (close) {
+		return;
+	}
+
+	completeRequestMetrics(bytesTransferred);
+
+	if (close) {
 		doClose();
 	} else {
 		cachedResponse = nullptr;
@@ -117,8 +552,71 @@ void HttpSession::onWrite(boost::system::error_code errorCode, std::size_t bytes
 	}
 }
 
+void HttpSession::upgradeToHttp2(std::string && settingsPayload) {
+	auto response = std::make_shared<EmptyResponse>(Status::switching_protocols, 11);
+	response->set(Field::connection, "Upgrade");
+	response->set(Field::upgrade, "h2c");
+	cachedResponse = response;
+
+	HTTP::async_write(
+		  socket
+		, *response
+		, boost::asio::bind_executor(
+			  strand
+			, std::bind(
+				  &HttpSession::onWriteHttp2Upgrade
+				, shared_from_this()
+				, std::placeholders::_1
+				, std::make_shared<std::string>(std::move(settingsPayload))
+			)
+		)
+	);
+}
+
+void HttpSession::onWriteHttp2Upgrade(boost::system::error_code errorCode, std::shared_ptr<std::string> settingsPayload) {
+	cachedResponse = nullptr;
+
+	if (errorCode) {
+		BalauBalauLogWarn(serverConfiguration->logger, "HttpSession error: {}", errorCode);
+		doClose();
+		return;
+	}
+
+	// The request is handled as stream 1 of the HTTP/2 session, which takes over the connection.
+	abandonRequestMetrics();
+	std::make_shared<Http2Session>(shared_from_this())->startUpgraded(std::move(request), *settingsPayload);
+}
+
+void HttpSession::completeRequestMetrics(size_t bytesOut) {
+	releaseAdmission();
+
+	if (!requestInFlight) {
+		return;
+	}
+
+	requestInFlight = false;
+
+	serverConfiguration->metrics->requestCompleted(
+		  *metricsRoute
+		, responseStatus
+		, requestBytesIn
+		, bytesOut
+		, std::chrono::steady_clock::now() - requestStart
+	);
+}
+
+void HttpSession::abandonRequestMetrics() {
+	releaseAdmission();
+
+	if (requestInFlight) {
+		requestInFlight = false;
+		serverConfiguration->metrics->requestAbandoned();
+	}
+}
+
 void HttpSession::doClose() {
 	// Executed via the strand.
+	abandonRequestMetrics();
 
 	if (!socket.is_open()) {
 		BalauBalauLogTrace(serverConfiguration->logger, "HttpSession::doClose ignoring duplicate call.");
@@ -127,30 +625,175 @@ void HttpSession::doClose() {
 
 	boost::system::error_code errorCode;
 	BalauBalauLogTrace(serverConfiguration->logger, "HttpSession::doClose shutting down");
-	socket.shutdown(TCP::socket::shutdown_send, errorCode);
-	BalauBalauLogTrace(serverConfiguration->logger, "HttpSession::doClose completed shut down");
 	socket.close(errorCode);
 	BalauBalauLogTrace(serverConfiguration->logger, "HttpSession::doClose closed");
 	httpSessions.unregisterSession(shared_from_this());
 }
 
-void HttpSession::parseCookies() {
-	cookies.clear();
-	cookieString = ::toString(request[Field::cookie]);
+void HttpSession::sendHttp2Response(std::unique_ptr<Impl::Http2Response> response) {
+	auto sink = http2Sink.lock();
 
-	// According to RFC-6265, cookies must be split by the exact "; " string.
-	auto cookieViews = Util::Strings::split(cookieString, "; ");
+	// The HTTP/2 session no longer exists if the connection has been closed.
+	if (sink) {
+		sink->sendHttp2Response(http2StreamId, std::move(response));
+	}
+}
 
-	for (auto cookieView : cookieViews) {
-		auto cookieNameAndValue = Util::Strings::split(cookieView, "=");
+void HttpSession::startHttp2Request(StringRequest && request_, size_t bytesIn) {
+	request = std::move(request_);
+	requestStart = std::chrono::steady_clock::now();
+	requestBytesIn = bytesIn;
+	requestInFlight = true;
+	serverConfiguration->metrics->requestStarted();
 
-		if (cookieNameAndValue.size() != 2) {
-			// Invalid cookie sent by user agent.. ignore.
-			continue;
-		}
+	parseCookies();
+	setClientSession();
+}
+
+bool HttpSession::startHttp2Body() {
+	// Invalid requests are handled via the buffered path.
+	if (!isLegalTarget(request.target()) || !acquireAdmission()) {
+		return false;
+	}
+
+	bodyVariables.clear();
+
+	try {
+		bodyHandler = serverConfiguration->httpHandler->createPostBodyHandler(*this, request, bodyVariables);
+	} catch (const std::exception & e) {
+		BalauBalauLogError(serverConfiguration->logger, "Exception thrown during request: {}", e);
+		abortStreamedBody();
+		return true;
+	} catch (...) {
+		BalauBalauLogError(serverConfiguration->logger, "Unknown exception thrown during request: {}");
+		abortStreamedBody();
+		return true;
+	}
+
+	streamedBodySize = 0;
+	return (bool) bodyHandler;
+}
+
+void HttpSession::rejectOversizeBody() {
+	bodyHandler.reset();
+	chunkParser.reset();
+	headerParser.reset();
+
+	Response<StringBody> response { Status::payload_too_large, request.version() };
+	serverConfiguration->headerCache.setCommonHeaders(response);
+	response.set(Field::content_type, "text/html");
+	response.body() = "The request body is too large.";
+	response.prepare_payload();
+
+	// The remainder of an HTTP/1 request body has not been read, so the connection cannot be reused.
+	if (http2StreamId == 0) {
+		response.keep_alive(false);
+	}
+
+	sendResponse(std::move(response));
+}
+
+void HttpSession::dispatchHttp2Request() {
+	if (!isLegalTarget(request.target())) {
+		sendResponse(HttpWebApp::createBadRequestResponse(*this, request, "Illegal path in request."));
+		return;
+	}
+
+	handleRequest(request);
+}
+
+void HttpSession::doDrain() {
+	// Executed via the strand.
+	auto http2 = http2Connection.lock();
+
+	if (http2) {
+		http2->drain();
+		return;
+	}
+
+	// Sessions with a request in flight are closed after the response has been written.
+	// A request that has arrived but has not yet been read is handled in the same way,
+	// as the session is closed after the response when the server is draining.
+	if (!requestInFlight && buffer.size() == 0 && !hasUnreadData()) {
+		doClose();
+	}
+}
 
-		cookies.insert(std::make_pair(cookieNameAndValue[0], cookieNameAndValue[1]));
+bool HttpSession::hasUnreadData() {
+	boost::system::error_code errorCode;
+
+	if (socket.tcpSocket().available(errorCode) != 0 && !errorCode) {
+		return true;
 	}
+
+	// Decrypted data may be held by the TLS stream.
+	return socket.isTls() && SSL_pending(socket.tlsStream().native_handle()) > 0;
+}
+
+bool HttpSession::isDraining() const {
+	return httpSessions.isDraining();
+}
+
+bool HttpSession::acquireAdmission() {
+	if (admissionRoute != nullptr) {
+		return true;
+	} else if (admissionShed) {
+		return false;
+	}
+
+	auto & admission = *serverConfiguration->admission;
+
+	if (!admission.isEnabled()) {
+		return true;
+	}
+
+	std::string_view path(request.target().data(), request.target().length());
+	const auto queryStart = path.find('?');
+
+	if (queryStart != std::string_view::npos) {
+		path = path.substr(0, queryStart);
+	}
+
+	auto & route = admission.resolve(path);
+
+	if (admission.tryAcquire(route)) {
+		admissionRoute = &route;
+		return true;
+	}
+
+	admissionShed = true;
+	return false;
+}
+
+void HttpSession::releaseAdmission() {
+	if (admissionRoute != nullptr) {
+		serverConfiguration->admission->release(*admissionRoute);
+		admissionRoute = nullptr;
+	}
+
+	admissionShed = false;
+}
+
+void HttpSession::shedRequest(const StringRequest & request_) {
+	const auto retryAfter = serverConfiguration->admission->getRetryAfter();
+
+	if (request_.method() == Method::head) {
+		sendResponse(HttpWebApp::createServiceUnavailableHeadResponse(*this, request_, retryAfter));
+	} else {
+		sendResponse(HttpWebApp::createServiceUnavailableResponse(*this, request_, retryAfter));
+	}
+}
+
+void HttpSession::parseCookies() {
+	cookies.clear();
+
+	// The cookie views refer to the field storage of the request, which is stable during the request.
+	const auto field = request[Field::cookie];
+
+	Network::Impl::forEachCookie(
+		  std::string_view(field.data(), field.size())
+		, [this] (std::string_view name, std::string_view value) { cookies.emplace(name, value); }
+	);
 }
 
 void HttpSession::setClientSession() {
@@ -158,7 +801,7 @@ void HttpSession::setClientSession() {
 
 	if (iter != cookies.end()) {
 		// Existing client session?
-		auto session = clientSessions.get(std::string(iter->second));
+		auto session = clientSessions.get(iter->second);
 
 		if (session) {
 			clientSession = session;
@@ -170,4 +813,12 @@ void HttpSession::setClientSession() {
 	clientSession = clientSessions.create(*serverConfiguration->clock);
 }
 
+void HttpSession::releaseResponseCapture() {
+	if (responseCapture) {
+		auto capture = std::move(responseCapture);
+		responseCapture = nullptr;
+		capture(nullptr);
+	}
+}
+
 } // namespace Balau::Network::Http
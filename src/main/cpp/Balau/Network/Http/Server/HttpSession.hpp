@@ -30,8 +30,17 @@
 #include <Balau/Network/Http/Server/HttpServerConfiguration.hpp>
 #include <Balau/Network/Http/Server/WsSession.hpp>
 #include <Balau/Network/Http/Server/ClientSession.hpp>
+#include <Balau/Network/Http/Server/Impl/HeaderValueBuilder.hpp>
+#include <Balau/Network/Http/Server/Impl/Http2Response.hpp>
+#include <Balau/Network/Http/Server/Impl/HttpSocket.hpp>
+#include <Balau/Network/Http/Server/Impl/RequestArena.hpp>
 #include <Balau/Util/DateTime.hpp>
 
+#include <boost/asio/write.hpp>
+#include <boost/optional.hpp>
+
+#include <array>
+
 // Avoid false positive (due to std::make_shared).
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
@@ -41,10 +50,13 @@ namespace Balau::Network::Http {
 namespace Impl {
 
 class ClientSessions;
+class ConfigurationPublisher;
 class HttpSessions;
 
 } // namespace Impl
 
+class Http2Session;
+
 ///
 /// Manages the handling of HTTP messages and WebSocket upgrade requests in an HTTP connection.
 ///
@@ -52,19 +64,62 @@ class HttpSessions;
 ///
 /// Multiple HTTP sessions may occur within the lifetime of a single client session.
 ///
+/// When the server terminates TLS, the session performs the TLS handshake before
+/// reading the first request.
+///
+/// When an HTTP/2 connection is established, each HTTP/2 stream is handled by a
+/// separate HTTP session object. The responses sent to these sessions are sent
+/// on the stream by the HTTP/2 session of the connection. Web applications thus
+/// handle HTTP/1 and HTTP/2 requests in the same way.
+///
+/// Before reading each request, the session picks up the latest configuration
+/// published by the server if the configuration has been reloaded. A request
+/// is thus always handled with a single configuration from start to finish.
+///
 class HttpSession final : public std::enable_shared_from_this<HttpSession> {
+	///
+	/// The size of the chunks in which streamed request bodies are read.
+	///
+	/// See HttpWebApp::createPostBodyHandler.
+	///
+	public: static constexpr size_t RequestBodyChunkSize = 64 * 1024;
+
 	///
 	/// Create an HTTP session object with the supplied data.
 	///
 	/// @param owner_ the owning HTTP session manager
 	/// @param clientSessions_ the HTTP client session manager
+	/// @param publisher_ the publisher of the configuration of the HTTP server that created this session
+	/// @param socket_ the session socket (plain or TLS)
+	///
+	public: HttpSession(Impl::HttpSessions & httpSessions_,
+	                    Impl::ClientSessions & clientSessions_,
+	                    std::shared_ptr<Impl::ConfigurationPublisher> publisher_,
+	                    Impl::HttpSocket && socket_);
+
+	///
+	/// Create an HTTP session object that handles a single HTTP/2 stream.
+	///
+	/// @param owner_ the owning HTTP session manager
+	/// @param clientSessions_ the HTTP client session manager
 	/// @param serverConfiguration_ the configuration of the HTTP server that created this session
-	/// @param socket_ the session socket
+	/// @param connectionStrand the strand of the HTTP/2 connection
+	/// @param remoteAddress_ the requester's IP address
+	/// @param http2Sink_ the HTTP/2 session that sends the responses
+	/// @param http2StreamId_ the HTTP/2 stream identifier
 	///
 	public: HttpSession(Impl::HttpSessions & httpSessions_,
 	                    Impl::ClientSessions & clientSessions_,
 	                    std::shared_ptr<HttpServerConfiguration> serverConfiguration_,
-	                    TCP::socket && socket_);
+	                    boost::asio::strand<boost::asio::io_context::executor_type> connectionStrand,
+	                    Address remoteAddress_,
+	                    std::weak_ptr<Impl::Http2ResponseSink> http2Sink_,
+	                    uint32_t http2StreamId_);
+
+	///
+	/// Destroy the session, releasing a pending response capture.
+	///
+	public: ~HttpSession();
 
 	///
 	/// Get the shared state of the http server.
@@ -77,7 +132,49 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 	/// Get the requester's IP address for logging.
 	///
 	public: Address remoteIpAddress() const {
-		return socket.remote_endpoint().address();
+		return http2StreamId == 0 ? socket.remote_endpoint().address() : remoteAddress;
+	}
+
+	///
+	/// Get the HTTP/2 stream identifier of the session, or zero for HTTP/1 sessions.
+	///
+	public: uint32_t getHttp2StreamId() const {
+		return http2StreamId;
+	}
+
+	///
+	/// Set the label of the route against which the metrics of the current request are recorded.
+	///
+	/// Called by routing handlers. The label must remain valid for the lifetime of
+	/// the server. If no route is set, the request is recorded against the
+	/// unmatched route.
+	///
+	public: void setMetricsRoute(const std::string & route) {
+		metricsRoute = &route;
+	}
+
+	///
+	/// Capture the next response sent by the session.
+	///
+	/// The capture function is called with the response before it is sent, if the
+	/// response has a string body. It is called with nullptr if the response has
+	/// another body type, or if the session moves on to the next request or is
+	/// destroyed without having sent a response.
+	///
+	/// Called by response caching handlers.
+	///
+	public: void captureResponse(std::function<void (const StringResponse *)> capture) {
+		responseCapture = std::move(capture);
+	}
+
+	///
+	/// Execute the function on the strand of the session.
+	///
+	/// Called by handlers that send the response of a request from outside of the
+	/// handler call, for example when the response was computed for another request.
+	///
+	public: void post(std::function<void ()> function) {
+		strand.post(std::move(function), allocator);
 	}
 
 	///
@@ -103,7 +200,7 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 			, "{} - {} {} {} - {} {} - \"{}\"{} - [{}]"
 			, remoteIpAddress().to_string()
 			, request.method()
-			, response.version() == 11 ? "HTTP/1.1" : "HTTP/1.0"
+			, http2StreamId != 0 ? "HTTP/2" : response.version() == 11 ? "HTTP/1.1" : "HTTP/1.0"
 			, response.result_int()
 			, response[Field::content_type]
 			, response[Field::content_length]
@@ -112,13 +209,50 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 			, request[Field::user_agent]
 		);
 
+		// The response is captured before the client specific headers are added.
+		if (responseCapture) {
+			auto capture = std::move(responseCapture);
+			responseCapture = nullptr;
+
+			if constexpr (std::is_same_v<BodyT, StringBody>) {
+				capture(&response);
+			} else {
+				capture(nullptr);
+			}
+		}
+
 		// Set the session cookie.
-		response.insert(
-			Field::set_cookie, serverConfiguration->sessionCookieName + "=" + clientSession->sessionId + "; HttpOnly"
-		);
+		Impl::HeaderValueBuilder<256> cookie;
+		cookie.append(serverConfiguration->sessionCookieName).append('=').append(clientSession->sessionId).append("; HttpOnly");
+		const auto cookieView = cookie.view();
+		response.insert(Field::set_cookie, boost::string_view(cookieView.data(), cookieView.length()));
+
+		responseStatus = response.result_int();
+
+		// The connection is closed after the response when the server is draining.
+		if (http2StreamId == 0 && isDraining()) {
+			response.keep_alive(false);
+		}
+
+		if (http2StreamId != 0) {
+			sendHttp2Response(std::make_unique<Impl::Http2ResponseImpl<BodyT>>(std::move(response)));
+			return;
+		}
+
+		// Responses with an in-memory body and a known length are written with the common header block.
+		if constexpr (std::is_same_v<BodyT, StringBody> || std::is_same_v<BodyT, EmptyBody>) {
+			if (response.has_content_length() && !response.chunked()) {
+				writeWithCommonHeaderBlock(std::move(response));
+				return;
+			}
+		}
 
 		// Transfer ownership of the response in preparation for the asynchronous call.
-		auto sharedResponse = std::make_shared<Response<BodyT>>(std::move(response));
+		// The response is allocated in the request arena and is released before the arena is reset.
+		auto sharedResponse = std::allocate_shared<Response<BodyT>>(
+			Impl::RequestArenaAllocator<Response<BodyT>>(arena), std::move(response)
+		);
+
 		auto sharedVoidResponse = std::shared_ptr<void>(sharedResponse);
 		cachedResponse = sharedVoidResponse;
 
@@ -141,8 +275,14 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 	////////////////////////// Private implementation /////////////////////////
 
 	friend class Listener;
+	friend class Http2Session;
 	friend class ::Balau::Network::Http::Impl::HttpSessions;
 
+	///
+	/// Start the session, performing the TLS handshake first if the socket is a TLS socket.
+	///
+	public: void start();
+
 	///
 	/// @throw NetworkException if there was an issue reading
 	///
@@ -153,8 +293,31 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 	///
 	public: void close();
 
-	// Callback from context.
+	///
+	/// Close the session gracefully.
+	///
+	/// Idle sessions are closed immediately. Sessions with a request in flight
+	/// are closed once the response has been written. HTTP/2 connections send
+	/// a GOAWAY frame and are closed once their open streams have completed.
+	///
+	public: void drain();
+
+	// Callbacks from context.
+	private: void onHandshake(boost::system::error_code errorCode);
+	private: void onFirstByte(boost::system::error_code errorCode);
+	private: void onReadHeader(boost::system::error_code errorCode, std::size_t bytesTransferred);
 	private: void onRead(boost::system::error_code errorCode, std::size_t bytesTransferred);
+	private: void onReadBodyChunk(boost::system::error_code errorCode, std::size_t bytesTransferred);
+
+	// Create a body handler if the POST request is to be streamed and start reading the body.
+	private: bool startStreamedBody();
+	private: void doReadBodyChunk();
+	private: bool deliverBodyChunk(std::string_view chunk);
+	private: void completeStreamedBody();
+
+	// Send a server error response and close the connection, used when the request body is not consumed.
+	private: void abortStreamedBody();
+	private: void rejectOversizeBody();
 
 	// Validate the request path.
 	// TODO Add other required validations.
@@ -162,6 +325,11 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 
 	// Dispatch the request to the appropriate handler method.
 	private: void handleRequest(const StringRequest & request) {
+		if (!acquireAdmission()) {
+			shedRequest(request);
+			return;
+		}
+
 		try {
 			// The variables generated and consumed during this request.
 			std::map<std::string, std::string> variables;
@@ -204,22 +372,152 @@ class HttpSession final : public std::enable_shared_from_this<HttpSession> {
 		}
 	}
 
+	// A response together with its serialised header, allocated in the request arena.
+	private: template <typename BodyT> struct HeaderBlockResponse {
+		Response<BodyT> response;
+		std::basic_string<char, std::char_traits<char>, Impl::RequestArenaAllocator<char>> header;
+
+		HeaderBlockResponse(Response<BodyT> && response_, Impl::RequestArena & arena)
+			: response(std::move(response_))
+			, header(Impl::RequestArenaAllocator<char>(arena)) {}
+	};
+
+	// Serialise the response header, using the common header block of the
+	// server in place of the Server and Date fields set in the response.
+	private: template <typename BodyT, typename StringT>
+	static void serialiseHeader(StringT & header, const Response<BodyT> & response, std::string_view commonHeaderBlock) {
+		const unsigned status = response.result_int();
+		const auto reason = response.reason();
+
+		header.append(response.version() == 10 ? "HTTP/1.0 " : "HTTP/1.1 ");
+		header.push_back(static_cast<char>('0' + status / 100 % 10));
+		header.push_back(static_cast<char>('0' + status / 10 % 10));
+		header.push_back(static_cast<char>('0' + status % 10));
+		header.push_back(' ');
+		header.append(reason.data(), reason.size());
+		header.append("\r\n");
+		header.append(commonHeaderBlock.data(), commonHeaderBlock.size());
+
+		for (const auto & field : response) {
+			if (field.name() == Field::server || field.name() == Field::date) {
+				continue;
+			}
+
+			const auto name = field.name_string();
+			const auto value = field.value();
+			header.append(name.data(), name.size());
+			header.append(": ");
+			header.append(value.data(), value.size());
+			header.append("\r\n");
+		}
+
+		header.append("\r\n");
+	}
+
+	// Write the response directly to the socket, bypassing the Beast serialiser.
+	private: template <typename BodyT> void writeWithCommonHeaderBlock(Response<BodyT> && response) {
+		using Written = HeaderBlockResponse<BodyT>;
+
+		// The response is allocated in the request arena and is released before the arena is reset.
+		auto written = std::allocate_shared<Written>(
+			Impl::RequestArenaAllocator<Written>(arena), std::move(response), arena
+		);
+
+		serialiseHeader(written->header, written->response, serverConfiguration->headerCache.commonHeaderBlock());
+		cachedResponse = std::shared_ptr<void>(written);
+
+		std::array<boost::asio::const_buffer, 2> buffers {
+			  boost::asio::buffer(written->header.data(), written->header.size())
+			, boost::asio::const_buffer()
+		};
+
+		if constexpr (std::is_same_v<BodyT, StringBody>) {
+			buffers[1] = boost::asio::buffer(written->response.body().data(), written->response.body().size());
+		}
+
+		boost::asio::async_write(
+			  socket
+			, buffers
+			, boost::asio::bind_executor(
+				  strand
+				, std::bind(
+					&HttpSession::onWrite
+					, shared_from_this()
+					, std::placeholders::_1
+					, std::placeholders::_2
+					, !written->response.keep_alive()
+				)
+			)
+		);
+	}
+
 	private: void onWrite(boost::system::error_code errorCode, std::size_t bytesTransferred, bool close);
+	private: void upgradeToHttp2(std::string && settingsPayload);
+	private: void onWriteHttp2Upgrade(boost::system::error_code errorCode, std::shared_ptr<std::string> settingsPayload);
+	private: void doReadHeader();
+	private: void completeRequestMetrics(size_t bytesOut);
+	private: void abandonRequestMetrics();
 	private: void doClose();
+	private: void doDrain();
+	private: bool isDraining() const;
+	private: bool hasUnreadData();
+
+	// Admission control of the current request. Admission is acquired a single time per request.
+	private: bool acquireAdmission();
+	private: void releaseAdmission();
+	private: void shedRequest(const StringRequest & request);
 	private: void parseCookies();
 	private: void setClientSession();
+	private: void releaseResponseCapture();
+
+	// Used when the session handles an HTTP/2 stream.
+	private: void sendHttp2Response(std::unique_ptr<Impl::Http2Response> response);
+	private: void startHttp2Request(StringRequest && request_, size_t bytesIn);
+	private: bool startHttp2Body();
+	private: void dispatchHttp2Request();
+
+	// The cookies of the current request, which refer to the request's cookie field.
+	private: using CookieMap = std::map<
+		  std::string_view
+		, std::string_view
+		, std::less<>
+		, Impl::RequestArenaAllocator<std::pair<const std::string_view, std::string_view>>
+	>;
 
 	private: Impl::HttpSessions & httpSessions;
 	private: Impl::ClientSessions & clientSessions;
 	private: std::shared_ptr<ClientSession> clientSession;
 	private: std::shared_ptr<HttpServerConfiguration> serverConfiguration;
+	private: const std::shared_ptr<Impl::ConfigurationPublisher> publisher; // Null for HTTP/2 stream sessions.
+	private: uint64_t configurationGeneration = 0;
 	private: boost::asio::strand<boost::asio::io_context::executor_type> strand;
-	private: TCP::socket socket;
+	private: Impl::HttpSocket socket;
 	private: Buffer buffer;
 	private: StringRequest request;
-	private: std::string cookieString;
-	private: std::map<std::string_view, std::string_view> cookies;
+	private: boost::optional<HTTP::request_parser<EmptyBody>> headerParser;
+	private: boost::optional<HTTP::request_parser<StringBody>> bodyParser;
+	private: boost::optional<HTTP::request_parser<HTTP::buffer_body>> chunkParser;
+	private: std::unique_ptr<RequestBodyHandler> bodyHandler;
+	private: std::map<std::string, std::string> bodyVariables;
+	private: std::unique_ptr<char[]> chunkBuffer;
+	private: uint64_t streamedBodySize = 0;
+	// The cookie table and the response are allocated from the arena. The request fields,
+	// body and handler variables are web application API types using the standard allocator.
+	private: Impl::RequestArena arena; // Must be declared before the data allocated from it.
+	private: CookieMap cookies;
 	private: std::shared_ptr<void> cachedResponse; // Used to keep the response alive.
+	private: std::function<void (const StringResponse *)> responseCapture;
+	private: std::chrono::steady_clock::time_point requestStart;
+	private: const std::string * metricsRoute = &HttpMetrics::UnmatchedRoute;
+	private: size_t requestBytesIn = 0;
+	private: unsigned responseStatus = 0;
+	private: bool requestInFlight = false;
+	private: HttpAdmissionControl::Route * admissionRoute = nullptr; // Set when the current request has been admitted.
+	private: bool admissionShed = false;
+	private: const Address remoteAddress;
+	private: const std::weak_ptr<Impl::Http2ResponseSink> http2Sink;
+	private: const uint32_t http2StreamId = 0;
+	private: std::weak_ptr<Impl::Http2ResponseSink> http2Connection; // Set when an HTTP/2 session takes over the connection.
 	private: std::allocator<char> allocator;
 };
 
@@ -24,7 +24,7 @@ namespace Balau::Network::Http {
 
 StringResponse HttpWebApp::createOkResponse(HttpSession & session, const StringRequest & request) {
 	Response<StringBody> response { Status::ok, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	response.body() = "";
@@ -34,7 +34,7 @@ StringResponse HttpWebApp::createOkResponse(HttpSession & session, const StringR
 
 EmptyResponse HttpWebApp::createOkHeadResponse(HttpSession & session, const StringRequest & request) {
 	Response<EmptyBody> response { Status::ok, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	return response;
@@ -44,7 +44,7 @@ EmptyResponse HttpWebApp::createRedirectResponse(HttpSession & session,
                                                  const StringRequest & request,
                                                  std::string_view location) {
 	Response<EmptyBody> response { Status::found, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::location, location);
 	response.keep_alive(request.keep_alive());
 	return response;
@@ -54,7 +54,7 @@ EmptyResponse HttpWebApp::createPermanentRedirectResponse(HttpSession & session,
                                                           const StringRequest & request,
                                                           std::string_view location) {
 	Response<EmptyBody> response { Status::moved_permanently, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::location, location);
 	response.keep_alive(request.keep_alive());
 	return response;
@@ -64,7 +64,7 @@ StringResponse HttpWebApp::createBadRequestResponse(HttpSession & session,
                                                     const StringRequest & request,
                                                     std::string_view errorMessage) {
 	Response<StringBody> response { Status::bad_request, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	response.body() = std::string(errorMessage);
@@ -74,7 +74,7 @@ StringResponse HttpWebApp::createBadRequestResponse(HttpSession & session,
 
 EmptyResponse HttpWebApp::createBadRequestHeadResponse(HttpSession & session, const StringRequest & request) {
 	Response<EmptyBody> response { Status::bad_request, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	return response;
@@ -82,7 +82,7 @@ EmptyResponse HttpWebApp::createBadRequestHeadResponse(HttpSession & session, co
 
 StringResponse HttpWebApp::createNotFoundStringResponse(HttpSession & session, const StringRequest & request) {
 	Response<StringBody> response { Status::not_found, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	response.body() = "The resource '" + std::string(request.target()) + "' was not found.";
@@ -92,7 +92,7 @@ StringResponse HttpWebApp::createNotFoundStringResponse(HttpSession & session, c
 
 EmptyResponse HttpWebApp::createNotFoundHeadResponse(HttpSession & session, const StringRequest & request) {
 	Response<EmptyBody> response { Status::not_found, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	return response;
@@ -102,7 +102,7 @@ StringResponse HttpWebApp::createServerErrorResponse(HttpSession & session,
                                                      const StringRequest & request,
                                                      std::string_view errorMessage) {
 	Response<StringBody> response { Status::internal_server_error, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	response.body() = "An error occurred: '" + std::string(errorMessage) + "'";
@@ -112,10 +112,34 @@ StringResponse HttpWebApp::createServerErrorResponse(HttpSession & session,
 
 EmptyResponse HttpWebApp::createServerErrorHeadResponse(HttpSession & session, const StringRequest & request) {
 	Response<EmptyBody> response { Status::internal_server_error, request.version() };
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, "text/html");
 	response.keep_alive(request.keep_alive());
 	return response;
 }
 
+StringResponse HttpWebApp::createServiceUnavailableResponse(HttpSession & session,
+                                                            const StringRequest & request,
+                                                            std::chrono::seconds retryAfter) {
+	Response<StringBody> response { Status::service_unavailable, request.version() };
+	session.configuration().headerCache.setCommonHeaders(response);
+	response.set(Field::content_type, "text/html");
+	response.set(Field::retry_after, ::toString(retryAfter.count()));
+	response.keep_alive(request.keep_alive());
+	response.body() = "The server is overloaded. Please retry later.";
+	response.prepare_payload();
+	return response;
+}
+
+EmptyResponse HttpWebApp::createServiceUnavailableHeadResponse(HttpSession & session,
+                                                               const StringRequest & request,
+                                                               std::chrono::seconds retryAfter) {
+	Response<EmptyBody> response { Status::service_unavailable, request.version() };
+	session.configuration().headerCache.setCommonHeaders(response);
+	response.set(Field::content_type, "text/html");
+	response.set(Field::retry_after, ::toString(retryAfter.count()));
+	response.keep_alive(request.keep_alive());
+	return response;
+}
+
 } // namespace Balau::Network::Http
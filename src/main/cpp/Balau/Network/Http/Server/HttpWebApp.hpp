@@ -27,8 +27,11 @@
 #define COM_BORA_SOFTWARE__BALAU_NETWORK_SERVER__HTTP_WEB_APPLICATION
 
 #include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <Balau/Network/Http/Server/RequestBodyHandler.hpp>
 #include <Balau/Network/Http/Server/Impl/HttpWebAppFactory.hpp>
 
+#include <chrono>
+
 namespace Balau::Network::Http {
 
 class HttpSession;
@@ -116,6 +119,20 @@ class HttpWebApp {
 	///
 	public: static EmptyResponse createServerErrorHeadResponse(HttpSession & session, const StringRequest & request);
 
+	///
+	/// Create a service unavailable response, used when a request is shed.
+	///
+	public: static StringResponse createServiceUnavailableResponse(HttpSession & session,
+	                                                               const StringRequest & request,
+	                                                               std::chrono::seconds retryAfter);
+
+	///
+	/// Create a service unavailable response for a head request.
+	///
+	public: static EmptyResponse createServiceUnavailableHeadResponse(HttpSession & session,
+	                                                                  const StringRequest & request,
+	                                                                  std::chrono::seconds retryAfter);
+
 	///////////////////////////////////////////////////////////////////////////
 
 	///
@@ -157,6 +174,27 @@ class HttpWebApp {
 	                                       const StringRequest & request,
 	                                       std::map<std::string, std::string> & variables) = 0;
 
+	///
+	/// Create a body handler for a streamed POST request.
+	///
+	/// Called by the HTTP session after the request header has been read and before
+	/// the request body is read. If a body handler is returned, the body is passed to
+	/// the handler in chunks as it arrives and handlePostRequest is not called.
+	///
+	/// The default implementation returns null, which results in the body being read
+	/// into the request object before handlePostRequest is called.
+	///
+	/// @param session the HTTP session object, also containing the client session
+	/// @param request the HTTP request object, containing the header fields and an empty body
+	/// @param variables the request variables that are generated and consumed during the request
+	/// @return a body handler or null if the body should be buffered
+	///
+	public: virtual std::unique_ptr<RequestBodyHandler> createPostBodyHandler(HttpSession & ,
+	                                                                          const StringRequest & ,
+	                                                                          std::map<std::string, std::string> & ) {
+		return std::unique_ptr<RequestBodyHandler>();
+	}
+
 	///////////////////////////////////////////////////////////////////////////
 
 	///
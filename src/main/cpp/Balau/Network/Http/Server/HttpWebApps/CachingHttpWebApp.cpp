@@ -0,0 +1,397 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "CachingHttpWebApp.hpp"
+#include "Impl/ResponseCache.hpp"
+#include "../HttpSession.hpp"
+#include "../../../../Application/EnvironmentProperties.hpp"
+
+#include <boost/beast/core/string.hpp>
+
+namespace Balau::Network::Http::HttpWebApps {
+
+namespace {
+
+using Entry = Impl::ResponseCache::Entry;
+
+bool iequals(std::string_view lhs, std::string_view rhs) {
+	return boost::beast::iequals(
+		boost::beast::string_view(lhs.data(), lhs.size()), boost::beast::string_view(rhs.data(), rhs.size())
+	);
+}
+
+// Calls the function for each trimmed element of a comma separated header value.
+template <typename FunctionT> void forEachElement(boost::string_view value, FunctionT function) {
+	auto elements = Util::Strings::splitAndTrim(std::string_view(value.data(), value.size()), ",");
+
+	for (auto element : elements) {
+		if (!element.empty()) {
+			function(element);
+		}
+	}
+}
+
+// The name of a Cache-Control directive, without the argument.
+std::string_view directiveName(std::string_view directive) {
+	return Util::Strings::trim(directive.substr(0, directive.find('=')));
+}
+
+bool hasDirective(boost::string_view cacheControl, std::string_view name) {
+	bool found = false;
+
+	forEachElement(cacheControl, [&found, name] (std::string_view directive) {
+		found = found || iequals(directiveName(directive), name);
+	});
+
+	return found;
+}
+
+// Get the lifetime from the s-maxage or max-age directive, or -1 if none is present.
+int64_t maxAge(boost::string_view cacheControl) {
+	int64_t sharedMaxAge = -1;
+	int64_t privateMaxAge = -1;
+
+	forEachElement(cacheControl, [&sharedMaxAge, &privateMaxAge] (std::string_view directive) {
+		const auto equals = directive.find('=');
+
+		if (equals == std::string_view::npos) {
+			return;
+		}
+
+		const auto name = directiveName(directive);
+		const auto value = Util::Strings::trim(directive.substr(equals + 1));
+		int64_t seconds = 0;
+
+		for (char c : value) {
+			if (c < '0' || c > '9') {
+				return;
+			}
+
+			seconds = std::min<int64_t>(seconds * 10 + (c - '0'), std::numeric_limits<int32_t>::max());
+		}
+
+		if (iequals(name, "s-maxage")) {
+			sharedMaxAge = seconds;
+		} else if (iequals(name, "max-age")) {
+			privateMaxAge = seconds;
+		}
+	});
+
+	return sharedMaxAge >= 0 ? sharedMaxAge : privateMaxAge;
+}
+
+// The statuses that are cacheable by default (RFC 7231 section 6.1).
+bool isCacheableStatus(unsigned status) {
+	switch (status) {
+		case 200: case 203: case 204: case 300: case 301: case 404: case 405: case 410: case 414: case 501: {
+			return true;
+		}
+
+		default: {
+			return false;
+		}
+	}
+}
+
+// Create the cache entry for the response, or null if the response is not cacheable.
+std::shared_ptr<const Entry> createEntry(const StringResponse & response,
+                                         const std::string & key,
+                                         const CachingHttpWebApp::Settings & settings,
+                                         std::chrono::milliseconds now) {
+	if (!isCacheableStatus(response.result_int()) || response.count(Field::set_cookie) != 0) {
+		return nullptr;
+	}
+
+	const auto cacheControl = response[Field::cache_control];
+
+	if (hasDirective(cacheControl, "no-store") || hasDirective(cacheControl, "no-cache") || hasDirective(cacheControl, "private")) {
+		return nullptr;
+	}
+
+	// The response may only vary on the request headers that are part of the key.
+	bool varies = false;
+
+	forEachElement(response[Field::vary], [&varies, &settings] (std::string_view name) {
+		varies = varies || std::none_of(
+			  settings.vary.begin()
+			, settings.vary.end()
+			, [name] (const std::string & configured) { return iequals(name, configured); }
+		);
+	});
+
+	if (varies) {
+		return nullptr;
+	}
+
+	const int64_t age = maxAge(cacheControl);
+	const auto ttl = age >= 0 ? std::chrono::seconds(age) : settings.ttl;
+
+	if (ttl.count() <= 0) {
+		return nullptr;
+	}
+
+	size_t size = key.length() + response.body().length();
+
+	for (const auto & field : response) {
+		size += field.name_string().size() + field.value().size() + 4;
+	}
+
+	if (size > settings.maxEntrySize) {
+		return nullptr;
+	}
+
+	return std::shared_ptr<const Entry>(new Entry { response, now, now + ttl, size });
+}
+
+void sendEntry(HttpSession & session, const StringRequest & request, const Entry & entry, std::chrono::milliseconds now) {
+	const auto age = std::chrono::duration_cast<std::chrono::seconds>(now - entry.storedAt).count();
+
+	if (request.method() == Method::head) {
+		EmptyResponse response { entry.response.base() };
+		response.version(request.version());
+		session.configuration().headerCache.setCommonHeaders(response);
+		response.set(Field::age, ::toString(std::max<int64_t>(age, 0)));
+		response.keep_alive(request.keep_alive());
+		session.sendResponse(std::move(response));
+	} else {
+		StringResponse response = entry.response;
+		response.version(request.version());
+		session.configuration().headerCache.setCommonHeaders(response);
+		response.set(Field::age, ::toString(std::max<int64_t>(age, 0)));
+		response.keep_alive(request.keep_alive());
+		session.sendResponse(std::move(response));
+	}
+}
+
+// Determine whether the request must be passed to the wrapped web application without using the cache.
+//
+// Responses to requests carrying credentials may be specific to the client. Cookies
+// are only permitted when the Cookie header is one of the configured Vary headers,
+// in which case the cookies form part of the key.
+bool bypassesCache(const StringRequest & request, const CachingHttpWebApp::Settings & settings) {
+	if (request.count(Field::authorization) != 0 || hasDirective(request[Field::cache_control], "no-store")) {
+		return true;
+	}
+
+	return request.count(Field::cookie) != 0 && std::none_of(
+		  settings.vary.begin()
+		, settings.vary.end()
+		, [] (const std::string & name) { return iequals(name, "cookie"); }
+	);
+}
+
+std::chrono::milliseconds currentTime(HttpSession & session) {
+	return session.configuration().clock->millitime();
+}
+
+} // namespace
+
+CachingHttpWebApp::Settings CachingHttpWebApp::Settings::fromConfiguration(const EnvironmentProperties & configuration) {
+	const Settings defaults;
+	Settings settings;
+
+	settings.ttl = std::chrono::seconds(configuration.getValue<int>("ttl", (int) defaults.ttl.count()));
+	settings.maxSize = (size_t) std::max(0, configuration.getValue<int>("max.size", (int) defaults.maxSize));
+	settings.maxEntrySize = (size_t) std::max(0, configuration.getValue<int>("max.entry.size", (int) defaults.maxEntrySize));
+	settings.coalesce = configuration.getValue<bool>("coalesce", defaults.coalesce);
+
+	const auto vary = configuration.getValue<std::string>("vary", "");
+
+	for (auto name : Util::Strings::split(vary, std::regex("[ \t,]+"))) {
+		if (!name.empty()) {
+			settings.vary.emplace_back(Util::Strings::toLower(name));
+		}
+	}
+
+	const auto admission = Util::Strings::toLower(configuration.getValue<std::string>("admission", "lru"));
+
+	if (admission == "lru") {
+		settings.admission = Admission::Lru;
+	} else if (admission == "tinylfu") {
+		settings.admission = Admission::TinyLfu;
+	} else {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("Cache setting admission = ", admission, " is not one of lru or tinylfu.")
+		);
+	}
+
+	settings.validate();
+	return settings;
+}
+
+void CachingHttpWebApp::Settings::validate() const {
+	if (ttl.count() < 0) {
+		ThrowBalauException(Exception::IllegalArgumentException, ::toString("Cache setting ttl = ", ttl.count(), " is negative."));
+	}
+
+	if (maxSize == 0) {
+		ThrowBalauException(Exception::IllegalArgumentException, "Cache setting max.size must be positive.");
+	}
+
+	if (maxEntrySize == 0 || maxEntrySize > maxSize) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("Cache setting max.entry.size = ", maxEntrySize, " is not in the range 1 to max.size (", maxSize, ").")
+		);
+	}
+}
+
+CachingHttpWebApp::CachingHttpWebApp(std::shared_ptr<HttpWebApp> wrapped_, Settings settings_)
+	: wrapped(std::move(wrapped_))
+	, settings(std::move(settings_))
+	, cache(
+		std::make_shared<Impl::ResponseCache>(
+			  settings.maxSize
+			, settings.admission == Settings::Admission::TinyLfu
+				? Impl::ResponseCache::Admission::TinyLfu
+				: Impl::ResponseCache::Admission::Lru
+		)
+	) {
+	settings.validate();
+}
+
+void CachingHttpWebApp::handleGetRequest(HttpSession & session,
+                                         const StringRequest & request,
+                                         std::map<std::string, std::string> & variables) {
+	if (bypassesCache(request, settings)) {
+		wrapped->handleGetRequest(session, request, variables);
+		return;
+	}
+
+	auto key = createKey(Method::get, request);
+	const auto now = currentTime(session);
+
+	if (hasDirective(request[Field::cache_control], "no-cache")) {
+		// The entry is refreshed without waiting for or coalescing with other requests.
+		computeResponse(session, request, variables, std::move(key), now);
+		return;
+	}
+
+	std::shared_ptr<const Entry> entry;
+
+	// Only called when the request is coalesced with the computation of another request.
+	auto createWaiter = [&session, &request, &variables, this] () -> Impl::ResponseCache::Waiter {
+		return [sessionPtr = session.shared_from_this(), request, variables, wrapped = wrapped]
+			(std::shared_ptr<const Entry> completed) mutable {
+				auto & waitingSession = *sessionPtr;
+
+				waitingSession.post(
+					[sessionPtr = std::move(sessionPtr), request = std::move(request), variables = std::move(variables), wrapped = std::move(wrapped), completed = std::move(completed)] () mutable {
+						if (completed) {
+							sendEntry(*sessionPtr, request, *completed, currentTime(*sessionPtr));
+						} else {
+							wrapped->handleGetRequest(*sessionPtr, request, variables);
+						}
+					}
+				);
+			};
+	};
+
+	switch (cache->lookup(key, now, settings.coalesce, createWaiter, entry)) {
+		case Impl::ResponseCache::LookupResult::Hit: {
+			sendEntry(session, request, *entry, now);
+			break;
+		}
+
+		case Impl::ResponseCache::LookupResult::Waiting: {
+			// The response is sent when the leading request completes.
+			break;
+		}
+
+		default: {
+			computeResponse(session, request, variables, std::move(key), now);
+			break;
+		}
+	}
+}
+
+void CachingHttpWebApp::handleHeadRequest(HttpSession & session,
+                                          const StringRequest & request,
+                                          std::map<std::string, std::string> & variables) {
+	if (!bypassesCache(request, settings) && !hasDirective(request[Field::cache_control], "no-cache")) {
+		const auto now = currentTime(session);
+
+		// HEAD requests are answered from the entry of the corresponding GET request.
+		auto entry = cache->peek(createKey(Method::get, request), now);
+
+		if (entry) {
+			sendEntry(session, request, *entry, now);
+			return;
+		}
+	}
+
+	wrapped->handleHeadRequest(session, request, variables);
+}
+
+void CachingHttpWebApp::handlePostRequest(HttpSession & session,
+                                          const StringRequest & request,
+                                          std::map<std::string, std::string> & variables) {
+	wrapped->handlePostRequest(session, request, variables);
+}
+
+std::unique_ptr<RequestBodyHandler> CachingHttpWebApp::createPostBodyHandler(HttpSession & session,
+                                                                             const StringRequest & request,
+                                                                             std::map<std::string, std::string> & variables) {
+	return wrapped->createPostBodyHandler(session, request, variables);
+}
+
+CachingHttpWebApp::Statistics CachingHttpWebApp::statistics() const {
+	const auto cacheStatistics = cache->statistics();
+	Statistics statistics;
+	statistics.hits = cacheStatistics.hits;
+	statistics.misses = cacheStatistics.misses;
+	statistics.coalesced = cacheStatistics.coalesced;
+	statistics.rejected = cacheStatistics.rejected;
+	statistics.evictions = cacheStatistics.evictions;
+	statistics.entries = cacheStatistics.entries;
+	statistics.size = cacheStatistics.size;
+	return statistics;
+}
+
+std::string CachingHttpWebApp::createKey(Method method, const StringRequest & request) const {
+	const auto methodString = HTTP::to_string(method);
+	const auto target = request.target();
+	std::string key;
+	key.reserve(methodString.size() + 1 + target.size());
+	key.append(methodString.data(), methodString.size()).append(1, ' ').append(target.data(), target.size());
+
+	for (const auto & name : settings.vary) {
+		const auto value = request[boost::string_view(name.data(), name.size())];
+		key.append(1, '\n').append(value.data(), value.size());
+	}
+
+	return key;
+}
+
+void CachingHttpWebApp::computeResponse(HttpSession & session,
+                                        const StringRequest & request,
+                                        std::map<std::string, std::string> & variables,
+                                        std::string key,
+                                        std::chrono::milliseconds now) {
+	// Completes the key with the response of the wrapped web application, releasing any waiting requests.
+	session.captureResponse(
+		[cache = cache, settings = settings, key = std::move(key), now] (const StringResponse * response) {
+			cache->complete(key, response ? createEntry(*response, key, settings, now) : nullptr);
+		}
+	);
+
+	wrapped->handleGetRequest(session, request, variables);
+}
+
+} // namespace Balau::Network::Http::HttpWebApps
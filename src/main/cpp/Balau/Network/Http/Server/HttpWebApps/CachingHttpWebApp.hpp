@@ -0,0 +1,223 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file CachingHttpWebApp.hpp
+///
+/// An HTTP web application wrapper that caches the responses of another web application.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__CACHING_HTTP_WEB_APP
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__CACHING_HTTP_WEB_APP
+
+#include <Balau/Network/Http/Server/HttpWebApp.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace Balau {
+
+class EnvironmentProperties;
+
+namespace Network::Http::HttpWebApps {
+
+namespace Impl {
+
+class ResponseCache;
+
+} // namespace Impl
+
+///
+/// An HTTP web application wrapper that caches the responses of another web application.
+///
+/// GET responses of the wrapped web application are stored as complete responses,
+/// keyed by the request method, the request target and the values of the configured
+/// Vary request headers.
+/// Subsequent GET and HEAD requests for the same key are served from the cache until
+/// the entry expires. POST requests are passed through to the wrapped web application.
+///
+/// The lifetime of an entry is the max-age (or s-maxage) of the response's
+/// Cache-Control header if present, otherwise the configured TTL. Responses with a
+/// Cache-Control no-store, no-cache or private directive, responses that set cookies,
+/// responses with a status that is not cacheable by default, and responses that do
+/// not have a string body are not cached. Requests with an Authorization header,
+/// with a Cookie header (unless Cookie is one of the Vary request headers), or with
+/// a Cache-Control no-store directive bypass the cache, and requests with a
+/// Cache-Control no-cache directive refresh the entry.
+///
+/// The cache is bounded by the total size of the entries. Entries are evicted in
+/// least recently used order. With TinyLFU admission, a new entry is only admitted
+/// if its key is requested more frequently than the key of the entry it would evict,
+/// which protects frequently requested entries from one-off requests.
+///
+/// Concurrent misses for the same key are coalesced when enabled. The first request
+/// computes the response via the wrapped web application, whilst the other requests
+/// wait and are then sent the cached response. If the computed response is not
+/// cacheable, the waiting requests are passed to the wrapped web application.
+///
+/// A caching web application is created by the HTTP server for each configured web
+/// application that has an enabled cache composite property.
+///
+class CachingHttpWebApp : public HttpWebApp {
+	///
+	/// The settings of a caching web application.
+	///
+	public: struct Settings {
+		///
+		/// The entry eviction and admission policies.
+		///
+		enum class Admission { Lru, TinyLfu };
+
+		///
+		/// The lifetime of entries for responses without a Cache-Control max-age directive.
+		///
+		std::chrono::seconds ttl { 60 };
+
+		///
+		/// The maximum total size of the cached entries in bytes.
+		///
+		size_t maxSize = 16 * 1024 * 1024;
+
+		///
+		/// The maximum size of a single cached entry in bytes.
+		///
+		size_t maxEntrySize = 1024 * 1024;
+
+		///
+		/// The names of the request headers that are part of the cache key.
+		///
+		std::vector<std::string> vary;
+
+		///
+		/// The admission policy.
+		///
+		Admission admission = Admission::Lru;
+
+		///
+		/// True if concurrent misses for the same key are coalesced.
+		///
+		bool coalesce = true;
+
+		///
+		/// Create settings from a cache configuration composite.
+		///
+		/// Settings that are not present in the configuration take their default values.
+		///
+		/// @throw IllegalArgumentException if a setting is invalid
+		///
+		static Settings fromConfiguration(const EnvironmentProperties & configuration);
+
+		///
+		/// Validate the settings.
+		///
+		/// @throw IllegalArgumentException if a setting is invalid
+		///
+		void validate() const;
+	};
+
+	///
+	/// The statistics of the cache.
+	///
+	public: struct Statistics {
+		///
+		/// The number of requests served from the cache.
+		///
+		uint64_t hits = 0;
+
+		///
+		/// The number of requests that were not served from the cache.
+		///
+		uint64_t misses = 0;
+
+		///
+		/// The number of missed requests that waited for another request's response.
+		///
+		uint64_t coalesced = 0;
+
+		///
+		/// The number of cacheable responses that were not admitted.
+		///
+		uint64_t rejected = 0;
+
+		///
+		/// The number of entries evicted in order to admit new entries.
+		///
+		uint64_t evictions = 0;
+
+		///
+		/// The number of entries in the cache.
+		///
+		size_t entries = 0;
+
+		///
+		/// The total size of the entries in the cache in bytes.
+		///
+		size_t size = 0;
+	};
+
+	///
+	/// Create a caching web application that wraps the supplied web application.
+	///
+	/// @param wrapped_ the web application whose responses are cached
+	/// @param settings_ the cache settings
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	public: CachingHttpWebApp(std::shared_ptr<HttpWebApp> wrapped_, Settings settings_);
+
+	public: void handleGetRequest(HttpSession & session,
+	                              const StringRequest & request,
+	                              std::map<std::string, std::string> & variables) override;
+
+	public: void handleHeadRequest(HttpSession & session,
+	                               const StringRequest & request,
+	                               std::map<std::string, std::string> & variables) override;
+
+	public: void handlePostRequest(HttpSession & session,
+	                               const StringRequest & request,
+	                               std::map<std::string, std::string> & variables) override;
+
+	public: std::unique_ptr<RequestBodyHandler> createPostBodyHandler(HttpSession & session,
+	                                                                  const StringRequest & request,
+	                                                                  std::map<std::string, std::string> & variables) override;
+
+	///
+	/// Get the statistics of the cache.
+	///
+	public: Statistics statistics() const;
+
+	///////////////////////// Private implementation //////////////////////////
+
+	private: std::string createKey(Method method, const StringRequest & request) const;
+
+	private: void computeResponse(HttpSession & session,
+	                              const StringRequest & request,
+	                              std::map<std::string, std::string> & variables,
+	                              std::string key,
+	                              std::chrono::milliseconds now);
+
+	private: const std::shared_ptr<HttpWebApp> wrapped;
+	private: const Settings settings;
+	private: const std::shared_ptr<Impl::ResponseCache> cache;
+};
+
+} // namespace Network::Http::HttpWebApps
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__CACHING_HTTP_WEB_APP
@@ -42,7 +42,7 @@ void CannedHttpWebApp::handleHeadRequest(HttpSession & session,
                                          const StringRequest & request,
                                          std::map<std::string, std::string> & ) {
 	Response <StringBody> response {Status::ok, request.version()};
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::content_type, mimeType);
 	response.set(Field::content_length, getResponseBody.size()); // TODO This is causing a deadlock.
 	response.keep_alive(request.keep_alive());
@@ -60,7 +60,7 @@ void CannedHttpWebApp::handle(HttpSession & session, const StringRequest & reque
 		session.sendResponse(createBadRequestResponse(session, request, "Not supported"));
 	} else {
 		Response <StringBody> response {Status::ok, request.version()};
-		response.set(Field::server, session.configuration().serverId);
+		session.configuration().headerCache.setCommonHeaders(response);
 		response.set(Field::content_type, mimeType);
 		response.body() = body;
 		response.prepare_payload();
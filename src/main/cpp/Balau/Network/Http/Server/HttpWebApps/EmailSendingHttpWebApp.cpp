@@ -19,11 +19,19 @@
 
 #include "EmailSendingHttpWebApp.hpp"
 
+#include "../FormRequestBodyHandler.hpp"
 #include "../HttpSession.hpp"
 #include "Balau/Network/Utilities/UrlDecode.hpp"
 
 namespace Balau::Network::Http::HttpWebApps {
 
+namespace {
+
+// The maximum size of a form body, equal to the body limit of buffered requests.
+const uint64_t MaxBodySize = 1024 * 1024;
+
+} // namespace
+
 EmailSendingHttpWebApp::EmailSendingHttpWebApp(BodyGenerator bodyGenerator_,
                                                std::shared_ptr<HttpWebApp> successHandler_,
                                                std::shared_ptr<HttpWebApp> failureHandler_,
@@ -112,9 +120,46 @@ void EmailSendingHttpWebApp::handleHeadRequest(HttpSession & session,
 void EmailSendingHttpWebApp::handlePostRequest(HttpSession & session,
                                                const StringRequest & request,
                                                std::map<std::string, std::string> & variables) {
+	processRequest(session, request, variables, nullptr);
+}
+
+std::unique_ptr<RequestBodyHandler> EmailSendingHttpWebApp::createPostBodyHandler(HttpSession & ,
+                                                                                  const StringRequest & request,
+                                                                                  std::map<std::string, std::string> & ) {
+	if (!FormRequestBodyHandler::isUrlEncodedForm(request)) {
+		return std::unique_ptr<RequestBodyHandler>();
+	}
+
+	FormRequestBodyHandler::Limits limits;
+	limits.maxBodySize = MaxBodySize;
+
+	// URL encoded forms do not contain file uploads, so no spool directory is required.
+	return std::make_unique<FormRequestBodyHandler>(
+		  request
+		, Resource::File()
+		, [this] (HttpSession & session,
+		          const StringRequest & request,
+		          std::map<std::string, std::string> & variables,
+		          FormRequestBodyHandler::Form & form) {
+			processRequest(session, request, variables, &form.fields);
+		}
+		, limits
+	);
+}
+
+void EmailSendingHttpWebApp::processRequest(HttpSession & session,
+                                            const StringRequest & request,
+                                            std::map<std::string, std::string> & variables,
+                                            const ParameterMap * formParameters) {
 	try {
-		const ParameterMap parameters = UrlDecode::splitAndDecode(request.body());
-		const std::string body = bodyGenerator(session, request, variables, parameters);
+		ParameterMap decodedParameters;
+
+		if (formParameters == nullptr) {
+			decodedParameters = UrlDecode::splitAndDecode(request.body());
+			formParameters = &decodedParameters;
+		}
+
+		const std::string body = bodyGenerator(session, request, variables, *formParameters);
 		emailSender.sendEmail(from, to, cc, subject, body);
 
 		if (successHandler) {
@@ -137,8 +137,21 @@ class EmailSendingHttpWebApp : public HttpWebApp {
 	                               const StringRequest & request,
 	                               std::map<std::string, std::string> & variables) override;
 
+	///
+	/// URL encoded form bodies are decoded incrementally as they arrive.
+	///
+	public: std::unique_ptr<RequestBodyHandler> createPostBodyHandler(HttpSession & session,
+	                                                                  const StringRequest & request,
+	                                                                  std::map<std::string, std::string> & variables) override;
+
 	///////////////////////// Private implementation //////////////////////////
 
+	// Send the email, decoding the request body if no parameters are supplied.
+	private: void processRequest(HttpSession & session,
+	                             const StringRequest & request,
+	                             std::map<std::string, std::string> & variables,
+	                             const ParameterMap * formParameters);
+
 	private: static unsigned short verifyPort(int port);
 
 	private: static BodyGenerator createBodyGenerator(const EnvironmentProperties & configuration);
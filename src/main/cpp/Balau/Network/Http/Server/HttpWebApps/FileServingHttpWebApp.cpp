@@ -71,17 +71,14 @@ void FileServingHttpWebApp::handleGetRequest(HttpSession & session,
 		, std::make_tuple(Status::ok, request.version())
 	};
 
-	auto timestamp = std::chrono::time_point_cast<std::chrono::seconds>(session.configuration().clock->now());
-
 	auto mimeType = session.configuration().mimeTypes->lookup(pathStr);
 
 	if (!mimeType.empty()) {
 		response.set(Field::content_type, mimeType);
 	}
 
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.set(Field::cache_control, "public,max-age=600"); // todo parameterise
-	response.set(Field::date, Util::DateTime::toString("%a, %d %b %Y %T GMT", timestamp));
 	response.prepare_payload();
 	response.keep_alive(request.keep_alive());
 
@@ -107,7 +104,7 @@ void FileServingHttpWebApp::handleHeadRequest(HttpSession & session,
 		response.set(Field::content_type, mimeType);
 	}
 
-	response.set(Field::server, session.configuration().serverId);
+	session.configuration().headerCache.setCommonHeaders(response);
 	response.keep_alive(request.keep_alive());
 	session.sendResponse(std::move(response));
 }
@@ -0,0 +1,1456 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "MultiPatternMatcher.hpp"
+
+#include <algorithm>
+
+namespace Balau::Network::Http::HttpWebApps::Impl {
+
+namespace {
+
+using Instruction = MultiPatternMatcher::Instruction;
+using Op = MultiPatternMatcher::Op;
+
+// Thrown by the parser and compiler when a pattern uses syntax that is not
+// supported by the compiled matcher. The pattern then falls back to std::regex.
+struct UnsupportedPattern {};
+
+// The maximum number of instructions generated for a single pattern.
+const size_t MaxPatternInstructions = 4096;
+
+const unsigned NoPosition = std::numeric_limits<unsigned>::max();
+
+struct Node {
+	enum class Type { Empty, Char, Any, Class, Concat, Alternate, Repeat, Group, Begin, End };
+
+	Type type;
+	unsigned char c = 0;
+	std::bitset<256> bits;
+	std::vector<std::unique_ptr<Node>> children;
+	int min = 0;
+	int max = -1;
+	bool greedy = true;
+	size_t group = 0;
+
+	explicit Node(Type type_) : type(type_) {}
+};
+
+using NodePtr = std::unique_ptr<Node>;
+
+NodePtr makeNode(Node::Type type) {
+	return std::make_unique<Node>(type);
+}
+
+std::bitset<256> digitBits() {
+	std::bitset<256> bits;
+
+	for (unsigned c = '0'; c <= '9'; ++c) {
+		bits.set(c);
+	}
+
+	return bits;
+}
+
+std::bitset<256> wordBits() {
+	std::bitset<256> bits = digitBits();
+
+	for (unsigned c = 'a'; c <= 'z'; ++c) {
+		bits.set(c);
+		bits.set(c - 'a' + 'A');
+	}
+
+	bits.set('_');
+	return bits;
+}
+
+std::bitset<256> spaceBits() {
+	std::bitset<256> bits;
+	bits.set(' ');
+	bits.set('\t');
+	bits.set('\n');
+	bits.set('\v');
+	bits.set('\f');
+	bits.set('\r');
+	return bits;
+}
+
+int hexValue(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	} else if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+
+	throw UnsupportedPattern();
+}
+
+//
+// Recursive descent parser for the supported ECMAScript subset.
+//
+// Any construct that is not supported or that is ambiguous between ECMAScript
+// implementations results in an UnsupportedPattern exception, so that the
+// std::regex implementation has the final say on such patterns.
+//
+class Parser {
+	public: explicit Parser(std::string_view pattern_) : pattern(pattern_) {}
+
+	public: NodePtr parse() {
+		auto node = parseAlternation();
+
+		if (position != pattern.length()) {
+			throw UnsupportedPattern();
+		}
+
+		return node;
+	}
+
+	public: size_t groupCount = 0;
+
+	private: NodePtr parseAlternation() {
+		auto first = parseConcatenation();
+
+		if (!more() || peek() != '|') {
+			return first;
+		}
+
+		auto node = makeNode(Node::Type::Alternate);
+		node->children.emplace_back(std::move(first));
+
+		while (more() && peek() == '|') {
+			++position;
+			node->children.emplace_back(parseConcatenation());
+		}
+
+		return node;
+	}
+
+	private: NodePtr parseConcatenation() {
+		auto node = makeNode(Node::Type::Concat);
+
+		while (more() && peek() != '|' && peek() != ')') {
+			node->children.emplace_back(parseRepetition());
+		}
+
+		return node;
+	}
+
+	private: NodePtr parseRepetition() {
+		auto atom = parseAtom();
+
+		if (!more()) {
+			return atom;
+		}
+
+		int min;
+		int max;
+
+		switch (peek()) {
+			case '*': min = 0; max = -1; ++position; break;
+			case '+': min = 1; max = -1; ++position; break;
+			case '?': min = 0; max = 1; ++position; break;
+			case '{': parseBraces(min, max); break;
+			default: return atom;
+		}
+
+		if (atom->type == Node::Type::Begin || atom->type == Node::Type::End) {
+			throw UnsupportedPattern();
+		}
+
+		// ECMAScript rejects empty iterations and resets the captures of each
+		// iteration, which the compiled matcher does not model.
+		if (isNullable(*atom)) {
+			throw UnsupportedPattern();
+		}
+
+		auto node = makeNode(Node::Type::Repeat);
+		node->min = min;
+		node->max = max;
+
+		if (more() && peek() == '?') {
+			node->greedy = false;
+			++position;
+		}
+
+		// Stacked quantifiers are an error in ECMAScript.
+		if (more() && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{')) {
+			throw UnsupportedPattern();
+		}
+
+		node->children.emplace_back(std::move(atom));
+		return node;
+	}
+
+	// True if the node can match the empty string.
+	private: static bool isNullable(const Node & node) {
+		switch (node.type) {
+			case Node::Type::Char:
+			case Node::Type::Any:
+			case Node::Type::Class: {
+				return false;
+			}
+
+			case Node::Type::Concat: {
+				return std::all_of(
+					node.children.begin(), node.children.end(), [] (const NodePtr & child) { return isNullable(*child); }
+				);
+			}
+
+			case Node::Type::Alternate: {
+				return std::any_of(
+					node.children.begin(), node.children.end(), [] (const NodePtr & child) { return isNullable(*child); }
+				);
+			}
+
+			case Node::Type::Repeat: {
+				return node.min == 0 || isNullable(*node.children[0]);
+			}
+
+			case Node::Type::Group: {
+				return isNullable(*node.children[0]);
+			}
+
+			default: {
+				return true;
+			}
+		}
+	}
+
+	private: void parseBraces(int & min, int & max) {
+		++position;
+		min = parseInteger();
+		max = min;
+
+		if (more() && peek() == ',') {
+			++position;
+			max = more() && peek() == '}' ? -1 : parseInteger();
+		}
+
+		if (!more() || peek() != '}' || (max != -1 && max < min)) {
+			throw UnsupportedPattern();
+		}
+
+		++position;
+	}
+
+	private: int parseInteger() {
+		const size_t start = position;
+		int value = 0;
+
+		while (more() && peek() >= '0' && peek() <= '9') {
+			value = value * 10 + (peek() - '0');
+
+			if (value > (int) MaxPatternInstructions) {
+				throw UnsupportedPattern();
+			}
+
+			++position;
+		}
+
+		if (position == start) {
+			throw UnsupportedPattern();
+		}
+
+		return value;
+	}
+
+	private: NodePtr parseAtom() {
+		const char c = pattern[position++];
+
+		switch (c) {
+			case '(': {
+				NodePtr node;
+
+				if (more() && peek() == '?') {
+					if (position + 1 < pattern.length() && pattern[position + 1] == ':') {
+						position += 2;
+						node = parseAlternation();
+					} else {
+						throw UnsupportedPattern();
+					}
+				} else {
+					node = makeNode(Node::Type::Group);
+					node->group = ++groupCount;
+					node->children.emplace_back(parseAlternation());
+				}
+
+				if (!more() || peek() != ')') {
+					throw UnsupportedPattern();
+				}
+
+				++position;
+				return node;
+			}
+
+			case '[': {
+				return parseClass();
+			}
+
+			case '.': {
+				return makeNode(Node::Type::Any);
+			}
+
+			case '^': {
+				return makeNode(Node::Type::Begin);
+			}
+
+			case '$': {
+				return makeNode(Node::Type::End);
+			}
+
+			case '\\': {
+				return parseEscape(false);
+			}
+
+			case ')': case ']': case '}': case '*': case '+': case '?': case '{': {
+				throw UnsupportedPattern();
+			}
+
+			default: {
+				auto node = makeNode(Node::Type::Char);
+				node->c = (unsigned char) c;
+				return node;
+			}
+		}
+	}
+
+	// Parses an escape sequence, the leading backslash having been consumed.
+	private: NodePtr parseEscape(bool inClass) {
+		if (!more()) {
+			throw UnsupportedPattern();
+		}
+
+		const char c = pattern[position++];
+
+		switch (c) {
+			case 'd': return classNode(digitBits(), false);
+			case 'D': return classNode(digitBits(), true);
+			case 'w': return classNode(wordBits(), false);
+			case 'W': return classNode(wordBits(), true);
+			case 's': return classNode(spaceBits(), false);
+			case 'S': return classNode(spaceBits(), true);
+			case 't': return charNode('\t');
+			case 'n': return charNode('\n');
+			case 'r': return charNode('\r');
+			case 'f': return charNode('\f');
+			case 'v': return charNode('\v');
+
+			case 'b': {
+				// Backspace inside a class, word boundary assertion outside.
+				if (inClass) {
+					return charNode('\b');
+				}
+
+				throw UnsupportedPattern();
+			}
+
+			case '0': {
+				if (more() && peek() >= '0' && peek() <= '9') {
+					throw UnsupportedPattern();
+				}
+
+				return charNode('\0');
+			}
+
+			case 'x': {
+				if (position + 2 > pattern.length()) {
+					throw UnsupportedPattern();
+				}
+
+				const int value = hexValue(pattern[position]) * 16 + hexValue(pattern[position + 1]);
+				position += 2;
+				return charNode((unsigned char) value);
+			}
+
+			default: {
+				// Back references, unicode escapes, control escapes, and identity
+				// escapes of alphanumeric characters are not supported.
+				if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+					throw UnsupportedPattern();
+				}
+
+				return charNode((unsigned char) c);
+			}
+		}
+	}
+
+	private: NodePtr parseClass() {
+		auto node = makeNode(Node::Type::Class);
+		bool negate = false;
+
+		if (more() && peek() == '^') {
+			negate = true;
+			++position;
+		}
+
+		while (true) {
+			if (!more()) {
+				throw UnsupportedPattern();
+			}
+
+			if (peek() == ']') {
+				++position;
+				break;
+			}
+
+			// POSIX classes, equivalence classes, and collating elements.
+			if (peek() == '[') {
+				throw UnsupportedPattern();
+			}
+
+			auto first = parseClassAtom();
+
+			if (first->type == Node::Type::Class) {
+				node->bits |= first->bits;
+				continue;
+			}
+
+			if (more() && peek() == '-' && position + 1 < pattern.length() && pattern[position + 1] != ']') {
+				++position;
+				auto last = parseClassAtom();
+
+				// Ranges involving class escapes or non-ASCII bytes are left to std::regex.
+				if (last->type == Node::Type::Class || first->c > last->c || last->c >= 0x80) {
+					throw UnsupportedPattern();
+				}
+
+				for (unsigned m = first->c; m <= last->c; ++m) {
+					node->bits.set(m);
+				}
+			} else {
+				node->bits.set(first->c);
+			}
+		}
+
+		if (negate) {
+			node->bits.flip();
+		}
+
+		return node;
+	}
+
+	private: NodePtr parseClassAtom() {
+		const char c = pattern[position++];
+
+		if (c == '\\') {
+			return parseEscape(true);
+		}
+
+		return charNode((unsigned char) c);
+	}
+
+	private: static NodePtr charNode(unsigned char c) {
+		auto node = makeNode(Node::Type::Char);
+		node->c = c;
+		return node;
+	}
+
+	private: static NodePtr classNode(std::bitset<256> bits, bool negate) {
+		auto node = makeNode(Node::Type::Class);
+		node->bits = negate ? ~bits : bits;
+		return node;
+	}
+
+	private: bool more() const {
+		return position < pattern.length();
+	}
+
+	private: char peek() const {
+		return pattern[position];
+	}
+
+	private: const std::string_view pattern;
+	private: size_t position = 0;
+};
+
+//
+// Returns true and sets the literal string if the parsed pattern is a plain literal,
+// optionally anchored with ^ and $.
+//
+bool extractLiteral(const Node & root, std::string & literal) {
+	if (root.type == Node::Type::Char) {
+		literal.assign(1, (char) root.c);
+		return true;
+	}
+
+	if (root.type != Node::Type::Concat) {
+		return false;
+	}
+
+	const auto & children = root.children;
+	size_t start = 0;
+	size_t end = children.size();
+
+	if (start < end && children[start]->type == Node::Type::Begin) {
+		++start;
+	}
+
+	if (start < end && children[end - 1]->type == Node::Type::End) {
+		--end;
+	}
+
+	literal.clear();
+
+	for (size_t m = start; m < end; ++m) {
+		if (children[m]->type != Node::Type::Char) {
+			return false;
+		}
+
+		literal.push_back((char) children[m]->c);
+	}
+
+	return true;
+}
+
+//
+// Compiles a parsed pattern into instructions that are appended to the program.
+//
+class Compiler {
+	public: Compiler(std::vector<Instruction> & program_, std::vector<std::bitset<256>> & classes_)
+		: program(program_)
+		, classes(classes_)
+		, start(program_.size()) {}
+
+	public: void compile(const Node & node) {
+		switch (node.type) {
+			case Node::Type::Empty: {
+				break;
+			}
+
+			case Node::Type::Char: {
+				emit(Op::Char, node.c);
+				break;
+			}
+
+			case Node::Type::Any: {
+				emit(Op::Any);
+				break;
+			}
+
+			case Node::Type::Class: {
+				classes.push_back(node.bits);
+				emit(Op::Class, 0, (uint32_t) (classes.size() - 1));
+				break;
+			}
+
+			case Node::Type::Begin: {
+				emit(Op::AssertBegin);
+				break;
+			}
+
+			case Node::Type::End: {
+				emit(Op::AssertEnd);
+				break;
+			}
+
+			case Node::Type::Concat: {
+				for (const auto & child : node.children) {
+					compile(*child);
+				}
+
+				break;
+			}
+
+			case Node::Type::Alternate: {
+				std::vector<size_t> jumps;
+
+				for (size_t m = 0; m < node.children.size(); ++m) {
+					if (m + 1 < node.children.size()) {
+						const size_t split = emit(Op::Split);
+						program[split].x = here();
+						compile(*node.children[m]);
+						jumps.push_back(emit(Op::Jump));
+						program[split].y = here();
+					} else {
+						compile(*node.children[m]);
+					}
+				}
+
+				for (const auto jump : jumps) {
+					program[jump].x = here();
+				}
+
+				break;
+			}
+
+			case Node::Type::Group: {
+				emit(Op::Save, 0, (uint32_t) (node.group * 2));
+				compile(*node.children[0]);
+				emit(Op::Save, 0, (uint32_t) (node.group * 2 + 1));
+				break;
+			}
+
+			case Node::Type::Repeat: {
+				compileRepeat(node);
+				break;
+			}
+		}
+	}
+
+	private: void compileRepeat(const Node & node) {
+		const Node & child = *node.children[0];
+
+		for (int m = 0; m < node.min; ++m) {
+			compile(child);
+		}
+
+		if (node.max == -1) {
+			// L1: split L2, L3; L2: child; jump L1; L3:
+			const size_t split = emit(Op::Split);
+			const uint32_t body = here();
+			compile(child);
+			emit(Op::Jump, 0, (uint32_t) split);
+			setSplit(split, body, here(), node.greedy);
+		} else {
+			// Nested optionals, all of which exit to the same label.
+			std::vector<std::pair<size_t, uint32_t>> splits;
+
+			for (int m = node.min; m < node.max; ++m) {
+				const size_t split = emit(Op::Split);
+				splits.emplace_back(split, here());
+				compile(child);
+			}
+
+			for (const auto & split : splits) {
+				setSplit(split.first, split.second, here(), node.greedy);
+			}
+		}
+	}
+
+	private: void setSplit(size_t split, uint32_t body, uint32_t exit, bool greedy) {
+		program[split].x = greedy ? body : exit;
+		program[split].y = greedy ? exit : body;
+	}
+
+	private: size_t emit(Op op, unsigned char c = 0, uint32_t x = 0) {
+		if (program.size() - start >= MaxPatternInstructions) {
+			throw UnsupportedPattern();
+		}
+
+		program.push_back(Instruction { op, c, x, 0 });
+		return program.size() - 1;
+	}
+
+	private: uint32_t here() const {
+		return (uint32_t) program.size();
+	}
+
+	private: std::vector<Instruction> & program;
+	private: std::vector<std::bitset<256>> & classes;
+	private: const size_t start;
+};
+
+// A list of NFA threads, stored in flat arrays.
+struct ThreadList {
+	std::vector<uint32_t> pcs;
+	std::vector<unsigned> captures;
+	size_t count = 0;
+
+	void prepare(size_t programSize, size_t slotCount) {
+		if (pcs.size() < programSize) {
+			pcs.resize(programSize);
+		}
+
+		if (captures.size() < programSize * slotCount) {
+			captures.resize(programSize * slotCount);
+		}
+
+		count = 0;
+	}
+};
+
+// Scratch space used by the NFA simulation, allocated once per thread.
+struct NfaScratch {
+	ThreadList current;
+	ThreadList next;
+	std::vector<unsigned> working;
+	std::vector<uint32_t> marks;
+	uint32_t generation = 0;
+
+	void prepare(size_t programSize, size_t slotCount) {
+		current.prepare(programSize, slotCount);
+		next.prepare(programSize, slotCount);
+
+		if (marks.size() < programSize) {
+			marks.resize(programSize, 0);
+		}
+
+		working.assign(slotCount, NoPosition);
+	}
+
+	// Generations increase monotonically per thread, so marks left by
+	// other matchers on the same thread are never mistaken for current ones.
+	void nextGeneration() {
+		if (++generation == 0) {
+			std::fill(marks.begin(), marks.end(), 0);
+			generation = 1;
+		}
+	}
+};
+
+thread_local NfaScratch nfaScratch;
+
+//
+// Pike VM simulation of the NFA program, with capture tracking.
+//
+// Threads are kept in priority order, so the first thread that reaches a match
+// instruction at the end of the input provides the ECMAScript leftmost capture
+// groups, and also identifies the lowest index pattern that matches.
+//
+class NfaSimulation {
+	public: NfaSimulation(const std::vector<Instruction> & program_,
+	                      const std::vector<std::bitset<256>> & classes_,
+	                      size_t slotCount_,
+	                      std::string_view input_,
+	                      NfaScratch & scratch_)
+		: program(program_)
+		, classes(classes_)
+		, slotCount(slotCount_)
+		, input(input_)
+		, scratch(scratch_) {}
+
+	// Returns the pattern index of the match and copies the captures, or NoMatch.
+	public: size_t run(const uint32_t * entryPcs, size_t entryCount, std::vector<unsigned> & captures) {
+		scratch.prepare(program.size(), slotCount);
+		scratch.nextGeneration();
+
+		ThreadList * current = &scratch.current;
+		ThreadList * next = &scratch.next;
+
+		for (size_t m = 0; m < entryCount; ++m) {
+			addThread(*current, entryPcs[m], 0);
+		}
+
+		const size_t length = input.length();
+
+		for (size_t position = 0; position <= length && current->count != 0; ++position) {
+			scratch.nextGeneration();
+			next->count = 0;
+
+			const auto c = position < length ? (unsigned char) input[position] : (unsigned char) 0;
+
+			for (size_t t = 0; t < current->count; ++t) {
+				const uint32_t pc = current->pcs[t];
+				const Instruction & instruction = program[pc];
+				const unsigned * threadCaptures = &current->captures[t * slotCount];
+				bool advance = false;
+
+				switch (instruction.op) {
+					case Op::Match: {
+						if (position == length) {
+							// Highest priority match. Lower priority threads are cut.
+							captures.assign(threadCaptures, threadCaptures + slotCount);
+							return instruction.x;
+						}
+
+						break;
+					}
+
+					case Op::Char: advance = position < length && c == instruction.c; break;
+					case Op::Any: advance = position < length && c != '\n' && c != '\r'; break;
+					case Op::Class: advance = position < length && classes[instruction.x].test(c); break;
+					default: break;
+				}
+
+				if (advance) {
+					std::copy(threadCaptures, threadCaptures + slotCount, scratch.working.begin());
+					addThread(*next, pc + 1, (unsigned) position + 1);
+				}
+			}
+
+			std::swap(current, next);
+		}
+
+		return MultiPatternMatcher::NoMatch;
+	}
+
+	// Follows the epsilon transitions from the pc, using the working captures.
+	private: void addThread(ThreadList & list, uint32_t pc, unsigned position) {
+		while (true) {
+			if (scratch.marks[pc] == scratch.generation) {
+				return;
+			}
+
+			scratch.marks[pc] = scratch.generation;
+
+			const Instruction & instruction = program[pc];
+
+			switch (instruction.op) {
+				case Op::Jump: {
+					pc = instruction.x;
+					continue;
+				}
+
+				case Op::Split: {
+					addThread(list, instruction.x, position);
+					pc = instruction.y;
+					continue;
+				}
+
+				case Op::Save: {
+					const unsigned previous = scratch.working[instruction.x];
+					scratch.working[instruction.x] = position;
+					addThread(list, pc + 1, position);
+					scratch.working[instruction.x] = previous;
+					return;
+				}
+
+				case Op::AssertBegin: {
+					if (position != 0) {
+						return;
+					}
+
+					++pc;
+					continue;
+				}
+
+				case Op::AssertEnd: {
+					if (position != input.length()) {
+						return;
+					}
+
+					++pc;
+					continue;
+				}
+
+				default: {
+					list.pcs[list.count] = pc;
+					std::copy(scratch.working.begin(), scratch.working.end(), &list.captures[list.count * slotCount]);
+					++list.count;
+					return;
+				}
+			}
+		}
+	}
+
+	private: const std::vector<Instruction> & program;
+	private: const std::vector<std::bitset<256>> & classes;
+	private: const size_t slotCount;
+	private: const std::string_view input;
+	private: NfaScratch & scratch;
+};
+
+// Scratch space used by the backtracker, allocated once per thread.
+struct BacktrackScratch {
+	struct Job {
+		uint32_t pc;
+		unsigned position;
+		uint32_t slot;      // NoPosition for a thread job, otherwise the capture slot to restore.
+	};
+
+	std::vector<uint64_t> visited;
+	std::vector<Job> jobs;
+	std::vector<unsigned> captures;
+};
+
+thread_local BacktrackScratch backtrackScratch;
+
+// The maximum size of the visited bitmap used by the backtracker.
+const size_t MaxBacktrackStates = 256 * 1024;
+
+//
+// Bounded backtracking simulation of a single pattern, with capture tracking.
+//
+// The backtracker explores the alternatives in priority order and returns the
+// first path that matches at the end of the input. It thus provides the same
+// captures as the Pike VM. Each (pc, position) pair is visited at most once,
+// which bounds the running time to the size of the visited bitmap.
+//
+class Backtracker {
+	public: Backtracker(const std::vector<Instruction> & program_,
+	                    const std::vector<std::bitset<256>> & classes_,
+	                    size_t slotCount_,
+	                    std::string_view input_,
+	                    BacktrackScratch & scratch_)
+		: program(program_)
+		, classes(classes_)
+		, slotCount(slotCount_)
+		, input(input_)
+		, scratch(scratch_) {}
+
+	public: static bool canRun(size_t patternLength, size_t inputLength) {
+		return patternLength * (inputLength + 1) <= MaxBacktrackStates;
+	}
+
+	// Returns true and sets the captures if the pattern starting at the entry pc matches.
+	public: bool run(uint32_t entry, size_t patternLength, std::vector<unsigned> & captures) {
+		const size_t length = input.length();
+		const size_t stride = length + 1;
+
+		scratch.visited.assign((patternLength * stride + 63) / 64, 0);
+		scratch.captures.assign(slotCount, NoPosition);
+		scratch.jobs.clear();
+		scratch.jobs.push_back({ entry, 0, NoPosition });
+
+		while (!scratch.jobs.empty()) {
+			const auto job = scratch.jobs.back();
+			scratch.jobs.pop_back();
+
+			if (job.slot != NoPosition) {
+				scratch.captures[job.slot] = job.position;
+				continue;
+			}
+
+			uint32_t pc = job.pc;
+			unsigned position = job.position;
+
+			while (true) {
+				const size_t index = (pc - entry) * stride + position;
+				uint64_t & word = scratch.visited[index / 64];
+				const uint64_t bit = (uint64_t) 1 << (index % 64);
+
+				if (word & bit) {
+					break;
+				}
+
+				word |= bit;
+
+				const Instruction & instruction = program[pc];
+				const auto c = position < length ? (unsigned char) input[position] : (unsigned char) 0;
+				bool advance = false;
+
+				switch (instruction.op) {
+					case Op::Char: advance = position < length && c == instruction.c; break;
+					case Op::Any: advance = position < length && c != '\n' && c != '\r'; break;
+					case Op::Class: advance = position < length && classes[instruction.x].test(c); break;
+
+					case Op::Split: {
+						scratch.jobs.push_back({ instruction.y, position, NoPosition });
+						pc = instruction.x;
+						continue;
+					}
+
+					case Op::Jump: {
+						pc = instruction.x;
+						continue;
+					}
+
+					case Op::Save: {
+						scratch.jobs.push_back({ 0, scratch.captures[instruction.x], instruction.x });
+						scratch.captures[instruction.x] = position;
+						++pc;
+						continue;
+					}
+
+					case Op::AssertBegin: {
+						if (position == 0) {
+							++pc;
+							continue;
+						}
+
+						break;
+					}
+
+					case Op::AssertEnd: {
+						if (position == length) {
+							++pc;
+							continue;
+						}
+
+						break;
+					}
+
+					case Op::Match: {
+						if (position == length) {
+							captures.assign(scratch.captures.begin(), scratch.captures.end());
+							return true;
+						}
+
+						break;
+					}
+				}
+
+				if (!advance) {
+					break;
+				}
+
+				++pc;
+				++position;
+			}
+		}
+
+		return false;
+	}
+
+	private: const std::vector<Instruction> & program;
+	private: const std::vector<std::bitset<256>> & classes;
+	private: const size_t slotCount;
+	private: const std::string_view input;
+	private: BacktrackScratch & scratch;
+};
+
+} // namespace
+
+MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string> & patternStrings)
+	: trie(1)
+	, dfaStates(new DfaState[MaxDfaStates]) {
+	patterns.reserve(patternStrings.size());
+
+	for (size_t index = 0; index < patternStrings.size(); ++index) {
+		const auto & patternString = patternStrings[index];
+
+		// Validate the pattern with the standard library, so that invalid
+		// patterns are reported in the same way as with std::regex matching.
+		auto regex = std::make_unique<std::regex>(patternString);
+
+		Pattern pattern { Kind::Fallback, regex->mark_count(), 0, 0, nullptr };
+		const size_t programSize = program.size();
+		const size_t classCount = classes.size();
+
+		try {
+			Parser parser(patternString);
+			auto root = parser.parse();
+			std::string literal;
+
+			if (parser.groupCount != pattern.groupCount) {
+				throw UnsupportedPattern();
+			} else if (pattern.groupCount == 0 && extractLiteral(*root, literal)) {
+				pattern.kind = Kind::Literal;
+				insertLiteral(literal, index);
+			} else {
+				pattern.kind = Kind::Compiled;
+				pattern.entry = (uint32_t) program.size();
+				Compiler(program, classes).compile(*root);
+				program.push_back(Instruction { Op::Match, 0, (uint32_t) index, 0 });
+				pattern.length = (uint32_t) (program.size() - pattern.entry);
+				entries.push_back(pattern.entry);
+				firstCompiled = std::min(firstCompiled, index);
+				slotCount = std::max(slotCount, (pattern.groupCount + 1) * 2);
+			}
+		} catch (const UnsupportedPattern & ) {
+			program.resize(programSize);
+			classes.resize(classCount);
+			pattern.kind = Kind::Fallback;
+			pattern.regex = std::move(regex);
+			fallbacks.push_back(index);
+		}
+
+		patterns.emplace_back(std::move(pattern));
+	}
+
+	compileByteClasses();
+
+	dfaMarks.resize(program.size(), 0);
+	acceptMarks.resize(program.size(), 0);
+	deadState = findOrCreateState({});
+
+	std::vector<uint32_t> startPcs;
+	++dfaGeneration;
+
+	for (const auto entry : entries) {
+		closure(entry, true, startPcs);
+	}
+
+	std::sort(startPcs.begin(), startPcs.end());
+	startState = findOrCreateState(std::move(startPcs));
+}
+
+size_t MultiPatternMatcher::match(std::string_view input, std::vector<std::string_view> & groups) const {
+	groups.clear();
+
+	size_t winner = matchLiteral(input);
+
+	// The compiled patterns are only run if one of them could beat the literal match.
+	if (firstCompiled < winner) {
+		bool cacheFull = false;
+		size_t compiledWinner = NoMatch;
+
+		// The empty input is handled by the NFA, as it may require the begin and end assertions together.
+		if (!input.empty()) {
+			compiledWinner = matchDfa(input, cacheFull);
+		}
+
+		if (input.empty() || cacheFull) {
+			std::vector<std::string_view> compiledGroups;
+			compiledWinner = runNfa(input, entries.data(), entries.size(), compiledGroups);
+
+			if (compiledWinner < winner) {
+				groups = std::move(compiledGroups);
+				winner = compiledWinner;
+			}
+		} else if (compiledWinner < winner) {
+			winner = compiledWinner;
+
+			if (patterns[winner].groupCount > 0) {
+				extractGroups(input, winner, groups);
+			}
+		}
+	}
+
+	for (const auto index : fallbacks) {
+		if (index >= winner) {
+			break;
+		}
+
+		std::cmatch results;
+
+		if (std::regex_match(input.data(), input.data() + input.length(), results, *patterns[index].regex)) {
+			groups.clear();
+
+			for (size_t m = 1; m < results.size(); ++m) {
+				groups.emplace_back(
+					results[m].matched ? std::string_view(results[m].first, (size_t) results[m].length()) : std::string_view()
+				);
+			}
+
+			return index;
+		}
+	}
+
+	if (winner != NoMatch && groups.size() != patterns[winner].groupCount) {
+		groups.resize(patterns[winner].groupCount);
+	}
+
+	return winner;
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+void MultiPatternMatcher::compileByteClasses() {
+	std::bitset<257> boundaries;
+	boundaries.set(0);
+
+	const auto addBoundary = [&boundaries] (unsigned c) {
+		boundaries.set(c);
+		boundaries.set(c + 1);
+	};
+
+	for (const auto & instruction : program) {
+		switch (instruction.op) {
+			case Op::Char: {
+				addBoundary(instruction.c);
+				break;
+			}
+
+			case Op::Any: {
+				addBoundary('\n');
+				addBoundary('\r');
+				break;
+			}
+
+			case Op::Class: {
+				const auto & bits = classes[instruction.x];
+
+				for (unsigned c = 1; c < 256; ++c) {
+					if (bits.test(c) != bits.test(c - 1)) {
+						boundaries.set(c);
+					}
+				}
+
+				break;
+			}
+
+			default: {
+				break;
+			}
+		}
+	}
+
+	unsigned byteClass = 0;
+
+	for (unsigned c = 0; c < 256; ++c) {
+		if (c > 0 && boundaries.test(c)) {
+			++byteClass;
+		}
+
+		if (byteClass == byteClassRepresentatives.size()) {
+			byteClassRepresentatives.push_back((unsigned char) c);
+		}
+
+		byteClasses[c] = (unsigned char) byteClass;
+	}
+}
+
+void MultiPatternMatcher::insertLiteral(const std::string & literal, size_t patternIndex) {
+	uint32_t node = 0;
+
+	for (const char ch : literal) {
+		const auto c = (unsigned char) ch;
+		auto & children = trie[node].children;
+
+		auto iter = std::lower_bound(
+			children.begin(), children.end(), c, [] (const auto & child, unsigned char value) { return child.first < value; }
+		);
+
+		if (iter != children.end() && iter->first == c) {
+			node = iter->second;
+		} else {
+			const auto child = (uint32_t) trie.size();
+			children.emplace(iter, c, child);
+			trie.emplace_back();
+			node = child;
+		}
+	}
+
+	// The first pattern with a given literal wins.
+	trie[node].pattern = std::min(trie[node].pattern, patternIndex);
+}
+
+size_t MultiPatternMatcher::matchLiteral(std::string_view input) const {
+	uint32_t node = 0;
+
+	for (const char ch : input) {
+		const auto c = (unsigned char) ch;
+		const auto & children = trie[node].children;
+
+		auto iter = std::lower_bound(
+			children.begin(), children.end(), c, [] (const auto & child, unsigned char value) { return child.first < value; }
+		);
+
+		if (iter == children.end() || iter->first != c) {
+			return NoMatch;
+		}
+
+		node = iter->second;
+	}
+
+	return trie[node].pattern;
+}
+
+size_t MultiPatternMatcher::matchDfa(std::string_view input, bool & cacheFull) const {
+	int32_t state = startState;
+
+	for (const char ch : input) {
+		const size_t byteClass = byteClasses[(unsigned char) ch];
+		int32_t next = dfaStates[state].next[byteClass].load(std::memory_order_acquire);
+
+		if (next == UnknownState) {
+			std::lock_guard<std::mutex> lock(dfaMutex);
+			next = computeTransition(state, byteClass);
+		}
+
+		if (next == CacheFull) {
+			cacheFull = true;
+			return NoMatch;
+		} else if (next == deadState) {
+			return NoMatch;
+		}
+
+		state = next;
+	}
+
+	return dfaStates[state].acceptPattern;
+}
+
+int32_t MultiPatternMatcher::computeTransition(int32_t stateIndex, size_t byteClass) const {
+	DfaState & state = dfaStates[stateIndex];
+
+	// Another thread may have computed the transition whilst this thread was waiting.
+	const int32_t existing = state.next[byteClass].load(std::memory_order_relaxed);
+
+	if (existing != UnknownState) {
+		return existing;
+	}
+
+	const unsigned char c = byteClassRepresentatives[byteClass];
+	std::vector<uint32_t> pcs;
+
+	++dfaGeneration;
+
+	for (const auto pc : state.pcs) {
+		const Instruction & instruction = program[pc];
+		bool advance = false;
+
+		switch (instruction.op) {
+			case Op::Char: advance = c == instruction.c; break;
+			case Op::Any: advance = c != '\n' && c != '\r'; break;
+			case Op::Class: advance = classes[instruction.x].test(c); break;
+			default: break;
+		}
+
+		if (advance) {
+			closure(pc + 1, false, pcs);
+		}
+	}
+
+	std::sort(pcs.begin(), pcs.end());
+	const int32_t next = findOrCreateState(std::move(pcs));
+
+	if (next != CacheFull) {
+		state.next[byteClass].store(next, std::memory_order_release);
+	}
+
+	return next;
+}
+
+int32_t MultiPatternMatcher::findOrCreateState(std::vector<uint32_t> && pcs) const {
+	auto iter = dfaStateIndex.find(pcs);
+
+	if (iter != dfaStateIndex.end()) {
+		return iter->second;
+	}
+
+	const size_t count = dfaStateCount.load(std::memory_order_relaxed);
+
+	if (count == MaxDfaStates) {
+		return CacheFull;
+	}
+
+	const auto stateIndex = (int32_t) count;
+	DfaState & state = dfaStates[stateIndex];
+	state.acceptPattern = NoMatch;
+
+	for (const auto pc : pcs) {
+		state.acceptPattern = std::min(state.acceptPattern, acceptsAtEnd(pc));
+	}
+
+	const size_t byteClassCount = byteClassRepresentatives.size();
+	state.next.reset(new std::atomic<int32_t>[byteClassCount]);
+
+	for (size_t m = 0; m < byteClassCount; ++m) {
+		state.next[m].store(pcs.empty() ? stateIndex : UnknownState, std::memory_order_relaxed);
+	}
+
+	state.pcs = pcs;
+	dfaStateIndex.emplace(std::move(pcs), stateIndex);
+	dfaStateCount.store(count + 1, std::memory_order_relaxed);
+	return stateIndex;
+}
+
+void MultiPatternMatcher::closure(uint32_t pc, bool atStart, std::vector<uint32_t> & output) const {
+	if (dfaMarks[pc] == dfaGeneration) {
+		return;
+	}
+
+	dfaMarks[pc] = dfaGeneration;
+
+	const Instruction & instruction = program[pc];
+
+	switch (instruction.op) {
+		case Op::Jump: {
+			closure(instruction.x, atStart, output);
+			break;
+		}
+
+		case Op::Split: {
+			closure(instruction.x, atStart, output);
+			closure(instruction.y, atStart, output);
+			break;
+		}
+
+		case Op::Save: {
+			closure(pc + 1, atStart, output);
+			break;
+		}
+
+		case Op::AssertBegin: {
+			if (atStart) {
+				closure(pc + 1, atStart, output);
+			}
+
+			break;
+		}
+
+		default: {
+			// Consuming instructions, matches, and end assertions, which are resolved in acceptsAtEnd.
+			output.push_back(pc);
+			break;
+		}
+	}
+}
+
+size_t MultiPatternMatcher::acceptsAtEnd(uint32_t pc) const {
+	// Follows the epsilon transitions that are valid at the end of a non-empty input.
+	std::vector<uint32_t> pending { pc };
+	++acceptGeneration;
+
+	while (!pending.empty()) {
+		const uint32_t current = pending.back();
+		pending.pop_back();
+
+		if (acceptMarks[current] == acceptGeneration) {
+			continue;
+		}
+
+		acceptMarks[current] = acceptGeneration;
+
+		const Instruction & instruction = program[current];
+
+		switch (instruction.op) {
+			case Op::Match: return instruction.x;
+			case Op::Jump: pending.push_back(instruction.x); break;
+			case Op::Split: pending.push_back(instruction.y); pending.push_back(instruction.x); break;
+			case Op::Save: case Op::AssertEnd: pending.push_back(current + 1); break;
+			default: break;
+		}
+	}
+
+	return NoMatch;
+}
+
+void MultiPatternMatcher::extractGroups(std::string_view input,
+                                        size_t patternIndex,
+                                        std::vector<std::string_view> & groups) const {
+	const Pattern & pattern = patterns[patternIndex];
+
+	if (!Backtracker::canRun(pattern.length, input.length())) {
+		runNfa(input, &pattern.entry, 1, groups);
+		return;
+	}
+
+	thread_local std::vector<unsigned> captures;
+
+	Backtracker backtracker(program, classes, slotCount, input, backtrackScratch);
+
+	if (!backtracker.run(pattern.entry, pattern.length, captures)) {
+		// Not reached, as the DFA has already determined that the pattern matches.
+		runNfa(input, &pattern.entry, 1, groups);
+		return;
+	}
+
+	setGroups(input, pattern.groupCount, captures, groups);
+}
+
+size_t MultiPatternMatcher::runNfa(std::string_view input,
+                                   const uint32_t * entryPcs,
+                                   size_t entryCount,
+                                   std::vector<std::string_view> & groups) const {
+	thread_local std::vector<unsigned> captures;
+
+	NfaSimulation simulation(program, classes, slotCount, input, nfaScratch);
+	const size_t winner = simulation.run(entryPcs, entryCount, captures);
+
+	groups.clear();
+
+	if (winner != NoMatch) {
+		setGroups(input, patterns[winner].groupCount, captures, groups);
+	}
+
+	return winner;
+}
+
+void MultiPatternMatcher::setGroups(std::string_view input,
+                                    size_t groupCount,
+                                    const std::vector<unsigned> & captures,
+                                    std::vector<std::string_view> & groups) {
+	groups.clear();
+
+	for (size_t group = 1; group <= groupCount; ++group) {
+		const unsigned start = captures[group * 2];
+		const unsigned end = captures[group * 2 + 1];
+
+		groups.emplace_back(
+			start != NoPosition && end != NoPosition ? input.substr(start, end - start) : std::string_view()
+		);
+	}
+}
+
+} // namespace Balau::Network::Http::HttpWebApps::Impl
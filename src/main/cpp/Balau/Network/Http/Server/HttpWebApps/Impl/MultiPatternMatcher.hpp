@@ -0,0 +1,192 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__MULTI_PATTERN_MATCHER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__MULTI_PATTERN_MATCHER
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Balau::Network::Http::HttpWebApps::Impl {
+
+//
+// Matches an input string against an ordered list of ECMAScript regular
+// expressions with a single combined matcher.
+//
+// The patterns are compiled once during construction:
+//  - patterns that are plain literals are placed in a literal trie;
+//  - patterns that use the supported ECMAScript subset (literals, escapes, '.',
+//    character classes, groups, alternation, greedy and lazy quantifiers, and
+//    the ^ and $ anchors) are compiled into a combined NFA program, which is
+//    lazily converted into a DFA as inputs are matched;
+//  - patterns that use other features (back references, lookaheads, word
+//    boundaries, quantified groups that can match the empty string, etc.)
+//    fall back to std::regex.
+//
+// Matching semantics are those of std::regex_match, i.e. the whole input must
+// match. When multiple patterns match, the pattern with the lowest index wins.
+// The capture groups of the winning pattern are then extracted by running an
+// NFA simulation of that pattern only. The matching cost is thus proportional
+// to the input length and is largely independent of the number of patterns.
+//
+// The DFA state cache is bounded. If it becomes full, matching falls back to
+// an NFA simulation of all the compiled patterns.
+//
+// Matching is thread safe. DFA transitions that are already cached are read
+// without locking.
+//
+class MultiPatternMatcher final {
+	//
+	// Returned by match when no pattern matches the input.
+	//
+	public: static constexpr size_t NoMatch = std::numeric_limits<size_t>::max();
+
+	//
+	// The maximum number of cached DFA states.
+	//
+	public: static constexpr size_t MaxDfaStates = 4096;
+
+	//
+	// Compile the supplied patterns.
+	//
+	// @throw std::regex_error if a pattern is not a valid regular expression
+	//
+	public: explicit MultiPatternMatcher(const std::vector<std::string> & patterns);
+
+	public: MultiPatternMatcher(const MultiPatternMatcher & ) = delete;
+	public: MultiPatternMatcher & operator = (const MultiPatternMatcher & ) = delete;
+
+	//
+	// Match the input against the patterns.
+	//
+	// On success, the groups vector is populated with the capture groups 1..n
+	// of the winning pattern. Groups that did not participate in the match are
+	// set to empty views. The views refer to the input string.
+	//
+	// @return the index of the first pattern that matches the input, or NoMatch
+	//
+	public: size_t match(std::string_view input, std::vector<std::string_view> & groups) const;
+
+	//
+	// Get the number of patterns in the matcher.
+	//
+	public: size_t patternCount() const {
+		return patterns.size();
+	}
+
+	//
+	// Get the number of patterns that fell back to std::regex.
+	//
+	public: size_t fallbackCount() const {
+		return fallbacks.size();
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	public: enum class Op : unsigned char {
+		Char, Any, Class, Split, Jump, Save, AssertBegin, AssertEnd, Match
+	};
+
+	public: struct Instruction {
+		Op op;
+		unsigned char c;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	private: enum class Kind { Literal, Compiled, Fallback };
+
+	private: struct Pattern {
+		Kind kind;
+		size_t groupCount;
+		uint32_t entry;
+		uint32_t length;
+		std::unique_ptr<std::regex> regex;
+	};
+
+	private: struct TrieNode {
+		std::vector<std::pair<unsigned char, uint32_t>> children; // Sorted by character.
+		size_t pattern = NoMatch;
+	};
+
+	private: struct DfaState {
+		std::vector<uint32_t> pcs;
+		size_t acceptPattern = NoMatch;
+		std::unique_ptr<std::atomic<int32_t>[]> next;
+	};
+
+	private: static constexpr int32_t UnknownState = -1;
+	private: static constexpr int32_t CacheFull = -2;
+
+	private: void compileByteClasses();
+	private: void insertLiteral(const std::string & literal, size_t patternIndex);
+	private: size_t matchLiteral(std::string_view input) const;
+	private: size_t matchDfa(std::string_view input, bool & cacheFull) const;
+	private: int32_t computeTransition(int32_t stateIndex, size_t byteClass) const;
+	private: int32_t findOrCreateState(std::vector<uint32_t> && pcs) const;
+	private: void closure(uint32_t pc, bool atStart, std::vector<uint32_t> & output) const;
+	private: size_t acceptsAtEnd(uint32_t pc) const;
+
+	private: void extractGroups(std::string_view input, size_t patternIndex, std::vector<std::string_view> & groups) const;
+
+	private: size_t runNfa(std::string_view input,
+	                       const uint32_t * entryPcs,
+	                       size_t entryCount,
+	                       std::vector<std::string_view> & groups) const;
+
+	private: static void setGroups(std::string_view input,
+	                               size_t groupCount,
+	                               const std::vector<unsigned> & captures,
+	                               std::vector<std::string_view> & groups);
+
+	private: std::vector<Pattern> patterns;
+	private: std::vector<TrieNode> trie;
+	private: std::vector<Instruction> program;
+	private: std::vector<std::bitset<256>> classes;
+	private: std::vector<uint32_t> entries;
+	private: std::vector<size_t> fallbacks;
+	private: std::array<unsigned char, 256> byteClasses {};
+	private: std::vector<unsigned char> byteClassRepresentatives;
+	private: size_t firstCompiled = NoMatch;
+	private: size_t slotCount = 2;
+
+	private: std::unique_ptr<DfaState[]> dfaStates;
+	private: mutable std::atomic<size_t> dfaStateCount { 0 };
+	private: mutable std::map<std::vector<uint32_t>, int32_t> dfaStateIndex;
+	private: mutable std::vector<uint32_t> dfaMarks;
+	private: mutable uint32_t dfaGeneration = 0;
+	private: mutable std::vector<uint32_t> acceptMarks;
+	private: mutable uint32_t acceptGeneration = 0;
+	private: mutable std::mutex dfaMutex;
+	private: int32_t startState = 0;
+	private: int32_t deadState = 0;
+};
+
+} // namespace Balau::Network::Http::HttpWebApps::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__MULTI_PATTERN_MATCHER
@@ -0,0 +1,217 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "ResponseCache.hpp"
+
+#include <algorithm>
+
+namespace Balau::Network::Http::HttpWebApps::Impl {
+
+namespace {
+
+// The number of sketch counters per cached kilobyte, bounded below and above.
+const size_t MinimumSketchWidth = 64;
+const size_t MaximumSketchWidth = 1U << 20U;
+
+size_t sketchWidth(size_t maxSize) {
+	size_t width = MinimumSketchWidth;
+
+	while (width < maxSize / 1024 && width < MaximumSketchWidth) {
+		width <<= 1U;
+	}
+
+	return width;
+}
+
+} // namespace
+
+ResponseCache::FrequencySketch::FrequencySketch(size_t width)
+	: counters(width * 4 / 2) // Two four bit counters per byte.
+	, mask(width - 1)
+	, sampleSize(width * 10) {}
+
+void ResponseCache::FrequencySketch::increment(size_t hash) {
+	for (size_t row = 0; row < 4; ++row) {
+		const size_t i = index(hash, row);
+		uint8_t & byte = counters[i / 2];
+		const unsigned shift = (i % 2) * 4;
+		const unsigned value = (byte >> shift) & 0xFU;
+
+		if (value < 15) {
+			byte = (uint8_t) (byte + (1U << shift));
+		}
+	}
+
+	// Age the counters, so that the sketch follows changes in popularity.
+	if (++additions == sampleSize) {
+		for (auto & byte : counters) {
+			byte = (uint8_t) ((byte >> 1U) & 0x77U);
+		}
+
+		additions /= 2;
+	}
+}
+
+unsigned ResponseCache::FrequencySketch::frequency(size_t hash) const {
+	unsigned minimum = 15;
+
+	for (size_t row = 0; row < 4; ++row) {
+		const size_t i = index(hash, row);
+		minimum = std::min(minimum, (unsigned) (counters[i / 2] >> ((i % 2) * 4)) & 0xFU);
+	}
+
+	return minimum;
+}
+
+size_t ResponseCache::FrequencySketch::index(size_t hash, size_t row) const {
+	// Double hashing, with the row's counters placed in its own quarter of the table.
+	const uint64_t h = (uint64_t) hash * 0x9E3779B97F4A7C15ULL;
+	const uint64_t step = (h >> 32U) | 1U;
+	return row * (mask + 1) + ((h + row * step) & mask);
+}
+
+ResponseCache::ResponseCache(size_t maxSize_, Admission admission_)
+	: maxSize(maxSize_)
+	, admission(admission_)
+	, sketch(sketchWidth(maxSize_)) {}
+
+ResponseCache::LookupResult ResponseCache::lookup(const std::string & key,
+                                                  std::chrono::milliseconds now,
+                                                  bool coalesce,
+                                                  const std::function<Waiter ()> & createWaiter,
+                                                  std::shared_ptr<const Entry> & entry) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (admission == Admission::TinyLfu) {
+		sketch.increment(std::hash<std::string>()(key));
+	}
+
+	auto iter = index.find(key);
+
+	if (iter != index.end()) {
+		if (iter->second->entry->expiresAt > now) {
+			lru.splice(lru.begin(), lru, iter->second);
+			entry = iter->second->entry;
+			++counts.hits;
+			return LookupResult::Hit;
+		}
+
+		erase(iter);
+	}
+
+	++counts.misses;
+
+	if (!coalesce) {
+		return LookupResult::Miss;
+	}
+
+	auto pendingIter = pending.find(key);
+
+	if (pendingIter != pending.end()) {
+		pendingIter->second.emplace_back(createWaiter());
+		++counts.coalesced;
+		return LookupResult::Waiting;
+	}
+
+	// The caller becomes the leader for the key.
+	pending.emplace(key, std::vector<Waiter>());
+	return LookupResult::Miss;
+}
+
+std::shared_ptr<const ResponseCache::Entry> ResponseCache::peek(const std::string & key, std::chrono::milliseconds now) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto iter = index.find(key);
+
+	if (iter == index.end() || iter->second->entry->expiresAt <= now) {
+		return nullptr;
+	}
+
+	return iter->second->entry;
+}
+
+void ResponseCache::complete(const std::string & key, std::shared_ptr<const Entry> entry) {
+	std::vector<Waiter> waiters;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (entry) {
+			insert(key, entry);
+		}
+
+		auto pendingIter = pending.find(key);
+
+		if (pendingIter != pending.end()) {
+			waiters = std::move(pendingIter->second);
+			pending.erase(pendingIter);
+		}
+	}
+
+	for (auto & waiter : waiters) {
+		waiter(entry);
+	}
+}
+
+ResponseCache::Statistics ResponseCache::statistics() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	Statistics statistics = counts;
+	statistics.entries = index.size();
+	statistics.size = size;
+	return statistics;
+}
+
+void ResponseCache::insert(const std::string & key, std::shared_ptr<const Entry> entry) {
+	if (entry->size > maxSize) {
+		++counts.rejected;
+		return;
+	}
+
+	auto existing = index.find(key);
+
+	if (existing != index.end()) {
+		erase(existing);
+	}
+
+	if (size + entry->size > maxSize && admission == Admission::TinyLfu && !lru.empty()) {
+		const auto & victim = lru.back();
+		const unsigned candidateFrequency = sketch.frequency(std::hash<std::string>()(key));
+		const unsigned victimFrequency = sketch.frequency(std::hash<std::string>()(victim.key));
+
+		if (candidateFrequency <= victimFrequency) {
+			++counts.rejected;
+			return;
+		}
+	}
+
+	while (size + entry->size > maxSize) {
+		erase(index.find(lru.back().key));
+		++counts.evictions;
+	}
+
+	size += entry->size;
+	lru.push_front(Node { key, std::move(entry) });
+	index.emplace(key, lru.begin());
+}
+
+void ResponseCache::erase(std::unordered_map<std::string, Lru::iterator>::iterator iter) {
+	size -= iter->second->entry->size;
+	lru.erase(iter->second);
+	index.erase(iter);
+}
+
+} // namespace Balau::Network::Http::HttpWebApps::Impl
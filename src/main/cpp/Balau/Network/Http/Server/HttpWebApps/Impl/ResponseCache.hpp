@@ -0,0 +1,148 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__RESPONSE_CACHE
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__RESPONSE_CACHE
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Balau::Network::Http::HttpWebApps::Impl {
+
+//
+// A byte size bounded cache of complete responses, used by CachingHttpWebApp.
+//
+// Entries are evicted in least recently used order. When TinyLFU admission is
+// selected, a new entry that requires an eviction is only admitted if its key
+// has been requested more frequently than the key of the eviction victim. The
+// request frequencies are estimated with a count-min sketch that is aged by
+// halving all the counters periodically.
+//
+// Concurrent misses for the same key are coalesced. The first lookup that misses
+// makes the caller the leader, which computes the response and then completes the
+// key. Subsequent lookups of the key register a waiter, which is called with the
+// completed entry, or with nullptr if the leader's response was not cacheable.
+//
+// The cache is thread safe. Waiters are called without the lock held.
+//
+class ResponseCache final {
+	public: enum class Admission { Lru, TinyLfu };
+
+	public: enum class LookupResult { Hit, Miss, Waiting };
+
+	public: struct Entry {
+		StringResponse response;
+		std::chrono::milliseconds storedAt;
+		std::chrono::milliseconds expiresAt;
+		size_t size;
+	};
+
+	public: using Waiter = std::function<void (std::shared_ptr<const Entry>)>;
+
+	public: struct Statistics {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t coalesced = 0;
+		uint64_t rejected = 0;
+		uint64_t evictions = 0;
+		size_t entries = 0;
+		size_t size = 0;
+	};
+
+	public: ResponseCache(size_t maxSize_, Admission admission_);
+
+	public: ResponseCache(const ResponseCache &) = delete;
+	public: ResponseCache & operator = (const ResponseCache &) = delete;
+
+	//
+	// Look up the entry for the key.
+	//
+	// Returns Hit and sets the entry if an unexpired entry is found. Otherwise, returns
+	// Waiting if coalescing is requested and another caller is computing the response
+	// (the waiter created by createWaiter is then registered), or Miss if the caller must compute the response
+	// and then call complete.
+	//
+	public: LookupResult lookup(const std::string & key,
+	                            std::chrono::milliseconds now,
+	                            bool coalesce,
+	                            const std::function<Waiter ()> & createWaiter,
+	                            std::shared_ptr<const Entry> & entry);
+
+	//
+	// Get the unexpired entry for the key without registering a miss, or nullptr.
+	//
+	public: std::shared_ptr<const Entry> peek(const std::string & key, std::chrono::milliseconds now);
+
+	//
+	// Complete the computation of the response for the key.
+	//
+	// The entry is stored if it is not null and is admitted. The waiters of the key
+	// are then called with the entry.
+	//
+	public: void complete(const std::string & key, std::shared_ptr<const Entry> entry);
+
+	public: Statistics statistics() const;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// Count-min sketch with four rows of saturating four bit counters.
+	private: class FrequencySketch {
+		public: explicit FrequencySketch(size_t width);
+		public: void increment(size_t hash);
+		public: unsigned frequency(size_t hash) const;
+
+		private: size_t index(size_t hash, size_t row) const;
+
+		private: std::vector<uint8_t> counters;
+		private: const size_t mask;
+		private: const size_t sampleSize;
+		private: size_t additions = 0;
+	};
+
+	private: struct Node {
+		std::string key;
+		std::shared_ptr<const Entry> entry;
+	};
+
+	private: using Lru = std::list<Node>;
+
+	private: void insert(const std::string & key, std::shared_ptr<const Entry> entry);
+	private: void erase(std::unordered_map<std::string, Lru::iterator>::iterator iter);
+
+	private: const size_t maxSize;
+	private: const Admission admission;
+	private: mutable std::mutex mutex;
+	private: Lru lru; // Most recently used first.
+	private: std::unordered_map<std::string, Lru::iterator> index;
+	private: std::unordered_map<std::string, std::vector<Waiter>> pending;
+	private: FrequencySketch sketch;
+	private: size_t size = 0;
+	private: Statistics counts;
+};
+
+} // namespace Balau::Network::Http::HttpWebApps::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS_IMPL__RESPONSE_CACHE
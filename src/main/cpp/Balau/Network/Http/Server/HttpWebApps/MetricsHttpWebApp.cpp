@@ -0,0 +1,58 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "MetricsHttpWebApp.hpp"
+#include "../HttpSession.hpp"
+
+namespace Balau::Network::Http::HttpWebApps {
+
+MetricsHttpWebApp::MetricsHttpWebApp(const EnvironmentProperties & , const BalauLogger & ) {}
+
+void MetricsHttpWebApp::handleGetRequest(HttpSession & session,
+                                         const StringRequest & request,
+                                         std::map<std::string, std::string> & ) {
+	Response<StringBody> response {Status::ok, request.version()};
+	session.configuration().headerCache.setCommonHeaders(response);
+	response.set(Field::content_type, ContentType);
+	response.set(Field::cache_control, "no-store");
+	session.configuration().metrics->writePrometheus(response.body());
+	session.configuration().admission->writePrometheus(response.body());
+	response.prepare_payload();
+	response.keep_alive(request.keep_alive());
+	session.sendResponse(std::move(response));
+}
+
+void MetricsHttpWebApp::handleHeadRequest(HttpSession & session,
+                                          const StringRequest & request,
+                                          std::map<std::string, std::string> & ) {
+	Response<EmptyBody> response {Status::ok, request.version()};
+	session.configuration().headerCache.setCommonHeaders(response);
+	response.set(Field::content_type, ContentType);
+	response.set(Field::cache_control, "no-store");
+	response.keep_alive(request.keep_alive());
+	session.sendResponse(std::move(response));
+}
+
+void MetricsHttpWebApp::handlePostRequest(HttpSession & session,
+                                          const StringRequest & request,
+                                          std::map<std::string, std::string> & ) {
+	session.sendResponse(createBadRequestResponse(session, request, "Not supported"));
+}
+
+} // namespace Balau::Network::Http::HttpWebApps
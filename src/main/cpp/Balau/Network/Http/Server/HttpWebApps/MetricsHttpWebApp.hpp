@@ -0,0 +1,80 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file MetricsHttpWebApp.hpp
+///
+/// An HTTP web application handler that serves the request metrics of the HTTP server.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__METRICS_HTTP_WEB_APP
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__METRICS_HTTP_WEB_APP
+
+#include <Balau/Network/Http/Server/HttpWebApp.hpp>
+
+namespace Balau {
+
+class BalauLogger;
+class EnvironmentProperties;
+
+namespace Network::Http::HttpWebApps {
+
+///
+/// An HTTP web application handler that serves the request metrics of the HTTP server.
+///
+/// The metrics are served in the Prometheus text exposition format in response
+/// to GET requests. Post requests are not supported.
+///
+/// When admission control is enabled, the limits and the admitted and shed
+/// request counters of the admission control routes are also served.
+///
+class MetricsHttpWebApp : public HttpWebApp {
+	///
+	/// The content type of the Prometheus text exposition format.
+	///
+	public: static constexpr const char * ContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+	///
+	/// Create a metrics handler.
+	///
+	public: MetricsHttpWebApp() = default;
+
+	///
+	/// Constructor used by the HTTP server.
+	///
+	public: MetricsHttpWebApp(const EnvironmentProperties & configuration, const BalauLogger & logger);
+
+	public: void handleGetRequest(HttpSession & session,
+	                              const StringRequest & request,
+	                              std::map<std::string, std::string> & variables) override;
+
+	public: void handleHeadRequest(HttpSession & session,
+	                               const StringRequest & request,
+	                               std::map<std::string, std::string> & variables) override;
+
+	public: void handlePostRequest(HttpSession & session,
+	                               const StringRequest & request,
+	                               std::map<std::string, std::string> & variables) override;
+};
+
+} // namespace Network::Http::HttpWebApps
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__METRICS_HTTP_WEB_APP
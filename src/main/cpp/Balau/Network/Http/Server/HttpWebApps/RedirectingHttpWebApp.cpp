@@ -26,7 +26,8 @@
 namespace Balau::Network::Http::HttpWebApps {
 
 RedirectingHttpWebApp::RedirectingHttpWebApp(const EnvironmentProperties & configuration, const BalauLogger & logger)
-	: redirections(buildRedirections(configuration, logger)) {}
+	: redirections(buildRedirections(configuration, logger))
+	, matcher(patterns(redirections)) {}
 
 void RedirectingHttpWebApp::handleGetRequest(HttpSession & session,
                                              const StringRequest & request,
@@ -49,33 +50,28 @@ void RedirectingHttpWebApp::handlePostRequest(HttpSession & session,
 void RedirectingHttpWebApp::handle(HttpSession & session,
                                    const StringRequest & request,
                                    std::map<std::string, std::string> & variables) {
-	const auto path = std::string(request.target());
-	std::smatch matchResult;
+	thread_local std::vector<std::string_view> groups;
 
-	for (const auto & redirection : redirections) {
-		if (std::regex_match(path, matchResult, redirection.matcher)) {
-			// Add sub-matches to variables before constructing the redirection path.
-			size_t subMatchIndex = 0;
-			for (const auto & subMatch : matchResult) {
-				if (subMatchIndex == 0) { // Miss first result (the whole string).
-					++subMatchIndex;
-					continue;
-				}
+	const auto target = request.target();
+	const size_t index = matcher.match(std::string_view(target.data(), target.length()), groups);
 
-				variables[::toString("$", subMatchIndex)] = subMatch;
-				++subMatchIndex;
-			}
+	if (index != Impl::MultiPatternMatcher::NoMatch) {
+		const auto & redirection = redirections[index];
 
-			const std::string redirectionPath = redirection.createPath(variables);
+		// Add sub-matches to variables before constructing the redirection path.
+		for (size_t groupIndex = 0; groupIndex < groups.size(); ++groupIndex) {
+			variables[::toString("$", groupIndex + 1)] = std::string(groups[groupIndex]);
+		}
 
-			if (redirection.code == 301) {
-				session.sendResponse(createPermanentRedirectResponse(session, request, redirectionPath), redirectionPath);
-			} else {
-				session.sendResponse(createRedirectResponse(session, request, redirectionPath), redirectionPath);
-			}
+		const std::string redirectionPath = redirection.createPath(variables);
 
-			return;
+		if (redirection.code == 301) {
+			session.sendResponse(createPermanentRedirectResponse(session, request, redirectionPath), redirectionPath);
+		} else {
+			session.sendResponse(createRedirectResponse(session, request, redirectionPath), redirectionPath);
 		}
+
+		return;
 	}
 
 	session.sendResponse(createNotFoundStringResponse(session, request));
@@ -87,7 +83,8 @@ RedirectingHttpWebApp::buildRedirections(const EnvironmentProperties & configura
 		return std::vector<Redirection>();
 	}
 
-	std::map<size_t, Redirection> redirectionMap;
+	// Multiple entries may share the same position (including the default position).
+	std::multimap<size_t, Redirection> redirectionMap;
 	auto matches = configuration.getComposite("matches");
 
 	for (const auto & match : *matches) {
@@ -132,15 +129,11 @@ RedirectingHttpWebApp::buildRedirections(const EnvironmentProperties & configura
 			}
 
 			try {
-				std::regex matcher(regexStr);
+				// Validate the regular expression. The expressions are compiled into the matcher afterwards.
+				std::regex validation(regexStr);
 				std::vector<RedirectingHttpWebApp::PathComponent> pathComponents = buildPathComponents(path);
 
-				redirectionMap[position] = Redirection(
-					matcher, code, pathComponents
-					#ifdef BALAU_DEBUG
-					, regexStr
-					#endif
-				);
+				redirectionMap.emplace(position, Redirection(regexStr, code, pathComponents));
 			} catch (const std::regex_error &) {
 				BalauBalauLogError(
 					  logger
@@ -165,12 +158,23 @@ RedirectingHttpWebApp::buildRedirections(const EnvironmentProperties & configura
 	std::for_each(
 		  redirectionMap.begin()
 		, redirectionMap.end()
-		, [&paths] (const std::map<size_t, Redirection>::value_type & pair) { paths.push_back(pair.second); }
+		, [&paths] (const std::multimap<size_t, Redirection>::value_type & pair) { paths.push_back(pair.second); }
 	);
 
 	return paths;
 }
 
+std::vector<std::string> RedirectingHttpWebApp::patterns(const std::vector<Redirection> & redirections) {
+	std::vector<std::string> patterns;
+	patterns.reserve(redirections.size());
+
+	for (const auto & redirection : redirections) {
+		patterns.push_back(redirection.pattern);
+	}
+
+	return patterns;
+}
+
 // TODO validation of configuration supplied path
 std::vector<RedirectingHttpWebApp::PathComponent> RedirectingHttpWebApp::buildPathComponents(const std::string & path) {
 	std::vector<RedirectingHttpWebApp::PathComponent> pathComponents;
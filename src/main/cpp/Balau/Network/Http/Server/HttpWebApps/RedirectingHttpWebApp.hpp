@@ -27,6 +27,7 @@
 #define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_HTTP_WEB_APPS__REDIRECTING_HTTP_WEB_APP
 
 #include <Balau/Network/Http/Server/HttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/Impl/MultiPatternMatcher.hpp>
 
 namespace Balau {
 
@@ -50,6 +51,11 @@ namespace Network::Http::HttpWebApps {
 ///
 /// If the HTTP code is omitted, HTTP 302 is returned by default.
 ///
+/// The regular expressions of all the redirect entries are compiled into a
+/// single matcher during construction. The cost of matching a request path is
+/// thus largely independent of the number of redirect entries. When multiple
+/// entries match a path, the entry with the lowest position wins.
+///
 class RedirectingHttpWebApp : public HttpWebApp {
 	///
 	/// Constructor called by the HTTP server during construction.
@@ -95,12 +101,9 @@ class RedirectingHttpWebApp : public HttpWebApp {
 	};
 
 	public: struct Redirection {
-		std::regex matcher;
+		std::string pattern;
 		unsigned int code;
 		std::vector<PathComponent> pathComponents;
-		#ifdef BALAU_DEBUG
-		std::string regexStr;
-		#endif
 
 		std::string createPath(std::map<std::string, std::string> & variables) const {
 			std::ostringstream stream;
@@ -116,20 +119,10 @@ class RedirectingHttpWebApp : public HttpWebApp {
 		Redirection(const Redirection & ) = default;
 		Redirection & operator = (const Redirection & ) = default;
 
-		Redirection(const std::regex & matcher_,
-		            unsigned int code_,
-		            const std::vector<PathComponent> & pathComponents_
-		            #ifdef BALAU_DEBUG
-		            , const std::string regexStr_
-		            #endif
-					)
-			: matcher(matcher_)
+		Redirection(std::string pattern_, unsigned int code_, const std::vector<PathComponent> & pathComponents_)
+			: pattern(std::move(pattern_))
 			, code(code_)
-			, pathComponents(pathComponents_)
-			#ifdef BALAU_DEBUG
-			, regexStr(regexStr_)
-			#endif
-			{}
+			, pathComponents(pathComponents_) {}
 	};
 
 	private: static std::vector<Redirection> buildRedirections(const EnvironmentProperties & configuration,
@@ -137,7 +130,12 @@ class RedirectingHttpWebApp : public HttpWebApp {
 
 	private: static std::vector<PathComponent> buildPathComponents(const std::string & path);
 
+	private: static std::vector<std::string> patterns(const std::vector<Redirection> & redirections);
+
 	private: const std::vector<Redirection> redirections;
+
+	// All redirection patterns, compiled into a single matcher.
+	private: const Impl::MultiPatternMatcher matcher;
 };
 
 } // namespace Network::Http::HttpWebApps
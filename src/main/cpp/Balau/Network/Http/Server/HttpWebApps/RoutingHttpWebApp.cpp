@@ -31,4 +31,24 @@ void RoutingHttpWebApp::sendNotFoundResponse(HttpSession & session, const String
 	}
 }
 
+void RoutingHttpWebApp::setMetricsRoute(HttpSession & session, const Node & node) const {
+	auto iter = routeLabels.find(&node);
+
+	if (iter != routeLabels.end()) {
+		session.setMetricsRoute(iter->second);
+	}
+}
+
+void RoutingHttpWebApp::createRouteLabels(const Node & node, const std::string & parentLabel) {
+	// Empty keys (such as the root key) do not contribute a path component.
+	const auto & key = std::get<KeyIndex>(node.value);
+	const auto label = key.empty() ? parentLabel : parentLabel + "/" + key;
+
+	routeLabels.emplace(&node, label.empty() ? "/" : label);
+
+	for (size_t m = 0; m < node.count(); ++m) {
+		createRouteLabels(node[m], label);
+	}
+}
+
 } // namespace Balau::Network::Http::HttpWebApps
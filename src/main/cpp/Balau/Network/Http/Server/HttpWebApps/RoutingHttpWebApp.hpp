@@ -29,6 +29,8 @@
 #include <Balau/Container/ObjectTrie.hpp>
 #include <Balau/Network/Http/Server/HttpWebApp.hpp>
 
+#include <unordered_map>
+
 namespace Balau::Network::Http::HttpWebApps {
 
 ///
@@ -70,6 +72,10 @@ namespace Balau::Network::Http::HttpWebApps {
 /// As the handlers are kept in shared pointers, handler instances may be shared
 /// between multiple nodes in the trie if required.
 ///
+/// The routing handler sets the metrics route of the session to the path of the
+/// resolved routing node (for example "/manual/css"). The request metrics of the
+/// HTTP server are thus recorded per routing node.
+///
 class RoutingHttpWebApp : public HttpWebApp {
 	///
 	/// Shared pointer container for web app instances.
@@ -99,7 +105,9 @@ class RoutingHttpWebApp : public HttpWebApp {
 	///
 	/// Construct a routing HTTP handler, by supplying a preformed routing trie.
 	///
-	public: RoutingHttpWebApp(Routing && routing_) : routing(std::move(routing_)) {}
+	public: RoutingHttpWebApp(Routing && routing_) : routing(std::move(routing_)) {
+		createRouteLabels(routing.root(), "");
+	}
 
 	public: void handleGetRequest(HttpSession & session,
 	                              const StringRequest & request,
@@ -131,10 +139,32 @@ class RoutingHttpWebApp : public HttpWebApp {
 		}
 	}
 
+	public: std::unique_ptr<RequestBodyHandler> createPostBodyHandler(HttpSession & session,
+	                                                                  const StringRequest & request,
+	                                                                  std::map<std::string, std::string> & variables) override {
+		HttpWebApp * handler = find(session, request);
+
+		// Unresolved requests are buffered and the not found response is sent by handlePostRequest.
+		return handler != nullptr
+			? handler->createPostBodyHandler(session, request, variables)
+			: std::unique_ptr<RequestBodyHandler>();
+	}
+
 	///////////////////////// Private implementation //////////////////////////
 
 	//private: HttpWebApp * resolve(HttpSession & session, const StringRequest & request);
 	private: HttpWebApp * resolve(HttpSession & session, const StringRequest & request) {
+		HttpWebApp * handler = find(session, request);
+
+		if (handler == nullptr) {
+			// No handler found for method.
+			sendNotFoundResponse(session, request);
+		}
+
+		return handler;
+	}
+
+	private: HttpWebApp * find(HttpSession & session, const StringRequest & request) {
 		const std::string_view & path = std::string_view(request.target().data(), request.target().length());
 		auto pathComponents = Util::Strings::split(path, "/");
 		std::vector<std::string_view> components;
@@ -145,6 +175,7 @@ class RoutingHttpWebApp : public HttpWebApp {
 		Node * node = routing.findNearest(components, [] (auto & lhs, auto & rhs) { return std::get<KeyIndex>(lhs) == rhs; }, false);
 
 		if (node != nullptr) {
+			setMetricsRoute(session, *node);
 			HttpWebApp * handler;
 
 			switch (request.method()) {
@@ -174,14 +205,17 @@ class RoutingHttpWebApp : public HttpWebApp {
 			}
 		}
 
-		// No handler found for method.
-		sendNotFoundResponse(session, request);
 		return nullptr;
 	}
 
 	private: void sendNotFoundResponse(HttpSession & session, const StringRequest & request);
+	private: void setMetricsRoute(HttpSession & session, const Node & node) const;
+	private: void createRouteLabels(const Node & node, const std::string & parentLabel);
 
 	private: Routing routing;
+
+	// The metrics route label of each routing node.
+	private: std::unordered_map<const Node *, std::string> routeLabels;
 };
 
 ///
@@ -59,7 +59,8 @@ class ClientSessions final {
 		}
 	}
 
-	private: std::shared_ptr<ClientSession> get(const std::string & sessionId) {
+	// The lookup is heterogeneous, in order to avoid allocating a key string per request.
+	private: std::shared_ptr<ClientSession> get(std::string_view sessionId) {
 		std::lock_guard<std::mutex> lock(mutex);
 		auto iter = sessions.find(sessionId);
 
@@ -81,7 +82,7 @@ class ClientSessions final {
 		sessions.clear();
 	}
 
-	private: std::map<std::string, std::shared_ptr<ClientSession>> sessions;
+	private: std::map<std::string, std::shared_ptr<ClientSession>, std::less<>> sessions;
 	private: std::mutex mutex;
 };
 
@@ -0,0 +1,120 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__CONFIGURATION_PUBLISHER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__CONFIGURATION_PUBLISHER
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Balau::Network::Http {
+
+struct HttpServerConfiguration;
+
+namespace Impl {
+
+//
+// Publishes the current configuration of an HTTP server to its sessions.
+//
+// A configuration reload builds a new configuration object off the request path
+// and publishes it here. Each published configuration has a generation number.
+// Sessions keep a reference to the configuration they obtained and, before each
+// request, compare their generation with the published one (a single atomic load).
+// The published pointer is only copied when the generation has changed, so there
+// is no per-request locking.
+//
+// Requests that are in progress complete with the configuration they started
+// with. A previous configuration is destroyed when the last session referencing
+// it has moved on to the new generation or has closed.
+//
+class ConfigurationPublisher final {
+	public: using Builder = std::function<
+		std::shared_ptr<HttpServerConfiguration> (const std::shared_ptr<HttpServerConfiguration> & current)
+	>;
+
+	public: explicit ConfigurationPublisher(std::shared_ptr<HttpServerConfiguration> configuration_)
+		: configuration(std::move(configuration_)) {}
+
+	//
+	// Get the generation number of the currently published configuration.
+	//
+	public: uint64_t generation() const {
+		return currentGeneration.load(std::memory_order_acquire);
+	}
+
+	//
+	// Get the currently published configuration.
+	//
+	public: std::shared_ptr<HttpServerConfiguration> current() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return configuration;
+	}
+
+	//
+	// Update the supplied configuration and generation if a newer configuration
+	// has been published. Returns true if the configuration was updated.
+	//
+	public: bool refresh(std::shared_ptr<HttpServerConfiguration> & config, uint64_t & gen) const {
+		if (generation() == gen) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		config = configuration;
+		gen = currentGeneration.load(std::memory_order_relaxed);
+		return true;
+	}
+
+	//
+	// Build a new configuration from the current one and publish it.
+	//
+	// Updates are serialised, so concurrent reloads never derive from a stale
+	// configuration. The builder runs without blocking readers. If the builder
+	// throws, the current configuration remains published.
+	//
+	public: uint64_t update(const Builder & builder) {
+		std::lock_guard<std::mutex> updateLock(updateMutex);
+		auto next = builder(current());
+		std::shared_ptr<HttpServerConfiguration> previous;
+		uint64_t published;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			previous = std::move(configuration);
+			configuration = std::move(next);
+			published = currentGeneration.fetch_add(1, std::memory_order_release) + 1;
+		}
+
+		// The previous configuration is released outside of the reader lock.
+		return published;
+	}
+
+	private: mutable std::mutex mutex;
+	private: std::mutex updateMutex;
+	private: std::shared_ptr<HttpServerConfiguration> configuration;
+	private: std::atomic<uint64_t> currentGeneration { 0 };
+};
+
+} // namespace Impl
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__CONFIGURATION_PUBLISHER
@@ -0,0 +1,73 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HEADER_VALUE_BUILDER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HEADER_VALUE_BUILDER
+
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// Builds a header value in a fixed size buffer that is intended to be placed on the stack.
+//
+// If the header value exceeds the capacity of the buffer, the builder falls back to
+// a heap allocated string. The view returned by the builder is valid until the builder
+// is destroyed or appended to.
+//
+template <size_t Capacity> class HeaderValueBuilder final {
+	public: HeaderValueBuilder() = default;
+
+	public: HeaderValueBuilder(const HeaderValueBuilder & ) = delete;
+	public: HeaderValueBuilder & operator = (const HeaderValueBuilder & ) = delete;
+
+	public: HeaderValueBuilder & append(std::string_view value) {
+		if (overflow.empty() && length + value.length() <= Capacity) {
+			std::memcpy(buffer + length, value.data(), value.length());
+			length += value.length();
+		} else {
+			if (overflow.empty()) {
+				overflow.reserve(length + value.length());
+				overflow.append(buffer, length);
+			}
+
+			overflow.append(value);
+		}
+
+		return *this;
+	}
+
+	public: HeaderValueBuilder & append(char c) {
+		return append(std::string_view(&c, 1));
+	}
+
+	public: std::string_view view() const {
+		return overflow.empty() ? std::string_view(buffer, length) : std::string_view(overflow);
+	}
+
+	private: char buffer[Capacity];
+	private: size_t length = 0;
+	private: std::string overflow;
+};
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HEADER_VALUE_BUILDER
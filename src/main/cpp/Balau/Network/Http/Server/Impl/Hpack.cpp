@@ -0,0 +1,586 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "Hpack.hpp"
+
+#include <array>
+
+namespace Balau::Network::Http::Impl {
+
+namespace {
+
+struct HuffmanCode {
+	uint32_t code;
+	unsigned bits;
+};
+
+// RFC 7541 appendix B. The codes are right aligned.
+const HuffmanCode huffmanCodes[257] = {
+	{ 0x1ff8, 13 }, { 0x7fffd8, 23 }, { 0xfffffe2, 28 }, { 0xfffffe3, 28 },
+	{ 0xfffffe4, 28 }, { 0xfffffe5, 28 }, { 0xfffffe6, 28 }, { 0xfffffe7, 28 },
+	{ 0xfffffe8, 28 }, { 0xffffea, 24 }, { 0x3ffffffc, 30 }, { 0xfffffe9, 28 },
+	{ 0xfffffea, 28 }, { 0x3ffffffd, 30 }, { 0xfffffeb, 28 }, { 0xfffffec, 28 },
+	{ 0xfffffed, 28 }, { 0xfffffee, 28 }, { 0xfffffef, 28 }, { 0xffffff0, 28 },
+	{ 0xffffff1, 28 }, { 0xffffff2, 28 }, { 0x3ffffffe, 30 }, { 0xffffff3, 28 },
+	{ 0xffffff4, 28 }, { 0xffffff5, 28 }, { 0xffffff6, 28 }, { 0xffffff7, 28 },
+	{ 0xffffff8, 28 }, { 0xffffff9, 28 }, { 0xffffffa, 28 }, { 0xffffffb, 28 },
+	{ 0x14, 6 }, { 0x3f8, 10 }, { 0x3f9, 10 }, { 0xffa, 12 },
+	{ 0x1ff9, 13 }, { 0x15, 6 }, { 0xf8, 8 }, { 0x7fa, 11 },
+	{ 0x3fa, 10 }, { 0x3fb, 10 }, { 0xf9, 8 }, { 0x7fb, 11 },
+	{ 0xfa, 8 }, { 0x16, 6 }, { 0x17, 6 }, { 0x18, 6 },
+	{ 0x0, 5 }, { 0x1, 5 }, { 0x2, 5 }, { 0x19, 6 },
+	{ 0x1a, 6 }, { 0x1b, 6 }, { 0x1c, 6 }, { 0x1d, 6 },
+	{ 0x1e, 6 }, { 0x1f, 6 }, { 0x5c, 7 }, { 0xfb, 8 },
+	{ 0x7ffc, 15 }, { 0x20, 6 }, { 0xffb, 12 }, { 0x3fc, 10 },
+	{ 0x1ffa, 13 }, { 0x21, 6 }, { 0x5d, 7 }, { 0x5e, 7 },
+	{ 0x5f, 7 }, { 0x60, 7 }, { 0x61, 7 }, { 0x62, 7 },
+	{ 0x63, 7 }, { 0x64, 7 }, { 0x65, 7 }, { 0x66, 7 },
+	{ 0x67, 7 }, { 0x68, 7 }, { 0x69, 7 }, { 0x6a, 7 },
+	{ 0x6b, 7 }, { 0x6c, 7 }, { 0x6d, 7 }, { 0x6e, 7 },
+	{ 0x6f, 7 }, { 0x70, 7 }, { 0x71, 7 }, { 0x72, 7 },
+	{ 0xfc, 8 }, { 0x73, 7 }, { 0xfd, 8 }, { 0x1ffb, 13 },
+	{ 0x7fff0, 19 }, { 0x1ffc, 13 }, { 0x3ffc, 14 }, { 0x22, 6 },
+	{ 0x7ffd, 15 }, { 0x3, 5 }, { 0x23, 6 }, { 0x4, 5 },
+	{ 0x24, 6 }, { 0x5, 5 }, { 0x25, 6 }, { 0x26, 6 },
+	{ 0x27, 6 }, { 0x6, 5 }, { 0x74, 7 }, { 0x75, 7 },
+	{ 0x28, 6 }, { 0x29, 6 }, { 0x2a, 6 }, { 0x7, 5 },
+	{ 0x2b, 6 }, { 0x76, 7 }, { 0x2c, 6 }, { 0x8, 5 },
+	{ 0x9, 5 }, { 0x2d, 6 }, { 0x77, 7 }, { 0x78, 7 },
+	{ 0x79, 7 }, { 0x7a, 7 }, { 0x7b, 7 }, { 0x7ffe, 15 },
+	{ 0x7fc, 11 }, { 0x3ffd, 14 }, { 0x1ffd, 13 }, { 0xffffffc, 28 },
+	{ 0xfffe6, 20 }, { 0x3fffd2, 22 }, { 0xfffe7, 20 }, { 0xfffe8, 20 },
+	{ 0x3fffd3, 22 }, { 0x3fffd4, 22 }, { 0x3fffd5, 22 }, { 0x7fffd9, 23 },
+	{ 0x3fffd6, 22 }, { 0x7fffda, 23 }, { 0x7fffdb, 23 }, { 0x7fffdc, 23 },
+	{ 0x7fffdd, 23 }, { 0x7fffde, 23 }, { 0xffffeb, 24 }, { 0x7fffdf, 23 },
+	{ 0xffffec, 24 }, { 0xffffed, 24 }, { 0x3fffd7, 22 }, { 0x7fffe0, 23 },
+	{ 0xffffee, 24 }, { 0x7fffe1, 23 }, { 0x7fffe2, 23 }, { 0x7fffe3, 23 },
+	{ 0x7fffe4, 23 }, { 0x1fffdc, 21 }, { 0x3fffd8, 22 }, { 0x7fffe5, 23 },
+	{ 0x3fffd9, 22 }, { 0x7fffe6, 23 }, { 0x7fffe7, 23 }, { 0xffffef, 24 },
+	{ 0x3fffda, 22 }, { 0x1fffdd, 21 }, { 0xfffe9, 20 }, { 0x3fffdb, 22 },
+	{ 0x3fffdc, 22 }, { 0x7fffe8, 23 }, { 0x7fffe9, 23 }, { 0x1fffde, 21 },
+	{ 0x7fffea, 23 }, { 0x3fffdd, 22 }, { 0x3fffde, 22 }, { 0xfffff0, 24 },
+	{ 0x1fffdf, 21 }, { 0x3fffdf, 22 }, { 0x7fffeb, 23 }, { 0x7fffec, 23 },
+	{ 0x1fffe0, 21 }, { 0x1fffe1, 21 }, { 0x3fffe0, 22 }, { 0x1fffe2, 21 },
+	{ 0x7fffed, 23 }, { 0x3fffe1, 22 }, { 0x7fffee, 23 }, { 0x7fffef, 23 },
+	{ 0xfffea, 20 }, { 0x3fffe2, 22 }, { 0x3fffe3, 22 }, { 0x3fffe4, 22 },
+	{ 0x7ffff0, 23 }, { 0x3fffe5, 22 }, { 0x3fffe6, 22 }, { 0x7ffff1, 23 },
+	{ 0x3ffffe0, 26 }, { 0x3ffffe1, 26 }, { 0xfffeb, 20 }, { 0x7fff1, 19 },
+	{ 0x3fffe7, 22 }, { 0x7ffff2, 23 }, { 0x3fffe8, 22 }, { 0x1ffffec, 25 },
+	{ 0x3ffffe2, 26 }, { 0x3ffffe3, 26 }, { 0x3ffffe4, 26 }, { 0x7ffffde, 27 },
+	{ 0x7ffffdf, 27 }, { 0x3ffffe5, 26 }, { 0xfffff1, 24 }, { 0x1ffffed, 25 },
+	{ 0x7fff2, 19 }, { 0x1fffe3, 21 }, { 0x3ffffe6, 26 }, { 0x7ffffe0, 27 },
+	{ 0x7ffffe1, 27 }, { 0x3ffffe7, 26 }, { 0x7ffffe2, 27 }, { 0xfffff2, 24 },
+	{ 0x1fffe4, 21 }, { 0x1fffe5, 21 }, { 0x3ffffe8, 26 }, { 0x3ffffe9, 26 },
+	{ 0xffffffd, 28 }, { 0x7ffffe3, 27 }, { 0x7ffffe4, 27 }, { 0x7ffffe5, 27 },
+	{ 0xfffec, 20 }, { 0xfffff3, 24 }, { 0xfffed, 20 }, { 0x1fffe6, 21 },
+	{ 0x3fffe9, 22 }, { 0x1fffe7, 21 }, { 0x1fffe8, 21 }, { 0x7ffff3, 23 },
+	{ 0x3fffea, 22 }, { 0x3fffeb, 22 }, { 0x1ffffee, 25 }, { 0x1ffffef, 25 },
+	{ 0xfffff4, 24 }, { 0xfffff5, 24 }, { 0x3ffffea, 26 }, { 0x7ffff4, 23 },
+	{ 0x3ffffeb, 26 }, { 0x7ffffe6, 27 }, { 0x3ffffec, 26 }, { 0x3ffffed, 26 },
+	{ 0x7ffffe7, 27 }, { 0x7ffffe8, 27 }, { 0x7ffffe9, 27 }, { 0x7ffffea, 27 },
+	{ 0x7ffffeb, 27 }, { 0xffffffe, 28 }, { 0x7ffffec, 27 }, { 0x7ffffed, 27 },
+	{ 0x7ffffee, 27 }, { 0x7ffffef, 27 }, { 0x7fffff0, 27 }, { 0x3ffffee, 26 },
+	{ 0x3fffffff, 30 }
+};
+
+const unsigned EosSymbol = 256;
+
+// A binary tree built from the Huffman codes, used for decoding.
+class HuffmanTree {
+	public: struct Node {
+		int16_t children[2] = { -1, -1 };
+		int16_t symbol = -1;
+	};
+
+	public: HuffmanTree() {
+		nodes.reserve(2 * 257);
+		nodes.emplace_back();
+
+		for (unsigned symbol = 0; symbol < 257; ++symbol) {
+			const auto & code = huffmanCodes[symbol];
+			size_t node = 0;
+
+			for (unsigned bit = code.bits; bit > 0; --bit) {
+				const unsigned direction = (code.code >> (bit - 1)) & 1U;
+
+				if (nodes[node].children[direction] < 0) {
+					nodes[node].children[direction] = (int16_t) nodes.size();
+					nodes.emplace_back();
+				}
+
+				node = (size_t) nodes[node].children[direction];
+			}
+
+			nodes[node].symbol = (int16_t) symbol;
+		}
+	}
+
+	public: std::vector<Node> nodes;
+};
+
+const HuffmanTree & huffmanTree() {
+	static const HuffmanTree tree;
+	return tree;
+}
+
+// RFC 7541 appendix A.
+const std::array<std::pair<std::string_view, std::string_view>, 61> staticTable = {{
+	  { ":authority", "" }
+	, { ":method", "GET" }
+	, { ":method", "POST" }
+	, { ":path", "/" }
+	, { ":path", "/index.html" }
+	, { ":scheme", "http" }
+	, { ":scheme", "https" }
+	, { ":status", "200" }
+	, { ":status", "204" }
+	, { ":status", "206" }
+	, { ":status", "304" }
+	, { ":status", "400" }
+	, { ":status", "404" }
+	, { ":status", "500" }
+	, { "accept-charset", "" }
+	, { "accept-encoding", "gzip, deflate" }
+	, { "accept-language", "" }
+	, { "accept-ranges", "" }
+	, { "accept", "" }
+	, { "access-control-allow-origin", "" }
+	, { "age", "" }
+	, { "allow", "" }
+	, { "authorization", "" }
+	, { "cache-control", "" }
+	, { "content-disposition", "" }
+	, { "content-encoding", "" }
+	, { "content-language", "" }
+	, { "content-length", "" }
+	, { "content-location", "" }
+	, { "content-range", "" }
+	, { "content-type", "" }
+	, { "cookie", "" }
+	, { "date", "" }
+	, { "etag", "" }
+	, { "expect", "" }
+	, { "expires", "" }
+	, { "from", "" }
+	, { "host", "" }
+	, { "if-match", "" }
+	, { "if-modified-since", "" }
+	, { "if-none-match", "" }
+	, { "if-range", "" }
+	, { "if-unmodified-since", "" }
+	, { "last-modified", "" }
+	, { "link", "" }
+	, { "location", "" }
+	, { "max-forwards", "" }
+	, { "proxy-authenticate", "" }
+	, { "proxy-authorization", "" }
+	, { "range", "" }
+	, { "referer", "" }
+	, { "refresh", "" }
+	, { "retry-after", "" }
+	, { "server", "" }
+	, { "set-cookie", "" }
+	, { "strict-transport-security", "" }
+	, { "transfer-encoding", "" }
+	, { "user-agent", "" }
+	, { "vary", "" }
+	, { "via", "" }
+	, { "www-authenticate", "" }
+}};
+
+bool decodeString(std::string_view input, size_t & position, std::string & output) {
+	if (position >= input.length()) {
+		return false;
+	}
+
+	const bool huffman = ((unsigned char) input[position] & 0x80U) != 0;
+	uint64_t length;
+
+	if (!hpackDecodeInteger(input, position, 7, length) || length > input.length() - position) {
+		return false;
+	}
+
+	const auto data = input.substr(position, (size_t) length);
+	position += (size_t) length;
+	output.clear();
+
+	if (huffman) {
+		return HpackHuffman::decode(data, output);
+	}
+
+	output.assign(data.data(), data.length());
+	return true;
+}
+
+} // namespace
+
+////////////////////////////////// Integers ///////////////////////////////////
+
+void hpackEncodeInteger(uint64_t value, unsigned prefixBits, unsigned char prefix, std::string & output) {
+	const uint64_t maximumPrefix = (1U << prefixBits) - 1;
+
+	if (value < maximumPrefix) {
+		output.push_back((char) (prefix | (unsigned char) value));
+		return;
+	}
+
+	output.push_back((char) (prefix | (unsigned char) maximumPrefix));
+	value -= maximumPrefix;
+
+	while (value >= 128) {
+		output.push_back((char) ((value & 0x7FU) | 0x80U));
+		value >>= 7U;
+	}
+
+	output.push_back((char) value);
+}
+
+bool hpackDecodeInteger(std::string_view input, size_t & position, unsigned prefixBits, uint64_t & value) {
+	if (position >= input.length()) {
+		return false;
+	}
+
+	const uint64_t maximumPrefix = (1U << prefixBits) - 1;
+	value = (unsigned char) input[position++] & maximumPrefix;
+
+	if (value < maximumPrefix) {
+		return true;
+	}
+
+	unsigned shift = 0;
+
+	while (position < input.length()) {
+		const auto byte = (unsigned char) input[position++];
+		value += (uint64_t) (byte & 0x7FU) << shift;
+
+		if ((byte & 0x80U) == 0) {
+			return true;
+		}
+
+		shift += 7;
+
+		// Values above 2^32 are not used by HTTP/2.
+		if (shift > 28) {
+			return false;
+		}
+	}
+
+	return false;
+}
+
+/////////////////////////////////// Huffman ///////////////////////////////////
+
+void HpackHuffman::encode(std::string_view input, std::string & output) {
+	uint64_t accumulator = 0;
+	unsigned accumulatedBits = 0;
+
+	for (const char c : input) {
+		const auto & code = huffmanCodes[(unsigned char) c];
+		accumulator = (accumulator << code.bits) | code.code;
+		accumulatedBits += code.bits;
+
+		while (accumulatedBits >= 8) {
+			accumulatedBits -= 8;
+			output.push_back((char) (accumulator >> accumulatedBits));
+		}
+	}
+
+	// Pad with the most significant bits of the EOS code.
+	if (accumulatedBits > 0) {
+		const unsigned padding = 8 - accumulatedBits;
+		output.push_back((char) ((accumulator << padding) | ((1U << padding) - 1)));
+	}
+}
+
+size_t HpackHuffman::encodedLength(std::string_view input) {
+	size_t bits = 0;
+
+	for (const char c : input) {
+		bits += huffmanCodes[(unsigned char) c].bits;
+	}
+
+	return (bits + 7) / 8;
+}
+
+bool HpackHuffman::decode(std::string_view input, std::string & output) {
+	const auto & nodes = huffmanTree().nodes;
+	size_t node = 0;
+	unsigned bitsSinceSymbol = 0;
+	bool allOnes = true;
+
+	for (const char c : input) {
+		const auto byte = (unsigned char) c;
+
+		for (int bit = 7; bit >= 0; --bit) {
+			const unsigned direction = (byte >> (unsigned) bit) & 1U;
+			const int16_t next = nodes[node].children[direction];
+
+			if (next < 0) {
+				return false;
+			}
+
+			node = (size_t) next;
+			++bitsSinceSymbol;
+			allOnes = allOnes && direction == 1;
+
+			const int16_t symbol = nodes[node].symbol;
+
+			if (symbol >= 0) {
+				if ((unsigned) symbol == EosSymbol) {
+					return false;
+				}
+
+				output.push_back((char) symbol);
+				node = 0;
+				bitsSinceSymbol = 0;
+				allOnes = true;
+			}
+		}
+	}
+
+	// Padding must be shorter than 8 bits and must consist of the most significant bits of EOS.
+	return bitsSinceSymbol < 8 && allOnes;
+}
+
+//////////////////////////////// Dynamic table ////////////////////////////////
+
+void HpackDynamicTable::insert(HpackHeader && header) {
+	const size_t headerSize = header.size();
+
+	// An entry larger than the table empties the table (RFC 7541 section 4.4).
+	if (headerSize > maximumSize) {
+		entries.clear();
+		currentSize = 0;
+		return;
+	}
+
+	evict(maximumSize - headerSize);
+	currentSize += headerSize;
+	entries.emplace_front(std::move(header));
+}
+
+void HpackDynamicTable::setMaximumSize(size_t size) {
+	maximumSize = size;
+	evict(maximumSize);
+}
+
+void HpackDynamicTable::evict(size_t requiredSize) {
+	while (currentSize > requiredSize) {
+		currentSize -= entries.back().size();
+		entries.pop_back();
+	}
+}
+
+/////////////////////////////////// Decoder ///////////////////////////////////
+
+HpackDecoder::Result HpackDecoder::decode(std::string_view block,
+                                          std::vector<HpackHeader> & headers,
+                                          size_t maximumHeaderListSize) {
+	size_t position = 0;
+	size_t headerListSize = 0;
+	bool tooLarge = false;
+	bool headerDecoded = false;
+
+	const auto emit = [&] (HpackHeader header) {
+		headerDecoded = true;
+		headerListSize += header.size();
+
+		if (headerListSize > maximumHeaderListSize) {
+			tooLarge = true;
+			headers.clear();
+		} else if (!tooLarge) {
+			headers.emplace_back(std::move(header));
+		}
+	};
+
+	while (position < block.length()) {
+		const auto first = (unsigned char) block[position];
+		uint64_t index;
+
+		if ((first & 0x80U) != 0) {
+			// Indexed header field.
+			const HpackHeader * header;
+
+			if (!hpackDecodeInteger(block, position, 7, index) || !lookup((size_t) index, header)) {
+				return Result::CompressionError;
+			}
+
+			emit(*header);
+		} else if ((first & 0x20U) != 0 && (first & 0x40U) == 0) {
+			// Dynamic table size update, only permitted at the start of the block.
+			if (headerDecoded || !hpackDecodeInteger(block, position, 5, index) || index > maximumTableSize) {
+				return Result::CompressionError;
+			}
+
+			table.setMaximumSize((size_t) index);
+		} else {
+			// Literal header field, with incremental indexing (6 bit prefix) or
+			// without indexing / never indexed (4 bit prefix).
+			const bool incrementalIndexing = (first & 0x40U) != 0;
+			HpackHeader header;
+
+			if (!hpackDecodeInteger(block, position, incrementalIndexing ? 6 : 4, index)) {
+				return Result::CompressionError;
+			}
+
+			if (index != 0) {
+				const HpackHeader * indexed;
+
+				if (!lookup((size_t) index, indexed)) {
+					return Result::CompressionError;
+				}
+
+				header.name = indexed->name;
+			} else if (!decodeString(block, position, header.name)) {
+				return Result::CompressionError;
+			}
+
+			if (!decodeString(block, position, header.value)) {
+				return Result::CompressionError;
+			}
+
+			if (incrementalIndexing) {
+				table.insert(HpackHeader(header));
+			}
+
+			emit(std::move(header));
+		}
+	}
+
+	return tooLarge ? Result::HeaderListTooLarge : Result::Success;
+}
+
+bool HpackDecoder::lookup(size_t index, const HpackHeader * & header) const {
+	// Static table entries are materialised once.
+	static const std::vector<HpackHeader> staticHeaders = [] () {
+		std::vector<HpackHeader> headers;
+
+		for (const auto & entry : staticTable) {
+			headers.emplace_back(entry.first, entry.second);
+		}
+
+		return headers;
+	}();
+
+	if (index == 0) {
+		return false;
+	} else if (index <= staticHeaders.size()) {
+		header = &staticHeaders[index - 1];
+		return true;
+	} else if (index - staticHeaders.size() - 1 < table.count()) {
+		header = &table[index - staticHeaders.size() - 1];
+		return true;
+	}
+
+	return false;
+}
+
+/////////////////////////////////// Encoder ///////////////////////////////////
+
+void HpackEncoder::setMaximumTableSize(size_t size) {
+	const size_t newSize = std::min(size, HpackDefaultTableSize);
+
+	if (newSize != table.getMaximumSize()) {
+		table.setMaximumSize(newSize);
+		pendingTableSizeUpdate = newSize;
+		tableSizeUpdatePending = true;
+	}
+}
+
+void HpackEncoder::startBlock(std::string & block) {
+	if (tableSizeUpdatePending) {
+		hpackEncodeInteger(pendingTableSizeUpdate, 5, 0x20, block);
+		tableSizeUpdatePending = false;
+	}
+}
+
+void HpackEncoder::encode(std::string_view name, std::string_view value, std::string & block) {
+	size_t nameIndex = 0;
+
+	for (size_t m = 0; m < staticTable.size(); ++m) {
+		if (staticTable[m].first == name) {
+			if (staticTable[m].second == value) {
+				hpackEncodeInteger(m + 1, 7, 0x80, block);
+				return;
+			}
+
+			if (nameIndex == 0) {
+				nameIndex = m + 1;
+			}
+		}
+	}
+
+	for (size_t m = 0; m < table.count(); ++m) {
+		const auto & entry = table[m];
+
+		if (entry.name == name) {
+			if (entry.value == value) {
+				hpackEncodeInteger(staticTable.size() + m + 1, 7, 0x80, block);
+				return;
+			}
+
+			if (nameIndex == 0) {
+				nameIndex = staticTable.size() + m + 1;
+			}
+		}
+	}
+
+	const bool index = shouldIndex(name, value) && name.length() + value.length() + 32 <= table.getMaximumSize();
+
+	if (index) {
+		hpackEncodeInteger(nameIndex, 6, 0x40, block);
+	} else {
+		hpackEncodeInteger(nameIndex, 4, 0x00, block);
+	}
+
+	if (nameIndex == 0) {
+		encodeString(name, block);
+	}
+
+	encodeString(value, block);
+
+	if (index) {
+		table.insert(HpackHeader(name, value));
+	}
+}
+
+bool HpackEncoder::shouldIndex(std::string_view name, std::string_view value) {
+	// Values that typically differ between responses would evict useful entries.
+	return name != "content-length"
+		&& name != "content-range"
+		&& name != "date"
+		&& name != "etag"
+		&& name != "last-modified"
+		&& name != "location"
+		&& value.length() <= HpackDefaultTableSize / 4;
+}
+
+void HpackEncoder::encodeString(std::string_view value, std::string & block) {
+	const size_t huffmanLength = HpackHuffman::encodedLength(value);
+
+	if (huffmanLength < value.length()) {
+		hpackEncodeInteger(huffmanLength, 7, 0x80, block);
+		HpackHuffman::encode(value, block);
+	} else {
+		hpackEncodeInteger(value.length(), 7, 0x00, block);
+		block.append(value.data(), value.length());
+	}
+}
+
+} // namespace Balau::Network::Http::Impl
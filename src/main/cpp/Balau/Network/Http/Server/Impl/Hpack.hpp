@@ -0,0 +1,234 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HPACK
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HPACK
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// The default SETTINGS_HEADER_TABLE_SIZE value.
+//
+constexpr size_t HpackDefaultTableSize = 4096;
+
+//
+// A header field in an HPACK header list.
+//
+struct HpackHeader {
+	std::string name;
+	std::string value;
+
+	HpackHeader() = default;
+
+	HpackHeader(std::string_view name_, std::string_view value_)
+		: name(name_)
+		, value(value_) {}
+
+	// The size of the header as defined in RFC 7541 section 4.1.
+	size_t size() const {
+		return name.length() + value.length() + 32;
+	}
+};
+
+//
+// The HPACK Huffman code (RFC 7541 appendix B).
+//
+class HpackHuffman final {
+	//
+	// Append the Huffman encoding of the input to the output.
+	//
+	public: static void encode(std::string_view input, std::string & output);
+
+	//
+	// Get the length of the Huffman encoding of the input.
+	//
+	public: static size_t encodedLength(std::string_view input);
+
+	//
+	// Append the decoded Huffman encoded input to the output.
+	//
+	// @return false if the input is not a valid Huffman encoding
+	//
+	public: static bool decode(std::string_view input, std::string & output);
+};
+
+//
+// An HPACK dynamic table (RFC 7541 section 2.3.2).
+//
+class HpackDynamicTable final {
+	public: explicit HpackDynamicTable(size_t maximumSize_) : maximumSize(maximumSize_) {}
+
+	public: size_t count() const {
+		return entries.size();
+	}
+
+	public: size_t size() const {
+		return currentSize;
+	}
+
+	public: size_t getMaximumSize() const {
+		return maximumSize;
+	}
+
+	// Zero based index into the dynamic table (0 = most recently inserted).
+	public: const HpackHeader & operator [] (size_t index) const {
+		return entries[index];
+	}
+
+	public: void insert(HpackHeader && header);
+
+	public: void setMaximumSize(size_t size);
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: void evict(size_t requiredSize);
+
+	private: std::deque<HpackHeader> entries;
+	private: size_t currentSize = 0;
+	private: size_t maximumSize;
+};
+
+//
+// Decodes HPACK header blocks (RFC 7541).
+//
+// A single decoder instance is used for all the header blocks received on an
+// HTTP/2 connection, as the dynamic table state is shared between the blocks.
+//
+class HpackDecoder final {
+	public: enum class Result {
+		  Success
+		, CompressionError // The connection must be terminated.
+		, HeaderListTooLarge // The header block was fully decoded, but the header list was discarded.
+	};
+
+	//
+	// Create a decoder.
+	//
+	// The dynamic table initially has the default size. The peer may change the
+	// size with dynamic table size updates, up to the maximum table size.
+	//
+	// @param maximumTableSize_ the SETTINGS_HEADER_TABLE_SIZE value advertised to the peer
+	//
+	public: explicit HpackDecoder(size_t maximumTableSize_)
+		: maximumTableSize(maximumTableSize_)
+		, table(HpackDefaultTableSize) {}
+
+	//
+	// Decode a complete header block into the supplied header list.
+	//
+	// The dynamic table is updated regardless of the maximum header list size.
+	//
+	public: Result decode(std::string_view block, std::vector<HpackHeader> & headers, size_t maximumHeaderListSize);
+
+	public: const HpackDynamicTable & dynamicTable() const {
+		return table;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: bool lookup(size_t index, const HpackHeader * & header) const;
+
+	private: const size_t maximumTableSize;
+	private: HpackDynamicTable table;
+};
+
+//
+// Encodes HPACK header blocks (RFC 7541).
+//
+// A single encoder instance is used for all the header blocks sent on an HTTP/2
+// connection.
+//
+// Header fields are added to the dynamic table unless their values typically
+// vary between responses. Literal strings are Huffman encoded when this
+// results in a shorter representation.
+//
+class HpackEncoder final {
+	public: HpackEncoder() : table(HpackDefaultTableSize) {}
+
+	//
+	// Set the maximum dynamic table size, following a change to the peer's
+	// SETTINGS_HEADER_TABLE_SIZE value.
+	//
+	// The encoder does not use a table larger than the default size. A dynamic
+	// table size update is emitted at the start of the next header block.
+	//
+	public: void setMaximumTableSize(size_t size);
+
+	//
+	// Append the encoding of a header field to the header block.
+	//
+	// Header names must be lowercase.
+	//
+	public: void encode(std::string_view name, std::string_view value, std::string & block);
+
+	//
+	// Start a new header block.
+	//
+	// Emits a pending dynamic table size update.
+	//
+	public: void startBlock(std::string & block);
+
+	public: const HpackDynamicTable & dynamicTable() const {
+		return table;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static bool shouldIndex(std::string_view name, std::string_view value);
+	private: static void encodeString(std::string_view value, std::string & block);
+
+	private: HpackDynamicTable table;
+	private: size_t pendingTableSizeUpdate = 0;
+	private: bool tableSizeUpdatePending = false;
+};
+
+//
+// Append an HPACK integer with the specified prefix size to the output (RFC 7541 section 5.1).
+//
+// @param prefix the bits preceding the integer in the first byte
+//
+void hpackEncodeInteger(uint64_t value, unsigned prefixBits, unsigned char prefix, std::string & output);
+
+//
+// Decode an HPACK integer with the specified prefix size (RFC 7541 section 5.1).
+//
+// @return false if the integer is truncated or too large
+//
+bool hpackDecodeInteger(std::string_view input, size_t & position, unsigned prefixBits, uint64_t & value);
+
+//
+// Print the HPACK decoder result as a UTF-8 string.
+//
+inline std::string toString(HpackDecoder::Result result) {
+	switch (result) {
+		case HpackDecoder::Result::Success:            return "Success";
+		case HpackDecoder::Result::CompressionError:   return "CompressionError";
+		case HpackDecoder::Result::HeaderListTooLarge: return "HeaderListTooLarge";
+		default: return "Unknown";
+	}
+}
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HPACK
@@ -0,0 +1,159 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_FRAMES
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_FRAMES
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// HTTP/2 framing layer constants and helpers (RFC 7540 sections 4 and 6).
+//
+namespace Http2Frames {
+
+// The client connection preface.
+constexpr std::string_view ConnectionPreface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+// The part of the connection preface that is parsed as an HTTP/1 request header.
+constexpr size_t ConnectionPrefaceRequestLength = 18;
+
+constexpr size_t FrameHeaderLength = 9;
+
+constexpr uint32_t DefaultWindowSize = 65535;
+constexpr uint32_t DefaultMaxFrameSize = 16384;
+
+enum class FrameType : uint8_t {
+	  Data         = 0x0
+	, Headers      = 0x1
+	, Priority     = 0x2
+	, RstStream    = 0x3
+	, Settings     = 0x4
+	, PushPromise  = 0x5
+	, Ping         = 0x6
+	, GoAway       = 0x7
+	, WindowUpdate = 0x8
+	, Continuation = 0x9
+};
+
+namespace Flags {
+
+constexpr uint8_t EndStream  = 0x1;
+constexpr uint8_t Ack        = 0x1;
+constexpr uint8_t EndHeaders = 0x4;
+constexpr uint8_t Padded     = 0x8;
+constexpr uint8_t Priority   = 0x20;
+
+} // namespace Flags
+
+enum class SettingId : uint16_t {
+	  HeaderTableSize      = 0x1
+	, EnablePush           = 0x2
+	, MaxConcurrentStreams = 0x3
+	, InitialWindowSize    = 0x4
+	, MaxFrameSize         = 0x5
+	, MaxHeaderListSize    = 0x6
+};
+
+enum class ErrorCode : uint32_t {
+	  NoError            = 0x0
+	, ProtocolError      = 0x1
+	, InternalError      = 0x2
+	, FlowControlError   = 0x3
+	, SettingsTimeout    = 0x4
+	, StreamClosed       = 0x5
+	, FrameSizeError     = 0x6
+	, RefusedStream      = 0x7
+	, Cancel             = 0x8
+	, CompressionError   = 0x9
+	, ConnectError       = 0xa
+	, EnhanceYourCalm    = 0xb
+	, InadequateSecurity = 0xc
+	, Http11Required     = 0xd
+};
+
+struct FrameHeader {
+	uint32_t length;
+	FrameType type;
+	uint8_t flags;
+	uint32_t streamId;
+
+	bool hasFlag(uint8_t flag) const {
+		return (flags & flag) != 0;
+	}
+};
+
+inline uint32_t readUint32(const char * data) {
+	return ((uint32_t) (unsigned char) data[0] << 24U)
+		| ((uint32_t) (unsigned char) data[1] << 16U)
+		| ((uint32_t) (unsigned char) data[2] << 8U)
+		| (uint32_t) (unsigned char) data[3];
+}
+
+inline void appendUint32(std::string & output, uint32_t value) {
+	output.push_back((char) (value >> 24U));
+	output.push_back((char) (value >> 16U));
+	output.push_back((char) (value >> 8U));
+	output.push_back((char) value);
+}
+
+// Parse the frame header at the start of the data (at least FrameHeaderLength bytes).
+inline FrameHeader parseFrameHeader(const char * data) {
+	FrameHeader header {};
+	header.length = ((uint32_t) (unsigned char) data[0] << 16U)
+		| ((uint32_t) (unsigned char) data[1] << 8U)
+		| (uint32_t) (unsigned char) data[2];
+	header.type = (FrameType) data[3];
+	header.flags = (uint8_t) data[4];
+	header.streamId = readUint32(data + 5) & 0x7FFFFFFFU;
+	return header;
+}
+
+inline void writeFrameHeader(char * data, uint32_t length, FrameType type, uint8_t flags, uint32_t streamId) {
+	data[0] = (char) (length >> 16U);
+	data[1] = (char) (length >> 8U);
+	data[2] = (char) length;
+	data[3] = (char) type;
+	data[4] = (char) flags;
+	data[5] = (char) ((streamId >> 24U) & 0x7FU);
+	data[6] = (char) (streamId >> 16U);
+	data[7] = (char) (streamId >> 8U);
+	data[8] = (char) streamId;
+}
+
+inline void appendFrameHeader(std::string & output, uint32_t length, FrameType type, uint8_t flags, uint32_t streamId) {
+	char header[FrameHeaderLength];
+	writeFrameHeader(header, length, type, flags, streamId);
+	output.append(header, FrameHeaderLength);
+}
+
+inline void appendSetting(std::string & output, SettingId id, uint32_t value) {
+	output.push_back((char) ((uint16_t) id >> 8U));
+	output.push_back((char) id);
+	appendUint32(output, value);
+}
+
+} // namespace Http2Frames
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_FRAMES
@@ -0,0 +1,172 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_RESPONSE
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_RESPONSE
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <boost/optional.hpp>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// A type erased response that is sent on an HTTP/2 stream.
+//
+// The response body is obtained incrementally via the Beast body writer of the
+// response, so that large bodies (such as files) are read as flow control
+// permits.
+//
+class Http2Response {
+	public: virtual ~Http2Response() = default;
+
+	//
+	// The status and header fields of the response.
+	//
+	public: virtual const HTTP::response_header<> & header() const = 0;
+
+	//
+	// Returns true if there is more body data to read.
+	//
+	// @throw boost::system::system_error if the body could not be read
+	//
+	public: virtual bool hasMore() = 0;
+
+	//
+	// Copy up to size bytes of the body into the destination.
+	//
+	// @return the number of bytes copied
+	// @throw boost::system::system_error if the body could not be read
+	//
+	public: virtual size_t read(char * destination, size_t size) = 0;
+};
+
+//
+// The Http2Response implementation for a Beast response with the specified body type.
+//
+template <typename BodyT> class Http2ResponseImpl final : public Http2Response {
+	public: explicit Http2ResponseImpl(Response<BodyT> && response_)
+		: response(std::move(response_))
+		, writer(response.base(), response.body()) {
+		boost::system::error_code errorCode;
+		writer.init(errorCode);
+		check(errorCode);
+	}
+
+	public: const HTTP::response_header<> & header() const override {
+		return response.base();
+	}
+
+	public: bool hasMore() override {
+		while (current == buffers.size()) {
+			if (finished) {
+				return false;
+			}
+
+			boost::system::error_code errorCode;
+			auto result = writer.get(errorCode);
+			check(errorCode);
+
+			buffers.clear();
+			current = 0;
+			offset = 0;
+
+			if (!result) {
+				finished = true;
+				return false;
+			}
+
+			for (auto iter = boost::asio::buffer_sequence_begin(result->first);
+			     iter != boost::asio::buffer_sequence_end(result->first);
+			     ++iter) {
+				if (iter->size() != 0) {
+					buffers.emplace_back(*iter);
+				}
+			}
+
+			finished = !result->second;
+		}
+
+		return true;
+	}
+
+	public: size_t read(char * destination, size_t size) override {
+		size_t copied = 0;
+
+		while (copied < size && hasMore()) {
+			const auto & buffer = buffers[current];
+			const size_t count = std::min(size - copied, buffer.size() - offset);
+			std::memcpy(destination + copied, static_cast<const char *>(buffer.data()) + offset, count);
+			copied += count;
+			offset += count;
+
+			if (offset == buffer.size()) {
+				++current;
+				offset = 0;
+			}
+		}
+
+		return copied;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: static void check(const boost::system::error_code & errorCode) {
+		if (errorCode) {
+			throw boost::system::system_error(errorCode);
+		}
+	}
+
+	private: Response<BodyT> response;
+	private: typename BodyT::writer writer;
+	private: std::vector<boost::asio::const_buffer> buffers;
+	private: size_t current = 0;
+	private: size_t offset = 0;
+	private: bool finished = false;
+};
+
+//
+// Receives the responses of the HTTP sessions that handle HTTP/2 streams.
+//
+class Http2ResponseSink {
+	public: virtual ~Http2ResponseSink() = default;
+
+	//
+	// Send the response on the specified stream.
+	//
+	// May be called from any thread.
+	//
+	public: virtual void sendHttp2Response(uint32_t streamId, std::unique_ptr<Http2Response> response) = 0;
+
+	//
+	// Send a GOAWAY frame, refuse new streams and close the connection once
+	// the open streams have completed.
+	//
+	// May be called from any thread.
+	//
+	public: virtual void drain() = 0;
+};
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP2_RESPONSE
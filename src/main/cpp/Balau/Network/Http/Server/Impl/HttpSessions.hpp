@@ -22,14 +22,16 @@
 
 #include <Balau/Network/Http/Server/HttpSession.hpp>
 
+#include <atomic>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace Balau::Network::Http::Impl {
 
 //
 // Maintains a thread-safe set of all HTTP sessions in order to allow forced
-// closure if the server is halted.
+// closure if the server is halted, and graceful closure if the server is drained.
 //
 // Each HTTP session has a reference to its owning HttpSessions instance.
 //
@@ -58,8 +60,39 @@ class HttpSessions final {
 
 		sessions.clear();
 	}
+
+	// Called a single time by the listener when it starts draining.
+	//
+	// Once draining, sessions close their connections after the in-flight request
+	// has been responded to. Idle sessions are closed immediately.
+	public: void drainAllSessions(const BalauLogger & logger) {
+		std::vector<std::shared_ptr<HttpSession>> toDrain;
+
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+			draining.store(true);
+			toDrain.assign(sessions.begin(), sessions.end());
+		}
+
+		BalauBalauLogInfo(logger, "HttpsSessions: draining {} HTTP sessions.", toDrain.size());
+
+		for (auto & session : toDrain) {
+			session->drain();
+		}
+	}
+
+	public: bool isDraining() const {
+		return draining.load(std::memory_order_relaxed);
+	}
+
+	public: size_t size() {
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return sessions.size();
+	}
+
 	private: std::set<std::shared_ptr<HttpSession>> sessions;
 	private: std::recursive_mutex mutex;
+	private: std::atomic<bool> draining { false };
 };
 
 } // namespace Balau::Network::Http::Impl
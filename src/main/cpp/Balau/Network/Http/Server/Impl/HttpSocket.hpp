@@ -0,0 +1,203 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP_SOCKET
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP_SOCKET
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/beast/websocket/stream.hpp>
+#include <boost/version.hpp>
+
+#include <memory>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// The stream of an accepted HTTP connection.
+//
+// Forwards to either the TCP socket of the connection or, when the server
+// terminates TLS, to a TLS stream that owns the TCP socket. The HTTP, HTTP/2
+// and WebSocket sessions of the connection thus use the same code for both.
+//
+class HttpSocket {
+	public: using executor_type = TCP::socket::executor_type;
+	public: using lowest_layer_type = TCP::socket::lowest_layer_type;
+	public: using TlsStream = SSL::stream<TCP::socket>;
+
+	//
+	// Create an unopened socket.
+	//
+	public: explicit HttpSocket(boost::asio::io_context & context)
+		: socket(context) {}
+
+	//
+	// Create a plain socket from an accepted TCP socket.
+	//
+	public: explicit HttpSocket(TCP::socket && socket_)
+		: socket(std::move(socket_)) {}
+
+	//
+	// Create a TLS socket from an accepted TCP socket.
+	//
+	// The server handshake must be performed before the socket is used.
+	//
+	public: HttpSocket(TCP::socket && socket_, SSL::context & tlsContext)
+		: socket(socket_.get_executor())
+		, tls(std::make_unique<TlsStream>(std::move(socket_), tlsContext)) {}
+
+	public: HttpSocket(HttpSocket && ) = default;
+	public: HttpSocket & operator = (HttpSocket && ) = default;
+
+	public: bool isTls() const {
+		return (bool) tls;
+	}
+
+	//
+	// Get the TLS stream. Only valid for TLS sockets.
+	//
+	public: TlsStream & tlsStream() {
+		return *tls;
+	}
+
+	//
+	// Get the underlying TCP socket.
+	//
+	public: TCP::socket & tcpSocket() {
+		return tls ? tls->next_layer() : socket;
+	}
+
+	public: executor_type get_executor() noexcept {
+		return tcpSocket().get_executor();
+	}
+
+	public: lowest_layer_type & lowest_layer() {
+		return tcpSocket().lowest_layer();
+	}
+
+	public: bool is_open() const {
+		return tls ? tls->next_layer().is_open() : socket.is_open();
+	}
+
+	public: TCP::endpoint remote_endpoint() const {
+		return tls ? tls->next_layer().remote_endpoint() : socket.remote_endpoint();
+	}
+
+	//
+	// Perform the server side TLS handshake.
+	//
+	public: template <typename HandshakeHandler> void asyncHandshake(HandshakeHandler && handler) {
+		tls->async_handshake(SSL::stream_base::server, std::forward<HandshakeHandler>(handler));
+	}
+
+	//
+	// Shut down the sending side of the connection and close the TCP socket.
+	//
+	// The TLS close_notify alert is not sent, as this would require an
+	// asynchronous write. Clients treat this in the same way as a plain
+	// connection being closed after the final response.
+	//
+	public: void close(boost::system::error_code & errorCode) {
+		auto & tcp = tcpSocket();
+		tcp.shutdown(TCP::socket::shutdown_send, errorCode);
+		tcp.close(errorCode);
+	}
+
+	public: template <typename MutableBufferSequence, typename ReadHandler>
+	void async_read_some(const MutableBufferSequence & buffers, ReadHandler && handler) {
+		if (tls) {
+			tls->async_read_some(buffers, std::forward<ReadHandler>(handler));
+		} else {
+			socket.async_read_some(buffers, std::forward<ReadHandler>(handler));
+		}
+	}
+
+	public: template <typename ConstBufferSequence, typename WriteHandler>
+	void async_write_some(const ConstBufferSequence & buffers, WriteHandler && handler) {
+		if (tls) {
+			tls->async_write_some(buffers, std::forward<WriteHandler>(handler));
+		} else {
+			socket.async_write_some(buffers, std::forward<WriteHandler>(handler));
+		}
+	}
+
+	public: template <typename MutableBufferSequence>
+	size_t read_some(const MutableBufferSequence & buffers, boost::system::error_code & ec) {
+		return tls ? tls->read_some(buffers, ec) : socket.read_some(buffers, ec);
+	}
+
+	public: template <typename ConstBufferSequence>
+	size_t write_some(const ConstBufferSequence & buffers, boost::system::error_code & ec) {
+		return tls ? tls->write_some(buffers, ec) : socket.write_some(buffers, ec);
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	// The socket of plain connections (unopened for TLS connections).
+	private: TCP::socket socket;
+	private: std::unique_ptr<TlsStream> tls;
+};
+
+//
+// WebSocket teardown customisation points for the HTTP socket.
+//
+
+#if BOOST_VERSION >= 107000
+using WsRoleType = boost::beast::role_type;
+#else
+using WsRoleType = boost::beast::websocket::role_type;
+#endif
+
+inline void teardown(WsRoleType role, HttpSocket & socket, boost::system::error_code & ec) {
+	using boost::beast::websocket::teardown;
+
+	if (socket.isTls()) {
+		teardown(role, socket.tlsStream(), ec);
+	} else {
+		teardown(role, socket.tcpSocket(), ec);
+	}
+}
+
+template <typename TeardownHandler>
+inline void async_teardown(WsRoleType role, HttpSocket & socket, TeardownHandler && handler) {
+	using boost::beast::websocket::async_teardown;
+
+	if (socket.isTls()) {
+		async_teardown(role, socket.tlsStream(), std::forward<TeardownHandler>(handler));
+	} else {
+		async_teardown(role, socket.tcpSocket(), std::forward<TeardownHandler>(handler));
+	}
+}
+
+#if BOOST_VERSION >= 107000
+
+//
+// Close customisation point for the HTTP socket, used by the WebSocket stream on timeouts.
+//
+inline void beast_close_socket(HttpSocket & socket) {
+	boost::system::error_code ignored;
+	socket.tcpSocket().close(ignored);
+}
+
+#endif
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__HTTP_SOCKET
@@ -22,9 +22,15 @@
 
 #include <Balau/Network/Http/Server/NetworkTypes.hpp>
 #include <Balau/Network/Http/Server/Impl/ClientSessions.hpp>
+#include <Balau/Network/Http/Server/Impl/ConfigurationPublisher.hpp>
 #include <Balau/Network/Http/Server/Impl/HttpSessions.hpp>
 #include <Balau/Network/Utilities/BalauLogger.hpp>
 
+#include <boost/asio/steady_timer.hpp>
+
+#include <atomic>
+#include <chrono>
+
 // Avoid false positive (due to std::make_shared).
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
@@ -33,16 +39,28 @@ namespace Balau::Network::Http::Impl {
 
 // Listener for HttpServer.
 class Listener final : public std::enable_shared_from_this<Listener> {
+	//
+	// If an inherited listening socket is supplied, the acceptor adopts it
+	// instead of binding to the configured endpoint.
 	//
 	// @throw NetworkException if there was an issue constructing the listener
 	//
-	public: Listener(std::shared_ptr<HttpServerConfiguration> serverConfiguration_,
-	                 boost::asio::io_context & context)
-		: serverConfiguration(std::move(serverConfiguration_))
+	public: Listener(std::shared_ptr<ConfigurationPublisher> publisher_,
+	                 boost::asio::io_context & context,
+	                 int inheritedSocket = -1)
+		: publisher(std::move(publisher_))
 		, acceptor(context)
-		, socket(context) {
+		, socket(context)
+		, drainTimer(context) {
+		const auto serverConfiguration = publisher->current();
 		boost::system::error_code errorCode;
 
+		if (inheritedSocket >= 0) {
+			acceptor.assign(serverConfiguration->endpoint.protocol(), inheritedSocket, errorCode);
+			checkError(errorCode, [] () { return "acceptor.assign failed"; });
+			return;
+		}
+
 		acceptor.open(serverConfiguration->endpoint.protocol(), errorCode);
 		checkError(errorCode, [] () { return "acceptor.open failed"; });
 
@@ -63,7 +81,41 @@ class Listener final : public std::enable_shared_from_this<Listener> {
 
 	public: void close() {
 		acceptor.close();
-		httpSessions.unregisterAllSessions(serverConfiguration->logger);
+		httpSessions.unregisterAllSessions(publisher->current()->logger);
+		closed.store(true);
+	}
+
+	//
+	// True once close has been called, either directly or at the end of a drain.
+	//
+	public: bool isClosed() const {
+		return closed.load();
+	}
+
+	//
+	// The native handle of the listening socket, used when handing the socket off
+	// to a successor process.
+	//
+	public: int nativeHandle() {
+		return acceptor.native_handle();
+	}
+
+	//
+	// Stop accepting connections, drain the existing sessions and close the listener
+	// once all sessions have closed or the timeout has expired.
+	//
+	// Returns immediately. Use isClosed to determine when the drain has completed.
+	//
+	public: void drain(std::chrono::milliseconds timeout) {
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		boost::asio::post(acceptor.get_executor(), [self = shared_from_this(), deadline] () {
+			const auto serverConfiguration = self->publisher->current();
+			boost::system::error_code errorCode;
+			self->acceptor.close(errorCode);
+			self->httpSessions.drainAllSessions(serverConfiguration->logger);
+			self->waitForSessions(deadline);
+		});
 	}
 
 	public: void doAccept() {
@@ -71,15 +123,22 @@ class Listener final : public std::enable_shared_from_this<Listener> {
 	}
 
 	private: void onAccept(boost::system::error_code errorCode) {
+		const auto serverConfiguration = publisher->current();
+
 		if (!errorCode) {
 			// ASIO states that following the socket move, the moved-from socket is in the same
 			// state as if constructed using basic_stream_socket<tcp>(io_context &) constructor.
+			auto & tlsContext = serverConfiguration->tlsContext;
+
 			auto session = std::make_shared<HttpSession>(
-				httpSessions, clientSessions, serverConfiguration, std::move(socket)
+				  httpSessions
+				, clientSessions
+				, publisher
+				, tlsContext ? HttpSocket(std::move(socket), *tlsContext) : HttpSocket(std::move(socket))
 			);
 
 			httpSessions.registerSession(session);
-			session->doRead();
+			session->start();
 		} else if (errorCode == boost::system::errc::operation_canceled) {
 			BalauBalauLogInfo(
 				  serverConfiguration->logger
@@ -103,6 +162,20 @@ class Listener final : public std::enable_shared_from_this<Listener> {
 		doAccept();
 	}
 
+	private: void waitForSessions(std::chrono::steady_clock::time_point deadline) {
+		if (httpSessions.size() == 0 || std::chrono::steady_clock::now() >= deadline) {
+			// Sessions still open after the deadline are forcibly closed.
+			close();
+			return;
+		}
+
+		drainTimer.expires_after(std::chrono::milliseconds(10));
+
+		drainTimer.async_wait([self = shared_from_this(), deadline] (const boost::system::error_code & ) {
+			self->waitForSessions(deadline);
+		});
+	}
+
 	private: template <typename ErrorMessageCreator>
 	void checkError(const boost::system::error_code & errorCode, const ErrorMessageCreator & errorMessage) {
 		if (errorCode) {
@@ -115,9 +188,11 @@ class Listener final : public std::enable_shared_from_this<Listener> {
 		return std::shared_ptr<ClientSession>();
 	}
 
-	private: std::shared_ptr<HttpServerConfiguration> serverConfiguration;
+	private: std::shared_ptr<ConfigurationPublisher> publisher;
 	private: TCP::acceptor acceptor;
 	private: TCP::socket socket;
+	private: boost::asio::steady_timer drainTimer;
+	private: std::atomic<bool> closed { false };
 	private: Impl::HttpSessions httpSessions;
 	private: Impl::ClientSessions clientSessions;
 };
@@ -0,0 +1,159 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__REQUEST_ARENA
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__REQUEST_ARENA
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// A monotonic arena for the scratch data of a single request.
+//
+// Allocations are bump allocated from a list of blocks and are never freed
+// individually. The arena is reset between requests, after which the blocks are
+// reused. Once the arena has grown to the size required by the requests of a
+// session, steady state requests thus perform no heap allocations for the data
+// allocated from the arena. Data held in web application API types, such as the
+// request fields and body, is not allocated from the arena.
+//
+// Blocks beyond the retained capacity are released on reset, in order to avoid
+// a single large request pinning memory for the lifetime of a keep-alive session.
+//
+// The arena is not thread safe. Synchronisation is provided by the owning session.
+//
+class RequestArena final {
+	public: static constexpr size_t DefaultBlockSize = 4096;
+	public: static constexpr size_t DefaultRetainedCapacity = 64 * 1024;
+
+	public: explicit RequestArena(size_t blockSize_ = DefaultBlockSize,
+	                              size_t retainedCapacity_ = DefaultRetainedCapacity)
+		: blockSize(blockSize_)
+		, retainedCapacity(retainedCapacity_) {}
+
+	public: RequestArena(const RequestArena &) = delete;
+	public: RequestArena & operator = (const RequestArena &) = delete;
+
+	public: void * allocate(size_t bytes, size_t alignment) {
+		while (blockIndex < blocks.size()) {
+			auto & block = blocks[blockIndex];
+			const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+			const size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+
+			if (aligned + bytes <= block.size) {
+				offset = aligned + bytes;
+				return block.data.get() + aligned;
+			}
+
+			// Move on to the next retained block.
+			++blockIndex;
+			offset = 0;
+		}
+
+		const size_t size = std::max(blockSize, bytes + alignment - 1);
+		blocks.push_back(Block { std::unique_ptr<char[]>(new char[size]), size });
+		++allocatedBlocks;
+
+		const auto base = reinterpret_cast<uintptr_t>(blocks.back().data.get());
+		const size_t aligned = ((base + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+		offset = aligned + bytes;
+		return blocks.back().data.get() + aligned;
+	}
+
+	//
+	// Make all the memory of the arena available again.
+	//
+	// All objects allocated from the arena must have been destroyed.
+	//
+	public: void reset() {
+		size_t retained = 0;
+		size_t count = 0;
+
+		while (count < blocks.size() && retained + blocks[count].size <= retainedCapacity) {
+			retained += blocks[count].size;
+			++count;
+		}
+
+		// The first block is always retained.
+		const size_t keep = std::max(count, std::min(blocks.size(), (size_t) 1));
+		blocks.erase(blocks.begin() + (ptrdiff_t) keep, blocks.end());
+		blockIndex = 0;
+		offset = 0;
+	}
+
+	//
+	// The total number of blocks allocated from the heap during the lifetime of the arena.
+	//
+	public: size_t blockAllocations() const {
+		return allocatedBlocks;
+	}
+
+	private: struct Block {
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	private: const size_t blockSize;
+	private: const size_t retainedCapacity;
+	private: std::vector<Block> blocks;
+	private: size_t blockIndex = 0;
+	private: size_t offset = 0;
+	private: size_t allocatedBlocks = 0;
+};
+
+//
+// Standard allocator that allocates from a request arena.
+//
+// Deallocation is a no-op. The memory is reclaimed when the arena is reset.
+//
+template <typename T> class RequestArenaAllocator {
+	public: using value_type = T;
+
+	public: explicit RequestArenaAllocator(RequestArena & arena_) noexcept : arena(&arena_) {}
+
+	public: template <typename U> RequestArenaAllocator(const RequestArenaAllocator<U> & rhs) noexcept // NOLINT
+		: arena(rhs.arena) {}
+
+	public: T * allocate(size_t n) {
+		return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	public: void deallocate(T * , size_t ) noexcept {}
+
+	public: template <typename U> bool operator == (const RequestArenaAllocator<U> & rhs) const noexcept {
+		return arena == rhs.arena;
+	}
+
+	public: template <typename U> bool operator != (const RequestArenaAllocator<U> & rhs) const noexcept {
+		return arena != rhs.arena;
+	}
+
+	template <typename U> friend class RequestArenaAllocator;
+
+	private: RequestArena * arena;
+};
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__REQUEST_ARENA
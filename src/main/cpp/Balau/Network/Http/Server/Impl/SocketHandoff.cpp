@@ -0,0 +1,236 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "SocketHandoff.hpp"
+#include "../../../../Exception/NetworkExceptions.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Balau::Network::Http::Impl {
+
+namespace {
+
+// Closes the socket when the scope is exited.
+class SocketCloser {
+	public: explicit SocketCloser(int socket_) : socket(socket_) {}
+
+	public: ~SocketCloser() {
+		if (socket >= 0) {
+			::close(socket);
+		}
+	}
+
+	public: SocketCloser(const SocketCloser &) = delete;
+	public: SocketCloser & operator = (const SocketCloser &) = delete;
+
+	private: const int socket;
+};
+
+[[noreturn]] void throwError(const char * operation, const std::string & path) {
+	ThrowBalauException(
+		Exception::NetworkException, ::toString(std::strerror(errno), " - ", operation, " failed for ", path)
+	);
+}
+
+sockaddr_un createAddress(const std::string & path) {
+	sockaddr_un address {};
+
+	if (path.empty() || path.length() >= sizeof(address.sun_path)) {
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("Invalid socket handoff path length: ", path)
+		);
+	}
+
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.data(), path.length());
+	return address;
+}
+
+// Determine whether the peer of the connection runs as the same user as this process.
+bool isSameUser(int connection) {
+	ucred credentials {};
+	socklen_t length = sizeof(credentials);
+
+	if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0 || length != sizeof(credentials)) {
+		return false;
+	}
+
+	return credentials.uid == ::geteuid();
+}
+
+} // namespace
+
+void sendListeningSocket(const std::string & path, int socket) {
+	const auto address = createAddress(path);
+	const int channel = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (channel < 0) {
+		throwError("socket", path);
+	}
+
+	SocketCloser channelCloser(channel);
+
+	if (::connect(channel, (const sockaddr *) &address, sizeof(address)) != 0) {
+		throwError("connect", path);
+	}
+
+	// At least one byte of normal data must accompany the ancillary data.
+	char payload = 0;
+	iovec io { &payload, 1 };
+
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] {};
+
+	msghdr message {};
+	message.msg_iov = &io;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	cmsghdr * header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(int));
+	std::memcpy(CMSG_DATA(header), &socket, sizeof(int));
+
+	if (::sendmsg(channel, &message, MSG_NOSIGNAL) != 1) {
+		throwError("sendmsg", path);
+	}
+}
+
+int receiveListeningSocket(const std::string & path, std::chrono::milliseconds timeout) {
+	const auto address = createAddress(path);
+	const int channel = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (channel < 0) {
+		throwError("socket", path);
+	}
+
+	SocketCloser channelCloser(channel);
+	::unlink(path.c_str());
+
+	if (::bind(channel, (const sockaddr *) &address, sizeof(address)) != 0) {
+		throwError("bind", path);
+	}
+
+	if (::listen(channel, 1) != 0) {
+		const int error = errno;
+		::unlink(path.c_str());
+		errno = error;
+		throwError("listen", path);
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	int connection;
+
+	// Connections from processes running as other users are rejected, and the
+	// wait continues for the predecessor until the timeout expires.
+	while (true) {
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now()
+		);
+
+		pollfd pollEntry { channel, POLLIN, 0 };
+		const int ready = remaining.count() > 0 ? ::poll(&pollEntry, 1, (int) remaining.count()) : 0;
+
+		if (ready < 0 && errno == EINTR) {
+			continue;
+		}
+
+		if (ready <= 0) {
+			const int error = ready == 0 ? ETIMEDOUT : errno;
+			::unlink(path.c_str());
+			errno = error;
+			throwError("poll", path);
+		}
+
+		connection = ::accept(channel, nullptr, nullptr);
+
+		if (connection < 0) {
+			const int acceptError = errno;
+			::unlink(path.c_str());
+			errno = acceptError;
+			throwError("accept", path);
+		}
+
+		if (isSameUser(connection)) {
+			break;
+		}
+
+		::close(connection);
+	}
+
+	::unlink(path.c_str());
+	SocketCloser connectionCloser(connection);
+
+	char payload = 0;
+	iovec io { &payload, 1 };
+
+	alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] {};
+
+	msghdr message {};
+	message.msg_iov = &io;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	if (::recvmsg(connection, &message, MSG_CMSG_CLOEXEC) != 1) {
+		throwError("recvmsg", path);
+	}
+
+	cmsghdr * header = CMSG_FIRSTHDR(&message);
+
+	// A truncated control message may have carried more descriptors than were
+	// expected. Any that were received are closed and the handoff is rejected.
+	if ((message.msg_flags & MSG_CTRUNC) != 0) {
+		if (header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+			const size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+			for (size_t m = 0; m < count; ++m) {
+				int received;
+				std::memcpy(&received, CMSG_DATA(header) + m * sizeof(int), sizeof(int));
+				::close(received);
+			}
+		}
+
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("Truncated ancillary data received via ", path)
+		);
+	}
+
+	if (header == nullptr
+		|| header->cmsg_level != SOL_SOCKET
+		|| header->cmsg_type != SCM_RIGHTS
+		|| header->cmsg_len != CMSG_LEN(sizeof(int))) {
+		ThrowBalauException(
+			Exception::NetworkException, ::toString("No listening socket received via ", path)
+		);
+	}
+
+	int socket;
+	std::memcpy(&socket, CMSG_DATA(header), sizeof(int));
+	return socket;
+}
+
+} // namespace Balau::Network::Http::Impl
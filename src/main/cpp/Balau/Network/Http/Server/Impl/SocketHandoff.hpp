@@ -0,0 +1,55 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__SOCKET_HANDOFF
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__SOCKET_HANDOFF
+
+#include <chrono>
+#include <string>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// Send the supplied listening socket to the process waiting on the Unix domain
+// socket at the specified path.
+//
+// The socket is passed as SCM_RIGHTS ancillary data. The calling process retains
+// its own copy of the socket.
+//
+// @throw NetworkException if the socket could not be sent
+//
+void sendListeningSocket(const std::string & path, int socket);
+
+//
+// Wait for a listening socket to be sent by a predecessor process to the Unix
+// domain socket at the specified path.
+//
+// Any existing file at the path is removed before binding and after the socket
+// has been received. Connections from processes running as a different user are
+// closed without receiving from them, and ancillary data that was truncated is
+// rejected.
+//
+// @return the received socket
+// @throw NetworkException if no socket was received before the timeout expired or the receive failed
+//
+int receiveListeningSocket(const std::string & path, std::chrono::milliseconds timeout);
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__SOCKET_HANDOFF
@@ -0,0 +1,123 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "TlsContext.hpp"
+#include "../../../../Exception/NetworkExceptions.hpp"
+
+namespace Balau::Network::Http::Impl {
+
+namespace {
+
+// ALPN protocol lists, in the wire format and in order of server preference.
+const unsigned char Http2AndHttp1Protocols[] = "\x02h2\x08http/1.1";
+const unsigned char Http1Protocols[] = "\x08http/1.1";
+
+int selectHttp2AndHttp1(::SSL * , const unsigned char ** out, unsigned char * outLength,
+                          const unsigned char * in, unsigned int inLength, void * ) {
+	const auto result = SSL_select_next_proto(
+		  (unsigned char **) out
+		, outLength
+		, Http2AndHttp1Protocols
+		, sizeof(Http2AndHttp1Protocols) - 1
+		, in
+		, inLength
+	);
+
+	return result == OPENSSL_NPN_NEGOTIATED ? SSL_TLSEXT_ERR_OK : SSL_TLSEXT_ERR_NOACK;
+}
+
+int selectHttp1(::SSL * , const unsigned char ** out, unsigned char * outLength,
+                  const unsigned char * in, unsigned int inLength, void * ) {
+	const auto result = SSL_select_next_proto(
+		(unsigned char **) out, outLength, Http1Protocols, sizeof(Http1Protocols) - 1, in, inLength
+	);
+
+	return result == OPENSSL_NPN_NEGOTIATED ? SSL_TLSEXT_ERR_OK : SSL_TLSEXT_ERR_NOACK;
+}
+
+// Sessions are only resumed by servers sharing the same context identifier.
+const unsigned char SessionIdContext[] = "balau.http.server";
+
+} // namespace
+
+std::shared_ptr<SSL::context> createTlsContext(const TlsSettings & settings, bool http2Enabled) {
+	settings.validate();
+
+	auto context = std::make_shared<SSL::context>(SSL::context::tls_server);
+
+	context->set_options(
+		SSL::context::default_workarounds | SSL::context::no_sslv2 | SSL::context::no_sslv3 | SSL::context::single_dh_use
+	);
+
+	boost::system::error_code errorCode;
+	const auto chainPath = settings.certificateChain.getEntry().path().string();
+	const auto keyPath = settings.privateKey.getEntry().path().string();
+
+	context->use_certificate_chain_file(chainPath, errorCode);
+
+	if (errorCode) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Could not load TLS certificate chain ", chainPath, ": ", errorCode.message())
+		);
+	}
+
+	context->use_private_key_file(keyPath, SSL::context::pem, errorCode);
+
+	if (errorCode) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Could not load TLS private key ", keyPath, ": ", errorCode.message())
+		);
+	}
+
+	auto * handle = context->native_handle();
+
+	SSL_CTX_set_min_proto_version(handle, settings.minimumVersion == "1.3" ? TLS1_3_VERSION : TLS1_2_VERSION);
+	SSL_CTX_set_session_id_context(handle, SessionIdContext, sizeof(SessionIdContext) - 1);
+	SSL_CTX_set_timeout(handle, (long) settings.sessionTimeout);
+
+	if (settings.sessionCache) {
+		SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_SERVER);
+		SSL_CTX_sess_set_cache_size(handle, settings.sessionCacheSize);
+	} else {
+		SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_OFF);
+	}
+
+	if (!settings.sessionTickets) {
+		SSL_CTX_set_options(handle, SSL_OP_NO_TICKET);
+
+		// Without the cache, TLS 1.3 would otherwise still issue (stateful) tickets.
+		if (!settings.sessionCache) {
+			SSL_CTX_set_num_tickets(handle, 0);
+		}
+	}
+
+	SSL_CTX_set_alpn_select_cb(handle, http2Enabled ? selectHttp2AndHttp1 : selectHttp1, nullptr);
+	return context;
+}
+
+std::string_view alpnProtocol(SSL::stream<TCP::socket> & stream) {
+	const unsigned char * protocol = nullptr;
+	unsigned int length = 0;
+	SSL_get0_alpn_selected(stream.native_handle(), &protocol, &length);
+	return protocol ? std::string_view((const char *) protocol, length) : std::string_view();
+}
+
+} // namespace Balau::Network::Http::Impl
@@ -0,0 +1,55 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__TLS_CONTEXT
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__TLS_CONTEXT
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <Balau/Network/Http/Server/TlsSettings.hpp>
+
+#include <string_view>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// The ALPN protocol identifier of HTTP/2 over TLS.
+//
+constexpr std::string_view AlpnHttp2 = "h2";
+
+//
+// Create the server TLS context from the supplied settings.
+//
+// The context offers h2 and http/1.1 via ALPN if HTTP/2 is enabled, otherwise
+// http/1.1 only. Clients that do not use ALPN are served via HTTP/1.
+//
+// @throw IllegalArgumentException if a setting is invalid
+// @throw NetworkException if the certificate chain or private key could not be loaded
+//
+std::shared_ptr<SSL::context> createTlsContext(const TlsSettings & settings, bool http2Enabled);
+
+//
+// Get the protocol negotiated via ALPN during the handshake of the supplied TLS stream.
+//
+// @return the protocol identifier, or an empty view if no protocol was negotiated
+//
+std::string_view alpnProtocol(SSL::stream<TCP::socket> & stream);
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__TLS_CONTEXT
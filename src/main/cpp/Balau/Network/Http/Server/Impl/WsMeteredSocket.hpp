@@ -0,0 +1,221 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_METERED_SOCKET
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_METERED_SOCKET
+
+#include <Balau/Network/Http/Server/WsCompression.hpp>
+#include <Balau/Network/Http/Server/Impl/HttpSocket.hpp>
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/version.hpp>
+
+#include <ctime>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// Accumulates the thread CPU time spent within nested scopes into a counter.
+//
+// Only the outermost scope on a thread measures the time, thus nested scopes
+// are not counted twice. A suspension excludes the enclosed code (such as web
+// application handlers) from the measurement of the active scope.
+//
+class WsCpuMeter final {
+	private: struct State {
+		int depth = 0;
+		std::atomic<int64_t> * counter = nullptr;
+		int64_t start = 0;
+	};
+
+	private: static State & threadState() {
+		thread_local State state;
+		return state;
+	}
+
+	private: static int64_t now() {
+		timespec time {};
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+		return (int64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+	}
+
+	public: class Scope final {
+		public: explicit Scope(std::atomic<int64_t> & counter) {
+			auto & state = threadState();
+
+			if (state.depth++ == 0) {
+				state.counter = &counter;
+				state.start = now();
+			}
+		}
+
+		public: Scope(const Scope & ) = delete;
+		public: Scope & operator = (const Scope & ) = delete;
+
+		public: ~Scope() {
+			auto & state = threadState();
+
+			if (--state.depth == 0) {
+				state.counter->fetch_add(now() - state.start, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	public: class Suspension final {
+		public: Suspension() : state(threadState()), depth(state.depth), counter(state.counter) {
+			if (depth > 0) {
+				counter->fetch_add(now() - state.start, std::memory_order_relaxed);
+				state.depth = 0;
+			}
+		}
+
+		public: Suspension(const Suspension & ) = delete;
+		public: Suspension & operator = (const Suspension & ) = delete;
+
+		public: ~Suspension() {
+			if (depth > 0) {
+				state.depth = depth;
+				state.counter = counter;
+				state.start = now();
+			}
+		}
+
+		private: State & state;
+		private: const int depth;
+		private: std::atomic<int64_t> * const counter;
+	};
+};
+
+//
+// The next layer of the WebSocket stream of WebSocket sessions.
+//
+// Forwards to the HTTP socket, counting the bytes read and written and measuring
+// the CPU time spent in the completion handlers, which is where the WebSocket
+// stream performs its framing and (de)compression.
+//
+// Completion handlers retain their associated executor, thus the session's strand
+// continues to be used for the stream's intermediate handlers.
+//
+// This class is not final, as Boost Asio's executor detection derives from it.
+//
+class WsMeteredSocket {
+	public: using executor_type = HttpSocket::executor_type;
+	public: using next_layer_type = HttpSocket;
+	public: using lowest_layer_type = HttpSocket::lowest_layer_type;
+
+	public: WsMeteredSocket(HttpSocket && socket_, WsCompressionMetrics & metrics_)
+		: socket(std::move(socket_))
+		, metrics(metrics_) {}
+
+	public: executor_type get_executor() noexcept {
+		return socket.get_executor();
+	}
+
+	public: next_layer_type & next_layer() {
+		return socket;
+	}
+
+	public: lowest_layer_type & lowest_layer() {
+		return socket.lowest_layer();
+	}
+
+	public: template <typename MutableBufferSequence, typename ReadHandler>
+	void async_read_some(const MutableBufferSequence & buffers, ReadHandler && handler) {
+		auto executor = boost::asio::get_associated_executor(handler, socket.get_executor());
+
+		socket.async_read_some(
+			  buffers
+			, boost::asio::bind_executor(
+				  executor
+				, Completion<typename std::decay<ReadHandler>::type>(
+					std::forward<ReadHandler>(handler), metrics.wireBytesReadCount, metrics.readCpuNanoseconds
+				)
+			)
+		);
+	}
+
+	public: template <typename ConstBufferSequence, typename WriteHandler>
+	void async_write_some(const ConstBufferSequence & buffers, WriteHandler && handler) {
+		auto executor = boost::asio::get_associated_executor(handler, socket.get_executor());
+
+		socket.async_write_some(
+			  buffers
+			, boost::asio::bind_executor(
+				  executor
+				, Completion<typename std::decay<WriteHandler>::type>(
+					std::forward<WriteHandler>(handler), metrics.wireBytesWrittenCount, metrics.writeCpuNanoseconds
+				)
+			)
+		);
+	}
+
+	public: template <typename MutableBufferSequence>
+	size_t read_some(const MutableBufferSequence & buffers, boost::system::error_code & ec) {
+		const size_t bytes = socket.read_some(buffers, ec);
+		metrics.wireBytesReadCount.fetch_add(bytes, std::memory_order_relaxed);
+		return bytes;
+	}
+
+	public: template <typename ConstBufferSequence>
+	size_t write_some(const ConstBufferSequence & buffers, boost::system::error_code & ec) {
+		const size_t bytes = socket.write_some(buffers, ec);
+		metrics.wireBytesWrittenCount.fetch_add(bytes, std::memory_order_relaxed);
+		return bytes;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: template <typename HandlerT> class Completion {
+		public: Completion(HandlerT && handler_, std::atomic<size_t> & bytes_, std::atomic<int64_t> & cpu_)
+			: handler(std::move(handler_))
+			, bytes(bytes_)
+			, cpu(cpu_) {}
+
+		public: void operator () (boost::system::error_code ec, size_t bytesTransferred) {
+			bytes.fetch_add(bytesTransferred, std::memory_order_relaxed);
+			WsCpuMeter::Scope scope(cpu);
+			handler(ec, bytesTransferred);
+		}
+
+		private: HandlerT handler;
+		private: std::atomic<size_t> & bytes;
+		private: std::atomic<int64_t> & cpu;
+	};
+
+	private: HttpSocket socket;
+	private: WsCompressionMetrics & metrics;
+};
+
+//
+// WebSocket teardown customisation points for the metered socket.
+//
+inline void teardown(WsRoleType role, WsMeteredSocket & socket, boost::system::error_code & ec) {
+	using boost::beast::websocket::teardown;
+	teardown(role, socket.next_layer(), ec);
+}
+
+template <typename TeardownHandler>
+inline void async_teardown(WsRoleType role, WsMeteredSocket & socket, TeardownHandler && handler) {
+	using boost::beast::websocket::async_teardown;
+	async_teardown(role, socket.next_layer(), std::forward<TeardownHandler>(handler));
+}
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_METERED_SOCKET
@@ -0,0 +1,134 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_OUTBOUND_QUEUE
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_OUTBOUND_QUEUE
+
+#include <Balau/Network/Http/Server/WsMessage.hpp>
+
+#include <deque>
+
+namespace Balau::Network::Http::Impl {
+
+//
+// The bounded outbound message queue of a WebSocket session.
+//
+// The queue applies the slow consumer policy when a message is pushed onto a
+// full queue. The queue is not thread safe. Synchronisation is provided by the
+// owning session.
+//
+class WsOutboundQueue final {
+	//
+	// The outcome of a push. Dropped indicates that a message was discarded,
+	// either the pushed message or the oldest queued message.
+	//
+	public: enum class Result { Queued, Dropped, Coalesced, Overflow };
+
+	public: WsOutboundQueue(size_t capacity_, WsSlowConsumerPolicy policy_)
+		: capacity(capacity_ == 0 ? 1 : capacity_)
+		, policy(policy_) {}
+
+	public: void configure(size_t capacity_, WsSlowConsumerPolicy policy_) {
+		capacity = capacity_ == 0 ? 1 : capacity_;
+		policy = policy_;
+
+		while (messages.size() > capacity) {
+			messages.pop_front();
+		}
+	}
+
+	public: Result push(std::shared_ptr<const WsMessage> message) {
+		if (messages.size() < capacity) {
+			messages.emplace_back(std::move(message));
+			return Result::Queued;
+		}
+
+		switch (policy) {
+			case WsSlowConsumerPolicy::Drop: {
+				return Result::Dropped;
+			}
+
+			case WsSlowConsumerPolicy::Coalesce: {
+				if (!message->key().empty()) {
+					for (auto & queued : messages) {
+						if (queued->key() == message->key()) {
+							queued = std::move(message);
+							return Result::Coalesced;
+						}
+					}
+				}
+
+				// The oldest message is discarded in order to queue the new one.
+				messages.pop_front();
+				messages.emplace_back(std::move(message));
+				return Result::Dropped;
+			}
+
+			default: {
+				return Result::Overflow;
+			}
+		}
+	}
+
+	// Returns null if the queue is empty.
+	public: std::shared_ptr<const WsMessage> pop() {
+		if (messages.empty()) {
+			return std::shared_ptr<const WsMessage>();
+		}
+
+		auto message = std::move(messages.front());
+		messages.pop_front();
+		return message;
+	}
+
+	public: void clear() {
+		messages.clear();
+	}
+
+	public: size_t size() const {
+		return messages.size();
+	}
+
+	public: bool empty() const {
+		return messages.empty();
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: std::deque<std::shared_ptr<const WsMessage>> messages;
+	private: size_t capacity;
+	private: WsSlowConsumerPolicy policy;
+};
+
+//
+// Print the outbound queue push result as a UTF-8 string.
+//
+inline std::string toString(WsOutboundQueue::Result result) {
+	switch (result) {
+		case WsOutboundQueue::Result::Queued:    return "Queued";
+		case WsOutboundQueue::Result::Dropped:   return "Dropped";
+		case WsOutboundQueue::Result::Coalesced: return "Coalesced";
+		case WsOutboundQueue::Result::Overflow:  return "Overflow";
+		default: return "Unknown";
+	}
+}
+
+} // namespace Balau::Network::Http::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER_IMPL__WS_OUTBOUND_QUEUE
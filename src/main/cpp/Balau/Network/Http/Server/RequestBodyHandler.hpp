@@ -0,0 +1,99 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file RequestBodyHandler.hpp
+///
+/// Abstract base class of handlers that consume request bodies incrementally.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__REQUEST_BODY_HANDLER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__REQUEST_BODY_HANDLER
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <limits>
+#include <map>
+
+namespace Balau::Network::Http {
+
+class HttpSession;
+
+///
+/// Abstract base class of handlers that consume request bodies incrementally.
+///
+/// Request body handlers are created by HTTP web applications that override the
+/// HttpWebApp::createPostBodyHandler method. The HTTP session reads the body in
+/// fixed size chunks and passes each chunk to the handler as it arrives. The body
+/// is thus never buffered in its entirety, and the memory used per request is
+/// bounded by the chunk size of the session.
+///
+/// Body handlers are used by a single HTTP session and are destroyed at the end
+/// of the request.
+///
+class RequestBodyHandler {
+	///
+	/// The default maximum size of a streamed request body (64 MiB).
+	///
+	public: static constexpr uint64_t DefaultMaxBodySize = 64 * 1024 * 1024;
+
+	///
+	/// Get the maximum size of the request body accepted by the handler.
+	///
+	/// Requests with larger bodies are rejected with a 413 response and the
+	/// connection is closed. The excess data is not passed to the handler.
+	///
+	public: virtual uint64_t maxBodySize() const {
+		return DefaultMaxBodySize;
+	}
+
+	///
+	/// Consume the next chunk of the request body.
+	///
+	/// The chunk data is valid only for the duration of the call.
+	///
+	/// Throwing an exception aborts the request. A server error response is sent
+	/// and the connection is closed.
+	///
+	/// @param chunk the next chunk of the request body
+	///
+	public: virtual void onBodyChunk(std::string_view chunk) = 0;
+
+	///
+	/// Called when the request body has been received in full.
+	///
+	/// The handler must send the response via the supplied session.
+	///
+	/// @param session the HTTP session object, also containing the client session
+	/// @param request the HTTP request object, containing the header fields and an empty body
+	/// @param variables the request variables that are generated and consumed during the request
+	///
+	public: virtual void onBodyComplete(HttpSession & session,
+	                                    const StringRequest & request,
+	                                    std::map<std::string, std::string> & variables) = 0;
+
+	///
+	/// Destroy the request body handler instance.
+	///
+	public: virtual ~RequestBodyHandler() = default;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__REQUEST_BODY_HANDLER
@@ -0,0 +1,101 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "TlsSettings.hpp"
+#include "../../../Application/EnvironmentProperties.hpp"
+
+namespace Balau::Network::Http {
+
+namespace {
+
+Resource::File getFile(const EnvironmentProperties & configuration, const char * name) {
+	if (!configuration.hasUnique<Resource::Uri>(name)) {
+		return Resource::File();
+	}
+
+	auto uri = configuration.getUnique<Resource::Uri>(name);
+	auto file = dynamic_cast<Resource::File *>(uri.get());
+
+	if (!file) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("TLS setting ", name, " must be a file on the local file system.")
+		);
+	}
+
+	return *file;
+}
+
+void validateFile(const char * name, const Resource::File & file) {
+	if (!file.exists() || !file.isRegularFile()) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("TLS setting ", name, " = ", file, " is not an existing file.")
+		);
+	}
+}
+
+void validatePositive(const char * name, int value) {
+	if (value <= 0) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("TLS setting ", name, " = ", value, " must be positive.")
+		);
+	}
+}
+
+} // namespace
+
+TlsSettings TlsSettings::fromConfiguration(const EnvironmentProperties & configuration) {
+	const TlsSettings defaults;
+	TlsSettings settings;
+
+	settings.enabled = configuration.getValue<bool>("enabled", defaults.enabled);
+	settings.certificateChain = getFile(configuration, "certificate.chain");
+	settings.privateKey = getFile(configuration, "private.key");
+	settings.minimumVersion = configuration.getValue<std::string>("min.version", defaults.minimumVersion);
+	settings.sessionCache = configuration.getValue<bool>("session.cache", defaults.sessionCache);
+	settings.sessionCacheSize = configuration.getValue<int>("session.cache.size", defaults.sessionCacheSize);
+	settings.sessionTimeout = configuration.getValue<int>("session.timeout", defaults.sessionTimeout);
+	settings.sessionTickets = configuration.getValue<bool>("session.tickets", defaults.sessionTickets);
+
+	settings.validate();
+	return settings;
+}
+
+void TlsSettings::validate() const {
+	if (!enabled) {
+		return;
+	}
+
+	validateFile("certificate.chain", certificateChain);
+	validateFile("private.key", privateKey);
+
+	if (minimumVersion != "1.2" && minimumVersion != "1.3") {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("TLS setting min.version = ", minimumVersion, " is not one of 1.2 or 1.3.")
+		);
+	}
+
+	validatePositive("session.cache.size", sessionCacheSize);
+	validatePositive("session.timeout", sessionTimeout);
+}
+
+} // namespace Balau::Network::Http
@@ -0,0 +1,112 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file TlsSettings.hpp
+///
+/// TLS settings of the HTTP server.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__TLS_SETTINGS
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__TLS_SETTINGS
+
+#include <Balau/Resource/File.hpp>
+
+#include <string>
+
+namespace Balau {
+
+class EnvironmentProperties;
+
+namespace Network::Http {
+
+///
+/// TLS settings of the HTTP server.
+///
+/// When TLS is enabled, the server performs a TLS handshake on each accepted
+/// connection before reading the first request. The protocol of the connection
+/// is negotiated via ALPN, thus HTTP/2 (h2) is used when HTTP/2 is enabled and
+/// the client offers it.
+///
+/// Sessions can be resumed via the server side session cache and via session
+/// tickets, avoiding the full handshake for returning clients.
+///
+struct TlsSettings {
+	///
+	/// True if the server terminates TLS.
+	///
+	bool enabled = false;
+
+	///
+	/// The PEM file containing the server certificate, followed by any intermediate certificates.
+	///
+	Resource::File certificateChain;
+
+	///
+	/// The PEM file containing the private key of the server certificate.
+	///
+	Resource::File privateKey;
+
+	///
+	/// The minimum accepted TLS protocol version ("1.2" or "1.3").
+	///
+	std::string minimumVersion = "1.2";
+
+	///
+	/// True if the server side session cache is enabled.
+	///
+	bool sessionCache = true;
+
+	///
+	/// The maximum number of sessions held in the server side session cache.
+	///
+	int sessionCacheSize = 20480;
+
+	///
+	/// The lifetime of cached sessions and session tickets, in seconds.
+	///
+	int sessionTimeout = 300;
+
+	///
+	/// True if session tickets are issued to clients.
+	///
+	bool sessionTickets = true;
+
+	///
+	/// Create settings from a tls configuration composite.
+	///
+	/// Settings that are not present in the configuration take their default values.
+	///
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	static TlsSettings fromConfiguration(const EnvironmentProperties & configuration);
+
+	///
+	/// Validate the settings.
+	///
+	/// @throw IllegalArgumentException if a setting is invalid
+	///
+	void validate() const;
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__TLS_SETTINGS
@@ -0,0 +1,209 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "WsBroadcaster.hpp"
+#include "WsSession.hpp"
+
+namespace Balau::Network::Http {
+
+namespace {
+
+// The maximum number of deliveries processed by a drain handler before it yields.
+constexpr size_t MaxDeliveriesPerDrain = 16;
+
+} // namespace
+
+WsBroadcaster::WsBroadcaster(size_t laneCount_)
+	: laneCount(laneCount_ == 0 ? 1 : laneCount_) {}
+
+void WsBroadcaster::subscribe(const std::string & topic, const std::shared_ptr<WsSession> & session) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto & subscribers = topics[topic];
+
+	if (subscribers.find(session.get()) == subscribers.end()) {
+		subscribers.emplace(session.get(), Subscriber { session, acquireLane(*session) });
+	}
+}
+
+void WsBroadcaster::unsubscribe(const std::string & topic, const WsSession & session) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto iter = topics.find(topic);
+
+	if (iter != topics.end()) {
+		auto s = iter->second.find(&session);
+
+		if (s != iter->second.end()) {
+			eraseSubscriber(iter->second, s);
+		}
+
+		if (iter->second.empty()) {
+			topics.erase(iter);
+		}
+	}
+}
+
+void WsBroadcaster::unsubscribe(const WsSession & session) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto iter = topics.begin(); iter != topics.end(); ) {
+		auto s = iter->second.find(&session);
+
+		if (s != iter->second.end()) {
+			eraseSubscriber(iter->second, s);
+		}
+
+		iter = iter->second.empty() ? topics.erase(iter) : std::next(iter);
+	}
+}
+
+size_t WsBroadcaster::publish(const std::string & topic, const std::shared_ptr<const WsMessage> & message) {
+	// The delivery batch of each lane, keyed by the lane.
+	std::unordered_map<Lane *, std::pair<std::shared_ptr<Lane>, std::vector<std::shared_ptr<WsSession>>>> batches;
+	size_t count = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto iter = topics.find(topic);
+
+		if (iter == topics.end()) {
+			return 0;
+		}
+
+		auto & subscribers = iter->second;
+
+		for (auto s = subscribers.begin(); s != subscribers.end(); ) {
+			auto session = s->second.session.lock();
+
+			if (!session) {
+				s = eraseSubscriber(subscribers, s);
+				continue;
+			}
+
+			auto & batch = batches[s->second.lane.get()];
+
+			if (!batch.first) {
+				batch.first = s->second.lane;
+			}
+
+			batch.second.emplace_back(std::move(session));
+			++count;
+			++s;
+		}
+
+		if (subscribers.empty()) {
+			topics.erase(iter);
+		}
+	}
+
+	for (auto & batch : batches) {
+		const auto & lane = batch.second.first;
+		bool startDraining = false;
+
+		{
+			std::lock_guard<std::mutex> lock(lane->mutex);
+			lane->deliveries.emplace_back(Delivery { message, std::move(batch.second.second) });
+
+			if (!lane->draining) {
+				lane->draining = true;
+				startDraining = true;
+			}
+		}
+
+		if (startDraining) {
+			boost::asio::post(lane->context, [lane] () { drain(lane); });
+		}
+	}
+
+	return count;
+}
+
+size_t WsBroadcaster::subscriberCount(const std::string & topic) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto iter = topics.find(topic);
+	return iter == topics.end() ? 0 : iter->second.size();
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+std::shared_ptr<WsBroadcaster::Lane> WsBroadcaster::acquireLane(const WsSession & session) {
+	// Executed with the mutex locked.
+	auto & context = session.ioContext();
+	auto & entry = contextLanes[&context];
+
+	if (entry.lanes.empty()) {
+		entry.lanes.reserve(laneCount);
+
+		for (size_t m = 0; m < laneCount; ++m) {
+			entry.lanes.emplace_back(std::make_shared<Lane>(context));
+		}
+	}
+
+	++entry.subscriptionCount;
+
+	// A session uses the same lane for all of its subscriptions, preserving publication order across topics.
+	return entry.lanes[std::hash<const WsSession *>()(&session) % laneCount];
+}
+
+WsBroadcaster::Subscribers::iterator WsBroadcaster::eraseSubscriber(Subscribers & subscribers, Subscribers::iterator iter) {
+	// Executed with the mutex locked.
+	auto entry = contextLanes.find(&iter->second.lane->context);
+
+	// The lanes of an IO context are released when it has no more subscriptions.
+	if (entry != contextLanes.end() && --entry->second.subscriptionCount == 0) {
+		contextLanes.erase(entry);
+	}
+
+	return subscribers.erase(iter);
+}
+
+void WsBroadcaster::drain(const std::shared_ptr<Lane> & lane) {
+	for (size_t m = 0; m < MaxDeliveriesPerDrain; ++m) {
+		Delivery delivery;
+
+		{
+			std::lock_guard<std::mutex> lock(lane->mutex);
+
+			if (lane->deliveries.empty()) {
+				lane->draining = false;
+				return;
+			}
+
+			delivery = std::move(lane->deliveries.front());
+			lane->deliveries.pop_front();
+		}
+
+		for (const auto & session : delivery.sessions) {
+			session->send(delivery.message);
+		}
+	}
+
+	// Yield to other handlers and continue draining in a new handler.
+	{
+		std::lock_guard<std::mutex> lock(lane->mutex);
+
+		if (lane->deliveries.empty()) {
+			lane->draining = false;
+			return;
+		}
+	}
+
+	boost::asio::post(lane->context, [lane] () { drain(lane); });
+}
+
+} // namespace Balau::Network::Http
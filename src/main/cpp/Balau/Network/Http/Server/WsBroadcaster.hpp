@@ -0,0 +1,175 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file WsBroadcaster.hpp
+///
+/// Topic based publish/subscribe broadcasting of messages to WebSocket sessions.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_BROADCASTER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_BROADCASTER
+
+#include <Balau/Network/Http/Server/WsMessage.hpp>
+
+#include <boost/asio/io_context.hpp>
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Balau::Network::Http {
+
+class WsSession;
+
+///
+/// Topic based publish/subscribe broadcasting of messages to WebSocket sessions.
+///
+/// A published message is created once and the same immutable message is then
+/// placed in the outbound queue of each subscribed session. The slow consumer
+/// policy of each session determines what happens when its outbound queue is full.
+///
+/// Each IO context that has subscribed sessions has its own set of lanes, and
+/// the subscribers of an IO context are partitioned into its lanes. When a
+/// message is published, a single delivery batch is created for each lane and
+/// the batch is delivered by a handler posted to the lane's IO context. Each
+/// lane is drained by at most one handler at a time, thus the messages are
+/// delivered to each session in publication order, whilst different lanes are
+/// processed in parallel by the worker threads of their IO contexts.
+///
+/// Sessions are held via weak pointers. Sessions that have been destroyed are
+/// removed from the subscriptions during publication.
+///
+/// All methods are thread safe.
+///
+class WsBroadcaster final {
+	///
+	/// The default number of delivery lanes per IO context.
+	///
+	public: static constexpr size_t DefaultLaneCount = 16;
+
+	///
+	/// Create a broadcaster.
+	///
+	/// @param laneCount_ the number of delivery lanes per IO context
+	///
+	public: explicit WsBroadcaster(size_t laneCount_ = DefaultLaneCount);
+
+	public: WsBroadcaster(const WsBroadcaster & ) = delete;
+	public: WsBroadcaster & operator = (const WsBroadcaster & ) = delete;
+
+	///
+	/// Subscribe the session to the topic.
+	///
+	/// Subscribing a session that is already subscribed to the topic has no effect.
+	///
+	public: void subscribe(const std::string & topic, const std::shared_ptr<WsSession> & session);
+
+	///
+	/// Unsubscribe the session from the topic.
+	///
+	public: void unsubscribe(const std::string & topic, const WsSession & session);
+
+	///
+	/// Unsubscribe the session from all topics.
+	///
+	public: void unsubscribe(const WsSession & session);
+
+	///
+	/// Publish the message to all sessions subscribed to the topic.
+	///
+	/// The message is delivered asynchronously.
+	///
+	/// @return the number of sessions to which the message will be delivered
+	///
+	public: size_t publish(const std::string & topic, const std::shared_ptr<const WsMessage> & message);
+
+	///
+	/// Publish a text message to all sessions subscribed to the topic.
+	///
+	/// The topic is used as the coalescing key of the message.
+	///
+	/// @return the number of sessions to which the message will be delivered
+	///
+	public: size_t publishText(const std::string & topic, std::string payload) {
+		return publish(topic, WsMessage::text(std::move(payload), topic));
+	}
+
+	///
+	/// Publish a binary message to all sessions subscribed to the topic.
+	///
+	/// The topic is used as the coalescing key of the message.
+	///
+	/// @return the number of sessions to which the message will be delivered
+	///
+	public: size_t publishBinary(const std::string & topic, std::string payload) {
+		return publish(topic, WsMessage::binary(std::move(payload), topic));
+	}
+
+	///
+	/// Get the number of sessions subscribed to the topic.
+	///
+	/// The count may include sessions that have been destroyed since the last publication.
+	///
+	public: size_t subscriberCount(const std::string & topic) const;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: struct Delivery {
+		std::shared_ptr<const WsMessage> message;
+		std::vector<std::shared_ptr<WsSession>> sessions;
+	};
+
+	private: struct Lane {
+		explicit Lane(boost::asio::io_context & context_)
+			: context(context_) {}
+
+		boost::asio::io_context & context;
+		std::mutex mutex;
+		std::deque<Delivery> deliveries;
+		bool draining = false;
+	};
+
+	// The lanes of an IO context, and the number of subscriptions that use them.
+	private: struct ContextLanes {
+		std::vector<std::shared_ptr<Lane>> lanes;
+		size_t subscriptionCount = 0;
+	};
+
+	private: struct Subscriber {
+		std::weak_ptr<WsSession> session;
+		std::shared_ptr<Lane> lane;
+	};
+
+	private: using Subscribers = std::unordered_map<const WsSession *, Subscriber>;
+
+	private: std::shared_ptr<Lane> acquireLane(const WsSession & session);
+	private: Subscribers::iterator eraseSubscriber(Subscribers & subscribers, Subscribers::iterator iter);
+	private: static void drain(const std::shared_ptr<Lane> & lane);
+
+	private: const size_t laneCount;
+	private: mutable std::mutex mutex;
+	private: std::unordered_map<const boost::asio::io_context *, ContextLanes> contextLanes;
+	private: std::unordered_map<std::string, Subscribers> topics;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_BROADCASTER
@@ -0,0 +1,192 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "WsCompression.hpp"
+#include "../../../Application/EnvironmentProperties.hpp"
+#include "../../../Util/Strings.hpp"
+
+#include <regex>
+
+namespace Balau::Network::Http {
+
+namespace {
+
+template <typename OptionT, typename = void> struct HasMessageSizeThreshold : std::false_type {};
+
+template <typename OptionT>
+struct HasMessageSizeThreshold<OptionT, std::void_t<decltype(std::declval<OptionT &>().msg_size_threshold)>>
+	: std::true_type {};
+
+// The message size threshold is only available in later versions of Boost Beast.
+template <typename OptionT> void setMessageSizeThreshold(OptionT & option, size_t size) {
+	if constexpr (HasMessageSizeThreshold<OptionT>::value) {
+		option.msg_size_threshold = size;
+	}
+}
+
+void validateRange(const char * name, int value, int minimum, int maximum) {
+	if (value < minimum || value > maximum) {
+		ThrowBalauException(
+			  Exception::IllegalArgumentException
+			, ::toString("WebSocket deflate setting ", name, " = ", value, " is not in the range ", minimum, " to ", maximum, ".")
+		);
+	}
+}
+
+bool matchesLocation(std::string_view path, std::string_view location) {
+	if (location.empty() || location == "/") {
+		return true;
+	}
+
+	if (path.length() < location.length() || path.substr(0, location.length()) != location) {
+		return false;
+	}
+
+	return path.length() == location.length() || location.back() == '/' || path[location.length()] == '/';
+}
+
+} // namespace
+
+WsDeflateSettings WsDeflateSettings::fromConfiguration(const EnvironmentProperties & configuration,
+                                                       const WsDeflateSettings & defaults) {
+	WsDeflateSettings settings = defaults;
+
+	settings.enabled = configuration.getValue<bool>("enabled", defaults.enabled);
+	settings.serverMaxWindowBits = configuration.getValue<int>("server.max.window.bits", defaults.serverMaxWindowBits);
+	settings.clientMaxWindowBits = configuration.getValue<int>("client.max.window.bits", defaults.clientMaxWindowBits);
+	settings.serverNoContextTakeover = configuration.getValue<bool>("server.no.context.takeover", defaults.serverNoContextTakeover);
+	settings.clientNoContextTakeover = configuration.getValue<bool>("client.no.context.takeover", defaults.clientNoContextTakeover);
+	settings.compressionLevel = configuration.getValue<int>("compression.level", defaults.compressionLevel);
+	settings.memoryLevel = configuration.getValue<int>("memory.level", defaults.memoryLevel);
+
+	const int minMessageSize = configuration.getValue<int>("min.message.size", (int) defaults.minMessageSize);
+	validateRange("min.message.size", minMessageSize, 0, std::numeric_limits<int>::max());
+	settings.minMessageSize = (size_t) minMessageSize;
+
+	settings.validate();
+	return settings;
+}
+
+bool WsDeflateSettings::minMessageSizeSupported() {
+	return HasMessageSizeThreshold<WS::permessage_deflate>::value;
+}
+
+WS::permessage_deflate WsDeflateSettings::toOption() const {
+	WS::permessage_deflate option;
+
+	option.server_enable = enabled;
+	option.client_enable = false;
+	option.server_max_window_bits = serverMaxWindowBits;
+	option.client_max_window_bits = clientMaxWindowBits;
+	option.server_no_context_takeover = serverNoContextTakeover;
+	option.client_no_context_takeover = clientNoContextTakeover;
+	option.compLevel = compressionLevel;
+	option.memLevel = memoryLevel;
+	setMessageSizeThreshold(option, minMessageSize);
+
+	return option;
+}
+
+void WsDeflateSettings::validate() const {
+	// Window bits of 8 are not supported due to a bug in zlib.
+	validateRange("server.max.window.bits", serverMaxWindowBits, 9, 15);
+	validateRange("client.max.window.bits", clientMaxWindowBits, 9, 15);
+	validateRange("compression.level", compressionLevel, 0, 9);
+	validateRange("memory.level", memoryLevel, 1, 9);
+}
+
+WsCompression::WsCompression() : WsCompression(WsDeflateSettings()) {}
+
+WsCompression::WsCompression(const WsDeflateSettings & defaultSettings)
+	: WsCompression(defaultSettings, std::vector<std::pair<std::string, WsDeflateSettings>>()) {}
+
+WsCompression::WsCompression(const WsDeflateSettings & defaultSettings,
+                             const std::vector<std::pair<std::string, WsDeflateSettings>> & routes_) {
+	// Blank delimited list of locations.
+	static const std::regex delimiter("[ \t]+");
+
+	defaultSettings.validate();
+	routes.emplace_back(std::make_unique<Route>(std::vector<std::string>(), defaultSettings));
+
+	for (const auto & route : routes_) {
+		route.second.validate();
+
+		std::vector<std::string> locations;
+
+		for (const auto & location : Util::Strings::splitAndTrim(route.first, delimiter)) {
+			if (!location.empty()) {
+				locations.emplace_back(location);
+			}
+		}
+
+		routes.emplace_back(std::make_unique<Route>(std::move(locations), route.second));
+	}
+}
+
+std::shared_ptr<WsCompression> WsCompression::fromConfiguration(const EnvironmentProperties & configuration) {
+	auto deflateConfiguration = configuration.getCompositeOrNull("deflate");
+
+	const auto defaultSettings = deflateConfiguration
+		? WsDeflateSettings::fromConfiguration(*deflateConfiguration, WsDeflateSettings())
+		: WsDeflateSettings();
+
+	std::vector<std::pair<std::string, WsDeflateSettings>> routes;
+
+	for (const auto & webAppConfiguration : configuration) {
+		if (!webAppConfiguration.isComposite()) {
+			continue;
+		}
+
+		auto config = webAppConfiguration.getComposite();
+
+		// Unconfigured web applications (and the deflate composite) do not have a location.
+		if (!config->hasValue<std::string>("location")) {
+			continue;
+		}
+
+		auto webAppDeflateConfiguration = config->getCompositeOrNull("deflate");
+
+		if (webAppDeflateConfiguration) {
+			routes.emplace_back(
+				  config->getValue<std::string>("location")
+				, WsDeflateSettings::fromConfiguration(*webAppDeflateConfiguration, defaultSettings)
+			);
+		}
+	}
+
+	return std::make_shared<WsCompression>(defaultSettings, routes);
+}
+
+WsCompression::Route & WsCompression::resolve(std::string_view path) {
+	Route * bestRoute = routes.front().get();
+	size_t bestLength = 0;
+
+	for (size_t m = 1; m < routes.size(); ++m) {
+		for (const auto & location : routes[m]->locations) {
+			if (location.length() + 1 > bestLength && matchesLocation(path, location)) {
+				bestRoute = routes[m].get();
+				bestLength = location.length() + 1;
+			}
+		}
+	}
+
+	return *bestRoute;
+}
+
+} // namespace Balau::Network::Http
@@ -0,0 +1,329 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_COMPRESSION
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_COMPRESSION
+
+///
+/// @file WsCompression.hpp
+///
+/// WebSocket permessage-deflate settings and compression metrics.
+///
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace Balau {
+
+class EnvironmentProperties;
+
+namespace Network::Http {
+
+namespace Impl {
+
+class WsMeteredSocket;
+
+} // namespace Impl
+
+///
+/// WebSocket permessage-deflate (RFC 7692) settings.
+///
+/// The window bits and the context takeover settings determine the amount of
+/// memory used per connection, which is traded against the compression ratio.
+///
+struct WsDeflateSettings {
+	///
+	/// True if the server offers the permessage-deflate extension.
+	///
+	bool enabled = false;
+
+	///
+	/// The base two logarithm of the server's LZ77 sliding window size (9 to 15).
+	///
+	int serverMaxWindowBits = 15;
+
+	///
+	/// The base two logarithm of the client's LZ77 sliding window size (9 to 15).
+	///
+	int clientMaxWindowBits = 15;
+
+	///
+	/// True if the server resets its compression context after each message.
+	///
+	bool serverNoContextTakeover = false;
+
+	///
+	/// True if the client is requested to reset its compression context after each message.
+	///
+	bool clientNoContextTakeover = false;
+
+	///
+	/// The deflate compression level (0 to 9).
+	///
+	int compressionLevel = 8;
+
+	///
+	/// The deflate memory level (1 to 9).
+	///
+	int memoryLevel = 4;
+
+	///
+	/// Outbound messages smaller than this size are not compressed.
+	///
+	/// This setting is only applied if the Boost Beast version supports it
+	/// (see minMessageSizeSupported).
+	///
+	size_t minMessageSize = 0;
+
+	///
+	/// Create settings from a deflate configuration composite.
+	///
+	/// Settings that are not present in the configuration are taken from the supplied defaults.
+	///
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	static WsDeflateSettings fromConfiguration(const EnvironmentProperties & configuration,
+	                                           const WsDeflateSettings & defaults);
+
+	///
+	/// Returns true if the Boost version supports the minimum message size setting.
+	///
+	static bool minMessageSizeSupported();
+
+	///
+	/// Create the Beast permessage-deflate option for these settings.
+	///
+	WS::permessage_deflate toOption() const;
+
+	///
+	/// Validate the settings.
+	///
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	void validate() const;
+};
+
+///
+/// Thread safe WebSocket compression metrics.
+///
+/// Payload bytes are the uncompressed message sizes. Wire bytes are the bytes
+/// written to and read from the socket, including WebSocket framing and the
+/// upgrade response. The CPU times are the thread CPU times spent processing
+/// WebSocket reads and writes, which include compression and decompression, but
+/// which exclude the time spent in the web application handlers.
+///
+class WsCompressionMetrics {
+	public: WsCompressionMetrics() = default;
+
+	public: WsCompressionMetrics(const WsCompressionMetrics & ) = delete;
+	public: WsCompressionMetrics & operator = (const WsCompressionMetrics & ) = delete;
+
+	///
+	/// Get the number of messages written.
+	///
+	public: size_t messagesWritten() const {
+		return messagesWrittenCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the number of messages read.
+	///
+	public: size_t messagesRead() const {
+		return messagesReadCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the uncompressed size of the messages written.
+	///
+	public: size_t payloadBytesWritten() const {
+		return payloadBytesWrittenCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the number of bytes written to the socket.
+	///
+	public: size_t wireBytesWritten() const {
+		return wireBytesWrittenCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the uncompressed size of the messages read.
+	///
+	public: size_t payloadBytesRead() const {
+		return payloadBytesReadCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the number of bytes read from the socket.
+	///
+	public: size_t wireBytesRead() const {
+		return wireBytesReadCount.load(std::memory_order_relaxed);
+	}
+
+	///
+	/// Get the thread CPU time spent writing messages.
+	///
+	public: std::chrono::nanoseconds writeCpuTime() const {
+		return std::chrono::nanoseconds(writeCpuNanoseconds.load(std::memory_order_relaxed));
+	}
+
+	///
+	/// Get the thread CPU time spent reading messages.
+	///
+	public: std::chrono::nanoseconds readCpuTime() const {
+		return std::chrono::nanoseconds(readCpuNanoseconds.load(std::memory_order_relaxed));
+	}
+
+	///
+	/// Get the ratio of payload bytes written to wire bytes written.
+	///
+	/// @return the outbound compression ratio, or zero if nothing has been written
+	///
+	public: double compressionRatio() const {
+		const auto wire = wireBytesWritten();
+		return wire == 0 ? 0.0 : (double) payloadBytesWritten() / (double) wire;
+	}
+
+	///
+	/// Get the ratio of payload bytes read to wire bytes read.
+	///
+	/// @return the inbound compression ratio, or zero if nothing has been read
+	///
+	public: double decompressionRatio() const {
+		const auto wire = wireBytesRead();
+		return wire == 0 ? 0.0 : (double) payloadBytesRead() / (double) wire;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	friend class WsSession;
+	friend class Impl::WsMeteredSocket;
+
+	private: std::atomic<size_t> messagesWrittenCount { 0 };
+	private: std::atomic<size_t> messagesReadCount { 0 };
+	private: std::atomic<size_t> payloadBytesWrittenCount { 0 };
+	private: std::atomic<size_t> wireBytesWrittenCount { 0 };
+	private: std::atomic<size_t> payloadBytesReadCount { 0 };
+	private: std::atomic<size_t> wireBytesReadCount { 0 };
+	private: std::atomic<int64_t> writeCpuNanoseconds { 0 };
+	private: std::atomic<int64_t> readCpuNanoseconds { 0 };
+};
+
+///
+/// The WebSocket compression settings and metrics of the server, by location.
+///
+/// Each route has a set of location prefixes, deflate settings, and metrics.
+/// A WebSocket session uses the route with the longest location prefix that
+/// matches the path of its upgrade request, or the default route if there is
+/// no match.
+///
+/// Routes are fixed at construction, thus route resolution is thread safe.
+///
+class WsCompression {
+	///
+	/// A WebSocket compression route.
+	///
+	public: struct Route {
+		///
+		/// The location prefixes of the route (empty for the default route).
+		///
+		const std::vector<std::string> locations;
+
+		///
+		/// The deflate settings of the route.
+		///
+		const WsDeflateSettings settings;
+
+		///
+		/// The compression metrics of the route.
+		///
+		WsCompressionMetrics metrics;
+
+		Route(std::vector<std::string> locations_, const WsDeflateSettings & settings_)
+			: locations(std::move(locations_))
+			, settings(settings_) {}
+	};
+
+	///
+	/// Create a compression registry with compression disabled.
+	///
+	public: WsCompression();
+
+	///
+	/// Create a compression registry with the supplied default settings and no additional routes.
+	///
+	public: explicit WsCompression(const WsDeflateSettings & defaultSettings);
+
+	///
+	/// Create a compression registry with the supplied default settings and routes.
+	///
+	/// @param defaultSettings the settings used for paths that do not match a route
+	/// @param routes pairs of space delimited location prefixes and route settings
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	public: WsCompression(const WsDeflateSettings & defaultSettings,
+	                      const std::vector<std::pair<std::string, WsDeflateSettings>> & routes);
+
+	///
+	/// Create a compression registry from the ws configuration composite of the server.
+	///
+	/// The default settings are taken from the deflate composite of the ws
+	/// composite. The settings of each configured web application are taken from
+	/// the deflate composite of the web application if present, with missing
+	/// values taken from the default settings.
+	///
+	/// @throw IllegalArgumentException if a setting is out of range
+	///
+	public: static std::shared_ptr<WsCompression> fromConfiguration(const EnvironmentProperties & configuration);
+
+	public: WsCompression(const WsCompression & ) = delete;
+	public: WsCompression & operator = (const WsCompression & ) = delete;
+
+	///
+	/// Resolve the route for the supplied path.
+	///
+	public: Route & resolve(std::string_view path);
+
+	///
+	/// Get the default route.
+	///
+	public: Route & defaultRoute() {
+		return *routes.front();
+	}
+
+	///
+	/// Get all the routes, starting with the default route.
+	///
+	public: const std::vector<std::unique_ptr<Route>> & getRoutes() const {
+		return routes;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: std::vector<std::unique_ptr<Route>> routes;
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_COMPRESSION
@@ -0,0 +1,130 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file WsMessage.hpp
+///
+/// Immutable outbound WebSocket messages that are shared between sessions.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_MESSAGE
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_MESSAGE
+
+#include <memory>
+#include <string>
+
+namespace Balau::Network::Http {
+
+///
+/// The action taken by a WebSocket session when its outbound queue is full.
+///
+enum class WsSlowConsumerPolicy {
+	///
+	/// Discard the message being sent.
+	///
+	Drop
+
+	///
+	/// Replace the queued message that has the same coalescing key as the message
+	/// being sent. If there is no such message, the oldest queued message is discarded.
+	///
+	, Coalesce
+
+	///
+	/// Close the connection.
+	///
+	, Disconnect
+};
+
+///
+/// An immutable outbound WebSocket message.
+///
+/// Messages are created once and are then shared via reference counted pointers
+/// between all the sessions that send them. The payload is written directly from
+/// the shared message, thus there are no per-recipient copies of the payload.
+///
+/// The optional coalescing key is used by sessions that have the coalescing slow
+/// consumer policy. A queued message is superseded by a newer message that has the
+/// same non-empty key.
+///
+class WsMessage final {
+	///
+	/// Create a shared text message.
+	///
+	/// @param payload the UTF-8 message payload
+	/// @param key the coalescing key (empty for no coalescing)
+	///
+	public: static std::shared_ptr<const WsMessage> text(std::string payload, std::string key = std::string()) {
+		return std::make_shared<const WsMessage>(std::move(payload), true, std::move(key));
+	}
+
+	///
+	/// Create a shared binary message.
+	///
+	/// @param payload the message payload
+	/// @param key the coalescing key (empty for no coalescing)
+	///
+	public: static std::shared_ptr<const WsMessage> binary(std::string payload, std::string key = std::string()) {
+		return std::make_shared<const WsMessage>(std::move(payload), false, std::move(key));
+	}
+
+	///
+	/// Create a message.
+	///
+	/// Messages are normally created via the text and binary functions.
+	///
+	public: WsMessage(std::string payload_, bool text_, std::string key_)
+		: payloadData(std::move(payload_))
+		, textMessage(text_)
+		, coalescingKey(std::move(key_)) {}
+
+	public: WsMessage(const WsMessage & ) = delete;
+	public: WsMessage & operator = (const WsMessage & ) = delete;
+
+	///
+	/// Get the message payload.
+	///
+	public: const std::string & payload() const {
+		return payloadData;
+	}
+
+	///
+	/// Returns true if the message is a text message and false if it is a binary message.
+	///
+	public: bool isText() const {
+		return textMessage;
+	}
+
+	///
+	/// Get the coalescing key of the message.
+	///
+	public: const std::string & key() const {
+		return coalescingKey;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: const std::string payloadData;
+	private: const bool textMessage;
+	private: const std::string coalescingKey;
+};
+
+} // namespace Balau::Network::Http
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_HTTP_SERVER__WS_MESSAGE
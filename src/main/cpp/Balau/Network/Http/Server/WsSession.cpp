@@ -0,0 +1,275 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "WsSession.hpp"
+
+#include "../../../Logging/Logger.hpp"
+
+namespace Balau::Network::Http {
+
+WsSession::WsSession(std::shared_ptr<HttpServerConfiguration> serverConfiguration_,
+                     Impl::HttpSocket && socket_,
+                     std::string path_)
+	: serverConfiguration(std::move(serverConfiguration_))
+	, strand(socket_.get_executor())
+	, context(strand.get_inner_executor().context())
+	, compressionRoute(serverConfiguration->wsCompression->resolve(path_))
+	, socket(std::move(socket_), compressionRoute.metrics)
+	, path(std::move(path_))
+	, outbound(DefaultOutboundQueueCapacity, WsSlowConsumerPolicy::Drop) {
+	socket.set_option(compressionRoute.settings.toOption());
+}
+
+void WsSession::run() {
+	socket.async_accept(
+		boost::asio::bind_executor(
+			strand, std::bind(&WsSession::onAccept, shared_from_this(), std::placeholders::_1)
+		)
+	);
+}
+
+void WsSession::onControl(WsFrame frameType, boost::beast::string_view payload) {
+	boost::ignore_unused(payload);
+
+	switch (frameType) {
+		case WsFrame::close: {
+			serverConfiguration->wsHandler->handleClose(*this, path); // TODO
+			break;
+		}
+
+		case WsFrame::ping: {
+			serverConfiguration->wsHandler->handlePing(*this, path); // TODO
+			break;
+		}
+
+		case WsFrame::pong: {
+			serverConfiguration->wsHandler->handlePong(*this, path); // TODO
+			break;
+		}
+	}
+}
+
+void WsSession::onAccept(boost::system::error_code ec) {
+	if (ec) {
+		markClosed();
+		BalauBalauLogWarn(serverConfiguration->logger, "WsSession handshake error: {}", ec);
+		return;
+	}
+
+	bool startWriting = false;
+
+	{
+		std::lock_guard<std::mutex> lock(outboundMutex);
+		accepted = true;
+
+		// Messages may have been sent before the handshake completed.
+		if (!writing && !outbound.empty()) {
+			writing = true;
+			startWriting = true;
+		}
+	}
+
+	if (startWriting) {
+		doWrite();
+	}
+
+	doRead();
+}
+
+void WsSession::doRead() {
+	Impl::WsCpuMeter::Scope cpuScope(compressionRoute.metrics.readCpuNanoseconds);
+
+	socket.async_read(
+		buffer,
+		boost::asio::bind_executor(
+			strand,
+			std::bind(
+				&WsSession::onRead,
+				shared_from_this(),
+				std::placeholders::_1,
+				std::placeholders::_2)));
+}
+
+void WsSession::onRead(boost::system::error_code ec, std::size_t bytes_transferred) {
+	if (ec) {
+		markClosed();
+
+		// Closed by the client or disconnected by the session.
+		if (ec != WS::error::closed && ec != boost::asio::error::operation_aborted) {
+			BalauBalauLogWarn(serverConfiguration->logger, "WsSession read error: {}", ec);
+		}
+
+		return;
+	}
+
+	auto & metrics = compressionRoute.metrics;
+	metrics.messagesReadCount.fetch_add(1, std::memory_order_relaxed);
+	metrics.payloadBytesReadCount.fetch_add(bytes_transferred, std::memory_order_relaxed);
+
+	const auto & handler = serverConfiguration->wsHandler;
+
+	if (handler) {
+		// The time spent in the web application is not attributed to the WebSocket stream.
+		Impl::WsCpuMeter::Suspension suspension;
+
+		try {
+			if (socket.got_text()) {
+				handler->handleTextMessage(*this, path);
+			} else {
+				handler->handleBinaryMessage(*this, path);
+			}
+		} catch (const std::exception & e) {
+			BalauBalauLogError(serverConfiguration->logger, "Exception thrown during WebSocket message handling: {}", e);
+		} catch (...) {
+			BalauBalauLogError(serverConfiguration->logger, "Unknown exception thrown during WebSocket message handling.");
+		}
+	}
+
+	buffer.consume(buffer.size());
+	doRead();
+}
+
+std::string_view WsSession::receivedMessage() const {
+	const auto data = buffer.data();
+	return std::string_view(static_cast<const char *>(data.data()), data.size());
+}
+
+bool WsSession::send(std::shared_ptr<const WsMessage> message) {
+	bool startWriting = false;
+
+	{
+		std::lock_guard<std::mutex> lock(outboundMutex);
+
+		if (closed) {
+			return false;
+		}
+
+		switch (outbound.push(std::move(message))) {
+			case Impl::WsOutboundQueue::Result::Dropped: {
+				++droppedMessages;
+				return true;
+			}
+
+			case Impl::WsOutboundQueue::Result::Coalesced: {
+				++coalescedMessages;
+				return true;
+			}
+
+			case Impl::WsOutboundQueue::Result::Overflow: {
+				closed = true;
+				outbound.clear();
+				boost::asio::post(strand, std::bind(&WsSession::disconnect, shared_from_this()));
+				return false;
+			}
+
+			default: {
+				break;
+			}
+		}
+
+		if (accepted && !writing) {
+			writing = true;
+			startWriting = true;
+		}
+	}
+
+	if (startWriting) {
+		boost::asio::post(strand, std::bind(&WsSession::doWrite, shared_from_this()));
+	}
+
+	return true;
+}
+
+void WsSession::configureOutboundQueue(size_t capacity, WsSlowConsumerPolicy policy) {
+	std::lock_guard<std::mutex> lock(outboundMutex);
+	outbound.configure(capacity, policy);
+}
+
+bool WsSession::isOpen() const {
+	std::lock_guard<std::mutex> lock(outboundMutex);
+	return !closed;
+}
+
+size_t WsSession::droppedMessageCount() const {
+	std::lock_guard<std::mutex> lock(outboundMutex);
+	return droppedMessages;
+}
+
+size_t WsSession::coalescedMessageCount() const {
+	std::lock_guard<std::mutex> lock(outboundMutex);
+	return coalescedMessages;
+}
+
+////////////////////////// Private implementation /////////////////////////
+
+void WsSession::doWrite() {
+	{
+		std::lock_guard<std::mutex> lock(outboundMutex);
+		inFlight = outbound.pop();
+
+		if (!inFlight) {
+			writing = false;
+			return;
+		}
+	}
+
+	// The payload is written directly from the shared message.
+	Impl::WsCpuMeter::Scope cpuScope(compressionRoute.metrics.writeCpuNanoseconds);
+	socket.text(inFlight->isText());
+
+	socket.async_write(
+		  boost::asio::buffer(inFlight->payload())
+		, boost::asio::bind_executor(
+			strand, std::bind(&WsSession::onWrite, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
+		)
+	);
+}
+
+void WsSession::onWrite(boost::system::error_code ec, std::size_t bytes_transferred) {
+	inFlight.reset();
+
+	if (ec) {
+		markClosed();
+		return;
+	}
+
+	auto & metrics = compressionRoute.metrics;
+	metrics.messagesWrittenCount.fetch_add(1, std::memory_order_relaxed);
+	metrics.payloadBytesWrittenCount.fetch_add(bytes_transferred, std::memory_order_relaxed);
+
+	doWrite();
+}
+
+void WsSession::disconnect() {
+	// The connection is closed without a closing handshake, as a slow consumer
+	// would not process the close frame in a timely manner.
+	boost::system::error_code ignored;
+	auto & tcpSocket = socket.next_layer().next_layer().tcpSocket();
+	tcpSocket.shutdown(TCP::socket::shutdown_both, ignored);
+	tcpSocket.close(ignored);
+}
+
+void WsSession::markClosed() {
+	std::lock_guard<std::mutex> lock(outboundMutex);
+	closed = true;
+	writing = false;
+	outbound.clear();
+}
+
+} // namespace Balau::Network::Http
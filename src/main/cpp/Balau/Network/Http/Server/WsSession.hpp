@@ -28,8 +28,13 @@
 
 #include <Balau/Network/Http/Server/WsWebApp.hpp>
 #include <Balau/Network/Http/Server/HttpServerConfiguration.hpp>
+#include <Balau/Network/Http/Server/WsMessage.hpp>
+#include <Balau/Network/Http/Server/Impl/WsMeteredSocket.hpp>
+#include <Balau/Network/Http/Server/Impl/WsOutboundQueue.hpp>
 #include <Balau/Util/DateTime.hpp>
 
+#include <mutex>
+
 // Avoid false positive (due to std::make_shared).
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
@@ -41,24 +46,34 @@ namespace Balau::Network::Http {
 ///
 /// Holds a pointer to the private session information object for the client.
 ///
+/// Received messages are passed to the WebSocket web application of the server.
+/// Outbound messages are sent via the thread safe send method, which places the
+/// messages in a bounded outbound queue. When the outbound queue is full, the
+/// slow consumer policy of the session is applied.
+///
+/// The permessage-deflate settings of the session are those of the compression
+/// route that matches the path of the upgrade request. The traffic of the session
+/// is counted in the metrics of the route.
+///
 class WsSession final : public std::enable_shared_from_this<WsSession> {
+	///
+	/// The default capacity of the outbound message queue.
+	///
+	public: static constexpr size_t DefaultOutboundQueueCapacity = 1024;
+
 	///
 	/// Create a WebSocket session object with the supplied data.
 	///
 	/// @param clientSession_ the client session associated with the WebSocket session
 	/// @param serverConfiguration_ the configuration of the HTTP server that created this session
-	/// @param socket_ the session socket
+	/// @param socket_ the session socket (plain or TLS)
 	///
 	/// TODO A single WebSocket web application will handle all the session.
 	/// TODO This can be selected from the routing trie in advance.
 	///
 	public: WsSession(std::shared_ptr<HttpServerConfiguration> serverConfiguration_,
-	                  TCP::socket && socket_,
-	                  std::string path_)
-		: serverConfiguration(std::move(serverConfiguration_))
-		, strand(socket_.get_executor())
-		, socket(std::move(socket_))
-		, path(std::move(path_)) {}
+	                  Impl::HttpSocket && socket_,
+	                  std::string path_);
 
 	///
 	/// Get the shared state of the http server.
@@ -69,6 +84,27 @@ class WsSession final : public std::enable_shared_from_this<WsSession> {
 		return *serverConfiguration;
 	}
 
+	///
+	/// Get the IO context on which the session runs.
+	///
+	public: boost::asio::io_context & ioContext() const {
+		return context;
+	}
+
+	///
+	/// Get the path of the WebSocket upgrade request.
+	///
+	public: const std::string & getPath() const {
+		return path;
+	}
+
+	///
+	/// Get the compression route of the session.
+	///
+	public: const WsCompression::Route & getCompressionRoute() const {
+		return compressionRoute;
+	}
+
 	public: template <typename Body, typename AllocatorT>
 	void doAccept(HTTP::request<Body, HTTP::basic_fields<AllocatorT>> req) {
 
@@ -93,102 +129,85 @@ class WsSession final : public std::enable_shared_from_this<WsSession> {
 		// TODO
 	}
 
-	public: void run() {
-		socket.async_accept(
-			boost::asio::bind_executor(
-				strand, std::bind(&WsSession::onAccept, shared_from_this(), std::placeholders::_1)
-			)
-		);
-	}
+	public: void run();
 
-	public: void onControl(WsFrame frameType, boost::beast::string_view payload) {
-		boost::ignore_unused(payload);
-
-		switch (frameType) {
-			case WsFrame::close: {
-				serverConfiguration->wsHandler->handleClose(*this, path); // TODO
-				break;
-			}
-
-			case WsFrame::ping: {
-				serverConfiguration->wsHandler->handlePing(*this, path); // TODO
-				break;
-			}
-
-			case WsFrame::pong: {
-				serverConfiguration->wsHandler->handlePong(*this, path); // TODO
-				break;
-			}
-		}
-	}
+	public: void onControl(WsFrame frameType, boost::beast::string_view payload);
 
 	///
-	/// @throw NetworkException if there was an issue accepting
+	/// Start the session, or close it with a warning log if the handshake failed.
 	///
-	public: void onAccept(boost::system::error_code ec) {
-		checkError(ec);
-		doRead();
-	}
+	public: void onAccept(boost::system::error_code ec);
 
-	public: void doRead() {
-		socket.async_read(
-			buffer,
-			boost::asio::bind_executor(
-				strand,
-				std::bind(
-					&WsSession::onRead,
-					shared_from_this(),
-					std::placeholders::_1,
-					std::placeholders::_2)));
-	}
+	public: void doRead();
+
+	public: void onRead(boost::system::error_code ec, std::size_t bytes_transferred);
 
 	///
-	/// @throw NetworkException if there was an issue reading
+	/// Get the payload of the received message that is currently being handled.
 	///
-	public: void onRead(boost::system::error_code ec, std::size_t bytes_transferred) {
-		boost::ignore_unused(bytes_transferred);
-
-		if (ec == WS::error::closed) {
-			return;
-		}
+	/// The view is valid for the duration of the web application handler call.
+	///
+	public: std::string_view receivedMessage() const;
 
-		checkError(ec);
+	///
+	/// Send a message to the client.
+	///
+	/// This method is thread safe and may be called from any thread. The message
+	/// is placed in the outbound queue of the session and is written asynchronously.
+	/// If the outbound queue is full, the slow consumer policy of the session is
+	/// applied.
+	///
+	/// @param message the shared message to send
+	/// @return true if the session is open, false if the session has been closed
+	///
+	public: bool send(std::shared_ptr<const WsMessage> message);
 
-		// Echo the message
-		socket.text(socket.got_text());
+	///
+	/// Set the capacity and the slow consumer policy of the outbound queue.
+	///
+	/// If the new capacity is smaller than the number of queued messages, the
+	/// oldest queued messages are discarded.
+	///
+	public: void configureOutboundQueue(size_t capacity, WsSlowConsumerPolicy policy);
 
-		socket.async_write(
-			  buffer.data()
-			, boost::asio::bind_executor(
-				strand, std::bind(&WsSession::onWrite, shared_from_this(), std::placeholders::_1, std::placeholders::_2)
-			)
-		);
-	}
+	///
+	/// Returns true if the session has not been closed.
+	///
+	public: bool isOpen() const;
 
 	///
-	/// @throw NetworkException if there was an issue writing
+	/// Get the number of outbound messages that have been discarded due to the slow consumer policy.
 	///
-	public: void onWrite(boost::system::error_code ec, std::size_t bytes_transferred) {
-		boost::ignore_unused(bytes_transferred);
+	public: size_t droppedMessageCount() const;
 
-		checkError(ec);
-		buffer.consume(buffer.size());
-		doRead();
-	}
+	///
+	/// Get the number of outbound messages that have replaced queued messages due to the slow consumer policy.
+	///
+	public: size_t coalescedMessageCount() const;
 
 	////////////////////////// Private implementation /////////////////////////
 
-	private: void checkError(const boost::system::error_code & errorCode) {
-		if (errorCode) {
-			ThrowBalauException(Exception::NetworkException, errorCode.message());
-		}
-	}
+	private: void doWrite();
+	private: void onWrite(boost::system::error_code ec, std::size_t bytes_transferred);
+	private: void disconnect();
+	private: void markClosed();
 
 	private: std::shared_ptr<HttpServerConfiguration> serverConfiguration;
 	private: boost::asio::strand<boost::asio::io_context::executor_type> strand;
-	private: WS::stream<TCP::socket> socket;
+	private: boost::asio::io_context & context;
+	private: WsCompression::Route & compressionRoute;
+	private: WS::stream<Impl::WsMeteredSocket> socket;
 	private: const std::string path;
-	private: boost::beast::multi_buffer buffer;
+	private: Buffer buffer;
+
+	private: mutable std::mutex outboundMutex;
+	private: Impl::WsOutboundQueue outbound;
+	private: std::shared_ptr<const WsMessage> inFlight;
+	private: bool accepted = false;
+	private: bool writing = false;
+	private: bool closed = false;
+	private: size_t droppedMessages = 0;
+	private: size_t coalescedMessages = 0;
 };
 
 } // namespace Balau::Network::Http
@@ -19,14 +19,16 @@
 
 #include "EchoingWsWebApp.hpp"
 
+#include "../WsSession.hpp"
+
 namespace Balau::Network::Http::WsWebApps {
 
 void EchoingWsWebApp::handleTextMessage(WsSession & session, std::string_view path) {
-
+	session.send(WsMessage::text(std::string(session.receivedMessage())));
 }
 
 void EchoingWsWebApp::handleBinaryMessage(WsSession & session, std::string_view path) {
-
+	session.send(WsMessage::binary(std::string(session.receivedMessage())));
 }
 
 void EchoingWsWebApp::handleClose(WsSession & session, std::string_view path) {
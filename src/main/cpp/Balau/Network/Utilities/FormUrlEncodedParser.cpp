@@ -0,0 +1,103 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "FormUrlEncodedParser.hpp"
+#include "UrlDecode.hpp"
+
+#include <cstring>
+
+namespace Balau::Network {
+
+void FormUrlEncodedParser::append(std::string_view chunk) {
+	const char * position = chunk.data();
+	const char * const end = position + chunk.length();
+
+	while (position != end) {
+		const auto * separator = static_cast<const char *>(std::memchr(position, '&', (size_t) (end - position)));
+
+		if (separator == nullptr) {
+			// Partial field.. keep it until the next chunk.
+			checkLength(pending.length() + (size_t) (end - position));
+			pending.append(position, end);
+			return;
+		}
+
+		if (pending.empty()) {
+			// The whole field is in the chunk, so it can be decoded without copying.
+			checkLength((size_t) (separator - position));
+			emitField(std::string_view(position, (size_t) (separator - position)));
+		} else {
+			checkLength(pending.length() + (size_t) (separator - position));
+			pending.append(position, separator);
+			emitField(pending);
+			pending.clear();
+		}
+
+		position = separator + 1;
+	}
+}
+
+void FormUrlEncodedParser::finish() {
+	if (!pending.empty()) {
+		emitField(pending);
+		pending.clear();
+	}
+}
+
+void FormUrlEncodedParser::emitField(std::string_view field) {
+	// Empty fields are counted, so that a body such as "&&&..." is bounded by the field count.
+	if (++fieldCount > maxFieldCount) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Form exceeds the maximum field count of ", maxFieldCount, ".")
+		);
+	}
+
+	if (field.empty()) {
+		return;
+	}
+
+	const size_t equals = field.find('=');
+
+	if (equals == std::string_view::npos) {
+		// No value supplied.
+		handler(UrlDecode::decode(field, validateUtf8), std::string());
+		return;
+	}
+
+	if (field.find('=', equals + 1) != std::string_view::npos) {
+		ThrowBalauException(Exception::NetworkException, "Invalid parameter list");
+	}
+
+	handler(
+		  UrlDecode::decode(field.substr(0, equals), validateUtf8)
+		, UrlDecode::decode(field.substr(equals + 1), validateUtf8)
+	);
+}
+
+void FormUrlEncodedParser::checkLength(size_t length) const {
+	if (length > maxFieldLength) {
+		ThrowBalauException(
+			  Exception::NetworkException
+			, ::toString("Form field exceeds the maximum length of ", maxFieldLength, " bytes.")
+		);
+	}
+}
+
+} // namespace Balau::Network
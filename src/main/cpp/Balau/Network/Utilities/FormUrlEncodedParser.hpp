@@ -0,0 +1,109 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__FORM_URL_ENCODED_PARSER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__FORM_URL_ENCODED_PARSER
+
+///
+/// @file FormUrlEncodedParser.hpp
+///
+/// Incremental parser for application/x-www-form-urlencoded data.
+///
+
+#include <Balau/Type/StdTypes.hpp>
+
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace Balau::Network {
+
+///
+/// Incremental parser for application/x-www-form-urlencoded data.
+///
+/// The encoded data is supplied in arbitrarily sized chunks via the append method.
+/// Each time a complete field has been received, the field is decoded with the
+/// UrlDecode::decode function and passed to the field handler.
+///
+/// Only the current partially received field is buffered by the parser. The memory
+/// used by the parser is thus bounded by the maximum field length, independently
+/// of the total length of the data.
+///
+/// Empty fields are not passed to the handler, but are counted against the
+/// maximum field count. Fields without a '=' character are supplied with an
+/// empty value.
+///
+class FormUrlEncodedParser {
+	///
+	/// The default maximum length of a single encoded field.
+	///
+	public: static constexpr size_t DefaultMaxFieldLength = 64 * 1024;
+
+	///
+	/// The type of the function called for each decoded field.
+	///
+	public: using FieldHandler = std::function<void (std::string && name, std::string && value)>;
+
+	///
+	/// Create an incremental form parser.
+	///
+	/// @param handler_ the function called for each decoded field
+	/// @param maxFieldLength_ the maximum length of a single encoded "name=value" field
+	/// @param validateUtf8_ if true, decoded percent encoded data will only be added if it is valid UTF-8
+	/// @param maxFieldCount_ the maximum number of fields, including empty fields
+	///
+	public: explicit FormUrlEncodedParser(FieldHandler handler_,
+	                                      size_t maxFieldLength_ = DefaultMaxFieldLength,
+	                                      bool validateUtf8_ = true,
+	                                      size_t maxFieldCount_ = std::numeric_limits<size_t>::max())
+		: handler(std::move(handler_))
+		, maxFieldLength(maxFieldLength_)
+		, maxFieldCount(maxFieldCount_)
+		, validateUtf8(validateUtf8_) {}
+
+	///
+	/// Parse the next chunk of encoded data.
+	///
+	/// @throw NetworkException if a field is invalid, exceeds the maximum field length, or exceeds the maximum field count
+	///
+	public: void append(std::string_view chunk);
+
+	///
+	/// Signal the end of the encoded data, emitting the last field.
+	///
+	/// @throw NetworkException if the last field is invalid
+	///
+	public: void finish();
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: void emitField(std::string_view field);
+	private: void checkLength(size_t length) const;
+
+	private: FieldHandler handler;
+	private: const size_t maxFieldLength;
+	private: const size_t maxFieldCount;
+	private: const bool validateUtf8;
+	private: std::string pending;
+	private: size_t fieldCount = 0;
+};
+
+} // namespace Balau::Network
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__FORM_URL_ENCODED_PARSER
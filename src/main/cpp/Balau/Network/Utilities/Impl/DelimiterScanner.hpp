@@ -0,0 +1,126 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES_IMPL__DELIMITER_SCANNER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES_IMPL__DELIMITER_SCANNER
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+namespace Balau::Network::Impl {
+
+//
+// Find the first occurrence of any of the delimiter characters in the input,
+// starting at the specified position.
+//
+// The input is scanned 32 bytes at a time when AVX2 is enabled and 16 bytes at
+// a time when SSE2 is enabled, with the remainder being scanned bytewise. The
+// delimiters are compile time constants, so each delimiter costs one vector
+// comparison per block.
+//
+// Returns std::string_view::npos if none of the delimiters are found.
+//
+template <char ... Delimiters> inline size_t findFirstOf(std::string_view input, size_t position = 0) {
+	static_assert(sizeof...(Delimiters) > 0, "At least one delimiter must be specified.");
+
+	const char * const data = input.data();
+	const size_t length = input.length();
+
+	#if defined(__AVX2__)
+	while (position + 32 <= length) {
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + position));
+		__m256i matches = _mm256_setzero_si256();
+		((matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Delimiters)))), ...);
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+
+		if (mask != 0) {
+			return position + static_cast<size_t>(__builtin_ctz(mask));
+		}
+
+		position += 32;
+	}
+	#endif
+
+	#if defined(__SSE2__)
+	while (position + 16 <= length) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+		__m128i matches = _mm_setzero_si128();
+		((matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, _mm_set1_epi8(Delimiters)))), ...);
+		const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+
+		if (mask != 0) {
+			return position + static_cast<size_t>(__builtin_ctz(mask));
+		}
+
+		position += 16;
+	}
+	#endif
+
+	for (; position < length; ++position) {
+		const char c = data[position];
+
+		if (((c == Delimiters) || ...)) {
+			return position;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+//
+// Call the handler with the name and value views of each cookie in the cookie header.
+//
+// According to RFC-6265, cookies are separated by the exact "; " string. Cookies
+// without an equals sign or with more than one equals sign are invalid and are
+// ignored.
+//
+template <typename HandlerT> inline void forEachCookie(std::string_view header, HandlerT handler) {
+	size_t start = 0;
+
+	while (start < header.length()) {
+		size_t end = findFirstOf<';'>(header, start);
+
+		while (end != std::string_view::npos && (end + 1 == header.length() || header[end + 1] != ' ')) {
+			end = findFirstOf<';'>(header, end + 1);
+		}
+
+		const auto cookie = header.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+		start = end == std::string_view::npos ? header.length() : end + 2;
+
+		const auto equals = findFirstOf<'='>(cookie);
+
+		if (equals == std::string_view::npos || findFirstOf<'='>(cookie, equals + 1) != std::string_view::npos) {
+			// Invalid cookie sent by user agent.. ignore.
+			continue;
+		}
+
+		handler(cookie.substr(0, equals), cookie.substr(equals + 1));
+	}
+}
+
+} // namespace Balau::Network::Impl
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES_IMPL__DELIMITER_SCANNER
@@ -18,7 +18,8 @@
 //
 
 #include "MimeTypes.hpp"
-#include "../../Util/Strings.hpp"
+
+#include <algorithm>
 
 namespace Balau::Network {
 
@@ -75,20 +76,115 @@ std::shared_ptr<MimeTypes> MimeTypes::defaultMimeTypes = std::shared_ptr<MimeTyp
 	)
 );
 
-std::string_view MimeTypes::lookup(const std::string & path) const {
+namespace {
+
+inline char foldCase(char c) {
+	return c >= 'A' && c <= 'Z' ? (char) (c | 0x20) : c;
+}
+
+inline bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+	if (lhs.length() != rhs.length()) {
+		return false;
+	}
+
+	for (size_t m = 0; m < lhs.length(); ++m) {
+		if (foldCase(lhs[m]) != foldCase(rhs[m])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+inline bool isLowerCase(std::string_view value) {
+	return std::none_of(value.begin(), value.end(), [] (char c) { return c >= 'A' && c <= 'Z'; });
+}
+
+} // namespace
+
+MimeTypes::MimeTypes(std::unordered_map<std::string, std::string> && data_)
+	: data(std::move(data_)) {
+	size_t size = 8;
+
+	while (size < data.size() * 2) {
+		size *= 2;
+	}
+
+	// Search for a seed that places each extension in its own slot, growing the table when none is found.
+	uint32_t candidateSeed = 0;
+
+	while (!populate(candidateSeed, size)) {
+		if (++candidateSeed % 64 == 0) {
+			size *= 2;
+		}
+	}
+
+	for (const auto & entry : data) {
+		maxExtensionLength = std::max(maxExtensionLength, entry.first.length());
+	}
+}
+
+std::string_view MimeTypes::lookup(std::string_view path) const {
 	const auto lastDotPosition = path.rfind('.');
 
-	if (lastDotPosition == std::string::npos) {
+	if (lastDotPosition == std::string_view::npos) {
+		return "";
+	}
+
+	const auto extension = path.substr(lastDotPosition + 1);
+
+	if (extension.length() > maxExtensionLength) {
 		return "";
 	}
 
-	auto match = data.find(Balau::Util::Strings::toLower(path.substr(lastDotPosition + 1)));
+	const auto & slot = slots[hash(extension, seed) & mask];
 
-	if (match != data.end()) {
-		return match->second;
+	if (!slot.extension.empty() && equalsIgnoreCase(slot.extension, extension)) {
+		return slot.mimeType;
 	}
 
 	return "";
 }
 
+uint32_t MimeTypes::hash(std::string_view extension, uint32_t seed) {
+	// FNV-1a over the case folded characters, with the seed mixed into the offset basis.
+	uint32_t h = 2166136261U ^ (seed * 0x9E3779B9U);
+
+	for (char c : extension) {
+		h ^= (uint8_t) foldCase(c);
+		h *= 16777619U;
+	}
+
+	return h ^ (h >> 15U);
+}
+
+bool MimeTypes::populate(uint32_t candidateSeed, size_t size) {
+	slots.assign(size, Slot());
+
+	for (const auto & entry : data) {
+		if (entry.first.empty()) {
+			continue;
+		}
+
+		auto & slot = slots[hash(entry.first, candidateSeed) & (size - 1)];
+
+		if (!slot.extension.empty()) {
+			if (!equalsIgnoreCase(slot.extension, entry.first)) {
+				return false;
+			}
+
+			// Extensions that differ only in case. The lower case one takes precedence.
+			if (!isLowerCase(entry.first)) {
+				continue;
+			}
+		}
+
+		slot = Slot { entry.first, entry.second };
+	}
+
+	seed = candidateSeed;
+	mask = size - 1;
+	return true;
+}
+
 } // namespace Balau::Network
@@ -31,6 +31,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Balau::Network {
 
@@ -45,6 +46,11 @@ namespace Balau::Network {
 /// Once constructed, the mime types instance should be shared via a shared_ptr
 /// container.
 ///
+/// Lookups are case insensitive and do not allocate. The extensions are placed in
+/// a table indexed by a seeded hash function, where the seed and table size are
+/// chosen during construction so that no two extensions share a slot. A lookup
+/// thus costs one hash of the path's extension and one comparison.
+///
 class MimeTypes {
 	///
 	/// The default set of mime types available.
@@ -54,15 +60,15 @@ class MimeTypes {
 	///
 	/// Construct a custom mime types instance by moving the supplied data.
 	///
-	public: MimeTypes(std::unordered_map<std::string, std::string> && data_) noexcept
-		: data(std::move(data_)) {}
+	public: MimeTypes(std::unordered_map<std::string, std::string> && data_);
 
 	///
 	/// Lookup a mime type from the supplied path.
 	///
-	/// If no registered file extension is found, an empty string view is returned.
+	/// The extension of the path is matched case insensitively. If no registered
+	/// file extension is found, an empty string view is returned.
 	///
-	public: std::string_view lookup(const std::string & path) const;
+	public: std::string_view lookup(std::string_view path) const;
 
 	///
 	/// Get the internal data in order to construct a custom mime types instance.
@@ -73,7 +79,19 @@ class MimeTypes {
 
 	///////////////////////// Private implementation //////////////////////////
 
+	private: struct Slot {
+		std::string_view extension;
+		std::string_view mimeType;
+	};
+
+	private: static uint32_t hash(std::string_view extension, uint32_t seed);
+	private: bool populate(uint32_t candidateSeed, size_t size);
+
 	private: const std::unordered_map<std::string, std::string> data;
+	private: std::vector<Slot> slots;
+	private: uint32_t seed = 0;
+	private: size_t mask = 0;
+	private: size_t maxExtensionLength = 0;
 
 	public: MimeTypes() = delete;
 	public: MimeTypes(MimeTypes &) = delete;
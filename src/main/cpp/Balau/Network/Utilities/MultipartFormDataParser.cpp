@@ -0,0 +1,349 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "MultipartFormDataParser.hpp"
+#include "../../Exception/NetworkExceptions.hpp"
+#include "../../Util/Strings.hpp"
+
+#include <cstring>
+
+namespace Balau::Network {
+
+namespace {
+
+// Header and parameter names are ASCII tokens, so UTF-8 aware conversion is not used.
+std::string toLowerAscii(std::string_view input) {
+	std::string output(input);
+
+	for (char & c : output) {
+		if (c >= 'A' && c <= 'Z') {
+			c = (char) (c - 'A' + 'a');
+		}
+	}
+
+	return output;
+}
+
+//
+// Parse the parameters of a header value of the form "type; key1=value1; key2="value2"".
+// The parameter names are returned in lower case and quoted values are unquoted.
+//
+std::vector<std::pair<std::string, std::string>> parseParameters(std::string_view value) {
+	std::vector<std::pair<std::string, std::string>> parameters;
+	size_t position = value.find(';');
+
+	while (position != std::string_view::npos && position < value.length()) {
+		++position; // Skip the ';'.
+
+		const size_t equals = value.find('=', position);
+
+		if (equals == std::string_view::npos) {
+			break;
+		}
+
+		const auto name = toLowerAscii(Util::Strings::trim(value.substr(position, equals - position)));
+		position = equals + 1;
+
+		while (position < value.length() && (value[position] == ' ' || value[position] == '\t')) {
+			++position;
+		}
+
+		std::string parameterValue;
+
+		if (position < value.length() && value[position] == '"') {
+			++position;
+
+			while (position < value.length() && value[position] != '"') {
+				if (value[position] == '\\' && position + 1 < value.length()) {
+					++position;
+				}
+
+				parameterValue += value[position];
+				++position;
+			}
+
+			position = value.find(';', position);
+		} else {
+			const size_t end = value.find(';', position);
+			const auto length = end == std::string_view::npos ? std::string_view::npos : end - position;
+			parameterValue = std::string(Util::Strings::trim(value.substr(position, length)));
+			position = end;
+		}
+
+		parameters.emplace_back(name, std::move(parameterValue));
+	}
+
+	return parameters;
+}
+
+} // namespace
+
+std::string MultipartFormDataParser::extractBoundary(std::string_view contentType) {
+	const auto type = toLowerAscii(Util::Strings::trim(contentType.substr(0, contentType.find(';'))));
+
+	if (type != "multipart/form-data") {
+		ThrowBalauException(Exception::NetworkException, "The content type is not multipart/form-data.");
+	}
+
+	std::string boundary;
+
+	for (auto & parameter : parseParameters(contentType)) {
+		if (parameter.first == "boundary") {
+			boundary = std::move(parameter.second);
+			break;
+		}
+	}
+
+	// RFC 2046 boundaries are 1 to 70 characters long.
+	if (boundary.empty() || boundary.length() > 70) {
+		ThrowBalauException(Exception::NetworkException, "Missing or invalid multipart/form-data boundary.");
+	}
+
+	return boundary;
+}
+
+MultipartFormDataParser::MultipartFormDataParser(std::string_view boundary,
+                                                 Handler & handler_,
+                                                 size_t maxHeaderLength_)
+	: handler(handler_)
+	, delimiter("\r\n--" + std::string(boundary))
+	, maxHeaderLength(maxHeaderLength_)
+	, state(State::Preamble)
+	, carry("\r\n") {} // The first delimiter is not preceded by a line break.
+
+void MultipartFormDataParser::append(std::string_view chunk) {
+	size_t position = 0;
+
+	if (!carry.empty()) {
+		position = parseCarriedData(chunk);
+	}
+
+	while (position < chunk.length()) {
+		switch (state) {
+			case State::Preamble:
+			case State::Data: {
+				position = parseData(chunk, position);
+				break;
+			}
+
+			case State::Boundary: {
+				position = parseBoundary(chunk, position);
+				break;
+			}
+
+			case State::Headers: {
+				position = parseHeaders(chunk, position);
+				break;
+			}
+
+			case State::Epilogue: {
+				return;
+			}
+		}
+	}
+}
+
+void MultipartFormDataParser::finish() {
+	if (state != State::Epilogue) {
+		ThrowBalauException(Exception::NetworkException, "Incomplete multipart/form-data body.");
+	}
+}
+
+size_t MultipartFormDataParser::parseData(std::string_view chunk, size_t position) {
+	const auto data = chunk.substr(position);
+	size_t partial;
+	const size_t found = findDelimiter(data, data.length(), partial);
+
+	if (found != std::string_view::npos) {
+		emitData(data.substr(0, found));
+		onDelimiter();
+		return position + found + delimiter.length();
+	}
+
+	// Keep a trailing partial delimiter until the next chunk.
+	emitData(data.substr(0, partial));
+	carry.assign(data.substr(partial));
+	return chunk.length();
+}
+
+size_t MultipartFormDataParser::parseCarriedData(std::string_view chunk) {
+	// Only the start of the chunk is joined to the carried data, as any delimiter
+	// starting in the carried data must end within the first delimiter length bytes.
+	std::string joined = carry;
+	joined.append(chunk.data(), std::min(chunk.length(), delimiter.length()));
+
+	size_t partial;
+	const size_t found = findDelimiter(joined, carry.length(), partial);
+
+	if (found != std::string_view::npos) {
+		const size_t consumed = found + delimiter.length() - carry.length();
+		emitData(std::string_view(carry).substr(0, found));
+		carry.clear();
+		onDelimiter();
+		return consumed;
+	} else if (partial < carry.length()) {
+		// The chunk was too short to complete the delimiter.
+		emitData(std::string_view(carry).substr(0, partial));
+		carry = joined.substr(partial);
+		return chunk.length();
+	}
+
+	emitData(carry);
+	carry.clear();
+	return 0;
+}
+
+size_t MultipartFormDataParser::parseBoundary(std::string_view chunk, size_t position) {
+	// After the delimiter, either "--" (close delimiter) or optional
+	// whitespace followed by a line break is expected.
+	while (position < chunk.length()) {
+		const char c = chunk[position++];
+		const char previous = headerBlock.empty() ? '\0' : headerBlock.back();
+		headerBlock += c;
+
+		if (headerBlock == "-") {
+			continue;
+		} else if (headerBlock == "--") {
+			headerBlock.clear();
+			state = State::Epilogue;
+			return chunk.length();
+		} else if (c == '\n' && previous == '\r') {
+			headerBlock.clear();
+			state = State::Headers;
+			return position;
+		} else if (previous == '\r' || (c != ' ' && c != '\t' && c != '\r') || headerBlock.length() > 1024) {
+			ThrowBalauException(Exception::NetworkException, "Invalid multipart/form-data boundary delimiter.");
+		}
+	}
+
+	return position;
+}
+
+size_t MultipartFormDataParser::parseHeaders(std::string_view chunk, size_t position) {
+	const size_t previous = headerBlock.length();
+	const size_t count = std::min(chunk.length() - position, maxHeaderLength + 4 - previous);
+	headerBlock.append(chunk.data() + position, count);
+
+	size_t end;
+
+	if (headerBlock.compare(0, 2, "\r\n") == 0) {
+		end = 2; // No headers.
+	} else {
+		end = headerBlock.find("\r\n\r\n", previous >= 3 ? previous - 3 : 0);
+
+		if (end != std::string::npos) {
+			end += 4;
+		}
+	}
+
+	if (end == std::string::npos) {
+		if (headerBlock.length() > maxHeaderLength) {
+			ThrowBalauException(
+				  Exception::NetworkException
+				, ::toString("Multipart/form-data part headers exceed the maximum length of ", maxHeaderLength, " bytes.")
+			);
+		}
+
+		return position + count;
+	}
+
+	const size_t consumed = end - previous;
+	headerBlock.resize(end);
+	parsePartHeaders();
+	headerBlock.clear();
+	state = State::Data;
+	handler.onPartBegin(part);
+	return position + consumed;
+}
+
+void MultipartFormDataParser::emitData(std::string_view data) {
+	if (state == State::Data && !data.empty()) {
+		handler.onPartData(data);
+	}
+}
+
+void MultipartFormDataParser::onDelimiter() {
+	if (state == State::Data) {
+		handler.onPartEnd();
+	}
+
+	state = State::Boundary;
+}
+
+size_t MultipartFormDataParser::findDelimiter(std::string_view data, size_t limit, size_t & partial) const {
+	const char * const begin = data.data();
+	const char * const end = begin + data.length();
+	const char * current = begin;
+	const char * const last = begin + std::min(limit, data.length());
+
+	while (current < last) {
+		const auto * candidate = static_cast<const char *>(std::memchr(current, '\r', (size_t) (last - current)));
+
+		if (candidate == nullptr) {
+			break;
+		}
+
+		const auto remaining = (size_t) (end - candidate);
+
+		if (remaining >= delimiter.length()) {
+			if (std::memcmp(candidate, delimiter.data(), delimiter.length()) == 0) {
+				return (size_t) (candidate - begin);
+			}
+		} else if (std::memcmp(candidate, delimiter.data(), remaining) == 0) {
+			partial = (size_t) (candidate - begin);
+			return std::string_view::npos;
+		}
+
+		current = candidate + 1;
+	}
+
+	partial = data.length();
+	return std::string_view::npos;
+}
+
+void MultipartFormDataParser::parsePartHeaders() {
+	part = Part();
+
+	for (auto line : Util::Strings::split(std::string_view(headerBlock), "\r\n")) {
+		const size_t colon = line.find(':');
+
+		if (colon == std::string_view::npos) {
+			ThrowBalauException(Exception::NetworkException, "Invalid multipart/form-data part header.");
+		}
+
+		auto name = toLowerAscii(Util::Strings::trim(line.substr(0, colon)));
+		auto value = std::string(Util::Strings::trim(line.substr(colon + 1)));
+
+		if (name == "content-disposition") {
+			for (auto & parameter : parseParameters(value)) {
+				if (parameter.first == "name") {
+					part.name = std::move(parameter.second);
+				} else if (parameter.first == "filename") {
+					part.filename = std::move(parameter.second);
+				}
+			}
+		} else if (name == "content-type") {
+			part.contentType = value;
+		}
+
+		part.headers.emplace_back(std::move(name), std::move(value));
+	}
+}
+
+} // namespace Balau::Network
@@ -0,0 +1,177 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__MULTIPART_FORM_DATA_PARSER
+#define COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__MULTIPART_FORM_DATA_PARSER
+
+///
+/// @file MultipartFormDataParser.hpp
+///
+/// Incremental parser for multipart/form-data bodies.
+///
+
+#include <Balau/Type/StdTypes.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Balau::Network {
+
+///
+/// Incremental parser for multipart/form-data bodies (RFC 7578).
+///
+/// The body is supplied in arbitrarily sized chunks via the append method. The
+/// parser calls the handler when a part starts, for each contiguous piece of part
+/// data, and when a part ends. Part data is passed to the handler directly from
+/// the supplied chunks where possible.
+///
+/// The memory used by the parser is bounded by the maximum part header length
+/// plus the length of the boundary delimiter, independently of the body length.
+/// Handlers that need to keep large parts (file uploads) should thus write the
+/// part data to its destination as it arrives.
+///
+class MultipartFormDataParser {
+	///
+	/// The default maximum length of the header block of a single part.
+	///
+	public: static constexpr size_t DefaultMaxHeaderLength = 8 * 1024;
+
+	///
+	/// Information on a part, obtained from the part headers.
+	///
+	public: struct Part {
+		///
+		/// The name parameter of the Content-Disposition header.
+		///
+		std::string name;
+
+		///
+		/// The filename parameter of the Content-Disposition header, or empty if not present.
+		///
+		std::string filename;
+
+		///
+		/// The value of the Content-Type header, or empty if not present.
+		///
+		std::string contentType;
+
+		///
+		/// All the part's headers, with lower case names.
+		///
+		std::vector<std::pair<std::string, std::string>> headers;
+
+		///
+		/// Returns true if the part is a file upload.
+		///
+		bool isFile() const {
+			return !filename.empty();
+		}
+	};
+
+	///
+	/// The callbacks called by the parser.
+	///
+	/// Exceptions thrown by the callbacks propagate out of the append method.
+	///
+	public: class Handler {
+		///
+		/// Called when the headers of a new part have been parsed.
+		///
+		public: virtual void onPartBegin(const Part & part) = 0;
+
+		///
+		/// Called for each piece of data of the current part.
+		///
+		/// The data is valid only for the duration of the call.
+		///
+		public: virtual void onPartData(std::string_view data) = 0;
+
+		///
+		/// Called when the current part ends.
+		///
+		public: virtual void onPartEnd() = 0;
+
+		public: virtual ~Handler() = default;
+	};
+
+	///
+	/// Extract the boundary parameter from a multipart/form-data content type.
+	///
+	/// @throw NetworkException if the content type is not multipart/form-data or has no valid boundary
+	///
+	public: static std::string extractBoundary(std::string_view contentType);
+
+	///
+	/// Create an incremental multipart parser.
+	///
+	/// @param boundary the boundary obtained from the Content-Type header of the request
+	/// @param handler_ the handler to call during parsing
+	/// @param maxHeaderLength_ the maximum length of the header block of a single part
+	///
+	public: MultipartFormDataParser(std::string_view boundary,
+	                                Handler & handler_,
+	                                size_t maxHeaderLength_ = DefaultMaxHeaderLength);
+
+	///
+	/// Parse the next chunk of the body.
+	///
+	/// @throw NetworkException if the body is invalid
+	///
+	public: void append(std::string_view chunk);
+
+	///
+	/// Signal the end of the body.
+	///
+	/// @throw NetworkException if the closing boundary delimiter has not been received
+	///
+	public: void finish();
+
+	///
+	/// Returns true if the closing boundary delimiter has been received.
+	///
+	public: bool isComplete() const {
+		return state == State::Epilogue;
+	}
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: enum class State { Preamble, Boundary, Headers, Data, Epilogue };
+
+	private: size_t parseData(std::string_view chunk, size_t position);
+	private: size_t parseCarriedData(std::string_view chunk);
+	private: size_t parseBoundary(std::string_view chunk, size_t position);
+	private: size_t parseHeaders(std::string_view chunk, size_t position);
+	private: void emitData(std::string_view data);
+	private: void onDelimiter();
+	private: size_t findDelimiter(std::string_view data, size_t limit, size_t & partial) const;
+	private: void parsePartHeaders();
+
+	private: Handler & handler;
+	private: const std::string delimiter;
+	private: const size_t maxHeaderLength;
+	private: State state;
+	private: std::string carry;
+	private: std::string headerBlock;
+	private: Part part;
+};
+
+} // namespace Balau::Network
+
+#endif // COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__MULTIPART_FORM_DATA_PARSER
@@ -27,9 +27,15 @@
 #define COM_BORA_SOFTWARE__BALAU_NETWORK_UTILITIES__URL_DECODE
 
 #include <Balau/Exception/NetworkExceptions.hpp>
+#include <Balau/Network/Utilities/Impl/DelimiterScanner.hpp>
+#include <Balau/Type/Character.hpp>
+#include <Balau/Type/FromString.hpp>
 #include <Balau/Util/Strings.hpp>
 
+#include <cstring>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace Balau::Network {
 
@@ -37,6 +43,11 @@ namespace Balau::Network {
 /// Utility for splitting and decoding URL encoded data.
 ///
 struct UrlDecode {
+	///
+	/// A parameter key and value, represented by string views onto the input string.
+	///
+	using Parameter = std::pair<std::string_view, std::string_view>;
+
 	///
 	/// Split the URL encoded parameters then decode each one.
 	///
@@ -49,14 +60,11 @@ struct UrlDecode {
 	                                                                   bool throwOnError = false) {
 		std::unordered_map<std::string, std::string> decodedParameters;
 
-		const auto parameters = split(data);
-
-		for (auto iter = parameters.begin(); iter != parameters.end(); ++iter) {
-			auto decodedKey = decode(iter->first, validateUtf8, throwOnError);
-			auto decodedValue = decode(iter->second, validateUtf8, throwOnError);
-
-			decodedParameters.insert(std::make_pair(std::move(decodedKey), std::move(decodedValue)));
-		}
+		forEachParameter(data, [&decodedParameters, validateUtf8, throwOnError] (std::string_view key, std::string_view value) {
+			decodedParameters.insert(
+				std::make_pair(decode(key, validateUtf8, throwOnError), decode(value, validateUtf8, throwOnError))
+			);
+		});
 
 		return decodedParameters;
 	}
@@ -72,22 +80,68 @@ struct UrlDecode {
 	///
 	static std::unordered_map<std::string_view, std::string_view> split(const std::string_view data) {
 		std::unordered_map<std::string_view, std::string_view> keysAndValues;
-		std::vector<std::string_view> parameters = Util::Strings::split(data, "&");
 
-		for (auto parameter : parameters) {
-			std::vector<std::string_view> keyAndValue = Util::Strings::split(parameter, "=");
+		forEachParameter(data, [&keysAndValues] (std::string_view key, std::string_view value) {
+			keysAndValues.emplace(key, value);
+		});
+
+		return keysAndValues;
+	}
+
+	///
+	/// Split the URL encoded parameters into the supplied vector of string view pairs.
+	///
+	/// The vector is cleared before the parameters are added, so a vector that is
+	/// reused across calls does not allocate once it has reached the required capacity.
+	/// The parameters are added in order of appearance, including any duplicate keys.
+	///
+	/// The caller is responsible for maintaining the original string onto which the views are pointing.
+	///
+	/// @param data the input string view containing the URL encoded parameters
+	/// @param parameters the vector into which the parameters are placed
+	/// @throw NetworkException if the parameter list was invalid
+	///
+	static void split(const std::string_view data, std::vector<Parameter> & parameters) {
+		parameters.clear();
+
+		forEachParameter(data, [&parameters] (std::string_view key, std::string_view value) {
+			parameters.emplace_back(key, value);
+		});
+	}
+
+	///
+	/// Call the handler with the key and value of each of the URL encoded parameters, without decoding.
+	///
+	/// Empty parameters are skipped. A parameter without an equals sign has an empty value.
+	/// The delimiters are located with a vectorised scan and no allocations are performed.
+	///
+	/// @param data the input string view containing the URL encoded parameters
+	/// @param handler a callable object accepting the key and value string views
+	/// @throw NetworkException if a parameter contains more than one equals sign
+	///
+	template <typename HandlerT> static void forEachParameter(const std::string_view data, HandlerT handler) {
+		size_t start = 0;
+
+		while (start < data.length()) {
+			const size_t end = std::min(Impl::findFirstOf<'&'>(data, start), data.length());
+			const auto parameter = data.substr(start, end - start);
+			start = end + 1;
 
-			if (keyAndValue.size() == 1) {
+			if (parameter.empty()) {
+				continue;
+			}
+
+			const size_t equals = Impl::findFirstOf<'='>(parameter);
+
+			if (equals == std::string_view::npos) {
 				// No value supplied.
-				keysAndValues.emplace(keyAndValue[0], "");
-			} else if (keyAndValue.size() != 2) {
+				handler(parameter, std::string_view());
+			} else if (Impl::findFirstOf<'='>(parameter, equals + 1) != std::string_view::npos) {
 				ThrowBalauException(Exception::NetworkException, "Invalid parameter list");
 			} else {
-				keysAndValues.emplace(keyAndValue[0], keyAndValue[1]);
+				handler(parameter.substr(0, equals), parameter.substr(equals + 1));
 			}
 		}
-
-		return keysAndValues;
 	}
 
 	///
@@ -113,37 +167,77 @@ struct UrlDecode {
 	/// @throw NetworkException if throwOnError was set to true and the input was invalid
 	///
 	static std::string decode(const std::string_view input, bool validateUtf8 = true, bool throwOnError = false) {
-		std::string output;
-		size_t index = 0;
+		std::string output(input);
+		decodeInPlace(output, validateUtf8, throwOnError);
+		return output;
+	}
+
+	///
+	/// Decode the percent encoded string in place, according to the rules of the decode function.
+	///
+	/// The string is shrunk to the decoded length. No allocations are performed.
+	///
+	/// @param value the percent encoded string, which is replaced by the decoded string
+	/// @param validateUtf8 if true, the decoded percent encoded data will only be added if it is valid UTF-8
+	/// @param throwOnError if true, errors will cause an exception to be thrown instead of being silently ignored
+	/// @throw NetworkException if throwOnError was set to true and the input was invalid
+	///
+	static void decodeInPlace(std::string & value, bool validateUtf8 = true, bool throwOnError = false) {
+		value.resize(decodeInPlace(value.data(), value.length(), validateUtf8, throwOnError));
+	}
+
+	///
+	/// Decode the percent encoded character data in place, according to the rules of the decode function.
+	///
+	/// Decoding never lengthens the data, so the decoded characters are written over
+	/// the input. Runs of characters that do not require decoding are located with a
+	/// vectorised scan and are moved as a block.
+	///
+	/// @param data the percent encoded character data, which is replaced by the decoded data
+	/// @param length the length of the percent encoded character data
+	/// @param validateUtf8 if true, the decoded percent encoded data will only be added if it is valid UTF-8
+	/// @param throwOnError if true, errors will cause an exception to be thrown instead of being silently ignored
+	/// @return the length of the decoded data
+	/// @throw NetworkException if throwOnError was set to true and the input was invalid
+	///
+	static size_t decodeInPlace(char * data, size_t length, bool validateUtf8 = true, bool throwOnError = false) {
+		const std::string_view input(data, length);
+		size_t read = Impl::findFirstOf<'+', '%'>(input);
+
+		if (read == std::string_view::npos) {
+			return length;
+		}
+
+		size_t write = read;
 
-		while (index < input.length()) {
-			switch (input[index]) {
+		while (read < length) {
+			switch (data[read]) {
 				case '+': {
-					output += ' ';
-					++index;
+					data[write++] = ' ';
+					++read;
 					break;
 				}
 
 				case '%': {
-					std::string thisOutput;
+					const size_t sequenceStart = write;
 
-					while (input[index] == '%') {
-						++index;
-
-						if (index == input.length()) {
-							// Illegal input.. % character on its own at the end.
+					while (read < length && data[read] == '%') {
+						if (read + 2 >= length) {
+							// Illegal input.. % character without two following characters at the end.
 							if (throwOnError) {
 								ThrowBalauException(Exception::NetworkException, "Invalid percent encoded string");
 							}
 
-							continue;
+							read = length;
+							break;
 						}
 
-						const size_t x = index;
-						++index;
+						const int high = hexValue(data[read + 1]);
+						const int low = hexValue(data[read + 2]);
+						read += 3;
 
-						if (index == input.length()) {
-							// Illegal input.. % character with single following character at the end.
+						if (high < 0 || low < 0) {
+							// Illegal input.. non-hexadecimal characters.
 							if (throwOnError) {
 								ThrowBalauException(Exception::NetworkException, "Invalid percent encoded string");
 							}
@@ -151,54 +245,61 @@ struct UrlDecode {
 							continue;
 						}
 
-						// Try to convert the hex character pair into an unsigned byte.
-						std::string_view v = input.substr(x, 2);
-						unsigned char b;
-						fromString(b, v, 16);
-						thisOutput += (char) b;
-						++index;
+						data[write++] = (char) ((high << 4) | low);
 					}
 
-					bool valid = true;
-
-					if (validateUtf8) {
-						int offset = 0;
-
-						while (offset != (int) thisOutput.length()) {
-							Character::getNextUtf8Safe(thisOutput, offset);
-
-							if (offset < 0) {
-								// Not valid UTF-8.
-								if (throwOnError) {
-									ThrowBalauException(Exception::NetworkException, "Invalid percent encoded string");
-								}
-
-								valid = false;
-								break;
-							}
+					if (validateUtf8 && !isValidUtf8(std::string_view(data + sequenceStart, write - sequenceStart))) {
+						// Not valid UTF-8.
+						if (throwOnError) {
+							ThrowBalauException(Exception::NetworkException, "Invalid percent encoded string");
 						}
-					}
 
-					if (valid) {
-						output += thisOutput;
+						write = sequenceStart;
 					}
 
 					break;
 				}
 
 				default: {
-					output += input[index];
-					++index;
+					const size_t next = std::min(Impl::findFirstOf<'+', '%'>(input, read), length);
+					std::memmove(data + write, data + read, next - read);
+					write += next - read;
+					read = next;
 					break;
 				}
 			}
 		}
 
-		return output;
+		return write;
 	}
 
 	////////////////////////// Private implementation /////////////////////////
 
+	static int hexValue(char c) {
+		if (c >= '0' && c <= '9') {
+			return c - '0';
+		} else if (c >= 'a' && c <= 'f') {
+			return c - 'a' + 10;
+		} else if (c >= 'A' && c <= 'F') {
+			return c - 'A' + 10;
+		} else {
+			return -1;
+		}
+	}
+
+	static bool isValidUtf8(std::string_view bytes) {
+		int offset = 0;
+
+		while (offset != (int) bytes.length()) {
+			// Invalid sequences are signalled by a negative code point.
+			if ((int32_t) Character::getNextUtf8Safe(bytes, offset) < 0) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	UrlDecode() = delete;
 	UrlDecode(const UrlDecode &) = delete;
 	UrlDecode & operator = (const UrlDecode &) = delete;
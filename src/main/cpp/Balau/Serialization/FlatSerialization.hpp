@@ -0,0 +1,561 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file FlatSerialization.hpp
+///
+/// Compact binary serialisation into contiguous buffers.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_SERIALIZATION__FLAT_SERIALIZATION
+#define COM_BORA_SOFTWARE__BALAU_SERIALIZATION__FLAT_SERIALIZATION
+
+#include <Balau/Exception/SerializationExceptions.hpp>
+#include <Balau/Serialization/SerializationMacros.hpp>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Balau::Serialization {
+
+namespace Impl {
+
+template <typename T> struct IsNvp : std::false_type {};
+template <typename T> struct IsNvp<boost::serialization::nvp<T>> : std::true_type {};
+
+template <typename T> struct IsVector : std::false_type {};
+template <typename T, typename A> struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T> struct IsStdArray : std::false_type {};
+template <typename T, size_t N> struct IsStdArray<std::array<T, N>> : std::true_type {};
+
+template <typename T> struct IsPair : std::false_type {};
+template <typename F, typename S> struct IsPair<std::pair<F, S>> : std::true_type {};
+
+template <typename T> struct IsMap : std::false_type {};
+template <typename K, typename V, typename C, typename A> struct IsMap<std::map<K, V, C, A>> : std::true_type {};
+template <typename K, typename V, typename H, typename E, typename A> struct IsMap<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+template <typename T> struct IsSet : std::false_type {};
+template <typename K, typename C, typename A> struct IsSet<std::set<K, C, A>> : std::true_type {};
+template <typename K, typename H, typename E, typename A> struct IsSet<std::unordered_set<K, H, E, A>> : std::true_type {};
+
+template <typename T> struct IsOptional : std::false_type {};
+template <typename T> struct IsOptional<std::optional<T>> : std::true_type {};
+
+// Single object smart pointers with the default deleter.
+template <typename T> struct IsSmartPointer : std::false_type {};
+template <typename T> struct IsSmartPointer<std::unique_ptr<T>> : std::bool_constant<!std::is_array_v<T>> {};
+template <typename T> struct IsSmartPointer<std::shared_ptr<T>> : std::bool_constant<!std::is_array_v<T>> {};
+
+// Types that are copied as raw bytes when contained in vectors.
+template <typename T> constexpr bool isRawElement =
+	std::is_floating_point_v<T> || (std::is_integral_v<T> && sizeof(T) == 1 && !std::is_same_v<T, bool>);
+
+} // namespace Impl
+
+///
+/// Output archive that encodes objects into a contiguous byte buffer.
+///
+/// The archive is a drop-in alternative to the Boost binary output archive for
+/// types that provide a Boost serialize method. Fields are declared in the same
+/// way, via the BoostSerialization macro. The encoding is selected at compile time
+/// for each field type, with no virtual dispatch and no stream buffers.
+///
+/// The encoding is as follows:
+///  - unsigned integers and enums are encoded as LEB128 varints;
+///  - signed integers are zigzag encoded and then encoded as varints;
+///  - bools and single byte integers are encoded as a single byte;
+///  - floating point values are encoded as their native bytes;
+///  - strings, vectors, sets, unordered sets, maps and unordered maps are encoded as
+///    a varint size followed by their elements;
+///  - arrays and pairs are encoded as their elements;
+///  - optionals, unique pointers and shared pointers are encoded as a presence byte,
+///    followed by the contained object if present;
+///  - class types are encoded as a varint class version followed by their serialized fields.
+///
+/// Class types may provide a serialize method, save and load methods, or a free
+/// serialize function found via argument dependent lookup, as for Boost
+/// serialization. Class versions are obtained from the Boost class version trait,
+/// which is set via the BoostSerializationClassVersion macro. The decoded class
+/// version is passed to the serialize method of the class when decoding.
+///
+/// Object tracking is not performed. Each smart pointer is encoded as a separate
+/// copy of its object, thus shared pointers that share an object are decoded as
+/// pointers to separate objects and cycles cannot be encoded. Raw pointers, and
+/// smart pointers to polymorphic types, are not supported.
+///
+/// Floating point values are encoded in the native byte order. The encoding is
+/// thus only portable between platforms of the same endianness.
+///
+class FlatOutputArchive {
+	///
+	/// Create an output archive that appends to the supplied buffer.
+	///
+	public: explicit FlatOutputArchive(std::vector<char> & buffer_)
+		: buffer(buffer_) {}
+
+	///
+	/// Encode the supplied value.
+	///
+	public: template <typename T> FlatOutputArchive & operator & (const T & value) {
+		write(value);
+		return *this;
+	}
+
+	///
+	/// Encode the supplied value.
+	///
+	public: template <typename T> FlatOutputArchive & operator << (const T & value) {
+		write(value);
+		return *this;
+	}
+
+	///
+	/// Encode an unsigned integer as a LEB128 varint.
+	///
+	public: void writeVarint(uint64_t value) {
+		char bytes[10];
+		size_t count = 0;
+
+		while (value >= 0x80U) {
+			bytes[count++] = (char) (value | 0x80U);
+			value >>= 7U;
+		}
+
+		bytes[count++] = (char) value;
+		buffer.insert(buffer.end(), bytes, bytes + count);
+	}
+
+	///
+	/// Append raw bytes to the buffer.
+	///
+	public: void writeBytes(const char * data, size_t size) {
+		buffer.insert(buffer.end(), data, data + size);
+	}
+
+	///
+	/// Boost serialization compatibility (the archive saves).
+	///
+	public: using is_saving = std::true_type;
+
+	///
+	/// Boost serialization compatibility (the archive does not load).
+	///
+	public: using is_loading = std::false_type;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: template <typename T> void write(const T & value) {
+		if constexpr (Impl::IsNvp<T>::value) {
+			write(value.const_value());
+		} else if constexpr (std::is_same_v<T, bool> || (std::is_integral_v<T> && sizeof(T) == 1)) {
+			buffer.push_back((char) value);
+		} else if constexpr (std::is_enum_v<T>) {
+			write((std::underlying_type_t<T>) value);
+		} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			const auto v = (int64_t) value;
+			writeVarint(((uint64_t) v << 1U) ^ (uint64_t) (v >> 63));
+		} else if constexpr (std::is_integral_v<T>) {
+			writeVarint((uint64_t) value);
+		} else if constexpr (std::is_floating_point_v<T>) {
+			writeBytes(reinterpret_cast<const char *>(&value), sizeof(T));
+		} else if constexpr (std::is_same_v<T, std::string>) {
+			writeVarint(value.size());
+			writeBytes(value.data(), value.size());
+		} else if constexpr (Impl::IsVector<T>::value) {
+			using E = typename T::value_type;
+			writeVarint(value.size());
+
+			if constexpr (Impl::isRawElement<E>) {
+				writeBytes(reinterpret_cast<const char *>(value.data()), value.size() * sizeof(E));
+			} else {
+				for (const auto & element : value) {
+					write(element);
+				}
+			}
+		} else if constexpr (Impl::IsStdArray<T>::value) {
+			for (const auto & element : value) {
+				write(element);
+			}
+		} else if constexpr (Impl::IsPair<T>::value) {
+			write(value.first);
+			write(value.second);
+		} else if constexpr (Impl::IsMap<T>::value) {
+			writeVarint(value.size());
+
+			for (const auto & entry : value) {
+				write(entry.first);
+				write(entry.second);
+			}
+		} else if constexpr (Impl::IsSet<T>::value) {
+			writeVarint(value.size());
+
+			for (const auto & element : value) {
+				write(element);
+			}
+		} else if constexpr (Impl::IsOptional<T>::value || Impl::IsSmartPointer<T>::value) {
+			if constexpr (Impl::IsSmartPointer<T>::value) {
+				static_assert(
+					  !std::is_polymorphic_v<typename T::element_type>
+					, "Smart pointers to polymorphic types are not supported by flat serialisation."
+				);
+			}
+
+			buffer.push_back((char) (bool) value);
+
+			if (value) {
+				write(*value);
+			}
+		} else {
+			static_assert(
+				  std::is_class_v<T> && !std::is_pointer_v<T>
+				, "Unsupported type for flat serialisation."
+			);
+
+			const unsigned int version = boost::serialization::version<T>::value;
+			writeVarint(version);
+			boost::serialization::serialize_adl(*this, const_cast<T &>(value), version);
+		}
+	}
+
+	private: std::vector<char> & buffer;
+};
+
+///
+/// Input archive that decodes objects from a contiguous byte buffer.
+///
+/// See FlatOutputArchive for details of the encoding.
+///
+class FlatInputArchive {
+	///
+	/// Create an input archive that decodes from the supplied bytes.
+	///
+	/// The bytes must remain valid for the lifetime of the archive.
+	///
+	public: FlatInputArchive(const char * data, size_t size)
+		: position(data)
+		, end(data + size) {}
+
+	///
+	/// Decode into the supplied value.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	public: template <typename T> FlatInputArchive & operator & (T && value) {
+		read(value);
+		return *this;
+	}
+
+	///
+	/// Decode into the supplied value.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	public: template <typename T> FlatInputArchive & operator >> (T && value) {
+		read(value);
+		return *this;
+	}
+
+	///
+	/// Decode a LEB128 varint.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	public: uint64_t readVarint() {
+		uint64_t value = 0;
+
+		for (unsigned int shift = 0; shift < 64; shift += 7) {
+			if (position == end) {
+				ThrowBalauException(Exception::SerializationException, "Truncated varint in flat serialised data.");
+			}
+
+			const auto byte = (uint8_t) *position++;
+
+			// The tenth byte may only contribute the most significant bit.
+			if (shift == 63 && (byte & 0x7EU) != 0) {
+				ThrowBalauException(Exception::SerializationException, "Varint exceeds 64 bits in flat serialised data.");
+			}
+
+			value |= (uint64_t) (byte & 0x7FU) << shift;
+
+			if ((byte & 0x80U) == 0) {
+				return value;
+			}
+		}
+
+		ThrowBalauException(Exception::SerializationException, "Overlong varint in flat serialised data.");
+	}
+
+	///
+	/// Read raw bytes from the buffer.
+	///
+	/// @throw SerializationException if the data is truncated
+	///
+	public: void readBytes(char * data, size_t size) {
+		require(size);
+		std::memcpy(data, position, size);
+		position += size;
+	}
+
+	///
+	/// Get the number of bytes that have not yet been decoded.
+	///
+	public: size_t remaining() const {
+		return (size_t) (end - position);
+	}
+
+	///
+	/// Boost serialization compatibility (the archive does not save).
+	///
+	public: using is_saving = std::false_type;
+
+	///
+	/// Boost serialization compatibility (the archive loads).
+	///
+	public: using is_loading = std::true_type;
+
+	////////////////////////// Private implementation /////////////////////////
+
+	private: void require(size_t size) const {
+		if (size > remaining()) {
+			ThrowBalauException(
+				  Exception::SerializationException
+				, ::toString("Truncated flat serialised data (", size, " bytes required, ", remaining(), " available).")
+			);
+		}
+	}
+
+	private: template <typename T> void read(T & value) {
+		if constexpr (Impl::IsNvp<std::remove_const_t<T>>::value) {
+			read(value.value());
+		} else if constexpr (std::is_same_v<T, bool>) {
+			require(1);
+			value = *position++ != 0;
+		} else if constexpr (std::is_integral_v<T> && sizeof(T) == 1) {
+			require(1);
+			value = (T) *position++;
+		} else if constexpr (std::is_enum_v<T>) {
+			std::underlying_type_t<T> underlying;
+			read(underlying);
+			value = (T) underlying;
+		} else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+			const uint64_t v = readVarint();
+			value = (T) (int64_t) ((v >> 1U) ^ (~(v & 1U) + 1U));
+		} else if constexpr (std::is_integral_v<T>) {
+			value = (T) readVarint();
+		} else if constexpr (std::is_floating_point_v<T>) {
+			readBytes(reinterpret_cast<char *>(&value), sizeof(T));
+		} else if constexpr (std::is_same_v<T, std::string>) {
+			const size_t size = readSize(1);
+			value.assign(position, size);
+			position += size;
+		} else if constexpr (Impl::IsVector<T>::value) {
+			using E = typename T::value_type;
+			const size_t size = readSize(Impl::isRawElement<E> ? sizeof(E) : 1);
+
+			if constexpr (Impl::isRawElement<E>) {
+				value.resize(size);
+				readBytes(reinterpret_cast<char *>(value.data()), size * sizeof(E));
+			} else if constexpr (std::is_same_v<E, bool>) {
+				// Vectors of bools hold proxies rather than bool references.
+				value.resize(size);
+
+				for (size_t m = 0; m < size; ++m) {
+					bool element;
+					read(element);
+					value[m] = element;
+				}
+			} else {
+				value.clear();
+				value.reserve(size);
+
+				for (size_t m = 0; m < size; ++m) {
+					value.emplace_back();
+					read(value.back());
+				}
+			}
+		} else if constexpr (Impl::IsStdArray<T>::value) {
+			for (auto & element : value) {
+				read(element);
+			}
+		} else if constexpr (Impl::IsPair<T>::value) {
+			read(value.first);
+			read(value.second);
+		} else if constexpr (Impl::IsMap<T>::value) {
+			const size_t size = readSize(1);
+			value.clear();
+
+			for (size_t m = 0; m < size; ++m) {
+				typename T::key_type key {};
+				typename T::mapped_type mapped {};
+				read(key);
+				read(mapped);
+				value.emplace_hint(value.end(), std::move(key), std::move(mapped));
+			}
+		} else if constexpr (Impl::IsSet<T>::value) {
+			const size_t size = readSize(1);
+			value.clear();
+
+			for (size_t m = 0; m < size; ++m) {
+				typename T::value_type element {};
+				read(element);
+				value.emplace_hint(value.end(), std::move(element));
+			}
+		} else if constexpr (Impl::IsOptional<T>::value) {
+			if (readPresence()) {
+				value.emplace();
+				read(*value);
+			} else {
+				value.reset();
+			}
+		} else if constexpr (Impl::IsSmartPointer<T>::value) {
+			using E = typename T::element_type;
+
+			static_assert(
+				!std::is_polymorphic_v<E>, "Smart pointers to polymorphic types are not supported by flat serialisation."
+			);
+
+			if (readPresence()) {
+				value = T(new E());
+				read(*value);
+			} else {
+				value.reset();
+			}
+		} else {
+			static_assert(
+				  std::is_class_v<T> && !std::is_pointer_v<T>
+				, "Unsupported type for flat serialisation."
+			);
+
+			const uint64_t version = readVarint();
+
+			if (version > boost::serialization::version<T>::value) {
+				ThrowBalauException(
+					  Exception::SerializationException
+					, ::toString(
+						  "Flat serialised data has class version ", version
+						, " which is newer than the supported version ", boost::serialization::version<T>::value, "."
+					)
+				);
+			}
+
+			boost::serialization::serialize_adl(*this, value, (unsigned int) version);
+		}
+	}
+
+	// Read the presence byte of an optional value.
+	private: bool readPresence() {
+		require(1);
+		const auto presence = (uint8_t) *position++;
+
+		if (presence > 1) {
+			ThrowBalauException(
+				  Exception::SerializationException
+				, ::toString("Invalid presence byte ", (unsigned int) presence, " in flat serialised data.")
+			);
+		}
+
+		return presence == 1;
+	}
+
+	// Read a size, checking that at least size * minimumElementBytes bytes remain.
+	private: size_t readSize(size_t minimumElementBytes) {
+		const uint64_t size = readVarint();
+
+		if (size > remaining() / minimumElementBytes) {
+			ThrowBalauException(
+				  Exception::SerializationException
+				, ::toString("Flat serialised size ", size, " exceeds the remaining data (", remaining(), " bytes).")
+			);
+		}
+
+		return (size_t) size;
+	}
+
+	private: const char * position;
+	private: const char * const end;
+};
+
+///
+/// Convenience functions for flat serialisation.
+///
+class FlatSerialization final {
+	///
+	/// Encode the object, appending the bytes to the supplied buffer.
+	///
+	public: template <typename T> static void marshal(std::vector<char> & buffer, const T & object) {
+		FlatOutputArchive archive(buffer);
+		archive << object;
+	}
+
+	///
+	/// Encode the object into a new buffer.
+	///
+	public: template <typename T> static std::vector<char> marshal(const T & object) {
+		std::vector<char> buffer;
+		marshal(buffer, object);
+		return buffer;
+	}
+
+	///
+	/// Decode an object from the supplied bytes.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	public: template <typename T> static void unmarshal(const char * data, size_t size, T & object) {
+		FlatInputArchive archive(data, size);
+		archive >> object;
+	}
+
+	///
+	/// Decode an object from the supplied bytes.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	public: template <typename T> static T unmarshal(const char * data, size_t size) {
+		T object {};
+		unmarshal(data, size, object);
+		return object;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	public: FlatSerialization() = delete;
+	public: FlatSerialization(const FlatSerialization &) = delete;
+	public: FlatSerialization & operator = (const FlatSerialization &) = delete;
+};
+
+} // namespace Balau::Serialization
+
+#endif // COM_BORA_SOFTWARE__BALAU_SERIALIZATION__FLAT_SERIALIZATION
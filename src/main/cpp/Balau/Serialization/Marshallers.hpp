@@ -0,0 +1,95 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+///
+/// @file Marshallers.hpp
+///
+/// Marshaller policies used to select the serialisation format of queues.
+///
+
+#ifndef COM_BORA_SOFTWARE__BALAU_SERIALIZATION__MARSHALLERS
+#define COM_BORA_SOFTWARE__BALAU_SERIALIZATION__MARSHALLERS
+
+#include <Balau/Serialization/FlatSerialization.hpp>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+
+namespace Balau::Serialization {
+
+///
+/// Marshaller policy that uses Boost binary archives.
+///
+/// The object type must provide Boost serialize or save/load methods.
+///
+struct BoostArchiveMarshaller {
+	///
+	/// Marshal the object, appending the bytes to the supplied buffer.
+	///
+	template <typename T> static void marshal(std::vector<char> & buffer, const T & object) {
+		SinkBuffer oStreamBuffer { SinkDevice(buffer) };
+		boost::archive::binary_oarchive archive(oStreamBuffer);
+		archive << BoostSerialization(object);
+	}
+
+	///
+	/// Unmarshal the object from the supplied bytes.
+	///
+	template <typename T> static void unmarshal(const char * data, size_t size, T & object) {
+		SourceBuffer iStreamBuffer(SourceDevice(data, size));
+		boost::archive::binary_iarchive archive(iStreamBuffer);
+		archive >> BoostSerialization(object);
+	}
+
+	private: using SinkDevice   = boost::iostreams::back_insert_device<std::vector<char>>;
+	private: using SinkBuffer   = boost::iostreams::stream_buffer<SinkDevice>;
+	private: using SourceDevice = boost::iostreams::basic_array_source<char>;
+	private: using SourceBuffer = boost::iostreams::stream_buffer<SourceDevice>;
+};
+
+///
+/// Marshaller policy that uses flat serialisation.
+///
+/// The object type must provide a Boost serialize method, or be a type that is
+/// natively supported by the flat archives.
+///
+struct FlatMarshaller {
+	///
+	/// Marshal the object, appending the bytes to the supplied buffer.
+	///
+	template <typename T> static void marshal(std::vector<char> & buffer, const T & object) {
+		FlatSerialization::marshal(buffer, object);
+	}
+
+	///
+	/// Unmarshal the object from the supplied bytes.
+	///
+	/// @throw SerializationException if the data is truncated or malformed
+	///
+	template <typename T> static void unmarshal(const char * data, size_t size, T & object) {
+		FlatSerialization::unmarshal(data, size, object);
+	}
+};
+
+} // namespace Balau::Serialization
+
+#endif // COM_BORA_SOFTWARE__BALAU_SERIALIZATION__MARSHALLERS
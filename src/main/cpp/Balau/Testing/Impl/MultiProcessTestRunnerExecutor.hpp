@@ -42,7 +42,7 @@ class MultiProcessTestRunnerExecutor : public TestRunnerExecutor {
 	private: class MultiProcessTestResultQueue : public TestResultQueue {
 		private: static constexpr unsigned int messageSizeLimit = 2048;
 
-		private: Interprocess::SharedMemoryQueue<TestResult> resultQueue;
+		private: Interprocess::SharedMemoryQueue<TestResult, Serialization::FlatMarshaller> resultQueue;
 
 		public: MultiProcessTestResultQueue() : resultQueue(queueSize, messageSizeLimit) {}
 
@@ -0,0 +1,275 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+
+#include <Balau/Concurrent/ThreadPool.hpp>
+#include <Balau/Application/Injector.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+namespace Balau::Concurrent {
+
+struct ThreadPoolTest : public Testing::TestGroup<ThreadPoolTest> {
+	ThreadPoolTest() {
+		RegisterTestCase(submit);
+		RegisterTestCase(submitException);
+		RegisterTestCase(execute);
+		RegisterTestCase(parallelFor);
+		RegisterTestCase(parallelForException);
+		RegisterTestCase(parallelInvoke);
+		RegisterTestCase(nestedForkJoin);
+		RegisterTestCase(destructorDrainsTasks);
+		RegisterTestCase(parkedWorkersWake);
+		RegisterTestCase(injection);
+	}
+
+	void submit() {
+		ThreadPool pool(4);
+
+		AssertThat(pool.getWorkerCount(), is((size_t) 4));
+		AssertThat(pool.isWorkerThread(), is(false));
+
+		std::vector<std::future<size_t>> futures;
+
+		for (size_t m = 0; m < 1000; m++) {
+			futures.emplace_back(pool.submit([] (size_t a, size_t b) { return a * b; }, m, (size_t) 3));
+		}
+
+		for (size_t m = 0; m < futures.size(); m++) {
+			AssertThat(futures[m].get(), is(m * 3));
+		}
+
+		auto onWorker = pool.submit([&pool] () { return pool.isWorkerThread(); });
+		AssertThat(onWorker.get(), is(true));
+
+		// Tasks submitted from inside the pool are pushed onto the worker's deque.
+		auto outer = pool.submit(
+			[&pool] () {
+				auto inner = pool.submit([] () { return std::string("inner"); });
+				return inner.get() + " outer";
+			}
+		);
+
+		AssertThat(outer.get(), is(std::string("inner outer")));
+	}
+
+	void submitException() {
+		ThreadPool pool(2);
+
+		auto future = pool.submit([] () -> int { ThrowBalauException(Exception::IllegalStateException, "task failed"); return 0; });
+
+		AssertThat([&future] () { future.get(); }, throws<Exception::IllegalStateException>());
+	}
+
+	void execute() {
+		std::atomic<size_t> count { 0 };
+
+		{
+			ThreadPool pool(3);
+
+			for (size_t m = 0; m < 500; m++) {
+				pool.execute([&count] () { count.fetch_add(1); });
+			}
+
+			pool.execute([] () { throw std::runtime_error("discarded"); });
+		}
+
+		AssertThat(count.load(), is((size_t) 500));
+	}
+
+	void parallelFor() {
+		ThreadPool pool(4);
+
+		const size_t count = 100000;
+		std::vector<size_t> values(count, 0);
+
+		pool.parallelFor((size_t) 0, count, [&values] (size_t index) { values[index] = index; });
+
+		AssertThat(std::accumulate(values.begin(), values.end(), (size_t) 0), is(count * (count - 1) / 2));
+
+		std::atomic<int> sum { 0 };
+		pool.parallelFor(-50, 50, [&sum] (int index) { sum.fetch_add(index); }, 7);
+		AssertThat(sum.load(), is(-50));
+
+		// Empty range.
+		pool.parallelFor(10, 10, [] (int) { throw std::runtime_error("not called"); });
+	}
+
+	void parallelForException() {
+		ThreadPool pool(4);
+		std::atomic<size_t> calls { 0 };
+
+		AssertThat(
+			  [&] () {
+				pool.parallelFor(
+					  (size_t) 0
+					, (size_t) 1000
+					, [&calls] (size_t index) {
+						calls.fetch_add(1);
+
+						if (index == 500) {
+							ThrowBalauException(Exception::IllegalStateException, "index 500");
+						}
+					}
+					, 10
+				);
+			}
+			, throws<Exception::IllegalStateException>()
+		);
+
+		// The remaining chunks completed before the exception was rethrown.
+		AssertThat(calls.load() >= 991, is(true));
+	}
+
+	void parallelInvoke() {
+		ThreadPool pool(3);
+
+		int a = 0;
+		std::string b;
+		double c = 0;
+
+		pool.parallelInvoke(
+			  [&a] () { a = 1; }
+			, [&b] () { b = "two"; }
+			, [&c] () { c = 3.0; }
+		);
+
+		AssertThat(a, is(1));
+		AssertThat(b, is(std::string("two")));
+		AssertThat(c, is(3.0));
+
+		AssertThat(
+			  [&pool] () {
+				pool.parallelInvoke(
+					  [] () {}
+					, [] () { ThrowBalauException(Exception::IllegalStateException, "second"); }
+				);
+			}
+			, throws<Exception::IllegalStateException>()
+		);
+	}
+
+	static uint64_t fibonacci(ThreadPool & pool, unsigned int n) {
+		if (n < 2) {
+			return n;
+		}
+
+		if (n < 12) {
+			return fibonacci(pool, n - 1) + fibonacci(pool, n - 2);
+		}
+
+		uint64_t x = 0;
+		uint64_t y = 0;
+		pool.parallelInvoke([&] () { x = fibonacci(pool, n - 1); }, [&] () { y = fibonacci(pool, n - 2); });
+		return x + y;
+	}
+
+	void nestedForkJoin() {
+		// Joins inside tasks execute other tasks whilst waiting, so a small pool does not deadlock.
+		ThreadPool pool(2);
+
+		auto future = pool.submit([&pool] () { return fibonacci(pool, 25); });
+		AssertThat(future.get(), is((uint64_t) 75025));
+
+		std::atomic<size_t> count { 0 };
+
+		pool.parallelFor(
+			  0
+			, 20
+			, [&pool, &count] (int) {
+				pool.parallelFor(0, 50, [&count] (int) { count.fetch_add(1); });
+			}
+		);
+
+		AssertThat(count.load(), is((size_t) 1000));
+	}
+
+	void destructorDrainsTasks() {
+		std::atomic<size_t> count { 0 };
+
+		{
+			ThreadPool pool(1);
+
+			for (size_t m = 0; m < 100; m++) {
+				pool.execute(
+					[&pool, &count] () {
+						pool.execute([&count] () { count.fetch_add(1); });
+						count.fetch_add(1);
+					}
+				);
+			}
+		}
+
+		AssertThat(count.load(), is((size_t) 200));
+	}
+
+	//
+	// Workers park when idle and joining threads sleep whilst the remaining tasks of
+	// their group run on other workers. Each round starts with all workers parked.
+	//
+	void parkedWorkersWake() {
+		ThreadPool pool(4);
+
+		for (size_t round = 0; round < 20; ++round) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+			AssertThat(pool.submit([round] () { return round; }).get(), is(round));
+
+			std::atomic<size_t> count { 0 };
+
+			pool.parallelFor(
+				  0
+				, 8
+				, [&count] (int index) {
+					if (index == 7) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					}
+
+					count.fetch_add(1);
+				}
+				, 1
+			);
+
+			AssertThat(count.load(), is((size_t) 8));
+		}
+	}
+
+	void injection() {
+		class Configuration : public ApplicationConfiguration {
+			public: void configure() const override {
+				bind<size_t>("balau.threadPool.workerCount").toValue(3);
+				bind<bool>("balau.threadPool.pinWorkers").toValue(true);
+				bind<ThreadPool>().toSingleton();
+			}
+		};
+
+		auto injector = Injector::create(Configuration());
+
+		auto pool = injector->getShared<ThreadPool>();
+
+		AssertThat(pool->getWorkerCount(), is((size_t) 3));
+		AssertThat(pool.get(), is(injector->getShared<ThreadPool>().get()));
+		AssertThat(pool->submit([] () { return 42; }).get(), is(42));
+	}
+};
+
+} // namespace Balau::Concurrent
@@ -88,6 +88,8 @@ struct ArrayBlockingQueueTest : public Testing::TestGroup<ArrayBlockingQueueTest
 	ArrayBlockingQueueTest() {
 		RegisterTestCase(fullQueue);
 		RegisterTestCase(fullQueueCallbacks);
+		RegisterTestCase(batch);
+		RegisterTestCase(batchAcrossThreads);
 	}
 
 	void fullQueue() {
@@ -186,6 +188,77 @@ struct ArrayBlockingQueueTest : public Testing::TestGroup<ArrayBlockingQueueTest
 			AssertThat(fullCount.load(), is(spaceNowAvailableCount.load()));
 		}
 	}
+
+	void batch() {
+		ArrayBlockingQueue<Element> queue(8);
+		std::vector<Element> input;
+
+		for (size_t m = 1; m <= 5; m++) {
+			input.emplace_back(m);
+		}
+
+		queue.enqueueAll(std::move(input));
+
+		std::vector<Element> output;
+
+		AssertThat(queue.dequeueUpTo(3, std::back_inserter(output), std::chrono::milliseconds(0)), is((size_t) 3));
+		AssertThat(queue.dequeueUpTo(10, std::back_inserter(output), std::chrono::milliseconds(0)), is((size_t) 2));
+		AssertThat(queue.dequeueUpTo(10, std::back_inserter(output), std::chrono::milliseconds(10)), is((size_t) 0));
+		AssertThat(queue.empty(), is(true));
+
+		for (size_t m = 0; m < output.size(); m++) {
+			AssertThat(output[m].value, is(m + 1));
+		}
+	}
+
+	void batchAcrossThreads() {
+		constexpr size_t QueueSize = 16;
+		constexpr size_t BatchSize = 40;
+		constexpr size_t BatchCount = 250;
+		constexpr size_t ConsumerCount = 2;
+
+		ArrayBlockingQueue<Element> queue(QueueSize);
+		std::atomic<size_t> dequeued { 0 };
+		std::atomic<size_t> sum { 0 };
+		std::vector<std::thread> consumers;
+
+		for (size_t c = 0; c < ConsumerCount; c++) {
+			consumers.emplace_back(
+				[&queue, &dequeued, &sum] () {
+					std::vector<Element> output;
+
+					while (dequeued < BatchSize * BatchCount) {
+						output.clear();
+						const size_t count = queue.dequeueUpTo(7, std::back_inserter(output), std::chrono::milliseconds(10));
+
+						for (auto & element : output) {
+							sum += element.value;
+						}
+
+						dequeued += count;
+					}
+				}
+			);
+		}
+
+		for (size_t b = 0; b < BatchCount; b++) {
+			std::vector<Element> input;
+
+			for (size_t m = 1; m <= BatchSize; m++) {
+				input.emplace_back(m);
+			}
+
+			queue.enqueueAll(std::move(input));
+		}
+
+		for (auto & consumer : consumers) {
+			consumer.join();
+		}
+
+		AssertThat(dequeued.load(), is(BatchSize * BatchCount));
+		AssertThat(sum.load(), is(BatchCount * BatchSize * (BatchSize + 1) / 2));
+		AssertThat(queue.empty(), is(true));
+	}
 };
 
 } // namespace Balau::Container
@@ -0,0 +1,154 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+
+#include <Balau/Container/LockFreeBlockingQueue.hpp>
+
+#include <atomic>
+#include <thread>
+
+namespace Balau::Container {
+
+struct LockFreeBlockingQueueTest : public Testing::TestGroup<LockFreeBlockingQueueTest> {
+	LockFreeBlockingQueueTest() {
+		RegisterTestCase(singleThread);
+		RegisterTestCase(fullQueue);
+		RegisterTestCase(blockingDequeue);
+		RegisterTestCase(multipleProducersAndConsumers);
+	}
+
+	void singleThread() {
+		LockFreeBlockingQueue<std::string> queue(3);
+
+		AssertThat(queue.getCapacity(), is((size_t) 4));
+		AssertThat(queue.empty(), is(true));
+		AssertThat(queue.full(), is(false));
+
+		for (size_t m = 0; m < 100; m++) {
+			queue.enqueue(::toString(m));
+			queue.enqueue(::toString(m + 1));
+			AssertThat(queue.dequeue(), is(::toString(m)));
+			AssertThat(queue.tryDequeue(), is(::toString(m + 1)));
+		}
+
+		bool success = true;
+		AssertThat(queue.tryDequeue(success), is(std::string()));
+		AssertThat(success, is(false));
+	}
+
+	void fullQueue() {
+		LockFreeBlockingQueue<size_t> queue(2);
+
+		AssertThat(queue.tryEnqueue(1), is(true));
+		AssertThat(queue.tryEnqueue(2), is(true));
+		AssertThat(queue.full(), is(true));
+		AssertThat(queue.tryEnqueue(3), is(false));
+
+		const auto start = std::chrono::steady_clock::now();
+		AssertThat(queue.tryEnqueue(3, std::chrono::milliseconds(20)), is(false));
+		AssertThat(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20), is(true));
+
+		std::thread consumer([&queue] () {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.dequeue();
+		});
+
+		// Blocks until the consumer makes space.
+		queue.enqueue(3);
+		consumer.join();
+
+		AssertThat(queue.dequeue(), is((size_t) 2));
+		AssertThat(queue.dequeue(), is((size_t) 3));
+		AssertThat(queue.empty(), is(true));
+	}
+
+	void blockingDequeue() {
+		LockFreeBlockingQueue<size_t> queue(8);
+		bool success = true;
+
+		queue.tryDequeue(std::chrono::milliseconds(20), success);
+		AssertThat(success, is(false));
+
+		std::thread producer([&queue] () {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			queue.enqueue(42);
+		});
+
+		AssertThat(queue.dequeue(), is((size_t) 42));
+		producer.join();
+	}
+
+	// Each consumer verifies that the elements of each producer arrive in order.
+	void multipleProducersAndConsumers() {
+		constexpr size_t ProducerCount = 4;
+		constexpr size_t ConsumerCount = 4;
+		constexpr size_t ElementCount = 50000;
+
+		LockFreeBlockingQueue<size_t> queue(16);
+		std::atomic<size_t> dequeued { 0 };
+		std::atomic<bool> failed { false };
+		std::vector<std::thread> threads;
+
+		for (size_t c = 0; c < ConsumerCount; c++) {
+			threads.emplace_back(
+				[&queue, &dequeued, &failed] () {
+					std::vector<size_t> last(ProducerCount, 0);
+
+					while (dequeued < ProducerCount * ElementCount) {
+						bool success;
+						const size_t element = queue.tryDequeue(std::chrono::milliseconds(10), success);
+
+						if (success) {
+							const size_t producer = element / (ElementCount + 1);
+							const size_t sequence = element % (ElementCount + 1);
+
+							if (sequence <= last[producer]) {
+								failed = true;
+							}
+
+							last[producer] = sequence;
+							++dequeued;
+						}
+					}
+				}
+			);
+		}
+
+		for (size_t p = 0; p < ProducerCount; p++) {
+			threads.emplace_back(
+				[&queue, p] () {
+					for (size_t m = 1; m <= ElementCount; m++) {
+						queue.enqueue(p * (ElementCount + 1) + m);
+					}
+				}
+			);
+		}
+
+		for (auto & thread : threads) {
+			thread.join();
+		}
+
+		AssertThat(failed.load(), is(false));
+		AssertThat(dequeued.load(), is(ProducerCount * ElementCount));
+		AssertThat(queue.empty(), is(true));
+	}
+};
+
+} // namespace Balau::Container
@@ -0,0 +1,145 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/ProcessCyclicBarrier.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Interprocess {
+
+struct ProcessCyclicBarrierTest : public Testing::TestGroup<ProcessCyclicBarrierTest> {
+	ProcessCyclicBarrierTest() {
+		RegisterTestCase(count);
+		RegisterTestCase(cyclesAcrossProcesses);
+		RegisterTestCase(participantDeath);
+	}
+
+	struct State {
+		explicit State(unsigned int participants) : barrier(participants) {}
+
+		ProcessCyclicBarrier barrier;
+		std::atomic<uint32_t> arrivals { 0 };
+	};
+
+	void count() {
+		AssertThat([] () { ProcessCyclicBarrier b(0); }, throws<Exception::SizeException>());
+		AssertThat([] () { ProcessCyclicBarrier b(ProcessCyclicBarrier::MaxParticipants + 1); }, throws<Exception::SizeException>());
+
+		ProcessCyclicBarrier barrier(1);
+		barrier.countdown();
+		barrier.countdown();
+		AssertThat(barrier.isBroken(), is(false));
+	}
+
+	//
+	// No participant may leave a cycle before all participants have arrived at it.
+	//
+	void cyclesAcrossProcesses() {
+		const unsigned int processCount = 4;
+		const unsigned int cycles = 2000;
+		MSharedMemoryObject<State> state(processCount + 1);
+
+		auto participate = [&state, processCount, cycles] () {
+			for (unsigned int cycle = 1; cycle <= cycles; ++cycle) {
+				state->arrivals.fetch_add(1);
+				state->barrier.countdown();
+
+				if (state->arrivals.load() < cycle * (processCount + 1)) {
+					return 1;
+				}
+
+				state->barrier.countdown();
+			}
+
+			return 0;
+		};
+
+		std::vector<int> pids;
+
+		for (unsigned int process = 0; process < processCount; ++process) {
+			pids.push_back(Concurrent::Fork::performFork(participate, true));
+		}
+
+		AssertThat(participate(), is(0));
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+			AssertThat("Child process left a cycle early.", report.exitStatus, is(0));
+		}
+
+		AssertThat(state->arrivals.load(), is(cycles * (processCount + 1)));
+	}
+
+	//
+	// A child process dies after the first cycle. The remaining participants
+	// are released from the second cycle with a broken barrier exception.
+	//
+	void participantDeath() {
+		MSharedMemoryObject<State> state(3U);
+
+		const int dying = Concurrent::Fork::performFork(
+			[&state] () {
+				state->barrier.countdown();
+				return 0;
+			}
+			, true
+		);
+
+		const int surviving = Concurrent::Fork::performFork(
+			[&state] () {
+				state->barrier.countdown();
+
+				try {
+					state->barrier.countdown();
+				} catch (const Exception::BrokenBarrierException &) {
+					return 0;
+				}
+
+				return 1;
+			}
+			, true
+		);
+
+		state->barrier.countdown();
+
+		AssertThat([&state] () { state->barrier.countdown(); }, throws<Exception::BrokenBarrierException>());
+		AssertThat(state->barrier.isBroken(), is(true));
+
+		const auto dyingReport = Concurrent::Fork::waitOnProcess(dying);
+		const auto survivingReport = Concurrent::Fork::waitOnProcess(surviving);
+
+		AssertThat("Child process did not exit correctly.", dyingReport.code, is((int) CLD_EXITED));
+		AssertThat("Child process did not exit correctly.", survivingReport.code, is((int) CLD_EXITED));
+		AssertThat("Child process was not released.", survivingReport.exitStatus, is(0));
+
+		state->barrier.reset();
+		AssertThat(state->barrier.isBroken(), is(false));
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
@@ -0,0 +1,135 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/ProcessEvent.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Interprocess {
+
+struct ProcessEventTest : public Testing::TestGroup<ProcessEventTest> {
+	ProcessEventTest() {
+		RegisterTestCase(manualReset);
+		RegisterTestCase(autoReset);
+		RegisterTestCase(manualResetAcrossProcesses);
+		RegisterTestCase(autoResetAcrossProcesses);
+	}
+
+	void manualReset() {
+		ProcessEvent event;
+
+		AssertThat(event.isSet(), is(false));
+		AssertThat(event.tryWait(std::chrono::milliseconds(10)), is(false));
+
+		event.set();
+		event.wait();
+		AssertThat(event.tryWait(std::chrono::milliseconds(10)), is(true));
+		AssertThat(event.isSet(), is(true));
+
+		event.reset();
+		AssertThat(event.isSet(), is(false));
+	}
+
+	void autoReset() {
+		ProcessEvent event(ProcessEventMode::AutoReset, true);
+
+		AssertThat(event.isSet(), is(true));
+		event.wait();
+		AssertThat(event.isSet(), is(false));
+		AssertThat(event.tryWait(std::chrono::milliseconds(10)), is(false));
+
+		event.set();
+		AssertThat(event.tryWait(std::chrono::milliseconds(10)), is(true));
+		AssertThat(event.tryWait(std::chrono::milliseconds(10)), is(false));
+	}
+
+	void manualResetAcrossProcesses() {
+		MSharedMemoryObject<ProcessEvent> event;
+		std::vector<int> pids;
+
+		for (int process = 0; process < 4; ++process) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&event] () { return event->tryWait(std::chrono::milliseconds(5000)) ? 0 : 1; }, true
+				)
+			);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		event->set();
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+			AssertThat("Child process was not released.", report.exitStatus, is(0));
+		}
+	}
+
+	//
+	// Each set releases a single waiter.
+	//
+	void autoResetAcrossProcesses() {
+		const unsigned int processCount = 4;
+		MSharedMemoryObject<ProcessEvent> event(ProcessEventMode::AutoReset);
+		MSharedMemoryObject<std::atomic<uint32_t>> released(0U);
+		std::vector<int> pids;
+
+		for (unsigned int process = 0; process < processCount; ++process) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&event, &released] () {
+						event->wait();
+						released->fetch_add(1);
+						return 0;
+					}
+					, true
+				)
+			);
+		}
+
+		for (unsigned int m = 1; m <= processCount; ++m) {
+			event->set();
+
+			while (released->load() < m) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			AssertThat(released->load(), is(m));
+		}
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		}
+
+		AssertThat(event->isSet(), is(false));
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
@@ -0,0 +1,223 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/MSharedMemoryObject.hpp>
+#include <Balau/Interprocess/ProcessSemaphore.hpp>
+
+#include <atomic>
+#include <csignal>
+#include <thread>
+#include <vector>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Interprocess {
+
+struct ProcessSemaphoreTest : public Testing::TestGroup<ProcessSemaphoreTest> {
+	ProcessSemaphoreTest() {
+		RegisterTestCase(singleProcess);
+		RegisterTestCase(pingPongAcrossProcesses);
+		RegisterTestCase(permitRecovery);
+		RegisterTestCase(concurrentFirstAcquires);
+		RegisterTestCase(killedDuringAcquireAndRelease);
+	}
+
+	void singleProcess() {
+		ProcessSemaphore semaphore(2);
+
+		AssertThat(semaphore.tryDecrement(), is(true));
+		AssertThat(semaphore.tryDecrement(), is(true));
+		AssertThat(semaphore.tryDecrement(), is(false));
+		AssertThat(semaphore.tryDecrement(std::chrono::milliseconds(10)), is(false));
+
+		std::thread incrementer([&semaphore] () {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			semaphore.increment();
+		});
+
+		semaphore.decrement();
+		incrementer.join();
+
+		semaphore.increment();
+		semaphore.acquire();
+		AssertThat(semaphore.getCount(), is(0U));
+		semaphore.release();
+		AssertThat(semaphore.getCount(), is(1U));
+	}
+
+	struct PingPong {
+		ProcessSemaphore ping;
+		ProcessSemaphore pong;
+	};
+
+	void pingPongAcrossProcesses() {
+		const unsigned int iterations = 20000;
+		MSharedMemoryObject<PingPong> semaphores;
+
+		const int pid = Concurrent::Fork::performFork(
+			[&semaphores, iterations] () {
+				for (unsigned int m = 0; m < iterations; ++m) {
+					semaphores->ping.decrement();
+					semaphores->pong.increment();
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		for (unsigned int m = 0; m < iterations; ++m) {
+			semaphores->ping.increment();
+			semaphores->pong.decrement();
+		}
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat(semaphores->ping.getCount(), is(0U));
+		AssertThat(semaphores->pong.getCount(), is(0U));
+	}
+
+	//
+	// A child process acquires the only permit and exits without releasing it.
+	// The permit is recovered by a waiter in the parent process.
+	//
+	void permitRecovery() {
+		MSharedMemoryObject<ProcessSemaphore> semaphore(1U);
+
+		const int pid = Concurrent::Fork::performFork(
+			[&semaphore] () {
+				semaphore->acquire();
+				return 0;
+			}
+			, true
+		);
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat(semaphore->getCount(), is(0U));
+
+		AssertThat(semaphore->tryAcquire(std::chrono::milliseconds(2000)), is(true));
+		semaphore->release();
+		AssertThat(semaphore->getCount(), is(1U));
+	}
+
+	//
+	// The threads of a child process make their first acquires concurrently and
+	// release all permits before the child exits. The process must occupy a
+	// single holder slot, otherwise permits would be recovered twice.
+	//
+	void concurrentFirstAcquires() {
+		const unsigned int threadCount = 8;
+		MSharedMemoryObject<ProcessSemaphore> semaphore(threadCount);
+
+		for (unsigned int round = 0; round < 10; ++round) {
+			const int pid = Concurrent::Fork::performFork(
+				[&semaphore, threadCount] () {
+					std::atomic<bool> start { false };
+					std::vector<std::thread> threads;
+
+					for (unsigned int m = 0; m < threadCount; ++m) {
+						threads.emplace_back([&semaphore, &start] () {
+							while (!start.load()) {
+								// Spin until all threads have started.
+							}
+
+							for (unsigned int n = 0; n < 100; ++n) {
+								semaphore->acquire();
+								semaphore->release();
+							}
+						});
+					}
+
+					start.store(true);
+
+					for (auto & thread : threads) {
+						thread.join();
+					}
+
+					return 0;
+				}
+				, true
+			);
+
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+			AssertThat(semaphore->getCount(), is(threadCount));
+		}
+
+		// Take all permits, then wait long enough for the dead child to be recovered.
+		for (unsigned int m = 0; m < threadCount; ++m) {
+			AssertThat(semaphore->tryDecrement(), is(true));
+		}
+
+		AssertThat(semaphore->tryDecrement(std::chrono::milliseconds(300)), is(false));
+		AssertThat(semaphore->getCount(), is(0U));
+	}
+
+	//
+	// A child process repeatedly acquires and releases permits and is killed at an
+	// arbitrary point, possibly part way through an acquire or release. All permits
+	// must be recoverable.
+	//
+	void killedDuringAcquireAndRelease() {
+		const unsigned int permits = 4;
+		MSharedMemoryObject<ProcessSemaphore> semaphore(permits);
+
+		for (unsigned int round = 0; round < 5; ++round) {
+			const int pid = Concurrent::Fork::performFork(
+				[&semaphore] () {
+					while (true) {
+						semaphore->acquire();
+						semaphore->acquire();
+						semaphore->release();
+						semaphore->release();
+					}
+
+					return 0;
+				}
+				, true
+			);
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20 + round * 7));
+			kill(pid, SIGKILL);
+			Concurrent::Fork::waitOnProcess(pid);
+
+			for (unsigned int m = 0; m < permits; ++m) {
+				AssertThat(semaphore->tryAcquire(std::chrono::milliseconds(2000)), is(true));
+			}
+
+			AssertThat(semaphore->getCount(), is(0U));
+
+			for (unsigned int m = 0; m < permits; ++m) {
+				semaphore->release();
+			}
+
+			AssertThat(semaphore->getCount(), is(permits));
+		}
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
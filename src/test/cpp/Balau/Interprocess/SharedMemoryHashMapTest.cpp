@@ -0,0 +1,290 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/SharedMemoryHashMap.hpp>
+#include <Balau/Interprocess/SharedMemoryObjectPool.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Interprocess {
+
+struct SharedMemoryHashMapTest : public Testing::TestGroup<SharedMemoryHashMapTest> {
+	SharedMemoryHashMapTest() {
+		RegisterTestCase(singleProcess);
+		RegisterTestCase(full);
+		RegisterTestCase(openByName);
+		RegisterTestCase(readAcrossProcesses);
+		RegisterTestCase(concurrentWriters);
+		RegisterTestCase(pooledValues);
+	}
+
+	// Trivially copyable test value.
+	struct Point {
+		long x;
+		long y;
+		long z;
+	};
+
+	using Segment = boost::interprocess::managed_shared_memory;
+
+	void singleProcess() {
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryHashMap<int, Point>::requiredSize(1000) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryHashMap<int, Point> map(CreateOnlySelector(), segment, "points", 1000);
+
+		AssertThat(map.getCapacity(), is((size_t) 1024));
+		AssertThat(map.size(), is((size_t) 0));
+		AssertThat(map.contains(1), is(false));
+
+		for (int m = 0; m < 500; ++m) {
+			AssertThat(map.insert(m, { m, m * 2, m * 3 }), is(true));
+		}
+
+		AssertThat(map.size(), is((size_t) 500));
+		AssertThat(map.insert(7, { 0, 0, 0 }), is(false));
+
+		Point point {};
+		AssertThat(map.get(7, point), is(true));
+		AssertThat(point.z, is(21L));
+
+		AssertThat(map.put(7, { 1, 2, 3 }), is(false));
+		AssertThat(map.get(7, point), is(true));
+		AssertThat(point.z, is(3L));
+
+		for (int m = 0; m < 500; m += 2) {
+			AssertThat(map.erase(m), is(true));
+		}
+
+		AssertThat(map.erase(0), is(false));
+		AssertThat(map.size(), is((size_t) 250));
+		AssertThat(map.contains(2), is(false));
+		AssertThat(map.contains(3), is(true));
+
+		long sum = 0;
+		map.forEach([&sum] (const int & key, const Point & value) { sum += value.x; });
+		AssertThat(sum, is(250L * 250L));
+
+		// Deleted buckets are reused.
+		AssertThat(map.put(2, { 5, 5, 5 }), is(true));
+		AssertThat(map.get(2, point), is(true));
+		AssertThat(point.x, is(5L));
+	}
+
+	void full() {
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryHashMap<int, int>::requiredSize(4) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryHashMap<int, int> map(CreateOnlySelector(), segment, "small", 4);
+
+		for (int m = 0; m < 4; ++m) {
+			map.put(m, m);
+		}
+
+		AssertThat([&map] () { map.put(4, 4); }, throws<Exception::SizeException>());
+		int value = 0;
+		AssertThat(map.get(4, value), is(false));
+
+		map.erase(1);
+		AssertThat(map.put(4, 4), is(true));
+	}
+
+	void openByName() {
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), 2 * SharedMemoryHashMap<int, int>::requiredSize(16) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryHashMap<int, int> creator(CreateOnlySelector(), segment, "map", 16);
+		SharedMemoryHashMap<int, int> user(OpenOnlySelector(), segment, "map");
+		SharedMemoryHashMap<int, int> peer(OpenOrCreateSelector(), segment, "map", 128);
+
+		AssertThat(peer.getCapacity(), is((size_t) 16));
+
+		creator.put(1, 42);
+		int value = 0;
+		AssertThat(user.get(1, value), is(true));
+		AssertThat(value, is(42));
+
+		AssertThat(
+			  [&segment] () { SharedMemoryHashMap<int, int> m(CreateOnlySelector(), segment, "map", 16); }
+			, throws<Exception::SharedMemoryObjectException>()
+		);
+
+		AssertThat(
+			  [&segment] () { SharedMemoryHashMap<int, int> m(OpenOnlySelector(), segment, "other"); }
+			, throws<Exception::SharedMemoryObjectException>()
+		);
+	}
+
+	//
+	// The child maps the segment again, at a different address to the parent's mapping.
+	//
+	void readAcrossProcesses() {
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		const int entryCount = 10000;
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryHashMap<int, Point>::requiredSize(2 * entryCount) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryHashMap<int, Point> map(CreateOnlySelector(), segment, "warm", 2 * entryCount);
+
+		for (int m = 0; m < entryCount; ++m) {
+			map.put(m, { m, -m, m });
+		}
+
+		const int pid = Concurrent::Fork::performFork(
+			[&name, entryCount] () {
+				Segment childSegment(boost::interprocess::open_only, name.c_str());
+				SharedMemoryHashMap<int, Point> childMap(OpenOnlySelector(), childSegment, "warm");
+				Point point {};
+
+				for (int m = 0; m < entryCount; ++m) {
+					if (!childMap.get(m, point) || point.y != -m) {
+						return 1;
+					}
+				}
+
+				return childMap.contains(entryCount) ? 1 : 0;
+			}
+			, true
+		);
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat("Child process read incorrect values.", report.exitStatus, is(0));
+	}
+
+	//
+	// Child processes write overlapping keys whilst the parent reads. Each value
+	// has x == z, thus a torn read would be detected.
+	//
+	void concurrentWriters() {
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		const int keyCount = 1000;
+		const int writerCount = 4;
+		const int iterations = 20;
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryHashMap<int, Point>::requiredSize(2 * keyCount) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryHashMap<int, Point> map(CreateOnlySelector(), segment, "shared", 2 * keyCount);
+		std::vector<int> pids;
+
+		for (int writer = 0; writer < writerCount; ++writer) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&name, writer, keyCount, iterations] () {
+						Segment childSegment(boost::interprocess::open_only, name.c_str());
+						SharedMemoryHashMap<int, Point> childMap(OpenOnlySelector(), childSegment, "shared");
+
+						for (int iteration = 0; iteration < iterations; ++iteration) {
+							for (int key = 0; key < keyCount; ++key) {
+								const long stamp = writer * iterations + iteration;
+
+								if (key % 5 == writer) {
+									childMap.erase(key);
+								} else {
+									childMap.put(key, { stamp, key, stamp });
+								}
+							}
+						}
+
+						return 0;
+					}
+					, true
+				)
+			);
+		}
+
+		bool torn = false;
+
+		for (int iteration = 0; iteration < 50; ++iteration) {
+			map.forEach([&torn] (const int & key, const Point & value) {
+				torn = torn || value.x != value.z || value.y != key;
+			});
+		}
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		}
+
+		AssertThat(torn, is(false));
+
+		size_t present = 0;
+		map.forEach([&present] (const int &, const Point &) { ++present; });
+		AssertThat(map.size(), is(present));
+		AssertThat(map.size() <= (size_t) keyCount, is(true));
+	}
+
+	//
+	// A map and an object pool in one segment, with the map values being pool handles.
+	//
+	void pooledValues() {
+		using Pool = SharedMemoryObjectPool<Point>;
+		using Map = SharedMemoryHashMap<int, Pool::Handle>;
+
+		const std::string name = "SMHM_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), Map::requiredSize(256) + Pool::requiredSize(256) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		Pool pool(CreateOnlySelector(), segment, "pool", 256);
+		Map map(CreateOnlySelector(), segment, "index", 256);
+
+		for (int m = 0; m < 200; ++m) {
+			map.put(m, pool.create(Point { m, m, m }));
+		}
+
+		const int pid = Concurrent::Fork::performFork(
+			[&name] () {
+				Segment childSegment(boost::interprocess::open_only, name.c_str());
+				const Pool childPool(OpenOnlySelector(), childSegment, "pool");
+				const Map childMap(OpenOnlySelector(), childSegment, "index");
+				Pool::Handle handle = Pool::NullHandle;
+
+				for (int m = 0; m < 200; ++m) {
+					if (!childMap.get(m, handle) || childPool[handle].y != m) {
+						return 1;
+					}
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat("Child process read incorrect values.", report.exitStatus, is(0));
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
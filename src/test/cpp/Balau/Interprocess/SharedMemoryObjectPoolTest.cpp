@@ -0,0 +1,165 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/SharedMemoryObjectPool.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Interprocess {
+
+struct SharedMemoryObjectPoolTest : public Testing::TestGroup<SharedMemoryObjectPoolTest> {
+	SharedMemoryObjectPoolTest() {
+		RegisterTestCase(createAndDestroy);
+		RegisterTestCase(exhausted);
+		RegisterTestCase(concurrentAllocation);
+	}
+
+	struct Record {
+		Record(unsigned int id_, double weight_) : id(id_), weight(weight_) {}
+
+		unsigned int id;
+		double weight;
+		char label[20] {};
+	};
+
+	using Segment = boost::interprocess::managed_shared_memory;
+
+	void createAndDestroy() {
+		const std::string name = "SMOP_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryObjectPool<Record>::requiredSize(100) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryObjectPool<Record> pool(CreateOnlySelector(), segment, "records", 100);
+
+		AssertThat(pool.getCapacity(), is((size_t) 100));
+		AssertThat(pool.size(), is((size_t) 0));
+
+		const auto first = pool.create(1U, 1.5);
+		const auto second = pool.create(2U, 2.5);
+
+		AssertThat(first != second, is(true));
+		AssertThat(pool.size(), is((size_t) 2));
+		AssertThat(pool[first].id, is(1U));
+		AssertThat(pool.get(second).weight, is(2.5));
+
+		pool.destroy(first);
+		AssertThat(pool.size(), is((size_t) 1));
+
+		// The released slot is reused.
+		const auto third = pool.create(3U, 3.5);
+		AssertThat(third, is(first));
+		AssertThat(pool[third].id, is(3U));
+
+		SharedMemoryObjectPool<Record> user(OpenOnlySelector(), segment, "records");
+		AssertThat(user[second].id, is(2U));
+
+		AssertThat(
+			  [&segment] () { SharedMemoryObjectPool<Record> p(CreateOnlySelector(), segment, "records", 10); }
+			, throws<Exception::SharedMemoryObjectException>()
+		);
+	}
+
+	void exhausted() {
+		const std::string name = "SMOP_" + SharedMemoryUtils::namePrefixFromUUID();
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryObjectPool<Record>::requiredSize(3) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		AssertThat(
+			  [&segment] () { SharedMemoryObjectPool<Record> p(CreateOnlySelector(), segment, "empty", 0); }
+			, throws<Exception::SizeException>()
+		);
+
+		SharedMemoryObjectPool<Record> pool(CreateOnlySelector(), segment, "records", 3);
+
+		for (unsigned int m = 0; m < 3; ++m) {
+			pool.create(m, 0.0);
+		}
+
+		AssertThat([&pool] () { pool.create(3U, 0.0); }, throws<Exception::SizeException>());
+		AssertThat(pool.size(), is((size_t) 3));
+	}
+
+	//
+	// Processes concurrently create and destroy objects. Each process verifies
+	// that no other process obtained the same slot whilst the process held it.
+	//
+	void concurrentAllocation() {
+		const std::string name = "SMOP_" + SharedMemoryUtils::namePrefixFromUUID();
+		const unsigned int processCount = 4;
+		const unsigned int iterations = 20000;
+		Segment segment(boost::interprocess::create_only, name.c_str(), SharedMemoryObjectPool<Record>::requiredSize(64) + 4096);
+		OnScopeExit removeSegment([&name] () { boost::interprocess::shared_memory_object::remove(name.c_str()); });
+
+		SharedMemoryObjectPool<Record> pool(CreateOnlySelector(), segment, "records", 64);
+		std::vector<int> pids;
+
+		for (unsigned int process = 0; process < processCount; ++process) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&name, process, iterations] () {
+						Segment childSegment(boost::interprocess::open_only, name.c_str());
+						SharedMemoryObjectPool<Record> childPool(OpenOnlySelector(), childSegment, "records");
+
+						for (unsigned int m = 0; m < iterations; ++m) {
+							const auto first = childPool.create(process, (double) m);
+							const auto second = childPool.create(process, (double) m);
+
+							if (childPool[first].id != process || childPool[second].weight != (double) m) {
+								return 1;
+							}
+
+							childPool.destroy(first);
+							childPool.destroy(second);
+						}
+
+						return 0;
+					}
+					, true
+				)
+			);
+		}
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+			AssertThat("Child process saw a shared slot.", report.exitStatus, is(0));
+		}
+
+		AssertThat(pool.size(), is((size_t) 0));
+
+		// All slots are available again.
+		for (unsigned int m = 0; m < 64; ++m) {
+			pool.create(m, 0.0);
+		}
+
+		AssertThat(pool.size(), is((size_t) 64));
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
@@ -20,6 +20,8 @@
 #include <Balau/Type/ToString.hpp>
 #include <Balau/Serialization/SerializationMacros.hpp>
 
+#include <boost/serialization/vector.hpp>
+
 #include <array>
 
 namespace Balau::Interprocess {
@@ -50,6 +52,32 @@ inline bool operator != (const SMT & lhs, const SMT & rhs) {
 	return lhs.d != rhs.d || lhs.i != rhs.i;
 }
 
+// Test object that is larger than the queue buffer.
+struct LargeMessage {
+	size_t id;
+	std::vector<char> payload;
+
+	LargeMessage() : id(0) {}
+
+	LargeMessage(size_t id_, size_t size) : id(id_), payload(size) {
+		for (size_t m = 0; m < size; ++m) {
+			payload[m] = (char) (m * 31 + id);
+		}
+	}
+
+	template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+		archive & BoostSerialization(id) & BoostSerialization(payload);
+	}
+};
+
+inline std::string toString(const LargeMessage & object) {
+	return "{ " + ::toString(object.id) + ", " + ::toString(object.payload.size()) + " bytes }";
+}
+
+inline bool operator == (const LargeMessage & lhs, const LargeMessage & rhs) {
+	return lhs.id == rhs.id && lhs.payload == rhs.payload;
+}
+
 } // namespace Balau::Interprocess
 
 #include <TestResources.hpp>
@@ -69,6 +97,7 @@ using namespace Balau::Concurrent;
 namespace Balau {
 
 using Testing::is;
+using Testing::throws;
 
 namespace Interprocess {
 
@@ -82,7 +111,16 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 		RegisterTestCase(multipleBufferSPST);
 		RegisterTestCase(multipleBufferSISO);
 		RegisterTestCase(multipleBufferMISO);
-		RegisterTestCase(multipleBufferPending);
+		RegisterTestCase(multipleBufferMIMO);
+		RegisterTestCase(largeMessages);
+		RegisterTestCase(largeMessageTryEnqueue);
+		RegisterTestCase(largeMessageGrowsArena);
+		RegisterTestCase(batchSPST);
+		RegisterTestCase(batchOversize);
+		RegisterTestCase(batchSISO);
+		RegisterTestCase(batchLeftoversShared);
+		RegisterTestCase(batchLeftoversWakeBlockedConsumer);
+		RegisterTestCase(batchLeftoversOwnerDeath);
 	}
 
 	// Shared between the child processes in the tests.
@@ -325,7 +363,7 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 		runMISO(*this, queue);
 	}
 
-	void singleBufferMIMO() {
+	static void runMIMO(SharedMemoryQueueTest & self, SharedMemoryQueue<SMT> & queue) {
 		const SMT noDequeue = { 0.0, 0 };
 		const SMT expected = { 42.0, 34 };
 		const unsigned int messageCount = 1000;
@@ -336,7 +374,6 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 		std::vector<int> enqueueingPids;
 
 		USharedMemoryObject<SharedTestState<dequeueingChildProcessCount>> sharedTestState;
-		SharedMemoryQueue<SMT> queue(messageCount);
 
 		for (size_t childProcessIndex = 0; childProcessIndex < dequeueingChildProcessCount; childProcessIndex++) {
 			dequeueingPids.push_back(
@@ -423,12 +460,12 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 			const char * reportText = sharedTestState->reports[m].data();
 
 			if (reportText[0] != 0) {
-				logLine("Dequeueing pid ", dequeueingPids[m], " failed: ", reportText[0]);
+				self.logLine("Dequeueing pid ", dequeueingPids[m], " failed: ", reportText[0]);
 				failed = true;
 			}
 
 			if (dequeueingTerminationReports[m].code != CLD_EXITED) {
-				logLine(
+				self.logLine(
 					  "Dequeueing pid "
 					, dequeueingPids[m]
 					, " did not exit correctly: "
@@ -443,12 +480,12 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 			const char * reportText = sharedTestState->reports[m].data();
 
 			if (reportText[0] != 0) {
-				logLine("Enqueueing pid ", enqueueingPids[m], " failed: ", reportText[0]);
+				self.logLine("Enqueueing pid ", enqueueingPids[m], " failed: ", reportText[0]);
 				failed = true;
 			}
 
 			if (enqueueingTerminationReports[m].code != CLD_EXITED) {
-				logLine(
+				self.logLine(
 					  "Enqueueing pid "
 					, enqueueingPids[m]
 					, " did not exit correctly: "
@@ -464,6 +501,11 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 		}
 	}
 
+	void singleBufferMIMO() {
+		SharedMemoryQueue<SMT> queue(1000);
+		runMIMO(*this, queue);
+	}
+
 	void multipleBufferSPST() {
 		SharedMemoryQueue<SMT> queue(100, (unsigned int) (sizeof(SMT) / 4));
 		runSPST(queue);
@@ -480,79 +522,253 @@ struct SharedMemoryQueueTest : public Testing::TestGroup<SharedMemoryQueueTest>
 		runMISO(*this, queue);
 	}
 
-	void multipleBufferPending() {
-		//
-		// Testing of the pending buffer with a re-queued multi-chunk marshal buffer.
-		// This is achieved by:
-		//  - setting up the underlying shared memory queue directly;
-		//  - calling tryDequeue();
-		//  - appending the last chunk to to underlying shared memory queue directly;
-		//  - calling dequeue().
-		//
-		// The steps are performed in a single thread.
-		// In order to manipulate the underlying shared memory queue directly, this
-		// test class is a friend of the SharedMemoryQueue class.
-		//
-		// The code is adapted from the enqueue method of the implementation.
-		//
+	void multipleBufferMIMO() {
+		SharedMemoryQueue<SMT> queue(1000, (unsigned int) (sizeof(SMT) / 4));
+		runMIMO(*this, queue);
+	}
 
-		SharedMemoryQueue<SMT> queue(100, (unsigned int) (sizeof(SMT) / 4));
+	void largeMessages() {
+		const size_t messageCount = 20;
+		SharedMemoryQueue<LargeMessage> queue(4, 256U);
 
-		std::vector<std::vector<char>> chunkBuffers;
-
-		const Impl::QueueHeader messageHeader { queue.queueState->sequenceNumber++, 1, 0, 0 };
-		std::vector<char> marshalBuffer;
-		marshalBuffer.clear();
-		queue.marshal(marshalBuffer, SMT { 42.0, 34 }, messageHeader);
-		const unsigned int totalBytes = (unsigned int) marshalBuffer.size() - SharedMemoryQueue<SMT>::HeaderSize;
-		auto * marshalHeader = (Impl::QueueHeader *) marshalBuffer.data();
-		marshalHeader->totalBytes = totalBytes;
-		const unsigned int chunkCount = queue.calculateChunkCount(totalBytes);
-		size_t dataStart = SharedMemoryQueue<SMT>::HeaderSize;
-
-		// Build the chunks.
-		for (unsigned int m = 0; m < chunkCount; m++) {
-			size_t chunkStart = dataStart - SharedMemoryQueue<SMT>::HeaderSize;
-			auto & chunkHeader = * (Impl::QueueHeader *) (marshalBuffer.data() + chunkStart);
-			chunkHeader.sequenceNumber = messageHeader.sequenceNumber;
-			chunkHeader.chunkCount = chunkCount;
-			chunkHeader.chunkNumber = m;
-			chunkHeader.totalBytes = totalBytes;
-
-			const size_t chunkBytes = m < chunkCount - 1
-				? queue.chunkSize
-				: marshalBuffer.size() - chunkStart;
-
-			chunkBuffers.emplace_back(marshalBuffer.data() + chunkStart, marshalBuffer.data() + chunkStart + chunkBytes);
-			dataStart += queue.chunkSize - SharedMemoryQueue<SMT>::HeaderSize;
+		const int pid = Fork::performFork(
+			[&] () {
+				for (size_t m = 0; m < messageCount; ++m) {
+					queue.enqueue(LargeMessage(m, 1024 * 1024 + m * 4096));
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		for (size_t m = 0; m < messageCount; ++m) {
+			const LargeMessage actual = queue.dequeue();
+
+			AssertThat(actual, is(LargeMessage(m, 1024 * 1024 + m * 4096)));
 		}
 
-		// Send all but the last chunk
-		for (unsigned int m = 0; m < chunkBuffers.size() - 1; m++) {
-			queue.queue.send(chunkBuffers[m].data(), chunkBuffers[m].size(), 0);
+		Fork::TerminationReport report = Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+
+		// All blobs have been returned to the arena.
+		AssertThat(queue.blobArena(0).allocatedBlockCount(), is((size_t) 0));
+	}
+
+	void largeMessageTryEnqueue() {
+		SharedMemoryQueue<LargeMessage> queue(1, 256U);
+
+		AssertThat(queue.tryEnqueue(LargeMessage(1, 100000)), is(true));
+
+		// The queue is full, thus the blob must be returned to the arena.
+		AssertThat(queue.tryEnqueue(LargeMessage(2, 100000), std::chrono::milliseconds(10)), is(false));
+		AssertThat(queue.blobArena(0).allocatedBlockCount(), is((size_t) 1));
+
+		AssertThat(queue.dequeue(), is(LargeMessage(1, 100000)));
+		AssertThat(queue.blobArena(0).allocatedBlockCount(), is((size_t) 0));
+
+		SharedMemoryQueue<LargeMessage> throwingQueue(1, 256U, true);
+
+		AssertThat(
+			  [&throwingQueue] () { throwingQueue.tryEnqueue(LargeMessage(1, 100000)); }
+			, throws<Exception::SizeException>()
+		);
+	}
+
+	void largeMessageGrowsArena() {
+		SharedMemoryQueue<LargeMessage> queue(4, 256U);
+
+		// Creates the arena with the default size.
+		queue.enqueue(LargeMessage(1, 100000));
+
+		AssertThat(queue.blobArena(0).segmentCount(), is(1U));
+
+		// Too large for the first segment, thus a second segment is chained.
+		const size_t hugeSize = SharedMemoryQueue<LargeMessage>::DefaultBlobArenaSize / 2 + 1;
+		queue.enqueue(LargeMessage(2, hugeSize));
+
+		AssertThat(queue.blobArena(0).segmentCount(), is(2U));
+
+		const int pid = Fork::performFork(
+			[&] () {
+				// The second segment is mapped by the child on first use.
+				const bool success = queue.dequeue() == LargeMessage(1, 100000) && queue.dequeue() == LargeMessage(2, hugeSize);
+				return success ? 0 : 1;
+			}
+			, true
+		);
+
+		Fork::TerminationReport report = Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat(report.exitStatus, is(0));
+		AssertThat(queue.blobArena(0).allocatedBlockCount(), is((size_t) 0));
+	}
+
+	static std::vector<SMT> createObjects(int first, int count) {
+		std::vector<SMT> objects;
+
+		for (int m = first; m < first + count; ++m) {
+			objects.emplace_back(m * 0.5, m);
 		}
 
-		// Send another object via the API.
-		queue.enqueue(SMT { 123.4, 12 });
+		return objects;
+	}
+
+	void batchSPST() {
+		SharedMemoryQueue<SMT> queue(100, 1024U);
+		const auto objects = createObjects(0, 50);
 
-		// Try to dequeue the incomplete object. This should result in the incomplete
-		// object's marshal buffer being re-queued on the internal process local queue.
-		SMT object = queue.tryDequeue();
+		queue.enqueueAll(objects);
 
-		AssertThat(object, is(SMT {}));
+		// The objects are packed into fewer buffers than objects.
+		AssertThat(queue.queue.get_num_msg() < objects.size(), is(true));
 
-		// Send the last chunk.
-		queue.queue.send(chunkBuffers[chunkBuffers.size() - 1].data(), chunkBuffers[chunkBuffers.size() - 1].size(), 0);
+		std::vector<SMT> actual;
 
-		// Try to dequeue again. This should result in the object being returned.
-		SMT object2 = queue.tryDequeue();
+		AssertThat(queue.dequeueUpTo(20, std::back_inserter(actual), std::chrono::milliseconds(0)), is((size_t) 20));
+		AssertThat(queue.dequeue(), is(objects[20]));
+		AssertThat(queue.dequeueUpTo(100, std::back_inserter(actual), std::chrono::milliseconds(0)), is((size_t) 29));
+		AssertThat(queue.empty(), is(true));
+		AssertThat(queue.dequeueUpTo(100, std::back_inserter(actual), std::chrono::milliseconds(10)), is((size_t) 0));
 
-		AssertThat(object2, is(SMT { 42.0, 34 }));
+		actual.insert(actual.begin() + 20, objects[20]);
+
+		AssertThat(actual, is(objects));
+	}
+
+	void batchOversize() {
+		SharedMemoryQueue<SMT> queue(100, (unsigned int) (sizeof(SMT) / 4));
+		const auto objects = createObjects(1, 5);
+
+		queue.enqueueAll(objects);
+
+		std::vector<SMT> actual;
+
+		AssertThat(queue.dequeueUpTo(10, std::back_inserter(actual), std::chrono::milliseconds(1000)), is((size_t) 5));
+		AssertThat(actual, is(objects));
+	}
+
+	void batchSISO() {
+		const int messageCount = 10000;
+		const int batchSize = 100;
+		SharedMemoryQueue<SMT> queue(10, 1024U);
+
+		const int pid = Fork::performFork(
+			[&] () {
+				for (int m = 0; m < messageCount; m += batchSize) {
+					queue.enqueueAll(createObjects(m, batchSize));
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		std::vector<SMT> actual;
+		const auto timeout = std::chrono::nanoseconds(1000000000LL * 30LL); // 30 seconds (allow for Valgrind delays)
+		const auto startTime = System::SystemClock().nanotime();
+
+		while (actual.size() < (size_t) messageCount && System::SystemClock().nanotime() - startTime < timeout) {
+			queue.dequeueUpTo(batchSize, std::back_inserter(actual), std::chrono::milliseconds(10));
+		}
+
+		Fork::TerminationReport report = Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat(actual, is(createObjects(0, messageCount)));
+	}
+
+	void batchLeftoversShared() {
+		SharedMemoryQueue<SMT> queue(100, 4096U);
+		SharedMemoryQueue<SMT> otherInstance(queue.getName());
+		const auto objects = createObjects(0, 50);
+
+		queue.enqueueAll(objects);
+
+		// The objects of the partially dequeued batch are visible to the other instance.
+		AssertThat(queue.dequeue(), is(objects[0]));
+		AssertThat(queue.empty(), is(false));
+		AssertThat(otherInstance.empty(), is(false));
+
+		std::vector<SMT> actual;
+
+		AssertThat(otherInstance.dequeueUpTo(100, std::back_inserter(actual), std::chrono::milliseconds(0)), is((size_t) 49));
+		AssertThat(actual, is(std::vector<SMT>(objects.begin() + 1, objects.end())));
+		AssertThat(queue.empty(), is(true));
+		AssertThat(otherInstance.empty(), is(true));
+	}
+
+	void batchLeftoversWakeBlockedConsumer() {
+		SharedMemoryQueue<SMT> queue(100, 4096U);
+		const auto objects = createObjects(0, 20);
+
+		// The child blocks on the empty queue. Whichever process receives the
+		// batch, the child must obtain the objects not dequeued by the parent.
+		const int pid = Fork::performFork(
+			[&] () {
+				std::vector<SMT> actual;
+				bool success = true;
+
+				while (success && actual.size() < objects.size() - 1) {
+					SMT object = queue.tryDequeue(std::chrono::milliseconds(5000), success);
+
+					if (success) {
+						actual.push_back(object);
+					}
+				}
+
+				if (!success) {
+					return 1;
+				}
+
+				for (size_t m = 1; m < actual.size(); ++m) {
+					if (actual[m].i <= actual[m - 1].i) {
+						return 2;
+					}
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		queue.enqueueAll(objects);
+		queue.dequeue();
+
+		Fork::TerminationReport report = Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat("Child process did not dequeue the leftover objects.", report.exitStatus, is(0));
+		AssertThat(queue.empty(), is(true));
+	}
+
+	void batchLeftoversOwnerDeath() {
+		SharedMemoryQueue<SMT> queue(100, 4096U);
+		const auto objects = createObjects(0, 20);
+
+		queue.enqueueAll(objects);
+		AssertThat(queue.dequeue(), is(objects[0]));
+
+		// The child dies whilst holding the leftover lock.
+		const int pid = Fork::performFork(
+			[&] () {
+				queue.queueState->leftoverMutex.lock();
+				return 0;
+			}
+			, true
+		);
+
+		Fork::TerminationReport report = Fork::waitOnProcess(pid);
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
 
-		// Dequeue again. This should result in second enqueued object being returned.
-		SMT object3 = queue.tryDequeue();
+		std::vector<SMT> actual;
 
-		AssertThat(object3, is(SMT { 123.4, 12 }));
+		AssertThat(queue.dequeueUpTo(100, std::back_inserter(actual), std::chrono::milliseconds(1000)), is((size_t) 19));
+		AssertThat(actual, is(std::vector<SMT>(objects.begin() + 1, objects.end())));
+		AssertThat(queue.empty(), is(true));
 	}
 };
 
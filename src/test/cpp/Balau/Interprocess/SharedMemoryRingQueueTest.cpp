@@ -0,0 +1,325 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/SharedMemoryRingQueue.hpp>
+
+#include <boost/serialization/string.hpp>
+
+#include <cstring>
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Interprocess {
+
+struct SharedMemoryRingQueueTest : public Testing::TestGroup<SharedMemoryRingQueueTest> {
+	SharedMemoryRingQueueTest() {
+		RegisterTestCase(singleProcess);
+		RegisterTestCase(capacity);
+		RegisterTestCase(serialisedType);
+		RegisterTestCase(oversize);
+		RegisterTestCase(openByName);
+		RegisterTestCase(blockingDequeue);
+		RegisterTestCase(spscAcrossProcesses);
+		RegisterTestCase(mpmcAcrossProcesses);
+		RegisterTestCase(reserveAndAcquire);
+		RegisterTestCase(discardedReservation);
+		RegisterTestCase(zeroCopyAcrossProcesses);
+	}
+
+	// Trivially copyable test message.
+	struct Message {
+		unsigned int producer;
+		unsigned int sequence;
+	};
+
+	void singleProcess() {
+		for (auto mode : { SharedMemoryRingQueueMode::SingleProducerSingleConsumer, SharedMemoryRingQueueMode::MultiProducerMultiConsumer }) {
+			SharedMemoryRingQueue<Message> queue(16, mode);
+
+			AssertThat(queue.getMode() == mode, is(true));
+			AssertThat(queue.empty(), is(true));
+
+			bool success = true;
+			queue.tryDequeue(success);
+			AssertThat(success, is(false));
+
+			for (unsigned int m = 0; m < 100; ++m) {
+				queue.enqueue({ 1, m });
+				const Message message = queue.dequeue();
+				AssertThat(message.sequence, is(m));
+			}
+
+			AssertThat(queue.empty(), is(true));
+		}
+	}
+
+	void capacity() {
+		SharedMemoryRingQueue<Message> queue(3);
+
+		AssertThat(queue.getCapacity(), is(4U));
+		AssertThat(queue.getSlotSize(), is((unsigned int) sizeof(Message)));
+
+		for (unsigned int m = 0; m < 4; ++m) {
+			AssertThat(queue.tryEnqueue({ 1, m }), is(true));
+		}
+
+		AssertThat(queue.full(), is(true));
+		AssertThat(queue.tryEnqueue({ 1, 4 }), is(false));
+		AssertThat(queue.tryEnqueue({ 1, 4 }, std::chrono::milliseconds(10)), is(false));
+
+		AssertThat(queue.dequeue().sequence, is(0U));
+		AssertThat(queue.tryEnqueue({ 1, 4 }), is(true));
+
+		for (unsigned int m = 1; m < 5; ++m) {
+			AssertThat(queue.dequeue().sequence, is(m));
+		}
+
+		bool success = true;
+		queue.tryDequeue(std::chrono::milliseconds(10), success);
+		AssertThat(success, is(false));
+	}
+
+	void serialisedType() {
+		SharedMemoryRingQueue<std::string> queue(8, 256);
+
+		queue.enqueue("hello");
+		queue.enqueue(std::string(200, 'x'));
+
+		AssertThat(queue.dequeue(), is("hello"));
+		AssertThat(queue.dequeue(), is(std::string(200, 'x')));
+	}
+
+	void oversize() {
+		SharedMemoryRingQueue<std::string> queue(8, 64);
+
+		AssertThat([&queue] () { queue.enqueue(std::string(100, 'x')); }, throws<Exception::SizeException>());
+		AssertThat([&queue] () { queue.tryEnqueue(std::string(100, 'x')); }, throws<Exception::SizeException>());
+		AssertThat(queue.empty(), is(true));
+
+		AssertThat(
+			[] () { SharedMemoryRingQueue<Message> q(0); }, throws<Exception::SizeException>()
+		);
+	}
+
+	void openByName() {
+		const std::string name = "SMRQ_" + SharedMemoryUtils::namePrefixFromUUID();
+		SharedMemoryRingQueue<Message> creator(16, sizeof(Message), name, SharedMemoryRingQueueMode::SingleProducerSingleConsumer);
+		SharedMemoryRingQueue<Message> user(name);
+
+		AssertThat(user.getCapacity(), is(16U));
+		AssertThat(user.getMode() == SharedMemoryRingQueueMode::SingleProducerSingleConsumer, is(true));
+
+		creator.enqueue({ 3, 42 });
+		AssertThat(user.dequeue().sequence, is(42U));
+
+		SharedMemoryRingQueue<Message> peer(OpenOrCreateSelector(), 128, sizeof(Message), name);
+		AssertThat(peer.getCapacity(), is(16U));
+
+		AssertThat(
+			[] () { SharedMemoryRingQueue<Message> q("SMRQ_does_not_exist"); }, throws<boost::interprocess::interprocess_exception>()
+		);
+	}
+
+	void blockingDequeue() {
+		SharedMemoryRingQueue<Message> queue(4);
+
+		std::thread producer([&queue] () {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			queue.enqueue({ 2, 7 });
+		});
+
+		const Message message = queue.dequeue();
+		producer.join();
+
+		AssertThat(message.sequence, is(7U));
+	}
+
+	void spscAcrossProcesses() {
+		const unsigned int messageCount = 200000;
+		SharedMemoryRingQueue<Message> queue(64, SharedMemoryRingQueueMode::SingleProducerSingleConsumer);
+
+		const int pid = Concurrent::Fork::performFork(
+			[&queue, messageCount] () {
+				for (unsigned int m = 0; m < messageCount; ++m) {
+					if (queue.dequeue().sequence != m) {
+						return 1;
+					}
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		for (unsigned int m = 0; m < messageCount; ++m) {
+			queue.enqueue({ 0, m });
+		}
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat("Child process dequeued out of order.", report.exitStatus, is(0));
+	}
+
+	void mpmcAcrossProcesses() {
+		const unsigned int messageCount = 50000;
+		const unsigned int producerCount = 4;
+		SharedMemoryRingQueue<Message> queue(64);
+		std::vector<int> pids;
+
+		for (unsigned int producer = 0; producer < producerCount; ++producer) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&queue, producer, messageCount] () {
+						for (unsigned int m = 0; m < messageCount; ++m) {
+							queue.enqueue({ producer, m });
+						}
+
+						return 0;
+					}
+					, true
+				)
+			);
+		}
+
+		// Consume with two threads, each verifying per-producer ordering.
+		std::atomic<unsigned int> consumed { 0 };
+		std::atomic<bool> failed { false };
+
+		auto consume = [&] () {
+			std::vector<int> last(producerCount, -1);
+
+			while (consumed < producerCount * messageCount && !failed) {
+				bool success;
+				const Message message = queue.tryDequeue(std::chrono::milliseconds(100), success);
+
+				if (!success) {
+					continue;
+				}
+
+				if (message.producer >= producerCount || (int) message.sequence <= last[message.producer]) {
+					failed = true;
+				} else {
+					last[message.producer] = (int) message.sequence;
+					++consumed;
+				}
+			}
+		};
+
+		std::thread consumer1(consume);
+		std::thread consumer2(consume);
+		consumer1.join();
+		consumer2.join();
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		}
+
+		AssertThat(failed.load(), is(false));
+		AssertThat(consumed.load(), is(producerCount * messageCount));
+		AssertThat(queue.empty(), is(true));
+	}
+
+	void reserveAndAcquire() {
+		SharedMemoryRingQueue<Message> queue(4, 64);
+
+		auto reservation = queue.reserve(16);
+		AssertThat(reservation.size(), is((size_t) 16));
+		std::memcpy(reservation.data(), "zero-copy", 9);
+		reservation.commit(9);
+		AssertThat(static_cast<bool>(reservation), is(false));
+
+		queue.emplace(Message { 5, 6 });
+
+		auto view = queue.acquire();
+		AssertThat(std::string(view.data(), view.size()), is("zero-copy"));
+		view.release();
+
+		auto objectView = queue.tryAcquire();
+		AssertThat(static_cast<bool>(objectView), is(true));
+		AssertThat(objectView.object().producer, is(5U));
+		AssertThat(objectView.object().sequence, is(6U));
+		objectView.release();
+
+		AssertThat(static_cast<bool>(queue.tryAcquire(std::chrono::milliseconds(10))), is(false));
+		AssertThat([&queue] () { queue.reserve(65); }, throws<Exception::SizeException>());
+	}
+
+	void discardedReservation() {
+		SharedMemoryRingQueue<Message> queue(4);
+
+		{
+			auto reservation = queue.reserve(sizeof(Message));
+		}
+
+		auto reservation = queue.tryReserve(sizeof(Message));
+		reservation.discard();
+
+		queue.enqueue({ 1, 99 });
+
+		// Consumers skip the discarded slots.
+		AssertThat(queue.dequeue().sequence, is(99U));
+		AssertThat(queue.empty(), is(true));
+
+		// The discarded slots have been returned to the producers.
+		for (unsigned int m = 0; m < 4; ++m) {
+			AssertThat(queue.tryEnqueue({ 1, m }), is(true));
+		}
+	}
+
+	void zeroCopyAcrossProcesses() {
+		const unsigned int messageCount = 200000;
+		SharedMemoryRingQueue<Message> queue(64, SharedMemoryRingQueueMode::SingleProducerSingleConsumer);
+
+		const int pid = Concurrent::Fork::performFork(
+			[&queue, messageCount] () {
+				for (unsigned int m = 0; m < messageCount; ++m) {
+					auto view = queue.acquire();
+
+					if (view.object().sequence != m) {
+						return 1;
+					}
+				}
+
+				return 0;
+			}
+			, true
+		);
+
+		for (unsigned int m = 0; m < messageCount; ++m) {
+			queue.emplace(Message { 0, m });
+		}
+
+		const auto report = Concurrent::Fork::waitOnProcess(pid);
+
+		AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+		AssertThat("Child process dequeued out of order.", report.exitStatus, is(0));
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
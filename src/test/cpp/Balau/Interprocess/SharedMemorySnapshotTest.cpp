@@ -0,0 +1,173 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2008 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Concurrent/Fork.hpp>
+#include <Balau/Interprocess/SharedMemorySnapshot.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Interprocess {
+
+struct SharedMemorySnapshotTest : public Testing::TestGroup<SharedMemorySnapshotTest> {
+	SharedMemorySnapshotTest() {
+		RegisterTestCase(singleProcess);
+		RegisterTestCase(openByName);
+		RegisterTestCase(readAcrossThreads);
+		RegisterTestCase(readAcrossProcesses);
+	}
+
+	// All fields of a published value are equal, thus a torn read would be detected.
+	struct Limits {
+		uint64_t fields[16];
+
+		explicit Limits(uint64_t value = 0) {
+			std::fill(std::begin(fields), std::end(fields), value);
+		}
+
+		bool consistent() const {
+			return std::all_of(std::begin(fields), std::end(fields), [this] (uint64_t f) { return f == fields[0]; });
+		}
+	};
+
+	void singleProcess() {
+		SharedMemorySnapshot<Limits> snapshot(7);
+
+		AssertThat(snapshot.getVersion(), is((uint64_t) 0));
+		AssertThat(snapshot.read().fields[3], is((uint64_t) 7));
+
+		AssertThat(snapshot.publish(Limits(8)), is((uint64_t) 1));
+		AssertThat(snapshot.publish(Limits(9)), is((uint64_t) 2));
+
+		Limits limits;
+		AssertThat(snapshot.read(limits), is((uint64_t) 2));
+		AssertThat(limits.fields[15], is((uint64_t) 9));
+
+		AssertThat(snapshot.update([] (Limits & l) { l.fields[0] = 100; }), is((uint64_t) 3));
+		AssertThat(snapshot.read().fields[0], is((uint64_t) 100));
+		AssertThat(snapshot.read().fields[1], is((uint64_t) 9));
+
+		uint64_t version = 3;
+		AssertThat(snapshot.readIfChanged(limits, version), is(false));
+
+		snapshot.publish(Limits(10));
+		AssertThat(snapshot.readIfChanged(limits, version), is(true));
+		AssertThat(version, is((uint64_t) 4));
+		AssertThat(limits.fields[0], is((uint64_t) 10));
+	}
+
+	void openByName() {
+		const std::string name = "SMS_" + SharedMemoryUtils::namePrefixFromUUID();
+		SharedMemorySnapshot<Limits> writer(CreateOnlySelector(), name, 1);
+		SharedMemorySnapshot<Limits> reader(OpenOnlySelector(), name);
+		SharedMemorySnapshot<Limits> peer(OpenOrCreateSelector(), name, 2);
+
+		AssertThat(peer.read().fields[0], is((uint64_t) 1));
+
+		writer.publish(Limits(5));
+		AssertThat(reader.getVersion(), is((uint64_t) 1));
+		AssertThat(reader.read().fields[0], is((uint64_t) 5));
+
+		boost::interprocess::shared_memory_object::remove((name + "_memory").c_str());
+	}
+
+	void readAcrossThreads() {
+		const uint64_t publications = 200000;
+		SharedMemorySnapshot<Limits> snapshot;
+		std::atomic<bool> failed { false };
+
+		auto read = [&] () {
+			uint64_t last = 0;
+			Limits limits;
+
+			while (last < publications) {
+				const uint64_t version = snapshot.read(limits);
+
+				if (version < last || !limits.consistent() || limits.fields[0] != version) {
+					failed = true;
+					return;
+				}
+
+				last = version;
+			}
+		};
+
+		std::thread reader1(read);
+		std::thread reader2(read);
+
+		for (uint64_t m = 1; m <= publications; ++m) {
+			snapshot.publish(Limits(m));
+		}
+
+		reader1.join();
+		reader2.join();
+
+		AssertThat(failed.load(), is(false));
+	}
+
+	void readAcrossProcesses() {
+		const uint64_t publications = 200000;
+		SharedMemorySnapshot<Limits> snapshot;
+		std::vector<int> pids;
+
+		for (int reader = 0; reader < 2; ++reader) {
+			pids.push_back(
+				Concurrent::Fork::performFork(
+					[&snapshot, publications] () {
+						uint64_t last = 0;
+						Limits limits;
+
+						while (last < publications) {
+							const uint64_t version = snapshot.read(limits);
+
+							if (version < last || !limits.consistent() || limits.fields[0] != version) {
+								return 1;
+							}
+
+							last = version;
+						}
+
+						return 0;
+					}
+					, true
+				)
+			);
+		}
+
+		for (uint64_t m = 1; m <= publications; ++m) {
+			snapshot.publish(Limits(m));
+		}
+
+		for (int pid : pids) {
+			const auto report = Concurrent::Fork::waitOnProcess(pid);
+			AssertThat("Child process did not exit correctly.", report.code, is((int) CLD_EXITED));
+			AssertThat("Child process read an inconsistent value.", report.exitStatus, is(0));
+		}
+	}
+};
+
+} // namespace Interprocess
+
+} // namespace Balau
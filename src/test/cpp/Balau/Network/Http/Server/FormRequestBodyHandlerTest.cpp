@@ -0,0 +1,169 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/FormRequestBodyHandler.hpp>
+#include <Balau/Util/Files.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network::Http {
+
+struct FormRequestBodyHandlerTest : public Testing::TestGroup<FormRequestBodyHandlerTest> {
+	FormRequestBodyHandlerTest() {
+		RegisterTestCase(urlEncodedForm);
+		RegisterTestCase(multipartFormWithUpload);
+		RegisterTestCase(uploadSizeLimit);
+		RegisterTestCase(unsupportedContentType);
+	}
+
+	static StringRequest createRequest(const std::string & contentType) {
+		StringRequest request { Network::Method::post, "/upload", 11 };
+		request.set(Field::content_type, contentType);
+		return request;
+	}
+
+	static void append(FormRequestBodyHandler & handler, std::string_view body, size_t chunkSize) {
+		for (size_t position = 0; position < body.length(); position += chunkSize) {
+			handler.onBodyChunk(body.substr(position, chunkSize));
+		}
+	}
+
+	static Resource::File spoolDirectory() {
+		return TestResources::TestResultsFolder / "Network" / "uploads";
+	}
+
+	static FormRequestBodyHandler::CompletionHandler completionHandler() {
+		return [] (HttpSession &, const StringRequest &, std::map<std::string, std::string> &, FormRequestBodyHandler::Form &) {};
+	}
+
+	void urlEncodedForm() {
+		const auto request = createRequest("application/x-www-form-urlencoded; charset=UTF-8");
+
+		AssertThat(FormRequestBodyHandler::isForm(request), is(true));
+		AssertThat(FormRequestBodyHandler::isUrlEncodedForm(request), is(true));
+
+		FormRequestBodyHandler handler(request, spoolDirectory(), completionHandler());
+		append(handler, "Name=TestName&Message=This+is+a+test+message.", 5);
+		handler.finish();
+
+		const std::unordered_map<std::string, std::string> expected = {
+			  std::make_pair("Name", "TestName")
+			, std::make_pair("Message", "This is a test message.")
+		};
+
+		AssertThat(handler.getForm().fields, is(expected));
+		AssertThat(handler.getForm().files.empty(), is(true));
+	}
+
+	void multipartFormWithUpload() {
+		const auto request = createRequest("multipart/form-data; boundary=AaB03x");
+
+		AssertThat(FormRequestBodyHandler::isMultipartForm(request), is(true));
+
+		std::string content;
+
+		for (size_t m = 0; m < 100000; ++m) {
+			content += (char) (m % 251);
+		}
+
+		const std::string body =
+			"--AaB03x\r\n"
+			"Content-Disposition: form-data; name=\"title\"\r\n"
+			"\r\n"
+			"Test upload\r\n"
+			"--AaB03x\r\n"
+			"Content-Disposition: form-data; name=\"file\"; filename=\"data.bin\"\r\n"
+			"Content-Type: application/octet-stream\r\n"
+			"\r\n"
+			+ content + "\r\n"
+			"--AaB03x--\r\n";
+
+		Resource::File spoolFile;
+
+		{
+			FormRequestBodyHandler handler(request, spoolDirectory(), completionHandler());
+			append(handler, body, 4096);
+			handler.finish();
+
+			auto & form = handler.getForm();
+
+			AssertThat(form.fields.size(), is(1U));
+			AssertThat(form.fields["title"], is("Test upload"));
+			AssertThat(form.files.size(), is(1U));
+
+			const auto & file = form.files[0];
+
+			AssertThat(file.name, is("file"));
+			AssertThat(file.filename, is("data.bin"));
+			AssertThat(file.contentType, is("application/octet-stream"));
+			AssertThat(file.size, is(content.length()));
+			AssertThat(Util::Files::readToString(file.file), is(content));
+
+			spoolFile = file.file;
+		}
+
+		// The spool file is deleted with the form.
+		AssertThat(Resource::File(spoolFile.toRawString()).exists(), is(false));
+	}
+
+	void uploadSizeLimit() {
+		const auto request = createRequest("multipart/form-data; boundary=AaB03x");
+
+		FormRequestBodyHandler::Limits limits;
+		limits.maxFileSize = 10;
+
+		FormRequestBodyHandler handler(request, spoolDirectory(), completionHandler(), limits);
+
+		AssertThat(
+			  [&handler] () {
+				append(
+					  handler
+					, "--AaB03x\r\n"
+					  "Content-Disposition: form-data; name=\"file\"; filename=\"data.bin\"\r\n"
+					  "\r\n"
+					  "01234567890123456789\r\n"
+					  "--AaB03x--\r\n"
+					, 7
+				);
+			}
+			, throws<Exception::NetworkException>()
+		);
+	}
+
+	void unsupportedContentType() {
+		const auto request = createRequest("text/plain");
+
+		AssertThat(FormRequestBodyHandler::isForm(request), is(false));
+
+		AssertThat(
+			  [&request] () { FormRequestBodyHandler handler(request, spoolDirectory(), completionHandler()); }
+			, throws<Exception::NetworkException>()
+		);
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
@@ -0,0 +1,494 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/Http2Session.hpp>
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/CannedHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/FileServingHttpWebApp.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+#include <Balau/Util/Files.hpp>
+
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::isGreaterThan;
+
+namespace Network::Http {
+
+using namespace Impl::Http2Frames;
+
+struct Http2SessionTest : public Testing::TestGroup<Http2SessionTest> {
+	Http2SessionTest() {
+		RegisterTestCase(decodeSettingsHeader);
+		RegisterTestCase(priorKnowledge);
+		RegisterTestCase(multiplexedFileServing);
+		RegisterTestCase(upgrade);
+		RegisterTestCase(maxConcurrentStreams);
+		RegisterTestCase(oversizeHeaderBlock);
+		RegisterTestCase(rapidReset);
+	}
+
+	struct StreamResult {
+		std::vector<Impl::HpackHeader> headers;
+		std::string body;
+		bool complete = false;
+		bool reset = false;
+		ErrorCode resetCode = ErrorCode::NoError;
+
+		std::string status() const {
+			return header(":status");
+		}
+
+		std::string header(const std::string & name) const {
+			for (const auto & h : headers) {
+				if (h.name == name) {
+					return h.value;
+				}
+			}
+
+			return "";
+		}
+	};
+
+	//
+	// A minimal synchronous HTTP/2 client.
+	//
+	// Received DATA frames are immediately credited back via WINDOW_UPDATE frames.
+	//
+	class TestClient {
+		public: explicit TestClient(unsigned short port)
+			: socket(ioContext) {
+			socket.connect(TCP::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+		}
+
+		public: void sendPreface(uint32_t initialWindowSize = DefaultWindowSize) {
+			std::string data(ConnectionPreface);
+			std::string payload;
+			appendSetting(payload, SettingId::EnablePush, 0);
+			appendSetting(payload, SettingId::InitialWindowSize, initialWindowSize);
+			appendFrameHeader(data, (uint32_t) payload.length(), FrameType::Settings, 0, 0);
+			data.append(payload);
+			boost::asio::write(socket, boost::asio::buffer(data));
+		}
+
+		public: void sendRequest(uint32_t streamId, const std::string & method, const std::string & path, bool endStream) {
+			std::string block;
+			encoder.startBlock(block);
+			encoder.encode(":method", method, block);
+			encoder.encode(":scheme", "http", block);
+			encoder.encode(":path", path, block);
+			encoder.encode(":authority", "localhost", block);
+			encoder.encode("user-agent", "Http2SessionTest", block);
+
+			const uint8_t flags = Flags::EndHeaders | (endStream ? Flags::EndStream : 0);
+			writeFrame(FrameType::Headers, flags, streamId, block);
+			results[streamId];
+		}
+
+		public: void sendData(uint32_t streamId, const std::string & data, bool endStream) {
+			writeFrame(FrameType::Data, endStream ? Flags::EndStream : 0, streamId, data);
+		}
+
+		public: void writeRaw(const std::string & data) {
+			boost::asio::write(socket, boost::asio::buffer(data));
+		}
+
+		public: void writeFrame(FrameType type, uint8_t flags, uint32_t streamId, const std::string & payload) {
+			std::string frame;
+			appendFrameHeader(frame, (uint32_t) payload.length(), type, flags, streamId);
+			frame.append(payload);
+			boost::asio::write(socket, boost::asio::buffer(frame));
+		}
+
+		// Read frames until a GOAWAY frame is received.
+		public: void readUntilGoAway() {
+			goAwayExpected = true;
+
+			while (!goAwayReceived) {
+				readFrame();
+			}
+		}
+
+		// Read frames until all the requested streams have completed or have been reset.
+		public: void readResponses() {
+			while (!allDone()) {
+				readFrame();
+			}
+		}
+
+		public: std::string readRaw(const std::string & delimiter) {
+			boost::asio::read_until(socket, raw, delimiter);
+			const auto data = raw.data();
+			std::string text(boost::asio::buffers_begin(data), boost::asio::buffers_end(data));
+			const size_t end = text.find(delimiter) + delimiter.length();
+			raw.consume(end);
+			return text.substr(0, end);
+		}
+
+		public: std::map<uint32_t, StreamResult> results;
+		public: uint32_t maxConcurrentStreams = 0;
+		public: bool settingsAcknowledged = false;
+		public: bool goAwayExpected = false;
+		public: bool goAwayReceived = false;
+		public: ErrorCode goAwayCode = ErrorCode::NoError;
+
+		private: bool allDone() const {
+			for (const auto & entry : results) {
+				if (!entry.second.complete && !entry.second.reset) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		private: void read(char * data, size_t length) {
+			// Bytes remaining from a preceding delimited read are consumed first.
+			const size_t buffered = std::min(length, raw.size());
+			boost::asio::buffer_copy(boost::asio::buffer(data, buffered), raw.data());
+			raw.consume(buffered);
+			boost::asio::read(socket, boost::asio::buffer(data + buffered, length - buffered));
+		}
+
+		private: void readFrame() {
+			char headerBytes[FrameHeaderLength];
+			read(headerBytes, FrameHeaderLength);
+			const auto header = parseFrameHeader(headerBytes);
+
+			std::string payload(header.length, '\0');
+			read(payload.data(), header.length);
+
+			auto & result = results[header.streamId];
+
+			switch (header.type) {
+				case FrameType::Headers: {
+					AssertThat(header.hasFlag(Flags::EndHeaders), is(true));
+					AssertThat(decoder.decode(payload, result.headers, 65536), is(Impl::HpackDecoder::Result::Success));
+					result.complete = header.hasFlag(Flags::EndStream);
+					break;
+				}
+
+				case FrameType::Data: {
+					result.body.append(payload);
+					result.complete = header.hasFlag(Flags::EndStream);
+
+					if (!payload.empty()) {
+						std::string increment;
+						appendUint32(increment, (uint32_t) payload.length());
+						writeFrame(FrameType::WindowUpdate, 0, 0, increment);
+
+						if (!result.complete) {
+							writeFrame(FrameType::WindowUpdate, 0, header.streamId, increment);
+						}
+					}
+
+					break;
+				}
+
+				case FrameType::RstStream: {
+					result.reset = true;
+					result.resetCode = (ErrorCode) readUint32(payload.data());
+					break;
+				}
+
+				case FrameType::Settings: {
+					if (header.hasFlag(Flags::Ack)) {
+						settingsAcknowledged = true;
+					} else {
+						for (size_t offset = 0; offset < payload.length(); offset += 6) {
+							if (payload[offset + 1] == (char) SettingId::MaxConcurrentStreams) {
+								maxConcurrentStreams = readUint32(payload.data() + offset + 2);
+							}
+						}
+
+						writeFrame(FrameType::Settings, Flags::Ack, 0, "");
+					}
+
+					break;
+				}
+
+				case FrameType::GoAway: {
+					if (!goAwayExpected) {
+						AssertFail("Unexpected GOAWAY frame.");
+					}
+
+					goAwayReceived = true;
+					goAwayCode = (ErrorCode) readUint32(payload.data() + 4);
+					break;
+				}
+
+				default: {
+					break;
+				}
+			}
+
+			// Connection level frames are not stream results.
+			if (header.streamId == 0) {
+				results.erase(0);
+			}
+		}
+
+		private: boost::asio::io_context ioContext;
+		private: TCP::socket socket;
+		private: boost::asio::streambuf raw;
+		private: Impl::HpackEncoder encoder;
+		private: Impl::HpackDecoder decoder { Impl::HpackDefaultTableSize };
+	};
+
+	static std::shared_ptr<HttpServer> startServer(unsigned short testPortStart,
+	                                               std::shared_ptr<HttpWebApp> handler,
+	                                               Http2Settings http2 = Http2Settings()) {
+		std::shared_ptr<HttpServer> server;
+
+		Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &handler, &http2, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::make_shared<HttpServer>(
+					  clock
+					, "BalauTest"
+					, endpoint
+					, "Http2Handler"
+					, 2
+					, handler
+					, std::shared_ptr<WsWebApp>(nullptr)
+					, "balau.network.server"
+					, "session"
+					, MimeTypes::defaultMimeTypes
+					, true
+					, std::shared_ptr<WsCompression>(nullptr)
+					, http2
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	static std::shared_ptr<HttpWebApp> cannedHandler() {
+		return std::shared_ptr<HttpWebApp>(new HttpWebApps::CannedHttpWebApp("text/plain", "get body", "post body"));
+	}
+
+	void decodeSettingsHeader() {
+		std::string payload;
+
+		// SETTINGS_MAX_CONCURRENT_STREAMS = 100, SETTINGS_INITIAL_WINDOW_SIZE = 65535.
+		AssertThat(Http2Session::decodeSettingsHeader("AAMAAABkAAQAAP__", payload), is(true));
+
+		std::string expected;
+		appendSetting(expected, SettingId::MaxConcurrentStreams, 100);
+		appendSetting(expected, SettingId::InitialWindowSize, 65535);
+		AssertThat(payload, is(expected));
+
+		AssertThat(Http2Session::decodeSettingsHeader("", payload), is(true));
+		AssertThat(payload.empty(), is(true));
+
+		// Invalid base64url character.
+		AssertThat(Http2Session::decodeSettingsHeader("AAMAAABk+", payload), is(false));
+
+		// Not a whole number of settings.
+		AssertThat(Http2Session::decodeSettingsHeader("AAMA", payload), is(false));
+	}
+
+	void priorKnowledge() {
+		auto server = startServer(43400, cannedHandler());
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+		client.sendPreface();
+		client.sendRequest(1, "GET", "/a", true);
+		client.sendRequest(3, "HEAD", "/b", true);
+		client.sendRequest(5, "POST", "/c", false);
+		client.sendData(5, "form data", true);
+		client.readResponses();
+
+		AssertThat(client.maxConcurrentStreams, is(100U));
+
+		AssertThat(client.results[1].status(), is("200"));
+		AssertThat(client.results[1].header("content-type"), is("text/plain"));
+		AssertThat(client.results[1].header("server"), is("BalauTest"));
+		AssertThat(client.results[1].header("content-length"), is("8"));
+		AssertThat(client.results[1].body, is("get body"));
+
+		AssertThat(client.results[3].status(), is("200"));
+		AssertThat(client.results[3].body, is(""));
+
+		AssertThat(client.results[5].status(), is("200"));
+		AssertThat(client.results[5].body, is("post body"));
+
+		// Connection specific headers are not sent.
+		AssertThat(client.results[1].header("connection"), is(""));
+
+		// The requests are recorded in the server metrics.
+		AssertThat(server->getMetrics().snapshot().inFlight, is(0));
+	}
+
+	void multiplexedFileServing() {
+		const auto documentRoot = TestResources::SourceFolder / "doc";
+		auto handler = std::shared_ptr<HttpWebApp>(new HttpWebApps::FileServingHttpWebApp(documentRoot));
+		auto server = startServer(43450, handler);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		const std::vector<std::string> paths {
+			"/manual/index.bdml", "/manual/Network/HttpServer.bdml", "/manual/Network/HttpWebApp.bdml"
+		};
+
+		// A small window forces the response bodies to be interleaved.
+		TestClient client(server->getPort());
+		client.sendPreface(1000);
+
+		for (size_t m = 0; m < paths.size(); ++m) {
+			client.sendRequest((uint32_t) (m * 2 + 1), "GET", paths[m], true);
+		}
+
+		client.readResponses();
+
+		for (size_t m = 0; m < paths.size(); ++m) {
+			const auto & result = client.results[(uint32_t) (m * 2 + 1)];
+			const auto expected = Util::Files::readToVector(documentRoot / paths[m]);
+
+			AssertThat(result.status(), is("200"));
+			AssertThat(result.body.length(), isGreaterThan(1000U));
+			AssertThat(result.body, is(std::string(expected.begin(), expected.end())));
+		}
+	}
+
+	void upgrade() {
+		auto server = startServer(43500, cannedHandler());
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+
+		const std::string upgradeRequest =
+			"GET /upgraded HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: Upgrade, HTTP2-Settings\r\n"
+			"Upgrade: h2c\r\n"
+			"HTTP2-Settings: AAMAAABkAAQAAP__\r\n"
+			"\r\n";
+
+		client.writeRaw(upgradeRequest);
+
+		const auto response = client.readRaw("\r\n\r\n");
+
+		AssertThat(response.find("HTTP/1.1 101"), is(0U));
+		AssertThat(response.find("Upgrade: h2c") != std::string::npos, is(true));
+
+		// The upgrade request is the request of stream 1.
+		client.sendPreface();
+		client.results[1];
+		client.readResponses();
+
+		AssertThat(client.maxConcurrentStreams, is(100U));
+		AssertThat(client.results[1].status(), is("200"));
+		AssertThat(client.results[1].body, is("get body"));
+
+		// Further requests are sent on the HTTP/2 connection.
+		client.sendRequest(3, "GET", "/next", true);
+		client.readResponses();
+
+		AssertThat(client.results[3].status(), is("200"));
+		AssertThat(client.results[3].body, is("get body"));
+	}
+
+	void maxConcurrentStreams() {
+		Http2Settings http2;
+		http2.maxConcurrentStreams = 1;
+
+		auto server = startServer(43550, cannedHandler(), http2);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+		client.sendPreface();
+
+		// Stream 1 remains open until its body is sent.
+		client.sendRequest(1, "POST", "/a", false);
+		client.sendRequest(3, "GET", "/b", true);
+		client.sendData(1, "form data", true);
+		client.readResponses();
+
+		AssertThat(client.maxConcurrentStreams, is(1U));
+		AssertThat(client.results[1].status(), is("200"));
+		AssertThat(client.results[1].body, is("post body"));
+		AssertThat(client.results[3].reset, is(true));
+		AssertThat((uint32_t) client.results[3].resetCode, is((uint32_t) ErrorCode::RefusedStream));
+	}
+
+	void oversizeHeaderBlock() {
+		Http2Settings http2;
+		http2.maxHeaderListSize = 1024;
+
+		auto server = startServer(43600, cannedHandler(), http2);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+		client.sendPreface();
+
+		// The header block is never ended, so it would grow without a limit.
+		const std::string fragment(600, 'x');
+		client.writeFrame(FrameType::Headers, 0, 1, fragment);
+		client.writeFrame(FrameType::Continuation, 0, 1, fragment);
+		client.readUntilGoAway();
+
+		AssertThat((uint32_t) client.goAwayCode, is((uint32_t) ErrorCode::EnhanceYourCalm));
+	}
+
+	void rapidReset() {
+		Http2Settings http2;
+		http2.maxStreamResetsPerSecond = 10;
+
+		auto server = startServer(43650, cannedHandler(), http2);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+		client.sendPreface();
+
+		std::string cancel;
+		appendUint32(cancel, (uint32_t) ErrorCode::Cancel);
+
+		// The eleventh reset exceeds the limit.
+		for (uint32_t streamId = 1; streamId <= 21; streamId += 2) {
+			client.sendRequest(streamId, "GET", "/a", false);
+			client.writeFrame(FrameType::RstStream, 0, streamId, cancel);
+		}
+
+		client.readUntilGoAway();
+
+		AssertThat((uint32_t) client.goAwayCode, is((uint32_t) ErrorCode::EnhanceYourCalm));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
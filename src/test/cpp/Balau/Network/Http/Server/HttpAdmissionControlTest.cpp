@@ -0,0 +1,371 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpAdmissionControl.hpp>
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpSession.hpp>
+#include <Balau/System/Sleep.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/connect.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::isGreaterThan;
+using Testing::isLessThan;
+using Testing::throws;
+
+namespace Network::Http {
+
+struct HttpAdmissionControlTest : public Testing::TestGroup<HttpAdmissionControlTest> {
+	HttpAdmissionControlTest() {
+		RegisterTestCase(validation);
+		RegisterTestCase(resolve);
+		RegisterTestCase(concurrencyLimit);
+		RegisterTestCase(priorities);
+		RegisterTestCase(adaptiveLimit);
+		RegisterTestCase(prometheus);
+		RegisterTestCase(shedding);
+		RegisterTestCase(saturatedWorkersReduceLimit);
+	}
+
+	static HttpAdmissionSettings fixedSettings(int maxConcurrency,
+	                                           HttpAdmissionPriority priority = HttpAdmissionPriority::Normal) {
+		HttpAdmissionSettings settings;
+		settings.maxConcurrency = maxConcurrency;
+		settings.adaptive = false;
+		settings.priority = priority;
+		return settings;
+	}
+
+	void validation() {
+		HttpAdmissionSettings settings;
+		settings.validate();
+
+		settings.maxConcurrency = 0;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		settings = HttpAdmissionSettings();
+		settings.minConcurrency = settings.maxConcurrency + 1;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		settings = HttpAdmissionSettings();
+		settings.lowPriorityShare = 101;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		AssertThat(HttpAdmissionControl().isEnabled(), is(false));
+	}
+
+	void resolve() {
+		HttpAdmissionControl admission(
+			  fixedSettings(10)
+			, { { "/api /rpc", fixedSettings(5) }, { "/api/health", fixedSettings(1, HttpAdmissionPriority::Critical) } }
+		);
+
+		AssertThat(admission.isEnabled(), is(true));
+		AssertThat(&admission.resolve("/") == &admission.defaultRoute(), is(true));
+		AssertThat(&admission.resolve("/apix") == &admission.defaultRoute(), is(true));
+		AssertThat(admission.resolve("/api").label(), is("/api /rpc"));
+		AssertThat(admission.resolve("/rpc/call").label(), is("/api /rpc"));
+		AssertThat(admission.resolve("/api/health").label(), is("/api/health"));
+		AssertThat(admission.defaultRoute().label(), is("default"));
+	}
+
+	void concurrencyLimit() {
+		HttpAdmissionControl admission(fixedSettings(2), {});
+		auto & route = admission.defaultRoute();
+
+		AssertThat(admission.tryAcquire(route), is(true));
+		AssertThat(admission.tryAcquire(route), is(true));
+		AssertThat(admission.tryAcquire(route), is(false));
+		AssertThat(route.inFlight(), is(int64_t(2)));
+		AssertThat(route.shed(), is(uint64_t(1)));
+
+		admission.release(route);
+
+		AssertThat(admission.tryAcquire(route), is(true));
+		AssertThat(route.admitted(), is(uint64_t(3)));
+	}
+
+	void priorities() {
+		auto lowSettings = fixedSettings(4, HttpAdmissionPriority::Low);
+		lowSettings.lowPriorityShare = 50;
+
+		HttpAdmissionControl admission(
+			  fixedSettings(1)
+			, { { "/health", fixedSettings(1, HttpAdmissionPriority::Critical) }, { "/batch", lowSettings } }
+		);
+
+		// Critical requests are always admitted.
+		auto & health = admission.resolve("/health");
+
+		for (int m = 0; m < 5; ++m) {
+			AssertThat(admission.tryAcquire(health), is(true));
+		}
+
+		AssertThat(health.shed(), is(uint64_t(0)));
+
+		// Low priority requests are only admitted up to their share of the limit.
+		auto & batch = admission.resolve("/batch");
+
+		AssertThat(admission.tryAcquire(batch), is(true));
+		AssertThat(admission.tryAcquire(batch), is(true));
+		AssertThat(admission.tryAcquire(batch), is(false));
+	}
+
+	void adaptiveLimit() {
+		HttpAdmissionSettings settings;
+		settings.maxConcurrency = 64;
+		settings.minConcurrency = 2;
+		settings.targetDelay = std::chrono::milliseconds(5);
+		settings.interval = std::chrono::milliseconds(1);
+
+		HttpAdmissionControl admission(settings, {});
+		auto & route = admission.defaultRoute();
+
+		AssertThat(route.limit(), is(int64_t(64)));
+
+		// A standing queue reduces the limit down to the minimum.
+		for (int m = 0; m < 20; ++m) {
+			System::Sleep::milliSleep(2);
+			admission.recordQueueingDelay(std::chrono::milliseconds(50));
+		}
+
+		AssertThat(route.limit(), is(int64_t(2)));
+
+		// The limit recovers once the queueing delay is below the target.
+		for (int m = 0; m < 5; ++m) {
+			System::Sleep::milliSleep(2);
+			admission.recordQueueingDelay(std::chrono::microseconds(100));
+		}
+
+		AssertThat(route.limit(), isGreaterThan(int64_t(2)));
+	}
+
+	void prometheus() {
+		HttpAdmissionControl admission(fixedSettings(1), { { "/api", fixedSettings(1) } });
+		auto & route = admission.resolve("/api/call");
+
+		admission.tryAcquire(route);
+		admission.tryAcquire(route);
+
+		std::string output;
+		admission.writePrometheus(output);
+
+		AssertThat(output.find("balau_http_admission_shed_total{route=\"/api\"} 1\n") != std::string::npos, is(true));
+		AssertThat(output.find("balau_http_admission_admitted_total{route=\"/api\"} 1\n") != std::string::npos, is(true));
+		AssertThat(output.find("balau_http_admission_in_flight{route=\"default\"} 0\n") != std::string::npos, is(true));
+
+		// Nothing is written when admission control is disabled.
+		std::string disabledOutput;
+		HttpAdmissionControl().writePrometheus(disabledOutput);
+		AssertThat(disabledOutput.empty(), is(true));
+	}
+
+	// Responds after a delay to requests for the slow route.
+	class SlowHttpWebApp : public HttpWebApp {
+		public: explicit SlowHttpWebApp(unsigned int delay_ = 500) : delay(delay_) {}
+
+		public: void handleGetRequest(HttpSession & session,
+		                              const StringRequest & request,
+		                              std::map<std::string, std::string> & ) override {
+			if (request.target() == "/slow") {
+				started = true;
+				System::Sleep::milliSleep(delay);
+			}
+
+			StringResponse response { Status::ok, request.version() };
+			session.configuration().headerCache.setCommonHeaders(response);
+			response.set(Field::content_type, "text/plain");
+			response.keep_alive(request.keep_alive());
+			response.body() = "done";
+			response.prepare_payload();
+			session.sendResponse(std::move(response));
+		}
+
+		public: void handleHeadRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestHeadResponse(session, request));
+		}
+
+		public: void handlePostRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestResponse(session, request, "Unsupported."));
+		}
+
+		public: std::atomic<bool> started { false };
+		private: const unsigned int delay;
+	};
+
+	static StringResponse get(unsigned short port, const std::string & path) {
+		boost::asio::io_context ioContext;
+		TCP::socket socket(ioContext);
+		TCP::resolver resolver(ioContext);
+		boost::asio::connect(socket, resolver.resolve("127.0.0.1", ::toString(port)));
+
+		StringRequest request { Network::Method::get, path, 11 };
+		request.set(Field::host, "localhost");
+		HTTP::write(socket, request);
+
+		Buffer buffer;
+		StringResponse response;
+		HTTP::read(socket, buffer, response);
+		return response;
+	}
+
+	static unsigned short startServer(std::shared_ptr<HttpServer> & server,
+	                                  unsigned short testPortStart,
+	                                  size_t workerCount,
+	                                  const std::shared_ptr<SlowHttpWebApp> & handler,
+	                                  const std::shared_ptr<HttpAdmissionControl> & admission) {
+		return Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &handler, &admission, testPortStart, workerCount] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::make_shared<HttpServer>(
+					  clock
+					, "BalauTest"
+					, endpoint
+					, "AdmissionHandler"
+					, workerCount
+					, handler
+					, std::shared_ptr<WsWebApp>(nullptr)
+					, "balau.network.server"
+					, "session"
+					, MimeTypes::defaultMimeTypes
+					, false
+					, std::shared_ptr<WsCompression>(nullptr)
+					, Http2Settings()
+					, TlsSettings()
+					, admission
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+	}
+
+	void shedding() {
+		const unsigned short testPortStart = 43950;
+		auto handler = std::make_shared<SlowHttpWebApp>();
+
+		auto admission = std::make_shared<HttpAdmissionControl>(
+			  fixedSettings(100)
+			, std::vector<std::pair<std::string, HttpAdmissionSettings>> {
+				  { "/slow", fixedSettings(1) }
+				, { "/health", fixedSettings(1, HttpAdmissionPriority::Critical) }
+			}
+			, std::chrono::seconds(7)
+		);
+
+		std::shared_ptr<HttpServer> server;
+		const unsigned short port = startServer(server, testPortStart, 3, handler, admission);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		StringResponse slowResponse;
+		std::thread slowThread([&slowResponse, port] () { slowResponse = get(port, "/slow"); });
+		OnScopeExit joinSlowThread([&slowThread] () { if (slowThread.joinable()) { slowThread.join(); } });
+
+		while (!handler->started) {
+			System::Sleep::milliSleep(10);
+		}
+
+		// The slow route is at its limit, thus the second request is shed.
+		const auto shedResponse = get(port, "/slow");
+
+		AssertThat(shedResponse.result(), is(Status::service_unavailable));
+		AssertThat(std::string(shedResponse[Field::retry_after]), is("7"));
+
+		// Critical routes and other routes are still admitted.
+		AssertThat(get(port, "/health").result(), is(Status::ok));
+		AssertThat(get(port, "/other").result(), is(Status::ok));
+
+		slowThread.join();
+		AssertThat(slowResponse.result(), is(Status::ok));
+		AssertThat(admission->resolve("/slow").shed(), is(uint64_t(1)));
+	}
+
+	void saturatedWorkersReduceLimit() {
+		const unsigned short testPortStart = 44000;
+
+		// Each slow request occupies the only worker thread, delaying all other handlers.
+		auto handler = std::make_shared<SlowHttpWebApp>(50);
+
+		HttpAdmissionSettings settings;
+		settings.maxConcurrency = 64;
+		settings.targetDelay = std::chrono::milliseconds(5);
+		settings.interval = std::chrono::milliseconds(100);
+
+		auto admission = std::make_shared<HttpAdmissionControl>(
+			settings, std::vector<std::pair<std::string, HttpAdmissionSettings>>()
+		);
+
+		std::shared_ptr<HttpServer> server;
+		const unsigned short port = startServer(server, testPortStart, 1, handler, admission);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		// No queueing delay is measured whilst the server is idle.
+		System::Sleep::milliSleep(300);
+		AssertThat(admission->defaultRoute().limit(), is(int64_t(64)));
+
+		std::atomic<bool> running { true };
+		std::vector<std::thread> clients;
+
+		for (int m = 0; m < 2; ++m) {
+			clients.emplace_back(
+				[&running, port] () {
+					while (running) {
+						get(port, "/slow");
+					}
+				}
+			);
+		}
+
+		OnScopeExit joinClients(
+			[&running, &clients] () {
+				running = false;
+
+				for (auto & client : clients) {
+					client.join();
+				}
+			}
+		);
+
+		// The standing queue of ready handlers reduces the limit.
+		System::Sleep::milliSleep(500);
+		AssertThat(admission->defaultRoute().limit(), isLessThan(int64_t(64)));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
@@ -0,0 +1,148 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpHeaderCache.hpp>
+#include <Balau/Network/Http/Server/Impl/HeaderValueBuilder.hpp>
+#include <Balau/Util/DateTime.hpp>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http {
+
+struct HttpHeaderCacheTest : public Testing::TestGroup<HttpHeaderCacheTest> {
+	HttpHeaderCacheTest() {
+		RegisterTestCase(formatImfFixdate);
+		RegisterTestCase(refreshOncePerSecond);
+		RegisterTestCase(commonHeaderBlock);
+		RegisterTestCase(headerValueBuilder);
+	}
+
+	class TestClock : public System::Clock {
+		public: std::chrono::system_clock::time_point timePoint;
+
+		public: explicit TestClock(std::chrono::system_clock::time_point timePoint_) : timePoint(timePoint_) {}
+
+		public: std::chrono::system_clock::time_point now() const override {
+			return timePoint;
+		}
+
+		public: Date::year_month_day today() const override {
+			return Date::year_month_day(Date::floor<Date::days>(timePoint));
+		}
+
+		public: std::chrono::nanoseconds nanotime() const override {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint.time_since_epoch());
+		}
+
+		public: std::chrono::microseconds microtime() const override {
+			return std::chrono::duration_cast<std::chrono::microseconds>(timePoint.time_since_epoch());
+		}
+
+		public: std::chrono::milliseconds millitime() const override {
+			return std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch());
+		}
+
+		public: std::chrono::centiseconds centitime() const override {
+			return std::chrono::duration_cast<std::chrono::centiseconds>(timePoint.time_since_epoch());
+		}
+
+		public: std::chrono::deciseconds decitime() const override {
+			return std::chrono::duration_cast<std::chrono::deciseconds>(timePoint.time_since_epoch());
+		}
+	};
+
+	static System::Clock::TimePoint timePoint(int64_t secondsSinceEpoch) {
+		return System::Clock::TimePoint(std::chrono::seconds(secondsSinceEpoch));
+	}
+
+	void formatImfFixdate() {
+		const std::vector<int64_t> testData = {
+			0, 784111777, 951782400, 1234567890, 1582934399, 4102444799
+		};
+
+		for (const auto seconds : testData) {
+			const auto tp = std::chrono::time_point_cast<std::chrono::seconds>(timePoint(seconds));
+			char buffer[HttpHeaderCache::DateLength];
+			HttpHeaderCache::formatImfFixdate(buffer, tp);
+
+			const auto actual = std::string(buffer, HttpHeaderCache::DateLength);
+			const auto expected = Util::DateTime::toString("%a, %d %b %Y %T GMT", tp);
+
+			AssertThat(actual, is(expected));
+		}
+	}
+
+	void refreshOncePerSecond() {
+		auto clock = std::make_shared<TestClock>(timePoint(784111777));
+		HttpHeaderCache cache(clock, "Balau test server");
+
+		AssertThat(std::string(cache.date()), is("Sun, 06 Nov 1994 08:49:37 GMT"));
+
+		clock->timePoint += std::chrono::milliseconds(999);
+		AssertThat(std::string(cache.date()), is("Sun, 06 Nov 1994 08:49:37 GMT"));
+
+		clock->timePoint += std::chrono::milliseconds(1);
+		AssertThat(std::string(cache.date()), is("Sun, 06 Nov 1994 08:49:38 GMT"));
+
+		// The ring of slots wraps around without affecting the published value.
+		for (size_t m = 0; m < HttpHeaderCache::SlotCount * 2; ++m) {
+			clock->timePoint += std::chrono::seconds(1);
+			cache.date();
+		}
+
+		AssertThat(std::string(cache.date()), is("Sun, 06 Nov 1994 08:51:46 GMT"));
+	}
+
+	void commonHeaderBlock() {
+		auto clock = std::make_shared<TestClock>(timePoint(784111777));
+		HttpHeaderCache cache(clock, "Balau test server");
+
+		AssertThat(std::string(cache.server()), is("Balau test server"));
+
+		AssertThat(
+			  std::string(cache.commonHeaderBlock())
+			, is("Server: Balau test server\r\nDate: Sun, 06 Nov 1994 08:49:37 GMT\r\n")
+		);
+
+		EmptyResponse response { Status::ok, 11 };
+		cache.setCommonHeaders(response);
+
+		AssertThat(std::string(response[Field::server]), is("Balau test server"));
+		AssertThat(std::string(response[Field::date]), is("Sun, 06 Nov 1994 08:49:37 GMT"));
+	}
+
+	void headerValueBuilder() {
+		Impl::HeaderValueBuilder<16> builder;
+		builder.append("session").append('=').append("12345678");
+		AssertThat(std::string(builder.view()), is("session=12345678"));
+
+		// Overflow into the fallback string.
+		builder.append("; HttpOnly");
+		AssertThat(std::string(builder.view()), is("session=12345678; HttpOnly"));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
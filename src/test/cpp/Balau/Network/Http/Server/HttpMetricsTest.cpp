@@ -0,0 +1,246 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Client/HttpClient.hpp>
+#include <Balau/Network/Http/Server/HttpMetrics.hpp>
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/CannedHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/MetricsHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/RoutingHttpWebApp.hpp>
+#include <Balau/System/Sleep.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::isGreaterThan;
+
+namespace Network::Http {
+
+struct HttpMetricsTest : public Testing::TestGroup<HttpMetricsTest> {
+	HttpMetricsTest() {
+		RegisterTestCase(record);
+		RegisterTestCase(merge);
+		RegisterTestCase(prometheus);
+		RegisterTestCase(served);
+	}
+
+	static bool contains(const std::string & text, const std::string & line) {
+		return text.find(line + "\n") != std::string::npos;
+	}
+
+	void record() {
+		HttpMetrics metrics;
+
+		metrics.requestStarted();
+		metrics.requestStarted();
+		metrics.requestStarted();
+
+		AssertThat(metrics.snapshot().inFlight, is(3));
+
+		metrics.requestCompleted("/manual", 200, 100, 1000, std::chrono::microseconds(300));
+		metrics.requestCompleted("/manual", 404, 50, 200, std::chrono::milliseconds(20));
+		metrics.requestAbandoned();
+
+		const auto snapshot = metrics.snapshot();
+
+		AssertThat(snapshot.inFlight, is(0));
+		AssertThat(snapshot.routes.size(), is(1U));
+		AssertThat(snapshot.find(HttpMetrics::UnmatchedRoute) == nullptr, is(true));
+
+		const auto * route = snapshot.find("/manual");
+
+		AssertThat(route != nullptr, is(true));
+		AssertThat(route->requestCount(), is(2U));
+		AssertThat(route->statusCounts.at(200), is(1U));
+		AssertThat(route->statusCounts.at(404), is(1U));
+		AssertThat(route->bytesIn, is(150U));
+		AssertThat(route->bytesOut, is(1200U));
+		AssertThat(route->latencyBuckets[0], is(1U)); // <= 0.5ms
+		AssertThat(route->latencyBuckets[5], is(1U)); // <= 25ms
+		AssertThat(route->latencySum, is(std::chrono::nanoseconds(20300000)));
+
+		// Statuses outside of the counted range.
+		metrics.requestStarted();
+		metrics.requestCompleted("/manual", 999, 0, 0, std::chrono::seconds(60));
+
+		const auto overflow = metrics.snapshot();
+
+		AssertThat(overflow.find("/manual")->statusCounts.at(0), is(1U));
+		AssertThat(overflow.find("/manual")->latencyBuckets[HttpMetrics::LatencyBucketCount - 1], is(1U));
+	}
+
+	void merge() {
+		HttpMetrics metrics;
+		const size_t threadCount = 4;
+		const size_t requestCount = 10000;
+		std::vector<std::thread> threads;
+
+		for (size_t t = 0; t < threadCount; ++t) {
+			threads.emplace_back(
+				[&metrics, t] () {
+					for (size_t m = 0; m < requestCount; ++m) {
+						metrics.requestStarted();
+
+						metrics.requestCompleted(
+							  m % 2 == 0 ? "/a" : "/b"
+							, t % 2 == 0 ? 200 : 500
+							, 1
+							, 2
+							, std::chrono::microseconds(100)
+						);
+					}
+				}
+			);
+		}
+
+		// Concurrent reads.
+		for (size_t m = 0; m < 100; ++m) {
+			metrics.snapshot();
+		}
+
+		for (auto & thread : threads) {
+			thread.join();
+		}
+
+		const auto snapshot = metrics.snapshot();
+
+		AssertThat(snapshot.inFlight, is(0));
+		AssertThat(snapshot.routes.size(), is(2U));
+		AssertThat(snapshot.routes[0].route, is("/a"));
+		AssertThat(snapshot.routes[1].route, is("/b"));
+
+		for (const auto & route : snapshot.routes) {
+			AssertThat(route.requestCount(), is(threadCount * requestCount / 2));
+			AssertThat(route.statusCounts.at(200), is(threadCount * requestCount / 4));
+			AssertThat(route.statusCounts.at(500), is(threadCount * requestCount / 4));
+			AssertThat(route.bytesIn, is(threadCount * requestCount / 2));
+			AssertThat(route.bytesOut, is(threadCount * requestCount));
+		}
+	}
+
+	void prometheus() {
+		HttpMetrics metrics;
+
+		metrics.requestStarted();
+		metrics.requestStarted();
+		metrics.requestCompleted("/", 200, 10, 20, std::chrono::milliseconds(2));
+		metrics.requestStarted();
+		metrics.requestCompleted("/\"quoted\"", 301, 5, 7, std::chrono::seconds(1));
+
+		const auto text = metrics.toPrometheus();
+
+		AssertThat(contains(text, "# TYPE balau_http_requests_in_flight gauge"), is(true));
+		AssertThat(contains(text, "balau_http_requests_in_flight 1"), is(true));
+		AssertThat(contains(text, "# TYPE balau_http_requests_total counter"), is(true));
+		AssertThat(contains(text, R"(balau_http_requests_total{route="/",status="200"} 1)"), is(true));
+		AssertThat(contains(text, R"(balau_http_requests_total{route="/\"quoted\"",status="301"} 1)"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_bytes_total{route="/"} 10)"), is(true));
+		AssertThat(contains(text, R"(balau_http_response_bytes_total{route="/"} 20)"), is(true));
+		AssertThat(contains(text, "# TYPE balau_http_request_duration_seconds histogram"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_duration_seconds_bucket{route="/",le="0.001"} 0)"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_duration_seconds_bucket{route="/",le="0.0025"} 1)"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_duration_seconds_bucket{route="/",le="+Inf"} 1)"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_duration_seconds_sum{route="/"} 0.002)"), is(true));
+		AssertThat(contains(text, R"(balau_http_request_duration_seconds_count{route="/"} 1)"), is(true));
+	}
+
+	void served() {
+		const unsigned short testPortStart = 43350;
+
+		using namespace HttpWebApps;
+
+		RoutingHttpWebApp::Routing routing(routingNode<CannedHttpWebApp>("", "text/plain", "root", ""));
+		routing.add(routingNode<CannedHttpWebApp>("api", "text/plain", "api", ""));
+		routing.add(routingNode<MetricsHttpWebApp>("metrics"));
+
+		auto handler = std::shared_ptr<HttpWebApp>(new RoutingHttpWebApp(std::move(routing)));
+		std::shared_ptr<HttpServer> server;
+
+		const unsigned short port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &handler, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::shared_ptr<HttpServer>(
+					new HttpServer(clock, "BalauTest", endpoint, "MetricsHandler", 2, handler)
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		HttpClient client("localhost", port);
+
+		AssertThat(client.get("/").base().result(), is(Status::ok));
+		AssertThat(client.get("/index.html").base().result(), is(Status::ok));
+		AssertThat(client.get("/api/v1/items").base().result(), is(Status::ok));
+		AssertThat(client.post("/api/v1/items", "body").base().result(), is(Status::bad_request));
+
+		const auto response = client.get("/metrics");
+
+		AssertThat(response.base().result(), is(Status::ok));
+		AssertThat(std::string(response[Field::content_type]), is(MetricsHttpWebApp::ContentType));
+
+		const auto text = std::string(response.body().begin(), response.body().end());
+
+		// The metrics request itself is in flight whilst the response is being created.
+		AssertThat(contains(text, "balau_http_requests_in_flight 1"), is(true));
+		AssertThat(contains(text, R"(balau_http_requests_total{route="/",status="200"} 2)"), is(true));
+		AssertThat(contains(text, R"(balau_http_requests_total{route="/api",status="200"} 1)"), is(true));
+		AssertThat(contains(text, R"(balau_http_requests_total{route="/api",status="400"} 1)"), is(true));
+
+		// The metrics request is recorded when the response write completes.
+		HttpMetrics::Snapshot snapshot;
+
+		for (size_t m = 0; m < 100; ++m) {
+			snapshot = server->getMetrics().snapshot();
+
+			if (snapshot.find("/metrics") != nullptr) {
+				break;
+			}
+
+			System::Sleep::milliSleep(10);
+		}
+
+		AssertThat(snapshot.find("/metrics") != nullptr, is(true));
+		AssertThat(snapshot.inFlight, is(0));
+
+		const auto * api = snapshot.find("/api");
+
+		AssertThat(api != nullptr, is(true));
+		AssertThat(api->requestCount(), is(2U));
+		AssertThat(api->bytesIn, isGreaterThan(0U));
+		AssertThat(api->bytesOut, isGreaterThan(0U));
+		AssertThat(api->latencySum.count(), isGreaterThan(0));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
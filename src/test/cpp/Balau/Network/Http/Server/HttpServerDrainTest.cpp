@@ -0,0 +1,246 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpSession.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/CannedHttpWebApp.hpp>
+#include <Balau/System/Sleep.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+
+#include <unistd.h>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http {
+
+struct HttpServerDrainTest : public Testing::TestGroup<HttpServerDrainTest> {
+	HttpServerDrainTest() {
+		RegisterTestCase(idleConnectionsAreClosed);
+		RegisterTestCase(inFlightRequestCompletes);
+		RegisterTestCase(listeningSocketHandoff);
+	}
+
+	// A synchronous HTTP/1.1 client that keeps its connection open between requests.
+	class PersistentClient {
+		public: explicit PersistentClient(unsigned short port) : socket(ioContext) {
+			TCP::resolver resolver(ioContext);
+			boost::asio::connect(socket, resolver.resolve("127.0.0.1", ::toString(port)));
+		}
+
+		public: void send(const std::string & path) {
+			StringRequest request { Network::Method::get, path, 11 };
+			request.set(Field::host, "localhost");
+			request.keep_alive(true);
+			HTTP::write(socket, request);
+		}
+
+		public: StringResponse receive() {
+			StringResponse response;
+			HTTP::read(socket, buffer, response);
+			return response;
+		}
+
+		public: StringResponse get(const std::string & path) {
+			send(path);
+			return receive();
+		}
+
+		// Returns true if the server has closed the connection.
+		public: bool isClosedByServer() {
+			char c;
+			boost::system::error_code errorCode;
+			boost::asio::read(socket, boost::asio::buffer(&c, 1), errorCode);
+			return errorCode == boost::asio::error::eof || errorCode == boost::asio::error::connection_reset;
+		}
+
+		private: boost::asio::io_context ioContext;
+		private: TCP::socket socket;
+		private: Buffer buffer;
+	};
+
+	// Responds after a delay, in order to keep a request in flight.
+	class SlowHttpWebApp : public HttpWebApp {
+		public: void handleGetRequest(HttpSession & session,
+		                              const StringRequest & request,
+		                              std::map<std::string, std::string> & ) override {
+			started = true;
+			System::Sleep::milliSleep(500);
+
+			StringResponse response { Status::ok, request.version() };
+			session.configuration().headerCache.setCommonHeaders(response);
+			response.set(Field::content_type, "text/plain");
+			response.keep_alive(request.keep_alive());
+			response.body() = "slow";
+			response.prepare_payload();
+			session.sendResponse(std::move(response));
+		}
+
+		public: void handleHeadRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestHeadResponse(session, request));
+		}
+
+		public: void handlePostRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestResponse(session, request, "Unsupported."));
+		}
+
+		public: std::atomic<bool> started { false };
+	};
+
+	static std::shared_ptr<HttpServer> createServer(const TCP::endpoint & endpoint, std::shared_ptr<HttpWebApp> handler) {
+		auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+		return std::make_shared<HttpServer>(
+			  clock
+			, "BalauTest"
+			, endpoint
+			, "DrainHandler"
+			, 2
+			, std::move(handler)
+			, std::shared_ptr<WsWebApp>(nullptr)
+			, "balau.network.server"
+			, "session"
+			, MimeTypes::defaultMimeTypes
+			, false
+		);
+	}
+
+	static std::shared_ptr<HttpServer> startServer(unsigned short testPortStart, std::shared_ptr<HttpWebApp> handler) {
+		std::shared_ptr<HttpServer> server;
+
+		Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &handler, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				server = createServer(endpoint, handler);
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	void idleConnectionsAreClosed() {
+		auto server = startServer(43800, std::make_shared<HttpWebApps::CannedHttpWebApp>("text/plain", "canned", ""));
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		PersistentClient client(server->getPort());
+
+		AssertThat(client.get("/").result(), is(Status::ok));
+
+		// The idle keep-alive connection does not hold up the drain.
+		const auto start = std::chrono::steady_clock::now();
+		server->drain(std::chrono::seconds(10));
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		AssertThat(elapsed < std::chrono::seconds(5), is(true));
+		AssertThat(server->isRunning(), is(false));
+		AssertThat(client.isClosedByServer(), is(true));
+	}
+
+	void inFlightRequestCompletes() {
+		auto handler = std::make_shared<SlowHttpWebApp>();
+		auto server = startServer(43850, handler);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		PersistentClient client(server->getPort());
+		client.send("/");
+
+		while (!handler->started) {
+			System::Sleep::milliSleep(10);
+		}
+
+		std::thread drainThread([&server] () { server->drain(std::chrono::seconds(10)); });
+		OnScopeExit joinDrainThread([&drainThread] () { drainThread.join(); });
+
+		// The in-flight request completes and the connection is then closed.
+		const auto response = client.receive();
+
+		AssertThat(response.result(), is(Status::ok));
+		AssertThat(response.body(), is("slow"));
+		AssertThat(response.keep_alive(), is(false));
+		AssertThat(client.isClosedByServer(), is(true));
+	}
+
+	void listeningSocketHandoff() {
+		const std::string path = ::toString("/tmp/balau-http-server-drain-test-", ::getpid(), ".sock");
+
+		auto predecessor = startServer(43900, std::make_shared<HttpWebApps::CannedHttpWebApp>("text/plain", "predecessor", ""));
+		OnScopeExit stopPredecessor([&predecessor] () { predecessor->stop(); });
+
+		const auto port = predecessor->getPort();
+		auto successor = createServer(makeEndpoint("127.0.0.1", port), std::make_shared<HttpWebApps::CannedHttpWebApp>("text/plain", "successor", ""));
+		OnScopeExit stopSuccessor([&successor] () { successor->stop(); });
+
+		AssertThat(PersistentClient(port).get("/").body(), is("predecessor"));
+
+		std::atomic<bool> received { false };
+
+		std::thread receiveThread([&successor, &path, &received] () {
+			try {
+				successor->receiveListeningSocket(path, std::chrono::seconds(10));
+				received = true;
+			} catch (const Exception::NetworkException & ) {
+				// Reported by the assertion below.
+			}
+		});
+
+		// Retry until the successor is waiting on the Unix domain socket.
+		for (int attempt = 0; ; ++attempt) {
+			try {
+				predecessor->handOff(path, std::chrono::seconds(10));
+				break;
+			} catch (const Exception::NetworkException & ) {
+				if (attempt == 500) {
+					receiveThread.join();
+					throw;
+				}
+
+				System::Sleep::milliSleep(10);
+			}
+		}
+
+		receiveThread.join();
+
+		AssertThat(received.load(), is(true));
+		AssertThat(predecessor->isRunning(), is(false));
+
+		// The successor serves on the inherited socket without binding the endpoint.
+		successor->startAsync();
+
+		AssertThat(PersistentClient(port).get("/").body(), is("successor"));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
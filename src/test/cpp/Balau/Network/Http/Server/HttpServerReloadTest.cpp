@@ -0,0 +1,192 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Application/EnvironmentConfiguration.hpp>
+#include <Balau/Application/Injector.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/connect.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network::Http {
+
+struct HttpServerReloadTest : public Testing::TestGroup<HttpServerReloadTest> {
+	HttpServerReloadTest() {
+		RegisterTestCase(reload);
+		RegisterTestCase(invalidReload);
+	}
+
+	// A synchronous HTTP/1.1 client that keeps its connection open between requests.
+	class PersistentClient {
+		public: explicit PersistentClient(unsigned short port) : socket(ioContext) {
+			TCP::resolver resolver(ioContext);
+			boost::asio::connect(socket, resolver.resolve("127.0.0.1", ::toString(port)));
+		}
+
+		public: Status get(const std::string & path) {
+			StringRequest request { Network::Method::get, path, 11 };
+			request.set(Field::host, "localhost");
+			request.keep_alive(true);
+			HTTP::write(socket, request);
+
+			Buffer buffer;
+			StringResponse response;
+			HTTP::read(socket, buffer, response);
+			return response.result();
+		}
+
+		private: boost::asio::io_context ioContext;
+		private: TCP::socket socket;
+	};
+
+	// Creates an HTTP server environment configuration with a file serving web application.
+	static std::shared_ptr<EnvironmentProperties> createConfiguration(unsigned short port,
+	                                                                  const std::string & location,
+	                                                                  const Resource::File & documentRoot) {
+		class EnvConfig : public EnvironmentConfiguration {
+			public: EnvConfig(const Resource::Uri & input, unsigned short port_)
+				: EnvironmentConfiguration(input)
+				, port(port_) {}
+
+			public: void configure() const override {
+				group("http.server"
+					, value<std::string>("logging.ns", "http.server")
+					, value<std::string>("access.log", "stream: stdout")
+					, value<std::string>("error.log", "stream: stderr")
+					, value<std::string>("server.id", "Test Server")
+					, value<int>("worker.count", 2)
+					, value<Endpoint>("listen", makeEndpoint("127.0.0.1", port))
+
+					, group("http"
+						, group("files"
+							, value<std::string>("location")
+							, value<std::string>("log.ns", "http.server.files")
+							, value<std::string>("access.log", "stream: stdout")
+							, value<std::string>("error.log", "stream: stderr")
+							, unique<Resource::Uri>("root")
+							, value<std::string>("index", "index.html")
+						)
+					)
+				);
+			}
+
+			private: const unsigned short port;
+		};
+
+		const Resource::StringUri env(
+			R"(
+				http.server {
+					http {
+						files {
+							location = )" + location + R"(
+							root = )" + documentRoot.toUriString() + R"(
+						}
+					}
+				}
+			)"
+		);
+
+		auto injector = Injector::create(EnvConfig(env, port));
+		return injector->getShared<EnvironmentProperties>("http.server");
+	}
+
+	void reload() {
+		const unsigned short testPortStart = 43700;
+		const auto documentRoot = TestResources::SourceFolder / "doc";
+		const std::string path = "/manual/index.bdml";
+
+		std::shared_ptr<HttpServer> server;
+
+		const unsigned short port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &documentRoot, testPortStart] () {
+				const auto port = Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50);
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				// Initially, the manual folder is the document root.
+				server = std::make_shared<HttpServer>(clock, createConfiguration(port, "/", documentRoot / "manual"), false);
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		PersistentClient client(port);
+
+		AssertThat(client.get(path), is(Status::not_found));
+
+		const HttpMetrics * metrics = &server->getMetrics();
+
+		server->reload(createConfiguration(port, "/", documentRoot));
+
+		// The existing connection and new connections both use the reloaded configuration.
+		AssertThat(client.get(path), is(Status::ok));
+		AssertThat(PersistentClient(port).get(path), is(Status::ok));
+
+		// The metrics are shared with the new configuration.
+		AssertThat(&server->getMetrics() == metrics, is(true));
+	}
+
+	void invalidReload() {
+		const unsigned short testPortStart = 43750;
+		const auto documentRoot = TestResources::SourceFolder / "doc";
+		const std::string path = "/manual/index.bdml";
+
+		std::shared_ptr<HttpServer> server;
+
+		const unsigned short port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &documentRoot, testPortStart] () {
+				const auto port = Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50);
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::make_shared<HttpServer>(clock, createConfiguration(port, "/", documentRoot), false);
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		PersistentClient client(port);
+
+		AssertThat(client.get(path), is(Status::ok));
+
+		// The duplicate location is rejected and the current configuration remains active.
+		AssertThat(
+			  [&] () { server->reload(createConfiguration(port, "/a /a", documentRoot / "manual")); }
+			, throws<Exception::NetworkException>()
+		);
+
+		AssertThat(client.get(path), is(Status::ok));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
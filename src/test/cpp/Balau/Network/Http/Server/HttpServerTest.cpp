@@ -23,6 +23,7 @@
 
 #include <Balau/Network/Http/Client/HttpClient.hpp>
 #include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpSession.hpp>
 #include <Balau/Testing/Util/NetworkTesting.hpp>
 #include <Balau/System/SystemClock.hpp>
 #include <Balau/Util/Files.hpp>
@@ -38,8 +39,75 @@ namespace Network::Http {
 struct HttpServerTest : public Testing::TestGroup<HttpServerTest> {
 	HttpServerTest() {
 		RegisterTestCase(injectedInstantiation);
+		RegisterTestCase(streamedPostRequest);
+		RegisterTestCase(streamedPostRequestTooLarge);
 	}
 
+	// Records the chunks of a streamed request body and returns a summary in the response.
+	class CountingBodyHandler : public RequestBodyHandler {
+		public: explicit CountingBodyHandler(uint64_t bodyLimit_) : bodyLimit(bodyLimit_) {}
+
+		public: uint64_t maxBodySize() const override {
+			return bodyLimit;
+		}
+
+		public: void onBodyChunk(std::string_view chunk) override {
+			byteCount += chunk.length();
+			largestChunk = std::max(largestChunk, chunk.length());
+
+			for (char c : chunk) {
+				checksum += (unsigned char) c;
+			}
+		}
+
+		public: void onBodyComplete(HttpSession & session,
+		                            const StringRequest & request,
+		                            std::map<std::string, std::string> & ) override {
+			StringResponse response { Status::ok, request.version() };
+			session.configuration().headerCache.setCommonHeaders(response);
+			response.set(Field::content_type, "text/plain");
+			response.keep_alive(request.keep_alive());
+			response.body() = ::toString(byteCount, " ", largestChunk, " ", checksum);
+			response.prepare_payload();
+			session.sendResponse(std::move(response));
+		}
+
+		private: const uint64_t bodyLimit;
+		private: size_t byteCount = 0;
+		private: size_t largestChunk = 0;
+		private: size_t checksum = 0;
+	};
+
+	class StreamingHttpWebApp : public HttpWebApp {
+		public: void handleGetRequest(HttpSession & session,
+		                              const StringRequest & request,
+		                              std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestResponse(session, request, "Unsupported."));
+		}
+
+		public: void handleHeadRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			session.sendResponse(createBadRequestHeadResponse(session, request));
+		}
+
+		public: void handlePostRequest(HttpSession & session,
+		                               const StringRequest & request,
+		                               std::map<std::string, std::string> & ) override {
+			// Only called for buffered bodies.
+			session.sendResponse(createServerErrorResponse(session, request, "The body was buffered."));
+		}
+
+		public: std::unique_ptr<RequestBodyHandler> createPostBodyHandler(HttpSession & ,
+		                                                                  const StringRequest & request,
+		                                                                  std::map<std::string, std::string> & ) override {
+			// The limited path accepts bodies of up to 1000 bytes.
+			return std::make_unique<CountingBodyHandler>(
+				request.target() == "/limited" ? 1000 : RequestBodyHandler::DefaultMaxBodySize
+			);
+		}
+	};
+
 	template <typename ResponseT> static void assertResponse(const ResponseT & response,
 	                                                         const char * expectedReason,
 	                                                         Status expectedStatus,
@@ -161,6 +229,62 @@ struct HttpServerTest : public Testing::TestGroup<HttpServerTest> {
 
 		AssertThat(response2.base().result(), is(Status::not_found));
 	}
+
+	static std::shared_ptr<HttpServer> startStreamingServer(unsigned short testPortStart) {
+		std::shared_ptr<HttpServer> server;
+		auto handler = std::shared_ptr<HttpWebApp>(new StreamingHttpWebApp);
+
+		Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &handler, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::shared_ptr<HttpServer>(
+					new HttpServer(clock, "BalauTest", endpoint, "StreamingHandler", 2, handler)
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	void streamedPostRequest() {
+		auto server = startStreamingServer(43290);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		// Larger than the body limit applied to buffered requests.
+		std::string body;
+		size_t expectedChecksum = 0;
+
+		for (size_t m = 0; m < 3 * 1024 * 1024; ++m) {
+			body += (char) ('a' + m % 26);
+			expectedChecksum += (unsigned char) body.back();
+		}
+
+		HttpClient client("localhost", server->getPort());
+		auto response = client.post("/upload", body);
+
+		AssertThat(response.base().result(), is(Status::ok));
+
+		const auto actual = std::string(response.body().begin(), response.body().end());
+		const auto expected = ::toString(body.length(), " ", HttpSession::RequestBodyChunkSize, " ", expectedChecksum);
+
+		AssertThat(actual, is(expected));
+	}
+
+	void streamedPostRequestTooLarge() {
+		auto server = startStreamingServer(43340);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		HttpClient client("localhost", server->getPort());
+		auto response = client.post("/limited", std::string(2000, 'a'));
+
+		AssertThat(response.base().result(), is(Status::payload_too_large));
+		AssertThat(response.keep_alive(), is(false));
+	}
 };
 
 } // namespace Network::Http
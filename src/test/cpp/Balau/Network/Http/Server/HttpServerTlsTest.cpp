@@ -0,0 +1,291 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/CannedHttpWebApp.hpp>
+#include <Balau/Network/Http/Server/Impl/Http2Frames.hpp>
+#include <Balau/Network/Http/Server/Impl/TlsContext.hpp>
+#include <Balau/System/Sleep.hpp>
+#include <Balau/System/SystemClock.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network::Http {
+
+struct HttpServerTlsTest : public Testing::TestGroup<HttpServerTlsTest> {
+	HttpServerTlsTest() {
+		RegisterTestCase(settingsValidation);
+		RegisterTestCase(get);
+		RegisterTestCase(sessionResumption);
+		RegisterTestCase(alpnHttp2);
+		RegisterTestCase(handshakeFailure);
+	}
+
+	//
+	// A synchronous TLS client connection that does not verify the server certificate.
+	//
+	class TestClient {
+		public: TestClient(unsigned short port, SSL_SESSION * session = nullptr, const std::string & alpn = "")
+			: context(SSL::context::tls_client)
+			, stream(ioContext, context) {
+			context.set_verify_mode(SSL::verify_none);
+
+			if (session != nullptr) {
+				SSL_set_session(stream.native_handle(), session);
+			}
+
+			if (!alpn.empty()) {
+				SSL_set_alpn_protos(stream.native_handle(), (const unsigned char *) alpn.data(), (unsigned) alpn.length());
+			}
+
+			stream.next_layer().connect(TCP::endpoint(boost::asio::ip::make_address("127.0.0.1"), port));
+			stream.handshake(SSL::stream_base::client);
+		}
+
+		public: ~TestClient() {
+			if (session != nullptr) {
+				SSL_SESSION_free(session);
+			}
+		}
+
+		public: StringResponse get(const std::string & path) {
+			StringRequest request(Network::Method::get, path, 11);
+			request.set(Field::host, "localhost");
+			request.set(Field::user_agent, "HttpServerTlsTest");
+			HTTP::write(stream, request);
+
+			StringResponse response;
+			HTTP::read(stream, buffer, response);
+
+			// TLS 1.3 session tickets are received after the handshake, thus the
+			// session is obtained once a response has been read.
+			if (session == nullptr) {
+				session = SSL_get1_session(stream.native_handle());
+			}
+
+			return response;
+		}
+
+		public: SSL_SESSION * getSession() const {
+			return session;
+		}
+
+		public: bool resumed() {
+			return SSL_session_reused(stream.native_handle()) == 1;
+		}
+
+		public: std::string_view alpnProtocol() {
+			return Impl::alpnProtocol(stream);
+		}
+
+		public: SSL::stream<TCP::socket> & getStream() {
+			return stream;
+		}
+
+		private: boost::asio::io_context ioContext;
+		private: SSL::context context;
+		private: SSL::stream<TCP::socket> stream;
+		private: Buffer buffer;
+		private: SSL_SESSION * session = nullptr;
+	};
+
+	static TlsSettings tlsSettings() {
+		TlsSettings tls;
+		tls.enabled = true;
+		tls.certificateChain = TestResources::assertTestResourceFileExists("Network/Http/Server/test-server.crt");
+		tls.privateKey = TestResources::assertTestResourceFileExists("Network/Http/Server/test-server.key");
+		return tls;
+	}
+
+	static std::shared_ptr<HttpServer> startServer(unsigned short testPortStart) {
+		std::shared_ptr<HttpServer> server;
+
+		Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::make_shared<HttpServer>(
+					  clock
+					, "BalauTest"
+					, endpoint
+					, "TlsHandler"
+					, 2
+					, std::shared_ptr<HttpWebApp>(
+						new HttpWebApps::CannedHttpWebApp("text/plain", "get body", "post body")
+					)
+					, std::shared_ptr<WsWebApp>(nullptr)
+					, "balau.network.server"
+					, "session"
+					, MimeTypes::defaultMimeTypes
+					, true
+					, std::shared_ptr<WsCompression>(nullptr)
+					, Http2Settings()
+					, tlsSettings()
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	// The handshake metrics are recorded by the server after the client handshake has completed.
+	static HttpMetrics::Snapshot waitForHandshakes(HttpServer & server, uint64_t count) {
+		HttpMetrics::Snapshot snapshot;
+
+		for (size_t m = 0; m < 100; ++m) {
+			snapshot = server.getMetrics().snapshot();
+
+			if (snapshot.tlsFullHandshakes + snapshot.tlsResumedHandshakes + snapshot.tlsFailedHandshakes >= count) {
+				break;
+			}
+
+			System::Sleep::milliSleep(10);
+		}
+
+		return snapshot;
+	}
+
+	void settingsValidation() {
+		TlsSettings tls;
+
+		// Disabled settings are not validated.
+		tls.validate();
+
+		tls.enabled = true;
+		AssertThat([&tls] () { tls.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		tls = tlsSettings();
+		tls.validate();
+
+		tls.minimumVersion = "1.1";
+		AssertThat([&tls] () { tls.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		tls = tlsSettings();
+		tls.sessionTimeout = 0;
+		AssertThat([&tls] () { tls.validate(); }, throws<Exception::IllegalArgumentException>());
+	}
+
+	void get() {
+		auto server = startServer(43500);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient client(server->getPort());
+
+		for (size_t m = 0; m < 2; ++m) {
+			const auto response = client.get("/");
+			AssertThat(response.result(), is(Status::ok));
+			AssertThat(std::string(response[Field::server]), is("BalauTest"));
+			AssertThat(response.body(), is("get body"));
+		}
+
+		AssertThat(client.alpnProtocol().empty(), is(true));
+
+		const auto snapshot = waitForHandshakes(*server, 1);
+		AssertThat(snapshot.tlsFullHandshakes, is(1U));
+		AssertThat(snapshot.tlsResumedHandshakes, is(0U));
+		AssertThat(snapshot.find(HttpMetrics::UnmatchedRoute)->requestCount(), is(2U));
+	}
+
+	void sessionResumption() {
+		auto server = startServer(43550);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient first(server->getPort());
+		AssertThat(first.get("/").result(), is(Status::ok));
+		AssertThat(first.resumed(), is(false));
+		AssertThat(first.getSession() != nullptr, is(true));
+
+		TestClient second(server->getPort(), first.getSession());
+		AssertThat(second.resumed(), is(true));
+		AssertThat(second.get("/").result(), is(Status::ok));
+
+		const auto snapshot = waitForHandshakes(*server, 2);
+		AssertThat(snapshot.tlsFullHandshakes, is(1U));
+		AssertThat(snapshot.tlsResumedHandshakes, is(1U));
+
+		const auto text = server->getMetrics().toPrometheus();
+		AssertThat(text.find("balau_http_tls_handshakes_total{result=\"resumed\"} 1\n") != std::string::npos, is(true));
+	}
+
+	void alpnHttp2() {
+		using namespace Impl::Http2Frames;
+
+		auto server = startServer(43600);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		TestClient http1(server->getPort(), nullptr, std::string("\x08http/1.1", 9));
+		AssertThat(http1.alpnProtocol(), is("http/1.1"));
+		AssertThat(http1.get("/").body(), is("get body"));
+
+		TestClient http2(server->getPort(), nullptr, std::string("\x02h2\x08http/1.1", 12));
+		AssertThat(http2.alpnProtocol(), is("h2"));
+
+		std::string preface(ConnectionPreface);
+		appendFrameHeader(preface, 0, FrameType::Settings, 0, 0);
+		boost::asio::write(http2.getStream(), boost::asio::buffer(preface));
+
+		// The server connection preface is a SETTINGS frame.
+		char headerBytes[FrameHeaderLength];
+		boost::asio::read(http2.getStream(), boost::asio::buffer(headerBytes, FrameHeaderLength));
+		const auto header = parseFrameHeader(headerBytes);
+
+		AssertThat(header.type == FrameType::Settings, is(true));
+		AssertThat(header.streamId, is(0U));
+	}
+
+	void handshakeFailure() {
+		auto server = startServer(43650);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		{
+			// A plaintext request is not a TLS client hello.
+			boost::asio::io_context ioContext;
+			TCP::socket socket(ioContext);
+			socket.connect(TCP::endpoint(boost::asio::ip::make_address("127.0.0.1"), server->getPort()));
+			boost::asio::write(socket, boost::asio::buffer(std::string("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")));
+
+			char data[256];
+			boost::system::error_code errorCode;
+			boost::asio::read(socket, boost::asio::buffer(data), errorCode);
+		}
+
+		const auto snapshot = waitForHandshakes(*server, 1);
+		AssertThat(snapshot.tlsFailedHandshakes, is(1U));
+		AssertThat(snapshot.tlsFullHandshakes, is(0U));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
@@ -0,0 +1,206 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/Impl/MultiPatternMatcher.hpp>
+
+#include <random>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network::Http::HttpWebApps::Impl {
+
+struct MultiPatternMatcherTest : public Testing::TestGroup<MultiPatternMatcherTest> {
+	MultiPatternMatcherTest() {
+		RegisterTestCase(literalPatterns);
+		RegisterTestCase(captureGroups);
+		RegisterTestCase(patternOrder);
+		RegisterTestCase(quantifiersAndClasses);
+		RegisterTestCase(fallbackPatterns);
+		RegisterTestCase(nullableQuantifiedGroups);
+		RegisterTestCase(invalidPattern);
+		RegisterTestCase(equivalenceWithStdRegex);
+	}
+
+	static std::vector<std::string> toStrings(const std::vector<std::string_view> & groups) {
+		return std::vector<std::string>(groups.begin(), groups.end());
+	}
+
+	// Asserts that the matcher and std::regex_match give identical results for the inputs.
+	static void assertEquivalence(const std::vector<std::string> & patterns, const std::vector<std::string> & inputs) {
+		MultiPatternMatcher matcher(patterns);
+		std::vector<std::regex> regexes(patterns.begin(), patterns.end());
+		std::vector<std::string_view> groups;
+
+		for (const auto & input : inputs) {
+			size_t expectedIndex = MultiPatternMatcher::NoMatch;
+			std::vector<std::string> expectedGroups;
+			std::smatch results;
+
+			for (size_t index = 0; index < regexes.size(); ++index) {
+				if (std::regex_match(input, results, regexes[index])) {
+					expectedIndex = index;
+
+					for (size_t m = 1; m < results.size(); ++m) {
+						expectedGroups.push_back(results[m].matched ? results[m].str() : "");
+					}
+
+					break;
+				}
+			}
+
+			AssertThat(matcher.match(input, groups), is(expectedIndex));
+			AssertThat(toStrings(groups), is(expectedGroups));
+		}
+	}
+
+	void literalPatterns() {
+		MultiPatternMatcher matcher({ "/a/b", "^/a/c$", "/a", "/a/b" });
+		std::vector<std::string_view> groups;
+
+		AssertThat(matcher.fallbackCount(), is(0U));
+		AssertThat(matcher.match("/a/b", groups), is(0U));
+		AssertThat(matcher.match("/a/c", groups), is(1U));
+		AssertThat(matcher.match("/a", groups), is(2U));
+		AssertThat(matcher.match("/a/", groups), is(MultiPatternMatcher::NoMatch));
+		AssertThat(matcher.match("/a/bc", groups), is(MultiPatternMatcher::NoMatch));
+		AssertThat(matcher.match("", groups), is(MultiPatternMatcher::NoMatch));
+		AssertThat(groups.empty(), is(true));
+	}
+
+	void captureGroups() {
+		MultiPatternMatcher matcher({
+			  "^/redirect/other/(.*)$"
+			, "^/redirect/(.*)/(.*)/(.*)$"
+			, "^/redirect/(.*)$"
+			, "^/optional/(a)?(b)$"
+		});
+
+		std::vector<std::string_view> groups;
+
+		AssertThat(matcher.match("/redirect/other/indirect/file.html", groups), is(0U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "indirect/file.html" }));
+
+		AssertThat(matcher.match("/redirect/first/second/third/file.html", groups), is(1U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "first/second", "third", "file.html" }));
+
+		AssertThat(matcher.match("/redirect/file.html", groups), is(2U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "file.html" }));
+
+		AssertThat(matcher.match("/optional/b", groups), is(3U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "", "b" }));
+	}
+
+	void patternOrder() {
+		// The first matching pattern wins, regardless of whether it is a literal.
+		MultiPatternMatcher matcher({ "/a/(.*)", "/a/b", "/c/d", "/c/(.*)" });
+		std::vector<std::string_view> groups;
+
+		AssertThat(matcher.match("/a/b", groups), is(0U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "b" }));
+
+		AssertThat(matcher.match("/c/d", groups), is(2U));
+		AssertThat(groups.empty(), is(true));
+
+		AssertThat(matcher.match("/c/e", groups), is(3U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "e" }));
+	}
+
+	void quantifiersAndClasses() {
+		assertEquivalence(
+			  { "/x/(\\d+)/(\\w+)?", "/[a-c]{2,3}z", "/([^/]+)\\.html", "/q(?:ab)+(z)?", "/r(a{2}|b{0,2})c", "/l/(.*?)(x*)", "/s.x", "/t[\\d-]x" }
+			, { "/x/123/abc", "/x/123/", "/x//", "/abz", "/abcz", "/abcdz", "/foo.html", "/a/b.html", "/qababz", "/qab", "/q"
+			  , "/raac", "/rbbc", "/rc", "/rbbbc", "/l/abcxx", "/s\nx", "/sax", "/t-x", "/t5x" }
+		);
+	}
+
+	void fallbackPatterns() {
+		// Back references and word boundaries are handled by std::regex.
+		MultiPatternMatcher matcher({ "/(a)\\1", "/b\\b", "/(.*)" });
+		std::vector<std::string_view> groups;
+
+		AssertThat(matcher.fallbackCount(), is(2U));
+
+		AssertThat(matcher.match("/aa", groups), is(0U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "a" }));
+
+		AssertThat(matcher.match("/b", groups), is(1U));
+		AssertThat(groups.empty(), is(true));
+
+		AssertThat(matcher.match("/ab", groups), is(2U));
+		AssertThat(toStrings(groups), is(std::vector<std::string> { "ab" }));
+	}
+
+	void nullableQuantifiedGroups() {
+		// Quantified groups that can match the empty string are handled by std::regex.
+		const std::vector<std::string> patterns = { "/(a*)*", "/(a*)?b", "/(?:a|)+c", "/(b?)(x)" };
+
+		MultiPatternMatcher matcher(patterns);
+		AssertThat(matcher.fallbackCount(), is(3U));
+
+		assertEquivalence(patterns, { "/", "/a", "/aaa", "/b", "/ab", "/c", "/aac", "/x", "/bx", "/ax" });
+	}
+
+	void invalidPattern() {
+		AssertThat([] () { MultiPatternMatcher matcher({ "/a", "/(b" }); }, throws<std::regex_error>());
+	}
+
+	void equivalenceWithStdRegex() {
+		// Pseudo-random patterns and inputs, compared with std::regex_match.
+		const std::vector<std::string> atoms = { "a", "b", "/", ".", "[ab]", "[^a]", "(a)", "(b|/)", "\\d", "x", "(?:ab)" };
+		const std::vector<std::string> quantifiers = { "", "", "*", "+", "?", "{1,2}", "*?", "+?" };
+		const std::string inputCharacters = "ab/x1";
+
+		std::mt19937 random(42);
+
+		for (size_t iteration = 0; iteration < 100; ++iteration) {
+			std::vector<std::string> patterns;
+			std::vector<std::string> inputs;
+
+			for (size_t m = 0, count = 1 + random() % 6; m < count; ++m) {
+				std::string pattern = random() % 3 == 0 ? "^" : "";
+
+				for (size_t n = 0, length = 1 + random() % 5; n < length; ++n) {
+					pattern += atoms[random() % atoms.size()] + quantifiers[random() % quantifiers.size()];
+				}
+
+				patterns.push_back(random() % 3 == 0 ? pattern + "$" : pattern);
+			}
+
+			for (size_t m = 0; m < 20; ++m) {
+				std::string input;
+
+				for (size_t n = 0, length = random() % 7; n < length; ++n) {
+					input += inputCharacters[random() % inputCharacters.size()];
+				}
+
+				inputs.push_back(input);
+			}
+
+			assertEquivalence(patterns, inputs);
+		}
+	}
+};
+
+} // namespace Network::Http::HttpWebApps::Impl
+
+} // namespace Balau
@@ -0,0 +1,196 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/Impl/ResponseCache.hpp>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http::HttpWebApps::Impl {
+
+struct ResponseCacheTest : public Testing::TestGroup<ResponseCacheTest> {
+	ResponseCacheTest() {
+		RegisterTestCase(hitAndMiss);
+		RegisterTestCase(expiry);
+		RegisterTestCase(lruEviction);
+		RegisterTestCase(tinyLfuAdmission);
+		RegisterTestCase(oversizedEntry);
+		RegisterTestCase(coalescing);
+		RegisterTestCase(uncacheableCompletion);
+	}
+
+	using Entry = ResponseCache::Entry;
+	using Result = ResponseCache::LookupResult;
+
+	static std::shared_ptr<const Entry> createEntry(const std::string & body, size_t size, int64_t ttlMillis = 1000) {
+		StringResponse response(Status::ok, 11);
+		response.body() = body;
+		response.prepare_payload();
+		const std::chrono::milliseconds now(0);
+		return std::shared_ptr<const Entry>(new Entry { std::move(response), now, now + std::chrono::milliseconds(ttlMillis), size });
+	}
+
+	static ResponseCache::Waiter noWaiter() {
+		return [] (std::shared_ptr<const Entry>) {};
+	}
+
+	static Result lookup(ResponseCache & cache,
+	                     const std::string & key,
+	                     std::shared_ptr<const Entry> & entry,
+	                     bool coalesce = false,
+	                     int64_t now = 0) {
+		return cache.lookup(key, std::chrono::milliseconds(now), coalesce, noWaiter, entry);
+	}
+
+	void hitAndMiss() {
+		ResponseCache cache(1000, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+
+		AssertThat(lookup(cache, "/a", entry) == Result::Miss, is(true));
+		cache.complete("/a", createEntry("a", 100));
+		AssertThat(lookup(cache, "/a", entry) == Result::Hit, is(true));
+		AssertThat(entry->response.body(), is("a"));
+
+		const auto statistics = cache.statistics();
+		AssertThat(statistics.hits, is(1U));
+		AssertThat(statistics.misses, is(1U));
+		AssertThat(statistics.entries, is(1U));
+		AssertThat(statistics.size, is(100U));
+	}
+
+	void expiry() {
+		ResponseCache cache(1000, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+
+		cache.complete("/a", createEntry("a", 100, 50));
+		AssertThat(lookup(cache, "/a", entry, false, 49) == Result::Hit, is(true));
+		AssertThat(cache.peek("/a", std::chrono::milliseconds(50)) == nullptr, is(true));
+		AssertThat(lookup(cache, "/a", entry, false, 50) == Result::Miss, is(true));
+		AssertThat(cache.statistics().entries, is(0U));
+	}
+
+	void lruEviction() {
+		ResponseCache cache(300, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+
+		cache.complete("/a", createEntry("a", 100));
+		cache.complete("/b", createEntry("b", 100));
+		cache.complete("/c", createEntry("c", 100));
+
+		// Touch /a so that /b becomes the least recently used entry.
+		AssertThat(lookup(cache, "/a", entry) == Result::Hit, is(true));
+		cache.complete("/d", createEntry("d", 100));
+
+		AssertThat(lookup(cache, "/b", entry) == Result::Miss, is(true));
+		AssertThat(lookup(cache, "/a", entry) == Result::Hit, is(true));
+		AssertThat(lookup(cache, "/c", entry) == Result::Hit, is(true));
+		AssertThat(lookup(cache, "/d", entry) == Result::Hit, is(true));
+		AssertThat(cache.statistics().evictions, is(1U));
+		AssertThat(cache.statistics().size, is(300U));
+	}
+
+	void tinyLfuAdmission() {
+		ResponseCache cache(200, ResponseCache::Admission::TinyLfu);
+		std::shared_ptr<const Entry> entry;
+
+		// Two frequently requested entries fill the cache.
+		for (int m = 0; m < 5; ++m) {
+			lookup(cache, "/hot1", entry);
+			lookup(cache, "/hot2", entry);
+		}
+
+		cache.complete("/hot1", createEntry("1", 100));
+		cache.complete("/hot2", createEntry("2", 100));
+
+		// A one-off request does not displace them.
+		AssertThat(lookup(cache, "/cold", entry) == Result::Miss, is(true));
+		cache.complete("/cold", createEntry("c", 100));
+		AssertThat(lookup(cache, "/hot1", entry) == Result::Hit, is(true));
+		AssertThat(lookup(cache, "/hot2", entry) == Result::Hit, is(true));
+		AssertThat(cache.statistics().rejected, is(1U));
+
+		// A key that becomes more frequent than the victim is admitted.
+		for (int m = 0; m < 10; ++m) {
+			lookup(cache, "/warm", entry);
+		}
+
+		cache.complete("/warm", createEntry("w", 100));
+		AssertThat(lookup(cache, "/warm", entry) == Result::Hit, is(true));
+		AssertThat(cache.statistics().evictions, is(1U));
+	}
+
+	void oversizedEntry() {
+		ResponseCache cache(100, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+
+		cache.complete("/a", createEntry("a", 101));
+		AssertThat(lookup(cache, "/a", entry) == Result::Miss, is(true));
+		AssertThat(cache.statistics().rejected, is(1U));
+	}
+
+	void coalescing() {
+		ResponseCache cache(1000, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+		std::vector<std::string> completed;
+
+		const auto createWaiter = [&completed] () -> ResponseCache::Waiter {
+			return [&completed] (std::shared_ptr<const Entry> e) { completed.emplace_back(e ? e->response.body() : "null"); };
+		};
+
+		const std::chrono::milliseconds now(0);
+
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Miss, is(true));
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Waiting, is(true));
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Waiting, is(true));
+		AssertThat(completed.size(), is(0U));
+
+		cache.complete("/a", createEntry("a", 100));
+		AssertThat(completed, is(std::vector<std::string> { "a", "a" }));
+		AssertThat(cache.statistics().coalesced, is(2U));
+
+		// The key is no longer pending.
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Hit, is(true));
+	}
+
+	void uncacheableCompletion() {
+		ResponseCache cache(1000, ResponseCache::Admission::Lru);
+		std::shared_ptr<const Entry> entry;
+		size_t nullCount = 0;
+
+		const auto createWaiter = [&nullCount] () -> ResponseCache::Waiter {
+			return [&nullCount] (std::shared_ptr<const Entry> e) { nullCount += e ? 0 : 1; };
+		};
+
+		const std::chrono::milliseconds now(0);
+
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Miss, is(true));
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Waiting, is(true));
+		cache.complete("/a", nullptr);
+		AssertThat(nullCount, is(1U));
+
+		// The next request becomes the leader again.
+		AssertThat(cache.lookup("/a", now, true, createWaiter, entry) == Result::Miss, is(true));
+	}
+};
+
+} // namespace Network::Http::HttpWebApps::Impl
+
+} // namespace Balau
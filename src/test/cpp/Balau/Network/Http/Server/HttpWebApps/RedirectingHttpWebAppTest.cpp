@@ -102,6 +102,7 @@ struct RedirectingHttpWebAppTest : public Testing::TestGroup<RedirectingHttpWebA
 										location = /redirect/
 
 										matches {
+											/redirect/exact            = 0 301 /test/exact.html
 											^/redirect/other/(.*)$     = 1 302 /test/other/$1
 											^/redirect/(.*)/(.*)/(.*)$ = 2 302 /flip/$2/$1/$3
 											^/redirect/(.*)$           = 3 301 /test/$1
@@ -127,6 +128,9 @@ struct RedirectingHttpWebAppTest : public Testing::TestGroup<RedirectingHttpWebA
 
 		HttpClient client("localhost", port);
 
+		// /redirect/exact = 301 /test/exact.html
+		assertResponse(client.get("/redirect/exact"), Status::moved_permanently, "/test/exact.html");
+
 		// ^/redirect/other/(.*)$ = /test/other/$1
 		assertResponse(client.get("/redirect/other/file.html"), Status::found, "/test/other/file.html");
 		assertResponse(client.get("/redirect/other/indirect/file.html"), Status::found, "/test/other/indirect/file.html");
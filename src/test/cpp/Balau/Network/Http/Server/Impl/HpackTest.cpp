@@ -0,0 +1,231 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Http/Server/Impl/Hpack.hpp>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http::Impl {
+
+struct HpackTest : public Testing::TestGroup<HpackTest> {
+	HpackTest() {
+		RegisterTestCase(integers);
+		RegisterTestCase(huffman);
+		RegisterTestCase(decodeRequests);
+		RegisterTestCase(decodeErrors);
+		RegisterTestCase(headerListTooLarge);
+		RegisterTestCase(encodeRoundTrip);
+		RegisterTestCase(encoderTableSizeUpdate);
+	}
+
+	static std::string fromHex(std::string_view hex) {
+		std::string bytes;
+
+		for (size_t m = 0; m + 1 < hex.length(); m += 2) {
+			bytes.push_back((char) std::stoi(std::string(hex.substr(m, 2)), nullptr, 16));
+		}
+
+		return bytes;
+	}
+
+	static std::vector<std::string> flatten(const std::vector<HpackHeader> & headers) {
+		std::vector<std::string> strings;
+
+		for (const auto & header : headers) {
+			strings.push_back(header.name + ": " + header.value);
+		}
+
+		return strings;
+	}
+
+	// RFC 7541 appendix C.1.
+	void integers() {
+		std::string output;
+
+		hpackEncodeInteger(10, 5, 0x00, output);
+		AssertThat(output, is(fromHex("0a")));
+
+		output.clear();
+		hpackEncodeInteger(1337, 5, 0x00, output);
+		AssertThat(output, is(fromHex("1f9a0a")));
+
+		output.clear();
+		hpackEncodeInteger(42, 8, 0x00, output);
+		AssertThat(output, is(fromHex("2a")));
+
+		size_t position = 0;
+		uint64_t value = 0;
+		AssertThat(hpackDecodeInteger(fromHex("1f9a0a"), position, 5, value), is(true));
+		AssertThat(value, is(1337U));
+		AssertThat(position, is(3U));
+
+		// Truncated.
+		position = 0;
+		AssertThat(hpackDecodeInteger(fromHex("1f9a"), position, 5, value), is(false));
+	}
+
+	// RFC 7541 appendix C.4.1.
+	void huffman() {
+		std::string encoded;
+		HpackHuffman::encode("www.example.com", encoded);
+
+		AssertThat(encoded, is(fromHex("f1e3c2e5f23a6ba0ab90f4ff")));
+		AssertThat(HpackHuffman::encodedLength("www.example.com"), is(12U));
+
+		std::string decoded;
+		AssertThat(HpackHuffman::decode(encoded, decoded), is(true));
+		AssertThat(decoded, is("www.example.com"));
+
+		// Padding longer than seven bits is invalid.
+		decoded.clear();
+		AssertThat(HpackHuffman::decode(encoded + "\xff", decoded), is(false));
+	}
+
+	// RFC 7541 appendix C.4.
+	void decodeRequests() {
+		HpackDecoder decoder(HpackDefaultTableSize);
+		std::vector<HpackHeader> headers;
+
+		AssertThat(
+			  decoder.decode(fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers, 65536)
+			, is(HpackDecoder::Result::Success)
+		);
+
+		AssertThat(flatten(headers), is(std::vector<std::string> {
+			":method: GET", ":scheme: http", ":path: /", ":authority: www.example.com"
+		}));
+
+		AssertThat(decoder.dynamicTable().size(), is(57U));
+
+		headers.clear();
+
+		AssertThat(
+			  decoder.decode(fromHex("828684be5886a8eb10649cbf"), headers, 65536)
+			, is(HpackDecoder::Result::Success)
+		);
+
+		AssertThat(flatten(headers), is(std::vector<std::string> {
+			":method: GET", ":scheme: http", ":path: /", ":authority: www.example.com", "cache-control: no-cache"
+		}));
+
+		AssertThat(decoder.dynamicTable().count(), is(2U));
+		AssertThat(decoder.dynamicTable().size(), is(110U));
+	}
+
+	void decodeErrors() {
+		HpackDecoder decoder(HpackDefaultTableSize);
+		std::vector<HpackHeader> headers;
+
+		// Index zero.
+		AssertThat(decoder.decode(fromHex("80"), headers, 65536), is(HpackDecoder::Result::CompressionError));
+
+		// Index beyond the dynamic table.
+		AssertThat(decoder.decode(fromHex("be"), headers, 65536), is(HpackDecoder::Result::CompressionError));
+
+		// Truncated string literal.
+		AssertThat(decoder.decode(fromHex("400a6162"), headers, 65536), is(HpackDecoder::Result::CompressionError));
+
+		// Table size update larger than the advertised maximum.
+		AssertThat(decoder.decode(fromHex("3fe21f"), headers, 65536), is(HpackDecoder::Result::CompressionError));
+
+		// Table size update after a header field.
+		AssertThat(decoder.decode(fromHex("8220"), headers, 65536), is(HpackDecoder::Result::CompressionError));
+	}
+
+	void headerListTooLarge() {
+		HpackDecoder decoder(HpackDefaultTableSize);
+		std::vector<HpackHeader> headers;
+
+		// The dynamic table is updated even though the header list is discarded.
+		AssertThat(
+			  decoder.decode(fromHex("828684418cf1e3c2e5f23a6ba0ab90f4ff"), headers, 100)
+			, is(HpackDecoder::Result::HeaderListTooLarge)
+		);
+
+		AssertThat(headers.empty(), is(true));
+		AssertThat(decoder.dynamicTable().size(), is(57U));
+	}
+
+	void encodeRoundTrip() {
+		const std::vector<HpackHeader> input {
+			  { ":status", "200" }
+			, { "content-type", "text/html" }
+			, { "content-length", "1234" }
+			, { "server", "Balau" }
+			, { "x-custom", "some value with \x7f characters" }
+		};
+
+		HpackEncoder encoder;
+		HpackDecoder decoder(HpackDefaultTableSize);
+
+		for (int m = 0; m < 2; ++m) {
+			std::string block;
+			encoder.startBlock(block);
+
+			for (const auto & header : input) {
+				encoder.encode(header.name, header.value, block);
+			}
+
+			std::vector<HpackHeader> output;
+			AssertThat(decoder.decode(block, output, 65536), is(HpackDecoder::Result::Success));
+			AssertThat(flatten(output), is(flatten(input)));
+
+			// The second block uses the dynamic table entries added by the first.
+			if (m == 1) {
+				AssertThat(block.length() < 12, is(true));
+			}
+		}
+
+		// The content length is not indexed.
+		AssertThat(encoder.dynamicTable().count(), is(3U));
+		AssertThat(decoder.dynamicTable().count(), is(3U));
+	}
+
+	void encoderTableSizeUpdate() {
+		HpackEncoder encoder;
+		HpackDecoder decoder(HpackDefaultTableSize);
+
+		std::string block;
+		encoder.startBlock(block);
+		encoder.encode("server", "Balau", block);
+
+		std::vector<HpackHeader> output;
+		AssertThat(decoder.decode(block, output, 65536), is(HpackDecoder::Result::Success));
+		AssertThat(decoder.dynamicTable().count(), is(1U));
+
+		// The peer disables the dynamic table.
+		encoder.setMaximumTableSize(0);
+		block.clear();
+		encoder.startBlock(block);
+		encoder.encode("server", "Balau", block);
+
+		output.clear();
+		AssertThat(decoder.decode(block, output, 65536), is(HpackDecoder::Result::Success));
+		AssertThat(flatten(output), is(std::vector<std::string> { "server: Balau" }));
+		AssertThat(decoder.dynamicTable().count(), is(0U));
+		AssertThat(encoder.dynamicTable().count(), is(0U));
+	}
+};
+
+} // namespace Network::Http::Impl
+
+} // namespace Balau
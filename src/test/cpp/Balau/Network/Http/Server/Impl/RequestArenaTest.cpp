@@ -0,0 +1,124 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <TestResources.hpp>
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <Balau/Network/Http/Server/Impl/RequestArena.hpp>
+
+#include <map>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http::Impl {
+
+struct RequestArenaTest : public Testing::TestGroup<RequestArenaTest> {
+	RequestArenaTest() {
+		RegisterTestCase(alignment);
+		RegisterTestCase(steadyStateAllocations);
+		RegisterTestCase(retainedCapacity);
+	}
+
+	using CookieMap = std::map<
+		  std::string_view
+		, std::string_view
+		, std::less<>
+		, RequestArenaAllocator<std::pair<const std::string_view, std::string_view>>
+	>;
+
+	// Performs the arena allocations of a single request, in the same way as an HTTP session.
+	static void simulateRequest(RequestArena & arena, CookieMap & cookies) {
+		cookies.clear();
+		arena.reset();
+
+		cookies.emplace("session", "0123456789abcdef0123456789abcdef");
+		cookies.emplace("theme", "dark");
+		cookies.emplace("language", "en");
+
+		StringResponse response { Status::ok, 11 };
+		auto sharedResponse = std::allocate_shared<StringResponse>(
+			RequestArenaAllocator<StringResponse>(arena), std::move(response)
+		);
+
+		AssertThat(sharedResponse->result(), is(Status::ok));
+	}
+
+	void alignment() {
+		RequestArena arena(256);
+
+		auto * c = static_cast<char *>(arena.allocate(1, 1));
+		auto * d = static_cast<double *>(arena.allocate(sizeof(double), alignof(double)));
+		auto * e = static_cast<char *>(arena.allocate(3, 1));
+		auto * f = static_cast<uint64_t *>(arena.allocate(sizeof(uint64_t), alignof(uint64_t)));
+
+		AssertThat(reinterpret_cast<uintptr_t>(d) % alignof(double), is(0U));
+		AssertThat(reinterpret_cast<uintptr_t>(f) % alignof(uint64_t), is(0U));
+		AssertThat(reinterpret_cast<char *>(d) > c, is(true));
+		AssertThat(reinterpret_cast<char *>(f) > e, is(true));
+		AssertThat(arena.blockAllocations(), is(1U));
+
+		// Allocations larger than the block size get their own block.
+		arena.allocate(1000, 8);
+		AssertThat(arena.blockAllocations(), is(2U));
+	}
+
+	// A steady state keep-alive request performs no heap allocations for the data in the arena.
+	void steadyStateAllocations() {
+		RequestArena arena(512);
+		CookieMap cookies { CookieMap::allocator_type(arena) };
+
+		// The first request grows the arena to the size required.
+		simulateRequest(arena, cookies);
+		const size_t warmedUp = arena.blockAllocations();
+
+		for (size_t m = 0; m < 1000; ++m) {
+			simulateRequest(arena, cookies);
+		}
+
+		AssertThat(arena.blockAllocations(), is(warmedUp));
+	}
+
+	void retainedCapacity() {
+		RequestArena arena(1024, 4096);
+
+		// A large request grows the arena beyond the retained capacity.
+		for (size_t m = 0; m < 8; ++m) {
+			arena.allocate(1024, 1);
+		}
+
+		AssertThat(arena.blockAllocations(), is(8U));
+
+		// The blocks within the retained capacity are reused after the reset.
+		arena.reset();
+
+		for (size_t m = 0; m < 4; ++m) {
+			arena.allocate(1024, 1);
+		}
+
+		AssertThat(arena.blockAllocations(), is(8U));
+
+		// The released blocks are allocated again.
+		arena.allocate(1024, 1);
+		AssertThat(arena.blockAllocations(), is(9U));
+	}
+};
+
+} // namespace Network::Http::Impl
+
+} // namespace Balau
@@ -0,0 +1,122 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Http/Server/Impl/WsOutboundQueue.hpp>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http::Impl {
+
+struct WsOutboundQueueTest : public Testing::TestGroup<WsOutboundQueueTest> {
+	WsOutboundQueueTest() {
+		RegisterTestCase(dropPolicy);
+		RegisterTestCase(coalescePolicy);
+		RegisterTestCase(coalescePolicyEviction);
+		RegisterTestCase(disconnectPolicy);
+		RegisterTestCase(configure);
+	}
+
+	using Result = WsOutboundQueue::Result;
+
+	static std::vector<std::string> drain(WsOutboundQueue & queue) {
+		std::vector<std::string> payloads;
+
+		for (auto message = queue.pop(); message; message = queue.pop()) {
+			payloads.push_back(message->payload());
+		}
+
+		return payloads;
+	}
+
+	void dropPolicy() {
+		WsOutboundQueue queue(2, WsSlowConsumerPolicy::Drop);
+
+		AssertThat(queue.push(WsMessage::text("a")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::text("b")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::text("c")), is(Result::Dropped));
+		AssertThat(queue.size(), is(2U));
+
+		AssertThat(drain(queue), is(std::vector<std::string> { "a", "b" }));
+		AssertThat(queue.empty(), is(true));
+	}
+
+	void coalescePolicy() {
+		WsOutboundQueue queue(3, WsSlowConsumerPolicy::Coalesce);
+
+		AssertThat(queue.push(WsMessage::text("x1", "x")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::text("y1", "y")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::text("z1")), is(Result::Queued));
+
+		// Replaces the queued message with the same key in place.
+		AssertThat(queue.push(WsMessage::text("x2", "x")), is(Result::Coalesced));
+		AssertThat(queue.push(WsMessage::text("y2", "y")), is(Result::Coalesced));
+
+		AssertThat(drain(queue), is(std::vector<std::string> { "x2", "y2", "z1" }));
+	}
+
+	void coalescePolicyEviction() {
+		WsOutboundQueue queue(2, WsSlowConsumerPolicy::Coalesce);
+
+		AssertThat(queue.push(WsMessage::text("x1", "x")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::text("y1", "y")), is(Result::Queued));
+
+		// No message with the same key, so the oldest message is discarded.
+		AssertThat(queue.push(WsMessage::text("w1", "w")), is(Result::Dropped));
+
+		// Messages without a key never replace other messages.
+		AssertThat(queue.push(WsMessage::text("v1")), is(Result::Dropped));
+
+		AssertThat(queue.size(), is(2U));
+		AssertThat(drain(queue), is(std::vector<std::string> { "w1", "v1" }));
+	}
+
+	void disconnectPolicy() {
+		WsOutboundQueue queue(1, WsSlowConsumerPolicy::Disconnect);
+
+		AssertThat(queue.push(WsMessage::binary("a")), is(Result::Queued));
+		AssertThat(queue.push(WsMessage::binary("b")), is(Result::Overflow));
+
+		auto message = queue.pop();
+
+		AssertThat(message->payload(), is("a"));
+		AssertThat(message->isText(), is(false));
+		AssertThat(queue.pop() == nullptr, is(true));
+	}
+
+	void configure() {
+		WsOutboundQueue queue(4, WsSlowConsumerPolicy::Drop);
+
+		for (const char * payload : { "a", "b", "c", "d" }) {
+			queue.push(WsMessage::text(payload));
+		}
+
+		queue.configure(2, WsSlowConsumerPolicy::Disconnect);
+
+		AssertThat(queue.size(), is(2U));
+		AssertThat(queue.push(WsMessage::text("e")), is(Result::Overflow));
+		AssertThat(drain(queue), is(std::vector<std::string> { "c", "d" }));
+	}
+};
+
+} // namespace Network::Http::Impl
+
+} // namespace Balau
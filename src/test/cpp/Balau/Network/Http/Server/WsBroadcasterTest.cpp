@@ -0,0 +1,237 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/WsBroadcaster.hpp>
+#include <Balau/Network/Http/Server/WsSession.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/FailingHttpWebApp.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/connect.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Http {
+
+struct WsBroadcasterTest : public Testing::TestGroup<WsBroadcasterTest> {
+	WsBroadcasterTest() {
+		RegisterTestCase(broadcast);
+		RegisterTestCase(slowConsumerDisconnect);
+		RegisterTestCase(multipleServers);
+	}
+
+	// Subscribes sessions to the topic contained in "subscribe <topic>" messages.
+	class SubscribingWsWebApp : public WsWebApp {
+		public: SubscribingWsWebApp(WsBroadcaster & broadcaster_, size_t capacity_, WsSlowConsumerPolicy policy_)
+			: broadcaster(broadcaster_)
+			, capacity(capacity_)
+			, policy(policy_) {}
+
+		public: void handleTextMessage(WsSession & session, std::string_view path) override {
+			const auto message = session.receivedMessage();
+			const std::string_view prefix = "subscribe ";
+
+			if (message.substr(0, prefix.length()) == prefix) {
+				session.configureOutboundQueue(capacity, policy);
+				broadcaster.subscribe(std::string(message.substr(prefix.length())), session.shared_from_this());
+				session.send(WsMessage::text("subscribed"));
+			}
+		}
+
+		public: void handleBinaryMessage(WsSession & , std::string_view ) override {}
+		public: void handleClose(WsSession & , std::string_view ) override {}
+		public: void handlePing(WsSession & , std::string_view ) override {}
+		public: void handlePong(WsSession & , std::string_view ) override {}
+
+		private: WsBroadcaster & broadcaster;
+		private: const size_t capacity;
+		private: const WsSlowConsumerPolicy policy;
+	};
+
+	struct Client {
+		boost::asio::io_context ioContext;
+		WS::stream<TCP::socket> ws { ioContext };
+
+		Client(unsigned short port, const std::string & topic) {
+			TCP::resolver resolver { ioContext };
+			auto results = resolver.resolve("localhost", ::toString(port));
+			boost::asio::connect(ws.next_layer(), results.begin(), results.end());
+			ws.handshake("localhost", "/");
+			ws.write(boost::asio::buffer(std::string("subscribe ") + topic));
+		}
+
+		std::string read() {
+			Buffer buffer;
+			ws.read(buffer);
+			const auto data = buffer.data();
+			return std::string(static_cast<const char *>(data.data()), data.size());
+		}
+	};
+
+	static std::shared_ptr<HttpServer> startServer(unsigned short testPortStart,
+	                                               const std::shared_ptr<WsWebApp> & wsHandler,
+	                                               unsigned short & port) {
+		std::shared_ptr<HttpServer> server;
+		auto httpHandler = std::shared_ptr<HttpWebApp>(new HttpWebApps::FailingHttpWebApp);
+
+		port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &httpHandler, &wsHandler, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::shared_ptr<HttpServer>(
+					new HttpServer(clock, "BalauTest", endpoint, "WsBroadcaster", 4, httpHandler, wsHandler)
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	void broadcast() {
+		const unsigned short testPortStart = 43310;
+		const size_t clientCount = 20;
+		const size_t messageCount = 200;
+
+		WsBroadcaster broadcaster(4);
+
+		auto wsHandler = std::shared_ptr<WsWebApp>(
+			new SubscribingWsWebApp(broadcaster, messageCount, WsSlowConsumerPolicy::Disconnect)
+		);
+
+		unsigned short port;
+		auto server = startServer(testPortStart, wsHandler, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		std::vector<std::unique_ptr<Client>> clients;
+
+		for (size_t m = 0; m < clientCount; ++m) {
+			clients.emplace_back(new Client(port, m % 2 == 0 ? "even" : "odd"));
+			AssertThat(clients.back()->read(), is("subscribed"));
+		}
+
+		AssertThat(broadcaster.subscriberCount("even"), is(clientCount / 2));
+		AssertThat(broadcaster.subscriberCount("odd"), is(clientCount / 2));
+
+		for (size_t m = 0; m < messageCount; ++m) {
+			AssertThat(broadcaster.publishText("even", ::toString("even ", m)), is(clientCount / 2));
+			AssertThat(broadcaster.publishText("odd", ::toString("odd ", m)), is(clientCount / 2));
+		}
+
+		// Each client receives the messages of its topic in publication order.
+		for (size_t c = 0; c < clientCount; ++c) {
+			const std::string topic = c % 2 == 0 ? "even" : "odd";
+
+			for (size_t m = 0; m < messageCount; ++m) {
+				AssertThat(clients[c]->read(), is(::toString(topic, " ", m)));
+			}
+		}
+
+		for (auto & client : clients) {
+			client->ws.close(WS::close_code::normal);
+		}
+	}
+
+	void slowConsumerDisconnect() {
+		const unsigned short testPortStart = 43320;
+
+		WsBroadcaster broadcaster;
+
+		auto wsHandler = std::shared_ptr<WsWebApp>(
+			new SubscribingWsWebApp(broadcaster, 4, WsSlowConsumerPolicy::Disconnect)
+		);
+
+		unsigned short port;
+		auto server = startServer(testPortStart, wsHandler, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		Client client(port, "updates");
+		AssertThat(client.read(), is("subscribed"));
+
+		// The client does not read, so the socket buffers and then the outbound queue fill.
+		const auto message = WsMessage::binary(std::string(256 * 1024, 'x'), "updates");
+		size_t subscribers = 1;
+
+		for (size_t m = 0; m < 2000 && subscribers != 0; ++m) {
+			subscribers = broadcaster.publish("updates", message);
+
+			if (subscribers != 0 && m % 100 == 99) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+		}
+
+		// The session was disconnected, destroyed, and removed from the subscriptions.
+		AssertThat(subscribers, is(0U));
+		AssertThat(broadcaster.subscriberCount("updates"), is(0U));
+	}
+
+	void multipleServers() {
+		const size_t messageCount = 100;
+
+		WsBroadcaster broadcaster(2);
+
+		auto wsHandler = std::shared_ptr<WsWebApp>(
+			new SubscribingWsWebApp(broadcaster, messageCount, WsSlowConsumerPolicy::Disconnect)
+		);
+
+		// The sessions of each server are delivered to by the lanes of the server's IO context.
+		unsigned short port1;
+		unsigned short port2;
+		auto server1 = startServer(44100, wsHandler, port1);
+		OnScopeExit stopServer1([&server1] () { server1->stop(); });
+		auto server2 = startServer(44150, wsHandler, port2);
+		OnScopeExit stopServer2([&server2] () { server2->stop(); });
+
+		std::vector<std::unique_ptr<Client>> clients;
+
+		for (size_t m = 0; m < 6; ++m) {
+			clients.emplace_back(new Client(m % 2 == 0 ? port1 : port2, "updates"));
+			AssertThat(clients.back()->read(), is("subscribed"));
+		}
+
+		for (size_t m = 0; m < messageCount; ++m) {
+			AssertThat(broadcaster.publishText("updates", ::toString("update ", m)), is(clients.size()));
+		}
+
+		for (auto & client : clients) {
+			for (size_t m = 0; m < messageCount; ++m) {
+				AssertThat(client->read(), is(::toString("update ", m)));
+			}
+		}
+
+		for (auto & client : clients) {
+			client->ws.close(WS::close_code::normal);
+		}
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
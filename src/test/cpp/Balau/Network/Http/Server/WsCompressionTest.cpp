@@ -0,0 +1,270 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Http/Server/HttpServer.hpp>
+#include <Balau/Network/Http/Server/WsCompression.hpp>
+#include <Balau/Network/Http/Server/WsSession.hpp>
+#include <Balau/Network/Http/Server/HttpWebApps/FailingHttpWebApp.hpp>
+#include <Balau/Testing/Util/NetworkTesting.hpp>
+#include <Balau/Type/OnScopeExit.hpp>
+
+#include <boost/asio/connect.hpp>
+
+#include <thread>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::isGreaterThan;
+using Testing::throws;
+
+namespace Network::Http {
+
+struct WsCompressionTest : public Testing::TestGroup<WsCompressionTest> {
+	WsCompressionTest() {
+		RegisterTestCase(validation);
+		RegisterTestCase(option);
+		RegisterTestCase(resolve);
+		RegisterTestCase(compressedEcho);
+		RegisterTestCase(uncompressedEcho);
+	}
+
+	// Echoes messages back to the client via the outbound queue of the session.
+	class EchoWsWebApp : public WsWebApp {
+		public: void handleTextMessage(WsSession & session, std::string_view ) override {
+			session.send(WsMessage::text(std::string(session.receivedMessage())));
+		}
+
+		public: void handleBinaryMessage(WsSession & session, std::string_view ) override {
+			session.send(WsMessage::binary(std::string(session.receivedMessage())));
+		}
+
+		public: void handleClose(WsSession & , std::string_view ) override {}
+		public: void handlePing(WsSession & , std::string_view ) override {}
+		public: void handlePong(WsSession & , std::string_view ) override {}
+	};
+
+	static WsDeflateSettings enabledSettings() {
+		WsDeflateSettings settings;
+		settings.enabled = true;
+		return settings;
+	}
+
+	void validation() {
+		WsDeflateSettings settings = enabledSettings();
+		settings.validate();
+
+		settings.serverMaxWindowBits = 8;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		settings = enabledSettings();
+		settings.compressionLevel = 10;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		settings = enabledSettings();
+		settings.memoryLevel = 0;
+		AssertThat([&settings] () { settings.validate(); }, throws<Exception::IllegalArgumentException>());
+
+		settings = enabledSettings();
+		settings.clientMaxWindowBits = 16;
+
+		AssertThat(
+			  [&settings] () { WsCompression compression(settings); }
+			, throws<Exception::IllegalArgumentException>()
+		);
+	}
+
+	void option() {
+		WsDeflateSettings settings = enabledSettings();
+		settings.serverMaxWindowBits = 10;
+		settings.clientMaxWindowBits = 12;
+		settings.serverNoContextTakeover = true;
+		settings.compressionLevel = 6;
+		settings.memoryLevel = 5;
+
+		const auto option = settings.toOption();
+
+		AssertThat(option.server_enable, is(true));
+		AssertThat(option.client_enable, is(false));
+		AssertThat(option.server_max_window_bits, is(10));
+		AssertThat(option.client_max_window_bits, is(12));
+		AssertThat(option.server_no_context_takeover, is(true));
+		AssertThat(option.client_no_context_takeover, is(false));
+		AssertThat(option.compLevel, is(6));
+		AssertThat(option.memLevel, is(5));
+
+		AssertThat(WsDeflateSettings().toOption().server_enable, is(false));
+	}
+
+	void resolve() {
+		WsDeflateSettings chat = enabledSettings();
+		chat.compressionLevel = 1;
+
+		WsDeflateSettings feeds = enabledSettings();
+		feeds.serverNoContextTakeover = true;
+
+		WsCompression compression(WsDeflateSettings(), { { "/chat", chat }, { "/feeds /chat/feeds", feeds } });
+
+		AssertThat(compression.getRoutes().size(), is(3U));
+		AssertThat(&compression.resolve("/"), is(&compression.defaultRoute()));
+		AssertThat(&compression.resolve("/other"), is(&compression.defaultRoute()));
+		AssertThat(&compression.resolve("/chatter"), is(&compression.defaultRoute()));
+		AssertThat(compression.resolve("/chat").settings.compressionLevel, is(1));
+		AssertThat(compression.resolve("/chat/room").settings.compressionLevel, is(1));
+		AssertThat(compression.resolve("/chat/feeds/prices").settings.serverNoContextTakeover, is(true));
+		AssertThat(compression.resolve("/feeds").settings.serverNoContextTakeover, is(true));
+		AssertThat(compression.resolve("/").settings.enabled, is(false));
+	}
+
+	static std::shared_ptr<HttpServer> startServer(unsigned short testPortStart,
+	                                               const std::shared_ptr<WsCompression> & compression,
+	                                               unsigned short & port) {
+		std::shared_ptr<HttpServer> server;
+		auto httpHandler = std::shared_ptr<HttpWebApp>(new HttpWebApps::FailingHttpWebApp);
+		auto wsHandler = std::shared_ptr<WsWebApp>(new EchoWsWebApp);
+
+		port = Testing::NetworkTesting::initialiseWithFreeTcpPort(
+			[&server, &httpHandler, &wsHandler, &compression, testPortStart] () {
+				auto endpoint = makeEndpoint("127.0.0.1", Testing::NetworkTesting::getFreeTcpPort(testPortStart, 50));
+				auto clock = std::shared_ptr<System::Clock>(new System::SystemClock());
+
+				server = std::shared_ptr<HttpServer>(
+					new HttpServer(
+						  clock
+						, "BalauTest"
+						, endpoint
+						, "WsCompression"
+						, 2
+						, httpHandler
+						, wsHandler
+						, "balau.network.server"
+						, "session"
+						, MimeTypes::defaultMimeTypes
+						, true
+						, compression
+					)
+				);
+
+				server->startAsync();
+				return server->getPort();
+			}
+		);
+
+		return server;
+	}
+
+	// Sends repetitive JSON messages to the echo server and verifies the responses.
+	static void exchangeJsonMessages(unsigned short port, const std::string & path, bool clientDeflate) {
+		boost::asio::io_context ioContext;
+		WS::stream<TCP::socket> ws { ioContext };
+
+		WS::permessage_deflate option;
+		option.client_enable = clientDeflate;
+		ws.set_option(option);
+
+		TCP::resolver resolver { ioContext };
+		auto results = resolver.resolve("localhost", ::toString(port));
+		boost::asio::connect(ws.next_layer(), results.begin(), results.end());
+		ws.handshake("localhost", path);
+
+		for (size_t m = 0; m < 100; ++m) {
+			std::string message = ::toString(R"({"sequence":)", m, R"(,"quotes":[)");
+
+			for (size_t q = 0; q < 20; ++q) {
+				message += ::toString(
+					  q == 0 ? "" : ","
+					, R"({"instrument":"EURUSD","venue":"venue-)", q, R"(","bid":1.0842,"ask":1.0843,"status":"active"})"
+				);
+			}
+
+			message += "]}";
+
+			ws.text(true);
+			ws.write(boost::asio::buffer(message));
+
+			Buffer buffer;
+			ws.read(buffer);
+			const auto data = buffer.data();
+			AssertThat(std::string(static_cast<const char *>(data.data()), data.size()), is(message));
+		}
+
+		ws.close(WS::close_code::normal);
+	}
+
+	// The server side metrics are updated asynchronously to the client.
+	static void waitForMessages(const WsCompressionMetrics & metrics, size_t count) {
+		for (size_t m = 0; m < 500 && (metrics.messagesRead() < count || metrics.messagesWritten() < count); ++m) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	void compressedEcho() {
+		const unsigned short testPortStart = 43330;
+
+		auto compression = std::make_shared<WsCompression>(
+			WsDeflateSettings(), std::vector<std::pair<std::string, WsDeflateSettings>> { { "/json", enabledSettings() } }
+		);
+
+		unsigned short port;
+		auto server = startServer(testPortStart, compression, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		exchangeJsonMessages(port, "/json", true);
+
+		const auto & metrics = compression->resolve("/json").metrics;
+		waitForMessages(metrics, 100);
+
+		AssertThat(metrics.messagesRead(), is(100U));
+		AssertThat(metrics.messagesWritten(), is(100U));
+		AssertThat(metrics.payloadBytesRead(), is(metrics.payloadBytesWritten()));
+		AssertThat(metrics.compressionRatio(), isGreaterThan(2.0));
+		AssertThat(metrics.decompressionRatio(), isGreaterThan(2.0));
+
+		// Nothing was counted for the default route.
+		AssertThat(compression->defaultRoute().metrics.messagesRead(), is(0U));
+	}
+
+	void uncompressedEcho() {
+		const unsigned short testPortStart = 43340;
+
+		auto compression = std::make_shared<WsCompression>();
+
+		unsigned short port;
+		auto server = startServer(testPortStart, compression, port);
+		OnScopeExit stopServer([&server] () { server->stop(); });
+
+		// The client offers compression, but the server does not accept it.
+		exchangeJsonMessages(port, "/json", true);
+
+		const auto & metrics = compression->defaultRoute().metrics;
+		waitForMessages(metrics, 100);
+
+		AssertThat(metrics.messagesRead(), is(100U));
+		AssertThat(metrics.messagesWritten(), is(100U));
+		AssertThat(metrics.compressionRatio() < 1.0, is(true));
+		AssertThat(metrics.decompressionRatio() < 1.0, is(true));
+	}
+};
+
+} // namespace Network::Http
+
+} // namespace Balau
@@ -0,0 +1,111 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Utilities/FormUrlEncodedParser.hpp>
+#include <Balau/Network/Utilities/UrlDecode.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network {
+
+struct FormUrlEncodedParserTest : public Testing::TestGroup<FormUrlEncodedParserTest> {
+	FormUrlEncodedParserTest() {
+		RegisterTestCase(chunkedParsing);
+		RegisterTestCase(emptyFieldsAndValues);
+		RegisterTestCase(maxFieldLength);
+		RegisterTestCase(maxFieldCount);
+		RegisterTestCase(invalidField);
+	}
+
+	static std::unordered_map<std::string, std::string> parse(std::string_view data, size_t chunkSize) {
+		std::unordered_map<std::string, std::string> fields;
+
+		FormUrlEncodedParser parser(
+			[&fields] (std::string && name, std::string && value) { fields.emplace(std::move(name), std::move(value)); }
+		);
+
+		for (size_t position = 0; position < data.length(); position += chunkSize) {
+			parser.append(data.substr(position, chunkSize));
+		}
+
+		parser.finish();
+		return fields;
+	}
+
+	void chunkedParsing() {
+		const std::string data =
+			"no-special-characters"
+			"=%23+beginning+and+space+and+other%5B%40%5Dcharacters"
+			"&all+%21%23%24%26%27%28%29%2A%2B%2C%2F%3A%3B%3D%3F%40%5B%5D+reserved"
+			"=utf-8+%c2%a9%c3%a7%e0%a6%88+characters";
+
+		const auto expected = UrlDecode::splitAndDecode(data);
+
+		for (size_t chunkSize = 1; chunkSize <= data.length(); ++chunkSize) {
+			AssertThat(parse(data, chunkSize), is(expected));
+		}
+	}
+
+	void emptyFieldsAndValues() {
+		std::unordered_map<std::string, std::string> expected = {
+			  std::make_pair("a", "1")
+			, std::make_pair("b", "")
+			, std::make_pair("c", "")
+		};
+
+		AssertThat(parse("a=1&&b=&c&", 3), is(expected));
+	}
+
+	void maxFieldLength() {
+		size_t count = 0;
+		FormUrlEncodedParser parser([&count] (std::string && , std::string && ) { ++count; }, 8);
+
+		// Fields up to the maximum length are accepted, regardless of the chunking.
+		parser.append("a=345678&b=3");
+		parser.append("45678&");
+		AssertThat(count, is(2U));
+
+		AssertThat([&parser] () { parser.append("c=3456789"); }, throws<Exception::NetworkException>());
+	}
+
+	void maxFieldCount() {
+		size_t count = 0;
+		FormUrlEncodedParser parser([&count] (std::string && , std::string && ) { ++count; }, 8, true, 3);
+
+		// Empty fields are not emitted, but are counted.
+		parser.append("a=1&&");
+		AssertThat(count, is(1U));
+
+		AssertThat([&parser] () { parser.append("&&&"); }, throws<Exception::NetworkException>());
+	}
+
+	void invalidField() {
+		AssertThat([] () { parse("a=1&b=2=3", 4); }, throws<Exception::NetworkException>());
+	}
+};
+
+} // namespace Network
+
+} // namespace Balau
@@ -0,0 +1,103 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Utilities/Impl/DelimiterScanner.hpp>
+
+#include <map>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network::Impl {
+
+struct DelimiterScannerTest : public Testing::TestGroup<DelimiterScannerTest> {
+	DelimiterScannerTest() {
+		RegisterTestCase(findFirstOfAllPositions);
+		RegisterTestCase(findFirstOfStartPosition);
+		RegisterTestCase(cookies);
+	}
+
+	// Scans inputs of every length up to several vector blocks, with a delimiter at every position.
+	void findFirstOfAllPositions() {
+		for (size_t length = 0; length <= 100; ++length) {
+			const std::string input(length, 'x');
+
+			AssertThat(findFirstOf<'&', '='>(input), is(std::string_view::npos));
+
+			for (size_t position = 0; position < length; ++position) {
+				std::string withDelimiter = input;
+				withDelimiter[position] = '=';
+				AssertThat(findFirstOf<'&', '='>(withDelimiter), is(position));
+
+				// A second, later delimiter does not affect the result.
+				if (position + 1 < length) {
+					withDelimiter[length - 1] = '&';
+					AssertThat(findFirstOf<'&', '='>(withDelimiter), is(position));
+				}
+			}
+		}
+	}
+
+	void findFirstOfStartPosition() {
+		const std::string input = "0123456789;0123456789;0123456789;0123456789;0123456789";
+
+		AssertThat(findFirstOf<';'>(input, 0), is(10U));
+		AssertThat(findFirstOf<';'>(input, 10), is(10U));
+		AssertThat(findFirstOf<';'>(input, 11), is(21U));
+		AssertThat(findFirstOf<';'>(input, 45), is(std::string_view::npos));
+		AssertThat(findFirstOf<';'>(input, input.length()), is(std::string_view::npos));
+	}
+
+	static std::map<std::string, std::string> parseCookies(std::string_view header) {
+		std::map<std::string, std::string> cookies;
+
+		forEachCookie(header, [&cookies] (std::string_view name, std::string_view value) {
+			cookies.emplace(name, value);
+		});
+
+		return cookies;
+	}
+
+	void cookies() {
+		AssertThat(
+			  parseCookies("session=0123456789abcdef; theme=dark; lang=en-GB")
+			, is(std::map<std::string, std::string> { { "session", "0123456789abcdef" }, { "theme", "dark" }, { "lang", "en-GB" } })
+		);
+
+		// Separators other than the exact "; " string are part of the cookie.
+		AssertThat(
+			  parseCookies("a=1;b; c=3;")
+			, is(std::map<std::string, std::string> { { "a", "1;b" }, { "c", "3;" } })
+		);
+
+		// Invalid cookies are ignored.
+		AssertThat(
+			  parseCookies("invalid; a=1=2; b=2; ")
+			, is(std::map<std::string, std::string> { { "b", "2" } })
+		);
+
+		AssertThat(parseCookies(""), is(std::map<std::string, std::string>()));
+	}
+};
+
+} // namespace Network::Impl
+
+} // namespace Balau
@@ -0,0 +1,94 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <TestResources.hpp>
+#include <Balau/Network/Utilities/MimeTypes.hpp>
+
+namespace Balau {
+
+using Testing::is;
+
+namespace Network {
+
+struct MimeTypesTest : public Testing::TestGroup<MimeTypesTest> {
+	MimeTypesTest() {
+		RegisterTestCase(defaultMimeTypes);
+		RegisterTestCase(caseInsensitivity);
+		RegisterTestCase(unknownExtensions);
+		RegisterTestCase(customMimeTypes);
+	}
+
+	void defaultMimeTypes() {
+		const auto & mimeTypes = *MimeTypes::defaultMimeTypes;
+
+		// Every registered extension is found.
+		for (const auto & entry : mimeTypes.getData()) {
+			AssertThat(mimeTypes.lookup("/some/path/file." + entry.first), is(std::string_view(entry.second)));
+		}
+
+		AssertThat(mimeTypes.lookup("index.html"), is("text/html"));
+		AssertThat(mimeTypes.lookup("/archive.tar.gz"), is("application/x-gzip"));
+	}
+
+	void caseInsensitivity() {
+		const auto & mimeTypes = *MimeTypes::defaultMimeTypes;
+
+		AssertThat(mimeTypes.lookup("INDEX.HTML"), is("text/html"));
+		AssertThat(mimeTypes.lookup("image.JpEg"), is("image/jpeg"));
+		AssertThat(mimeTypes.lookup("font.WOFF2"), is("font/woff2"));
+	}
+
+	void unknownExtensions() {
+		const auto & mimeTypes = *MimeTypes::defaultMimeTypes;
+
+		AssertThat(mimeTypes.lookup("README"), is(""));
+		AssertThat(mimeTypes.lookup("file."), is(""));
+		AssertThat(mimeTypes.lookup("file.unknown"), is(""));
+		AssertThat(mimeTypes.lookup("file.htmlx"), is(""));
+		AssertThat(mimeTypes.lookup("file.a-very-long-extension"), is(""));
+		AssertThat(mimeTypes.lookup("/directory.html/file"), is(""));
+		AssertThat(mimeTypes.lookup(""), is(""));
+	}
+
+	void customMimeTypes() {
+		std::unordered_map<std::string, std::string> data;
+
+		for (size_t m = 0; m < 500; ++m) {
+			data.emplace(::toString("ext", m), ::toString("application/x-type", m));
+		}
+
+		data.emplace("DAT", "application/x-upper");
+		data.emplace("dat", "application/x-lower");
+
+		const MimeTypes mimeTypes(std::move(data));
+
+		for (size_t m = 0; m < 500; ++m) {
+			const auto expected = ::toString("application/x-type", m);
+			AssertThat(mimeTypes.lookup(::toString("file.ext", m)), is(std::string_view(expected)));
+		}
+
+		// Extensions that differ only in case resolve to the lower case registration.
+		AssertThat(mimeTypes.lookup("file.Dat"), is("application/x-lower"));
+		AssertThat(mimeTypes.lookup("file.ext500"), is(""));
+	}
+};
+
+} // namespace Network
+
+} // namespace Balau
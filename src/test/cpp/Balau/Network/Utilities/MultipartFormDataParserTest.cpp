@@ -0,0 +1,168 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Network/Http/Server/NetworkTypes.hpp>
+#include <TestResources.hpp>
+
+#include <Balau/Network/Utilities/MultipartFormDataParser.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Network {
+
+struct MultipartFormDataParserTest : public Testing::TestGroup<MultipartFormDataParserTest> {
+	MultipartFormDataParserTest() {
+		RegisterTestCase(extractBoundary);
+		RegisterTestCase(chunkedParsing);
+		RegisterTestCase(delimiterLookalikes);
+		RegisterTestCase(incompleteBody);
+		RegisterTestCase(maxHeaderLength);
+	}
+
+	struct RecordingHandler : public MultipartFormDataParser::Handler {
+		std::vector<MultipartFormDataParser::Part> parts;
+		std::vector<std::string> data;
+		size_t endCount = 0;
+
+		void onPartBegin(const MultipartFormDataParser::Part & part) override {
+			parts.push_back(part);
+			data.emplace_back();
+		}
+
+		void onPartData(std::string_view d) override {
+			data.back().append(d);
+		}
+
+		void onPartEnd() override {
+			++endCount;
+		}
+	};
+
+	static RecordingHandler parse(std::string_view boundary, std::string_view body, size_t chunkSize) {
+		RecordingHandler handler;
+		MultipartFormDataParser parser(boundary, handler);
+
+		for (size_t position = 0; position < body.length(); position += chunkSize) {
+			parser.append(body.substr(position, chunkSize));
+		}
+
+		parser.finish();
+		return handler;
+	}
+
+	void extractBoundary() {
+		AssertThat(MultipartFormDataParser::extractBoundary("multipart/form-data; boundary=abc"), is("abc"));
+		AssertThat(MultipartFormDataParser::extractBoundary("Multipart/Form-Data;charset=utf-8; Boundary=\"a b;c\""), is("a b;c"));
+
+		AssertThat([] () { MultipartFormDataParser::extractBoundary("text/plain; boundary=abc"); }, throws<Exception::NetworkException>());
+		AssertThat([] () { MultipartFormDataParser::extractBoundary("multipart/form-data"); }, throws<Exception::NetworkException>());
+		AssertThat([] () { MultipartFormDataParser::extractBoundary("multipart/form-data; boundary="); }, throws<Exception::NetworkException>());
+	}
+
+	void chunkedParsing() {
+		const std::string body =
+			"This is the preamble.\r\n"
+			"--AaB03x\r\n"
+			"Content-Disposition: form-data; name=\"submit-name\"\r\n"
+			"\r\n"
+			"Larry\r\n"
+			"--AaB03x  \r\n"
+			"content-disposition: form-data; name=\"files\"; filename=\"file1.txt\"\r\n"
+			"Content-Type: text/plain\r\n"
+			"\r\n"
+			"... contents of file1.txt ...\r\n\r\n"
+			"--AaB03x\r\n"
+			"\r\n"
+			"no headers\r\n"
+			"--AaB03x--\r\n"
+			"This is the epilogue.\r\n";
+
+		for (size_t chunkSize = 1; chunkSize <= body.length(); ++chunkSize) {
+			const auto handler = parse("AaB03x", body, chunkSize);
+
+			AssertThat(handler.parts.size(), is(3U));
+			AssertThat(handler.endCount, is(3U));
+
+			AssertThat(handler.parts[0].name, is("submit-name"));
+			AssertThat(handler.parts[0].isFile(), is(false));
+			AssertThat(handler.data[0], is("Larry"));
+
+			AssertThat(handler.parts[1].name, is("files"));
+			AssertThat(handler.parts[1].filename, is("file1.txt"));
+			AssertThat(handler.parts[1].contentType, is("text/plain"));
+			AssertThat(handler.parts[1].headers.size(), is(2U));
+			AssertThat(handler.parts[1].headers[0].first, is("content-disposition"));
+			AssertThat(handler.parts[1].isFile(), is(true));
+			AssertThat(handler.data[1], is("... contents of file1.txt ...\r\n"));
+
+			AssertThat(handler.parts[2].headers.empty(), is(true));
+			AssertThat(handler.data[2], is("no headers"));
+		}
+	}
+
+	void delimiterLookalikes() {
+		// Partial delimiters inside the part data must be passed through as data.
+		const std::string content = "\r\n-\r\n--\r\n--Aa\r\n--AaB03\r\r\n--AaB03y--AaB03x";
+
+		const std::string body =
+			"--AaB03x\r\n"
+			"Content-Disposition: form-data; name=\"data\"; filename=\"data.bin\"\r\n"
+			"\r\n"
+			+ content + "\r\n"
+			"--AaB03x--";
+
+		for (size_t chunkSize = 1; chunkSize <= body.length(); ++chunkSize) {
+			const auto handler = parse("AaB03x", body, chunkSize);
+
+			AssertThat(handler.parts.size(), is(1U));
+			AssertThat(handler.data[0], is(content));
+		}
+	}
+
+	void incompleteBody() {
+		AssertThat(
+			  [] () { parse("b", "--b\r\nContent-Disposition: form-data; name=\"a\"\r\n\r\nvalue", 4); }
+			, throws<Exception::NetworkException>()
+		);
+
+		AssertThat(
+			  [] () { parse("b", "--b\r\nContent-Disposition form-data\r\n\r\nvalue\r\n--b--", 4); }
+			, throws<Exception::NetworkException>()
+		);
+	}
+
+	void maxHeaderLength() {
+		RecordingHandler handler;
+		MultipartFormDataParser parser("b", handler, 64);
+
+		parser.append("--b\r\nContent-Disposition: form-data; name=\"a\"\r\n");
+
+		AssertThat(
+			  [&parser] () { parser.append("X-Padding: " + std::string(64, 'x') + "\r\n\r\n"); }
+			, throws<Exception::NetworkException>()
+		);
+	}
+};
+
+} // namespace Network
+
+} // namespace Balau
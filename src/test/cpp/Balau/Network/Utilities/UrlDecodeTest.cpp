@@ -26,6 +26,7 @@ namespace Balau {
 
 using Testing::is;
 using Testing::isGreaterThan;
+using Testing::throws;
 
 namespace Network {
 
@@ -33,6 +34,10 @@ struct UrlDecodeTest : public Testing::TestGroup<UrlDecodeTest> {
 	UrlDecodeTest() {
 		RegisterTestCase(decodeTest);
 		RegisterTestCase(splitAndDecodeTest);
+		RegisterTestCase(decodeInPlaceTest);
+		RegisterTestCase(invalidEncodingTest);
+		RegisterTestCase(splitTest);
+		RegisterTestCase(flatSplitTest);
 	}
 
 	void decodeTest() {
@@ -60,6 +65,64 @@ struct UrlDecodeTest : public Testing::TestGroup<UrlDecodeTest> {
 
 		// TODO add tests for boolean arguments.
 	}
+
+	void decodeInPlaceTest() {
+		// Long enough for the vectorised scans to cover several blocks.
+		std::string value = "a-long-run-of-characters-without-any-encoding-before+the%20first%2Bencoded+character";
+		UrlDecode::decodeInPlace(value);
+		AssertThat(value, is("a-long-run-of-characters-without-any-encoding-before the first+encoded character"));
+
+		std::string unchanged = "no-special-characters";
+		UrlDecode::decodeInPlace(unchanged);
+		AssertThat(unchanged, is("no-special-characters"));
+
+		std::string empty;
+		UrlDecode::decodeInPlace(empty);
+		AssertThat(empty, is(""));
+	}
+
+	void invalidEncodingTest() {
+		AssertThat(UrlDecode::decode("trailing%"), is("trailing"));
+		AssertThat(UrlDecode::decode("trailing%4"), is("trailing"));
+		AssertThat(UrlDecode::decode("not%zzhex"), is("nothex"));
+		AssertThat(UrlDecode::decode("invalid%c3utf-8"), is("invalidutf-8"));
+		AssertThat(UrlDecode::decode("invalid%c3utf-8", false), is("invalid\xc3utf-8"));
+
+		AssertThat([] () { UrlDecode::decode("trailing%4", true, true); }, throws<Exception::NetworkException>());
+		AssertThat([] () { UrlDecode::decode("not%zzhex", true, true); }, throws<Exception::NetworkException>());
+		AssertThat([] () { UrlDecode::decode("invalid%c3utf-8", true, true); }, throws<Exception::NetworkException>());
+	}
+
+	void splitTest() {
+		const auto actual = UrlDecode::split("a=1&&b=&c&=4&");
+
+		const std::unordered_map<std::string_view, std::string_view> expected = {
+			  std::make_pair("a", "1")
+			, std::make_pair("b", "")
+			, std::make_pair("c", "")
+			, std::make_pair("", "4")
+		};
+
+		AssertThat(actual, is(expected));
+		AssertThat([] () { UrlDecode::split("a=1=2"); }, throws<Exception::NetworkException>());
+	}
+
+	void flatSplitTest() {
+		std::vector<UrlDecode::Parameter> actual;
+		UrlDecode::split("first=1&second=2&first=3", actual);
+
+		const std::vector<UrlDecode::Parameter> expected = {
+			  std::make_pair("first", "1")
+			, std::make_pair("second", "2")
+			, std::make_pair("first", "3")
+		};
+
+		AssertThat(actual, is(expected));
+
+		// The vector is cleared on reuse.
+		UrlDecode::split("x", actual);
+		AssertThat(actual, is(std::vector<UrlDecode::Parameter> { std::make_pair("x", "") }));
+	}
 };
 
 } // namespace Network
@@ -0,0 +1,319 @@
+// @formatter:off
+//
+// Balau core C++ library
+//
+// Copyright (C) 2017 Bora Software (contact@borasoftware.com)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <Balau/Serialization/FlatSerialization.hpp>
+#include <Balau/Serialization/Marshallers.hpp>
+#include <Balau/Type/ToString.hpp>
+
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+namespace Balau::Serialization {
+
+// Test enum.
+enum class FlatColour : unsigned char { Red, Green, Blue };
+
+inline std::string toString(FlatColour colour) {
+	return ::toString((int) colour);
+}
+
+// Test message with nested and container fields.
+struct FlatMessage {
+	struct Point {
+		int x = 0;
+		int y = 0;
+
+		template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+			archive & BoostSerialization(x) & BoostSerialization(y);
+		}
+	};
+
+	std::string name;
+	long long timestamp = 0;
+	unsigned int count = 0;
+	double ratio = 0.0;
+	bool enabled = false;
+	FlatColour colour = FlatColour::Red;
+	std::vector<Point> points;
+	std::vector<char> bytes;
+	std::map<std::string, int> attributes;
+
+	template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+		archive
+			& BoostSerialization(name)
+			& BoostSerialization(timestamp)
+			& BoostSerialization(count)
+			& BoostSerialization(ratio)
+			& BoostSerialization(enabled)
+			& BoostSerialization(colour)
+			& BoostSerialization(points)
+			& BoostSerialization(bytes)
+			& BoostSerialization(attributes);
+	}
+};
+
+// Version 1 of a versioned message.
+struct FlatRecordV1 {
+	int id = 0;
+
+	template <typename Archive> void serialize(Archive & archive, unsigned int ) {
+		archive & BoostSerialization(id);
+	}
+};
+
+// Version 2 of the versioned message, which adds a field.
+struct FlatRecordV2 {
+	int id = 0;
+	std::string label = "none";
+
+	template <typename Archive> void serialize(Archive & archive, unsigned int version) {
+		archive & BoostSerialization(id);
+
+		if (version >= 2) {
+			archive & BoostSerialization(label);
+		}
+	}
+};
+
+// Test message serialized via a free function.
+struct FlatFreeMessage {
+	int id = 0;
+	std::optional<std::string> label;
+	std::unique_ptr<FlatRecordV1> record;
+	std::shared_ptr<FlatRecordV1> shared;
+};
+
+template <typename Archive> void serialize(Archive & archive, FlatFreeMessage & message, unsigned int ) {
+	archive
+		& BoostSerialization(message.id)
+		& BoostSerialization(message.label)
+		& BoostSerialization(message.record)
+		& BoostSerialization(message.shared);
+}
+
+} // namespace Balau::Serialization
+
+BoostSerializationClassVersion(Balau::Serialization::FlatRecordV1, 1)
+BoostSerializationClassVersion(Balau::Serialization::FlatRecordV2, 2)
+
+#include <TestResources.hpp>
+
+namespace Balau {
+
+using Testing::is;
+using Testing::throws;
+
+namespace Serialization {
+
+struct FlatSerializationTest : public Testing::TestGroup<FlatSerializationTest> {
+	FlatSerializationTest() {
+		RegisterTestCase(integers);
+		RegisterTestCase(varintEncoding);
+		RegisterTestCase(message);
+		RegisterTestCase(standardContainers);
+		RegisterTestCase(freeSerializeFunction);
+		RegisterTestCase(versioning);
+		RegisterTestCase(malformedData);
+		RegisterTestCase(encodedSize);
+	}
+
+	template <typename T> static T roundTrip(const T & value) {
+		const auto buffer = FlatSerialization::marshal(value);
+		return FlatSerialization::unmarshal<T>(buffer.data(), buffer.size());
+	}
+
+	static FlatMessage createMessage() {
+		FlatMessage message;
+		message.name = "sensor.temperature";
+		message.timestamp = -1234567890123LL;
+		message.count = 300;
+		message.ratio = 0.25;
+		message.enabled = true;
+		message.colour = FlatColour::Blue;
+		message.points = { { 1, -1 }, { 1000000, -1000000 } };
+		message.bytes = { 'a', 'b', 'c' };
+		message.attributes = { { "a", 1 }, { "b", -2 } };
+		return message;
+	}
+
+	void integers() {
+		AssertThat(roundTrip(0), is(0));
+		AssertThat(roundTrip(-1), is(-1));
+		AssertThat(roundTrip(std::numeric_limits<int>::min()), is(std::numeric_limits<int>::min()));
+		AssertThat(roundTrip(std::numeric_limits<int>::max()), is(std::numeric_limits<int>::max()));
+		AssertThat(roundTrip(std::numeric_limits<long long>::min()), is(std::numeric_limits<long long>::min()));
+		AssertThat(roundTrip(std::numeric_limits<unsigned long long>::max()), is(std::numeric_limits<unsigned long long>::max()));
+		AssertThat(roundTrip((short) -300), is((short) -300));
+		AssertThat(roundTrip((char) 'x'), is('x'));
+		AssertThat(roundTrip(true), is(true));
+		AssertThat(roundTrip(FlatColour::Green), is(FlatColour::Green));
+	}
+
+	void varintEncoding() {
+		AssertThat(FlatSerialization::marshal(127U).size(), is((size_t) 1));
+		AssertThat(FlatSerialization::marshal(300U).size(), is((size_t) 2));
+		AssertThat(FlatSerialization::marshal(-1).size(), is((size_t) 1));
+		AssertThat(FlatSerialization::marshal(std::numeric_limits<unsigned long long>::max()).size(), is((size_t) 10));
+
+		const auto buffer = FlatSerialization::marshal(300U);
+		AssertThat((unsigned char) buffer[0], is((unsigned char) 0xAC));
+		AssertThat((unsigned char) buffer[1], is((unsigned char) 0x02));
+	}
+
+	void message() {
+		const FlatMessage expected = createMessage();
+		const FlatMessage actual = roundTrip(expected);
+
+		AssertThat(actual.name, is(expected.name));
+		AssertThat(actual.timestamp, is(expected.timestamp));
+		AssertThat(actual.count, is(expected.count));
+		AssertThat(actual.ratio, is(expected.ratio));
+		AssertThat(actual.enabled, is(expected.enabled));
+		AssertThat(actual.colour, is(expected.colour));
+		AssertThat(actual.points.size(), is((size_t) 2));
+		AssertThat(actual.points[1].x, is(1000000));
+		AssertThat(actual.points[1].y, is(-1000000));
+		AssertThat(actual.bytes, is(expected.bytes));
+		AssertThat(actual.attributes, is(expected.attributes));
+	}
+
+	void standardContainers() {
+		const std::vector<bool> bools { true, false, true, true };
+		AssertThat(roundTrip(bools) == bools, is(true));
+
+		const std::set<std::string> set { "a", "b", "c" };
+		AssertThat(roundTrip(set) == set, is(true));
+
+		const std::unordered_set<int> unorderedSet { 1, -2, 300 };
+		AssertThat(roundTrip(unorderedSet) == unorderedSet, is(true));
+
+		const std::unordered_map<std::string, std::vector<int>> unorderedMap { { "a", { 1, 2 } }, { "b", {} } };
+		AssertThat(roundTrip(unorderedMap) == unorderedMap, is(true));
+
+		const std::optional<int> present = 42;
+		const std::optional<int> absent;
+		AssertThat(roundTrip(present) == present, is(true));
+		AssertThat(roundTrip(absent).has_value(), is(false));
+	}
+
+	void freeSerializeFunction() {
+		FlatFreeMessage expected;
+		expected.id = 7;
+		expected.label = "label";
+		expected.record = std::make_unique<FlatRecordV1>();
+		expected.record->id = 8;
+
+		const auto buffer = FlatSerialization::marshal(expected);
+		const auto actual = FlatSerialization::unmarshal<FlatFreeMessage>(buffer.data(), buffer.size());
+
+		AssertThat(actual.id, is(7));
+		AssertThat(actual.label == expected.label, is(true));
+		AssertThat(actual.record != nullptr, is(true));
+		AssertThat(actual.record->id, is(8));
+		AssertThat(actual.shared == nullptr, is(true));
+	}
+
+	void versioning() {
+		// Older data is decoded with the older version's fields.
+		FlatRecordV1 v1;
+		v1.id = 42;
+		const auto v1Buffer = FlatSerialization::marshal(v1);
+		const auto v2 = FlatSerialization::unmarshal<FlatRecordV2>(v1Buffer.data(), v1Buffer.size());
+
+		AssertThat(v2.id, is(42));
+		AssertThat(v2.label, is("none"));
+
+		// Newer data cannot be decoded by an older version.
+		FlatRecordV2 newer;
+		newer.label = "new";
+		const auto v2Buffer = FlatSerialization::marshal(newer);
+
+		AssertThat(
+			  [&v2Buffer] () { FlatSerialization::unmarshal<FlatRecordV1>(v2Buffer.data(), v2Buffer.size()); }
+			, throws<Exception::SerializationException>()
+		);
+	}
+
+	void malformedData() {
+		const auto buffer = FlatSerialization::marshal(createMessage());
+
+		for (size_t size : { (size_t) 0, (size_t) 1, buffer.size() / 2, buffer.size() - 1 }) {
+			AssertThat(
+				  [&buffer, size] () { FlatSerialization::unmarshal<FlatMessage>(buffer.data(), size); }
+				, throws<Exception::SerializationException>()
+			);
+		}
+
+		// A string length far beyond the available data.
+		const std::vector<char> oversize { (char) 0xFF, (char) 0xFF, (char) 0xFF, (char) 0x0F };
+
+		AssertThat(
+			  [&oversize] () { FlatSerialization::unmarshal<std::string>(oversize.data(), oversize.size()); }
+			, throws<Exception::SerializationException>()
+		);
+
+		// A ten byte varint whose last byte carries bits beyond the 64th.
+		std::vector<char> overflow(9, (char) 0xFF);
+		overflow.push_back((char) 0x02);
+
+		AssertThat(
+			  [&overflow] () { FlatSerialization::unmarshal<uint64_t>(overflow.data(), overflow.size()); }
+			, throws<Exception::SerializationException>()
+		);
+
+		// An invalid presence byte.
+		const std::vector<char> presence { (char) 0x02, (char) 0x01 };
+
+		AssertThat(
+			  [&presence] () { FlatSerialization::unmarshal<std::optional<int>>(presence.data(), presence.size()); }
+			, throws<Exception::SerializationException>()
+		);
+	}
+
+	// The flat encoding is smaller than the Boost archive encoding and both round trip.
+	void encodedSize() {
+		const FlatMessage message = createMessage();
+
+		const auto flat = marshallerRoundTrip<FlatMarshaller>(message);
+		const auto boost = marshallerRoundTrip<BoostArchiveMarshaller>(message);
+
+		AssertThat(flat < boost, is(true));
+	}
+
+	// Marshal and unmarshal the message, returning the encoded size.
+	template <typename MarshallerT> static size_t marshallerRoundTrip(const FlatMessage & message) {
+		std::vector<char> buffer;
+		FlatMessage decoded;
+
+		MarshallerT::marshal(buffer, message);
+		MarshallerT::unmarshal(buffer.data(), buffer.size(), decoded);
+
+		AssertThat(decoded.name, is(message.name));
+		AssertThat(decoded.timestamp, is(message.timestamp));
+		AssertThat(decoded.points.size(), is(message.points.size()));
+		AssertThat(decoded.bytes, is(message.bytes));
+		AssertThat(decoded.attributes, is(message.attributes));
+		return buffer.size();
+	}
+};
+
+} // namespace Serialization
+
+} // namespace Balau